@@ -187,3 +187,93 @@ LOCAL_MODULE_TAGS := optional
 LOCAL_MODULE:= muxer
 
 include $(BUILD_EXECUTABLE)
+
+################################################################################
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:=         \
+        mediascan.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+	libstagefright libmedia liblog libutils libbinder
+
+LOCAL_C_INCLUDES:= \
+	frameworks/av/media/libstagefright \
+	$(TOP)/frameworks/native/include/media/openmax
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= mediascan
+
+include $(BUILD_EXECUTABLE)
+
+################################################################################
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:=         \
+        charsetbench.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+	libmedia liblog libutils libicuuc libicui18n
+
+LOCAL_C_INCLUDES:= \
+	$(TOP)/frameworks/av/include/media \
+	$(TOP)/frameworks/av/media/libmedia \
+	$(TOP)/external/icu/icu4c/source/common \
+	$(TOP)/external/icu/icu4c/source/i18n
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= charsetbench
+
+include $(BUILD_EXECUTABLE)
+
+################################################################################
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:=         \
+        playerbench.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+	libmedia liblog libutils libbinder
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= playerbench
+
+include $(BUILD_EXECUTABLE)
+
+################################################################################
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:=         \
+        soundpoolbench.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+	libmedia liblog libutils libbinder
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= soundpoolbench
+
+include $(BUILD_EXECUTABLE)
+
+################################################################################
+
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:=         \
+        soundpoolvoicebench.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+	libmedia liblog libutils libbinder
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= soundpoolvoicebench
+
+include $(BUILD_EXECUTABLE)
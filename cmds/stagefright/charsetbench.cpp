@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "charsetbench"
+#include <utils/Log.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <media/CharacterEncodingDetector.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
+using namespace android;
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-n <repetitions>] [-v] <corpus>\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -n passes over the corpus (default 100)\n");
+    fprintf(stderr, "       -v print the converted tags of the first pass\n");
+    fprintf(stderr, "The corpus holds one 'name=value' line per tag, in the tag's\n"
+                    "native encoding, with the tag sets of different files\n"
+                    "separated by empty lines.\n");
+
+    exit(1);
+}
+
+static int64_t getNowUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return (int64_t)tv.tv_usec + tv.tv_sec * 1000000ll;
+}
+
+struct TagSet {
+    Vector<String8> mNames;
+    Vector<String8> mValues;
+};
+
+static bool loadCorpus(const char *path, Vector<TagSet> *tagSets, size_t *numBytes) {
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "unable to open %s\n", path);
+        return false;
+    }
+
+    *numBytes = 0;
+    TagSet tagSet;
+    char line[4096];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        size_t len = strlen(line);
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) {
+            line[--len] = '\0';
+        }
+
+        if (len == 0) {
+            if (!tagSet.mNames.isEmpty()) {
+                tagSets->push(tagSet);
+                tagSet = TagSet();
+            }
+            continue;
+        }
+
+        char *separator = strchr(line, '=');
+        if (separator == NULL) {
+            continue;
+        }
+        *separator = '\0';
+        tagSet.mNames.push(String8(line));
+        tagSet.mValues.push(String8(separator + 1));
+        *numBytes += strlen(separator + 1);
+    }
+    if (!tagSet.mNames.isEmpty()) {
+        tagSets->push(tagSet);
+    }
+
+    fclose(file);
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    int numRepetitions = 100;
+    bool verbose = false;
+
+    int res;
+    while ((res = getopt(argc, argv, "h?n:v")) >= 0) {
+        switch (res) {
+            case 'n':
+                numRepetitions = atoi(optarg);
+                break;
+            case 'v':
+                verbose = true;
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+
+    argc -= optind;
+    argv += optind;
+
+    if (argc != 1 || numRepetitions <= 0) {
+        usage(me);
+    }
+
+    Vector<TagSet> tagSets;
+    size_t numBytes;
+    if (!loadCorpus(argv[0], &tagSets, &numBytes) || tagSets.isEmpty()) {
+        fprintf(stderr, "no tags in %s\n", argv[0]);
+        return 1;
+    }
+
+    size_t numDetections = 0;
+    int64_t startUs = getNowUs();
+    for (int rep = 0; rep < numRepetitions; ++rep) {
+        for (size_t i = 0; i < tagSets.size(); ++i) {
+            const TagSet &tagSet = tagSets[i];
+
+            CharacterEncodingDetector detector;
+            for (size_t j = 0; j < tagSet.mNames.size(); ++j) {
+                detector.addTag(tagSet.mNames[j].string(), tagSet.mValues[j].string());
+            }
+            detector.detectAndConvert();
+            numDetections += detector.numDetections();
+
+            if (verbose && rep == 0) {
+                for (size_t j = 0; j < detector.size(); ++j) {
+                    const char *name;
+                    const char *value;
+                    detector.getTag(j, &name, &value);
+                    printf("%s=%s\n", name, value);
+                }
+                printf("\n");
+            }
+        }
+    }
+    int64_t durationUs = getNowUs() - startUs;
+
+    size_t numTagSets = tagSets.size() * numRepetitions;
+    printf("%zu tag sets (%zu bytes) x %d in %.1f ms\n",
+           tagSets.size(), numBytes, numRepetitions, durationUs / 1E3);
+    printf("%.1f tag sets/s, %.2f MB/s, %.2f ICU detections per tag set\n",
+           numTagSets * 1E6 / durationUs,
+           (double)numBytes * numRepetitions / durationUs,
+           (double)numDetections / numTagSets);
+
+    return 0;
+}
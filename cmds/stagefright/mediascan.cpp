@@ -0,0 +1,254 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "mediascan"
+#include <utils/Log.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <binder/ProcessState.h>
+#include <media/stagefright/StagefrightMediaScanner.h>
+
+using namespace android;
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-n <number of files>] [-w <number of workers>]"
+                    " <tree root> <sample file>...\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -n files to put in the synthetic tree (default 1000)\n");
+    fprintf(stderr, "       -w worker threads for the parallel scan (default 4)\n");
+    fprintf(stderr, "Builds a tree of copies of the sample files under <tree root>\n"
+                    "and times a sequential scan, a parallel scan without a\n"
+                    "journal and an incremental rescan with the journal.\n");
+
+    exit(1);
+}
+
+static int64_t getNowUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return (int64_t)tv.tv_usec + tv.tv_sec * 1000000ll;
+}
+
+// Behaves like the framework's client: processes each file as it is reported.
+class SequentialClient : public MediaScannerClient {
+public:
+    SequentialClient(MediaScanner *scanner)
+        : mScanner(scanner), mNumFiles(0), mNumTags(0) {}
+
+    virtual status_t scanFile(const char* path, long long /* lastModified */,
+            long long /* fileSize */, bool isDirectory, bool /* noMedia */) {
+        if (!isDirectory) {
+            ++mNumFiles;
+            mScanner->processFile(path, NULL, *this);
+        }
+        return OK;
+    }
+
+    virtual status_t handleStringTag(const char* /* name */, const char* /* value */) {
+        ++mNumTags;
+        return OK;
+    }
+
+    virtual status_t setMimeType(const char* /* mimeType */) {
+        return OK;
+    }
+
+    size_t numFiles() const { return mNumFiles; }
+    size_t numTags() const { return mNumTags; }
+
+private:
+    MediaScanner *mScanner;
+    size_t mNumFiles;
+    size_t mNumTags;
+};
+
+// Consumes the batches produced by a parallel scan.
+class BatchClient : public MediaScannerClient {
+public:
+    BatchClient() : mNumFiles(0), mNumTags(0), mNumBatches(0) {}
+
+    virtual status_t scanFile(const char* /* path */, long long /* lastModified */,
+            long long /* fileSize */, bool /* isDirectory */, bool /* noMedia */) {
+        return OK;
+    }
+
+    virtual status_t handleStringTag(const char* /* name */, const char* /* value */) {
+        return OK;
+    }
+
+    virtual status_t setMimeType(const char* /* mimeType */) {
+        return OK;
+    }
+
+    virtual bool handlesScannedFiles() const {
+        return true;
+    }
+
+    virtual status_t handleScannedFiles(const Vector<MediaScanFileResult> &files) {
+        ++mNumBatches;
+        mNumFiles += files.size();
+        for (size_t i = 0; i < files.size(); ++i) {
+            mNumTags += files[i].mTagNames.size();
+        }
+        return OK;
+    }
+
+    size_t numFiles() const { return mNumFiles; }
+    size_t numTags() const { return mNumTags; }
+    size_t numBatches() const { return mNumBatches; }
+
+private:
+    size_t mNumFiles;
+    size_t mNumTags;
+    size_t mNumBatches;
+};
+
+static bool copyFile(const char *from, const char *to) {
+    if (link(from, to) == 0) {
+        return true;
+    }
+
+    int in = open(from, O_RDONLY);
+    if (in < 0) {
+        return false;
+    }
+    int out = open(to, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out < 0) {
+        close(in);
+        return false;
+    }
+
+    char buffer[65536];
+    ssize_t n;
+    bool ok = true;
+    while ((n = read(in, buffer, sizeof(buffer))) > 0) {
+        if (write(out, buffer, n) != n) {
+            ok = false;
+            break;
+        }
+    }
+
+    close(out);
+    close(in);
+    return ok && n == 0;
+}
+
+// Spreads copies of the samples over directories of 100 files each.
+static bool buildTree(const char *root, int numFiles, int numSamples, char **samples) {
+    mkdir(root, 0755);
+
+    for (int i = 0; i < numFiles; ++i) {
+        char dir[PATH_MAX];
+        snprintf(dir, sizeof(dir), "%s/d%04d", root, i / 100);
+        if (i % 100 == 0) {
+            mkdir(dir, 0755);
+        }
+
+        const char *sample = samples[i % numSamples];
+        const char *extension = strrchr(sample, '.');
+
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/f%06d%s", dir, i, extension ? extension : "");
+        if (access(path, F_OK) != 0 && !copyFile(sample, path)) {
+            fprintf(stderr, "unable to create %s\n", path);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void report(const char *name, int64_t durationUs, size_t numFiles, size_t numTags) {
+    printf("%-20s %8.1f ms  %7zu files processed  %8zu tags  %8.1f files/s\n",
+           name, durationUs / 1E3, numFiles, numTags,
+           numFiles > 0 ? numFiles * 1E6 / durationUs : 0.0);
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    int numFiles = 1000;
+    int numWorkers = 4;
+
+    int res;
+    while ((res = getopt(argc, argv, "h?n:w:")) >= 0) {
+        switch (res) {
+            case 'n':
+                numFiles = atoi(optarg);
+                break;
+            case 'w':
+                numWorkers = atoi(optarg);
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 2 || numFiles <= 0 || numWorkers <= 0) {
+        usage(me);
+    }
+
+    ProcessState::self()->startThreadPool();
+
+    const char *root = argv[0];
+    if (!buildTree(root, numFiles, argc - 1, argv + 1)) {
+        return 1;
+    }
+
+    char journalPath[PATH_MAX];
+    snprintf(journalPath, sizeof(journalPath), "%s/.scanjournal", root);
+    unlink(journalPath);
+
+    StagefrightMediaScanner scanner;
+
+    {
+        SequentialClient client(&scanner);
+        int64_t startUs = getNowUs();
+        scanner.processDirectory(root, client);
+        report("sequential", getNowUs() - startUs, client.numFiles(), client.numTags());
+    }
+
+    scanner.setParallelScan(numWorkers, journalPath);
+
+    {
+        BatchClient client;
+        int64_t startUs = getNowUs();
+        scanner.processDirectory(root, client);
+        report("parallel", getNowUs() - startUs, client.numFiles(), client.numTags());
+    }
+
+    {
+        BatchClient client;
+        int64_t startUs = getNowUs();
+        scanner.processDirectory(root, client);
+        report("incremental", getNowUs() - startUs, client.numFiles(), client.numTags());
+    }
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "playerbench"
+#include <utils/Log.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <binder/ProcessState.h>
+#include <media/mediaplayer.h>
+#include <utils/Vector.h>
+
+using namespace android;
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-n <number of players>] [-p] [-w <seconds>] <file>\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -n players to create (default 16)\n");
+    fprintf(stderr, "       -p start and pause every player after preparing it\n");
+    fprintf(stderr, "       -w seconds to wait before the final measurement "
+                    "(default 0)\n");
+    fprintf(stderr, "Prepares the players like an app preloading clips and\n"
+                    "reports the threads and resident memory they add to the\n"
+                    "media server.\n");
+
+    exit(1);
+}
+
+static int64_t getNowUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return (int64_t)tv.tv_usec + tv.tv_sec * 1000000ll;
+}
+
+static pid_t findMediaServer() {
+    DIR *dir = opendir("/proc");
+    if (dir == NULL) {
+        return -1;
+    }
+
+    pid_t pid = -1;
+    struct dirent *ent;
+    while (pid < 0 && (ent = readdir(dir)) != NULL) {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/%s/cmdline", ent->d_name);
+        FILE *file = fopen(path, "r");
+        if (file == NULL) {
+            continue;
+        }
+        char cmdline[256];
+        size_t n = fread(cmdline, 1, sizeof(cmdline) - 1, file);
+        cmdline[n] = '\0';
+        fclose(file);
+
+        if (strstr(cmdline, "mediaserver") != NULL) {
+            pid = atoi(ent->d_name);
+        }
+    }
+    closedir(dir);
+
+    return pid;
+}
+
+struct ProcessStats {
+    int mNumThreads;
+    int mRssKb;
+};
+
+static bool getProcessStats(pid_t pid, ProcessStats *stats) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/status", pid);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return false;
+    }
+
+    stats->mNumThreads = -1;
+    stats->mRssKb = -1;
+    char line[256];
+    while (fgets(line, sizeof(line), file) != NULL) {
+        sscanf(line, "Threads: %d", &stats->mNumThreads);
+        sscanf(line, "VmRSS: %d kB", &stats->mRssKb);
+    }
+    fclose(file);
+
+    return stats->mNumThreads >= 0 && stats->mRssKb >= 0;
+}
+
+static void printStats(const char *label, const ProcessStats &base,
+        const ProcessStats &stats, size_t numPlayers) {
+    printf("%s: %d threads (+%d), %d kB rss (+%d kB)",
+           label, stats.mNumThreads, stats.mNumThreads - base.mNumThreads,
+           stats.mRssKb, stats.mRssKb - base.mRssKb);
+    if (numPlayers > 0) {
+        printf(", per player %.2f threads, %.1f kB",
+               (double)(stats.mNumThreads - base.mNumThreads) / numPlayers,
+               (double)(stats.mRssKb - base.mRssKb) / numPlayers);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    int numPlayers = 16;
+    bool startAndPause = false;
+    int waitSecs = 0;
+
+    int res;
+    while ((res = getopt(argc, argv, "h?n:pw:")) >= 0) {
+        switch (res) {
+            case 'n':
+                numPlayers = atoi(optarg);
+                break;
+            case 'p':
+                startAndPause = true;
+                break;
+            case 'w':
+                waitSecs = atoi(optarg);
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+
+    argc -= optind;
+    argv += optind;
+
+    if (argc != 1 || numPlayers <= 0 || waitSecs < 0) {
+        usage(me);
+    }
+
+    int fd = open(argv[0], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "unable to open %s\n", argv[0]);
+        return 1;
+    }
+
+    pid_t serverPid = findMediaServer();
+    ProcessStats base;
+    if (serverPid < 0 || !getProcessStats(serverPid, &base)) {
+        fprintf(stderr, "unable to find the media server\n");
+        return 1;
+    }
+
+    ProcessState::self()->startThreadPool();
+
+    printStats("idle", base, base, 0);
+
+    Vector<sp<MediaPlayer> > players;
+    int64_t startUs = getNowUs();
+    for (int i = 0; i < numPlayers; ++i) {
+        sp<MediaPlayer> player = new MediaPlayer;
+        status_t err = player->setDataSource(fd, 0, st.st_size);
+        if (err == OK) {
+            err = player->prepare();
+        }
+        if (err == OK && startAndPause) {
+            err = player->start();
+            if (err == OK) {
+                usleep(100000);
+                err = player->pause();
+            }
+        }
+        if (err != OK) {
+            fprintf(stderr, "player %d failed (%d)\n", i, err);
+            break;
+        }
+        players.push(player);
+    }
+    int64_t durationUs = getNowUs() - startUs;
+
+    printf("%zu players prepared in %.1f ms, %.1f ms per player\n",
+           players.size(), durationUs / 1E3,
+           players.isEmpty() ? 0.0 : durationUs / 1E3 / players.size());
+
+    ProcessStats stats;
+    if (getProcessStats(serverPid, &stats)) {
+        printStats("prepared", base, stats, players.size());
+    }
+
+    if (waitSecs > 0) {
+        sleep(waitSecs);
+        if (getProcessStats(serverPid, &stats)) {
+            printStats("waited", base, stats, players.size());
+        }
+    }
+
+    for (size_t i = 0; i < players.size(); ++i) {
+        players.editItemAt(i)->reset();
+        players.editItemAt(i)->disconnect();
+    }
+    players.clear();
+    close(fd);
+
+    return 0;
+}
@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "soundpoolbench"
+#include <utils/Log.h>
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <binder/ProcessState.h>
+#include <media/SoundPool.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+using namespace android;
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-t <threads>] [-r <repeat>] [-c <cache kB>] <file> ...\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -t maximum number of decode threads (default 4)\n");
+    fprintf(stderr, "       -r loads of each file, like a game with many clips "
+                    "(default 8)\n");
+    fprintf(stderr, "       -c also load with a cache bound and play every sample, "
+                    "muted\n");
+    fprintf(stderr, "Loads OGG, MP3, WAV... clips in a SoundPool with 1 to <threads>\n"
+                    "decode threads and reports the load time and decoded size.\n");
+
+    exit(1);
+}
+
+static int64_t getNowUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return (int64_t)tv.tv_usec + tv.tv_sec * 1000000ll;
+}
+
+struct Clip {
+    int mFd;
+    int64_t mLength;
+};
+
+// counts the SAMPLE_LOADED events of a sound pool
+struct LoadWaiter {
+    LoadWaiter() : mLoaded(0), mFailed(0) {}
+
+    static void callback(SoundPoolEvent event, SoundPool* soundPool __unused, void* user) {
+        LoadWaiter *waiter = (LoadWaiter *)user;
+        if (event.mMsg != SoundPoolEvent::SAMPLE_LOADED) {
+            return;
+        }
+        Mutex::Autolock lock(waiter->mLock);
+        if (event.mArg2 != NO_ERROR) {
+            fprintf(stderr, "sample %d failed to load (%d)\n", event.mArg1, event.mArg2);
+            waiter->mFailed++;
+        }
+        waiter->mLoaded++;
+        waiter->mCondition.signal();
+    }
+
+    void wait(size_t count) {
+        Mutex::Autolock lock(mLock);
+        while (mLoaded < count) {
+            mCondition.wait(mLock);
+        }
+    }
+
+    Mutex mLock;
+    Condition mCondition;
+    size_t mLoaded;
+    size_t mFailed;
+};
+
+// loads all the clips, returns the load time or -1 on error
+static int64_t loadAll(SoundPool *soundPool, LoadWaiter *waiter, const Vector<Clip> &clips,
+        int repeat, Vector<int> *sampleIDs) {
+    int64_t startUs = getNowUs();
+    for (int r = 0; r < repeat; ++r) {
+        for (size_t i = 0; i < clips.size(); ++i) {
+            int sampleID = soundPool->load(clips[i].mFd, 0, clips[i].mLength, 1);
+            if (sampleID <= 0) {
+                fprintf(stderr, "load failed\n");
+                return -1;
+            }
+            sampleIDs->push(sampleID);
+        }
+    }
+    waiter->wait(sampleIDs->size());
+    int64_t durationUs = getNowUs() - startUs;
+
+    return waiter->mFailed == 0 ? durationUs : -1;
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    int maxThreads = 4;
+    int repeat = 8;
+    int cacheKb = 0;
+
+    int res;
+    while ((res = getopt(argc, argv, "h?t:r:c:")) >= 0) {
+        switch (res) {
+            case 't':
+                maxThreads = atoi(optarg);
+                break;
+            case 'r':
+                repeat = atoi(optarg);
+                break;
+            case 'c':
+                cacheKb = atoi(optarg);
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+
+    argc -= optind;
+    argv += optind;
+
+    if (argc < 1 || maxThreads <= 0 || repeat <= 0 || cacheKb < 0) {
+        usage(me);
+    }
+
+    Vector<Clip> clips;
+    for (int i = 0; i < argc; ++i) {
+        Clip clip;
+        struct stat st;
+        clip.mFd = open(argv[i], O_RDONLY);
+        if (clip.mFd < 0 || fstat(clip.mFd, &st) != 0) {
+            fprintf(stderr, "unable to open %s\n", argv[i]);
+            return 1;
+        }
+        clip.mLength = st.st_size;
+        clips.push(clip);
+    }
+
+    ProcessState::self()->startThreadPool();
+
+    audio_attributes_t attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.content_type = AUDIO_CONTENT_TYPE_SONIFICATION;
+    attributes.usage = AUDIO_USAGE_GAME;
+
+    bool ok = true;
+    size_t decodedSize = 0;
+    int64_t singleThreadUs = 0;
+    for (int threads = 1; threads <= maxThreads && ok; ++threads) {
+        SoundPool *soundPool = new SoundPool(4, &attributes, threads);
+        LoadWaiter waiter;
+        soundPool->setCallback(LoadWaiter::callback, &waiter);
+        // no bound, whatever media.soundpool.cache_kb is
+        soundPool->setMaxCacheSize(0);
+
+        Vector<int> sampleIDs;
+        int64_t durationUs = loadAll(soundPool, &waiter, clips, repeat, &sampleIDs);
+        size_t size = soundPool->cacheSize();
+        if (durationUs < 0) {
+            ok = false;
+        } else {
+            if (threads == 1) {
+                singleThreadUs = durationUs;
+                decodedSize = size;
+            }
+            printf("%d threads: %zu samples loaded in %.1f ms, %.2f ms per sample, "
+                   "speedup %.2f, %zu kB decoded\n",
+                   threads, sampleIDs.size(), durationUs / 1E3,
+                   durationUs / 1E3 / sampleIDs.size(),
+                   durationUs > 0 ? (double)singleThreadUs / durationUs : 0.0, size / 1024);
+            if (size != decodedSize) {
+                fprintf(stderr, "decoded size %zu differs from %zu with one thread\n",
+                        size, decodedSize);
+                ok = false;
+            }
+        }
+        delete soundPool;
+    }
+
+    if (ok && cacheKb > 0) {
+        size_t maxCacheSize = (size_t)cacheKb * 1024;
+        SoundPool *soundPool = new SoundPool(4, &attributes, maxThreads);
+        LoadWaiter waiter;
+        soundPool->setCallback(LoadWaiter::callback, &waiter);
+        soundPool->setMaxCacheSize(maxCacheSize);
+
+        Vector<int> sampleIDs;
+        int64_t durationUs = loadAll(soundPool, &waiter, clips, repeat, &sampleIDs);
+        size_t size = soundPool->cacheSize();
+        // the last loaded or played sample is kept even if alone above the bound,
+        // one decoded copy of each clip is at least as large
+        size_t slack = decodedSize / repeat;
+        if (durationUs < 0 || size > maxCacheSize + slack) {
+            fprintf(stderr, "cache size %zu above %zu after loading\n", size, maxCacheSize);
+            ok = false;
+        } else {
+            printf("cache %d kB: %zu samples loaded in %.1f ms, %zu kB cached\n",
+                   cacheKb, sampleIDs.size(), durationUs / 1E3, size / 1024);
+        }
+
+        // play every sample muted, evicted ones are decoded again
+        int64_t startUs = getNowUs();
+        for (size_t i = 0; ok && i < sampleIDs.size(); ++i) {
+            int channelID = soundPool->play(sampleIDs[i], 0.0f, 0.0f, 1, 0, 1.0f);
+            if (channelID == 0) {
+                fprintf(stderr, "sample %d did not play\n", sampleIDs[i]);
+                ok = false;
+                break;
+            }
+            soundPool->stop(channelID);
+        }
+        if (ok) {
+            durationUs = getNowUs() - startUs;
+            soundPool->setMaxCacheSize(maxCacheSize);
+            size = soundPool->cacheSize();
+            printf("cache %d kB: %zu samples played in %.1f ms, %.2f ms per play, "
+                   "%zu kB cached\n", cacheKb, sampleIDs.size(), durationUs / 1E3,
+                   durationUs / 1E3 / sampleIDs.size(), size / 1024);
+            if (size > maxCacheSize + slack) {
+                fprintf(stderr, "cache size %zu above %zu after playing\n", size, maxCacheSize);
+                ok = false;
+            }
+        }
+        delete soundPool;
+    }
+
+    for (size_t i = 0; i < clips.size(); ++i) {
+        close(clips[i].mFd);
+    }
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "soundpoolvoicebench"
+#include <utils/Log.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <binder/ProcessState.h>
+#include <media/SoundPool.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+using namespace android;
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-v <voices>,...] [-w <seconds>] [-g <gain>] <file>\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -v numbers of simultaneous voices (default 8,32,128)\n");
+    fprintf(stderr, "       -w seconds of playback measured (default 5)\n");
+    fprintf(stderr, "       -g volume of each voice (default 0.01)\n");
+    fprintf(stderr, "Plays the clip looped on many voices, with one AudioTrack per\n"
+                    "voice and with the voices mixed into one AudioTrack, and reports\n"
+                    "the voice start latency and the CPU used here and in the media\n"
+                    "server.\n");
+
+    exit(1);
+}
+
+static int64_t getNowUs() {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+
+    return (int64_t)tv.tv_usec + tv.tv_sec * 1000000ll;
+}
+
+static pid_t findMediaServer() {
+    DIR *dir = opendir("/proc");
+    if (dir == NULL) {
+        return -1;
+    }
+
+    pid_t pid = -1;
+    struct dirent *ent;
+    while (pid < 0 && (ent = readdir(dir)) != NULL) {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/%s/cmdline", ent->d_name);
+        FILE *file = fopen(path, "r");
+        if (file == NULL) {
+            continue;
+        }
+        char cmdline[256];
+        size_t n = fread(cmdline, 1, sizeof(cmdline) - 1, file);
+        cmdline[n] = '\0';
+        fclose(file);
+
+        if (strstr(cmdline, "mediaserver") != NULL) {
+            pid = atoi(ent->d_name);
+        }
+    }
+    closedir(dir);
+
+    return pid;
+}
+
+// user and system CPU time of a process in us, or -1
+static int64_t getProcessCpuUs(pid_t pid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        return -1;
+    }
+    char line[1024];
+    size_t n = fread(line, 1, sizeof(line) - 1, file);
+    line[n] = '\0';
+    fclose(file);
+
+    // skip the command name, which may contain spaces
+    const char *p = strrchr(line, ')');
+    unsigned long utime, stime;
+    if (p == NULL || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+            &utime, &stime) != 2) {
+        return -1;
+    }
+    return (int64_t)(utime + stime) * 1000000ll / sysconf(_SC_CLK_TCK);
+}
+
+static int64_t getSelfCpuUs() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return (int64_t)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000ll +
+            usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+}
+
+struct LoadWaiter {
+    LoadWaiter() : mLoaded(false), mStatus(NO_ERROR) {}
+
+    static void callback(SoundPoolEvent event, SoundPool* soundPool __unused, void* user) {
+        LoadWaiter *waiter = (LoadWaiter *)user;
+        if (event.mMsg != SoundPoolEvent::SAMPLE_LOADED) {
+            return;
+        }
+        Mutex::Autolock lock(waiter->mLock);
+        waiter->mLoaded = true;
+        waiter->mStatus = event.mArg2;
+        waiter->mCondition.signal();
+    }
+
+    status_t wait() {
+        Mutex::Autolock lock(mLock);
+        while (!mLoaded) {
+            mCondition.wait(mLock);
+        }
+        return mStatus;
+    }
+
+    Mutex mLock;
+    Condition mCondition;
+    bool mLoaded;
+    status_t mStatus;
+};
+
+// plays numVoices voices for seconds, returns false on error
+static bool run(bool mixVoices, int numVoices, int seconds, float gain,
+        const audio_attributes_t *attributes, int fd, int64_t length, pid_t serverPid) {
+    SoundPool *soundPool = new SoundPool(numVoices, attributes, 0, mixVoices);
+    LoadWaiter waiter;
+    soundPool->setCallback(LoadWaiter::callback, &waiter);
+    int sampleID = soundPool->load(fd, 0, length, 1);
+    if (waiter.wait() != NO_ERROR) {
+        fprintf(stderr, "unable to load the clip\n");
+        delete soundPool;
+        return false;
+    }
+
+    bool ok = true;
+    Vector<int> channelIDs;
+    int64_t totalUs = 0;
+    int64_t maxUs = 0;
+    for (int i = 0; i < numVoices; ++i) {
+        // spread the rates so that the voices are not in phase
+        float rate = 1.0f + 0.01f * (i % 8);
+        int64_t startUs = getNowUs();
+        int channelID = soundPool->play(sampleID, gain, gain, 1, -1 /* loop */, rate);
+        int64_t latencyUs = getNowUs() - startUs;
+        if (channelID == 0) {
+            fprintf(stderr, "voice %d did not start\n", i);
+            ok = false;
+            break;
+        }
+        channelIDs.push(channelID);
+        totalUs += latencyUs;
+        if (latencyUs > maxUs) {
+            maxUs = latencyUs;
+        }
+    }
+
+    if (ok) {
+        // let the voices settle before measuring
+        usleep(500000);
+        int64_t selfUs = getSelfCpuUs();
+        int64_t serverUs = getProcessCpuUs(serverPid);
+        int64_t startUs = getNowUs();
+        sleep(seconds);
+        int64_t durationUs = getNowUs() - startUs;
+        selfUs = getSelfCpuUs() - selfUs;
+        serverUs = serverUs >= 0 ? getProcessCpuUs(serverPid) - serverUs : -1;
+
+        printf("%-7s %6d %10.1f %10.1f %10.1f%% ", mixVoices ? "mixer" : "tracks", numVoices,
+               (double)totalUs / numVoices, (double)maxUs,
+               100.0 * selfUs / durationUs);
+        if (serverUs >= 0) {
+            printf("%10.1f%%\n", 100.0 * serverUs / durationUs);
+        } else {
+            printf("%11s\n", "-");
+        }
+    }
+
+    for (size_t i = 0; i < channelIDs.size(); ++i) {
+        soundPool->stop(channelIDs[i]);
+    }
+    delete soundPool;
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    const char *voices = "8,32,128";
+    int seconds = 5;
+    float gain = 0.01f;
+
+    int res;
+    while ((res = getopt(argc, argv, "h?v:w:g:")) >= 0) {
+        switch (res) {
+            case 'v':
+                voices = optarg;
+                break;
+            case 'w':
+                seconds = atoi(optarg);
+                break;
+            case 'g':
+                gain = atof(optarg);
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+
+    argc -= optind;
+    argv += optind;
+
+    if (argc != 1 || seconds <= 0 || gain < 0.0f || gain > 1.0f) {
+        usage(me);
+    }
+
+    Vector<int> numVoices;
+    for (const char *p = voices; *p != '\0'; ) {
+        char *end;
+        long n = strtol(p, &end, 10);
+        if (end == p || n <= 0) {
+            usage(me);
+        }
+        numVoices.push((int)n);
+        p = *end == ',' ? end + 1 : end;
+    }
+
+    int fd = open(argv[0], O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        fprintf(stderr, "unable to open %s\n", argv[0]);
+        return 1;
+    }
+
+    ProcessState::self()->startThreadPool();
+
+    audio_attributes_t attributes;
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.content_type = AUDIO_CONTENT_TYPE_SONIFICATION;
+    attributes.usage = AUDIO_USAGE_GAME;
+
+    pid_t serverPid = findMediaServer();
+
+    printf("%-7s %6s %10s %10s %11s %11s\n", "mode", "voices", "start us", "max us",
+           "client cpu", "server cpu");
+    bool ok = true;
+    for (int mix = 0; mix <= 1 && ok; ++mix) {
+        for (size_t i = 0; i < numVoices.size() && ok; ++i) {
+            // without the mixer a sound pool has at most 32 channels
+            if (!mix && numVoices[i] > 32) {
+                printf("%-7s %6d %10s\n", "tracks", numVoices[i], "-");
+                continue;
+            }
+            ok = run(mix != 0, numVoices[i], seconds, gain, &attributes, fd, st.st_size,
+                     serverPid);
+        }
+    }
+    close(fd);
+
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -32,6 +32,7 @@
 #include <media/IMediaHTTPService.h>
 #include <media/IMediaPlayerService.h>
 #include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AMessage.h>
 #include "include/NuCachedSource2.h"
 #include <media/stagefright/AudioPlayer.h>
 #include <media/stagefright/DataSource.h>
@@ -598,6 +599,10 @@ static void usage(const char *me) {
     fprintf(stderr, "       -b bug to reproduce\n");
     fprintf(stderr, "       -p(rofiles) dump decoder profiles supported\n");
     fprintf(stderr, "       -t(humbnail) extract video thumbnail or album art\n");
+    fprintf(stderr, "       -z <width>x<height> with -t, extract thumbnails that fit\n"
+                    "          the given size and report per-thumbnail latency\n");
+    fprintf(stderr, "       -B with -t, compare extracting metadata (and thumbnails\n"
+                    "          with -z) one file per call against a single batch\n");
     fprintf(stderr, "       -s(oftware) prefer software codec\n");
     fprintf(stderr, "       -r(hardware) force to use hardware codec\n");
     fprintf(stderr, "       -o playback audio\n");
@@ -609,6 +614,205 @@ static void usage(const char *me) {
     fprintf(stderr, "       -T allocate buffers from a surface texture\n");
     fprintf(stderr, "       -d(ump) output_filename (raw stream data to a file)\n");
     fprintf(stderr, "       -D(ump) output_filename (decoded PCM data to a file)\n");
+    fprintf(stderr, "       -i(dentify) only sniff the content type, reporting "
+                    "per-sniffer time and bytes read\n");
+}
+
+static const int kBatchBenchmarkKeys[] = {
+    METADATA_KEY_MIMETYPE,
+    METADATA_KEY_DURATION,
+    METADATA_KEY_TITLE,
+    METADATA_KEY_ARTIST,
+    METADATA_KEY_ALBUM,
+    METADATA_KEY_HAS_AUDIO,
+    METADATA_KEY_HAS_VIDEO,
+    METADATA_KEY_VIDEO_WIDTH,
+    METADATA_KEY_VIDEO_HEIGHT,
+};
+
+static void performBatchBenchmark(
+        const sp<IMediaMetadataRetriever> &retriever, int argc, char **argv,
+        int thumbnailWidth, int thumbnailHeight) {
+    const size_t numKeys =
+        sizeof(kBatchBenchmarkKeys) / sizeof(kBatchBenchmarkKeys[0]);
+
+    Vector<MetadataBatchRequest> requests;
+    for (int k = 0; k < argc; ++k) {
+        int fd = open(argv[k], O_RDONLY | O_LARGEFILE);
+        CHECK_GE(fd, 0);
+
+        off64_t fileSize = lseek64(fd, 0, SEEK_END);
+        CHECK_GE(fileSize, 0ll);
+
+        MetadataBatchRequest request;
+        request.mFd = fd;
+        request.mOffset = 0;
+        request.mLength = fileSize;
+        requests.push(request);
+    }
+
+    // One round trip per key and per thumbnail, the way clients do it today.
+    int64_t startUs = getNowUs();
+    size_t numSingleThumbnails = 0;
+    for (size_t i = 0; i < requests.size(); ++i) {
+        const MetadataBatchRequest &request = requests[i];
+        if (retriever->setDataSource(
+                    request.mFd, request.mOffset, request.mLength) != OK) {
+            continue;
+        }
+        for (size_t j = 0; j < numKeys; ++j) {
+            retriever->extractMetadata(kBatchBenchmarkKeys[j]);
+        }
+        if (thumbnailWidth > 0 && retriever->getThumbnailAtTime(
+                    -1, MediaSource::ReadOptions::SEEK_CLOSEST_SYNC,
+                    thumbnailWidth, thumbnailHeight) != NULL) {
+            ++numSingleThumbnails;
+        }
+    }
+    int64_t singleUs = getNowUs() - startUs;
+
+    Vector<int> keyCodes;
+    keyCodes.appendArray(kBatchBenchmarkKeys, numKeys);
+
+    size_t numBatchThumbnails = 0;
+    size_t numFailed = 0;
+    startUs = getNowUs();
+    for (size_t start = 0; start < requests.size();
+            start += IMediaMetadataRetriever::kMaxBatchSize) {
+        size_t count = requests.size() - start;
+        if (count > IMediaMetadataRetriever::kMaxBatchSize) {
+            count = IMediaMetadataRetriever::kMaxBatchSize;
+        }
+        Vector<MetadataBatchRequest> chunk;
+        chunk.appendArray(requests.array() + start, count);
+
+        Vector<MetadataBatchResult> results;
+        CHECK_EQ(retriever->extractMetadataBatch(
+                    chunk, keyCodes, thumbnailWidth, thumbnailHeight, &results),
+                 (status_t)OK);
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (results[i].mStatus != OK) {
+                printf("%s: failed (%d)\n", argv[start + i], results[i].mStatus);
+                ++numFailed;
+                continue;
+            }
+            if (results[i].mThumbnail != NULL) {
+                ++numBatchThumbnails;
+            }
+            ssize_t index = results[i].mMetadata.indexOfKey(METADATA_KEY_MIMETYPE);
+            printf("%s: %s, %zu values%s\n", argv[start + i],
+                   index < 0 ? "?" : results[i].mMetadata.valueAt(index).string(),
+                   results[i].mMetadata.size(),
+                   results[i].mThumbnail != NULL ? ", thumbnail" : "");
+        }
+    }
+    int64_t batchUs = getNowUs() - startUs;
+
+    for (size_t i = 0; i < requests.size(); ++i) {
+        close(requests[i].mFd);
+    }
+
+    printf("one file per call: %zu files, %zu thumbnails in %.2f ms\n",
+           requests.size(), numSingleThumbnails, singleUs / 1E3);
+    printf("batched:           %zu files (%zu failed), %zu thumbnails in %.2f ms\n",
+           requests.size(), numFailed, numBatchThumbnails, batchUs / 1E3);
+}
+
+struct SniffTotals {
+    int64_t mTimeUs;
+    size_t mBytesRequested;
+    size_t mBytesFetched;
+    size_t mNumRuns;
+    size_t mNumSkipped;
+};
+
+// Opens and sniffs each file gNumRepetitions times and prints what each
+// sniffer cost, per file and summed over all files.
+static void performSniffBenchmark(int argc, char **argv) {
+    KeyedVector<String8, SniffTotals> totals;
+    int64_t totalSniffUs = 0;
+    size_t numSniffs = 0;
+
+    for (int k = 0; k < argc; ++k) {
+        const char *filename = argv[k];
+
+        for (long rep = 0; rep < gNumRepetitions; ++rep) {
+            sp<DataSource> dataSource =
+                DataSource::CreateFromURI(NULL /* httpService */, filename);
+
+            if (dataSource == NULL) {
+                fprintf(stderr, "Unable to create data source for '%s'.\n",
+                        filename);
+                break;
+            }
+
+            String8 mimeType;
+            float confidence;
+            sp<AMessage> meta;
+            Vector<DataSource::SniffStat> stats;
+
+            int64_t startUs = getNowUs();
+            dataSource->sniff(&mimeType, &confidence, &meta, &stats);
+            int64_t sniffUs = getNowUs() - startUs;
+
+            totalSniffUs += sniffUs;
+            ++numSniffs;
+
+            if (rep == 0) {
+                printf("%s: '%s' (confidence %.2f) in %" PRId64 " us\n",
+                       filename, mimeType.string(), confidence, sniffUs);
+            }
+
+            for (size_t i = 0; i < stats.size(); ++i) {
+                const DataSource::SniffStat &stat = stats.itemAt(i);
+
+                if (rep == 0) {
+                    if (stat.mSkipped) {
+                        printf("  %-10s skipped\n", stat.mName);
+                    } else {
+                        printf("  %-10s %8" PRId64 " us %8zu bytes requested "
+                               "%8zu bytes fetched%s\n",
+                               stat.mName, stat.mTimeUs, stat.mBytesRequested,
+                               stat.mBytesFetched,
+                               stat.mConfidence > 0.0f ? " (match)" : "");
+                    }
+                }
+
+                ssize_t index = totals.indexOfKey(String8(stat.mName));
+                if (index < 0) {
+                    SniffTotals empty;
+                    memset(&empty, 0, sizeof(empty));
+                    index = totals.add(String8(stat.mName), empty);
+                }
+
+                SniffTotals &total = totals.editValueAt(index);
+                if (stat.mSkipped) {
+                    ++total.mNumSkipped;
+                } else {
+                    ++total.mNumRuns;
+                    total.mTimeUs += stat.mTimeUs;
+                    total.mBytesRequested += stat.mBytesRequested;
+                    total.mBytesFetched += stat.mBytesFetched;
+                }
+            }
+        }
+    }
+
+    if (numSniffs == 0) {
+        return;
+    }
+
+    printf("%zu sniffs, avg. %.2f ms per sniff\n",
+           numSniffs, totalSniffUs / (1E3 * numSniffs));
+
+    for (size_t i = 0; i < totals.size(); ++i) {
+        const SniffTotals &total = totals.valueAt(i);
+        printf("  %-10s ran %6zu skipped %6zu total %10" PRId64 " us "
+               "%12zu bytes requested %12zu bytes fetched\n",
+               totals.keyAt(i).string(), total.mNumRuns, total.mNumSkipped,
+               total.mTimeUs, total.mBytesRequested, total.mBytesFetched);
+    }
 }
 
 static void dumpCodecProfiles(const sp<IOMX>& omx, bool queryDecoders) {
@@ -667,6 +871,10 @@ int main(int argc, char **argv) {
     bool useSurfaceTexAlloc = false;
     bool dumpStream = false;
     bool dumpPCMStream = false;
+    bool sniffOnly = false;
+    bool batchExtract = false;
+    int thumbnailWidth = 0;
+    int thumbnailHeight = 0;
     String8 dumpStreamFilename;
     gNumRepetitions = 1;
     gMaxNumFrames = 0;
@@ -680,7 +888,7 @@ int main(int argc, char **argv) {
     sp<ALooper> looper;
 
     int res;
-    while ((res = getopt(argc, argv, "han:lm:b:ptsrow:kxSTd:D:")) >= 0) {
+    while ((res = getopt(argc, argv, "han:lm:b:ptsrow:kxSTd:D:iz:B")) >= 0) {
         switch (res) {
             case 'a':
             {
@@ -792,6 +1000,28 @@ int main(int argc, char **argv) {
                 break;
             }
 
+            case 'i':
+            {
+                sniffOnly = true;
+                break;
+            }
+
+            case 'B':
+            {
+                batchExtract = true;
+                break;
+            }
+
+            case 'z':
+            {
+                if (sscanf(optarg, "%dx%d", &thumbnailWidth, &thumbnailHeight) != 2
+                        || thumbnailWidth <= 0 || thumbnailHeight <= 0) {
+                    usage(argv[0]);
+                    exit(1);
+                }
+                break;
+            }
+
             case '?':
             case 'h':
             default:
@@ -811,6 +1041,12 @@ int main(int argc, char **argv) {
     argc -= optind;
     argv += optind;
 
+    if (sniffOnly) {
+        DataSource::RegisterDefaultSniffers();
+        performSniffBenchmark(argc, argv);
+        return 0;
+    }
+
     if (extractThumbnail) {
         sp<IServiceManager> sm = defaultServiceManager();
         sp<IBinder> binder = sm->getService(String16("media.player"));
@@ -824,6 +1060,15 @@ int main(int argc, char **argv) {
 
         CHECK(retriever != NULL);
 
+        if (batchExtract) {
+            performBatchBenchmark(
+                    retriever, argc, argv, thumbnailWidth, thumbnailHeight);
+            return 0;
+        }
+
+        int64_t totalThumbnailUs = 0;
+        size_t numThumbnails = 0;
+
         for (int k = 0; k < argc; ++k) {
             const char *filename = argv[k];
 
@@ -840,9 +1085,31 @@ int main(int argc, char **argv) {
             close(fd);
             fd = -1;
 
-            sp<IMemory> mem =
-                    retriever->getFrameAtTime(-1,
-                                    MediaSource::ReadOptions::SEEK_PREVIOUS_SYNC);
+            sp<IMemory> mem;
+            if (thumbnailWidth > 0) {
+                // Repeated requests on the same file reuse the decoder.
+                for (long rep = 0; rep < gNumRepetitions; ++rep) {
+                    int64_t startUs = getNowUs();
+                    mem = retriever->getThumbnailAtTime(
+                            -1, MediaSource::ReadOptions::SEEK_PREVIOUS_SYNC,
+                            thumbnailWidth, thumbnailHeight);
+                    int64_t delayUs = getNowUs() - startUs;
+
+                    if (mem == NULL) {
+                        break;
+                    }
+
+                    totalThumbnailUs += delayUs;
+                    ++numThumbnails;
+
+                    VideoFrame *frame = (VideoFrame *)mem->pointer();
+                    printf("getThumbnailAtTime(%s) => %ux%u in %.2f ms\n",
+                           filename, frame->mWidth, frame->mHeight, delayUs / 1E3);
+                }
+            } else {
+                mem = retriever->getFrameAtTime(-1,
+                                MediaSource::ReadOptions::SEEK_PREVIOUS_SYNC);
+            }
 
             if (mem != NULL) {
                 failed = false;
@@ -870,6 +1137,12 @@ int main(int argc, char **argv) {
             }
         }
 
+        if (numThumbnails > 0) {
+            printf("%zu thumbnails, avg. %.2f ms per thumbnail, %.2f thumbnails/sec\n",
+                   numThumbnails, totalThumbnailUs / (1E3 * numThumbnails),
+                   numThumbnails * 1E6 / totalThumbnailUs);
+        }
+
         return 0;
     }
 
@@ -403,6 +403,10 @@ protected:
      int32_t                 mId;                // system wide unique effect engine instance ID
      Mutex                   mLock;               // Mutex for mEnabled access
 
+     // shared memory the effect engine publishes its results into, see
+     // IEffect::getDataMemory()
+     sp<IMemory>             getDataMemory(uint32_t size);
+
      // IEffectClient
      virtual void controlStatusChanged(bool controlGranted);
      virtual void enableStatusChanged(bool enabled);
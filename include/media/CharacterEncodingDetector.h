@@ -39,6 +39,10 @@ class CharacterEncodingDetector {
         void detectAndConvert();
         status_t getTag(int index, const char **name, const char**value);
 
+        // number of times detectAndConvert() had to fall back to ICU detection,
+        // as opposed to settling on an encoding from the byte statistics alone.
+        size_t numDetections() const { return mNumDetections; }
+
     private:
         const UCharsetMatch *getPreferred(
                 const char *input, size_t len,
@@ -54,6 +58,7 @@ class CharacterEncodingDetector {
         StringArray     mValues;
 
         UConverter*     mUtf8Conv;
+        size_t          mNumDetections;
 };
 
 
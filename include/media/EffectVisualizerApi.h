@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_EFFECTVISUALIZERAPI_H_
+#define ANDROID_EFFECTVISUALIZERAPI_H_
+
+#include <stdint.h>
+#include <audio_effects/effect_visualizer.h>
+
+#if __cplusplus
+extern "C" {
+#endif
+
+/////////////////////////////////////////////////
+//      Float capture and spectrum extensions of the visualizer effect
+/////////////////////////////////////////////////
+
+// The values below extend audio_effects/effect_visualizer.h. They are offset from the
+// base definitions so that they do not collide with values added there later.
+
+// range of the float capture size and of the spectrum window size, in samples.
+// Both must be powers of two.
+#define VISUALIZER_FLOAT_CAPTURE_SIZE_MAX 8192
+#define VISUALIZER_FLOAT_CAPTURE_SIZE_MIN 128
+#define VISUALIZER_SPECTRUM_SIZE_MAX 8192
+#define VISUALIZER_SPECTRUM_SIZE_MIN 128
+
+// maximum number of windows averaged into one published spectrum
+#define VISUALIZER_SPECTRUM_AVERAGING_MAX 16
+
+// maximum number of shared spectrum buffers registered at the same time on one effect
+#define VISUALIZER_SPECTRUM_BUFFERS_MAX 4
+
+enum {
+    // number of mono float samples returned by VISUALIZER_CMD_CAPTURE_FLOAT, 0 when disabled
+    VISUALIZER_PARAM_FLOAT_CAPTURE_SIZE = 0x100,
+    // size of the analysis window of the spectrum in samples, 0 when disabled
+    VISUALIZER_PARAM_SPECTRUM_SIZE,
+    // overlap of consecutive windows in percent of the window size: 0, 50 or 75
+    VISUALIZER_PARAM_SPECTRUM_OVERLAP,
+    // number of consecutive windows whose power is averaged into one published spectrum
+    VISUALIZER_PARAM_SPECTRUM_AVERAGING,
+};
+
+// Command VISUALIZER_CMD_CAPTURE_FLOAT returns the last VISUALIZER_PARAM_FLOAT_CAPTURE_SIZE
+// mono samples played, as floats in [-1.0, 1.0] not affected by the scaling mode.
+//  Command format:
+//      size: 0
+//      data: N/A
+//  Reply format:
+//      size: VISUALIZER_PARAM_FLOAT_CAPTURE_SIZE * sizeof(float)
+//      data: float samples
+#define VISUALIZER_CMD_CAPTURE_FLOAT (EFFECT_CMD_FIRST_PROPRIETARY + 0x100)
+
+// Command VISUALIZER_CMD_SET_SPECTRUM_BUFFER registers (size > 0) or unregisters (size 0)
+// a buffer the effect publishes its spectra into. It is sent by the framework with a buffer
+// in shared memory and must not be accepted from applications.
+//  Command format:
+//      size: sizeof(visualizer_spectrum_buffer_t)
+//      data: visualizer_spectrum_buffer_t
+//  Reply format:
+//      size: sizeof(int)
+//      data: status
+#define VISUALIZER_CMD_SET_SPECTRUM_BUFFER (EFFECT_CMD_FIRST_PROPRIETARY + 0x101)
+
+// Header of a shared spectrum buffer, followed by the magnitude of binCount bins from DC to
+// half the sampling rate. A full scale sine at the center of a bin reads 1.0 in that bin.
+// The effect increments sequence before and after writing a spectrum, so a reader must
+// retry while it is odd or when it changed during the copy.
+typedef struct visualizer_spectrum_cblk_s {
+    volatile int32_t sequence;  // even when stable, 0 until the first spectrum
+    uint32_t binCount;          // window size / 2 + 1
+    uint32_t samplingRate;      // in Hz
+    uint32_t windowCount;       // number of windows averaged
+    uint32_t costNs;            // CPU time the effect spent computing this spectrum
+    uint32_t reserved[3];
+    float bins[];
+} visualizer_spectrum_cblk_t;
+
+// Size of a shared spectrum buffer for a window size
+#define VISUALIZER_SPECTRUM_BUFFER_SIZE(windowSize) \
+        (sizeof(visualizer_spectrum_cblk_t) + ((windowSize) / 2 + 1) * sizeof(float))
+
+typedef struct visualizer_spectrum_buffer_s {
+    visualizer_spectrum_cblk_t *cblk;
+    uint32_t size;              // in bytes, including the header
+} visualizer_spectrum_buffer_t;
+
+#if __cplusplus
+}  // extern "C"
+#endif
+
+#endif /*ANDROID_EFFECTVISUALIZERAPI_H_*/
@@ -42,6 +42,11 @@ public:
     virtual void disconnect() = 0;
 
     virtual sp<IMemory> getCblk() const = 0;
+
+    // Returns shared memory of at least size bytes that the effect engine publishes its
+    // results into, so that they are read without a binder call per result. Only the
+    // visualizer supports it, for its spectra. Returns 0 if not supported or on error.
+    virtual sp<IMemory> getDataMemory(uint32_t size) = 0;
 };
 
 // ----------------------------------------------------------------------------
@@ -23,15 +23,39 @@
 #include <binder/IMemory.h>
 #include <utils/KeyedVector.h>
 #include <utils/RefBase.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
 
 namespace android {
 
 struct IMediaHTTPService;
 
+// One file of an extractMetadataBatch() request.
+struct MetadataBatchRequest {
+    int mFd;
+    int64_t mOffset;
+    int64_t mLength;
+};
+
+// The outcome for one file of an extractMetadataBatch() request. mMetadata
+// only holds the requested keys the file has a value for; mThumbnail is a
+// VideoFrame, or NULL if no thumbnail was asked for or none could be made.
+struct MetadataBatchResult {
+    status_t mStatus;
+    KeyedVector<int, String8> mMetadata;
+    sp<IMemory> mThumbnail;
+};
+
 class IMediaMetadataRetriever: public IInterface
 {
 public:
     DECLARE_META_INTERFACE(MediaMetadataRetriever);
+
+    enum {
+        // Upper bound on the number of files in one extractMetadataBatch() call.
+        kMaxBatchSize = 64,
+    };
+
     virtual void            disconnect() = 0;
 
     virtual status_t        setDataSource(
@@ -41,8 +65,22 @@ public:
 
     virtual status_t        setDataSource(int fd, int64_t offset, int64_t length) = 0;
     virtual sp<IMemory>     getFrameAtTime(int64_t timeUs, int option) = 0;
+    virtual sp<IMemory>     getThumbnailAtTime(
+            int64_t timeUs, int option, int maxWidth, int maxHeight) = 0;
     virtual sp<IMemory>     extractAlbumArt() = 0;
     virtual const char*     extractMetadata(int keyCode) = 0;
+
+    // Extracts the metadata for keyCodes, and a thumbnail no larger than
+    // thumbnailMaxWidth x thumbnailMaxHeight unless either is 0, from each
+    // of the requested files in one call. This leaves the data source set
+    // through setDataSource() untouched. Returns BAD_VALUE if there are more
+    // than kMaxBatchSize requests; per file failures are reported in
+    // MetadataBatchResult::mStatus.
+    virtual status_t        extractMetadataBatch(
+            const Vector<MetadataBatchRequest> &requests,
+            const Vector<int> &keyCodes,
+            int thumbnailMaxWidth, int thumbnailMaxHeight,
+            Vector<MetadataBatchResult> *results) = 0;
 };
 
 // ----------------------------------------------------------------------------
@@ -41,6 +41,11 @@ public:
 
     virtual status_t    setDataSource(int fd, int64_t offset, int64_t length) = 0;
     virtual VideoFrame* getFrameAtTime(int64_t timeUs, int option) = 0;
+
+    // Like getFrameAtTime(), but the frame is only decoded from a sync sample
+    // and scaled down to fit within maxWidth x maxHeight.
+    virtual VideoFrame* getThumbnailAtTime(
+            int64_t timeUs, int option, int maxWidth, int maxHeight) = 0;
     virtual MediaAlbumArt* extractAlbumArt() = 0;
     virtual const char* extractMetadata(int keyCode) = 0;
 };
@@ -53,6 +58,10 @@ public:
 
     virtual             ~MediaMetadataRetrieverInterface() {}
     virtual VideoFrame* getFrameAtTime(int64_t timeUs, int option) { return NULL; }
+    virtual VideoFrame* getThumbnailAtTime(
+            int64_t timeUs, int option, int /* maxWidth */, int /* maxHeight */) {
+        return getFrameAtTime(timeUs, option);
+    }
     virtual MediaAlbumArt* extractAlbumArt() { return NULL; }
     virtual const char* extractMetadata(int keyCode) { return NULL; }
 };
@@ -21,6 +21,7 @@
 #include <utils/List.h>
 #include <utils/Vector.h>
 #include <utils/KeyedVector.h>
+#include <utils/SortedVector.h>
 #include <media/AudioTrack.h>
 #include <binder/MemoryHeapBase.h>
 #include <binder/MemoryBase.h>
@@ -32,6 +33,7 @@ static const int IDLE_PRIORITY = -1;
 // forward declarations
 class SoundEvent;
 class SoundPoolThread;
+class SoundPoolMixer;
 class SoundPool;
 
 // for queued events
@@ -51,7 +53,8 @@ typedef void SoundPoolCallback(SoundPoolEvent event, SoundPool* soundPool, void*
 // tracks samples used by application
 class Sample  : public RefBase {
 public:
-    enum sample_state { UNLOADED, LOADING, READY, UNLOADING };
+    // EVICTED: the decoded data was dropped to bound the cache, it is decoded again on play
+    enum sample_state { UNLOADED, LOADING, READY, UNLOADING, EVICTED };
     Sample(int sampleID, const char* url);
     Sample(int sampleID, int fd, int64_t offset, int64_t length);
     ~Sample();
@@ -63,9 +66,19 @@ public:
     int state() { return mState; }
     uint8_t* data() { return static_cast<uint8_t*>(mData->pointer()); }
     status_t doLoad();
+    status_t doLoad(sp<MemoryHeapBase>& decodeHeap);
     void startLoad() { mState = LOADING; }
     sp<IMemory> getIMemory() { return mData; }
 
+    // decoded data cache, called with the sound pool lock held
+    void keepSource() { mKeepSource = true; }
+    bool canEvict() { return mState == READY && (mUrl != NULL || mFd >= 0); }
+    size_t evict();
+    size_t cachedSize() { return mCachedSize; }
+    void setCachedSize(size_t cachedSize) { mCachedSize = cachedSize; }
+    uint32_t lastUsed() { return mLastUsed; }
+    void setLastUsed(uint32_t lastUsed) { mLastUsed = lastUsed; }
+
     // hack
     void init(int numChannels, int sampleRate, audio_format_t format, size_t size,
             sp<IMemory> data ) {
@@ -88,6 +101,9 @@ private:
     char*               mUrl;
     sp<IMemory>         mData;
     sp<MemoryHeapBase>  mHeap;
+    bool                mKeepSource;    // keep mFd open to decode again after an eviction
+    size_t              mCachedSize;    // bytes counted in the sound pool cache
+    uint32_t            mLastUsed;      // sound pool cache clock at the last load or play
 };
 
 // stores pending events for stolen channels
@@ -121,7 +137,7 @@ protected:
 class SoundChannel : public SoundEvent {
 public:
     enum state { IDLE, RESUMING, STOPPING, PAUSED, PLAYING };
-    SoundChannel() : mState(IDLE), mNumChannels(1),
+    SoundChannel() : mMixer(NULL), mState(IDLE), mNumChannels(1),
             mPos(0), mToggle(0), mAutoPaused(false) {}
     ~SoundChannel();
     void init(SoundPool* soundPool);
@@ -143,6 +159,7 @@ public:
     void clearNextEvent() { mNextEvent.clear(); }
     void nextEvent();
     int nextChannelID() { return mNextEvent.channelID(); }
+    sp<Sample> nextSample() { return mNextEvent.sample(); }
     void dump();
 
 private:
@@ -151,6 +168,7 @@ private:
     bool doStop_l();
 
     SoundPool*          mSoundPool;
+    SoundPoolMixer*     mMixer;         // mixes this channel instead of mAudioTrack if not NULL
     sp<AudioTrack>      mAudioTrack;
     SoundEvent          mNextEvent;
     Mutex               mLock;
@@ -166,8 +184,13 @@ private:
 class SoundPool {
     friend class SoundPoolThread;
     friend class SoundChannel;
+    friend class SoundPoolMixer;
 public:
-    SoundPool(int maxChannels, const audio_attributes_t* pAttributes);
+    // decodeThreads 0 selects one decode thread per CPU, up to kMaxDecodeThreads.
+    // mixVoices, or property "media.soundpool.mixer", mixes all the channels into a single
+    // AudioTrack and allows up to kMaxMixerVoices channels.
+    SoundPool(int maxChannels, const audio_attributes_t* pAttributes, int decodeThreads = 0,
+            bool mixVoices = false);
     ~SoundPool();
     int load(const char* url, int priority);
     int load(int fd, int64_t offset, int64_t length, int priority);
@@ -185,6 +208,11 @@ public:
     void setRate(int channelID, float rate);
     const audio_attributes_t* attributes() { return &mAttributes; }
 
+    // bound the decoded data of all samples, 0 for no bound. Least recently played samples
+    // which are not playing are evicted above the bound and decoded again when played.
+    void setMaxCacheSize(size_t maxCacheSize);
+    size_t cacheSize();
+
     // called from SoundPoolThread
     void sampleLoaded(int sampleID);
 
@@ -197,12 +225,17 @@ public:
 
 private:
     SoundPool() {} // no default constructor
-    bool startThreads();
+    bool startThreads(int decodeThreads);
     void doLoad(sp<Sample>& sample);
-    sp<Sample> findSample(int sampleID) { return mSamples.valueFor(sampleID); }
+    void reloadSample(int sampleID);
+    bool isPlaying_l(const sp<Sample>& sample);
+    void trimCache_l(const sp<Sample>& keep);
+    sp<Sample> findSample(int sampleID);
+    sp<Sample> findSample_l(int sampleID) { return mSamples.valueFor(sampleID); }
     SoundChannel* findChannel (int channelID);
     SoundChannel* findNextChannel (int channelID);
     SoundChannel* allocateChannel_l(int priority);
+    SoundPoolMixer* mixer() { return mMixer; }
     void moveToFront_l(SoundChannel* channel);
     void notify(SoundPoolEvent event);
     void dump();
@@ -210,6 +243,7 @@ private:
     // restart thread
     void addToRestartList(SoundChannel* channel);
     void addToStopList(SoundChannel* channel);
+    void mixerIdle();
     static int beginThread(void* arg);
     int run();
     void quit();
@@ -218,6 +252,7 @@ private:
     Mutex                   mRestartLock;
     Condition               mCondition;
     SoundPoolThread*        mDecodeThread;
+    SoundPoolMixer*         mMixer;
     SoundChannel*           mChannelPool;
     List<SoundChannel*>     mChannels;
     List<SoundChannel*>     mRestart;
@@ -229,6 +264,14 @@ private:
     int                     mNextSampleID;
     int                     mNextChannelID;
     bool                    mQuit;
+    bool                    mMixerIdle;     // the last voice of the mixer faded out
+
+    // decoded data cache
+    size_t                  mCacheSize;
+    size_t                  mMaxCacheSize;
+    uint32_t                mCacheClock;
+    SortedVector<int>       mReloading;         // evicted samples being decoded again
+    Condition               mReloadCondition;   // signaled when mReloading changes
 
     // callback
     Mutex                   mCallbackLock;
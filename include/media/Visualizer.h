@@ -19,6 +19,7 @@
 
 #include <media/AudioEffect.h>
 #include <audio_effects/effect_visualizer.h>
+#include <media/EffectVisualizerApi.h>
 #include <utils/Thread.h>
 
 /**
@@ -45,6 +46,13 @@
  * is called as well as the type of data returned is specified.
  * Before capturing data, the Visualizer must be enabled by calling the setEnabled() method.
  * When data capture is not needed any more, the Visualizer should be disabled.
+ *
+ * For metering and analysis, higher resolution data is also available:
+ * - Float waveform data: mono float samples by using the getFloatWaveForm() method, up to
+ *   getMaxFloatCaptureSize() samples as set by setFloatCaptureSize()
+ * - Spectrum data: the effect computes windowed float FFTs itself, optionally overlapping
+ *   and averaged, as configured by setSpectrumMode(). Each spectrum is published in shared
+ *   memory and read by getSpectrum() without any call to the audio server.
  */
 
 
@@ -131,6 +139,34 @@ public:
     // are returned
     status_t getFft(uint8_t *fft);
 
+    // maximum float capture size in samples
+    static uint32_t getMaxFloatCaptureSize() { return VISUALIZER_FLOAT_CAPTURE_SIZE_MAX; }
+    // maximum spectrum window size in samples
+    static uint32_t getMaxSpectrumSize() { return VISUALIZER_SPECTRUM_SIZE_MAX; }
+
+    // set the size of the float capture: a power of two in the range
+    // [VISUALIZER_FLOAT_CAPTURE_SIZE_MIN, VISUALIZER_FLOAT_CAPTURE_SIZE_MAX], or 0 to disable it
+    status_t setFloatCaptureSize(uint32_t size);
+    uint32_t getFloatCaptureSize() { return mFloatCaptureSize; }
+
+    // return a capture of getFloatCaptureSize() mono float samples in [-1.0, 1.0]. The scaling
+    // mode does not apply to it.
+    status_t getFloatWaveForm(float *waveform);
+
+    // configure the spectrum computed by the effect: Hann windows of size samples, a power of
+    // two in the range [VISUALIZER_SPECTRUM_SIZE_MIN, VISUALIZER_SPECTRUM_SIZE_MAX] or 0 to
+    // disable the spectrum, overlapping by overlap percent (0, 50 or 75). The power of
+    // averaging consecutive windows is averaged into each spectrum published.
+    status_t setSpectrumMode(uint32_t size, uint32_t overlap, uint32_t averaging);
+    uint32_t getSpectrumSize() { return mSpectrumSize; }
+
+    // return the last spectrum published: getSpectrumSize() / 2 + 1 magnitudes from DC to half
+    // the sampling rate, where a full scale sine reads 1.0. sequence must hold the value
+    // returned by the previous call, or 0: if no spectrum was published since, WOULD_BLOCK is
+    // returned and bins is not written. costNs receives the CPU time the effect spent on the
+    // spectrum if not NULL. This reads shared memory only and does not call the audio server.
+    status_t getSpectrum(float *bins, int32_t *sequence, uint32_t *costNs = NULL);
+
 protected:
     // from IEffectClient
     virtual void controlStatusChanged(bool controlGranted);
@@ -140,6 +176,8 @@ private:
     static const uint32_t CAPTURE_RATE_MAX = 20000;
     static const uint32_t CAPTURE_RATE_DEF = 10000;
     static const uint32_t CAPTURE_SIZE_DEF = VISUALIZER_CAPTURE_SIZE_MAX;
+    // attempts at reading a spectrum while the effect is writing it
+    static const int SPECTRUM_READ_TRIES_MAX = 16;
 
     /* internal class to handle the callback */
     class CaptureThread : public Thread
@@ -158,6 +196,8 @@ private:
     status_t doFft(uint8_t *fft, uint8_t *waveform);
     void periodicCapture();
     uint32_t initCaptureSize();
+    status_t setSpectrumMode_l(uint32_t size, uint32_t overlap, uint32_t averaging);
+    status_t setParameter32(int32_t param, uint32_t value);
 
     Mutex mCaptureLock;
     uint32_t mCaptureRate;
@@ -169,6 +209,11 @@ private:
     void *mCaptureCbkUser;
     sp<CaptureThread> mCaptureThread;
     uint32_t mCaptureFlags;
+    uint32_t mFloatCaptureSize;
+    uint32_t mSpectrumSize;
+    uint32_t mSpectrumOverlap;
+    uint32_t mSpectrumAveraging;
+    sp<IMemory> mSpectrumMemory;    // spectra published by the effect
 };
 
 
@@ -75,9 +75,19 @@ public:
 
     status_t setDataSource(int fd, int64_t offset, int64_t length);
     sp<IMemory> getFrameAtTime(int64_t timeUs, int option);
+    sp<IMemory> getThumbnailAtTime(int64_t timeUs, int option, int maxWidth, int maxHeight);
     sp<IMemory> extractAlbumArt();
     const char* extractMetadata(int keyCode);
 
+    // Extracts metadata, and optionally a thumbnail, for many files at once;
+    // see IMediaMetadataRetriever::extractMetadataBatch(). Any number of
+    // requests may be passed, they are sent in chunks of kMaxBatchSize.
+    status_t extractMetadataBatch(
+            const Vector<MetadataBatchRequest> &requests,
+            const Vector<int> &keyCodes,
+            int thumbnailMaxWidth, int thumbnailMaxHeight,
+            Vector<MetadataBatchResult> *results);
+
 private:
     static const sp<IMediaPlayerService>& getService();
 
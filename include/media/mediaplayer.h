@@ -162,7 +162,11 @@ enum media_parameter_keys {
     KEY_PARAMETER_PLAYBACK_RATE_PERMILLE = 1300,                // set only
 
     // Set a Parcel containing the value of a parcelled Java AudioAttribute instance
-    KEY_PARAMETER_AUDIO_ATTRIBUTES = 1400                       // set only
+    KEY_PARAMETER_AUDIO_ATTRIBUTES = 1400,                      // set only
+
+    // Scrubbing mode, saved as int32_t (0 or 1). While scrubbing, seeks show the frame
+    // closest to the seek time and may skip forward without flushing the decoders.
+    KEY_PARAMETER_SCRUBBING = 1500                              // set only
 };
 
 // Keep INVOKE_ID_* in sync with MediaPlayer.java.
@@ -22,6 +22,7 @@
 #include <utils/List.h>
 #include <utils/Errors.h>
 #include <utils/String8.h>
+#include <utils/Vector.h>
 #include <pthread.h>
 
 struct dirent;
@@ -68,6 +69,23 @@ private:
     MediaAlbumArt();
 } __packed;
 
+// Outcome of a file processed by the worker pool of a parallel scan, see
+// MediaScanner::setParallelScan().
+struct MediaScanFileResult {
+    String8 mPath;
+    long long mLastModified;
+    long long mFileSize;
+    bool mNoMedia;
+    MediaScanResult mResult;
+
+    // Empty if processFile() did not report a mime type.
+    String8 mMimeType;
+
+    // Tags in the order processFile() reported them.
+    Vector<String8> mTagNames;
+    Vector<String8> mTagValues;
+};
+
 struct MediaScanner {
     MediaScanner();
     virtual ~MediaScanner();
@@ -80,17 +98,40 @@ struct MediaScanner {
 
     void setLocale(const char *locale);
 
+    // Switches processDirectory() to the parallel, incremental mode.
+    //
+    // Regular files whose size and modification time match the journal at
+    // journalPath (if not NULL) are not reported to the client at all; the
+    // entries under the scanned directory are rewritten after every
+    // successful scan, those of other directories are kept. Deleting it
+    // forces a full rescan, which clients must do if they lose their own
+    // records.
+    //
+    // If the client handlesScannedFiles(), changed files are processed by
+    // numWorkers threads calling processFile() concurrently, and the results
+    // are delivered in batches through handleScannedFiles() on the calling
+    // thread. Otherwise they are reported through scanFile() as usual.
+    //
+    // numWorkers == 0 restores the default sequential mode.
+    void setParallelScan(int numWorkers, const char *journalPath);
+
     virtual MediaAlbumArt *extractAlbumArt(int fd) = 0;
 
 protected:
     const char *locale() const;
 
 private:
+    struct ScanSession;
+
     // current locale (like "ja_JP"), created/destroyed with strdup()/free()
     char *mLocale;
     char *mSkipList;
     int *mSkipIndex;
 
+    int mNumWorkers;
+    char *mJournalPath;
+    ScanSession *mSession;
+
     MediaScanResult doProcessDirectory(
             char *path, int pathRemaining, MediaScannerClient &client, bool noMedia);
     MediaScanResult doProcessDirectoryEntry(
@@ -119,6 +160,12 @@ public:
     virtual status_t handleStringTag(const char* name, const char* value) = 0;
     virtual status_t setMimeType(const char* mimeType) = 0;
 
+    // Clients that can consume metadata extracted by the worker pool of a
+    // parallel scan return true here and implement handleScannedFiles().
+    // Such clients must not call processFile() on the files they are given.
+    virtual bool handlesScannedFiles() const { return false; }
+    virtual status_t handleScannedFiles(const Vector<MediaScanFileResult> &files);
+
 protected:
     // default encoding from MediaScanner::mLocale
     String8 mLocale;
@@ -33,6 +33,9 @@ struct ColorConverter {
 
     bool isValid() const;
 
+    // If the destination crop rectangle is smaller than the source crop
+    // rectangle, the source is downsampled while it is converted. This is
+    // only supported for the YUV 4:2:0 planar and semi-planar formats.
     status_t convert(
             const void *srcBits,
             size_t srcWidth, size_t srcHeight,
@@ -79,6 +82,9 @@ private:
     status_t convertTIYUV420PackedSemiPlanar(
             const BitmapParams &src, const BitmapParams &dst);
 
+    status_t convertYUV420Scaled(
+            const BitmapParams &src, const BitmapParams &dst);
+
     ColorConverter(const ColorConverter &);
     ColorConverter &operator=(const ColorConverter &);
 };
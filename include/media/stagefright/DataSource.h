@@ -26,6 +26,7 @@
 #include <utils/List.h>
 #include <utils/RefBase.h>
 #include <utils/threads.h>
+#include <utils/Vector.h>
 #include <drm/DrmManagerClient.h>
 
 namespace android {
@@ -79,7 +80,19 @@ public:
 
     ////////////////////////////////////////////////////////////////////////////
 
-    bool sniff(String8 *mimeType, float *confidence, sp<AMessage> *meta);
+    // Per-sniffer cost of a single sniff() call, in the order the sniffers
+    // were run. Skipped sniffers are reported with zero time and bytes.
+    struct SniffStat {
+        const char *mName;
+        int64_t mTimeUs;
+        size_t mBytesRequested;  // bytes the sniffer asked for
+        size_t mBytesFetched;    // bytes actually read from this source
+        float mConfidence;       // 0 unless the sniffer recognized the content
+        bool mSkipped;
+    };
+
+    bool sniff(String8 *mimeType, float *confidence, sp<AMessage> *meta,
+               Vector<SniffStat> *stats = NULL);
 
     // The sniffer can optionally fill in "meta" with an AMessage containing
     // a dictionary of values that helps the corresponding extractor initialize
@@ -106,11 +119,32 @@ protected:
     virtual ~DataSource() {}
 
 private:
+    // Cheap test of the first few bytes of the content against a sniffer's
+    // signature.
+    typedef bool (*MagicFunc)(const uint8_t *head, size_t size);
+
+    struct Sniffer {
+        SnifferFunc mFunc;
+        const char *mName;
+
+        // Highest confidence mFunc ever reports; once a better match has
+        // been found the sniffer can be skipped.
+        float mMaxConfidence;
+
+        // NULL if the format has no signature at a fixed offset.
+        MagicFunc mMatchesMagic;
+
+        // If set, mFunc cannot succeed unless mMatchesMagic does.
+        bool mMagicRequired;
+    };
+
     static Mutex gSnifferMutex;
-    static List<SnifferFunc> gSniffers;
+    static List<Sniffer> gSniffers;
     static bool gSniffersRegistered;
 
-    static void RegisterSniffer_l(SnifferFunc func);
+    static void RegisterSniffer_l(
+            SnifferFunc func, const char *name, float maxConfidence,
+            MagicFunc matchesMagic = NULL, bool magicRequired = false);
 
     DataSource(const DataSource &);
     DataSource &operator=(const DataSource &);
@@ -0,0 +1,18 @@
+LOCAL_PATH:= $(call my-dir)
+
+# Multichannel biquad cascade engine shared by the effect libraries
+include $(CLEAR_VARS)
+
+LOCAL_ARM_MODE := arm
+
+LOCAL_SRC_FILES:= \
+	BiquadBank.c
+
+LOCAL_MODULE:= libeffectsbiquad
+
+LOCAL_MODULE_TAGS := optional
+
+# the channel loops are written to be vectorized, one channel per lane
+LOCAL_CFLAGS += -O2 -ftree-vectorize -fvisibility=hidden
+
+include $(BUILD_STATIC_LIBRARY)
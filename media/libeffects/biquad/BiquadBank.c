@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "BiquadBank.h"
+
+/* Runs one section over a block for `lanes` adjacent channels of frames that are
+ * `stride` samples apart. It is always inlined with constant lanes and stride so that
+ * the channel loops unroll into straight vector code and the state stays in registers.
+ */
+static inline __attribute__((always_inline)) void BiquadBank_section(
+        const biquad_coefs_t *coefs,
+        float *s1State,
+        float *s2State,
+        const size_t lanes,
+        const size_t stride,
+        const float *in,
+        float *out,
+        size_t frameCount)
+{
+    const float b0 = coefs->b0;
+    const float b1 = coefs->b1;
+    const float b2 = coefs->b2;
+    const float a1 = coefs->a1;
+    const float a2 = coefs->a2;
+    float s1[BIQUADBANK_MAX_LANES];
+    float s2[BIQUADBANK_MAX_LANES];
+    size_t c;
+
+    for (c = 0; c < lanes; c++) {
+        s1[c] = s1State[c];
+        s2[c] = s2State[c];
+    }
+
+    while (frameCount--) {
+        for (c = 0; c < lanes; c++) {
+            const float x = in[c];
+            const float y = b0 * x + s1[c];
+            s1[c] = b1 * x - a1 * y + s2[c];
+            s2[c] = b2 * x - a2 * y;
+            out[c] = y;
+        }
+        in += stride;
+        out += stride;
+    }
+
+    for (c = 0; c < lanes; c++) {
+        s1State[c] = s1[c];
+        s2State[c] = s2[c];
+    }
+}
+
+/* Any channel count: full groups of BIQUADBANK_MAX_LANES channels, then the rest */
+static void BiquadBank_sectionWide(const biquad_coefs_t *coefs,
+        float *s1State,
+        float *s2State,
+        size_t channelCount,
+        const float *in,
+        float *out,
+        size_t frameCount)
+{
+    size_t c = 0;
+
+    for (; c + BIQUADBANK_MAX_LANES <= channelCount; c += BIQUADBANK_MAX_LANES) {
+        BiquadBank_section(coefs, s1State + c, s2State + c, BIQUADBANK_MAX_LANES,
+                channelCount, in + c, out + c, frameCount);
+    }
+    for (; c < channelCount; c++) {
+        BiquadBank_section(coefs, s1State + c, s2State + c, 1,
+                channelCount, in + c, out + c, frameCount);
+    }
+}
+
+void BiquadBank_process(const biquad_coefs_t *coefs,
+        size_t sectionCount,
+        float *state,
+        size_t channelCount,
+        const float *in,
+        float *out,
+        size_t frameCount)
+{
+    size_t s;
+
+    if (sectionCount == 0) {
+        if (in != out) {
+            memmove(out, in, frameCount * channelCount * sizeof(float));
+        }
+        return;
+    }
+
+    /* A whole block goes through each section in turn, in place after the first one */
+    for (s = 0; s < sectionCount; s++) {
+        const float *src = (s == 0) ? in : out;
+        float *s1State = state + 2 * s * channelCount;
+        float *s2State = s1State + channelCount;
+
+        switch (channelCount) {
+        case 1:
+            BiquadBank_section(&coefs[s], s1State, s2State, 1, 1, src, out, frameCount);
+            break;
+        case 2:
+            BiquadBank_section(&coefs[s], s1State, s2State, 2, 2, src, out, frameCount);
+            break;
+        case 4:
+            BiquadBank_section(&coefs[s], s1State, s2State, 4, 4, src, out, frameCount);
+            break;
+        case 6:
+            BiquadBank_section(&coefs[s], s1State, s2State, 6, 6, src, out, frameCount);
+            break;
+        case 8:
+            BiquadBank_section(&coefs[s], s1State, s2State, 8, 8, src, out, frameCount);
+            break;
+        default:
+            BiquadBank_sectionWide(&coefs[s], s1State, s2State, channelCount,
+                    src, out, frameCount);
+            break;
+        }
+    }
+}
+
+void BiquadBank_reset(float *state, size_t sectionCount, size_t channelCount)
+{
+    memset(state, 0, BIQUADBANK_STATE_SIZE(sectionCount, channelCount) * sizeof(float));
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_BIQUADBANK_H_
+#define ANDROID_BIQUADBANK_H_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*------------------------------------
+ * definitions
+ *------------------------------------
+*/
+
+/* Number of channels filtered together in one pass over a block */
+#define BIQUADBANK_MAX_LANES 8
+
+/* Coefficients of one second order section, normalized so that a0 is 1:
+ *   y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+ * A first order section has b2 and a2 set to 0.
+ */
+typedef struct {
+    float b0;
+    float b1;
+    float b2;
+    float a1;
+    float a2;
+} biquad_coefs_t;
+
+/* Number of floats of state needed by a cascade. The sections are in transposed
+ * direct form II, which keeps two values per section and channel; the state
+ * must be zeroed before the first call.
+ */
+#define BIQUADBANK_STATE_SIZE(sectionCount, channelCount) (2 * (sectionCount) * (channelCount))
+
+/*------------------------------------
+ * API
+ *------------------------------------
+*/
+
+/* Filters interleaved float samples through a cascade of sections. Every channel goes
+ * through the same coefficients with its own state, and the channels of a frame are
+ * computed side by side so that they map onto vector lanes. Up to
+ * BIQUADBANK_MAX_LANES channels are processed per pass, wider layouts take several
+ * passes over the block.
+ *
+ * coefs         sectionCount sets of coefficients, applied in order
+ * state         BIQUADBANK_STATE_SIZE(sectionCount, channelCount) floats
+ * in, out       frameCount frames of channelCount samples, out may be equal to in
+ */
+void BiquadBank_process(const biquad_coefs_t *coefs,
+        size_t sectionCount,
+        float *state,
+        size_t channelCount,
+        const float *in,
+        float *out,
+        size_t frameCount);
+
+/* Clears the state of a cascade */
+void BiquadBank_reset(float *state, size_t sectionCount, size_t channelCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANDROID_BIQUADBANK_H_ */
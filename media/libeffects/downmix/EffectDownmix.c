@@ -23,21 +23,36 @@
 #include <stdbool.h>
 #include "EffectDownmix.h"
 
-// Do not submit with DOWNMIX_TEST_CHANNEL_INDEX defined, strictly for testing
-//#define DOWNMIX_TEST_CHANNEL_INDEX 0
-// Do not submit with DOWNMIX_ALWAYS_USE_GENERIC_DOWNMIXER defined, strictly for testing
-//#define DOWNMIX_ALWAYS_USE_GENERIC_DOWNMIXER 0
-
 #define MINUS_3_DB_IN_Q19_12 2896 // -3dB = 0.707 * 2^12 = 2896
-
-// subset of possible audio_channel_mask_t values, and AUDIO_CHANNEL_OUT_* renamed to CHANNEL_MASK_*
-typedef enum {
-    CHANNEL_MASK_QUAD_BACK = AUDIO_CHANNEL_OUT_QUAD_BACK,
-    CHANNEL_MASK_QUAD_SIDE = AUDIO_CHANNEL_OUT_QUAD_SIDE,
-    CHANNEL_MASK_5POINT1_BACK = AUDIO_CHANNEL_OUT_5POINT1_BACK,
-    CHANNEL_MASK_5POINT1_SIDE = AUDIO_CHANNEL_OUT_5POINT1_SIDE,
-    CHANNEL_MASK_7POINT1 = AUDIO_CHANNEL_OUT_7POINT1,
-} downmix_input_channel_mask_t;
+#define UNITY_IN_Q19_12 4096
+
+// Contribution to the left and right outputs of each channel position, in the order of the
+// AUDIO_CHANNEL_OUT_* bits, which is also the order of the samples in a frame. Left and right
+// channels go to their side, center and LFE channels go to both sides at -3dB. The sum is then
+// scaled by 1/2, so the channels of the common layouts mix as they always have:
+//   quad         FL + BL, FR + BR
+//   5.1 and 7.1  FL + BL + SL + (FC + LFE) * -3dB, and the same on the right
+static const int32_t kPositionGainsQ19_12[][2] = {
+        { UNITY_IN_Q19_12, 0 },                             // FRONT_LEFT
+        { 0, UNITY_IN_Q19_12 },                             // FRONT_RIGHT
+        { MINUS_3_DB_IN_Q19_12, MINUS_3_DB_IN_Q19_12 },     // FRONT_CENTER
+        { MINUS_3_DB_IN_Q19_12, MINUS_3_DB_IN_Q19_12 },     // LOW_FREQUENCY
+        { UNITY_IN_Q19_12, 0 },                             // BACK_LEFT
+        { 0, UNITY_IN_Q19_12 },                             // BACK_RIGHT
+        { UNITY_IN_Q19_12, 0 },                             // FRONT_LEFT_OF_CENTER
+        { 0, UNITY_IN_Q19_12 },                             // FRONT_RIGHT_OF_CENTER
+        { MINUS_3_DB_IN_Q19_12, MINUS_3_DB_IN_Q19_12 },     // BACK_CENTER
+        { UNITY_IN_Q19_12, 0 },                             // SIDE_LEFT
+        { 0, UNITY_IN_Q19_12 },                             // SIDE_RIGHT
+        { MINUS_3_DB_IN_Q19_12, MINUS_3_DB_IN_Q19_12 },     // TOP_CENTER
+        { UNITY_IN_Q19_12, 0 },                             // TOP_FRONT_LEFT
+        { MINUS_3_DB_IN_Q19_12, MINUS_3_DB_IN_Q19_12 },     // TOP_FRONT_CENTER
+        { 0, UNITY_IN_Q19_12 },                             // TOP_FRONT_RIGHT
+        { UNITY_IN_Q19_12, 0 },                             // TOP_BACK_LEFT
+        { MINUS_3_DB_IN_Q19_12, MINUS_3_DB_IN_Q19_12 },     // TOP_BACK_CENTER
+        { 0, UNITY_IN_Q19_12 },                             // TOP_BACK_RIGHT
+};
+static const int kNbPositions = sizeof(kPositionGainsQ19_12) / sizeof(kPositionGainsQ19_12[0]);
 
 // effect_handle_t interface implementation for downmix effect
 const struct effect_interface_s gDownmixInterface = {
@@ -81,67 +96,6 @@ static const effect_descriptor_t * const gDescriptors[] = {
 const int kNbEffects = sizeof(gDescriptors) / sizeof(const effect_descriptor_t *);
 
 
-/*----------------------------------------------------------------------------
- * Test code
- *--------------------------------------------------------------------------*/
-#ifdef DOWNMIX_TEST_CHANNEL_INDEX
-// strictly for testing, logs the indices of the channels for a given mask,
-// uses the same code as Downmix_foldGeneric()
-void Downmix_testIndexComputation(uint32_t mask) {
-    ALOGI("Testing index computation for 0x%" PRIx32 ":", mask);
-    // check against unsupported channels
-    if (mask & kUnsupported) {
-        ALOGE("Unsupported channels (top or front left/right of center)");
-        return;
-    }
-    // verify has FL/FR
-    if ((mask & AUDIO_CHANNEL_OUT_STEREO) != AUDIO_CHANNEL_OUT_STEREO) {
-        ALOGE("Front channels must be present");
-        return;
-    }
-    // verify uses SIDE as a pair (ok if not using SIDE at all)
-    bool hasSides = false;
-    if ((mask & kSides) != 0) {
-        if ((mask & kSides) != kSides) {
-            ALOGE("Side channels must be used as a pair");
-            return;
-        }
-        hasSides = true;
-    }
-    // verify uses BACK as a pair (ok if not using BACK at all)
-    bool hasBacks = false;
-    if ((mask & kBacks) != 0) {
-        if ((mask & kBacks) != kBacks) {
-            ALOGE("Back channels must be used as a pair");
-            return;
-        }
-        hasBacks = true;
-    }
-
-    const int numChan = audio_channel_count_from_out_mask(mask);
-    const bool hasFC = ((mask & AUDIO_CHANNEL_OUT_FRONT_CENTER) == AUDIO_CHANNEL_OUT_FRONT_CENTER);
-    const bool hasLFE =
-            ((mask & AUDIO_CHANNEL_OUT_LOW_FREQUENCY) == AUDIO_CHANNEL_OUT_LOW_FREQUENCY);
-    const bool hasBC = ((mask & AUDIO_CHANNEL_OUT_BACK_CENTER) == AUDIO_CHANNEL_OUT_BACK_CENTER);
-    // compute at what index each channel is: samples will be in the following order:
-    //   FL FR FC LFE BL BR BC SL SR
-    // when a channel is not present, its index is set to the same as the index of the preceding
-    // channel
-    const int indexFC  = hasFC    ? 2            : 1;        // front center
-    const int indexLFE = hasLFE   ? indexFC + 1  : indexFC;  // low frequency
-    const int indexBL  = hasBacks ? indexLFE + 1 : indexLFE; // back left
-    const int indexBR  = hasBacks ? indexBL + 1  : indexBL;  // back right
-    const int indexBC  = hasBC    ? indexBR + 1  : indexBR;  // back center
-    const int indexSL  = hasSides ? indexBC + 1  : indexBC;  // side left
-    const int indexSR  = hasSides ? indexSL + 1  : indexSL;  // side right
-
-    ALOGI("  FL FR FC LFE BL BR BC SL SR");
-    ALOGI("   %d  %d  %d   %d  %d  %d  %d  %d  %d",
-            0, 1, indexFC, indexLFE, indexBL, indexBR, indexBC, indexSL, indexSR);
-}
-#endif
-
-
 /*----------------------------------------------------------------------------
  * Effect API implementation
  *--------------------------------------------------------------------------*/
@@ -159,26 +113,6 @@ int32_t DownmixLib_Create(const effect_uuid_t *uuid,
 
     ALOGV("DownmixLib_Create()");
 
-#ifdef DOWNMIX_TEST_CHANNEL_INDEX
-    // should work (won't log an error)
-    ALOGI("DOWNMIX_TEST_CHANNEL_INDEX: should work:");
-    Downmix_testIndexComputation(AUDIO_CHANNEL_OUT_FRONT_LEFT | AUDIO_CHANNEL_OUT_FRONT_RIGHT |
-                    AUDIO_CHANNEL_OUT_LOW_FREQUENCY | AUDIO_CHANNEL_OUT_BACK_CENTER);
-    Downmix_testIndexComputation(CHANNEL_MASK_QUAD_SIDE | CHANNEL_MASK_QUAD_BACK);
-    Downmix_testIndexComputation(CHANNEL_MASK_5POINT1_SIDE | AUDIO_CHANNEL_OUT_BACK_CENTER);
-    Downmix_testIndexComputation(CHANNEL_MASK_5POINT1_BACK | AUDIO_CHANNEL_OUT_BACK_CENTER);
-    // shouldn't work (will log an error, won't display channel indices)
-    ALOGI("DOWNMIX_TEST_CHANNEL_INDEX: should NOT work:");
-    Downmix_testIndexComputation(AUDIO_CHANNEL_OUT_FRONT_LEFT | AUDIO_CHANNEL_OUT_FRONT_RIGHT |
-                        AUDIO_CHANNEL_OUT_LOW_FREQUENCY | AUDIO_CHANNEL_OUT_BACK_LEFT);
-    Downmix_testIndexComputation(AUDIO_CHANNEL_OUT_FRONT_LEFT | AUDIO_CHANNEL_OUT_FRONT_RIGHT |
-                            AUDIO_CHANNEL_OUT_LOW_FREQUENCY | AUDIO_CHANNEL_OUT_SIDE_LEFT);
-    Downmix_testIndexComputation(AUDIO_CHANNEL_OUT_FRONT_LEFT |
-                        AUDIO_CHANNEL_OUT_BACK_LEFT | AUDIO_CHANNEL_OUT_BACK_RIGHT);
-    Downmix_testIndexComputation(AUDIO_CHANNEL_OUT_FRONT_LEFT |
-                            AUDIO_CHANNEL_OUT_SIDE_LEFT | AUDIO_CHANNEL_OUT_SIDE_RIGHT);
-#endif
-
     if (pHandle == NULL || uuid == NULL) {
         return -EINVAL;
     }
@@ -282,13 +216,49 @@ static int Downmix_Process(effect_handle_t self,
         return -ENODATA;
     }
 
-    pSrc = inBuffer->s16;
-    pDst = outBuffer->s16;
     size_t numFrames = outBuffer->frameCount;
 
     const bool accumulate =
             (pDwmModule->config.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE);
-    const uint32_t downmixInputChannelMask = pDwmModule->config.inputCfg.channels;
+
+    if (pDwmModule->config.inputCfg.format == AUDIO_FORMAT_PCM_FLOAT) {
+        const float *pSrcF = inBuffer->f32;
+        float *pDstF = outBuffer->f32;
+
+        switch(pDownmixer->type) {
+
+          case DOWNMIX_TYPE_STRIP:
+              if (accumulate) {
+                  while (numFrames) {
+                      pDstF[0] += pSrcF[0];
+                      pDstF[1] += pSrcF[1];
+                      pSrcF += pDownmixer->input_channel_count;
+                      pDstF += 2;
+                      numFrames--;
+                  }
+              } else {
+                  while (numFrames) {
+                      pDstF[0] = pSrcF[0];
+                      pDstF[1] = pSrcF[1];
+                      pSrcF += pDownmixer->input_channel_count;
+                      pDstF += 2;
+                      numFrames--;
+                  }
+              }
+              break;
+
+          case DOWNMIX_TYPE_FOLD:
+              Downmix_foldMatrixFloat(pDownmixer, pSrcF, pDstF, numFrames, accumulate);
+              break;
+
+          default:
+            return -EINVAL;
+        }
+        return 0;
+    }
+
+    pSrc = inBuffer->s16;
+    pDst = outBuffer->s16;
 
     switch(pDownmixer->type) {
 
@@ -313,37 +283,8 @@ static int Downmix_Process(effect_handle_t self,
           break;
 
       case DOWNMIX_TYPE_FOLD:
-#ifdef DOWNMIX_ALWAYS_USE_GENERIC_DOWNMIXER
-          // bypass the optimized downmix routines for the common formats
-          if (!Downmix_foldGeneric(
-                  downmixInputChannelMask, pSrc, pDst, numFrames, accumulate)) {
-              ALOGE("Multichannel configuration 0x%" PRIx32 " is not supported", downmixInputChannelMask);
-              return -EINVAL;
-          }
+          Downmix_foldMatrix16(pDownmixer, pSrc, pDst, numFrames, accumulate);
           break;
-#endif
-        // optimize for the common formats
-        switch((downmix_input_channel_mask_t)downmixInputChannelMask) {
-        case CHANNEL_MASK_QUAD_BACK:
-        case CHANNEL_MASK_QUAD_SIDE:
-            Downmix_foldFromQuad(pSrc, pDst, numFrames, accumulate);
-            break;
-        case CHANNEL_MASK_5POINT1_BACK:
-        case CHANNEL_MASK_5POINT1_SIDE:
-            Downmix_foldFrom5Point1(pSrc, pDst, numFrames, accumulate);
-            break;
-        case CHANNEL_MASK_7POINT1:
-            Downmix_foldFrom7Point1(pSrc, pDst, numFrames, accumulate);
-            break;
-        default:
-            if (!Downmix_foldGeneric(
-                    downmixInputChannelMask, pSrc, pDst, numFrames, accumulate)) {
-                ALOGE("Multichannel configuration 0x%" PRIx32 " is not supported", downmixInputChannelMask);
-                return -EINVAL;
-            }
-            break;
-        }
-        break;
 
       default:
         return -EINVAL;
@@ -609,8 +550,9 @@ int Downmix_Configure(downmix_module_t *pDwmModule, effect_config_t *pConfig, bo
     // Check configuration compatibility with build options, and effect capabilities
     if (pConfig->inputCfg.samplingRate != pConfig->outputCfg.samplingRate
         || pConfig->outputCfg.channels != DOWNMIX_OUTPUT_CHANNELS
-        || pConfig->inputCfg.format != AUDIO_FORMAT_PCM_16_BIT
-        || pConfig->outputCfg.format != AUDIO_FORMAT_PCM_16_BIT) {
+        || (pConfig->inputCfg.format != AUDIO_FORMAT_PCM_16_BIT
+                && pConfig->inputCfg.format != AUDIO_FORMAT_PCM_FLOAT)
+        || pConfig->outputCfg.format != pConfig->inputCfg.format) {
         ALOGE("Downmix_Configure error: invalid config");
         return -EINVAL;
     }
@@ -633,6 +575,12 @@ int Downmix_Configure(downmix_module_t *pDwmModule, effect_config_t *pConfig, bo
                 audio_channel_count_from_out_mask(pConfig->inputCfg.channels);
     }
 
+    if (!Downmix_computeMatrix(pDownmixer, pConfig->inputCfg.channels)) {
+        ALOGE("Downmix_Configure error: multichannel configuration 0x%" PRIx32
+                " is not supported", pConfig->inputCfg.channels);
+        return -EINVAL;
+    }
+
     Downmix_Reset(pDownmixer, init);
 
     return 0;
@@ -768,60 +716,57 @@ int Downmix_getParameter(downmix_object_t *pDownmixer, int32_t param, uint32_t *
 
 
 /*----------------------------------------------------------------------------
- * Downmix_foldFromQuad()
+ * Downmix_computeMatrix()
  *----------------------------------------------------------------------------
  * Purpose:
- * downmix a quad signal to stereo
+ * Compute the contribution of each channel of an input mask to the stereo output,
+ * see kPositionGainsQ19_12
  *
  * Inputs:
- *  pSrc       quad audio samples to downmix
- *  numFrames  the number of quad frames to downmix
- *  accumulate whether to mix (when true) the result of the downmix with the contents of pDst,
- *               or overwrite pDst (when false)
+ *  pDownmixer  downmix context, whose matrix is updated
+ *  mask        the channel mask of the input
  *
- * Outputs:
- *  pDst       downmixed stereo audio samples
+ * Returns: false if the mask has no channels or channels that are not output channels
  *
  *----------------------------------------------------------------------------
  */
-void Downmix_foldFromQuad(int16_t *pSrc, int16_t*pDst, size_t numFrames, bool accumulate) {
-    // sample at index 0 is FL
-    // sample at index 1 is FR
-    // sample at index 2 is RL
-    // sample at index 3 is RR
-    if (accumulate) {
-        while (numFrames) {
-            // FL + RL
-            pDst[0] = clamp16(pDst[0] + ((pSrc[0] + pSrc[2]) >> 1));
-            // FR + RR
-            pDst[1] = clamp16(pDst[1] + ((pSrc[1] + pSrc[3]) >> 1));
-            pSrc += 4;
-            pDst += 2;
-            numFrames--;
-        }
-    } else { // same code as above but without adding and clamping pDst[i] to itself
-        while (numFrames) {
-            // FL + RL
-            pDst[0] = clamp16((pSrc[0] + pSrc[2]) >> 1);
-            // FR + RR
-            pDst[1] = clamp16((pSrc[1] + pSrc[3]) >> 1);
-            pSrc += 4;
-            pDst += 2;
-            numFrames--;
+bool Downmix_computeMatrix(downmix_object_t *pDownmixer, uint32_t mask) {
+    int position;
+    int channel = 0;
+
+    if (mask == 0 || (mask >> kNbPositions) != 0) {
+        return false;
+    }
+
+    memset(pDownmixer->matrix16, 0, sizeof(pDownmixer->matrix16));
+    memset(pDownmixer->matrixFloat, 0, sizeof(pDownmixer->matrixFloat));
+    for (position = 0; position < kNbPositions; position++) {
+        if ((mask & (1u << position)) == 0) {
+            continue;
         }
+        pDownmixer->matrix16[2 * channel] = kPositionGainsQ19_12[position][0];
+        pDownmixer->matrix16[2 * channel + 1] = kPositionGainsQ19_12[position][1];
+        // same gains as the 16 bit matrix, including the final >> 13
+        pDownmixer->matrixFloat[2 * channel] = kPositionGainsQ19_12[position][0] / 8192.0f;
+        pDownmixer->matrixFloat[2 * channel + 1] = kPositionGainsQ19_12[position][1] / 8192.0f;
+        ALOGV("Downmix_computeMatrix channel %d: L %d R %d", channel,
+                pDownmixer->matrix16[2 * channel], pDownmixer->matrix16[2 * channel + 1]);
+        channel++;
     }
+    return true;
 }
 
 
 /*----------------------------------------------------------------------------
- * Downmix_foldFrom5Point1()
+ * Downmix_foldMatrix16()
  *----------------------------------------------------------------------------
  * Purpose:
- * downmix a 5.1 signal to stereo
+ * downmix a multichannel 16 bit signal to stereo with the matrix of the downmixer
  *
  * Inputs:
- *  pSrc       5.1 audio samples to downmix
- *  numFrames  the number of 5.1 frames to downmix
+ *  pDownmixer downmix context, configured for the channel mask of pSrc
+ *  pSrc       multichannel audio samples to downmix
+ *  numFrames  the number of multichannel frames to downmix
  *  accumulate whether to mix (when true) the result of the downmix with the contents of pDst,
  *               or overwrite pDst (when false)
  *
@@ -830,132 +775,117 @@ void Downmix_foldFromQuad(int16_t *pSrc, int16_t*pDst, size_t numFrames, bool ac
  *
  *----------------------------------------------------------------------------
  */
-void Downmix_foldFrom5Point1(int16_t *pSrc, int16_t*pDst, size_t numFrames, bool accumulate) {
-    int32_t lt, rt, centerPlusLfeContrib; // samples in Q19.12 format
-    // sample at index 0 is FL
-    // sample at index 1 is FR
-    // sample at index 2 is FC
-    // sample at index 3 is LFE
-    // sample at index 4 is RL
-    // sample at index 5 is RR
+// The loops over the channels of a frame are unrolled and vectorized when lanes is a
+// constant, which is the case for the common layouts below: 8 lanes of 16 bit products
+// summed in 32 bit are one or two multiply-accumulate instructions.
+static inline __attribute__((always_inline)) void Downmix_foldFrames16_l(
+        const int16_t *mL, const int16_t *mR, const int numChan, const int lanes,
+        const int16_t *pSrc, int16_t *pDst, size_t numFrames, bool accumulate) {
+    int32_t lt, rt; // samples in Q19.12 format
+    int c;
     // code is mostly duplicated between the two values of accumulate to avoid repeating the test
     // for every sample
     if (accumulate) {
         while (numFrames) {
-            // centerPlusLfeContrib = FC(-3dB) + LFE(-3dB)
-            centerPlusLfeContrib = (pSrc[2] * MINUS_3_DB_IN_Q19_12)
-                    + (pSrc[3] * MINUS_3_DB_IN_Q19_12);
-            // FL + centerPlusLfeContrib + RL
-            lt = (pSrc[0] << 12) + centerPlusLfeContrib + (pSrc[4] << 12);
-            // FR + centerPlusLfeContrib + RR
-            rt = (pSrc[1] << 12) + centerPlusLfeContrib + (pSrc[5] << 12);
+            lt = 0;
+            rt = 0;
+            for (c = 0; c < lanes; c++) {
+                lt += pSrc[c] * mL[c];
+                rt += pSrc[c] * mR[c];
+            }
             // accumulate in destination
             pDst[0] = clamp16(pDst[0] + (lt >> 13));
             pDst[1] = clamp16(pDst[1] + (rt >> 13));
-            pSrc += 6;
+            pSrc += numChan;
             pDst += 2;
             numFrames--;
         }
     } else { // same code as above but without adding and clamping pDst[i] to itself
         while (numFrames) {
-            // centerPlusLfeContrib = FC(-3dB) + LFE(-3dB)
-            centerPlusLfeContrib = (pSrc[2] * MINUS_3_DB_IN_Q19_12)
-                    + (pSrc[3] * MINUS_3_DB_IN_Q19_12);
-            // FL + centerPlusLfeContrib + RL
-            lt = (pSrc[0] << 12) + centerPlusLfeContrib + (pSrc[4] << 12);
-            // FR + centerPlusLfeContrib + RR
-            rt = (pSrc[1] << 12) + centerPlusLfeContrib + (pSrc[5] << 12);
+            lt = 0;
+            rt = 0;
+            for (c = 0; c < lanes; c++) {
+                lt += pSrc[c] * mL[c];
+                rt += pSrc[c] * mR[c];
+            }
             // store in destination
             pDst[0] = clamp16(lt >> 13); // differs from when accumulate is true above
             pDst[1] = clamp16(rt >> 13); // differs from when accumulate is true above
-            pSrc += 6;
+            pSrc += numChan;
             pDst += 2;
             numFrames--;
         }
     }
 }
 
-
-/*----------------------------------------------------------------------------
- * Downmix_foldFrom7Point1()
- *----------------------------------------------------------------------------
- * Purpose:
- * downmix a 7.1 signal to stereo
- *
- * Inputs:
- *  pSrc       7.1 audio samples to downmix
- *  numFrames  the number of 7.1 frames to downmix
- *  accumulate whether to mix (when true) the result of the downmix with the contents of pDst,
- *               or overwrite pDst (when false)
- *
- * Outputs:
- *  pDst       downmixed stereo audio samples
- *
- *----------------------------------------------------------------------------
- */
-void Downmix_foldFrom7Point1(int16_t *pSrc, int16_t*pDst, size_t numFrames, bool accumulate) {
-    int32_t lt, rt, centerPlusLfeContrib; // samples in Q19.12 format
-    // sample at index 0 is FL
-    // sample at index 1 is FR
-    // sample at index 2 is FC
-    // sample at index 3 is LFE
-    // sample at index 4 is RL
-    // sample at index 5 is RR
-    // sample at index 6 is SL
-    // sample at index 7 is SR
-    // code is mostly duplicated between the two values of accumulate to avoid repeating the test
-    // for every sample
-    if (accumulate) {
-        while (numFrames) {
-            // centerPlusLfeContrib = FC(-3dB) + LFE(-3dB)
-            centerPlusLfeContrib = (pSrc[2] * MINUS_3_DB_IN_Q19_12)
-                    + (pSrc[3] * MINUS_3_DB_IN_Q19_12);
-            // FL + centerPlusLfeContrib + SL + RL
-            lt = (pSrc[0] << 12) + centerPlusLfeContrib + (pSrc[6] << 12) + (pSrc[4] << 12);
-            // FR + centerPlusLfeContrib + SR + RR
-            rt = (pSrc[1] << 12) + centerPlusLfeContrib + (pSrc[7] << 12) + (pSrc[5] << 12);
-            //accumulate in destination
-            pDst[0] = clamp16(pDst[0] + (lt >> 13));
-            pDst[1] = clamp16(pDst[1] + (rt >> 13));
-            pSrc += 8;
-            pDst += 2;
-            numFrames--;
-    }
-    } else { // same code as above but without adding and clamping pDst[i] to itself
-        while (numFrames) {
-            // centerPlusLfeContrib = FC(-3dB) + LFE(-3dB)
-            centerPlusLfeContrib = (pSrc[2] * MINUS_3_DB_IN_Q19_12)
-                    + (pSrc[3] * MINUS_3_DB_IN_Q19_12);
-            // FL + centerPlusLfeContrib + SL + RL
-            lt = (pSrc[0] << 12) + centerPlusLfeContrib + (pSrc[6] << 12) + (pSrc[4] << 12);
-            // FR + centerPlusLfeContrib + SR + RR
-            rt = (pSrc[1] << 12) + centerPlusLfeContrib + (pSrc[7] << 12) + (pSrc[5] << 12);
-            // store in destination
-            pDst[0] = clamp16(lt >> 13); // differs from when accumulate is true above
-            pDst[1] = clamp16(rt >> 13); // differs from when accumulate is true above
-            pSrc += 8;
-            pDst += 2;
-            numFrames--;
+static inline __attribute__((always_inline)) void Downmix_foldMatrix16_l(
+        const int16_t *matrix, const int numChan, const int lanes,
+        const int16_t *pSrc, int16_t *pDst, size_t numFrames, bool accumulate) {
+    int16_t mL[DOWNMIX_MAX_INPUT_CHANNELS];
+    int16_t mR[DOWNMIX_MAX_INPUT_CHANNELS];
+    int c;
+    // planar copies of the gains, padded with zeros up to the number of lanes so that each
+    // output is a dot product of a full vector of input samples
+    for (c = 0; c < lanes; c++) {
+        mL[c] = c < numChan ? matrix[2 * c] : 0;
+        mR[c] = c < numChan ? matrix[2 * c + 1] : 0;
+    }
+    if (lanes > numChan) {
+        // the padded lanes read into the next frames, so the last ones are done apart
+        const size_t tailFrames = (lanes - 1) / numChan;
+        if (numFrames > tailFrames) {
+            const size_t frames = numFrames - tailFrames;
+            Downmix_foldFrames16_l(mL, mR, numChan, lanes, pSrc, pDst, frames, accumulate);
+            pSrc += frames * numChan;
+            pDst += frames * 2;
+            numFrames = tailFrames;
         }
     }
+    Downmix_foldFrames16_l(mL, mR, numChan, numChan, pSrc, pDst, numFrames, accumulate);
+}
+
+void Downmix_foldMatrix16(const downmix_object_t *pDownmixer,
+        const int16_t *pSrc, int16_t *pDst, size_t numFrames, bool accumulate) {
+    const int16_t *matrix = pDownmixer->matrix16;
+
+    // the common layouts get a kernel with a constant frame size, padded to 8 lanes
+    switch (pDownmixer->input_channel_count) {
+    case 3: // 2.1
+        Downmix_foldMatrix16_l(matrix, 3, 8, pSrc, pDst, numFrames, accumulate);
+        break;
+    case 4: // quad
+        Downmix_foldMatrix16_l(matrix, 4, 8, pSrc, pDst, numFrames, accumulate);
+        break;
+    case 5:
+        Downmix_foldMatrix16_l(matrix, 5, 8, pSrc, pDst, numFrames, accumulate);
+        break;
+    case 6: // 5.1
+        Downmix_foldMatrix16_l(matrix, 6, 8, pSrc, pDst, numFrames, accumulate);
+        break;
+    case 7: // 6.1
+        Downmix_foldMatrix16_l(matrix, 7, 8, pSrc, pDst, numFrames, accumulate);
+        break;
+    case 8: // 7.1
+        Downmix_foldMatrix16_l(matrix, 8, 8, pSrc, pDst, numFrames, accumulate);
+        break;
+    default:
+        Downmix_foldMatrix16_l(matrix, pDownmixer->input_channel_count,
+                pDownmixer->input_channel_count, pSrc, pDst, numFrames, accumulate);
+        break;
+    }
 }
 
 
 /*----------------------------------------------------------------------------
- * Downmix_foldGeneric()
+ * Downmix_foldMatrixFloat()
  *----------------------------------------------------------------------------
  * Purpose:
- * downmix to stereo a multichannel signal whose format is:
- *  - has FL/FR
- *  - if using AUDIO_CHANNEL_OUT_SIDE*, it contains both left and right
- *  - if using AUDIO_CHANNEL_OUT_BACK*, it contains both left and right
- *  - doesn't use any of the AUDIO_CHANNEL_OUT_TOP* channels
- *  - doesn't use any of the AUDIO_CHANNEL_OUT_FRONT_*_OF_CENTER channels
- * Only handles channel masks not enumerated in downmix_input_channel_mask_t
+ * downmix a multichannel float signal to stereo with the matrix of the downmixer,
+ * the output is not clamped
  *
  * Inputs:
- *  mask       the channel mask of pSrc
- *  pSrc       multichannel audio buffer to downmix
+ *  pDownmixer downmix context, configured for the channel mask of pSrc
+ *  pSrc       multichannel audio samples to downmix
  *  numFrames  the number of multichannel frames to downmix
  *  accumulate whether to mix (when true) the result of the downmix with the contents of pDst,
  *               or overwrite pDst (when false)
@@ -963,119 +893,74 @@ void Downmix_foldFrom7Point1(int16_t *pSrc, int16_t*pDst, size_t numFrames, bool
  * Outputs:
  *  pDst       downmixed stereo audio samples
  *
- * Returns: false if multichannel format is not supported
- *
  *----------------------------------------------------------------------------
  */
-bool Downmix_foldGeneric(
-        uint32_t mask, int16_t *pSrc, int16_t*pDst, size_t numFrames, bool accumulate) {
-    // check against unsupported channels
-    if (mask & kUnsupported) {
-        ALOGE("Unsupported channels (top or front left/right of center)");
-        return false;
+static inline __attribute__((always_inline)) void Downmix_foldMatrixFloat_l(
+        const float *matrix, const int numChan,
+        const float *pSrc, float *pDst, size_t numFrames, bool accumulate) {
+    float lt, rt;
+    float m[DOWNMIX_MAX_INPUT_CHANNELS * 2];
+    int c;
+    for (c = 0; c < 2 * numChan; c++) {
+        m[c] = matrix[c];
     }
-    // verify has FL/FR
-    if ((mask & AUDIO_CHANNEL_OUT_STEREO) != AUDIO_CHANNEL_OUT_STEREO) {
-        ALOGE("Front channels must be present");
-        return false;
-    }
-    // verify uses SIDE as a pair (ok if not using SIDE at all)
-    bool hasSides = false;
-    if ((mask & kSides) != 0) {
-        if ((mask & kSides) != kSides) {
-            ALOGE("Side channels must be used as a pair");
-            return false;
-        }
-        hasSides = true;
-    }
-    // verify uses BACK as a pair (ok if not using BACK at all)
-    bool hasBacks = false;
-    if ((mask & kBacks) != 0) {
-        if ((mask & kBacks) != kBacks) {
-            ALOGE("Back channels must be used as a pair");
-            return false;
-        }
-        hasBacks = true;
-    }
-
-    const int numChan = audio_channel_count_from_out_mask(mask);
-    const bool hasFC = ((mask & AUDIO_CHANNEL_OUT_FRONT_CENTER) == AUDIO_CHANNEL_OUT_FRONT_CENTER);
-    const bool hasLFE =
-            ((mask & AUDIO_CHANNEL_OUT_LOW_FREQUENCY) == AUDIO_CHANNEL_OUT_LOW_FREQUENCY);
-    const bool hasBC = ((mask & AUDIO_CHANNEL_OUT_BACK_CENTER) == AUDIO_CHANNEL_OUT_BACK_CENTER);
-    // compute at what index each channel is: samples will be in the following order:
-    //   FL FR FC LFE BL BR BC SL SR
-    // when a channel is not present, its index is set to the same as the index of the preceding
-    // channel
-    const int indexFC  = hasFC    ? 2            : 1;        // front center
-    const int indexLFE = hasLFE   ? indexFC + 1  : indexFC;  // low frequency
-    const int indexBL  = hasBacks ? indexLFE + 1 : indexLFE; // back left
-    const int indexBR  = hasBacks ? indexBL + 1  : indexBL;  // back right
-    const int indexBC  = hasBC    ? indexBR + 1  : indexBR;  // back center
-    const int indexSL  = hasSides ? indexBC + 1  : indexBC;  // side left
-    const int indexSR  = hasSides ? indexSL + 1  : indexSL;  // side right
-
-    int32_t lt, rt, centersLfeContrib; // samples in Q19.12 format
-    // code is mostly duplicated between the two values of accumulate to avoid repeating the test
-    // for every sample
     if (accumulate) {
         while (numFrames) {
-            // compute contribution of FC, BC and LFE
-            centersLfeContrib = 0;
-            if (hasFC)  { centersLfeContrib += pSrc[indexFC]; }
-            if (hasLFE) { centersLfeContrib += pSrc[indexLFE]; }
-            if (hasBC)  { centersLfeContrib += pSrc[indexBC]; }
-            centersLfeContrib *= MINUS_3_DB_IN_Q19_12;
-            // always has FL/FR
-            lt = (pSrc[0] << 12);
-            rt = (pSrc[1] << 12);
-            // mix in sides and backs
-            if (hasSides) {
-                lt += pSrc[indexSL] << 12;
-                rt += pSrc[indexSR] << 12;
+            lt = pDst[0];
+            rt = pDst[1];
+            for (c = 0; c < numChan; c++) {
+                lt += pSrc[c] * m[2 * c];
+                rt += pSrc[c] * m[2 * c + 1];
             }
-            if (hasBacks) {
-                lt += pSrc[indexBL] << 12;
-                rt += pSrc[indexBR] << 12;
-            }
-            lt += centersLfeContrib;
-            rt += centersLfeContrib;
-            // accumulate in destination
-            pDst[0] = clamp16(pDst[0] + (lt >> 13));
-            pDst[1] = clamp16(pDst[1] + (rt >> 13));
+            pDst[0] = lt;
+            pDst[1] = rt;
             pSrc += numChan;
             pDst += 2;
             numFrames--;
         }
     } else {
         while (numFrames) {
-            // compute contribution of FC, BC and LFE
-            centersLfeContrib = 0;
-            if (hasFC)  { centersLfeContrib += pSrc[indexFC]; }
-            if (hasLFE) { centersLfeContrib += pSrc[indexLFE]; }
-            if (hasBC)  { centersLfeContrib += pSrc[indexBC]; }
-            centersLfeContrib *= MINUS_3_DB_IN_Q19_12;
-            // always has FL/FR
-            lt = (pSrc[0] << 12);
-            rt = (pSrc[1] << 12);
-            // mix in sides and backs
-            if (hasSides) {
-                lt += pSrc[indexSL] << 12;
-                rt += pSrc[indexSR] << 12;
+            lt = 0;
+            rt = 0;
+            for (c = 0; c < numChan; c++) {
+                lt += pSrc[c] * m[2 * c];
+                rt += pSrc[c] * m[2 * c + 1];
             }
-            if (hasBacks) {
-                lt += pSrc[indexBL] << 12;
-                rt += pSrc[indexBR] << 12;
-            }
-            lt += centersLfeContrib;
-            rt += centersLfeContrib;
-            // store in destination
-            pDst[0] = clamp16(lt >> 13); // differs from when accumulate is true above
-            pDst[1] = clamp16(rt >> 13); // differs from when accumulate is true above
+            pDst[0] = lt;
+            pDst[1] = rt;
             pSrc += numChan;
             pDst += 2;
             numFrames--;
         }
     }
-    return true;
+}
+
+void Downmix_foldMatrixFloat(const downmix_object_t *pDownmixer,
+        const float *pSrc, float *pDst, size_t numFrames, bool accumulate) {
+    const float *matrix = pDownmixer->matrixFloat;
+
+    switch (pDownmixer->input_channel_count) {
+    case 3: // 2.1
+        Downmix_foldMatrixFloat_l(matrix, 3, pSrc, pDst, numFrames, accumulate);
+        break;
+    case 4: // quad
+        Downmix_foldMatrixFloat_l(matrix, 4, pSrc, pDst, numFrames, accumulate);
+        break;
+    case 5:
+        Downmix_foldMatrixFloat_l(matrix, 5, pSrc, pDst, numFrames, accumulate);
+        break;
+    case 6: // 5.1
+        Downmix_foldMatrixFloat_l(matrix, 6, pSrc, pDst, numFrames, accumulate);
+        break;
+    case 7: // 6.1
+        Downmix_foldMatrixFloat_l(matrix, 7, pSrc, pDst, numFrames, accumulate);
+        break;
+    case 8: // 7.1
+        Downmix_foldMatrixFloat_l(matrix, 8, pSrc, pDst, numFrames, accumulate);
+        break;
+    default:
+        Downmix_foldMatrixFloat_l(matrix, pDownmixer->input_channel_count,
+                pSrc, pDst, numFrames, accumulate);
+        break;
+    }
 }
@@ -0,0 +1,21 @@
+LOCAL_PATH:= $(call my-dir)
+
+# Downmix benchmark and 16 bit bit-exactness check
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	downmixbench.c \
+	../EffectDownmix.c
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils liblog
+
+LOCAL_C_INCLUDES := \
+	$(call include-path-for, audio-effects) \
+	$(call include-path-for, audio-utils)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= downmixbench
+
+include $(BUILD_EXECUTABLE)
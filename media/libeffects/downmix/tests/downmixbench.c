@@ -0,0 +1,294 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Times the downmix effect for each fold path, in 16 bit and float and with both access
+ * modes, through the effect interface. The 16 bit output is checked against the per-frame
+ * fold that the matrix replaced, which is also timed.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <audio_effects/effect_downmix.h>
+#include <audio_utils/primitives.h>
+#include <hardware/audio_effect.h>
+#include <system/audio.h>
+
+#define FRAMES_PER_CALL 1024
+#define PASSES 5
+
+extern audio_effect_library_t AUDIO_EFFECT_LIBRARY_INFO_SYM;
+
+static const struct {
+    const char *name;
+    audio_channel_mask_t mask;
+} kLayouts[] = {
+    { "quad",       AUDIO_CHANNEL_OUT_QUAD },
+    { "5.1",        AUDIO_CHANNEL_OUT_5POINT1 },
+    { "7.1",        AUDIO_CHANNEL_OUT_7POINT1 },
+    { "6.1",        AUDIO_CHANNEL_OUT_5POINT1 | AUDIO_CHANNEL_OUT_BACK_CENTER },
+    { "2.1",        AUDIO_CHANNEL_OUT_STEREO | AUDIO_CHANNEL_OUT_LOW_FREQUENCY },
+    { "5.1.2",      AUDIO_CHANNEL_OUT_5POINT1 | AUDIO_CHANNEL_OUT_TOP_FRONT_LEFT
+                            | AUDIO_CHANNEL_OUT_TOP_FRONT_RIGHT },
+};
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-n <seconds>]\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -n seconds of 48kHz audio per pass (default 10)\n");
+
+    exit(1);
+}
+
+static int64_t getNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_nsec + ts.tv_sec * 1000000000ll;
+}
+
+// The fold that the matrix replaced, for the masks it supported: front pair, optional
+// center, LFE and back center at -3dB, optional back and side pairs.
+static bool referenceFold(uint32_t mask, const int16_t *pSrc, int16_t *pDst, size_t numFrames,
+        bool accumulate) {
+    const uint32_t sides = AUDIO_CHANNEL_OUT_SIDE_LEFT | AUDIO_CHANNEL_OUT_SIDE_RIGHT;
+    const uint32_t backs = AUDIO_CHANNEL_OUT_BACK_LEFT | AUDIO_CHANNEL_OUT_BACK_RIGHT;
+    const uint32_t supported = AUDIO_CHANNEL_OUT_STEREO | AUDIO_CHANNEL_OUT_FRONT_CENTER
+            | AUDIO_CHANNEL_OUT_LOW_FREQUENCY | AUDIO_CHANNEL_OUT_BACK_CENTER | sides | backs;
+    if ((mask & ~supported) != 0 || (mask & AUDIO_CHANNEL_OUT_STEREO) != AUDIO_CHANNEL_OUT_STEREO
+            || ((mask & sides) != 0 && (mask & sides) != sides)
+            || ((mask & backs) != 0 && (mask & backs) != backs)) {
+        return false;
+    }
+    const bool hasSides = (mask & sides) != 0;
+    const bool hasBacks = (mask & backs) != 0;
+    const bool hasFC = (mask & AUDIO_CHANNEL_OUT_FRONT_CENTER) != 0;
+    const bool hasLFE = (mask & AUDIO_CHANNEL_OUT_LOW_FREQUENCY) != 0;
+    const bool hasBC = (mask & AUDIO_CHANNEL_OUT_BACK_CENTER) != 0;
+    const int numChan = audio_channel_count_from_out_mask(mask);
+    const int indexFC  = hasFC    ? 2            : 1;
+    const int indexLFE = hasLFE   ? indexFC + 1  : indexFC;
+    const int indexBL  = hasBacks ? indexLFE + 1 : indexLFE;
+    const int indexBR  = hasBacks ? indexBL + 1  : indexBL;
+    const int indexBC  = hasBC    ? indexBR + 1  : indexBR;
+    const int indexSL  = hasSides ? indexBC + 1  : indexBC;
+    const int indexSR  = hasSides ? indexSL + 1  : indexSL;
+
+    while (numFrames) {
+        int32_t centersLfeContrib = 0;
+        if (hasFC)  { centersLfeContrib += pSrc[indexFC]; }
+        if (hasLFE) { centersLfeContrib += pSrc[indexLFE]; }
+        if (hasBC)  { centersLfeContrib += pSrc[indexBC]; }
+        centersLfeContrib *= 2896;
+        int32_t lt = (pSrc[0] << 12);
+        int32_t rt = (pSrc[1] << 12);
+        if (hasSides) {
+            lt += pSrc[indexSL] << 12;
+            rt += pSrc[indexSR] << 12;
+        }
+        if (hasBacks) {
+            lt += pSrc[indexBL] << 12;
+            rt += pSrc[indexBR] << 12;
+        }
+        lt += centersLfeContrib;
+        rt += centersLfeContrib;
+        if (accumulate) {
+            pDst[0] = clamp16(pDst[0] + (lt >> 13));
+            pDst[1] = clamp16(pDst[1] + (rt >> 13));
+        } else {
+            pDst[0] = clamp16(lt >> 13);
+            pDst[1] = clamp16(rt >> 13);
+        }
+        pSrc += numChan;
+        pDst += 2;
+        numFrames--;
+    }
+    return true;
+}
+
+static effect_handle_t createDownmixer(audio_channel_mask_t mask, audio_format_t format,
+        bool accumulate) {
+    const effect_uuid_t uuid =
+            {0x93f04452, 0xe4fe, 0x41cc, 0x91f9, {0xe4, 0x75, 0xb6, 0xd1, 0xd6, 0x9f}};
+    effect_handle_t handle;
+    effect_config_t config;
+    uint32_t replySize = sizeof(int);
+    int reply = 0;
+
+    if (AUDIO_EFFECT_LIBRARY_INFO_SYM.create_effect(&uuid, 0, 0, &handle) != 0) {
+        return NULL;
+    }
+    memset(&config, 0, sizeof(config));
+    config.inputCfg.samplingRate = 48000;
+    config.inputCfg.channels = mask;
+    config.inputCfg.format = format;
+    config.inputCfg.accessMode = EFFECT_BUFFER_ACCESS_READ;
+    config.inputCfg.mask = EFFECT_CONFIG_ALL;
+    config.outputCfg = config.inputCfg;
+    config.outputCfg.channels = AUDIO_CHANNEL_OUT_STEREO;
+    config.outputCfg.accessMode = accumulate ?
+            EFFECT_BUFFER_ACCESS_ACCUMULATE : EFFECT_BUFFER_ACCESS_WRITE;
+    if ((*handle)->command(handle, EFFECT_CMD_SET_CONFIG, sizeof(config), &config,
+                    &replySize, &reply) != 0 || reply != 0
+            || (*handle)->command(handle, EFFECT_CMD_ENABLE, 0, NULL, &replySize, &reply) != 0
+            || reply != 0) {
+        AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+static int runLayout(const char *name, audio_channel_mask_t mask, size_t frames, bool accumulate) {
+    const size_t numChan = audio_channel_count_from_out_mask(mask);
+    int16_t *in16 = malloc(frames * numChan * sizeof(int16_t));
+    int16_t *out16 = malloc(frames * 2 * sizeof(int16_t));
+    int16_t *ref16 = malloc(frames * 2 * sizeof(int16_t));
+    float *inFloat = malloc(frames * numChan * sizeof(float));
+    float *outFloat = malloc(frames * 2 * sizeof(float));
+    effect_handle_t h16 = createDownmixer(mask, AUDIO_FORMAT_PCM_16_BIT, accumulate);
+    effect_handle_t hFloat = createDownmixer(mask, AUDIO_FORMAT_PCM_FLOAT, accumulate);
+    int64_t nsRef = 0, ns16 = 0, nsFloat = 0;
+    bool hasRef = true;
+    size_t mismatches = 0;
+    double maxFloatErr = 0;
+    unsigned seed = 1;
+    size_t i;
+    int pass;
+
+    if (h16 == NULL || hFloat == NULL) {
+        fprintf(stderr, "%s: unable to configure the downmixer\n", name);
+        return 1;
+    }
+
+    for (i = 0; i < frames * numChan; i++) {
+        seed = seed * 1103515245 + 12345;
+        in16[i] = (int16_t)(seed >> 16);
+        inFloat[i] = in16[i] / 32768.0f;
+    }
+    // keep the fastest of a few passes, the outputs are reset before each one so that the
+    // accumulated results stay comparable
+    for (pass = 0; pass < PASSES; pass++) {
+        int64_t passRef = 0, pass16 = 0, passFloat = 0;
+
+        for (i = 0; i < frames * 2; i++) {
+            out16[i] = ref16[i] = (int16_t)(i * 37);
+            outFloat[i] = out16[i] / 32768.0f;
+        }
+        for (i = 0; i < frames; i += FRAMES_PER_CALL) {
+            audio_buffer_t inBuffer, outBuffer;
+            int64_t start = getNowNs();
+            hasRef = referenceFold(mask, &in16[i * numChan], &ref16[i * 2], FRAMES_PER_CALL,
+                    accumulate);
+            passRef += getNowNs() - start;
+
+            inBuffer.frameCount = outBuffer.frameCount = FRAMES_PER_CALL;
+            inBuffer.s16 = &in16[i * numChan];
+            outBuffer.s16 = &out16[i * 2];
+            start = getNowNs();
+            (*h16)->process(h16, &inBuffer, &outBuffer);
+            pass16 += getNowNs() - start;
+
+            inBuffer.f32 = &inFloat[i * numChan];
+            outBuffer.f32 = &outFloat[i * 2];
+            start = getNowNs();
+            (*hFloat)->process(hFloat, &inBuffer, &outBuffer);
+            passFloat += getNowNs() - start;
+        }
+        if (pass == 0 || passRef < nsRef) {
+            nsRef = passRef;
+        }
+        if (pass == 0 || pass16 < ns16) {
+            ns16 = pass16;
+        }
+        if (pass == 0 || passFloat < nsFloat) {
+            nsFloat = passFloat;
+        }
+    }
+
+    for (i = 0; i < frames * 2; i++) {
+        if (hasRef && out16[i] != ref16[i]) {
+            mismatches++;
+        }
+        // the float path is not clamped, so only compare where the 16 bit one wasn't either
+        if (out16[i] != INT16_MAX && out16[i] != INT16_MIN) {
+            double err = fabs(outFloat[i] - out16[i] / 32768.0);
+            if (err > maxFloatErr) {
+                maxFloatErr = err;
+            }
+        }
+    }
+
+    char refTime[16];
+    if (hasRef) {
+        snprintf(refTime, sizeof(refTime), "%.2f", (double)nsRef / frames);
+    } else {
+        snprintf(refTime, sizeof(refTime), "n/a");
+    }
+    printf("%-6s %-10s %10s %10.2f %10.2f %10s %12.1f\n", name,
+            accumulate ? "accumulate" : "write", refTime,
+            (double)ns16 / frames, (double)nsFloat / frames,
+            hasRef ? (mismatches == 0 ? "exact" : "MISMATCH") : "n/a",
+            maxFloatErr > 0 ? 20 * log10(maxFloatErr) : -999.0);
+
+    AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(h16);
+    AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(hFloat);
+    free(in16);
+    free(out16);
+    free(ref16);
+    free(inFloat);
+    free(outFloat);
+    return hasRef && mismatches != 0;
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    int seconds = 10;
+    int res;
+    size_t i;
+
+    while ((res = getopt(argc, argv, "hn:")) >= 0) {
+        switch (res) {
+            case 'n':
+                seconds = atoi(optarg);
+                if (seconds <= 0) {
+                    usage(me);
+                }
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+
+    const size_t frames = (size_t)seconds * 48000 / FRAMES_PER_CALL * FRAMES_PER_CALL;
+    int failures = 0;
+
+    printf("%-6s %-10s %10s %10s %10s %10s %12s\n", "layout", "mode",
+            "ref ns/f", "16 ns/f", "float ns/f", "16 vs ref", "float err dB");
+    for (i = 0; i < sizeof(kLayouts) / sizeof(kLayouts[0]); i++) {
+        failures += runLayout(kLayouts[i].name, kLayouts[i].mask, frames, false);
+        failures += runLayout(kLayouts[i].name, kLayouts[i].mask, frames, true);
+    }
+    return failures != 0;
+}
@@ -17,3 +17,5 @@ LOCAL_C_INCLUDES := \
     $(call include-path-for, audio-effects)
 
 include $(BUILD_SHARED_LIBRARY)
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
@@ -21,9 +21,15 @@
 #include <string.h>
 #include <stdlib.h>
 #include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include <cutils/misc.h>
 #include <cutils/config_utils.h>
+#include <cutils/properties.h>
 #include <audio_effects/audio_effects_conf.h>
 
 static list_elem_t *gEffectList; // list of effect_entry_t: all currently created effects
@@ -42,6 +48,16 @@ static int gInitDone; // true is global initialization has been preformed
 static int gCanQueryEffect; // indicates that call to EffectQueryEffect() is valid, i.e. that the list of effects
                           // was not modified since last call to EffectQueryNumberEffects()
 
+static loading_mode_t gLoadingMode;  // library loading strategy, read at init
+static const char * const kLoadingModeNames[] = { "eager", "parallel", "lazy" };
+// manifest cache, only used during init in lazy loading mode
+static manifest_entry_t *gManifest;     // entries read from the cache file
+static uint32_t gManifestCount;
+static manifest_entry_t *gNewManifest;  // entries of the descriptors queried at this init
+static uint32_t gNewManifestCount;
+static uint32_t gNewManifestCapacity;
+static int gManifestDirty;              // a descriptor was not found in the cache
+
 
 /////////////////////////////////////////////////
 //      Local functions prototypes
@@ -50,7 +66,22 @@ static int gCanQueryEffect; // indicates that call to EffectQueryEffect() is val
 static int init();
 static int loadEffectConfigFile(const char *path);
 static int loadLibraries(cnode *root);
-static int loadLibrary(cnode *root, const char *name);
+static lib_entry_t *newLibrary(cnode *root, const char *name);
+static void freeLibrary(lib_entry_t *l);
+static void prefetchLibrary(const lib_entry_t *l);
+static int openLibrary(lib_entry_t *l);
+static void linkLibrary(lib_entry_t *l);
+static int queryDescriptor(lib_entry_t *l, const effect_uuid_t *uuid, effect_descriptor_t *d);
+static loading_mode_t getLoadingMode();
+static int readManifest(const struct stat *conf);
+static int writeManifest(const struct stat *conf);
+static void freeManifests();
+static int findCachedDescriptor(const lib_entry_t *l,
+               const effect_uuid_t *uuid,
+               effect_descriptor_t *d);
+static void cacheDescriptor(const lib_entry_t *l,
+               const effect_uuid_t *uuid,
+               const effect_descriptor_t *d);
 static int loadEffects(cnode *root);
 static int loadEffect(cnode *node);
 // To get and add the effect pointed by the passed node to the gSubEffectList
@@ -304,6 +335,14 @@ int EffectCreate(const effect_uuid_t *uuid, int32_t sessionId, int32_t ioId, eff
         }
     }
 
+    // in lazy loading mode the library is opened by the first effect created from it
+    if (l->desc == NULL) {
+        ret = openLibrary(l);
+        if (ret < 0) {
+            goto exit;
+        }
+    }
+
     // create effect in library
     ret = l->desc->create_effect(uuid, sessionId, ioId, &itfe);
     if (ret != 0) {
@@ -441,6 +480,11 @@ int EffectGetSubEffects(const effect_uuid_t *uuid, sub_effect_entry_t **pSube,
 
 int init() {
     int hdl;
+    struct timespec start;
+    struct timespec end;
+    list_elem_t *e;
+    uint32_t numLibs = 0;
+    uint32_t numOpenLibs = 0;
 
     if (gInitDone) {
         return 0;
@@ -448,6 +492,9 @@ int init() {
 
     pthread_mutex_init(&gLibLock, NULL);
 
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    gLoadingMode = getLoadingMode();
+
     if (access(AUDIO_EFFECT_VENDOR_CONFIG_FILE, R_OK) == 0) {
         loadEffectConfigFile(AUDIO_EFFECT_VENDOR_CONFIG_FILE);
     } else if (access(AUDIO_EFFECT_DEFAULT_CONFIG_FILE, R_OK) == 0) {
@@ -456,7 +503,17 @@ int init() {
 
     updateNumEffects();
     gInitDone = 1;
-    ALOGV("init() done");
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    for (e = gLibraryList; e != NULL; e = e->next) {
+        numLibs++;
+        if (((lib_entry_t *)e->object)->desc != NULL) {
+            numOpenLibs++;
+        }
+    }
+    ALOGI("init() %u effects, %u of %u libraries opened, %s loading in %lld us",
+            gNumEffects, numOpenLibs, numLibs, kLoadingModeNames[gLoadingMode],
+            ((end.tv_sec - start.tv_sec) * 1000000000LL + end.tv_nsec - start.tv_nsec) / 1000);
     return 0;
 }
 
@@ -464,11 +521,17 @@ int loadEffectConfigFile(const char *path)
 {
     cnode *root;
     char *data;
+    struct stat conf;
+    int haveConf;
 
     data = load_file(path, NULL);
     if (data == NULL) {
         return -ENODEV;
     }
+    haveConf = (stat(path, &conf) == 0);
+    if (gLoadingMode == LOADING_LAZY && haveConf) {
+        readManifest(&conf);
+    }
     root = config_node("", "");
     config_load(root, data);
     loadLibraries(root);
@@ -477,69 +540,165 @@ int loadEffectConfigFile(const char *path)
     free(root);
     free(data);
 
+    // rewrite the cache if a descriptor was missing from it, or if some of its entries were
+    // left unused because their effect or library changed
+    if (gLoadingMode == LOADING_LAZY && haveConf &&
+            (gManifestDirty || gNewManifestCount != gManifestCount)) {
+        writeManifest(&conf);
+    }
+    freeManifests();
+
     return 0;
 }
 
 int loadLibraries(cnode *root)
 {
     cnode *node;
+    lib_entry_t **libs;
+    size_t count = 0;
+    size_t i;
 
     node = config_find(root, LIBRARIES_TAG);
     if (node == NULL) {
         return -ENOENT;
     }
-    node = node->first_child;
-    while (node) {
-        loadLibrary(node, node->name);
-        node = node->next;
+    for (node = node->first_child; node != NULL; node = node->next) {
+        count++;
+    }
+    libs = calloc(count, sizeof(lib_entry_t *));
+    if (libs == NULL) {
+        return -ENOMEM;
+    }
+    node = config_find(root, LIBRARIES_TAG)->first_child;
+    for (i = 0; i < count; i++, node = node->next) {
+        libs[i] = newLibrary(node, node->name);
     }
+
+    switch (gLoadingMode) {
+    case LOADING_LAZY:
+        // only check that the library is there, it is opened when first needed
+        for (i = 0; i < count; i++) {
+            if (libs[i] != NULL && access(libs[i]->path, R_OK) != 0) {
+                ALOGW("loadLibraries() cannot access %s", libs[i]->path);
+                freeLibrary(libs[i]);
+                libs[i] = NULL;
+            }
+        }
+        break;
+    case LOADING_PARALLEL:
+        // The linker serializes dlopen(), so opening on several threads would only queue the
+        // threads on its lock. What can overlap is reading the library files from storage:
+        // the reads are all started here and the libraries are then opened in turn.
+        for (i = 0; i < count; i++) {
+            if (libs[i] != NULL) {
+                prefetchLibrary(libs[i]);
+            }
+        }
+        // fall through
+    case LOADING_EAGER:
+    default:
+        for (i = 0; i < count; i++) {
+            if (libs[i] != NULL && openLibrary(libs[i]) != 0) {
+                freeLibrary(libs[i]);
+                libs[i] = NULL;
+            }
+        }
+        break;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (libs[i] != NULL) {
+            linkLibrary(libs[i]);
+        }
+    }
+    free(libs);
     return 0;
 }
 
-int loadLibrary(cnode *root, const char *name)
+lib_entry_t *newLibrary(cnode *root, const char *name)
 {
     cnode *node;
-    void *hdl;
-    audio_effect_library_t *desc;
-    list_elem_t *e;
     lib_entry_t *l;
 
     node = config_find(root, PATH_TAG);
     if (node == NULL) {
-        return -EINVAL;
+        return NULL;
     }
 
-    hdl = dlopen(node->value, RTLD_NOW);
+    l = malloc(sizeof(lib_entry_t));
+    l->name = strndup(name, PATH_MAX);
+    l->path = strndup(node->value, PATH_MAX);
+    l->handle = NULL;
+    l->desc = NULL;
+    l->effects = NULL;
+    pthread_mutex_init(&l->lock, NULL);
+    return l;
+}
+
+void freeLibrary(lib_entry_t *l)
+{
+    pthread_mutex_destroy(&l->lock);
+    free(l->name);
+    free(l->path);
+    free(l);
+}
+
+// Starts reading the library file into the page cache without waiting for the data
+void prefetchLibrary(const lib_entry_t *l)
+{
+    int fd = open(l->path, O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+    close(fd);
+}
+
+int openLibrary(lib_entry_t *l)
+{
+    void *hdl;
+    audio_effect_library_t *desc;
+
+    hdl = dlopen(l->path, RTLD_NOW);
     if (hdl == NULL) {
-        ALOGW("loadLibrary() failed to open %s", node->value);
+        ALOGW("openLibrary() failed to open %s", l->path);
         goto error;
     }
 
     desc = (audio_effect_library_t *)dlsym(hdl, AUDIO_EFFECT_LIBRARY_INFO_SYM_AS_STR);
     if (desc == NULL) {
-        ALOGW("loadLibrary() could not find symbol %s", AUDIO_EFFECT_LIBRARY_INFO_SYM_AS_STR);
+        ALOGW("openLibrary() could not find symbol %s", AUDIO_EFFECT_LIBRARY_INFO_SYM_AS_STR);
         goto error;
     }
 
     if (AUDIO_EFFECT_LIBRARY_TAG != desc->tag) {
-        ALOGW("getLibrary() bad tag %08x in lib info struct", desc->tag);
+        ALOGW("openLibrary() bad tag %08x in lib info struct", desc->tag);
         goto error;
     }
 
     if (EFFECT_API_VERSION_MAJOR(desc->version) !=
             EFFECT_API_VERSION_MAJOR(EFFECT_LIBRARY_API_VERSION)) {
-        ALOGW("loadLibrary() bad lib version %08x", desc->version);
+        ALOGW("openLibrary() bad lib version %08x", desc->version);
         goto error;
     }
 
-    // add entry for library in gLibraryList
-    l = malloc(sizeof(lib_entry_t));
-    l->name = strndup(name, PATH_MAX);
-    l->path = strndup(node->value, PATH_MAX);
     l->handle = hdl;
     l->desc = desc;
-    l->effects = NULL;
-    pthread_mutex_init(&l->lock, NULL);
+    ALOGV("openLibrary() opened library %p for path %s", l, l->path);
+
+    return 0;
+
+error:
+    if (hdl != NULL) {
+        dlclose(hdl);
+    }
+    return -EINVAL;
+}
+
+// add entry for library in gLibraryList
+void linkLibrary(lib_entry_t *l)
+{
+    list_elem_t *e;
 
     e = malloc(sizeof(list_elem_t));
     e->object = l;
@@ -547,15 +706,198 @@ int loadLibrary(cnode *root, const char *name)
     e->next = gLibraryList;
     gLibraryList = e;
     pthread_mutex_unlock(&gLibLock);
-    ALOGV("getLibrary() linked library %p for path %s", l, node->value);
+    ALOGV("linkLibrary() linked library %p for path %s", l, l->path);
+}
+
+// Queries the descriptor of an effect. In lazy loading mode it is taken from the manifest cache
+// when there, and the library is only opened for descriptors that are not.
+int queryDescriptor(lib_entry_t *l, const effect_uuid_t *uuid, effect_descriptor_t *d)
+{
+    int ret;
+
+    if (gLoadingMode == LOADING_LAZY) {
+        if (findCachedDescriptor(l, uuid, d) == 0) {
+            cacheDescriptor(l, uuid, d);
+            return 0;
+        }
+        gManifestDirty = 1;
+    }
+    if (l->desc == NULL) {
+        ret = openLibrary(l);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+    ret = l->desc->get_descriptor(uuid, d);
+    if (ret == 0 && gLoadingMode == LOADING_LAZY) {
+        cacheDescriptor(l, uuid, d);
+    }
+    return ret;
+}
+
+loading_mode_t getLoadingMode()
+{
+    char value[PROPERTY_VALUE_MAX];
+
+    property_get(LOADING_MODE_PROPERTY, value, "eager");
+    if (strcmp(value, "parallel") == 0) {
+        return LOADING_PARALLEL;
+    }
+    if (strcmp(value, "lazy") == 0) {
+        return LOADING_LAZY;
+    }
+    if (strcmp(value, "eager") != 0) {
+        ALOGW("getLoadingMode() unknown %s %s, using eager", LOADING_MODE_PROPERTY, value);
+    }
+    return LOADING_EAGER;
+}
 
+int readManifest(const struct stat *conf)
+{
+    manifest_header_t header;
+    size_t size;
+    int fd;
+
+    fd = open(AUDIO_EFFECT_MANIFEST_FILE, O_RDONLY);
+    if (fd < 0) {
+        ALOGV("readManifest() no manifest: %s", strerror(errno));
+        return -ENOENT;
+    }
+    if (read(fd, &header, sizeof(header)) != (ssize_t)sizeof(header) ||
+            header.magic != MANIFEST_MAGIC ||
+            header.version != MANIFEST_VERSION ||
+            header.entrySize != sizeof(manifest_entry_t) ||
+            header.count > MANIFEST_ENTRIES_MAX ||
+            header.confMtime != (int64_t)conf->st_mtime ||
+            header.confSize != (int64_t)conf->st_size) {
+        ALOGI("readManifest() %s is stale, rebuilding", AUDIO_EFFECT_MANIFEST_FILE);
+        close(fd);
+        return -EINVAL;
+    }
+    size = header.count * sizeof(manifest_entry_t);
+    gManifest = malloc(size != 0 ? size : sizeof(manifest_entry_t));
+    if (gManifest == NULL || read(fd, gManifest, size) != (ssize_t)size) {
+        ALOGW("readManifest() could not read %u entries", header.count);
+        free(gManifest);
+        gManifest = NULL;
+        close(fd);
+        return -EINVAL;
+    }
+    close(fd);
+    gManifestCount = header.count;
     return 0;
+}
 
-error:
-    if (hdl != NULL) {
-        dlclose(hdl);
+// The manifest is written next to its final path and renamed over it, so that a reader never
+// sees a partial file
+int writeManifest(const struct stat *conf)
+{
+    manifest_header_t header;
+    char tmpPath[PATH_MAX];
+    size_t size = gNewManifestCount * sizeof(manifest_entry_t);
+    int ret = 0;
+    int fd;
+
+    snprintf(tmpPath, sizeof(tmpPath), "%s.tmp", AUDIO_EFFECT_MANIFEST_FILE);
+    fd = open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        ret = -errno;
+        ALOGW("writeManifest() could not create %s: %s", tmpPath, strerror(-ret));
+        return ret;
     }
-    return -EINVAL;
+
+    memset(&header, 0, sizeof(header));
+    header.magic = MANIFEST_MAGIC;
+    header.version = MANIFEST_VERSION;
+    header.entrySize = sizeof(manifest_entry_t);
+    header.count = gNewManifestCount;
+    header.confMtime = conf->st_mtime;
+    header.confSize = conf->st_size;
+
+    if (write(fd, &header, sizeof(header)) != (ssize_t)sizeof(header) ||
+            (size != 0 && write(fd, gNewManifest, size) != (ssize_t)size)) {
+        ret = -EIO;
+    }
+    if (close(fd) != 0 && ret == 0) {
+        ret = -EIO;
+    }
+    if (ret == 0 && rename(tmpPath, AUDIO_EFFECT_MANIFEST_FILE) != 0) {
+        ret = -errno;
+    }
+    if (ret != 0) {
+        ALOGW("writeManifest() could not write %s: %s", AUDIO_EFFECT_MANIFEST_FILE,
+                strerror(-ret));
+        unlink(tmpPath);
+        return ret;
+    }
+    ALOGV("writeManifest() wrote %u entries", gNewManifestCount);
+    return 0;
+}
+
+void freeManifests()
+{
+    free(gManifest);
+    gManifest = NULL;
+    gManifestCount = 0;
+    free(gNewManifest);
+    gNewManifest = NULL;
+    gNewManifestCount = 0;
+    gNewManifestCapacity = 0;
+    gManifestDirty = 0;
+}
+
+int findCachedDescriptor(const lib_entry_t *l,
+               const effect_uuid_t *uuid,
+               effect_descriptor_t *d)
+{
+    struct stat lib;
+    uint32_t i;
+
+    if (gManifest == NULL || stat(l->path, &lib) != 0) {
+        return -ENOENT;
+    }
+    for (i = 0; i < gManifestCount; i++) {
+        const manifest_entry_t *m = &gManifest[i];
+        if (memcmp(&m->uuid, uuid, sizeof(effect_uuid_t)) == 0 &&
+                strncmp(m->path, l->path, MANIFEST_PATH_MAX) == 0 &&
+                m->libMtime == (int64_t)lib.st_mtime &&
+                m->libSize == (int64_t)lib.st_size) {
+            *d = m->desc;
+            return 0;
+        }
+    }
+    return -ENOENT;
+}
+
+// Adds a descriptor to the manifest written at the end of init
+void cacheDescriptor(const lib_entry_t *l,
+               const effect_uuid_t *uuid,
+               const effect_descriptor_t *d)
+{
+    struct stat lib;
+    manifest_entry_t *m;
+
+    if (strlen(l->path) >= MANIFEST_PATH_MAX ||
+            gNewManifestCount >= MANIFEST_ENTRIES_MAX ||
+            stat(l->path, &lib) != 0) {
+        return;
+    }
+    if (gNewManifestCount == gNewManifestCapacity) {
+        uint32_t capacity = gNewManifestCapacity ? gNewManifestCapacity * 2 : 32;
+        m = realloc(gNewManifest, capacity * sizeof(manifest_entry_t));
+        if (m == NULL) {
+            return;
+        }
+        gNewManifest = m;
+        gNewManifestCapacity = capacity;
+    }
+    m = &gNewManifest[gNewManifestCount++];
+    memset(m, 0, sizeof(manifest_entry_t));
+    strncpy(m->path, l->path, MANIFEST_PATH_MAX - 1);
+    m->libMtime = lib.st_mtime;
+    m->libSize = lib.st_size;
+    m->uuid = *uuid;
+    m->desc = *d;
 }
 
 // This will find the library and UUID tags of the sub effect pointed by the
@@ -578,6 +920,17 @@ int addSubEffect(cnode *root)
         ALOGW("addSubEffect() could not get library %s", node->value);
         return -EINVAL;
     }
+    // the proxy effect calls the library of its sub effects directly and not through
+    // EffectCreate(), so in lazy loading mode these libraries are opened here
+    if (l->desc == NULL) {
+        pthread_mutex_lock(&gLibLock);
+        int ret = openLibrary(l);
+        pthread_mutex_unlock(&gLibLock);
+        if (ret != 0) {
+            ALOGW("addSubEffect() could not open library %s", l->name);
+            return -EINVAL;
+        }
+    }
     node = config_find(root, UUID_TAG);
     if (node == NULL) {
         return -EINVAL;
@@ -587,7 +940,7 @@ int addSubEffect(cnode *root)
         return -EINVAL;
     }
     d = malloc(sizeof(effect_descriptor_t));
-    if (l->desc->get_descriptor(&uuid, d) != 0) {
+    if (queryDescriptor(l, &uuid, d) != 0) {
         char s[40];
         uuidToString(&uuid, s, 40);
         ALOGW("Error querying effect %s on lib %s", s, l->name);
@@ -662,7 +1015,7 @@ int loadEffect(cnode *root)
     }
 
     d = malloc(sizeof(effect_descriptor_t));
-    if (l->desc->get_descriptor(&uuid, d) != 0) {
+    if (queryDescriptor(l, &uuid, d) != 0) {
         char s[40];
         uuidToString(&uuid, s, 40);
         ALOGW("Error querying effect %s on lib %s", s, l->name);
@@ -66,6 +66,46 @@ typedef struct sub_effect_entry_s {
     void *object;
 } sub_effect_entry_t;
 
+// Library loading strategies, selected at init with the property below:
+// - eager: all libraries are opened in turn and asked for their descriptors (default)
+// - parallel: same, but the library files are all read ahead before the first one is opened
+// - lazy: descriptors come from the manifest cache and libraries are opened on first create,
+//   except the libraries of proxy sub effects which are opened at init
+#define LOADING_MODE_PROPERTY "audio.effects.loading"
+
+typedef enum {
+    LOADING_EAGER,
+    LOADING_PARALLEL,
+    LOADING_LAZY,
+} loading_mode_t;
+
+// Descriptor cache used in lazy loading mode. The manifest is tied to the configuration file
+// it was built from and each entry to the library file it was read from, so that a changed
+// file is queried again. It is rewritten at init when an entry was missing or stale.
+#define AUDIO_EFFECT_MANIFEST_FILE "/data/misc/media/audio_effects.manifest"
+
+#define MANIFEST_MAGIC 0x4d464541 // "AEFM"
+#define MANIFEST_VERSION 1
+#define MANIFEST_PATH_MAX 128
+#define MANIFEST_ENTRIES_MAX 1024
+
+typedef struct manifest_header_s {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entrySize;     // sizeof(manifest_entry_t)
+    uint32_t count;         // number of entries following the header
+    int64_t confMtime;
+    int64_t confSize;
+} manifest_header_t;
+
+typedef struct manifest_entry_s {
+    char path[MANIFEST_PATH_MAX];   // library path
+    int64_t libMtime;
+    int64_t libSize;
+    effect_uuid_t uuid;             // uuid the descriptor was queried with
+    effect_descriptor_t desc;
+} manifest_entry_t;
+
 
 ////////////////////////////////////////////////////////////////////////////////
 //
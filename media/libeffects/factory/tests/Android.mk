@@ -0,0 +1,37 @@
+LOCAL_PATH:= $(call my-dir)
+
+# Effect factory start up time with each library loading strategy
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	effectsloadbench.c
+
+LOCAL_SHARED_LIBRARIES := \
+	libeffects libcutils liblog
+
+LOCAL_C_INCLUDES := \
+	$(call include-path-for, audio-effects)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= effectsloadbench
+
+include $(BUILD_EXECUTABLE)
+
+# Proxied effects created from the lazy loading manifest
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	effectsproxytest.c
+
+LOCAL_SHARED_LIBRARIES := \
+	libeffects libcutils liblog
+
+LOCAL_C_INCLUDES := \
+	$(call include-path-for, audio-effects)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= effectsproxytest
+
+include $(BUILD_EXECUTABLE)
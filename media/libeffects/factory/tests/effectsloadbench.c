@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Measures the effect factory start up with each library loading strategy. The factory
+ * initializes once per process, so every run is a fresh child process that times the first
+ * call into the factory, the memory it added, and the first create of every effect.
+ * Run as root: the strategy is switched with a system property and the page cache can be
+ * dropped before each run to approach a cold boot.
+ */
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <cutils/properties.h>
+#include <hardware/audio_effect.h>
+#include <media/EffectsFactoryApi.h>
+
+#include "../EffectsFactory.h"
+
+static const char * const kModes[] = { "eager", "parallel", "lazy" };
+static const size_t kNumModes = sizeof(kModes) / sizeof(kModes[0]);
+
+struct Result {
+    int64_t initNs;         // first call into the factory, which loads the configuration
+    int64_t createNs;       // first create and release of every effect
+    int64_t rssKb;          // resident memory added by the first call
+    uint32_t numEffects;
+    uint32_t numCreated;
+};
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-n <runs>] [-m <modes>] [-d] [-c]\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -n runs per strategy (default 5)\n");
+    fprintf(stderr, "       -m comma separated strategies among eager, parallel and lazy"
+            " (default all)\n");
+    fprintf(stderr, "       -d drop the page cache before each run\n");
+    fprintf(stderr, "       -c delete the lazy loading manifest before each run\n");
+
+    exit(1);
+}
+
+static int64_t getNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_nsec + ts.tv_sec * 1000000000ll;
+}
+
+static int64_t getRssKb() {
+    long pages = 0;
+    long resident = 0;
+    FILE *f = fopen("/proc/self/statm", "r");
+
+    if (f == NULL) {
+        return 0;
+    }
+    if (fscanf(f, "%ld %ld", &pages, &resident) != 2) {
+        resident = 0;
+    }
+    fclose(f);
+    return (int64_t)resident * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+static void dropCaches() {
+    int fd = open("/proc/sys/vm/drop_caches", O_WRONLY);
+
+    sync();
+    if (fd < 0 || write(fd, "3", 1) != 1) {
+        fprintf(stderr, "could not drop the page cache\n");
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+// Runs in the child process: nothing touched the factory yet
+static void measure(struct Result *result) {
+    effect_descriptor_t desc;
+    effect_handle_t handle;
+    uint32_t i;
+
+    memset(result, 0, sizeof(*result));
+    const int64_t rss = getRssKb();
+    int64_t start = getNowNs();
+    if (EffectQueryNumberEffects(&result->numEffects) != 0) {
+        return;
+    }
+    result->initNs = getNowNs() - start;
+    result->rssKb = getRssKb() - rss;
+
+    start = getNowNs();
+    for (i = 0; i < result->numEffects; i++) {
+        if (EffectQueryEffect(i, &desc) != 0) {
+            continue;
+        }
+        if (EffectCreate(&desc.uuid, 0 /* sessionId */, 0 /* ioId */, &handle) == 0) {
+            EffectRelease(handle);
+            result->numCreated++;
+        }
+    }
+    result->createNs = getNowNs() - start;
+}
+
+static bool runOnce(struct Result *result) {
+    int fds[2];
+    int status;
+    pid_t pid;
+
+    if (pipe(fds) != 0) {
+        return false;
+    }
+    pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    if (pid == 0) {
+        struct Result r;
+        close(fds[0]);
+        measure(&r);
+        _exit(write(fds[1], &r, sizeof(r)) == sizeof(r) ? 0 : 1);
+    }
+    close(fds[1]);
+    const bool ok = read(fds[0], result, sizeof(*result)) == sizeof(*result);
+    close(fds[0]);
+    waitpid(pid, &status, 0);
+    return ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    const char *modes = "eager,parallel,lazy";
+    char saved[PROPERTY_VALUE_MAX];
+    int runs = 5;
+    bool drop = false;
+    bool cold = false;
+    int failures = 0;
+    int res;
+
+    while ((res = getopt(argc, argv, "hn:m:dc")) >= 0) {
+        switch (res) {
+            case 'n':
+                runs = atoi(optarg);
+                break;
+            case 'm':
+                modes = optarg;
+                break;
+            case 'd':
+                drop = true;
+                break;
+            case 'c':
+                cold = true;
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+    if (runs <= 0) {
+        usage(me);
+    }
+
+    property_get(LOADING_MODE_PROPERTY, saved, "");
+    printf("%d runs per strategy%s%s\n", runs, drop ? ", page cache dropped" : "",
+            cold ? ", no manifest" : "");
+    printf("%9s %8s %8s %8s %8s %8s %10s %9s\n", "strategy", "effects", "created",
+            "init us", "min us", "max us", "create us", "rss kB");
+
+    for (size_t m = 0; m < kNumModes; m++) {
+        if (strstr(modes, kModes[m]) == NULL) {
+            continue;
+        }
+        if (property_set(LOADING_MODE_PROPERTY, kModes[m]) != 0) {
+            fprintf(stderr, "could not set %s\n", LOADING_MODE_PROPERTY);
+            failures++;
+            break;
+        }
+
+        struct Result sum;
+        int64_t minNs = INT64_MAX;
+        int64_t maxNs = 0;
+        int done = 0;
+        memset(&sum, 0, sizeof(sum));
+        for (int n = 0; n < runs; n++) {
+            struct Result r;
+            if (cold) {
+                unlink(AUDIO_EFFECT_MANIFEST_FILE);
+            }
+            if (drop) {
+                dropCaches();
+            }
+            if (!runOnce(&r)) {
+                failures++;
+                continue;
+            }
+            sum.initNs += r.initNs;
+            sum.createNs += r.createNs;
+            sum.rssKb += r.rssKb;
+            sum.numEffects = r.numEffects;
+            sum.numCreated = r.numCreated;
+            minNs = r.initNs < minNs ? r.initNs : minNs;
+            maxNs = r.initNs > maxNs ? r.initNs : maxNs;
+            done++;
+        }
+        if (done == 0) {
+            printf("%9s failed\n", kModes[m]);
+            continue;
+        }
+        printf("%9s %8u %8u %8" PRId64 " %8" PRId64 " %8" PRId64 " %10" PRId64 " %9" PRId64 "\n",
+                kModes[m], sum.numEffects, sum.numCreated, sum.initNs / done / 1000,
+                minNs / 1000, maxNs / 1000, sum.createNs / done / 1000, sum.rssKb / done);
+    }
+
+    property_set(LOADING_MODE_PROPERTY, saved);
+    return failures == 0 ? 0 : 1;
+}
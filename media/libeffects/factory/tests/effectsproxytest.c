@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Creates every proxied effect (an effect with offload and host sub effects) in lazy loading
+ * mode, first without the manifest cache and then from the manifest written by the first run.
+ * The proxy calls the libraries of its sub effects directly, so they must be opened at init
+ * even when their descriptors come from the manifest. The factory initializes once per process,
+ * so each run is a child process. Run as root: the strategy is switched with a system property.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <cutils/properties.h>
+#include <hardware/audio_effect.h>
+#include <media/EffectsFactoryApi.h>
+
+#include "../EffectsFactory.h"
+
+#define NUM_SUB_EFFECTS 2   // one offload and one host sub effect per proxy
+
+// Runs in the child process, returns the number of proxies created or -1 on failure
+static int createProxies() {
+    effect_descriptor_t desc;
+    effect_handle_t handle;
+    sub_effect_entry_t *sube[NUM_SUB_EFFECTS];
+    uint32_t numEffects;
+    uint32_t i;
+    int numProxies = 0;
+
+    if (EffectQueryNumberEffects(&numEffects) != 0) {
+        return -1;
+    }
+    for (i = 0; i < numEffects; i++) {
+        if (EffectQueryEffect(i, &desc) != 0 ||
+                EffectGetSubEffects(&desc.uuid, sube, NUM_SUB_EFFECTS) != NUM_SUB_EFFECTS) {
+            continue;
+        }
+        if (sube[0]->lib->desc == NULL || sube[1]->lib->desc == NULL) {
+            fprintf(stderr, "%s: sub effect library not opened\n", desc.name);
+            return -1;
+        }
+        if (EffectCreate(&desc.uuid, 0 /* sessionId */, 0 /* ioId */, &handle) != 0) {
+            fprintf(stderr, "%s: could not create the proxy\n", desc.name);
+            return -1;
+        }
+        // the first command creates the sub effects
+        int reply = 0;
+        uint32_t replySize = sizeof(reply);
+        int ret = (*handle)->command(handle, EFFECT_CMD_INIT, 0, NULL, &replySize, &reply);
+        EffectRelease(handle);
+        if (ret != 0 || reply != 0) {
+            fprintf(stderr, "%s: init failed %d %d\n", desc.name, ret, reply);
+            return -1;
+        }
+        numProxies++;
+    }
+    return numProxies;
+}
+
+static int runOnce() {
+    int status;
+    pid_t pid = fork();
+
+    if (pid < 0) {
+        return -1;
+    }
+    if (pid == 0) {
+        int numProxies = createProxies();
+        _exit(numProxies < 0 ? 255 : numProxies);
+    }
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) == 255) {
+        return -1;
+    }
+    return WEXITSTATUS(status);
+}
+
+int main() {
+    char saved[PROPERTY_VALUE_MAX];
+    bool ok = true;
+
+    property_get(LOADING_MODE_PROPERTY, saved, "");
+    if (property_set(LOADING_MODE_PROPERTY, "lazy") != 0) {
+        fprintf(stderr, "could not set %s\n", LOADING_MODE_PROPERTY);
+        return 1;
+    }
+
+    unlink(AUDIO_EFFECT_MANIFEST_FILE);
+    int cold = runOnce();
+    if (access(AUDIO_EFFECT_MANIFEST_FILE, R_OK) != 0) {
+        fprintf(stderr, "%s not written\n", AUDIO_EFFECT_MANIFEST_FILE);
+        ok = false;
+    }
+    int warm = runOnce();
+    printf("proxies created: %d without manifest, %d from manifest\n", cold, warm);
+    if (cold < 0 || warm < 0 || cold != warm) {
+        ok = false;
+    } else if (warm == 0) {
+        printf("no proxied effect in the configuration\n");
+    }
+
+    property_set(LOADING_MODE_PROPERTY, saved);
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -17,6 +17,7 @@
 #define LOG_TAG "EffectLE"
 //#define LOG_NDEBUG 0
 #include <cutils/log.h>
+#include <cutils/atomic.h>
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
@@ -43,6 +44,11 @@ const effect_descriptor_t gLEDescriptor = {
         "The Android Open Source Project",
 };
 
+// number of frames converted to float and compressed at a time
+#define LE_WORK_FRAMES 256
+// full scale of the compressor, which works on 16 bit sample values
+#define LE_FLOAT_SCALE 32768.0f
+
 enum le_state_e {
     LOUDNESS_ENHANCER_STATE_UNINITIALIZED,
     LOUDNESS_ENHANCER_STATE_INITIALIZED,
@@ -53,7 +59,10 @@ struct LoudnessEnhancerContext {
     const struct effect_interface_s *mItfe;
     effect_config_t mConfig;
     uint8_t mState;
-    int32_t mTargetGainmB;// target gain in mB
+    volatile int32_t mTargetGainmB;// target gain in mB, set by the command thread
+    int32_t mAppliedGainmB;// target gain the compressor was last initialized with
+    float mInputAmp;// makeup gain for mAppliedGainmB
+    float mWorkBuffer[LE_WORK_FRAMES * 2];
     // in this implementation, there is no coupling between the compression on the left and right
     // channels
     le_fx::AdaptiveDynamicRangeCompression* mCompressor;
@@ -68,8 +77,10 @@ void LE_reset(LoudnessEnhancerContext *pContext)
     ALOGV("  > LE_reset(%p)", pContext);
 
     if (pContext->mCompressor != NULL) {
-        float targetAmp = pow(10, pContext->mTargetGainmB/2000.0f); // mB to linear amplification
-        ALOGV("LE_reset(): Target gain=%dmB <=> factor=%.2fX", pContext->mTargetGainmB, targetAmp);
+        pContext->mAppliedGainmB = android_atomic_acquire_load(&pContext->mTargetGainmB);
+        float targetAmp = pow(10, pContext->mAppliedGainmB/2000.0f); // mB to linear amplification
+        ALOGV("LE_reset(): Target gain=%dmB <=> factor=%.2fX", pContext->mAppliedGainmB, targetAmp);
+        pContext->mInputAmp = targetAmp;
         pContext->mCompressor->Initialize(targetAmp, pContext->mConfig.inputCfg.samplingRate);
     } else {
         ALOGE("LE_reset(%p): null compressors, can't apply target gain", pContext);
@@ -107,7 +118,8 @@ int LE_setConfig(LoudnessEnhancerContext *pContext, effect_config_t *pConfig)
     if (pConfig->inputCfg.channels != AUDIO_CHANNEL_OUT_STEREO) return -EINVAL;
     if (pConfig->outputCfg.accessMode != EFFECT_BUFFER_ACCESS_WRITE &&
             pConfig->outputCfg.accessMode != EFFECT_BUFFER_ACCESS_ACCUMULATE) return -EINVAL;
-    if (pConfig->inputCfg.format != AUDIO_FORMAT_PCM_16_BIT) return -EINVAL;
+    if (pConfig->inputCfg.format != AUDIO_FORMAT_PCM_16_BIT &&
+            pConfig->inputCfg.format != AUDIO_FORMAT_PCM_FLOAT) return -EINVAL;
 
     pContext->mConfig = *pConfig;
 
@@ -279,26 +291,59 @@ int LE_process(
         return -EINVAL;
     }
 
+    // a new target gain is only applied here, so that the compressor state is never changed
+    // by the command thread while a buffer is being processed
+    if (android_atomic_acquire_load(&pContext->mTargetGainmB) != pContext->mAppliedGainmB) {
+        LE_reset(pContext);
+    }
+
     //ALOGV("LE about to process %d samples", inBuffer->frameCount);
-    uint16_t inIdx;
-    float inputAmp = pow(10, pContext->mTargetGainmB/2000.0f);
-    float leftSample, rightSample;
-    for (inIdx = 0 ; inIdx < inBuffer->frameCount ; inIdx++) {
+    const bool isFloat = pContext->mConfig.inputCfg.format == AUDIO_FORMAT_PCM_FLOAT;
+    const bool accumulate = inBuffer->raw != outBuffer->raw &&
+            pContext->mConfig.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE;
+    const float inputAmp = pContext->mInputAmp;
+    float *work = pContext->mWorkBuffer;
+    for (size_t frame = 0; frame < inBuffer->frameCount; frame += LE_WORK_FRAMES) {
+        const size_t frames = inBuffer->frameCount - frame < LE_WORK_FRAMES ?
+                inBuffer->frameCount - frame : LE_WORK_FRAMES;
+        const size_t offset = frame * 2;
+
         // makeup gain is applied on the input of the compressor
-        leftSample  = inputAmp * (float)inBuffer->s16[2*inIdx];
-        rightSample = inputAmp * (float)inBuffer->s16[2*inIdx +1];
-        pContext->mCompressor->Compress(&leftSample, &rightSample);
-        inBuffer->s16[2*inIdx]    = (int16_t) leftSample;
-        inBuffer->s16[2*inIdx +1] = (int16_t) rightSample;
-    }
+        if (isFloat) {
+            const float amp = inputAmp * LE_FLOAT_SCALE;
+            for (size_t i = 0; i < frames * 2; i++) {
+                work[i] = amp * inBuffer->f32[offset + i];
+            }
+        } else {
+            for (size_t i = 0; i < frames * 2; i++) {
+                work[i] = inputAmp * (float)inBuffer->s16[offset + i];
+            }
+        }
 
-    if (inBuffer->raw != outBuffer->raw) {
-        if (pContext->mConfig.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE) {
-            for (size_t i = 0; i < outBuffer->frameCount*2; i++) {
-                outBuffer->s16[i] = clamp16(outBuffer->s16[i] + inBuffer->s16[i]);
+        pContext->mCompressor->CompressBlock(work, frames);
+
+        if (isFloat) {
+            const float scale = 1.0f / LE_FLOAT_SCALE;
+            if (accumulate) {
+                for (size_t i = 0; i < frames * 2; i++) {
+                    outBuffer->f32[offset + i] += work[i] * scale;
+                }
+            } else {
+                for (size_t i = 0; i < frames * 2; i++) {
+                    outBuffer->f32[offset + i] = work[i] * scale;
+                }
             }
         } else {
-            memcpy(outBuffer->raw, inBuffer->raw, outBuffer->frameCount * 2 * sizeof(int16_t));
+            if (accumulate) {
+                for (size_t i = 0; i < frames * 2; i++) {
+                    outBuffer->s16[offset + i] =
+                            clamp16(outBuffer->s16[offset + i] + (int16_t)work[i]);
+                }
+            } else {
+                for (size_t i = 0; i < frames * 2; i++) {
+                    outBuffer->s16[offset + i] = (int16_t)work[i];
+                }
+            }
         }
     }
     if (pContext->mState != LOUDNESS_ENHANCER_STATE_ACTIVE) {
@@ -405,9 +450,9 @@ int LE_command(effect_handle_t self, uint32_t cmdCode, uint32_t cmdSize,
         }
         switch (*(uint32_t *)p->data) {
         case LOUDNESS_ENHANCER_PARAM_TARGET_GAIN_MB:
-            pContext->mTargetGainmB = *((int32_t *)p->data + 1);
+            android_atomic_release_store(*((int32_t *)p->data + 1), &pContext->mTargetGainmB);
             ALOGV("set target gain(mB) = %d", pContext->mTargetGainmB);
-            LE_reset(pContext); // apply parameter update
+            // the parameter update is applied by the next LE_process()
             break;
         default:
             *(int32_t *)pReplyData = -EINVAL;
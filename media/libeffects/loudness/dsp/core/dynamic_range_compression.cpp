@@ -41,6 +41,7 @@ const float AdaptiveDynamicRangeCompression::kDefaultKneeThresholdInDecibel =
 const float AdaptiveDynamicRangeCompression::kCompressionRatio = 7.0f;
 const float AdaptiveDynamicRangeCompression::kTauAttack = 0.001f;
 const float AdaptiveDynamicRangeCompression::kTauRelease = 0.015f;
+const size_t AdaptiveDynamicRangeCompression::kBlockSize;
 
 AdaptiveDynamicRangeCompression::AdaptiveDynamicRangeCompression() {
   static const float kTargetGain[] = {
@@ -137,5 +138,45 @@ void AdaptiveDynamicRangeCompression::Compress(float *x1, float *x2) {
   }
 }
 
+void AdaptiveDynamicRangeCompression::CompressBlock(float *x,
+                                                    size_t frame_count) {
+  while (frame_count > 0) {
+    const size_t n = std::min(frame_count, kBlockSize);
+    // Peak of both channels, in the log domain, then the rectified overshoot
+    // multiplied with the slope
+    for (size_t i = 0; i < n; ++i) {
+      const float max_abs_x = std::max(std::fabs(x[2 * i]),
+          std::max(std::fabs(x[2 * i + 1]), kMinLogAbsValue));
+      block_[i] = math::fast_log(max_abs_x);
+    }
+    for (size_t i = 0; i < n; ++i) {
+      block_[i] = std::max(block_[i] - knee_threshold_, 0.0f) * slope_;
+    }
+    // Envelope detector
+    float state = state_;
+    for (size_t i = 0; i < n; ++i) {
+      const float cv = block_[i];
+      const float alpha = cv <= state ? alpha_attack_ : alpha_release_;
+      state = alpha * state + (1.0f - alpha) * cv;
+      block_[i] = state;
+    }
+    state_ = state;
+    // Gain curve and limiter. The state starts from 0 with a unity gain, so
+    // the gain is the exponential of the state.
+    for (size_t i = 0; i < n; ++i) {
+      block_[i] = math::fast_exp(block_[i]);
+    }
+    compressor_gain_ = block_[n - 1];
+    for (size_t i = 0; i < n; ++i) {
+      x[2 * i] = std::min(std::max(x[2 * i] * block_[i], -kFixedPointLimit),
+                          kFixedPointLimit);
+      x[2 * i + 1] = std::min(std::max(x[2 * i + 1] * block_[i],
+                                       -kFixedPointLimit), kFixedPointLimit);
+    }
+    x += 2 * n;
+    frame_count -= n;
+  }
+}
+
 }  // namespace le_fx
 
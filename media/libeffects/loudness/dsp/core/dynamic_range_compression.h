@@ -58,6 +58,16 @@ class AdaptiveDynamicRangeCompression {
   // Stereo channel version of the compressor
   void Compress(float *x1, float *x2);
 
+  // Block version of the stereo compressor, for interleaved samples processed
+  // in place. The envelope and the gain curve are computed for up to
+  // kBlockSize frames at a time: the peak detection, the log(.) and exp(.)
+  // approximations and the gain are separate loops over the block, leaving
+  // only the attack/release recursion sample by sample. The gain is exp(.) of
+  // the detector state rather than a running product of Taylor expansions as
+  // in Compress(.), so it does not drift and the output does not depend on
+  // how the signal is split into calls.
+  void CompressBlock(float *x, size_t frame_count);
+
   // This version is slower than Compress(.) but faster than CompressSlow(.)
   float CompressNormalSpeed(float x);
 
@@ -91,6 +101,8 @@ class AdaptiveDynamicRangeCompression {
   static const float kTauAttack;
   // The release time of the envelope detector
   static const float kTauRelease;
+  // The number of frames processed at a time by CompressBlock(.)
+  static const size_t kBlockSize = 64;
 
   float sampling_rate_;
   // the internal state of the envelope detector
@@ -108,6 +120,8 @@ class AdaptiveDynamicRangeCompression {
   // This interpolator provides the function that relates target gain to knee
   // threshold.
   sigmod::InterpolatorLinear<float> target_gain_to_knee_threshold_;
+  // Per frame detector input and then gain, for CompressBlock(.)
+  float block_[kBlockSize];
 
   LE_FX_DISALLOW_COPY_AND_ASSIGN(AdaptiveDynamicRangeCompression);
 };
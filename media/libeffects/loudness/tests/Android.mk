@@ -0,0 +1,26 @@
+LOCAL_PATH:= $(call my-dir)
+
+# Loudness enhancer compressor benchmark and accuracy check
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	loudnessbench.cpp \
+	../EffectLoudnessEnhancer.cpp \
+	../dsp/core/dynamic_range_compression.cpp
+
+LOCAL_CFLAGS+= -O2
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils \
+	liblog
+
+LOCAL_C_INCLUDES := \
+	$(LOCAL_PATH)/.. \
+	$(call include-path-for, audio-effects)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= loudnessbench
+
+include external/stlport/libstlport.mk
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,327 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Runs a signal with a wide dynamic range through the loudness enhancer compressor, sample by
+ * sample as it used to be run and block by block, and through the effect with 16 bit and float
+ * buffers. Reports the CPU time per buffer of each, and checks the block output against a double
+ * precision model of the compressor, its independence from the block size, and the float effect
+ * output against the 16 bit one.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <audio_effects/effect_loudnessenhancer.h>
+#include <hardware/audio_effect.h>
+#include <system/audio.h>
+
+#include "dsp/core/dynamic_range_compression.h"
+
+extern "C" audio_effect_library_t AUDIO_EFFECT_LIBRARY_INFO_SYM;
+
+static const effect_uuid_t kLoudnessEnhancerUuid =
+        { 0xfa415329, 0x2034, 0x4bea, 0xb5dc, { 0x5b, 0x38, 0x1c, 0x8d, 0x1e, 0x2c } };
+
+// Same constants as AdaptiveDynamicRangeCompression
+static const double kMinLogAbsValue = 0.032767;
+static const double kFixedPointLimit = 32767.0;
+static const double kCompressionRatio = 7.0;
+static const double kTauAttack = 0.001;
+static const double kTauRelease = 0.015;
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-r <rate>] [-b <ms>] [-s <seconds>] [-g <mB>]\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -r sample rate (default 48000)\n");
+    fprintf(stderr, "       -b milliseconds per process call (default 20)\n");
+    fprintf(stderr, "       -s seconds of audio (default 20)\n");
+    fprintf(stderr, "       -g target gain in mB (default 1000)\n");
+
+    exit(1);
+}
+
+static int64_t getThreadCpuNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return (int64_t)ts.tv_nsec + ts.tv_sec * 1000000000ll;
+}
+
+static int command(effect_handle_t handle, uint32_t cmd, uint32_t size, void *data) {
+    int reply = 0;
+    uint32_t replySize = sizeof(reply);
+    int status = (*handle)->command(handle, cmd, size, data, &replySize, &reply);
+
+    return status != 0 ? status : reply;
+}
+
+static int setParam(effect_handle_t handle, uint32_t param, int32_t value) {
+    uint32_t buf32[sizeof(effect_param_t) / sizeof(uint32_t) + 2];
+    effect_param_t *p = (effect_param_t *)buf32;
+
+    p->psize = sizeof(uint32_t);
+    p->vsize = sizeof(int32_t);
+    *(uint32_t *)p->data = param;
+    *((int32_t *)p->data + 1) = value;
+    return command(handle, EFFECT_CMD_SET_PARAM, sizeof(buf32), p);
+}
+
+static effect_handle_t openLoudnessEnhancer(uint32_t rate, bool isFloat, int32_t gainmB) {
+    effect_handle_t handle;
+    effect_config_t config;
+
+    if (AUDIO_EFFECT_LIBRARY_INFO_SYM.create_effect(&kLoudnessEnhancerUuid, 0, 0, &handle) != 0) {
+        return NULL;
+    }
+    memset(&config, 0, sizeof(config));
+    config.inputCfg.samplingRate = rate;
+    config.inputCfg.channels = AUDIO_CHANNEL_OUT_STEREO;
+    config.inputCfg.format = isFloat ? AUDIO_FORMAT_PCM_FLOAT : AUDIO_FORMAT_PCM_16_BIT;
+    config.inputCfg.accessMode = EFFECT_BUFFER_ACCESS_READ;
+    config.inputCfg.mask = EFFECT_CONFIG_ALL;
+    config.outputCfg = config.inputCfg;
+    config.outputCfg.accessMode = EFFECT_BUFFER_ACCESS_WRITE;
+    if (command(handle, EFFECT_CMD_SET_CONFIG, sizeof(config), &config) != 0 ||
+            setParam(handle, LOUDNESS_ENHANCER_PARAM_TARGET_GAIN_MB, gainmB) != 0 ||
+            command(handle, EFFECT_CMD_ENABLE, 0, NULL) != 0) {
+        AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+// CPU time spent in process() for the whole signal
+static int64_t runEffect(effect_handle_t handle, void *in, void *out, size_t frameCount,
+        size_t numBuffers, size_t frameSize) {
+    int64_t cpuNs = 0;
+    for (size_t n = 0; n < numBuffers; n++) {
+        audio_buffer_t inBuffer, outBuffer;
+        inBuffer.frameCount = frameCount;
+        inBuffer.raw = (uint8_t *)in + n * frameCount * frameSize;
+        outBuffer.frameCount = frameCount;
+        outBuffer.raw = (uint8_t *)out + n * frameCount * frameSize;
+        const int64_t start = getThreadCpuNs();
+        (*handle)->process(handle, &inBuffer, &outBuffer);
+        cpuNs += getThreadCpuNs() - start;
+    }
+    return cpuNs;
+}
+
+// The compressor with exact log(.) and exp(.), in double precision
+static void compressReference(const float *in, double *out, size_t frames, double targetGain,
+        double rate) {
+    static const double kTargetGain[] = { 1.0, 2.0, 3.0, 4.0, 5.0 };
+    static const double kKneeThreshold[] = { -8.0, -8.0, -8.5, -9.0, -10.0 };
+    double kneeDb = kKneeThreshold[4];
+    for (int i = 0; i < 4; i++) {
+        if (targetGain < kTargetGain[i + 1]) {
+            kneeDb = targetGain <= kTargetGain[0] ? kKneeThreshold[0] :
+                    kKneeThreshold[i] + (targetGain - kTargetGain[i]) *
+                    (kKneeThreshold[i + 1] - kKneeThreshold[i]);
+            break;
+        }
+    }
+    const double knee = kneeDb * log(10.0) / 20 + log(kFixedPointLimit);
+    const double alphaAttack = exp(-1.0 / (kTauAttack * rate));
+    const double alphaRelease = exp(-1.0 / (kTauRelease * rate));
+    const double slope = 1.0 / kCompressionRatio - 1.0;
+    double state = 0;
+
+    for (size_t i = 0; i < frames; i++) {
+        const double maxAbs = fmax(fmax(fabs(in[2 * i]), fabs(in[2 * i + 1])), kMinLogAbsValue);
+        const double cv = fmax(log(maxAbs) - knee, 0.0) * slope;
+        const double alpha = cv <= state ? alphaAttack : alphaRelease;
+        state = alpha * state + (1 - alpha) * cv;
+        const double gain = exp(state);
+        out[2 * i] = fmin(fmax(in[2 * i] * gain, -kFixedPointLimit), kFixedPointLimit);
+        out[2 * i + 1] = fmin(fmax(in[2 * i + 1] * gain, -kFixedPointLimit), kFixedPointLimit);
+    }
+}
+
+// Largest and rms difference to the reference, in dB relative to full scale
+static void compare(const float *out, const double *ref, size_t samples, double *maxDb,
+        double *rmsDb) {
+    double maxErr = 0, sumErr = 0;
+    for (size_t i = 0; i < samples; i++) {
+        const double err = fabs(out[i] - ref[i]);
+        if (err > maxErr) {
+            maxErr = err;
+        }
+        sumErr += err * err;
+    }
+    *maxDb = maxErr > 0 ? 20 * log10(maxErr / kFixedPointLimit) : -999.0;
+    *rmsDb = sumErr > 0 ? 10 * log10(sumErr / samples) - 20 * log10(kFixedPointLimit) : -999.0;
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    uint32_t rate = 48000;
+    int bufferMs = 20;
+    int seconds = 20;
+    int32_t gainmB = 1000;
+    int res;
+
+    while ((res = getopt(argc, argv, "hr:b:s:g:")) >= 0) {
+        switch (res) {
+            case 'r':
+                rate = atoi(optarg);
+                break;
+            case 'b':
+                bufferMs = atoi(optarg);
+                break;
+            case 's':
+                seconds = atoi(optarg);
+                break;
+            case 'g':
+                gainmB = atoi(optarg);
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+    if (rate < 8000 || bufferMs <= 0 || seconds <= 0 || gainmB < 0) {
+        usage(me);
+    }
+
+    const size_t frameCount = rate * bufferMs / 1000;
+    const size_t numBuffers = seconds * 1000 / bufferMs;
+    const size_t frames = numBuffers * frameCount;
+    const float targetGain = pow(10, gainmB / 2000.0);
+    int16_t *in16 = new int16_t[frames * 2];
+    float *inFloat = new float[frames * 2];
+    float *input = new float[frames * 2];      // input of the compressor, with the makeup gain
+    int16_t *out16 = new int16_t[frames * 2];
+    float *outFloat = new float[frames * 2];
+    float *outSample = new float[frames * 2];
+    float *outBlock = new float[frames * 2];
+    double *outRef = new double[frames * 2];
+
+    // Two tones and some noise, with a level swinging between -50 and 0 dBFS every second
+    unsigned seed = 1;
+    for (size_t i = 0; i < frames; i++) {
+        seed = seed * 1103515245 + 12345;
+        const double t = (double)i / rate;
+        const double level = pow(10, (-25 + 25 * sin(2 * M_PI * t)) / 20);
+        const double noise = (int16_t)(seed >> 16) / 32768.0 * 0.1;
+        const double left = level * (0.6 * sin(2 * M_PI * 220 * t) + 0.3 * sin(2 * M_PI * 3300 * t)
+                + noise);
+        const double right = level * (0.6 * sin(2 * M_PI * 330 * t) + 0.3 * sin(2 * M_PI * 5000 * t)
+                - noise);
+        in16[2 * i] = (int16_t)lrint(left * 32767);
+        in16[2 * i + 1] = (int16_t)lrint(right * 32767);
+        // same quantised signal on both paths so only processing differs
+        inFloat[2 * i] = in16[2 * i] / 32768.0f;
+        inFloat[2 * i + 1] = in16[2 * i + 1] / 32768.0f;
+        input[2 * i] = targetGain * in16[2 * i];
+        input[2 * i + 1] = targetGain * in16[2 * i + 1];
+    }
+
+    // Compressor alone, sample by sample and block by block
+    le_fx::AdaptiveDynamicRangeCompression compressor;
+    compressor.Initialize(targetGain, rate);
+    memcpy(outSample, input, frames * 2 * sizeof(float));
+    int64_t start = getThreadCpuNs();
+    for (size_t i = 0; i < frames; i++) {
+        compressor.Compress(&outSample[2 * i], &outSample[2 * i + 1]);
+    }
+    const int64_t sampleNs = getThreadCpuNs() - start;
+
+    compressor.Initialize(targetGain, rate);
+    memcpy(outBlock, input, frames * 2 * sizeof(float));
+    start = getThreadCpuNs();
+    for (size_t n = 0; n < numBuffers; n++) {
+        compressor.CompressBlock(&outBlock[n * frameCount * 2], frameCount);
+    }
+    const int64_t blockNs = getThreadCpuNs() - start;
+
+    // The block output must not depend on how the signal is split
+    bool splitExact = true;
+    static const size_t kSplits[] = { 1, 37, 1000 };
+    float *outSplit = new float[frames * 2];
+    for (size_t s = 0; s < sizeof(kSplits) / sizeof(kSplits[0]); s++) {
+        compressor.Initialize(targetGain, rate);
+        memcpy(outSplit, input, frames * 2 * sizeof(float));
+        for (size_t i = 0; i < frames; i += kSplits[s]) {
+            compressor.CompressBlock(&outSplit[2 * i],
+                    frames - i < kSplits[s] ? frames - i : kSplits[s]);
+        }
+        if (memcmp(outSplit, outBlock, frames * 2 * sizeof(float)) != 0) {
+            printf("block output differs when processed %zu frames at a time\n", kSplits[s]);
+            splitExact = false;
+        }
+    }
+    delete[] outSplit;
+
+    // Through the effect, 16 bit and float
+    effect_handle_t handle16 = openLoudnessEnhancer(rate, false, gainmB);
+    effect_handle_t handleFloat = openLoudnessEnhancer(rate, true, gainmB);
+    if (handle16 == NULL || handleFloat == NULL) {
+        fprintf(stderr, "could not open the loudness enhancer\n");
+        return 1;
+    }
+    const int64_t effect16Ns = runEffect(handle16, in16, out16, frameCount, numBuffers,
+            2 * sizeof(int16_t));
+    const int64_t effectFloatNs = runEffect(handleFloat, inFloat, outFloat, frameCount,
+            numBuffers, 2 * sizeof(float));
+    AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(handle16);
+    AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(handleFloat);
+
+    double maxFloatErr = 0;
+    for (size_t i = 0; i < frames * 2; i++) {
+        const double err = fabs(outFloat[i] * 32768.0 - out16[i]);
+        if (err > maxFloatErr) {
+            maxFloatErr = err;
+        }
+    }
+
+    compressReference(input, outRef, frames, targetGain, rate);
+    double sampleMaxDb, sampleRmsDb, blockMaxDb, blockRmsDb;
+    compare(outSample, outRef, frames * 2, &sampleMaxDb, &sampleRmsDb);
+    compare(outBlock, outRef, frames * 2, &blockMaxDb, &blockRmsDb);
+
+    printf("%u Hz, %d ms buffers, target gain %d mB\n", rate, bufferMs, gainmB);
+    printf("%-20s %12s %12s %14s\n", "", "us/buffer", "error max dB", "error rms dB");
+    printf("%-20s %12.2f %12.1f %14.1f\n", "compress per sample",
+            sampleNs / 1e3 / numBuffers, sampleMaxDb, sampleRmsDb);
+    printf("%-20s %12.2f %12.1f %14.1f\n", "compress per block",
+            blockNs / 1e3 / numBuffers, blockMaxDb, blockRmsDb);
+    printf("%-20s %12.2f\n", "effect 16 bit", effect16Ns / 1e3 / numBuffers);
+    printf("%-20s %12.2f\n", "effect float", effectFloatNs / 1e3 / numBuffers);
+    printf("float effect output within %.2f LSB of the 16 bit output\n", maxFloatErr);
+
+    // The approximations of the block version must not be worse than those of the per sample
+    // version, and the float path differs from the 16 bit one only by the 16 bit truncation
+    const bool pass = splitExact && blockMaxDb <= sampleMaxDb + 1.0 && blockRmsDb < -60.0 &&
+            maxFloatErr <= 1.0;
+    printf("%s\n", pass ? "PASS" : "FAIL");
+
+    delete[] in16;
+    delete[] inFloat;
+    delete[] input;
+    delete[] out16;
+    delete[] outFloat;
+    delete[] outSample;
+    delete[] outBlock;
+    delete[] outRef;
+    return pass ? 0 : 1;
+}
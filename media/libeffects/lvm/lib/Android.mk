@@ -39,19 +39,23 @@ LOCAL_SRC_FILES:= \
     Eq/src/LVEQNB_Tables.c \
     Common/src/InstAlloc.c \
     Common/src/DC_2I_D16_TRC_WRA_01.c \
+    Common/src/DC_2I_D16_TRC_WRA_01_Float.c \
     Common/src/DC_2I_D16_TRC_WRA_01_Init.c \
     Common/src/FO_2I_D16F32C15_LShx_TRC_WRA_01.c \
+    Common/src/FO_2I_D16F32C15_LShx_TRC_WRA_01_Float.c \
     Common/src/FO_2I_D16F32Css_LShx_TRC_WRA_01_Init.c \
     Common/src/FO_1I_D16F16C15_TRC_WRA_01.c \
     Common/src/FO_1I_D16F16Css_TRC_WRA_01_Init.c \
     Common/src/BP_1I_D16F32C30_TRC_WRA_01.c \
     Common/src/BP_1I_D16F16C14_TRC_WRA_01.c \
     Common/src/BP_1I_D32F32C30_TRC_WRA_02.c \
+    Common/src/BP_1I_D32F32C30_TRC_WRA_02_Float.c \
     Common/src/BP_1I_D16F16Css_TRC_WRA_01_Init.c \
     Common/src/BP_1I_D16F32Cll_TRC_WRA_01_Init.c \
     Common/src/BP_1I_D32F32Cll_TRC_WRA_02_Init.c \
     Common/src/BQ_2I_D32F32Cll_TRC_WRA_01_Init.c \
     Common/src/BQ_2I_D32F32C30_TRC_WRA_01.c \
+    Common/src/BQ_2I_D32F32C30_TRC_WRA_01_Float.c \
     Common/src/BQ_2I_D16F32C15_TRC_WRA_01.c \
     Common/src/BQ_2I_D16F32C14_TRC_WRA_01.c \
     Common/src/BQ_2I_D16F32C13_TRC_WRA_01.c \
@@ -65,12 +69,19 @@ LOCAL_SRC_FILES:= \
     Common/src/BQ_1I_D16F32Css_TRC_WRA_01_init.c \
     Common/src/PK_2I_D32F32C30G11_TRC_WRA_01.c \
     Common/src/PK_2I_D32F32C14G11_TRC_WRA_01.c \
+    Common/src/PK_2I_D32F32C30G11_TRC_WRA_01_Float.c \
+    Common/src/PK_2I_D32F32C14G11_TRC_WRA_01_Float.c \
     Common/src/PK_2I_D32F32CssGss_TRC_WRA_01_Init.c \
     Common/src/PK_2I_D32F32CllGss_TRC_WRA_01_Init.c \
     Common/src/Int16LShiftToInt32_16x32.c \
     Common/src/From2iToMono_16.c \
     Common/src/Copy_16.c \
     Common/src/MonoTo2I_16.c \
+    Common/src/Copy_Float.c \
+    Common/src/MonoTo2I_Float.c \
+    Common/src/From2iToMono_Float.c \
+    Common/src/Int16ToFloat_16xFlt.c \
+    Common/src/FloatToInt16_Sat_Fltx16.c \
     Common/src/LoadConst_16.c \
     Common/src/dB_to_Lin32.c \
     Common/src/Shift_Sat_v16xv16.c \
@@ -99,7 +110,17 @@ LOCAL_SRC_FILES:= \
     Common/src/LVC_Core_MixSoft_1St_D16C31_WRA.c \
     Common/src/LVC_Core_MixHard_2St_D16C31_SAT.c \
     Common/src/LVC_MixInSoft_D16C31_SAT.c \
+    Common/src/LVC_MixSoft_1St_2i_D16C31_SAT_Float.c \
+    Common/src/LVC_MixSoft_1St_D16C31_SAT_Float.c \
+    Common/src/LVC_MixSoft_2St_D16C31_SAT_Float.c \
+    Common/src/LVC_MixInSoft_D16C31_SAT_Float.c \
+    Common/src/LVC_Core_MixHard_1St_2i_D16C31_SAT_Float.c \
+    Common/src/LVC_Core_MixSoft_1St_2i_D16C31_WRA_Float.c \
+    Common/src/LVC_Core_MixInSoft_D16C31_SAT_Float.c \
+    Common/src/LVC_Core_MixSoft_1St_D16C31_WRA_Float.c \
+    Common/src/LVC_Core_MixHard_2St_D16C31_SAT_Float.c \
     Common/src/AGC_MIX_VOL_2St1Mon_D32_WRA.c \
+    Common/src/AGC_MIX_VOL_2St1Mon_D32_WRA_Float.c \
     Common/src/LVM_Timer.c \
     Common/src/LVM_Timer_Init.c
 
@@ -117,7 +138,8 @@ LOCAL_C_INCLUDES += \
     $(LOCAL_PATH)/SpectrumAnalyzer/lib \
     $(LOCAL_PATH)/SpectrumAnalyzer/src \
     $(LOCAL_PATH)/StereoWidening/src \
-    $(LOCAL_PATH)/StereoWidening/lib
+    $(LOCAL_PATH)/StereoWidening/lib \
+    $(LOCAL_PATH)/../../biquad
 
 LOCAL_CFLAGS += -fvisibility=hidden
 
@@ -155,6 +177,8 @@ LOCAL_SRC_FILES:= \
     Common/src/Add2_Sat_32x32.c \
     Common/src/JoinTo2i_32x32.c \
     Common/src/MonoTo2I_32.c \
+    Common/src/MonoTo2I_Float.c \
+    Common/src/Copy_Float.c \
     Common/src/LVM_FO_HPF.c \
     Common/src/LVM_FO_LPF.c \
     Common/src/LVM_Polynomial.c \
@@ -457,6 +457,36 @@ LVDBE_ReturnStatus_en LVDBE_Process(LVDBE_Handle_t          hInstance,
                                        LVM_UINT16           NumSamples);
 
 
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                 LVDBE_Process_Float                                        */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*  Floating point process function for the Bass Enhancement module. Samples are        */
+/*  LVM_FLOAT with full scale +/-1.0 and the output is not saturated.                   */
+/*                                                                                      */
+/* PARAMETERS:                                                                          */
+/*  hInstance                Instance handle                                            */
+/*  pInData                  Pointer to the input data                                  */
+/*  pOutData                 Pointer to the output data                                 */
+/*  NumSamples              Number of samples in the input buffer                       */
+/*                                                                                      */
+/* RETURNS:                                                                             */
+/*  LVDBE_SUCCESS             Succeeded                                                 */
+/*    LVDBE_TOOMANYSAMPLES    NumSamples was larger than the maximum block size         */
+/*                                                                                      */
+/* NOTES:                                                                               */
+/*  1. The filter taps are shared with LVDBE_Process and must be cleared when           */
+/*     changing between the two                                                         */
+/*                                                                                      */
+/****************************************************************************************/
+
+LVDBE_ReturnStatus_en LVDBE_Process_Float(LVDBE_Handle_t        hInstance,
+                                       const LVM_FLOAT      *pInData,
+                                       LVM_FLOAT            *pOutData,
+                                       LVM_UINT16           NumSamples);
+
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
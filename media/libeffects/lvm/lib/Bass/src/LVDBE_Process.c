@@ -197,11 +197,132 @@ LVDBE_ReturnStatus_en LVDBE_Process(LVDBE_Handle_t            hInstance,
 }
 
 
+/********************************************************************************************/
+/*                                                                                          */
+/* FUNCTION:                 LVDBE_Process_Float                                            */
+/*                                                                                          */
+/* DESCRIPTION:                                                                             */
+/*  Floating point process function for the Bass Enhancement module. This follows the      */
+/*  same signal flow as LVDBE_Process without the 16/32-bit conversions, the headroom       */
+/*  shift is only used to scale the AGC target level.                                       */
+/*                                                                                          */
+/* PARAMETERS:                                                                              */
+/*  hInstance                 Instance handle                                               */
+/*  pInData                   Pointer to the input data                                     */
+/*  pOutData                  Pointer to the output data                                    */
+/*  NumSamples                Number of samples in the input buffer                         */
+/*                                                                                          */
+/* RETURNS:                                                                                 */
+/*  LVDBE_SUCCESS             Succeeded                                                     */
+/*    LVDBE_TOOMANYSAMPLES    NumSamples was larger than the maximum block size             */
+/*                                                                                          */
+/* NOTES:                                                                                   */
+/*                                                                                          */
+/********************************************************************************************/
 
+LVDBE_ReturnStatus_en LVDBE_Process_Float(LVDBE_Handle_t        hInstance,
+                                       const LVM_FLOAT      *pInData,
+                                       LVM_FLOAT            *pOutData,
+                                       LVM_UINT16           NumSamples)
+{
 
+    LVDBE_Instance_t    *pInstance =(LVDBE_Instance_t  *)hInstance;
+    LVM_FLOAT           *pScratch  = (LVM_FLOAT *)pInstance->MemoryTable.Region[LVDBE_MEMREGION_SCRATCH].pBaseAddress;
+
+    /* Mono path starts at offset of 2*NumSamples from pScratch */
+    LVM_FLOAT           *pMono       = &pScratch[2*NumSamples];
 
+    /* Bypass volume reuses the mono path once the AGC has been applied */
+    LVM_FLOAT           *pScratchVol = &pScratch[2*NumSamples];
 
+    /*
+     * Check the number of samples is not too large
+     */
+    if (NumSamples > pInstance->Capabilities.MaxBlockSize)
+    {
+        return(LVDBE_TOOMANYSAMPLES);
+    }
 
+    /*
+     * Check if the algorithm is enabled
+     */
+    /* DBE path is processed when DBE is ON or during On/Off transitions */
+    if ((pInstance->Params.OperatingMode == LVDBE_ON)||
+        (LVC_Mixer_GetCurrent(&pInstance->pData->BypassMixer.MixerStream[0])
+         !=LVC_Mixer_GetTarget(&pInstance->pData->BypassMixer.MixerStream[0])))
+    {
 
+        Copy_Float(pInData,                                            /* Source                */
+                   pScratch,                                           /* Destination           */
+                   (LVM_INT16)(2*NumSamples));                         /* Left and right        */
 
 
+        /*
+         * Apply the high pass filter if selected
+         */
+        if (pInstance->Params.HPFSelect == LVDBE_HPF_ON)
+        {
+              BQ_2I_D32F32C30_TRC_WRA_01_Float(&pInstance->pCoef->HPFInstance,/* Filter instance */
+                                               pScratch,                /* Source               */
+                                               pScratch,                /* Destination          */
+                                               (LVM_INT16)NumSamples);  /* Number of samples    */
+        }
+
+
+        /*
+         * Create the mono stream
+         */
+        From2iToMono_Float(pScratch,                                   /* Stereo source         */
+                           pMono,                                      /* Mono destination      */
+                           (LVM_INT16)NumSamples);                     /* Number of samples     */
+
+
+        /*
+         * Apply the band pass filter
+         */
+        BP_1I_D32F32C30_TRC_WRA_02_Float(&pInstance->pCoef->BPFInstance, /* Filter instance     */
+                                         pMono,                        /* Source                */
+                                         pMono,                        /* Destination           */
+                                         (LVM_INT16)NumSamples);       /* Number of samples     */
+
+
+        /*
+         * Apply the AGC and mix
+         */
+        AGC_MIX_VOL_2St1Mon_D32_WRA_Float(&pInstance->pData->AGCInstance, /* Instance pointer   */
+                                          pScratch,                    /* Stereo source         */
+                                          pMono,                       /* Mono band pass source */
+                                          pScratch,                    /* Stereo destination    */
+                                          LVDBE_SCALESHIFT,            /* Fixed point scaling   */
+                                          NumSamples);                 /* Number of samples     */
+
+    }
+
+    /* Bypass Volume path is processed when DBE is OFF or during On/Off transitions */
+    if ((pInstance->Params.OperatingMode == LVDBE_OFF)||
+        (LVC_Mixer_GetCurrent(&pInstance->pData->BypassMixer.MixerStream[1])
+         !=LVC_Mixer_GetTarget(&pInstance->pData->BypassMixer.MixerStream[1])))
+    {
+
+        /*
+         * The algorithm is disabled but volume management is required to compensate for
+         * headroom and volume (if enabled)
+         */
+        LVC_MixSoft_1St_D16C31_SAT_Float(&pInstance->pData->BypassVolume,
+                                         pInData,
+                                         pScratchVol,
+                                         (LVM_INT16)(2*NumSamples));   /* Left and right          */
+
+    }
+
+    /*
+     * Mix DBE processed path and bypass volume path
+     */
+    LVC_MixSoft_2St_D16C31_SAT_Float(&pInstance->pData->BypassMixer,
+                                     pScratch,
+                                     pScratchVol,
+                                     pOutData,
+                                     (LVM_INT16)(2*NumSamples));
+
+    return(LVDBE_SUCCESS);
+}
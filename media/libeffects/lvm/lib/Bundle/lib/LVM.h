@@ -120,6 +120,7 @@ typedef enum
     LVM_WRONGAUDIOTIME     = 5,                     /* Wrong time value for audio time*/
     LVM_ALGORITHMDISABLED  = 6,                     /* Algorithm is disabled*/
     LVM_ALGORITHMPSA       = 7,                     /* Algorithm PSA returns an error */
+    LVM_NOTSUPPORTED       = 8,                     /* Not supported in this buffer mode */
     LVM_RETURNSTATUS_DUMMY = LVM_MAXENUM
 } LVM_ReturnStatus_en;
 
@@ -521,6 +522,44 @@ LVM_ReturnStatus_en LVM_Process(LVM_Handle_t                hInstance,
                                 LVM_UINT32                  AudioTime);
 
 
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                LVM_Process_Float                                           */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*  Floating point process function for the LifeVibes module. Samples are LVM_FLOAT     */
+/*  with full scale +/-1.0. The equaliser, bass enhancement, volume, treble boost and   */
+/*  DC removal run in floating point; Concert Sound and the spectrum analyser run on a  */
+/*  16-bit copy of each block.                                                          */
+/*                                                                                      */
+/* PARAMETERS:                                                                          */
+/*  hInstance               Instance handle                                             */
+/*  pInData                 Pointer to the input data                                   */
+/*  pOutData                Pointer to the output data                                  */
+/*  NumSamples              Number of samples in the input buffer                       */
+/*  AudioTime               Audio Time of the current input data in milli-seconds       */
+/*                                                                                      */
+/* RETURNS:                                                                             */
+/*  LVM_SUCCESS            Succeeded                                                    */
+/*  LVM_INVALIDNUMSAMPLES  When the NumSamples is not a valied multiple                 */
+/*  LVM_ALIGNMENTERROR     When either the input our output buffers are not 32-bit      */
+/*                         aligned                                                      */
+/*  LVM_NULLADDRESS        When one of hInstance, pInData or pOutData is NULL           */
+/*  LVM_NOTSUPPORTED       When the instance uses managed buffers                       */
+/*                                                                                      */
+/* NOTES:                                                                               */
+/*  1. Only unmanaged buffer mode is supported                                          */
+/*  2. The output is not saturated                                                      */
+/*  3. Changing between LVM_Process and LVM_Process_Float clears the audio buffers      */
+/*                                                                                      */
+/****************************************************************************************/
+LVM_ReturnStatus_en LVM_Process_Float(LVM_Handle_t          hInstance,
+                                      const LVM_FLOAT       *pInData,
+                                      LVM_FLOAT             *pOutData,
+                                      LVM_UINT16            NumSamples,
+                                      LVM_UINT32            AudioTime);
+
+
 /****************************************************************************************/
 /*                                                                                      */
 /* FUNCTION:                LVM_SetHeadroomParams                                       */
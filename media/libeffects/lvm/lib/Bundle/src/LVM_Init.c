@@ -174,6 +174,11 @@ LVM_ReturnStatus_en LVM_GetMemoryTable(LVM_Handle_t         hInstance,
         InstAlloc_AddMember(&AllocMem[LVM_MEMREGION_PERSISTENT_SLOW_DATA],
                             sizeof(LVM_Buffer_t));
     }
+    else
+    {
+        InstAlloc_AddMember(&AllocMem[LVM_MEMREGION_TEMPORARY_FAST],        /* Float path conversion buffer */
+                            2 * InternalBlockSize * sizeof(LVM_INT16));
+    }
 
     /*
      * Treble Enhancement requirements
@@ -532,6 +537,8 @@ LVM_ReturnStatus_en LVM_GetInstanceHandle(LVM_Handle_t           *phInstance,
      * Common settings for managed and unmanaged buffers
      */
     pInstance->SamplesToProcess = 0;                /* No samples left to process */
+    pInstance->DataPath         = LVM_DATAPATH_NONE;
+    pInstance->pConvertBuffer   = LVM_NULL;
     if (pInstParams->BufferMode == LVM_MANAGED_BUFFERS)
     {
         /*
@@ -550,6 +557,14 @@ LVM_ReturnStatus_en LVM_GetInstanceHandle(LVM_Handle_t           *phInstance,
         pInstance->pBufferManagement->OutDelaySamples = 0;                     /* No samples in the output buffer */
         pInstance->pBufferManagement->BufferState = LVM_FIRSTCALL;             /* Set the state ready for the first call */
     }
+    else
+    {
+        /*
+         * Conversion buffer for the floating point path, ahead of the algorithm scratch
+         */
+        pInstance->pConvertBuffer = InstAlloc_AddMember(&AllocMem[LVM_MEMREGION_TEMPORARY_FAST],
+                                                        (LVM_UINT32)(2 * InternalBlockSize * sizeof(LVM_INT16)));
+    }
 
 
     /*
@@ -111,6 +111,11 @@ extern "C" {
 #define LVM_DBE_MASK                    4
 #define LVM_VC_MASK                     16
 #define LVM_TE_MASK                     32
+
+/* Data path used by the last process call, the filter taps are only valid for that path */
+#define LVM_DATAPATH_NONE               0         /* No data processed since the taps were cleared */
+#define LVM_DATAPATH_16BIT              1         /* LVM_Process */
+#define LVM_DATAPATH_FLOAT              2         /* LVM_Process_Float */
 #define LVM_PSA_MASK                    2048
 
 
@@ -183,6 +188,9 @@ typedef struct
     LVM_INT16               SamplesToProcess;   /* Input samples left to process */
     LVM_INT16               *pInputSamples;     /* External input sample pointer */
     LVM_INT16               *pOutputSamples;    /* External output sample pointer */
+    LVM_INT16               DataPath;           /* Data path of the last process call */
+    LVM_INT16               *pConvertBuffer;    /* 16-bit block for the fixed point modules */
+                                                /* on the floating point path */
 
     /* Configuration number */
     LVM_INT32               ConfigurationNumber;
@@ -106,6 +106,16 @@ LVM_ReturnStatus_en LVM_Process(LVM_Handle_t                hInstance,
     }
 
 
+    /*
+     * The filter taps hold floating point values after LVM_Process_Float
+     */
+    if (pInstance->DataPath == LVM_DATAPATH_FLOAT)
+    {
+        LVM_ClearAudioBuffers(hInstance);
+    }
+    pInstance->DataPath = LVM_DATAPATH_16BIT;
+
+
     /*
      * Update new parameters if necessary
      */
@@ -273,3 +283,260 @@ LVM_ReturnStatus_en LVM_Process(LVM_Handle_t                hInstance,
 
     return(LVM_SUCCESS);
 }
+
+
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                LVM_Process_Float                                           */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*  Floating point process function for the LifeVibes module. The blocks are processed */
+/*  in the same order as LVM_Process. Concert Sound and the spectrum analyser have no   */
+/*  floating point implementation, they run on a 16-bit copy of the block.              */
+/*                                                                                      */
+/* PARAMETERS:                                                                          */
+/*  hInstance               Instance handle                                             */
+/*  pInData                 Pointer to the input data                                   */
+/*  pOutData                Pointer to the output data                                  */
+/*  NumSamples              Number of samples in the input buffer                       */
+/*  AudioTime               Audio Time of the current input data in milli-seconds       */
+/*                                                                                      */
+/* RETURNS:                                                                             */
+/*  LVM_SUCCESS            Succeeded                                                    */
+/*  LVM_INVALIDNUMSAMPLES  When the NumSamples is not a valied multiple                 */
+/*  LVM_ALIGNMENTERROR     When either the input our output buffers are not 32-bit      */
+/*                         aligned                                                      */
+/*  LVM_NULLADDRESS        When one of hInstance, pInData or pOutData is NULL           */
+/*  LVM_NOTSUPPORTED       When the instance uses managed buffers                       */
+/*                                                                                      */
+/* NOTES:                                                                               */
+/*                                                                                      */
+/****************************************************************************************/
+
+LVM_ReturnStatus_en LVM_Process_Float(LVM_Handle_t          hInstance,
+                                      const LVM_FLOAT       *pInData,
+                                      LVM_FLOAT             *pOutData,
+                                      LVM_UINT16            NumSamples,
+                                      LVM_UINT32            AudioTime)
+{
+
+    LVM_Instance_t      *pInstance  = (LVM_Instance_t  *)hInstance;
+    LVM_UINT16          SampleCount = NumSamples;
+    LVM_FLOAT           *pInput     = (LVM_FLOAT *)pInData;
+    LVM_FLOAT           *pOutput    = pOutData;
+    LVM_FLOAT           *pToProcess;
+    LVM_FLOAT           *pProcessed;
+    LVM_INT16           BlockSize;
+    LVM_ReturnStatus_en  Status;
+
+    /*
+     * Check if the number of samples is zero
+     */
+    if (NumSamples == 0)
+    {
+        return(LVM_SUCCESS);
+    }
+
+
+    /*
+     * Check valid points have been given
+     */
+    if ((hInstance == LVM_NULL) || (pInData == LVM_NULL) || (pOutData == LVM_NULL))
+    {
+        return (LVM_NULLADDRESS);
+    }
+
+    /*
+     * The floating point path processes directly in the caller's buffers
+     */
+    if (pInstance->InstParams.BufferMode != LVM_UNMANAGED_BUFFERS)
+    {
+        return(LVM_NOTSUPPORTED);
+    }
+
+    /*
+     * Check if the number of samples is a good multiple
+     */
+    if ((NumSamples % pInstance->BlickSizeMultiple) != 0)
+    {
+        return(LVM_INVALIDNUMSAMPLES);
+    }
+
+    /*
+     * Check the buffer alignment
+     */
+    if ((((uintptr_t)pInData % 4) != 0) || (((uintptr_t)pOutData % 4) != 0))
+    {
+        return(LVM_ALIGNMENTERROR);
+    }
+
+
+    /*
+     * The filter taps hold 32-bit values after LVM_Process
+     */
+    if (pInstance->DataPath == LVM_DATAPATH_16BIT)
+    {
+        LVM_ClearAudioBuffers(hInstance);
+    }
+    pInstance->DataPath = LVM_DATAPATH_FLOAT;
+
+
+    /*
+     * Update new parameters if necessary
+     */
+    if (pInstance->ControlPending == LVM_TRUE)
+    {
+        Status = LVM_ApplyNewSettings(hInstance);
+
+        if(Status != LVM_SUCCESS)
+        {
+            return Status;
+        }
+    }
+
+
+    /*
+     * Convert from Mono if necessary
+     */
+    if (pInstance->Params.SourceFormat == LVM_MONO)
+    {
+        MonoTo2I_Float(pInData,                             /* Source */
+                       pOutData,                            /* Destination */
+                       (LVM_INT16)NumSamples);              /* Number of input samples */
+        pInput     = pOutData;
+    }
+
+
+    /*
+     * Process the data in blocks of at most the internal block size
+     */
+    while (SampleCount != 0)
+    {
+        if (SampleCount > pInstance->InternalBlockSize)
+        {
+            BlockSize = pInstance->InternalBlockSize;
+        }
+        else
+        {
+            BlockSize = (LVM_INT16)SampleCount;
+        }
+        pToProcess = pInput;
+        pProcessed = pOutput;
+
+        /*
+         * Apply ConcertSound if required
+         */
+        if (pInstance->CS_Active == LVM_TRUE)
+        {
+            FloatToInt16_Sat_Fltx16(pToProcess,
+                                    pInstance->pConvertBuffer,
+                                    (LVM_INT16)(2*BlockSize));      /* Left and right */
+            (void)LVCS_Process(pInstance->hCSInstance,              /* Concert Sound instance handle */
+                               pInstance->pConvertBuffer,
+                               pInstance->pConvertBuffer,
+                               (LVM_UINT16)BlockSize);
+            Int16ToFloat_16xFlt(pInstance->pConvertBuffer,
+                                pProcessed,
+                                (LVM_INT16)(2*BlockSize));          /* Left and right */
+            pToProcess = pProcessed;
+        }
+
+        /*
+         * Apply volume if required
+         */
+        if (pInstance->VC_Active!=0)
+        {
+            LVC_MixSoft_1St_D16C31_SAT_Float(&pInstance->VC_Volume,
+                                             pToProcess,
+                                             pProcessed,
+                                             (LVM_INT16)(2*BlockSize));     /* Left and right*/
+            pToProcess = pProcessed;
+        }
+
+        /*
+         * Call N-Band equaliser if enabled
+         */
+        if (pInstance->EQNB_Active == LVM_TRUE)
+        {
+            LVEQNB_Process_Float(pInstance->hEQNBInstance,      /* N-Band equaliser instance handle */
+                                 pToProcess,
+                                 pProcessed,
+                                 (LVM_UINT16)BlockSize);
+            pToProcess = pProcessed;
+        }
+
+        /*
+         * Call bass enhancement if enabled
+         */
+        if (pInstance->DBE_Active == LVM_TRUE)
+        {
+            LVDBE_Process_Float(pInstance->hDBEInstance,        /* Dynamic Bass Enhancement instance handle */
+                                pToProcess,
+                                pProcessed,
+                                (LVM_UINT16)BlockSize);
+            pToProcess = pProcessed;
+        }
+
+        /*
+         * Bypass mode or everything off, so copy the input to the output
+         */
+        if (pToProcess != pProcessed)
+        {
+            Copy_Float(pToProcess,                              /* Source */
+                       pProcessed,                              /* Destination */
+                       (LVM_INT16)(2*BlockSize));               /* Left and right */
+        }
+
+        /*
+         * Apply treble boost if required
+         */
+        if (pInstance->TE_Active == LVM_TRUE)
+        {
+            FO_2I_D16F32C15_LShx_TRC_WRA_01_Float(&pInstance->pTE_State->TrebleBoost_State,
+                                                  pProcessed,
+                                                  pProcessed,
+                                                  BlockSize);
+        }
+
+        /*
+         * Volume balance
+         */
+        LVC_MixSoft_1St_2i_D16C31_SAT_Float(&pInstance->VC_BalanceMix,
+                                            pProcessed,
+                                            pProcessed,
+                                            BlockSize);
+
+        /*
+         * Perform Parametric Spectum Analysis
+         */
+        if ((pInstance->Params.PSA_Enable == LVM_PSA_ON)&&(pInstance->InstParams.PSA_Included==LVM_PSA_ON))
+        {
+            FloatToInt16_Sat_Fltx16(pProcessed,
+                                    pInstance->pConvertBuffer,
+                                    (LVM_INT16)(2*BlockSize));      /* Left and right */
+            From2iToMono_16(pInstance->pConvertBuffer,
+                            pInstance->pPSAInput,
+                            BlockSize);
+
+            LVPSA_Process(pInstance->hPSAInstance,
+                          pInstance->pPSAInput,
+                          (LVM_UINT16)BlockSize,
+                          AudioTime);
+        }
+
+
+        /*
+         * DC removal
+         */
+        DC_2I_D16_TRC_WRA_01_Float(&pInstance->DC_RemovalInstance,
+                                   pProcessed,
+                                   pProcessed,
+                                   BlockSize);
+
+        pInput      += 2*BlockSize;
+        pOutput     += 2*BlockSize;
+        SampleCount  = (LVM_UINT16)(SampleCount - BlockSize);
+    }
+
+    return(LVM_SUCCESS);
+}
@@ -66,6 +66,13 @@ void AGC_MIX_VOL_2St1Mon_D32_WRA(AGC_MIX_VOL_2St1Mon_D32_t  *pInstance,     /* I
                                  LVM_INT32                  *pDst,          /* Stereo destination */
                                  LVM_UINT16                 n);             /* Number of samples */
 
+void AGC_MIX_VOL_2St1Mon_D32_WRA_Float(AGC_MIX_VOL_2St1Mon_D32_t  *pInstance,  /* Instance pointer */
+                                       const LVM_FLOAT            *pStSrc,     /* Stereo source */
+                                       const LVM_FLOAT            *pMonoSrc,   /* Mono source */
+                                       LVM_FLOAT                  *pDst,       /* Stereo destination */
+                                       LVM_INT16                  DataShift,   /* Fixed point data scaling */
+                                       LVM_UINT16                 n);          /* Number of samples */
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -322,6 +322,46 @@ void DC_2I_D16_TRC_WRA_01          (        Biquad_Instance_t       *pInstance,
                                             LVM_INT16               *pDataOut,
                                             LVM_INT16               NrSamples);
 
+/**********************************************************************************
+   FUNCTION PROTOTYPES: FLOATING POINT DATA PATH
+***********************************************************************************/
+
+/* These run on the instances of the fixed point filters of the same name and use */
+/* the same coefficients. The delay taps hold LVM_FLOAT values, so they must be   */
+/* cleared when an instance changes between the fixed and floating point paths.   */
+/* Except for the DC removal, the filtering is done by the shared multichannel    */
+/* biquad engine in libeffects/biquad.                                            */
+
+void BQ_2I_D32F32C30_TRC_WRA_01_Float (     Biquad_Instance_t       *pInstance,
+                                            LVM_FLOAT               *pDataIn,
+                                            LVM_FLOAT               *pDataOut,
+                                            LVM_INT16               NrSamples);
+
+void FO_2I_D16F32C15_LShx_TRC_WRA_01_Float( Biquad_Instance_t       *pInstance,
+                                            LVM_FLOAT               *pDataIn,
+                                            LVM_FLOAT               *pDataOut,
+                                            LVM_INT16               NrSamples);
+
+void BP_1I_D32F32C30_TRC_WRA_02_Float (     Biquad_Instance_t       *pInstance,
+                                            LVM_FLOAT               *pDataIn,
+                                            LVM_FLOAT               *pDataOut,
+                                            LVM_INT16               NrSamples);
+
+void PK_2I_D32F32C30G11_TRC_WRA_01_Float (  Biquad_Instance_t       *pInstance,
+                                            LVM_FLOAT               *pDataIn,
+                                            LVM_FLOAT               *pDataOut,
+                                            LVM_INT16               NrSamples);
+
+void PK_2I_D32F32C14G11_TRC_WRA_01_Float (  Biquad_Instance_t       *pInstance,
+                                            LVM_FLOAT               *pDataIn,
+                                            LVM_FLOAT               *pDataOut,
+                                            LVM_INT16               NrSamples);
+
+void DC_2I_D16_TRC_WRA_01_Float    (        Biquad_Instance_t       *pInstance,
+                                            LVM_FLOAT               *pDataIn,
+                                            LVM_FLOAT               *pDataOut,
+                                            LVM_INT16               NrSamples);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -169,6 +169,30 @@ void Int32RShiftToInt16_Sat_32x16(const  LVM_INT32  *src,
                                     LVM_INT16 n,
                                     LVM_INT16 shift );
 
+/**********************************************************************************
+    FLOATING POINT DATA PATH, FULL SCALE IS +/-1.0
+***********************************************************************************/
+
+void Copy_Float(              const LVM_FLOAT *src,
+                                    LVM_FLOAT *dst,
+                                    LVM_INT16 n );
+
+void MonoTo2I_Float(          const LVM_FLOAT *src,
+                                    LVM_FLOAT *dst,
+                                    LVM_INT16 n);
+
+void From2iToMono_Float(      const LVM_FLOAT *src,
+                                    LVM_FLOAT *dst,
+                                    LVM_INT16 n);
+
+void Int16ToFloat_16xFlt(     const LVM_INT16 *src,
+                                    LVM_FLOAT *dst,
+                                    LVM_INT16 n );
+
+void FloatToInt16_Sat_Fltx16( const LVM_FLOAT *src,
+                                    LVM_INT16 *dst,
+                                    LVM_INT16 n );
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
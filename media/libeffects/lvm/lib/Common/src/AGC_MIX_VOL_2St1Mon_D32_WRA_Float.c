@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/****************************************************************************************/
+/*                                                                                      */
+/*    Includes                                                                          */
+/*                                                                                      */
+/****************************************************************************************/
+
+#include "AGC.h"
+
+/****************************************************************************************/
+/*                                                                                      */
+/*    Defines                                                                           */
+/*                                                                                      */
+/****************************************************************************************/
+
+#define VOL_TC_SHIFT                                        21          /* As a power of 2 */
+#define DECAY_SHIFT                                        10           /* As a power of 2 */
+
+
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                  AGC_MIX_VOL_2St1Mon_D32_WRA_Float                         */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*    Floating point version of AGC_MIX_VOL_2St1Mon_D32_WRA. The gains are applied in   */
+/*    floating point while the AGC gain and volume are updated in the fixed point       */
+/*    instance exactly as the 32-bit version does, so the instance can be shared.       */
+/*                                                                                      */
+/* PARAMETERS:                                                                          */
+/*  pInstance               Instance pointer                                            */
+/*  pStereoIn               Stereo source                                               */
+/*  pMonoIn                 Mono band pass source                                       */
+/*  pStereoOut              Stereo destination                                          */
+/*  DataShift               Left shift applied to 16-bit samples by the fixed point     */
+/*                          caller, used to scale the AGC target level                  */
+/*                                                                                      */
+/* RETURNS:                                                                             */
+/*  Void                                                                                */
+/*                                                                                      */
+/* NOTES:                                                                               */
+/*  1. Samples are LVM_FLOAT with full scale +/-1.0                                     */
+/*                                                                                      */
+/****************************************************************************************/
+
+void AGC_MIX_VOL_2St1Mon_D32_WRA_Float(AGC_MIX_VOL_2St1Mon_D32_t  *pInstance,  /* Instance pointer */
+                                       const LVM_FLOAT            *pStSrc,     /* Stereo source */
+                                       const LVM_FLOAT            *pMonoSrc,   /* Mono source */
+                                       LVM_FLOAT                  *pDst,       /* Stereo destination */
+                                       LVM_INT16                  DataShift,   /* Fixed point data scaling */
+                                       LVM_UINT16                 NumSamples)  /* Number of samples */
+{
+
+    /*
+     * General variables
+     */
+    LVM_UINT16      i;                                          /* Sample index */
+    LVM_FLOAT       Left;                                       /* Left sample */
+    LVM_FLOAT       Right;                                      /* Right sample */
+    LVM_FLOAT       Mono;                                       /* Mono sample */
+    LVM_FLOAT       AbsPeak;                                    /* Absolute peak signal */
+    LVM_INT32       HighWord;                                   /* High word in intermediate calculations */
+    LVM_INT32       LowWord;                                    /* Low word in intermediate calculations */
+    LVM_FLOAT       AGC_Mult;                                   /* AGC gain */
+    LVM_FLOAT       Vol_Mult;                                   /* Volume gain */
+
+    /*
+     * Instance control variables
+     */
+    LVM_INT32      AGC_Gain      = pInstance->AGC_Gain;         /* Get the current AGC gain */
+    LVM_INT32      AGC_MaxGain   = pInstance->AGC_MaxGain;      /* Get maximum AGC gain */
+    LVM_INT16      AGC_Attack    = pInstance->AGC_Attack;       /* Attack scaler */
+    LVM_INT16      AGC_Decay     = pInstance->AGC_Decay;        /* Decay scaler */
+    LVM_INT32      Vol_Current   = pInstance->Volume;           /* Actual volume setting */
+    LVM_INT32      Vol_Target    = pInstance->Target;           /* Target volume setting */
+    LVM_INT16      Vol_TC        = pInstance->VolumeTC;         /* Time constant */
+
+    /*
+     * The fixed point version multiplies by the upper 16 bits of the gains, drops 16
+     * bits and then shifts left, so the float gains are the gains scaled by 2^(Shift-32)
+     */
+    const LVM_FLOAT AGC_Scale  = (LVM_FLOAT)(1L << pInstance->AGC_GainShift) * (1.0f / 4294967296.0f);
+    const LVM_FLOAT Vol_Scale  = (LVM_FLOAT)(1L << pInstance->VolumeShift) * (1.0f / 4294967296.0f);
+    const LVM_FLOAT AGC_Target = (LVM_FLOAT)pInstance->AGC_Target / (LVM_FLOAT)(1L << (15 + DataShift));
+
+
+    /*
+     * Process on a sample by sample basis
+     */
+    for (i=0;i<NumSamples;i++)                                  /* For each sample */
+    {
+
+        /*
+         * Get the scalers
+         */
+        AGC_Mult    = (LVM_FLOAT)(AGC_Gain & 0xFFFF0000) * AGC_Scale;
+        Vol_Mult    = (LVM_FLOAT)(Vol_Current & 0xFFFF0000) * Vol_Scale;
+
+
+        /*
+         * Get the input samples
+         */
+        Left  = *pStSrc++;                                      /* Get the left sample */
+        Right = *pStSrc++;                                      /* Get the right sample */
+        Mono  = *pMonoSrc++;                                    /* Get the mono sample */
+
+
+        /*
+         * Apply the AGC gain to the mono input and mix with the stereo signal
+         */
+        Mono   = Mono * AGC_Mult;
+        Left  += Mono;                                          /* Mix in the mono signal */
+        Right += Mono;
+
+
+        /*
+         * Apply the volume and write to the output stream
+         */
+        Left  = Left  * Vol_Mult;
+        Right = Right * Vol_Mult;
+        *pDst++ = Left;                                         /* Save the results */
+        *pDst++ = Right;
+
+
+        /*
+         * Update the AGC gain
+         */
+        AbsPeak = (Left < 0) ? -Left : Left;                    /* Get the absolute peak */
+        if (Right > AbsPeak)
+        {
+            AbsPeak = Right;
+        }
+        else if (-Right > AbsPeak)
+        {
+            AbsPeak = -Right;
+        }
+        if (AbsPeak > AGC_Target)
+        {
+            /*
+             * The signal is too large so decrease the gain
+             */
+            HighWord = (AGC_Attack * (AGC_Gain >> 16));         /* signed long (AGC_Gain) by unsigned short (AGC_Attack) multiply */
+            LowWord = (AGC_Attack * (AGC_Gain & 0xffff));
+            AGC_Gain = (HighWord + (LowWord >> 16)) << 1;
+        }
+        else
+        {
+            /*
+             * The signal is too small so increase the gain
+             */
+            if (AGC_Gain > AGC_MaxGain)
+            {
+                AGC_Gain -= (AGC_Decay << DECAY_SHIFT);
+            }
+            else
+            {
+                AGC_Gain += (AGC_Decay << DECAY_SHIFT);
+            }
+        }
+
+        /*
+         * Update the gain
+         */
+        Vol_Current += Vol_TC * ((Vol_Target - Vol_Current) >> VOL_TC_SHIFT);
+    }
+
+
+    /*
+     * Update the parameters
+     */
+    pInstance->Volume = Vol_Current;                            /* Actual volume setting */
+    pInstance->AGC_Gain = AGC_Gain;
+
+    return;
+
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BIQUAD.h"
+#include "BP_1I_D32F32Cll_TRC_WRA_02_Private.h"
+#include "BiquadBank.h"
+
+/**************************************************************************
+ Floating point version of BP_1I_D32F32C30_TRC_WRA_02, using the same
+ instance. Samples are LVM_FLOAT with full scale +/-1.0. The filtering is
+ done by the shared biquad engine with b1 = 0 and b2 = -b0.
+
+ COEFS-
+ pBiquadState->coefs[0] is A0,
+ pBiquadState->coefs[1] is -B2,
+ pBiquadState->coefs[2] is -B1, these are in Q30 format
+
+ DELAYS-
+ pBiquadState->pDelays holds the transposed direct form II state of the
+ shared biquad engine, two LVM_FLOAT values.
+***************************************************************************/
+
+void BP_1I_D32F32C30_TRC_WRA_02_Float ( Biquad_Instance_t       *pInstance,
+                                        LVM_FLOAT               *pDataIn,
+                                        LVM_FLOAT               *pDataOut,
+                                        LVM_INT16               NrSamples)
+    {
+        PFilter_State pBiquadState = (PFilter_State) pInstance;
+        biquad_coefs_t Coefs;
+
+        Coefs.b0 =  (LVM_FLOAT)pBiquadState->coefs[0] * (1.0f / (1 << 30));
+        Coefs.b1 =  0.0f;
+        Coefs.b2 = -Coefs.b0;
+        Coefs.a1 = -(LVM_FLOAT)pBiquadState->coefs[2] * (1.0f / (1 << 30));
+        Coefs.a2 = -(LVM_FLOAT)pBiquadState->coefs[1] * (1.0f / (1 << 30));
+
+        BiquadBank_process(&Coefs, 1, (LVM_FLOAT *)pBiquadState->pDelays, 1,
+                           pDataIn, pDataOut, (size_t)NrSamples);
+    }
@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BIQUAD.h"
+#include "DC_2I_D16_TRC_WRA_01_Private.h"
+
+/**************************************************************************
+ Floating point version of DC_2I_D16_TRC_WRA_01. The DC estimates stay in
+ the fixed point state (Q15 in the upper 16 bits) so the instance can be
+ shared with the 16-bit data path. The output is not saturated.
+***************************************************************************/
+
+void DC_2I_D16_TRC_WRA_01_Float( Biquad_Instance_t       *pInstance,
+                                 LVM_FLOAT               *pDataIn,
+                                 LVM_FLOAT               *pDataOut,
+                                 LVM_INT16               NrSamples)
+    {
+        LVM_INT32 LeftDC,RightDC;
+        LVM_FLOAT Diff;
+        LVM_INT32 j;
+        PFilter_State pBiquadState = (PFilter_State) pInstance;
+
+        LeftDC  =   pBiquadState->LeftDC;
+        RightDC =   pBiquadState->RightDC;
+        for(j=NrSamples-1;j>=0;j--)
+        {
+            /* Subtract DC */
+            Diff=*(pDataIn++)-(LVM_FLOAT)LeftDC*(1.0f/2147483648.0f);
+            *(pDataOut++)=Diff;
+            if (Diff < 0) {
+                LeftDC -= DC_D16_STEP; }
+            else {
+                LeftDC += DC_D16_STEP; }
+
+            /* Subtract DC */
+            Diff=*(pDataIn++)-(LVM_FLOAT)RightDC*(1.0f/2147483648.0f);
+            *(pDataOut++)=Diff;
+            if (Diff < 0) {
+                RightDC -= DC_D16_STEP; }
+            else {
+                RightDC += DC_D16_STEP; }
+
+        }
+        pBiquadState->LeftDC    =   LeftDC;
+        pBiquadState->RightDC   =   RightDC;
+
+    }
@@ -0,0 +1,56 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BIQUAD.h"
+#include "FO_2I_D16F32Css_LShx_TRC_WRA_01_Private.h"
+#include "BiquadBank.h"
+
+/**************************************************************************
+ Floating point version of FO_2I_D16F32C15_LShx_TRC_WRA_01, using the same
+ instance. Samples are LVM_FLOAT with full scale +/-1.0. The output is not
+ saturated. The filtering is done by the shared biquad engine as a first
+ order section, with the output gain folded into the numerator.
+
+ COEFS-
+ pBiquadState->coefs[0] is A1,
+ pBiquadState->coefs[1] is A0,
+ pBiquadState->coefs[2] is -B1, these are in Q15 format
+ pBiquadState->Shift    is the output gain as a power of 2
+
+ DELAYS-
+ pBiquadState->pDelays holds the transposed direct form II state of the
+ shared biquad engine, two LVM_FLOAT values per channel. The taps must be
+ cleared when switching between the fixed and floating point data paths.
+***************************************************************************/
+
+void FO_2I_D16F32C15_LShx_TRC_WRA_01_Float ( Biquad_Instance_t       *pInstance,
+                                             LVM_FLOAT               *pDataIn,
+                                             LVM_FLOAT               *pDataOut,
+                                             LVM_INT16               NrSamples)
+    {
+        PFilter_State pBiquadState = (PFilter_State) pInstance;
+        const LVM_FLOAT OutGain = (LVM_FLOAT)(1 << pBiquadState->Shift);
+        biquad_coefs_t Coefs;
+
+        Coefs.b0 =  (LVM_FLOAT)pBiquadState->coefs[1] * (OutGain / (1 << 15));
+        Coefs.b1 =  (LVM_FLOAT)pBiquadState->coefs[0] * (OutGain / (1 << 15));
+        Coefs.b2 =  0.0f;
+        Coefs.a1 = -(LVM_FLOAT)pBiquadState->coefs[2] * (1.0f / (1 << 15));
+        Coefs.a2 =  0.0f;
+
+        BiquadBank_process(&Coefs, 1, (LVM_FLOAT *)pBiquadState->pDelays, 2,
+                           pDataIn, pDataOut, (size_t)NrSamples);
+    }
@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**********************************************************************************
+   INCLUDE FILES
+***********************************************************************************/
+
+#include "VectorArithmetic.h"
+
+/**********************************************************************************
+   FUNCTION FloatToInt16_Sat_Fltx16
+
+   Converts floating point samples to Q15 with rounding and saturation.
+   src and dst must not overlap.
+***********************************************************************************/
+
+void FloatToInt16_Sat_Fltx16( const LVM_FLOAT *src,
+                                    LVM_INT16 *dst,
+                                    LVM_INT16 n )
+{
+    LVM_INT16 ii;
+    LVM_FLOAT Temp;
+
+    for (ii = n; ii != 0; ii--)
+    {
+        Temp = *src * 32768.0f;
+        if (Temp >= 32767.0f)
+        {
+            *dst = 0x7FFF;
+        }
+        else if (Temp <= -32768.0f)
+        {
+            *dst = (LVM_INT16)-0x8000;
+        }
+        else
+        {
+            *dst = (LVM_INT16)(Temp < 0 ? Temp - 0.5f : Temp + 0.5f);
+        }
+        src++;
+        dst++;
+    }
+
+    return;
+}
+
+/**********************************************************************************/
@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**********************************************************************************
+   INCLUDE FILES
+***********************************************************************************/
+
+#include "VectorArithmetic.h"
+
+/**********************************************************************************
+   FUNCTION Int16ToFloat_16xFlt
+
+   Converts Q15 samples to floating point, full scale is +/-1.0.
+   src and dst must not overlap.
+***********************************************************************************/
+
+void Int16ToFloat_16xFlt( const LVM_INT16 *src,
+                                LVM_FLOAT *dst,
+                                LVM_INT16 n )
+{
+    LVM_INT16 ii;
+
+    for (ii = n; ii != 0; ii--)
+    {
+        *dst = (LVM_FLOAT)*src * (1.0f / 32768.0f);
+        src++;
+        dst++;
+    }
+
+    return;
+}
+
+/**********************************************************************************/
@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**********************************************************************************
+   INCLUDE FILES
+***********************************************************************************/
+
+#include "LVC_Mixer_Private.h"
+
+/**********************************************************************************
+   FUNCTION LVC_Core_MixHard_2St_D16C31_SAT_Float
+***********************************************************************************/
+
+void LVC_Core_MixHard_2St_D16C31_SAT_Float( LVMixer3_st *ptrInstance1,
+                                    LVMixer3_st         *ptrInstance2,
+                                    const LVM_FLOAT     *src1,
+                                    const LVM_FLOAT     *src2,
+                                          LVM_FLOAT     *dst,
+                                          LVM_INT16     n)
+{
+    LVM_INT16 ii;
+    Mix_Private_st  *pInstance1=(Mix_Private_st *)(ptrInstance1->PrivateParams);
+    Mix_Private_st  *pInstance2=(Mix_Private_st *)(ptrInstance2->PrivateParams);
+    const LVM_FLOAT Gain1 = LVC_MIXER_GAIN_FLOAT(pInstance1->Current, pInstance1->Shift);
+    const LVM_FLOAT Gain2 = LVC_MIXER_GAIN_FLOAT(pInstance2->Current, pInstance2->Shift);
+
+    for (ii = n; ii != 0; ii--){
+        *dst++ = *(src1++) * Gain1 + *(src2++) * Gain2;
+    }
+}
+
+/**********************************************************************************/
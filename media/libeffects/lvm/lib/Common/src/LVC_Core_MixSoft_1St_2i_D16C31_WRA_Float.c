@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**********************************************************************************
+   INCLUDE FILES
+***********************************************************************************/
+
+#include "LVC_Mixer_Private.h"
+
+/**********************************************************************************
+   FUNCTION LVC_Core_MixSoft_1St_2i_D16C31_WRA_Float
+***********************************************************************************/
+
+void LVC_Core_MixSoft_1St_2i_D16C31_WRA_Float( LVMixer3_st  *ptrInstance1,
+                                         LVMixer3_st        *ptrInstance2,
+                                         const LVM_FLOAT    *src,
+                                         LVM_FLOAT          *dst,
+                                         LVM_INT16          n)
+{
+    LVM_INT16   OutLoop;
+    LVM_INT16   InLoop;
+    LVM_INT32   ii;
+    Mix_Private_st  *pInstanceL=(Mix_Private_st *)(ptrInstance1->PrivateParams);
+    Mix_Private_st  *pInstanceR=(Mix_Private_st *)(ptrInstance2->PrivateParams);
+
+    LVM_INT32   DeltaL=pInstanceL->Delta;
+    LVM_INT32   CurrentL=pInstanceL->Current;
+    LVM_INT32   TargetL=pInstanceL->Target;
+
+    LVM_INT32   DeltaR=pInstanceR->Delta;
+    LVM_INT32   CurrentR=pInstanceR->Current;
+    LVM_INT32   TargetR=pInstanceR->Target;
+
+    LVM_FLOAT   GainL;
+    LVM_FLOAT   GainR;
+
+    InLoop = (LVM_INT16)(n >> 2); /* Process per 4 samples */
+    OutLoop = (LVM_INT16)(n - (InLoop << 2));
+
+    if (OutLoop)
+    {
+        LVC_MIXER_STEP(CurrentL, TargetL, DeltaL);
+        LVC_MIXER_STEP(CurrentR, TargetR, DeltaR);
+        GainL = LVC_MIXER_GAIN_FLOAT(CurrentL, 0);
+        GainR = LVC_MIXER_GAIN_FLOAT(CurrentR, 0);
+
+        for (ii = OutLoop; ii != 0; ii--)
+        {
+            dst[0] = src[0] * GainL;
+            dst[1] = src[1] * GainR;
+            src += 2;
+            dst += 2;
+        }
+    }
+
+    for (ii = InLoop; ii != 0; ii--)
+    {
+        LVC_MIXER_STEP(CurrentL, TargetL, DeltaL);
+        LVC_MIXER_STEP(CurrentR, TargetR, DeltaR);
+        GainL = LVC_MIXER_GAIN_FLOAT(CurrentL, 0);
+        GainR = LVC_MIXER_GAIN_FLOAT(CurrentR, 0);
+
+        dst[0] = src[0] * GainL;
+        dst[1] = src[1] * GainR;
+        dst[2] = src[2] * GainL;
+        dst[3] = src[3] * GainR;
+        dst[4] = src[4] * GainL;
+        dst[5] = src[5] * GainR;
+        dst[6] = src[6] * GainL;
+        dst[7] = src[7] * GainR;
+        src += 8;
+        dst += 8;
+    }
+    pInstanceL->Current=CurrentL;
+    pInstanceR->Current=CurrentR;
+}
+
+/**********************************************************************************/
@@ -0,0 +1,66 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**********************************************************************************
+   INCLUDE FILES
+***********************************************************************************/
+
+#include "LVC_Mixer_Private.h"
+
+/**********************************************************************************
+   FUNCTION LVC_Core_MixSoft_1St_D16C31_WRA_Float
+***********************************************************************************/
+
+void LVC_Core_MixSoft_1St_D16C31_WRA_Float( LVMixer3_st *ptrInstance,
+                                    const LVM_FLOAT     *src,
+                                          LVM_FLOAT     *dst,
+                                          LVM_INT16     n)
+{
+    LVM_INT16   OutLoop;
+    LVM_INT16   InLoop;
+    LVM_INT32   ii;
+    Mix_Private_st  *pInstance=(Mix_Private_st *)(ptrInstance->PrivateParams);
+    LVM_INT32   Delta=pInstance->Delta;
+    LVM_INT32   Current=pInstance->Current;
+    LVM_INT32   Target=pInstance->Target;
+    LVM_INT32   Shift=pInstance->Shift;
+    LVM_FLOAT   Gain;
+
+    InLoop = (LVM_INT16)(n >> 2); /* Process per 4 samples */
+    OutLoop = (LVM_INT16)(n - (InLoop << 2));
+
+    if (OutLoop){
+        LVC_MIXER_STEP(Current, Target, Delta);
+        Gain = LVC_MIXER_GAIN_FLOAT(Current, Shift);
+        for (ii = OutLoop; ii != 0; ii--){
+            *(dst++) = *(src++) * Gain;
+        }
+    }
+
+    for (ii = InLoop; ii != 0; ii--){
+        LVC_MIXER_STEP(Current, Target, Delta);
+        Gain = LVC_MIXER_GAIN_FLOAT(Current, Shift);
+        dst[0] = src[0] * Gain;
+        dst[1] = src[1] * Gain;
+        dst[2] = src[2] * Gain;
+        dst[3] = src[3] * Gain;
+        src += 4;
+        dst += 4;
+    }
+    pInstance->Current=Current;
+}
+
+/**********************************************************************************/
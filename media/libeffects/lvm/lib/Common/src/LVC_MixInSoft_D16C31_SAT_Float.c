@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**********************************************************************************
+   INCLUDE FILES
+***********************************************************************************/
+
+#include "LVC_Mixer_Private.h"
+#include "VectorArithmetic.h"
+#include "ScalarArithmetic.h"
+
+/**********************************************************************************
+   DEFINITIONS
+***********************************************************************************/
+
+#define TRUE          1
+#define FALSE         0
+
+/**********************************************************************************
+   FUNCTION LVC_MixInSoft_D16C31_SAT_Float
+***********************************************************************************/
+
+void LVC_MixInSoft_D16C31_SAT_Float( LVMixer3_1St_st *ptrInstance,
+                                  const LVM_FLOAT             *src,
+                                        LVM_FLOAT             *dst,
+                                        LVM_INT16             n)
+{
+    char        HardMixing = TRUE;
+    LVM_INT32   TargetGain;
+    LVM_FLOAT   Gain;
+    LVM_INT16   ii;
+    Mix_Private_st  *pInstance=(Mix_Private_st *)(ptrInstance->MixerStream[0].PrivateParams);
+
+    if(n<=0)    return;
+
+    /******************************************************************************
+       SOFT MIXING
+    *******************************************************************************/
+    if (pInstance->Current != pInstance->Target)
+    {
+        if(pInstance->Delta == 0x7FFFFFFF){
+            pInstance->Current = pInstance->Target;
+            TargetGain=pInstance->Target>>(16-pInstance->Shift);  // TargetGain in Q16.15 format
+            LVC_Mixer_SetTarget(&(ptrInstance->MixerStream[0]),TargetGain);
+        }else if (Abs_32(pInstance->Current-pInstance->Target) < pInstance->Delta){
+            pInstance->Current = pInstance->Target; /* Difference is not significant anymore.  Make them equal. */
+            TargetGain=pInstance->Target>>(16-pInstance->Shift);  // TargetGain in Q16.15 format
+            LVC_Mixer_SetTarget(&(ptrInstance->MixerStream[0]),TargetGain);
+        }else{
+            /* Soft mixing has to be applied */
+            HardMixing = FALSE;
+            LVC_Core_MixInSoft_D16C31_SAT_Float( &(ptrInstance->MixerStream[0]), src, dst, n);
+        }
+    }
+
+    /******************************************************************************
+       HARD MIXING
+    *******************************************************************************/
+
+    if (HardMixing){
+        if (pInstance->Target != 0){ /* Nothing to do in case Target = 0 */
+            if ((pInstance->Target>>16) == 0x7FFF){
+                Gain = (LVM_FLOAT)(1L << pInstance->Shift);
+            }
+            else{
+                Gain = LVC_MIXER_GAIN_FLOAT(pInstance->Target, pInstance->Shift);
+                pInstance->Current = pInstance->Target; /* In case the LVCore function would have changed the Current value */
+            }
+            for (ii = n; ii != 0; ii--){
+                *dst++ += *src++ * Gain;
+            }
+        }
+    }
+
+    /******************************************************************************
+       CALL BACK
+    *******************************************************************************/
+
+    if (ptrInstance->MixerStream[0].CallbackSet){
+        if (Abs_32(pInstance->Current-pInstance->Target) < pInstance->Delta){
+            pInstance->Current = pInstance->Target; /* Difference is not significant anymore.  Make them equal. */
+            TargetGain=pInstance->Target>>(16-pInstance->Shift);  // TargetGain in Q16.15 format
+            LVC_Mixer_SetTarget(ptrInstance->MixerStream,TargetGain);
+            ptrInstance->MixerStream[0].CallbackSet = FALSE;
+            if (ptrInstance->MixerStream[0].pCallBack != 0){
+                (*ptrInstance->MixerStream[0].pCallBack) ( ptrInstance->MixerStream[0].pCallbackHandle, ptrInstance->MixerStream[0].pGeneralPurpose,ptrInstance->MixerStream[0].CallbackParam );
+            }
+        }
+    }
+}
+
+/**********************************************************************************/
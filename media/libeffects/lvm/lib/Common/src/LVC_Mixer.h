@@ -125,6 +125,34 @@ void LVC_MixSoft_1St_2i_D16C31_SAT( LVMixer3_2St_st         *pInstance,
                                         LVM_INT16           *dst,   /* dst can be equal to src */
                                         LVM_INT16           n);     /* Number of stereo samples */
 
+/*** Float functions **************************************************************/
+
+/**********************************************************************************/
+/* Floating point data path versions of the functions above. They use the same    */
+/* instances, ramp the gains in the same steps and make the same callbacks, so a  */
+/* mixer can be shared with the 16 bit data path. Outputs are not saturated.      */
+/**********************************************************************************/
+void LVC_MixSoft_1St_D16C31_SAT_Float( LVMixer3_1St_st *pInstance,
+                                  const LVM_FLOAT           *src,
+                                        LVM_FLOAT           *dst,
+                                        LVM_INT16           n);
+
+void LVC_MixInSoft_D16C31_SAT_Float( LVMixer3_1St_st *pInstance,
+                                  const LVM_FLOAT           *src,
+                                        LVM_FLOAT           *dst,
+                                        LVM_INT16           n);
+
+void LVC_MixSoft_2St_D16C31_SAT_Float( LVMixer3_2St_st *pInstance,
+                                const LVM_FLOAT             *src1,
+                                const LVM_FLOAT             *src2,
+                                      LVM_FLOAT             *dst,  /* dst cannot be equal to src2 */
+                                      LVM_INT16             n);
+
+void LVC_MixSoft_1St_2i_D16C31_SAT_Float( LVMixer3_2St_st   *pInstance,
+                                const   LVM_FLOAT           *src,
+                                        LVM_FLOAT           *dst,   /* dst can be equal to src */
+                                        LVM_INT16           n);     /* Number of stereo samples */
+
 
 #ifdef __cplusplus
 }
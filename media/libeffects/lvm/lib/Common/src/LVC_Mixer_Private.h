@@ -24,6 +24,7 @@
 
 #include "LVC_Mixer.h"
 #include "VectorArithmetic.h"
+#include "LVM_Macros.h"
 
 /* Instance parameter structure */
 typedef struct
@@ -40,6 +41,22 @@ typedef struct
 /**********************************************************************************
    DEFINITIONS
 ***********************************************************************************/
+
+/* Gain of a mixer stream as a float, including the integer part given by Shift */
+#define LVC_MIXER_GAIN_FLOAT(Current, Shift)                                            \
+        ((LVM_FLOAT)(Current) * (1.0f / 2147483648.0f) * (LVM_FLOAT)(1L << (Shift)))
+
+/* Moves Current one Delta towards Target, as the soft mixers do every 4 samples */
+#define LVC_MIXER_STEP(Current, Target, Delta)                                          \
+        {LVM_INT32 LVC_MIXER_STEP_Temp;                                                 \
+         if ((Current) < (Target)) {                                                    \
+            ADD2_SAT_32x32((Current),(Delta),LVC_MIXER_STEP_Temp);                      \
+            (Current) = (LVC_MIXER_STEP_Temp > (Target)) ? (Target) : LVC_MIXER_STEP_Temp; \
+         } else {                                                                       \
+            (Current) -= (Delta);                                                       \
+            if ((Current) < (Target)) (Current) = (Target);                             \
+         }                                                                              \
+        }
 #define LVCore_MixInSoft_D32C31_SAT    LVCore_InSoft_D32C31_SAT
 #define LVCore_MixSoft_1St_D32C31_WRA  LVCore_Soft_1St_D32C31_WRA
 #define LVCore_MixHard_2St_D32C31_SAT  LVCore_Hard_2St_D32C31_SAT
@@ -113,6 +130,40 @@ void LVC_Core_MixHard_2St_D32C31_SAT( LVMixer3_st *pInstance1,
                                           LVM_INT32     *dst,
                                           LVM_INT16     n);
 
+/*** Float functions **************************************************************/
+
+/* These apply the integer part of the gain (Shift) themselves, except for the 2i */
+/* functions which only support gains up to 1.0 as their 16 bit versions do.      */
+
+void LVC_Core_MixInSoft_D16C31_SAT_Float( LVMixer3_st *pInstance,
+                                    const LVM_FLOAT     *src,
+                                          LVM_FLOAT     *dst,
+                                          LVM_INT16     n);
+
+void LVC_Core_MixSoft_1St_D16C31_WRA_Float( LVMixer3_st *pInstance,
+                                    const LVM_FLOAT     *src,
+                                          LVM_FLOAT     *dst,
+                                          LVM_INT16     n);
+
+void LVC_Core_MixHard_2St_D16C31_SAT_Float( LVMixer3_st *pInstance1,
+                                    LVMixer3_st         *pInstance2,
+                                    const LVM_FLOAT     *src1,
+                                    const LVM_FLOAT     *src2,
+                                          LVM_FLOAT     *dst,
+                                          LVM_INT16     n);
+
+void LVC_Core_MixSoft_1St_2i_D16C31_WRA_Float( LVMixer3_st  *ptrInstance1,
+                                         LVMixer3_st        *ptrInstance2,
+                                         const LVM_FLOAT    *src,
+                                         LVM_FLOAT          *dst,   /* dst can be equal to src */
+                                         LVM_INT16          n);     /* Number of stereo samples */
+
+void LVC_Core_MixHard_1St_2i_D16C31_SAT_Float( LVMixer3_st  *ptrInstance1,
+                                         LVMixer3_st        *ptrInstance2,
+                                         const LVM_FLOAT    *src,
+                                         LVM_FLOAT          *dst,    /* dst can be equal to src */
+                                         LVM_INT16          n);      /* Number of stereo samples */
+
 /**********************************************************************************/
 
 #endif //#ifndef __LVC_MIXER_PRIVATE_H__
@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "BIQUAD.h"
+#include "PK_2I_D32F32CllGss_TRC_WRA_01_Private.h"
+#include "BiquadBank.h"
+
+/**************************************************************************
+ Floating point version of PK_2I_D32F32C30G11_TRC_WRA_01, using the same
+ instance. Samples are LVM_FLOAT with full scale +/-1.0.
+
+ The peaking filter adds Gain times a band pass output to its input. This
+ is the single biquad
+   (1 + Gain * A0) + B1 z^-1 + (B2 - Gain * A0) z^-2
+   -------------------------------------------------
+                 1 + B1 z^-1 + B2 z^-2
+ which the shared biquad engine runs on both channels in parallel.
+
+ COEFS-
+ pBiquadState->coefs[0] is A0,
+ pBiquadState->coefs[1] is -B2,
+ pBiquadState->coefs[2] is -B1, these are in Q30 format
+ pBiquadState->coefs[3] is Gain, in Q11 format
+
+ DELAYS-
+ pBiquadState->pDelays holds the transposed direct form II state of the
+ shared biquad engine, two LVM_FLOAT values per channel. The taps must be
+ cleared when switching between the fixed and floating point data paths.
+***************************************************************************/
+
+void PK_2I_D32F32C30G11_TRC_WRA_01_Float ( Biquad_Instance_t       *pInstance,
+                                           LVM_FLOAT               *pDataIn,
+                                           LVM_FLOAT               *pDataOut,
+                                           LVM_INT16               NrSamples)
+    {
+        PFilter_State pBiquadState = (PFilter_State) pInstance;
+        const LVM_FLOAT A0   = (LVM_FLOAT)pBiquadState->coefs[0] * (1.0f / (1 << 30));
+        const LVM_FLOAT B2   = -(LVM_FLOAT)pBiquadState->coefs[1] * (1.0f / (1 << 30));
+        const LVM_FLOAT B1   = -(LVM_FLOAT)pBiquadState->coefs[2] * (1.0f / (1 << 30));
+        const LVM_FLOAT Gain = (LVM_FLOAT)pBiquadState->coefs[3] * (1.0f / (1 << 11));
+        biquad_coefs_t Coefs;
+
+        Coefs.b0 = 1.0f + Gain * A0;
+        Coefs.b1 = B1;
+        Coefs.b2 = B2 - Gain * A0;
+        Coefs.a1 = B1;
+        Coefs.a2 = B2;
+
+        BiquadBank_process(&Coefs, 1, (LVM_FLOAT *)pBiquadState->pDelays, 2,
+                           pDataIn, pDataOut, (size_t)NrSamples);
+    }
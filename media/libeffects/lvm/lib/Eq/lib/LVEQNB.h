@@ -467,6 +467,38 @@ LVEQNB_ReturnStatus_en LVEQNB_Process(LVEQNB_Handle_t       hInstance,
                                       LVM_UINT16            NumSamples);
 
 
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                LVEQNB_Process_Float                                        */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*  Floating point process function for the N-Band Equaliser module. Samples are        */
+/*  LVM_FLOAT with full scale +/-1.0 and the output is not saturated.                   */
+/*                                                                                      */
+/* PARAMETERS:                                                                          */
+/*  hInstance               Instance handle                                             */
+/*  pInData                 Pointer to the input data                                   */
+/*  pOutData                Pointer to the output data                                  */
+/*  NumSamples              Number of samples in the input buffer                       */
+/*                                                                                      */
+/* RETURNS:                                                                             */
+/*  LVEQNB_SUCCESS          Succeeded                                                   */
+/*  LVEQNB_NULLADDRESS      When hInstance, pInData or pOutData are NULL                */
+/*  LVEQNB_ALIGNMENTERROR   When pInData or pOutData are not 32-bit aligned             */
+/*  LVEQNB_TOOMANYSAMPLES   NumSamples was larger than the maximum block size           */
+/*                                                                                      */
+/* NOTES:                                                                               */
+/*  1. The filter taps are shared with LVEQNB_Process and must be cleared when          */
+/*     changing between the two                                                         */
+/*                                                                                      */
+/****************************************************************************************/
+
+LVEQNB_ReturnStatus_en LVEQNB_Process_Float(LVEQNB_Handle_t       hInstance,
+                                            const LVM_FLOAT       *pInData,
+                                            LVM_FLOAT             *pOutData,
+                                            LVM_UINT16            NumSamples);
+
+
 
 #ifdef __cplusplus
 }
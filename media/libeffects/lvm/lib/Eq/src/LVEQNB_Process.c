@@ -195,6 +195,161 @@ LVEQNB_ReturnStatus_en LVEQNB_Process(LVEQNB_Handle_t       hInstance,
 
 
 
+    return(LVEQNB_SUCCESS);
+
+}
+
+
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                LVEQNB_Process_Float                                        */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*  Floating point process function for the N-Band Equaliser module. The band filters   */
+/*  run directly on the output buffer, the scratch is only used for the bypass mix      */
+/*  during on/off transitions.                                                          */
+/*                                                                                      */
+/* PARAMETERS:                                                                          */
+/*  hInstance               Instance handle                                             */
+/*  pInData                 Pointer to the input data                                   */
+/*  pOutData                Pointer to the output data                                  */
+/*  NumSamples              Number of samples in the input buffer                       */
+/*                                                                                      */
+/* RETURNS:                                                                             */
+/*  LVEQNB_SUCCESS          Succeeded                                                   */
+/*  LVEQNB_NULLADDRESS      When hInstance, pInData or pOutData are NULL                */
+/*  LVEQNB_ALIGNMENTERROR   When pInData or pOutData are not 32-bit aligned             */
+/*  LVEQNB_TOOMANYSAMPLES   NumSamples was larger than the maximum block size           */
+/*                                                                                      */
+/* NOTES:                                                                               */
+/*                                                                                      */
+/****************************************************************************************/
+
+LVEQNB_ReturnStatus_en LVEQNB_Process_Float(LVEQNB_Handle_t       hInstance,
+                                            const LVM_FLOAT       *pInData,
+                                            LVM_FLOAT             *pOutData,
+                                            LVM_UINT16            NumSamples)
+{
+
+    LVM_UINT16          i;
+    Biquad_Instance_t   *pBiquad;
+    LVEQNB_Instance_t   *pInstance = (LVEQNB_Instance_t  *)hInstance;
+    LVM_FLOAT           *pWork;
+
+
+     /* Check for NULL pointers */
+    if((hInstance == LVM_NULL) || (pInData == LVM_NULL) || (pOutData == LVM_NULL))
+    {
+        return LVEQNB_NULLADDRESS;
+    }
+
+    /* Check if the input and output data buffers are 32-bit aligned */
+    if ((((uintptr_t)pInData % 4) != 0) || (((uintptr_t)pOutData % 4) != 0))
+    {
+        return LVEQNB_ALIGNMENTERROR;
+    }
+
+    /*
+    * Check the number of samples is not too large
+    */
+    if (NumSamples > pInstance->Capabilities.MaxBlockSize)
+    {
+        return(LVEQNB_TOOMANYSAMPLES);
+    }
+
+    if (pInstance->Params.OperatingMode == LVEQNB_ON)
+    {
+        /*
+         * The input is still needed for the bypass mix during a transition
+         */
+        if (pInstance->bInOperatingModeTransition == LVM_TRUE)
+        {
+            pWork = (LVM_FLOAT *)pInstance->pFastTemporary;
+        }
+        else
+        {
+            pWork = pOutData;
+        }
+
+        if (pWork != pInData)
+        {
+            Copy_Float(pInData,                                 /* Source */
+                       pWork,                                   /* Destination */
+                       (LVM_INT16)(2*NumSamples));              /* Left and Right */
+        }
+
+        /*
+         * For each section execte the filter unless the gain is 0dB
+         */
+        for (i=0; i<pInstance->NBands; i++)
+        {
+            /*
+             * Check if band is non-zero dB gain
+             */
+            if (pInstance->pBandDefinitions[i].Gain != 0)
+            {
+                /*
+                 * Get the address of the biquad instance
+                 */
+                pBiquad = &pInstance->pEQNB_FilterState[i];
+
+
+                /*
+                 * Select single or double precision as required
+                 */
+                switch (pInstance->pBiquadType[i])
+                {
+                    case LVEQNB_SinglePrecision:
+                    {
+                        PK_2I_D32F32C14G11_TRC_WRA_01_Float(pBiquad,
+                                                            pWork,
+                                                            pWork,
+                                                            (LVM_INT16)NumSamples);
+                        break;
+                    }
+
+                    case LVEQNB_DoublePrecision:
+                    {
+                        PK_2I_D32F32C30G11_TRC_WRA_01_Float(pBiquad,
+                                                            pWork,
+                                                            pWork,
+                                                            (LVM_INT16)NumSamples);
+                        break;
+                    }
+                    default:
+                        break;
+                }
+            }
+        }
+
+
+        if(pInstance->bInOperatingModeTransition == LVM_TRUE){
+                LVC_MixSoft_2St_D16C31_SAT_Float(&pInstance->BypassMixer,
+                                                 pWork,
+                                                 pInData,
+                                                 pWork,
+                                                 (LVM_INT16)(2*NumSamples));
+
+                Copy_Float(pWork,                                       /* Source */
+                           pOutData,                                    /* Destination */
+                           (LVM_INT16)(2*NumSamples));                  /* Left and Right samples */
+        }
+    }
+    else
+    {
+        /*
+         * Mode is OFF so copy the data if necessary
+         */
+        if (pInData != pOutData)
+        {
+            Copy_Float(pInData,                                 /* Source */
+                       pOutData,                                /* Destination */
+                       (LVM_INT16)(2*NumSamples));              /* Left and Right samples */
+        }
+    }
+
+
+
     return(LVEQNB_SUCCESS);
 
 }
@@ -113,6 +113,7 @@ typedef struct
     LVM_UINT16                  Density;                /* Echo density, 0 to 100 for minimum to maximum density */
     LVM_UINT16                  Damping;                /* Damping */
     LVM_UINT16                  RoomSize;               /* Simulated room size, 1 to 100 for minimum to maximum size */
+    LVM_Mode_en                 HalfRateTail;           /* Run the delay network at half the sample rate, see LVREV_Process_Float */
 
 } LVREV_ControlParams_st;
 
@@ -303,6 +304,37 @@ LVREV_ReturnStatus_en LVREV_Process(LVREV_Handle_t      hInstance,
                                     const LVM_UINT16          NumSamples);
 
 
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                LVREV_Process_Float                                         */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*  Floating point process function for the LVREV module. Samples are LVM_FLOAT with    */
+/*  full scale +/-1.0. When HalfRateTail is on and the sample rate is 32kHz or more,    */
+/*  the input is decimated by two before the delay network and its output is            */
+/*  interpolated back, which roughly halves the cost of the reverb.                     */
+/*                                                                                      */
+/* PARAMETERS:                                                                          */
+/*  hInstance               Instance handle                                             */
+/*  pInData                 Pointer to the input data                                   */
+/*  pOutData                Pointer to the output data                                  */
+/*  NumSamples              Number of samples in the input buffer                       */
+/*                                                                                      */
+/* RETURNS:                                                                             */
+/*  LVREV_SUCCESS           Succeeded                                                   */
+/*  LVREV_NULLADDRESS       When one of hInstance, pInData or pOutData is NULL          */
+/*                                                                                      */
+/* NOTES:                                                                               */
+/*  1. The output is not saturated                                                      */
+/*  2. Switching between LVREV_Process and LVREV_Process_Float clears the audio buffers */
+/*                                                                                      */
+/****************************************************************************************/
+LVREV_ReturnStatus_en LVREV_Process_Float(LVREV_Handle_t      hInstance,
+                                          const LVM_FLOAT     *pInData,
+                                          LVM_FLOAT           *pOutData,
+                                          const LVM_UINT16    NumSamples);
+
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
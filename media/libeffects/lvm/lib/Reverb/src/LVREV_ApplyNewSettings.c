@@ -595,6 +595,144 @@ LVREV_ReturnStatus_en LVREV_ApplyNewSettings (LVREV_Instance_st     *pPrivate)
 }
 
 
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                LVREV_FloatCoefs                                            */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*  Converts first order filter coefficients from Q31 to floating point                 */
+/*                                                                                      */
+/****************************************************************************************/
+static void LVREV_FloatCoefs(const FO_C32_Coefs_t  *pCoeffs,
+                             LVM_FLOAT             *pFloatCoefs)
+{
+    pFloatCoefs[0] = (LVM_FLOAT)pCoeffs->A1 / 2147483648.0f;
+    pFloatCoefs[1] = (LVM_FLOAT)pCoeffs->A0 / 2147483648.0f;
+    pFloatCoefs[2] = (LVM_FLOAT)pCoeffs->B1 / 2147483648.0f;    /* -B1 is stored in B1 */
+}
+
+
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                LVREV_ApplyNewSettings_Float                                */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*  Updates the floating point coefficients from the current parameters. The filters   */
+/*  and the fixed delays are designed for the rate the delay network runs at, which is  */
+/*  half the sample rate when the half rate tail is on. Gains and mixer targets are     */
+/*  shared with the fixed point path and are read when processing.                      */
+/*                                                                                      */
+/* PARAMETERS:                                                                          */
+/*  pPrivate                Pointer to the instance private parameters                  */
+/*                                                                                      */
+/* NOTES:                                                                               */
+/*  1. LVREV_ApplyNewSettings must have been called first                               */
+/*  2. The audio buffers are cleared when the delay network rate changes                */
+/*                                                                                      */
+/****************************************************************************************/
+void LVREV_ApplyNewSettings_Float(LVREV_Instance_st     *pPrivate)
+{
+    LVREV_FloatCoefs_st *pCoefs = &pPrivate->FloatCoefs;
+    LVM_Fs_en           CoreRate = pPrivate->CurrentParams.SampleRate;
+    LVM_INT16           bHalfRate = LVM_FALSE;
+    LVM_INT32           Fs;
+    LVM_INT32           Omega;
+    FO_C32_Coefs_t      Coeffs;
+    LVM_INT16           i;
+    LVM_INT16           Damping      = (LVM_INT16)((pPrivate->CurrentParams.Damping * 100) + 1000);
+    LVM_INT32           ScaleTable[] = {LVREV_T_3_Power_0_on_4, LVREV_T_3_Power_1_on_4, LVREV_T_3_Power_2_on_4, LVREV_T_3_Power_3_on_4};
+    LVM_INT16           MaxT_Delay[]  = {LVREV_MAX_T0_DELAY, LVREV_MAX_T1_DELAY, LVREV_MAX_T2_DELAY, LVREV_MAX_T3_DELAY};
+    LVM_INT16           MaxAP_Delay[] = {LVREV_MAX_AP0_DELAY, LVREV_MAX_AP1_DELAY, LVREV_MAX_AP2_DELAY, LVREV_MAX_AP3_DELAY};
+
+    /*
+     * Select the delay network rate, the half rate tail needs at least 16kHz of bandwidth
+     */
+    if (pPrivate->CurrentParams.HalfRateTail == LVM_MODE_ON)
+    {
+        switch (pPrivate->CurrentParams.SampleRate)
+        {
+            case LVM_FS_48000:
+                CoreRate  = LVM_FS_24000;
+                bHalfRate = LVM_TRUE;
+                break;
+            case LVM_FS_44100:
+                CoreRate  = LVM_FS_22050;
+                bHalfRate = LVM_TRUE;
+                break;
+            case LVM_FS_32000:
+                CoreRate  = LVM_FS_16000;
+                bHalfRate = LVM_TRUE;
+                break;
+            default:
+                break;
+        }
+    }
+    if ((CoreRate != pCoefs->CoreRate) || (bHalfRate != pCoefs->bHalfRate))
+    {
+        LVREV_ClearAudioBuffers((LVREV_Handle_t)pPrivate);
+    }
+    pCoefs->CoreRate  = CoreRate;
+    pCoefs->bHalfRate = bHalfRate;
+    Fs = LVM_GetFsFromTable(CoreRate);
+
+    /*
+     * High pass filter
+     */
+    Omega = LVM_GetOmega(pPrivate->CurrentParams.HPF, CoreRate);
+    LVM_FO_HPF(Omega, &Coeffs);
+    LVREV_FloatCoefs(&Coeffs, pCoefs->HPCoefs);
+
+    /*
+     * Low pass filter, not applied above 2.9 radians
+     */
+    Coeffs.A0 = 0x7FFFFFFF;
+    Coeffs.A1 = 0;
+    Coeffs.B1 = 0;
+    if(pPrivate->CurrentParams.LPF <= (LVM_FsTable[CoreRate] >> 1))
+    {
+        Omega = LVM_GetOmega(pPrivate->CurrentParams.LPF, CoreRate);
+        if(Omega<=LVREV_2_9_INQ29)
+        {
+            LVM_FO_LPF(Omega, &Coeffs);
+        }
+    }
+    LVREV_FloatCoefs(&Coeffs, pCoefs->LPCoefs);
+
+    /*
+     * Reverb low pass filters and fixed delays
+     */
+    for (i=0; i<4; i++)
+    {
+        LVM_INT32 Temp;
+
+        if (i != 0)
+        {
+            MUL32x16INTO32(ScaleTable[i], Damping, Temp, 15)
+        }
+        else
+        {
+            Temp = Damping;
+        }
+        if(Temp <= (LVM_FsTable[CoreRate] >> 1))
+        {
+            Omega = LVM_GetOmega((LVM_UINT16)Temp, CoreRate);
+            LVM_FO_LPF(Omega, &Coeffs);
+        }
+        else
+        {
+            Coeffs.A0 = 0x7FF00000;
+            Coeffs.A1 = 0;
+            Coeffs.B1 = 0;
+        }
+        LVREV_FloatCoefs(&Coeffs, pCoefs->RevLPCoefs[i]);
+
+        pCoefs->FixedDelay[i] = (MaxT_Delay[i] - MaxAP_Delay[i]) * Fs / 48000;
+    }
+
+    pPrivate->bFloatPending = LVM_FALSE;
+}
+
+
 /****************************************************************************************/
 /*                                                                                      */
 /* FUNCTION:                BypassMixer_Callback                                        */
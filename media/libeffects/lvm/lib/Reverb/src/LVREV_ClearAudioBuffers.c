@@ -98,6 +98,13 @@ LVREV_ReturnStatus_en LVREV_ClearAudioBuffers(LVREV_Handle_t  hInstance)
         LoadConst_32(0,pLVREV_Private->pDelay_T[0], (LVM_INT16)LVREV_MAX_T0_DELAY);
     }
 
+    /*
+     * Clear the floating point filter taps and rewind the delay lines
+     */
+    LoadConst_32(0,
+        (void *)&pLVREV_Private->FloatTaps,             /* Destination Cast to void: no dereferencing in function*/
+        (LVM_INT16)(sizeof(LVREV_FloatTaps_st) / sizeof(LVM_INT32)));
+
     return LVREV_SUCCESS;
 }
 
@@ -313,6 +313,9 @@ LVREV_ReturnStatus_en LVREV_GetInstanceHandle(LVREV_Handle_t            *phInsta
     pLVREV_Private->A_DelaySize[3] = LVREV_MAX_AP3_DELAY;
     pLVREV_Private->B_DelaySize[3] = LVREV_MAX_AP3_DELAY;
 
+    /* Floating point data path */
+    pLVREV_Private->DataPath       = LVREV_DATAPATH_NONE;
+    pLVREV_Private->bFloatPending  = LVM_TRUE;
 
     LVREV_ClearAudioBuffers(*phInstance);
 
@@ -75,6 +75,11 @@ extern "C" {
 #define LVREV_FEEDBACKMIXER_TC            100           /* Feedback mixer time constant*/
 #define LVREV_OUTPUTGAIN_SHIFT              5           /* Bits shift for output gain correction */
 
+/* Data path used by the last process call, the delay lines are only valid for that path */
+#define LVREV_DATAPATH_NONE                 0           /* No data processed since the buffers were cleared */
+#define LVREV_DATAPATH_FIXED                1           /* LVREV_Process */
+#define LVREV_DATAPATH_FLOAT                2           /* LVREV_Process_Float */
+
 /* Parameter limits */
 #define LVREV_NUM_FS                        9           /* Number of supported sample rates */
 #define LVREV_MAXBLKSIZE_LIMIT             64           /* Maximum block size low limit */
@@ -117,6 +122,29 @@ typedef struct
 } LVREV_FastCoef_st;
 
 
+/* Floating point coefficients, set by LVREV_ApplyNewSettings_Float */
+typedef struct
+{
+    LVM_Fs_en               CoreRate;                   /* Rate the delay network runs at */
+    LVM_INT16               bHalfRate;                  /* Delay network runs at half the sample rate */
+    LVM_FLOAT               HPCoefs[3];                 /* High pass filter A1, A0 and -B1 */
+    LVM_FLOAT               LPCoefs[3];                 /* Low pass filter A1, A0 and -B1 */
+    LVM_FLOAT               RevLPCoefs[4][3];           /* Reverb low pass filters A1, A0 and -B1 */
+    LVM_INT32               FixedDelay[4];              /* Fixed delay in samples at the core rate */
+} LVREV_FloatCoefs_st;
+
+/* Floating point signal state, cleared by LVREV_ClearAudioBuffers */
+typedef struct
+{
+    LVM_FLOAT               HPTaps[2];                  /* High pass filter x(n-1) and y(n-1) */
+    LVM_FLOAT               LPTaps[2];                  /* Low pass filter x(n-1) and y(n-1) */
+    LVM_FLOAT               RevLPTaps[4][2];            /* Reverb low pass filters x(n-1) and y(n-1) */
+    LVM_FLOAT               DecimTaps[2];               /* Half rate decimator x(2n-1) and x(2n) */
+    LVM_FLOAT               InterpTaps[2];              /* Half rate interpolator last left and right output */
+    LVM_INT32               Phase;                      /* Half rate position of the next frame in its pair */
+    LVM_INT32               WritePos[4];                /* Delay line write positions */
+} LVREV_FloatTaps_st;
+
 /* Instance parameter structure */
 typedef struct
 {
@@ -159,6 +187,12 @@ typedef struct
     LVM_INT16               Gain;                       /* Gain applied to output to maintain average signal power */
     Mix_1St_Cll_t           GainMixer;                  /* Gain smoothing */
 
+    /* Floating point data path */
+    LVM_INT16               DataPath;                   /* Data path of the last process call */
+    LVM_CHAR                bFloatPending;              /* Floating point coefficients need updating */
+    LVREV_FloatCoefs_st     FloatCoefs;                 /* Floating point coefficients */
+    LVREV_FloatTaps_st      FloatTaps;                  /* Floating point signal state, delay lines are in pDelay_T */
+
 } LVREV_Instance_st;
 
 
@@ -170,11 +204,18 @@ typedef struct
 
 LVREV_ReturnStatus_en   LVREV_ApplyNewSettings(LVREV_Instance_st     *pPrivate);
 
+void                    LVREV_ApplyNewSettings_Float(LVREV_Instance_st  *pPrivate);
+
 void                    ReverbBlock(LVM_INT32           *pInput,
                                     LVM_INT32           *pOutput,
                                     LVREV_Instance_st   *pPrivate,
                                     LVM_UINT16          NumSamples);
 
+void                    ReverbBlock_Float(const LVM_FLOAT   *pInput,
+                                          LVM_FLOAT         *pOutput,
+                                          LVREV_Instance_st *pPrivate,
+                                          LVM_UINT16        NumSamples);
+
 LVM_INT32               BypassMixer_Callback(void       *pCallbackData,
                                              void       *pGeneralPurpose,
                                              LVM_INT16  GeneralPurpose );
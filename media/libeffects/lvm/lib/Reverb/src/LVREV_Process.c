@@ -22,6 +22,8 @@
 /****************************************************************************************/
 #include "LVREV_Private.h"
 #include "VectorArithmetic.h"
+#include "Mixer_private.h"
+#include <math.h> /* For powf */
 
 
 /****************************************************************************************/
@@ -67,6 +69,15 @@ LVREV_ReturnStatus_en LVREV_Process(LVREV_Handle_t      hInstance,
         return LVREV_NULLADDRESS;
     }
 
+    /*
+     * The delay lines hold floating point samples after LVREV_Process_Float
+     */
+    if (pLVREV_Private->DataPath == LVREV_DATAPATH_FLOAT)
+    {
+        LVREV_ClearAudioBuffers(hInstance);
+    }
+    pLVREV_Private->DataPath = LVREV_DATAPATH_FIXED;
+
     /*
      * Apply the new controls settings if required
      */
@@ -481,5 +492,631 @@ void ReverbBlock(LVM_INT32 *pInput, LVM_INT32 *pOutput, LVREV_Instance_st *pPriv
 }
 
 
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                LVREV_Process_Float                                         */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*  Floating point process function for the LVREV module.                               */
+/*                                                                                      */
+/* PARAMETERS:                                                                          */
+/*  hInstance               Instance handle                                             */
+/*  pInData                 Pointer to the input data                                   */
+/*  pOutData                Pointer to the output data                                  */
+/*  NumSamples              Number of samples in the input buffer                       */
+/*                                                                                      */
+/* RETURNS:                                                                             */
+/*  LVREV_Success           Succeeded                                                   */
+/*  LVREV_NULLADDRESS       When one of hInstance, pInData or pOutData is NULL          */
+/*                                                                                      */
+/* NOTES:                                                                               */
+/*  1. The output is not saturated                                                      */
+/*                                                                                      */
+/****************************************************************************************/
+LVREV_ReturnStatus_en LVREV_Process_Float(LVREV_Handle_t      hInstance,
+                                          const LVM_FLOAT     *pInData,
+                                          LVM_FLOAT           *pOutData,
+                                          const LVM_UINT16    NumSamples)
+{
+   LVREV_Instance_st     *pLVREV_Private = (LVREV_Instance_st *)hInstance;
+   const LVM_FLOAT       *pInput  = pInData;
+   LVM_FLOAT             *pOutput = pOutData;
+   LVM_INT32             SamplesToProcess, RemainingSamples;
+   LVM_INT32             format = 1;
+
+    /*
+     * Check for error conditions
+     */
+
+    /* Check for NULL pointers */
+    if((hInstance == LVM_NULL) || (pInData == LVM_NULL) || (pOutData == LVM_NULL))
+    {
+        return LVREV_NULLADDRESS;
+    }
+
+    /*
+     * The delay lines hold fixed point samples after LVREV_Process
+     */
+    if (pLVREV_Private->DataPath != LVREV_DATAPATH_FLOAT)
+    {
+        LVREV_ClearAudioBuffers(hInstance);
+        pLVREV_Private->bFloatPending = LVM_TRUE;
+    }
+    pLVREV_Private->DataPath = LVREV_DATAPATH_FLOAT;
+
+    /*
+     * Apply the new controls settings if required
+     */
+    if(pLVREV_Private->bControlPending == LVM_TRUE)
+    {
+        LVREV_ReturnStatus_en   errorCode;
+
+        /*
+         * Clear the pending flag and update the control settings
+         */
+        pLVREV_Private->bControlPending = LVM_FALSE;
+
+        errorCode = LVREV_ApplyNewSettings (pLVREV_Private);
+
+        if(errorCode != LVREV_SUCCESS)
+        {
+            return errorCode;
+        }
+        pLVREV_Private->bFloatPending = LVM_TRUE;
+    }
+    if(pLVREV_Private->bFloatPending == LVM_TRUE)
+    {
+        LVREV_ApplyNewSettings_Float(pLVREV_Private);
+    }
+
+    /*
+     * Trap the case where the number of samples is zero.
+     */
+    if (NumSamples == 0)
+    {
+        return LVREV_SUCCESS;
+    }
+
+    /*
+     * If OFF copy and reformat the data as necessary
+     */
+    if (pLVREV_Private->CurrentParams.OperatingMode == LVM_MODE_OFF)
+    {
+        if(pInput != pOutput)
+        {
+            /*
+             * Copy the data to the output buffer, convert to stereo is required
+             */
+            if(pLVREV_Private->CurrentParams.SourceFormat == LVM_MONO){
+                MonoTo2I_Float(pInput, pOutput, (LVM_INT16)NumSamples);
+            } else {
+                Copy_Float(pInput, pOutput, (LVM_INT16)(NumSamples << 1));
+            }
+        }
+
+        return LVREV_SUCCESS;
+    }
+
+    RemainingSamples = (LVM_INT32)NumSamples;
+
+    if (pLVREV_Private->CurrentParams.SourceFormat != LVM_MONO)
+    {
+        format = 2;
+    }
+
+    while (RemainingSamples!=0)
+    {
+        /*
+         * Process the data
+         */
+
+        if(RemainingSamples >  pLVREV_Private->MaxBlkLen)
+        {
+            SamplesToProcess =  pLVREV_Private->MaxBlkLen;
+            RemainingSamples = (LVM_INT16)(RemainingSamples - SamplesToProcess);
+        }
+        else
+        {
+            SamplesToProcess = RemainingSamples;
+            RemainingSamples = 0;
+        }
+
+        ReverbBlock_Float(pInput, pOutput, pLVREV_Private, (LVM_UINT16)SamplesToProcess);
+
+        pInput  = pInput  + (SamplesToProcess*format);
+        pOutput = pOutput + (SamplesToProcess*2);      // Always stereo output
+    }
+
+    return LVREV_SUCCESS;
+}
+
+
+/****************************************************************************************/
+/*                                                                                      */
+/*  Floating point helpers for ReverbBlock_Float                                        */
+/*                                                                                      */
+/****************************************************************************************/
+
+/* Kept in the delay network so that decaying tails never reach denormal values */
+#define LVREV_DENORMAL_OFFSET   1e-20f
+
+/*
+ * Advances a fixed point soft mixer over a block, one step of Alpha every four samples
+ * as in the 32-bit mixers, and returns the gain at the start and end of the block. The
+ * target reached callback is called as in the 32-bit mixers.
+ */
+static void LVREV_MixerRamp_Float(Mix_1St_Cll_t     *pMixer,
+                                  LVM_FLOAT         Steps,
+                                  LVM_FLOAT         *pStart,
+                                  LVM_FLOAT         *pEnd)
+{
+    LVM_INT32 Diff = pMixer->Current - pMixer->Target;
+
+    if ((Diff != 0) &&
+        ((pMixer->Alpha == 0) || ((Diff < POINT_ZERO_ONE_DB) && (Diff > -POINT_ZERO_ONE_DB))))
+    {
+        pMixer->Current = pMixer->Target;
+        Diff = 0;
+    }
+    *pStart = (LVM_FLOAT)pMixer->Current / 2147483648.0f;
+    if (Diff != 0)
+    {
+        LVM_FLOAT Decay = powf((LVM_FLOAT)pMixer->Alpha / 2147483648.0f, Steps);
+
+        pMixer->Current = pMixer->Target + (LVM_INT32)((LVM_FLOAT)Diff * Decay);
+    }
+    *pEnd = (LVM_FLOAT)pMixer->Current / 2147483648.0f;
+
+    if (pMixer->CallbackSet)
+    {
+        Diff = pMixer->Current - pMixer->Target;
+        if ((Diff < POINT_ZERO_ONE_DB) && (Diff > -POINT_ZERO_ONE_DB))
+        {
+            pMixer->Current = pMixer->Target;
+            pMixer->CallbackSet = LVM_FALSE;
+            if (pMixer->pCallBack != 0)
+            {
+                (*pMixer->pCallBack)(pMixer->pCallbackHandle, pMixer->pGeneralPurpose, pMixer->CallbackParam);
+            }
+        }
+    }
+}
+
+/* pDst = pSrc * gain, the gain moving linearly from Start to End over the block */
+static void LVREV_MultRamp_Float(const LVM_FLOAT    *pSrc,
+                                 LVM_FLOAT          Start,
+                                 LVM_FLOAT          End,
+                                 LVM_FLOAT          *pDst,
+                                 LVM_INT16          n)
+{
+    const LVM_FLOAT Step = (End - Start) / n;
+    LVM_INT16 ii;
+
+    for (ii = 0; ii < n; ii++)
+    {
+        pDst[ii] = pSrc[ii] * (Start + Step * (LVM_FLOAT)(ii + 1));
+    }
+}
+
+/* pDst += pSrc * gain, the gain moving linearly from Start to End over the block */
+static void LVREV_MacRamp_Float(const LVM_FLOAT     *pSrc,
+                                LVM_FLOAT           Start,
+                                LVM_FLOAT           End,
+                                LVM_FLOAT           *pDst,
+                                LVM_INT16           n)
+{
+    const LVM_FLOAT Step = (End - Start) / n;
+    LVM_INT16 ii;
+
+    for (ii = 0; ii < n; ii++)
+    {
+        pDst[ii] += pSrc[ii] * (Start + Step * (LVM_FLOAT)(ii + 1));
+    }
+}
+
+/* First order filter y(n) = A1 * x(n-1) + A0 * x(n) - B1 * y(n-1), in place */
+static void LVREV_FirstOrder_Float(const LVM_FLOAT  *pCoefs,
+                                   LVM_FLOAT        *pTaps,
+                                   LVM_FLOAT        *pData,
+                                   LVM_INT16        n)
+{
+    const LVM_FLOAT A1 = pCoefs[0];
+    const LVM_FLOAT A0 = pCoefs[1];
+    const LVM_FLOAT MinusB1 = pCoefs[2];
+    LVM_FLOAT X1 = pTaps[0];
+    LVM_FLOAT Y1 = pTaps[1];
+    LVM_INT16 ii;
+
+    for (ii = 0; ii < n; ii++)
+    {
+        const LVM_FLOAT X = pData[ii];
+
+        Y1 = A1 * X1 + A0 * X + MinusB1 * Y1;
+        X1 = X;
+        pData[ii] = Y1;
+    }
+    pTaps[0] = X1;
+    pTaps[1] = Y1;
+}
+
+/*
+ * The delay lines are circular buffers of T samples. Reads and writes are split at the
+ * wrap point so that the processing itself runs on contiguous blocks.
+ */
+static void LVREV_DelayRead_Float(const LVM_FLOAT   *pDelay,
+                                  LVM_INT32         Size,
+                                  LVM_INT32         Position,
+                                  LVM_FLOAT         *pDst,
+                                  LVM_INT16         n)
+{
+    LVM_INT32 First;
+
+    if (Position < 0)
+    {
+        Position += Size;
+    }
+    First = Size - Position;
+    if (First >= n)
+    {
+        Copy_Float(&pDelay[Position], pDst, n);
+    }
+    else
+    {
+        Copy_Float(&pDelay[Position], pDst, (LVM_INT16)First);
+        Copy_Float(pDelay, &pDst[First], (LVM_INT16)(n - First));
+    }
+}
+
+static void LVREV_DelayWrite_Float(const LVM_FLOAT  *pSrc,
+                                   LVM_FLOAT        *pDelay,
+                                   LVM_INT32        Size,
+                                   LVM_INT32        Position,
+                                   LVM_INT16        n)
+{
+    LVM_INT32 First;
+
+    if (Position < 0)
+    {
+        Position += Size;
+    }
+    First = Size - Position;
+    if (First >= n)
+    {
+        Copy_Float(pSrc, &pDelay[Position], n);
+    }
+    else
+    {
+        Copy_Float(pSrc, &pDelay[Position], (LVM_INT16)First);
+        Copy_Float(&pSrc[First], pDelay, (LVM_INT16)(n - First));
+    }
+}
+
+
+/****************************************************************************************/
+/*                                                                                      */
+/* FUNCTION:                ReverbBlock_Float                                           */
+/*                                                                                      */
+/* DESCRIPTION:                                                                         */
+/*  Floating point version of ReverbBlock. The delay network is the same, with the      */
+/*  delay lines kept as circular buffers instead of being shifted every block and the   */
+/*  soft mixers applied as linear ramps over the block. With the half rate tail the     */
+/*  mono input is decimated by two with a [1/4 1/2 1/4] filter before the network and   */
+/*  the stereo output is linearly interpolated back to the full rate.                   */
+/*                                                                                      */
+/* PARAMETERS:                                                                          */
+/*  pInput                  Pointer to the input data                                   */
+/*  pOutput                 Pointer to the output data                                  */
+/*  pPrivate                Pointer to the instance private parameters                  */
+/*  NumSamples              Number of samples in the input buffer                       */
+/*                                                                                      */
+/* NOTES:                                                                               */
+/*  1. NumSamples must not be more than MaxBlkLen                                       */
+/*                                                                                      */
+/****************************************************************************************/
+void ReverbBlock_Float(const LVM_FLOAT *pInput, LVM_FLOAT *pOutput, LVREV_Instance_st *pPrivate, LVM_UINT16 NumSamples)
+{
+    LVREV_FloatCoefs_st *pCoefs = &pPrivate->FloatCoefs;
+    LVREV_FloatTaps_st  *pTaps  = &pPrivate->FloatTaps;
+    LVM_FLOAT   *pIn    = (LVM_FLOAT *)pPrivate->pScratch;      /* Delay network input */
+    LVM_FLOAT   *pTemp  = (LVM_FLOAT *)pPrivate->pInputSave;    /* Delay line scratch */
+    LVM_FLOAT   *pLine[4];                                      /* Delay line outputs */
+    LVM_FLOAT   *pLeft, *pRight;
+    LVM_FLOAT   Headroom = (LVM_FLOAT)LVREV_HEADROOM / 32768.0f;
+    LVM_FLOAT   Steps = (LVM_FLOAT)NumSamples / 4.0f;           /* Soft mixer steps in the block */
+    LVM_FLOAT   Start, End, Start2, End2, Step;
+    LVM_INT32   StartPhase = pTaps->Phase;
+    LVM_INT32   NumberOfDelayLines;
+    LVM_INT16   NumCore = (LVM_INT16)NumSamples;                /* Samples at the delay network rate */
+    LVM_INT16   ii, j;
+
+    if(pPrivate->InstanceParams.NumDelays == LVREV_DELAYLINES_4 )
+    {
+        NumberOfDelayLines = 4;
+    }
+    else if(pPrivate->InstanceParams.NumDelays == LVREV_DELAYLINES_2 )
+    {
+        NumberOfDelayLines = 2;
+    }
+    else
+    {
+        NumberOfDelayLines = 1;
+    }
+    for (j = 0; j < NumberOfDelayLines; j++)
+    {
+        pLine[j] = (LVM_FLOAT *)pPrivate->pScratchDelayLine[j];
+    }
+
+    /*
+     *  Mono input with headroom
+     */
+    if(pPrivate->CurrentParams.SourceFormat == LVM_MONO)
+    {
+        for (ii = 0; ii < NumCore; ii++)
+        {
+            pIn[ii] = pInput[ii] * Headroom;
+        }
+    }
+    else
+    {
+        for (ii = 0; ii < NumCore; ii++)
+        {
+            pIn[ii] = (pInput[2 * ii] + pInput[2 * ii + 1]) * (0.5f * Headroom);
+        }
+    }
+
+    /*
+     *  Decimate by two, one network sample is produced on the second frame of each pair
+     */
+    if (pCoefs->bHalfRate)
+    {
+        LVM_FLOAT   Prev = pTaps->DecimTaps[0];
+        LVM_FLOAT   Cur  = pTaps->DecimTaps[1];
+        LVM_INT32   Phase = StartPhase;
+
+        NumCore = 0;
+        for (ii = 0; ii < (LVM_INT16)NumSamples; ii++)
+        {
+            const LVM_FLOAT X = pIn[ii];
+
+            if (Phase == 0)
+            {
+                Cur = X;
+            }
+            else
+            {
+                pIn[NumCore++] = 0.25f * (Prev + X) + 0.5f * Cur;
+                Prev = X;
+            }
+            Phase ^= 1;
+        }
+        pTaps->DecimTaps[0] = Prev;
+        pTaps->DecimTaps[1] = Cur;
+        pTaps->Phase = Phase;
+    }
+
+    if (NumCore != 0)
+    {
+        /*
+         *  High pass and low pass filters
+         */
+        LVREV_FirstOrder_Float(pCoefs->HPCoefs, pTaps->HPTaps, pIn, NumCore);
+        LVREV_FirstOrder_Float(pCoefs->LPCoefs, pTaps->LPTaps, pIn, NumCore);
+        for (ii = 0; ii < NumCore; ii++)
+        {
+            pIn[ii] += LVREV_DENORMAL_OFFSET;
+        }
+
+        /*
+         *  Process all delay lines
+         */
+        for(j = 0; j < NumberOfDelayLines; j++)
+        {
+            LVM_FLOAT       *pDelay   = (LVM_FLOAT *)pPrivate->pDelay_T[j];
+            LVM_FLOAT       *pOut     = pLine[j];
+            LVM_INT32       Size      = pPrivate->T[j];
+            LVM_INT32       APInput   = pTaps->WritePos[j] - pCoefs->FixedDelay[j];
+            LVM_INT32       DelayA    = pPrivate->A_DelaySize[j];
+            LVM_INT32       DelayB    = pPrivate->B_DelaySize[j];
+            Mix_2St_Cll_t   *pTapMixer = &pPrivate->Mixer_APTaps[j];
+
+            if (pCoefs->bHalfRate)
+            {
+                DelayA = (DelayA + 1) >> 1;
+                DelayB = (DelayB + 1) >> 1;
+            }
+
+            /*
+             * All-pass filter with pop and click suppression, the taps are crossfaded
+             * when the room size changes
+             */
+            LVREV_MixerRamp_Float((Mix_1St_Cll_t *)pTapMixer, Steps, &Start, &End);
+            LVREV_MixerRamp_Float((Mix_1St_Cll_t *)&pTapMixer->Alpha2, Steps, &Start2, &End2);
+            if ((Start2 == 0.0f) && (End2 == 0.0f))
+            {
+                LVREV_DelayRead_Float(pDelay, Size, APInput - DelayA, pOut, NumCore);
+                LVREV_MultRamp_Float(pOut, Start, End, pOut, NumCore);
+            }
+            else if ((Start == 0.0f) && (End == 0.0f))
+            {
+                LVREV_DelayRead_Float(pDelay, Size, APInput - DelayB, pOut, NumCore);
+                LVREV_MultRamp_Float(pOut, Start2, End2, pOut, NumCore);
+            }
+            else
+            {
+                LVREV_DelayRead_Float(pDelay, Size, APInput - DelayA, pOut, NumCore);
+                LVREV_MultRamp_Float(pOut, Start, End, pOut, NumCore);
+                LVREV_DelayRead_Float(pDelay, Size, APInput - DelayB, pTemp, NumCore);
+                LVREV_MacRamp_Float(pTemp, Start2, End2, pOut, NumCore);
+            }
+
+            /* Sum the inverted, smoothed feedback into the fixed delay output, giving the all-pass delay input */
+            LVREV_DelayRead_Float(pDelay, Size, APInput, pTemp, NumCore);
+            LVREV_MixerRamp_Float(&pPrivate->Mixer_SGFeedback[j], Steps, &Start, &End);
+            LVREV_MacRamp_Float(pOut, -Start, -End, pTemp, NumCore);
+            LVREV_DelayWrite_Float(pTemp, pDelay, Size, APInput, NumCore);
+
+            /* Sum the smoothed feedforward into the all-pass output */
+            LVREV_MixerRamp_Float(&pPrivate->Mixer_SGFeedforward[j], Steps, &Start, &End);
+            LVREV_MacRamp_Float(pTemp, Start, End, pOut, NumCore);
+
+            /*
+             *  Feedback gain
+             */
+            LVREV_MixerRamp_Float(&pPrivate->FeedbackMixer[j], Steps, &Start, &End);
+            LVREV_MultRamp_Float(pOut, Start, End, pOut, NumCore);
+
+            /*
+             *  Low pass filter
+             */
+            LVREV_FirstOrder_Float(pCoefs->RevLPCoefs[j], pTaps->RevLPTaps[j], pOut, NumCore);
+        }
+
+        /*
+         *  Apply rotation matrix and delay samples
+         */
+        for(j = 0; j < NumberOfDelayLines; j++)
+        {
+            const LVM_FLOAT *pA, *pB;
+            LVM_FLOAT       SignA, SignB;
+
+            switch(j)
+            {
+                case 3:
+                    pA = pLine[1]; SignA = -1.0f;
+                    pB = pLine[2]; SignB = -1.0f;
+                    break;
+                case 2:
+                    pA = pLine[0]; SignA = -1.0f;
+                    pB = pLine[3]; SignB = -1.0f;
+                    break;
+                case 1:
+                    pA = pLine[0]; SignA = -1.0f;
+                    if(NumberOfDelayLines == 4)
+                    {
+                        pB = pLine[3]; SignB = 1.0f;
+                    }
+                    else
+                    {
+                        pB = pLine[1]; SignB = -1.0f;
+                    }
+                    break;
+                default:
+                    if(NumberOfDelayLines == 4)
+                    {
+                        pA = pLine[1]; SignA = -1.0f;
+                        pB = pLine[2]; SignB = 1.0f;
+                    }
+                    else if(NumberOfDelayLines == 2)
+                    {
+                        pA = pLine[0]; SignA = 1.0f;
+                        pB = pLine[1]; SignB = -1.0f;
+                    }
+                    else
+                    {
+                        pA = pLine[0]; SignA = 1.0f;
+                        pB = pLine[0]; SignB = 0.0f;
+                    }
+                    break;
+            }
+            for (ii = 0; ii < NumCore; ii++)
+            {
+                pTemp[ii] = pIn[ii] + SignA * pA[ii] + SignB * pB[ii];
+            }
+
+            LVREV_DelayWrite_Float(pTemp, (LVM_FLOAT *)pPrivate->pDelay_T[j], pPrivate->T[j],
+                                   pTaps->WritePos[j], NumCore);
+            pTaps->WritePos[j] += NumCore;
+            if (pTaps->WritePos[j] >= pPrivate->T[j])
+            {
+                pTaps->WritePos[j] -= pPrivate->T[j];
+            }
+        }
+    }
+
+    /*
+     *  Create stereo output
+     */
+    pLeft  = pLine[0];
+    pRight = pLine[0];
+    if (NumberOfDelayLines == 4)
+    {
+        pRight = pLine[1];
+        for (ii = 0; ii < NumCore; ii++)
+        {
+            pLeft[ii]  += pLine[3][ii];
+            pRight[ii] += pLine[2][ii];
+        }
+    }
+    else if (NumberOfDelayLines == 2)
+    {
+        pRight = pTemp;
+        for (ii = 0; ii < NumCore; ii++)
+        {
+            pRight[ii] = pLine[1][ii] - pLine[0][ii];
+            pLeft[ii]  = pLine[0][ii] + pLine[1][ii];
+        }
+    }
+
+    if (pCoefs->bHalfRate)
+    {
+        /* The second frame of each pair takes the new sample, the first one sits halfway */
+        LVM_FLOAT   LastLeft  = pTaps->InterpTaps[0];
+        LVM_FLOAT   LastRight = pTaps->InterpTaps[1];
+        LVM_INT32   Phase = StartPhase;
+        LVM_INT16   k = 0;
+
+        for (ii = 0; ii < (LVM_INT16)NumSamples; ii++)
+        {
+            if (Phase == 0)
+            {
+                pOutput[2 * ii]     = LastLeft;
+                pOutput[2 * ii + 1] = LastRight;
+            }
+            else
+            {
+                pOutput[2 * ii]     = 0.5f * (LastLeft + pLeft[k]);
+                pOutput[2 * ii + 1] = 0.5f * (LastRight + pRight[k]);
+                LastLeft  = pLeft[k];
+                LastRight = pRight[k];
+                k++;
+            }
+            Phase ^= 1;
+        }
+        pTaps->InterpTaps[0] = LastLeft;
+        pTaps->InterpTaps[1] = LastRight;
+    }
+    else
+    {
+        for (ii = 0; ii < NumCore; ii++)
+        {
+            pOutput[2 * ii]     = pLeft[ii];
+            pOutput[2 * ii + 1] = pRight[ii];
+        }
+    }
+
+    /*
+     *  Dry/wet mixer and output gain, both soft mixers run on stereo samples
+     */
+    LVREV_MixerRamp_Float((Mix_1St_Cll_t *)&pPrivate->BypassMixer, 2 * Steps, &Start, &End);
+    LVREV_MixerRamp_Float((Mix_1St_Cll_t *)&pPrivate->BypassMixer.Alpha2, 2 * Steps, &Start2, &End2);
+    Start += Start2;
+    End   += End2;
+    LVREV_MixerRamp_Float(&pPrivate->GainMixer, 2 * Steps, &Start2, &End2);
+    Start *= Start2 * (LVM_FLOAT)(1 << LVREV_OUTPUTGAIN_SHIFT);
+    End   *= End2 * (LVM_FLOAT)(1 << LVREV_OUTPUTGAIN_SHIFT);
+
+    Step = (End - Start) / NumSamples;
+    for (ii = 0; ii < (LVM_INT16)NumSamples; ii++)
+    {
+        const LVM_FLOAT Gain = Start + Step * (LVM_FLOAT)(ii + 1);
+
+        pOutput[2 * ii]     *= Gain;
+        pOutput[2 * ii + 1] *= Gain;
+    }
+
+    return;
+}
+
+
 /* End of file */
 
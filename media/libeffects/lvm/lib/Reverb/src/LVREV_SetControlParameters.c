@@ -105,6 +105,11 @@ LVREV_ReturnStatus_en LVREV_SetControlParameters(LVREV_Handle_t           hInsta
         return LVREV_OUTOFRANGE;
     }
 
+    if ((pNewParams->HalfRateTail != LVM_MODE_OFF) && (pNewParams->HalfRateTail != LVM_MODE_ON))
+    {
+        return LVREV_OUTOFRANGE;
+    }
+
 
 
     /*
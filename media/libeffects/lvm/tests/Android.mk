@@ -0,0 +1,55 @@
+LOCAL_PATH:= $(call my-dir)
+
+# LVM float/fixed point benchmark
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	lvmbench.c
+
+LOCAL_STATIC_LIBRARIES := libmusicbundle libeffectsbiquad
+
+LOCAL_C_INCLUDES += \
+	$(LOCAL_PATH)/../lib/Common/lib/ \
+	$(LOCAL_PATH)/../lib/Bundle/lib/
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= lvmbench
+
+include $(BUILD_EXECUTABLE)
+
+# Biquad engine benchmark against the LVM filter variants
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	biquadbench.c
+
+LOCAL_STATIC_LIBRARIES := libmusicbundle libeffectsbiquad
+
+LOCAL_C_INCLUDES += \
+	$(LOCAL_PATH)/../lib/Common/lib/ \
+	$(LOCAL_PATH)/../../biquad
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= biquadbench
+
+include $(BUILD_EXECUTABLE)
+
+# Reverb fixed point, float and half rate tail benchmark over the presets
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	reverbbench.c
+
+LOCAL_STATIC_LIBRARIES := libreverb
+
+LOCAL_C_INCLUDES += \
+	$(LOCAL_PATH)/../lib/Common/lib/ \
+	$(LOCAL_PATH)/../lib/Reverb/lib/
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= reverbbench
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,314 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Compares the shared biquad engine with the LVM per-variant filters on a cascade of
+ * peaking sections, for stereo and 8 channel layouts. The LVM filters only handle
+ * interleaved stereo, so the 8 channel layout is split into four stereo buffers for
+ * them and the cost of the split is included.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "BIQUAD.h"
+#include "BiquadBank.h"
+
+#define BLOCK_FRAMES        256
+#define MAX_SECTIONS        8
+#define MAX_CHANNELS        8
+#define SAMPLE_RATE         48000
+
+static const double kFrequencies[MAX_SECTIONS] = { 60, 230, 910, 3600, 14000, 120, 2000, 8000 };
+static const double kGainsDb[MAX_SECTIONS] = { 3, -2, 4, -3, 2, 1, -1, 2 };
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-n <seconds>] [-s <sections>]\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -n seconds of audio to filter per layout (default 10)\n");
+    fprintf(stderr, "       -s sections in the cascade, 1 to %d (default 1 and 5)\n",
+            MAX_SECTIONS);
+
+    exit(1);
+}
+
+static int64_t getNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_nsec + ts.tv_sec * 1000000000ll;
+}
+
+/* Peaking sections, as in the Audio EQ Cookbook with a Q of 1 */
+static void designSections(biquad_coefs_t *coefs, size_t sections) {
+    size_t s;
+    for (s = 0; s < sections; s++) {
+        double A = pow(10, kGainsDb[s] / 40);
+        double w0 = 2 * M_PI * kFrequencies[s] / SAMPLE_RATE;
+        double alpha = sin(w0) / 2;
+        double a0 = 1 + alpha / A;
+
+        coefs[s].b0 = (1 + alpha * A) / a0;
+        coefs[s].b1 = -2 * cos(w0) / a0;
+        coefs[s].b2 = (1 - alpha * A) / a0;
+        coefs[s].a1 = -2 * cos(w0) / a0;
+        coefs[s].a2 = (1 - alpha / A) / a0;
+    }
+}
+
+/* One channel at a time in direct form I, as the per-variant float filters did */
+static void scalarCascade(const biquad_coefs_t *coefs, size_t sections, float *state,
+        size_t channels, const float *in, float *out, size_t frames) {
+    size_t s, c, i;
+    for (s = 0; s < sections; s++) {
+        const float *src = (s == 0) ? in : out;
+        for (c = 0; c < channels; c++) {
+            float *st = &state[(s * channels + c) * 4];
+            float x1 = st[0], x2 = st[1], y1 = st[2], y2 = st[3];
+            for (i = 0; i < frames; i++) {
+                float x = src[i * channels + c];
+                float y = coefs[s].b0 * x + coefs[s].b1 * x1 + coefs[s].b2 * x2
+                        - coefs[s].a1 * y1 - coefs[s].a2 * y2;
+                x2 = x1; x1 = x;
+                y2 = y1; y1 = y;
+                out[i * channels + c] = y;
+            }
+            st[0] = x1; st[1] = x2; st[2] = y1; st[3] = y2;
+        }
+    }
+}
+
+/* Biquad_Instance_t is sized for 32 bit pointers, leave room for a 64 bit one */
+typedef struct {
+    Biquad_Instance_t instance;
+    LVM_INT32 pad[2];
+} lvm_instance_t;
+
+typedef struct {
+    lvm_instance_t instance[MAX_CHANNELS / 2][MAX_SECTIONS];
+    Biquad_2I_Order2_Taps_t taps[MAX_CHANNELS / 2][MAX_SECTIONS];
+} lvm_cascade_t;
+
+static void initLvm16(lvm_cascade_t *lvm, const biquad_coefs_t *coefs, size_t sections) {
+    size_t p, s;
+    for (p = 0; p < MAX_CHANNELS / 2; p++) {
+        for (s = 0; s < sections; s++) {
+            BQ_C16_Coefs_t c;
+            c.A0 = (LVM_INT16)lrint(coefs[s].b0 * (1 << 14));
+            c.A1 = (LVM_INT16)lrint(coefs[s].b1 * (1 << 14));
+            c.A2 = (LVM_INT16)lrint(coefs[s].b2 * (1 << 14));
+            c.B1 = (LVM_INT16)lrint(-coefs[s].a1 * (1 << 14));
+            c.B2 = (LVM_INT16)lrint(-coefs[s].a2 * (1 << 14));
+            memset(&lvm->taps[p][s], 0, sizeof(lvm->taps[p][s]));
+            BQ_2I_D16F32Css_TRC_WRA_01_Init(&lvm->instance[p][s].instance, &lvm->taps[p][s], &c);
+        }
+    }
+}
+
+static void initLvm32(lvm_cascade_t *lvm, const biquad_coefs_t *coefs, size_t sections) {
+    size_t p, s;
+    for (p = 0; p < MAX_CHANNELS / 2; p++) {
+        for (s = 0; s < sections; s++) {
+            BQ_C32_Coefs_t c;
+            c.A0 = (LVM_INT32)lrint(coefs[s].b0 * (1 << 30));
+            c.A1 = (LVM_INT32)lrint(coefs[s].b1 * (1 << 30));
+            c.A2 = (LVM_INT32)lrint(coefs[s].b2 * (1 << 30));
+            c.B1 = (LVM_INT32)lrint(-coefs[s].a1 * (1 << 30));
+            c.B2 = (LVM_INT32)lrint(-coefs[s].a2 * (1 << 30));
+            memset(&lvm->taps[p][s], 0, sizeof(lvm->taps[p][s]));
+            BQ_2I_D32F32Cll_TRC_WRA_01_Init(&lvm->instance[p][s].instance, &lvm->taps[p][s], &c);
+        }
+    }
+}
+
+/* Splits interleaved frames into stereo pairs */
+#define SPLIT_PAIRS(in, pairs, channels, frames)                                \
+    {                                                                           \
+        size_t i_, p_;                                                          \
+        for (i_ = 0; i_ < (frames); i_++) {                                     \
+            for (p_ = 0; p_ < (channels) / 2; p_++) {                           \
+                (pairs)[p_][2 * i_] = (in)[i_ * (channels) + 2 * p_];           \
+                (pairs)[p_][2 * i_ + 1] = (in)[i_ * (channels) + 2 * p_ + 1];   \
+            }                                                                   \
+        }                                                                       \
+    }
+
+#define MERGE_PAIRS(pairs, out, channels, frames)                               \
+    {                                                                           \
+        size_t i_, p_;                                                          \
+        for (i_ = 0; i_ < (frames); i_++) {                                     \
+            for (p_ = 0; p_ < (channels) / 2; p_++) {                           \
+                (out)[i_ * (channels) + 2 * p_] = (pairs)[p_][2 * i_];          \
+                (out)[i_ * (channels) + 2 * p_ + 1] = (pairs)[p_][2 * i_ + 1];  \
+            }                                                                   \
+        }                                                                       \
+    }
+
+static void runLayout(size_t channels, size_t sections, size_t frames) {
+    biquad_coefs_t coefs[MAX_SECTIONS];
+    float bankState[BIQUADBANK_STATE_SIZE(MAX_SECTIONS, MAX_CHANNELS)];
+    float scalarState[MAX_SECTIONS * MAX_CHANNELS * 4];
+    lvm_cascade_t *lvm = malloc(sizeof(lvm_cascade_t));
+    const size_t samples = frames * channels;
+    float *inFloat = malloc(samples * sizeof(float));
+    float *outBank = malloc(samples * sizeof(float));
+    float *outScalar = malloc(samples * sizeof(float));
+    LVM_INT16 *in16 = malloc(samples * sizeof(LVM_INT16));
+    LVM_INT16 *out16 = malloc(samples * sizeof(LVM_INT16));
+    LVM_INT32 *in32 = malloc(samples * sizeof(LVM_INT32));
+    LVM_INT32 *out32 = malloc(samples * sizeof(LVM_INT32));
+    LVM_INT16 *pairs16[MAX_CHANNELS / 2];
+    LVM_INT32 *pairs32[MAX_CHANNELS / 2];
+    int64_t nsBank = 0, nsScalar = 0, ns16 = 0, ns32 = 0;
+    double maxErrScalar = 0, maxErr32 = 0;
+    unsigned seed = 1;
+    size_t i, p, s;
+
+    for (p = 0; p < channels / 2; p++) {
+        pairs16[p] = malloc(BLOCK_FRAMES * 2 * sizeof(LVM_INT16));
+        pairs32[p] = malloc(BLOCK_FRAMES * 2 * sizeof(LVM_INT32));
+    }
+
+    /* white noise at -12dBFS, with 3 bits of headroom on the 32 bit path */
+    for (i = 0; i < samples; i++) {
+        seed = seed * 1103515245 + 12345;
+        in16[i] = (LVM_INT16)(((LVM_INT32)((seed >> 16) & 0x7fff) - 0x4000) / 2);
+        inFloat[i] = in16[i] / 32768.0f;
+        in32[i] = (LVM_INT32)in16[i] << 12;
+    }
+
+    designSections(coefs, sections);
+    BiquadBank_reset(bankState, sections, channels);
+    memset(scalarState, 0, sizeof(scalarState));
+    initLvm16(lvm, coefs, sections);
+
+    for (i = 0; i < frames; i += BLOCK_FRAMES) {
+        const size_t o = i * channels;
+        int64_t start = getNowNs();
+        BiquadBank_process(coefs, sections, bankState, channels,
+                &inFloat[o], &outBank[o], BLOCK_FRAMES);
+        nsBank += getNowNs() - start;
+
+        start = getNowNs();
+        scalarCascade(coefs, sections, scalarState, channels,
+                &inFloat[o], &outScalar[o], BLOCK_FRAMES);
+        nsScalar += getNowNs() - start;
+
+        start = getNowNs();
+        SPLIT_PAIRS(&in16[o], pairs16, channels, BLOCK_FRAMES);
+        for (p = 0; p < channels / 2; p++) {
+            for (s = 0; s < sections; s++) {
+                BQ_2I_D16F32C14_TRC_WRA_01(&lvm->instance[p][s].instance, pairs16[p], pairs16[p],
+                        BLOCK_FRAMES);
+            }
+        }
+        MERGE_PAIRS(pairs16, &out16[o], channels, BLOCK_FRAMES);
+        ns16 += getNowNs() - start;
+    }
+
+    initLvm32(lvm, coefs, sections);
+    for (i = 0; i < frames; i += BLOCK_FRAMES) {
+        const size_t o = i * channels;
+        int64_t start = getNowNs();
+        SPLIT_PAIRS(&in32[o], pairs32, channels, BLOCK_FRAMES);
+        for (p = 0; p < channels / 2; p++) {
+            for (s = 0; s < sections; s++) {
+                BQ_2I_D32F32C30_TRC_WRA_01(&lvm->instance[p][s].instance, pairs32[p], pairs32[p],
+                        BLOCK_FRAMES);
+            }
+        }
+        MERGE_PAIRS(pairs32, &out32[o], channels, BLOCK_FRAMES);
+        ns32 += getNowNs() - start;
+    }
+
+    for (i = 0; i < samples; i++) {
+        double err = fabs(outBank[i] - outScalar[i]);
+        if (err > maxErrScalar) {
+            maxErrScalar = err;
+        }
+        err = fabs(outBank[i] - out32[i] / (32768.0 * 4096.0));
+        if (err > maxErr32) {
+            maxErr32 = err;
+        }
+    }
+
+    printf("%2zu ch %zu sec %11.2f %11.2f %11.2f %11.2f %12.1f %12.1f\n", channels, sections,
+            (double)ns16 / frames, (double)ns32 / frames, (double)nsScalar / frames,
+            (double)nsBank / frames,
+            maxErrScalar > 0 ? 20 * log10(maxErrScalar) : -999.0,
+            maxErr32 > 0 ? 20 * log10(maxErr32) : -999.0);
+
+    for (p = 0; p < channels / 2; p++) {
+        free(pairs16[p]);
+        free(pairs32[p]);
+    }
+    free(lvm);
+    free(inFloat);
+    free(outBank);
+    free(outScalar);
+    free(in16);
+    free(out16);
+    free(in32);
+    free(out32);
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    int seconds = 10;
+    int sections = 0;
+    int res;
+
+    while ((res = getopt(argc, argv, "hn:s:")) >= 0) {
+        switch (res) {
+            case 'n':
+                seconds = atoi(optarg);
+                if (seconds <= 0) {
+                    usage(me);
+                }
+                break;
+            case 's':
+                sections = atoi(optarg);
+                if (sections <= 0 || sections > MAX_SECTIONS) {
+                    usage(me);
+                }
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+
+    size_t frames = (size_t)seconds * SAMPLE_RATE / BLOCK_FRAMES * BLOCK_FRAMES;
+
+    printf("ns/frame       %11s %11s %11s %11s %12s %12s\n", "lvm D16C14", "lvm D32C30",
+            "scalar flt", "biquadbank", "vs flt dB", "vs D32 dB");
+    if (sections != 0) {
+        runLayout(2, sections, frames);
+        runLayout(8, sections, frames);
+    } else {
+        runLayout(2, 1, frames);
+        runLayout(8, 1, frames);
+        runLayout(2, 5, frames);
+        runLayout(8, 5, frames);
+    }
+    return 0;
+}
@@ -0,0 +1,310 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Runs each bundle effect through LVM_Process and LVM_Process_Float on the
+ * same input and reports the cost per frame of both paths, and how far the
+ * float output is from the 16 bit reference.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "LVM.h"
+
+#define BLOCK_FRAMES        256
+#define NUM_BANDS           5
+
+enum {
+    EFFECT_BASS,
+    EFFECT_VIRTUALIZER,
+    EFFECT_EQUALIZER,
+    EFFECT_VOLUME,
+    NUM_EFFECTS
+};
+
+static const char *kEffectNames[NUM_EFFECTS] = {
+    "bass", "virtualizer", "equalizer", "volume"
+};
+
+static const LVM_UINT16 kBandFrequencies[NUM_BANDS] = { 60, 230, 910, 3600, 14000 };
+static const LVM_INT16 kBandGains[NUM_BANDS] = { 5, 3, -2, 4, 6 };
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-n <seconds>] [-e <effect>]\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -n seconds of 44.1kHz audio to process (default 10)\n");
+    fprintf(stderr, "       -e bass, virtualizer, equalizer or volume (default all)\n");
+
+    exit(1);
+}
+
+static int64_t getNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_nsec + ts.tv_sec * 1000000000ll;
+}
+
+static LVM_Handle_t createInstance(int effect, LVM_MemTab_t *memTab) {
+    LVM_InstParams_t instParams;
+    LVM_ControlParams_t params;
+    LVM_EQNB_BandDef_t bandDefs[NUM_BANDS];
+    LVM_HeadroomParams_t headroomParams;
+    LVM_HeadroomBandDef_t headroomBandDefs[2];
+    LVM_Handle_t hInstance = LVM_NULL;
+    int i;
+
+    instParams.BufferMode    = LVM_UNMANAGED_BUFFERS;
+    instParams.MaxBlockSize  = BLOCK_FRAMES;
+    instParams.EQNB_NumBands = NUM_BANDS;
+    instParams.PSA_Included  = LVM_PSA_ON;
+
+    if (LVM_GetMemoryTable(LVM_NULL, memTab, &instParams) != LVM_SUCCESS) {
+        return LVM_NULL;
+    }
+    for (i = 0; i < LVM_NR_MEMORY_REGIONS; i++) {
+        memTab->Region[i].pBaseAddress = NULL;
+        if (memTab->Region[i].Size != 0) {
+            memTab->Region[i].pBaseAddress = malloc(memTab->Region[i].Size);
+            if (memTab->Region[i].pBaseAddress == NULL) {
+                return LVM_NULL;
+            }
+        }
+    }
+    if (LVM_GetInstanceHandle(&hInstance, memTab, &instParams) != LVM_SUCCESS) {
+        return LVM_NULL;
+    }
+
+    /* Same defaults as the effect bundle wrapper, with only one effect switched on */
+    memset(&params, 0, sizeof(params));
+    params.OperatingMode            = LVM_MODE_ON;
+    params.SampleRate               = LVM_FS_44100;
+    params.SourceFormat             = LVM_STEREO;
+    params.SpeakerType              = LVM_HEADPHONES;
+    params.VirtualizerOperatingMode = LVM_MODE_OFF;
+    params.VirtualizerType          = LVM_CONCERTSOUND;
+    params.VirtualizerReverbLevel   = 100;
+    params.CS_EffectLevel           = LVM_CS_EFFECT_NONE;
+    params.EQNB_OperatingMode       = LVM_EQNB_OFF;
+    params.EQNB_NBands              = NUM_BANDS;
+    params.pEQNB_BandDefinition     = bandDefs;
+    params.VC_EffectLevel           = 0;
+    params.VC_Balance               = 0;
+    params.TE_OperatingMode         = LVM_TE_OFF;
+    params.TE_EffectLevel           = 0;
+    params.PSA_Enable               = LVM_PSA_OFF;
+    params.PSA_PeakDecayRate        = LVM_PSA_SPEED_MEDIUM;
+    params.BE_OperatingMode         = LVM_BE_OFF;
+    params.BE_EffectLevel           = 0;
+    params.BE_CentreFreq            = LVM_BE_CENTRE_90Hz;
+    params.BE_HPF                   = LVM_BE_HPF_ON;
+
+    for (i = 0; i < NUM_BANDS; i++) {
+        bandDefs[i].Frequency = kBandFrequencies[i];
+        bandDefs[i].QFactor   = 96;
+        bandDefs[i].Gain      = 0;
+    }
+
+    switch (effect) {
+    case EFFECT_BASS:
+        params.BE_OperatingMode = LVM_BE_ON;
+        params.BE_EffectLevel   = 15;
+        break;
+    case EFFECT_VIRTUALIZER:
+        params.VirtualizerOperatingMode = LVM_MODE_ON;
+        params.CS_EffectLevel           = LVM_CS_EFFECT_HIGH;
+        break;
+    case EFFECT_EQUALIZER:
+        params.EQNB_OperatingMode = LVM_EQNB_ON;
+        for (i = 0; i < NUM_BANDS; i++) {
+            bandDefs[i].Gain = kBandGains[i];
+        }
+        break;
+    case EFFECT_VOLUME:
+        params.VC_EffectLevel = -6;
+        params.VC_Balance     = 3;
+        break;
+    }
+
+    if (LVM_SetControlParameters(hInstance, &params) != LVM_SUCCESS) {
+        return LVM_NULL;
+    }
+
+    headroomBandDefs[0].Limit_Low       = 20;
+    headroomBandDefs[0].Limit_High      = 4999;
+    headroomBandDefs[0].Headroom_Offset = 0;
+    headroomBandDefs[1].Limit_Low       = 5000;
+    headroomBandDefs[1].Limit_High      = 24000;
+    headroomBandDefs[1].Headroom_Offset = 0;
+    headroomParams.pHeadroomDefinition    = headroomBandDefs;
+    headroomParams.Headroom_OperatingMode = LVM_HEADROOM_ON;
+    headroomParams.NHeadroomBands         = 2;
+
+    if (LVM_SetHeadroomParams(hInstance, &headroomParams) != LVM_SUCCESS) {
+        return LVM_NULL;
+    }
+    return hInstance;
+}
+
+static void freeInstance(LVM_MemTab_t *memTab) {
+    int i;
+    for (i = 0; i < LVM_NR_MEMORY_REGIONS; i++) {
+        free(memTab->Region[i].pBaseAddress);
+    }
+}
+
+/* Music-like test signal: a few partials plus some noise, at about -12dBFS */
+static void makeInput(LVM_INT16 *in16, LVM_FLOAT *inFloat, size_t frames) {
+    size_t i;
+    unsigned seed = 1;
+
+    for (i = 0; i < frames; i++) {
+        double t = (double)i / 44100.0;
+        double noise;
+        double left, right;
+
+        seed = seed * 1103515245 + 12345;
+        noise = ((double)((seed >> 16) & 0x7fff) / 16384.0 - 1.0) * 0.02;
+        left = 0.12 * sin(2 * M_PI * 80 * t) + 0.08 * sin(2 * M_PI * 440 * t)
+                + 0.04 * sin(2 * M_PI * 3000 * t) + noise;
+        right = 0.12 * sin(2 * M_PI * 82 * t) + 0.08 * sin(2 * M_PI * 660 * t)
+                + 0.04 * sin(2 * M_PI * 5000 * t) - noise;
+
+        in16[2 * i] = (LVM_INT16)lrint(left * 32768.0);
+        in16[2 * i + 1] = (LVM_INT16)lrint(right * 32768.0);
+        /* feed both paths the same quantised signal so only processing differs */
+        inFloat[2 * i] = in16[2 * i] / 32768.0f;
+        inFloat[2 * i + 1] = in16[2 * i + 1] / 32768.0f;
+    }
+}
+
+static int runEffect(int effect, const LVM_INT16 *in16, const LVM_FLOAT *inFloat, size_t frames) {
+    LVM_MemTab_t memTab16, memTabFloat;
+    LVM_Handle_t h16 = createInstance(effect, &memTab16);
+    LVM_Handle_t hFloat = createInstance(effect, &memTabFloat);
+    LVM_INT16 *out16 = malloc(frames * 2 * sizeof(LVM_INT16));
+    LVM_FLOAT *outFloat = malloc(frames * 2 * sizeof(LVM_FLOAT));
+    int64_t ns16 = 0, nsFloat = 0;
+    double maxErr = 0, sumErr = 0, sumRef = 0;
+    size_t i;
+
+    if (h16 == LVM_NULL || hFloat == LVM_NULL || out16 == NULL || outFloat == NULL) {
+        fprintf(stderr, "%s: unable to create instances\n", kEffectNames[effect]);
+        return 1;
+    }
+
+    for (i = 0; i < frames; i += BLOCK_FRAMES) {
+        int64_t start = getNowNs();
+        if (LVM_Process(h16, &in16[2 * i], &out16[2 * i], BLOCK_FRAMES, 0) != LVM_SUCCESS) {
+            fprintf(stderr, "%s: LVM_Process failed\n", kEffectNames[effect]);
+            return 1;
+        }
+        ns16 += getNowNs() - start;
+
+        start = getNowNs();
+        if (LVM_Process_Float(hFloat, &inFloat[2 * i], &outFloat[2 * i], BLOCK_FRAMES, 0)
+                != LVM_SUCCESS) {
+            fprintf(stderr, "%s: LVM_Process_Float failed\n", kEffectNames[effect]);
+            return 1;
+        }
+        nsFloat += getNowNs() - start;
+    }
+
+    for (i = 0; i < frames * 2; i++) {
+        double ref = out16[i] / 32768.0;
+        double err = fabs(outFloat[i] - ref);
+        if (err > maxErr) {
+            maxErr = err;
+        }
+        sumErr += err * err;
+        sumRef += ref * ref;
+    }
+
+    printf("%-12s %9.2f %9.2f %9.2f %12.2f %12.2f\n", kEffectNames[effect],
+            (double)ns16 / frames, (double)nsFloat / frames,
+            (double)ns16 / (nsFloat > 0 ? nsFloat : 1),
+            maxErr > 0 ? 20 * log10(maxErr) : -999.0,
+            sumErr > 0 ? 10 * log10(sumErr / (sumRef > 0 ? sumRef : 1)) : -999.0);
+
+    freeInstance(&memTab16);
+    freeInstance(&memTabFloat);
+    free(out16);
+    free(outFloat);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    int seconds = 10;
+    int only = -1;
+    int res;
+    int i;
+
+    while ((res = getopt(argc, argv, "hn:e:")) >= 0) {
+        switch (res) {
+            case 'n':
+                seconds = atoi(optarg);
+                if (seconds <= 0) {
+                    usage(me);
+                }
+                break;
+            case 'e':
+                for (i = 0; i < NUM_EFFECTS; i++) {
+                    if (!strcmp(optarg, kEffectNames[i])) {
+                        only = i;
+                    }
+                }
+                if (only < 0) {
+                    usage(me);
+                }
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+
+    size_t frames = (size_t)seconds * 44100 / BLOCK_FRAMES * BLOCK_FRAMES;
+    LVM_INT16 *in16 = malloc(frames * 2 * sizeof(LVM_INT16));
+    LVM_FLOAT *inFloat = malloc(frames * 2 * sizeof(LVM_FLOAT));
+    if (in16 == NULL || inFloat == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    makeInput(in16, inFloat, frames);
+
+    printf("%-12s %9s %9s %9s %12s %12s\n",
+            "effect", "ns/f 16", "ns/f flt", "speedup", "max err dB", "rms err dB");
+    for (i = 0; i < NUM_EFFECTS; i++) {
+        if (only >= 0 && i != only) {
+            continue;
+        }
+        if (runEffect(i, in16, inFloat, frames) != 0) {
+            return 1;
+        }
+    }
+
+    free(in16);
+    free(inFloat);
+    return 0;
+}
@@ -0,0 +1,346 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Runs every reverb preset through LVREV_Process, LVREV_Process_Float and
+ * LVREV_Process_Float with the half rate tail, and reports the cost per frame
+ * of each path, the decay time measured on a noise burst, and how far the
+ * float outputs are from the fixed point reference.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "LVREV.h"
+
+#define BLOCK_FRAMES        256
+#define SAMPLE_RATE         48000
+#define BURST_FRAMES        (SAMPLE_RATE / 5)
+#define DECAY_FRAMES        (SAMPLE_RATE * 3)
+
+enum {
+    PATH_FIXED,
+    PATH_FLOAT,
+    PATH_HALF_RATE,
+    NUM_PATHS
+};
+
+/* Same mapping from the OpenSL ES presets as the reverb wrapper */
+typedef struct {
+    const char *name;
+    LVM_UINT16 t60;
+    LVM_UINT16 damping;
+    LVM_UINT16 density;
+    LVM_UINT16 roomSize;
+} Preset;
+
+static const Preset kPresets[] = {
+    { "smallroom",  1100, 41, 100, 100 },
+    { "mediumroom", 1300, 41, 100, 100 },
+    { "largeroom",  1500, 41, 100, 100 },
+    { "mediumhall", 1800, 35, 100, 100 },
+    { "largehall",  1800, 35, 100, 100 },
+    { "plate",      1300, 45, 100,  75 },
+};
+
+#define NUM_PRESETS (sizeof(kPresets) / sizeof(kPresets[0]))
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-n <seconds>] [-p <preset>]\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -n seconds of 48kHz audio to process (default 10)\n");
+    fprintf(stderr, "       -p smallroom, mediumroom, largeroom, mediumhall, largehall or plate"
+            " (default all)\n");
+
+    exit(1);
+}
+
+static int64_t getNowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (int64_t)ts.tv_nsec + ts.tv_sec * 1000000000ll;
+}
+
+static LVREV_Handle_t createInstance(const Preset *preset, int path, LVREV_MemoryTable_st *memTab) {
+    LVREV_InstanceParams_st instParams;
+    LVREV_ControlParams_st params;
+    LVREV_Handle_t hInstance = LVM_NULL;
+    int i;
+
+    instParams.MaxBlockSize = BLOCK_FRAMES;
+    instParams.SourceFormat = LVM_MONO;
+    instParams.NumDelays    = LVREV_DELAYLINES_4;
+
+    if (LVREV_GetMemoryTable(LVM_NULL, memTab, &instParams) != LVREV_SUCCESS) {
+        return LVM_NULL;
+    }
+    for (i = 0; i < LVREV_NR_MEMORY_REGIONS; i++) {
+        memTab->Region[i].pBaseAddress = NULL;
+        if (memTab->Region[i].Size != 0) {
+            memTab->Region[i].pBaseAddress = malloc(memTab->Region[i].Size);
+            if (memTab->Region[i].pBaseAddress == NULL) {
+                return LVM_NULL;
+            }
+        }
+    }
+    if (LVREV_GetInstanceHandle(&hInstance, memTab, &instParams) != LVREV_SUCCESS) {
+        return LVM_NULL;
+    }
+
+    /* Auxiliary reverb defaults from the wrapper, with the preset applied */
+    params.OperatingMode = LVM_MODE_ON;
+    params.SampleRate    = LVM_FS_48000;
+    params.SourceFormat  = LVM_MONO;
+    params.Level         = 100;
+    params.LPF           = 23999;
+    params.HPF           = 50;
+    params.T60           = preset->t60;
+    params.Density       = preset->density;
+    params.Damping       = preset->damping;
+    params.RoomSize      = preset->roomSize;
+    params.HalfRateTail  = path == PATH_HALF_RATE ? LVM_MODE_ON : LVM_MODE_OFF;
+
+    if (LVREV_SetControlParameters(hInstance, &params) != LVREV_SUCCESS) {
+        return LVM_NULL;
+    }
+    return hInstance;
+}
+
+static void freeInstance(LVREV_MemoryTable_st *memTab) {
+    int i;
+    for (i = 0; i < LVREV_NR_MEMORY_REGIONS; i++) {
+        free(memTab->Region[i].pBaseAddress);
+    }
+}
+
+/* Mono noise at about -12dBFS, the first burstFrames only if burstFrames is not 0 */
+static void makeInput(LVM_INT32 *inFixed, LVM_FLOAT *inFloat, size_t frames, size_t burstFrames) {
+    size_t i;
+    unsigned seed = 1;
+
+    for (i = 0; i < frames; i++) {
+        LVM_INT16 sample = 0;
+
+        seed = seed * 1103515245 + 12345;
+        if (burstFrames == 0 || i < burstFrames) {
+            sample = (LVM_INT16)((int)((seed >> 16) & 0x7fff) / 4 - 4096);
+        }
+        /* same 8.24 scaling as the wrapper, both paths see the same quantised signal */
+        inFixed[i] = (LVM_INT32)sample << 8;
+        inFloat[i] = sample / 32768.0f;
+    }
+}
+
+/* Processes the input with one path, returns the time spent and the output scaled to float */
+static int64_t runPath(const Preset *preset, int path, const LVM_INT32 *inFixed,
+        const LVM_FLOAT *inFloat, LVM_FLOAT *out, size_t frames) {
+    LVREV_MemoryTable_st memTab;
+    LVREV_Handle_t hInstance = createInstance(preset, path, &memTab);
+    LVM_INT32 *outFixed = malloc(BLOCK_FRAMES * 2 * sizeof(LVM_INT32));
+    int64_t ns = 0;
+    size_t i, j;
+
+    if (hInstance == LVM_NULL || outFixed == NULL) {
+        fprintf(stderr, "%s: unable to create instance\n", preset->name);
+        return -1;
+    }
+
+    for (i = 0; i < frames; i += BLOCK_FRAMES) {
+        LVREV_ReturnStatus_en status;
+        int64_t start = getNowNs();
+
+        if (path == PATH_FIXED) {
+            status = LVREV_Process(hInstance, (LVM_INT32 *)&inFixed[i], outFixed, BLOCK_FRAMES);
+        } else {
+            status = LVREV_Process_Float(hInstance, &inFloat[i], &out[2 * i], BLOCK_FRAMES);
+        }
+        ns += getNowNs() - start;
+        if (status != LVREV_SUCCESS) {
+            fprintf(stderr, "%s: process failed %d\n", preset->name, status);
+            ns = -1;
+            break;
+        }
+        if (path == PATH_FIXED) {
+            for (j = 0; j < BLOCK_FRAMES * 2; j++) {
+                out[2 * i + j] = outFixed[j] / 8388608.0f;
+            }
+        }
+    }
+
+    freeInstance(&memTab);
+    free(outFixed);
+    return ns;
+}
+
+static double energy(const LVM_FLOAT *out, size_t frames) {
+    double sum = 0;
+    size_t i;
+
+    for (i = 0; i < frames * 2; i++) {
+        sum += (double)out[i] * out[i];
+    }
+    return sum;
+}
+
+/* Decay time from the Schroeder integral of the tail, extrapolated from -5dB to -25dB */
+static double measureT60(const LVM_FLOAT *out, size_t frames) {
+    double total = energy(&out[2 * BURST_FRAMES], frames - BURST_FRAMES);
+    double remaining = total;
+    double t5 = -1, t25 = -1;
+    size_t i;
+
+    if (total <= 0) {
+        return 0;
+    }
+    for (i = BURST_FRAMES; i < frames; i++) {
+        double level = 10 * log10(remaining / total);
+
+        if (t5 < 0 && level <= -5) {
+            t5 = (double)i / SAMPLE_RATE;
+        }
+        if (level <= -25) {
+            t25 = (double)i / SAMPLE_RATE;
+            break;
+        }
+        remaining -= (double)out[2 * i] * out[2 * i] + (double)out[2 * i + 1] * out[2 * i + 1];
+    }
+    if (t5 < 0 || t25 < 0) {
+        return 0;
+    }
+    return 3 * (t25 - t5) * 1000;
+}
+
+static double errorDb(const LVM_FLOAT *out, const LVM_FLOAT *ref, size_t frames) {
+    double sumErr = 0, sumRef = 0;
+    size_t i;
+
+    for (i = 0; i < frames * 2; i++) {
+        double err = (double)out[i] - ref[i];
+        sumErr += err * err;
+        sumRef += (double)ref[i] * ref[i];
+    }
+    return sumErr > 0 ? 10 * log10(sumErr / (sumRef > 0 ? sumRef : 1)) : -999.0;
+}
+
+static int runPreset(const Preset *preset, size_t frames) {
+    size_t decayFrames = (BURST_FRAMES + DECAY_FRAMES) / BLOCK_FRAMES * BLOCK_FRAMES;
+    size_t maxFrames = frames > decayFrames ? frames : decayFrames;
+    LVM_INT32 *inFixed = malloc(maxFrames * sizeof(LVM_INT32));
+    LVM_FLOAT *inFloat = malloc(maxFrames * sizeof(LVM_FLOAT));
+    LVM_FLOAT *out[NUM_PATHS];
+    int64_t ns[NUM_PATHS];
+    double t60[NUM_PATHS];
+    int path;
+
+    for (path = 0; path < NUM_PATHS; path++) {
+        out[path] = malloc(maxFrames * 2 * sizeof(LVM_FLOAT));
+        if (out[path] == NULL) {
+            fprintf(stderr, "out of memory\n");
+            return 1;
+        }
+    }
+    if (inFixed == NULL || inFloat == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    /* Decay of a noise burst */
+    makeInput(inFixed, inFloat, decayFrames, BURST_FRAMES);
+    for (path = 0; path < NUM_PATHS; path++) {
+        if (runPath(preset, path, inFixed, inFloat, out[path], decayFrames) < 0) {
+            return 1;
+        }
+        t60[path] = measureT60(out[path], decayFrames);
+    }
+
+    /* Cost and accuracy on continuous noise */
+    makeInput(inFixed, inFloat, frames, 0);
+    for (path = 0; path < NUM_PATHS; path++) {
+        ns[path] = runPath(preset, path, inFixed, inFloat, out[path], frames);
+        if (ns[path] < 0) {
+            return 1;
+        }
+    }
+
+    printf("%-11s %8.1f %8.1f %8.1f %6.0f %6.0f %6.0f %9.2f %9.2f %9.2f\n", preset->name,
+            (double)ns[PATH_FIXED] / frames, (double)ns[PATH_FLOAT] / frames,
+            (double)ns[PATH_HALF_RATE] / frames,
+            t60[PATH_FIXED], t60[PATH_FLOAT], t60[PATH_HALF_RATE],
+            10 * log10(energy(out[PATH_HALF_RATE], frames) / energy(out[PATH_FIXED], frames)),
+            errorDb(out[PATH_FLOAT], out[PATH_FIXED], frames),
+            errorDb(out[PATH_HALF_RATE], out[PATH_FIXED], frames));
+
+    for (path = 0; path < NUM_PATHS; path++) {
+        free(out[path]);
+    }
+    free(inFixed);
+    free(inFloat);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    int seconds = 10;
+    int only = -1;
+    int res;
+    size_t i;
+
+    while ((res = getopt(argc, argv, "hn:p:")) >= 0) {
+        switch (res) {
+            case 'n':
+                seconds = atoi(optarg);
+                if (seconds <= 0) {
+                    usage(me);
+                }
+                break;
+            case 'p':
+                for (i = 0; i < NUM_PRESETS; i++) {
+                    if (!strcmp(optarg, kPresets[i].name)) {
+                        only = (int)i;
+                    }
+                }
+                if (only < 0) {
+                    usage(me);
+                }
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+
+    size_t frames = (size_t)seconds * SAMPLE_RATE / BLOCK_FRAMES * BLOCK_FRAMES;
+
+    printf("%-11s %8s %8s %8s %6s %6s %6s %9s %9s %9s\n", "preset",
+            "ns/f fix", "ns/f flt", "ns/f hlf", "T60fix", "T60flt", "T60hlf",
+            "hlf lvl", "flt err", "hlf err");
+    for (i = 0; i < NUM_PRESETS; i++) {
+        if (only >= 0 && (int)i != only) {
+            continue;
+        }
+        if (runPreset(&kPresets[i], frames) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
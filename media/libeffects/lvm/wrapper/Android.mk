@@ -15,7 +15,7 @@ LOCAL_MODULE:= libbundlewrapper
 
 LOCAL_MODULE_RELATIVE_PATH := soundfx
 
-LOCAL_STATIC_LIBRARIES += libmusicbundle
+LOCAL_STATIC_LIBRARIES += libmusicbundle libeffectsbiquad
 
 LOCAL_SHARED_LIBRARIES := \
      libcutils \
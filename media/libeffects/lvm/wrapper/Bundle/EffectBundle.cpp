@@ -49,6 +49,10 @@ extern "C" const struct effect_interface_s gLvmEffectInterface;
             ALOGV("\tLVM_ERROR : Parameter error - "\
                     "out of range returned by %s in %s\n", callingFunc, calledFunc);\
         }\
+        if (LvmStatus == LVM_NOTSUPPORTED){\
+            ALOGV("\tLVM_ERROR : Parameter error - "\
+                    "not supported returned by %s in %s\n", callingFunc, calledFunc);\
+        }\
     }
 
 
@@ -263,6 +267,7 @@ extern "C" int EffectCreate(const effect_uuid_t *uuid,
         pContext->pBundledContext->bStereoPositionEnabled   = LVM_FALSE;
         pContext->pBundledContext->positionSaved            = 0;
         pContext->pBundledContext->workBuffer               = NULL;
+        pContext->pBundledContext->workBufferFloat          = NULL;
         pContext->pBundledContext->frameCount               = -1;
         pContext->pBundledContext->SamplesToExitCountVirt   = 0;
         pContext->pBundledContext->SamplesToExitCountBb     = 0;
@@ -433,6 +438,9 @@ extern "C" int EffectRelease(effect_handle_t handle){
         if (pContext->pBundledContext->workBuffer != NULL) {
             free(pContext->pBundledContext->workBuffer);
         }
+        if (pContext->pBundledContext->workBufferFloat != NULL) {
+            free(pContext->pBundledContext->workBufferFloat);
+        }
         delete pContext->pBundledContext;
         pContext->pBundledContext = LVM_NULL;
     }
@@ -722,7 +730,8 @@ int LvmBundle_process(LVM_INT16        *pIn,
     if (pContext->config.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_WRITE){
         pOutTmp = pOut;
     }else if (pContext->config.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE){
-        if (pContext->pBundledContext->frameCount != frameCount) {
+        if (pContext->pBundledContext->frameCount != frameCount ||
+                pContext->pBundledContext->workBuffer == NULL) {
             if (pContext->pBundledContext->workBuffer != NULL) {
                 free(pContext->pBundledContext->workBuffer);
             }
@@ -766,6 +775,68 @@ int LvmBundle_process(LVM_INT16        *pIn,
     return 0;
 }    /* end LvmBundle_process */
 
+//----------------------------------------------------------------------------
+// LvmBundle_process_float()
+//----------------------------------------------------------------------------
+// Purpose:
+// Apply LVM Bundle effects to floating point data, without converting to
+// 16 bit first
+//
+// Inputs:
+//  pIn:        pointer to stereo float input data
+//  pOut:       pointer to stereo float output data
+//  frameCount: Frames to process
+//  pContext:   effect engine context
+//
+//  Outputs:
+//  pOut:       pointer to updated stereo float output data
+//
+//----------------------------------------------------------------------------
+
+int LvmBundle_process_float(LVM_FLOAT        *pIn,
+                            LVM_FLOAT        *pOut,
+                            int              frameCount,
+                            EffectContext    *pContext){
+
+    LVM_ReturnStatus_en     LvmStatus = LVM_SUCCESS;                /* Function call status */
+    LVM_FLOAT               *pOutTmp;
+
+    if (pContext->config.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_WRITE){
+        pOutTmp = pOut;
+    }else if (pContext->config.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE){
+        if (pContext->pBundledContext->frameCount != frameCount ||
+                pContext->pBundledContext->workBufferFloat == NULL) {
+            if (pContext->pBundledContext->workBufferFloat != NULL) {
+                free(pContext->pBundledContext->workBufferFloat);
+            }
+            pContext->pBundledContext->workBufferFloat =
+                    (LVM_FLOAT *)malloc(frameCount * sizeof(LVM_FLOAT) * 2);
+            pContext->pBundledContext->frameCount = frameCount;
+        }
+        pOutTmp = pContext->pBundledContext->workBufferFloat;
+    }else{
+        ALOGV("LVM_ERROR : LvmBundle_process_float invalid access mode");
+        return -EINVAL;
+    }
+
+    /* Process the samples */
+    LvmStatus = LVM_Process_Float(pContext->pBundledContext->hInstance, /* Instance handle */
+                                  pIn,                                  /* Input buffer */
+                                  pOutTmp,                              /* Output buffer */
+                                  (LVM_UINT16)frameCount,               /* Number of samples */
+                                  0);                                   /* Audo Time */
+
+    LVM_ERROR_CHECK(LvmStatus, "LVM_Process_Float", "LvmBundle_process_float")
+    if(LvmStatus != LVM_SUCCESS) return -EINVAL;
+
+    if (pContext->config.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE){
+        for (int i=0; i<frameCount*2; i++){
+            pOut[i] += pOutTmp[i];
+        }
+    }
+    return 0;
+}    /* end LvmBundle_process_float */
+
 //----------------------------------------------------------------------------
 // LvmEffect_enable()
 //----------------------------------------------------------------------------
@@ -937,8 +1008,13 @@ int Effect_setConfig(EffectContext *pContext, effect_config_t *pConfig){
     CHECK_ARG(pConfig->inputCfg.channels == AUDIO_CHANNEL_OUT_STEREO);
     CHECK_ARG(pConfig->outputCfg.accessMode == EFFECT_BUFFER_ACCESS_WRITE
               || pConfig->outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE);
-    CHECK_ARG(pConfig->inputCfg.format == AUDIO_FORMAT_PCM_16_BIT);
+    CHECK_ARG(pConfig->inputCfg.format == AUDIO_FORMAT_PCM_16_BIT
+              || pConfig->inputCfg.format == AUDIO_FORMAT_PCM_FLOAT);
 
+    if (pContext->config.inputCfg.format != pConfig->inputCfg.format) {
+        // the accumulate buffer is sized for the old sample format
+        pContext->pBundledContext->frameCount = -1;
+    }
     pContext->config = *pConfig;
 
     switch (pConfig->inputCfg.samplingRate) {
@@ -2901,10 +2977,17 @@ int Effect_process(effect_handle_t     self,
         pContext->pBundledContext->NumberEffectsCalled = 0;
         /* Process all the available frames, block processing is
            handled internalLY by the LVM bundle */
-        lvmStatus = android::LvmBundle_process(    (LVM_INT16 *)inBuffer->raw,
-                                                (LVM_INT16 *)outBuffer->raw,
-                                                outBuffer->frameCount,
-                                                pContext);
+        if (pContext->config.inputCfg.format == AUDIO_FORMAT_PCM_FLOAT) {
+            lvmStatus = android::LvmBundle_process_float(inBuffer->f32,
+                                                         outBuffer->f32,
+                                                         outBuffer->frameCount,
+                                                         pContext);
+        } else {
+            lvmStatus = android::LvmBundle_process(    (LVM_INT16 *)inBuffer->raw,
+                                                    (LVM_INT16 *)outBuffer->raw,
+                                                    outBuffer->frameCount,
+                                                    pContext);
+        }
         if(lvmStatus != LVM_SUCCESS){
             ALOGV("\tLVM_ERROR : LvmBundle_process returned error %d", lvmStatus);
             return lvmStatus;
@@ -2914,13 +2997,21 @@ int Effect_process(effect_handle_t     self,
         //pContext->pBundledContext->NumberEffectsEnabled,
         //pContext->pBundledContext->NumberEffectsCalled, pContext->EffectType);
         // 2 is for stereo input
+        size_t sampleSize = (pContext->config.inputCfg.format == AUDIO_FORMAT_PCM_FLOAT) ?
+                sizeof(LVM_FLOAT) : sizeof(LVM_INT16);
         if (pContext->config.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE) {
-            for (size_t i=0; i < outBuffer->frameCount*2; i++){
-                outBuffer->s16[i] =
-                        clamp16((LVM_INT32)outBuffer->s16[i] + (LVM_INT32)inBuffer->s16[i]);
+            if (sampleSize == sizeof(LVM_FLOAT)) {
+                for (size_t i=0; i < outBuffer->frameCount*2; i++){
+                    outBuffer->f32[i] += inBuffer->f32[i];
+                }
+            } else {
+                for (size_t i=0; i < outBuffer->frameCount*2; i++){
+                    outBuffer->s16[i] =
+                            clamp16((LVM_INT32)outBuffer->s16[i] + (LVM_INT32)inBuffer->s16[i]);
+                }
             }
         } else if (outBuffer->raw != inBuffer->raw) {
-            memcpy(outBuffer->raw, inBuffer->raw, outBuffer->frameCount*sizeof(LVM_INT16)*2);
+            memcpy(outBuffer->raw, inBuffer->raw, outBuffer->frameCount*sampleSize*2);
         }
     }
 
@@ -96,6 +96,7 @@ struct BundledEffectContext{
     int                             SamplesToExitCountBb;
     int                             SamplesToExitCountVirt;
     LVM_INT16                       *workBuffer;
+    LVM_FLOAT                       *workBufferFloat; /* accumulate buffer for float data */
     int                             frameCount;
     int32_t                         bandGaindB[FIVEBAND_NUMBANDS];
     int                             volume;
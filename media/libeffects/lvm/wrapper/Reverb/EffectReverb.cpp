@@ -26,6 +26,7 @@
 #include <string.h>
 
 #include <cutils/log.h>
+#include <cutils/properties.h>
 #include "EffectReverb.h"
 // from Reverb/lib
 #include "LVREV.h"
@@ -544,6 +545,131 @@ int process( LVM_INT16     *pIn,
     return 0;
 }    /* end process */
 
+//----------------------------------------------------------------------------
+// process_float()
+//----------------------------------------------------------------------------
+// Purpose:
+// Apply the Reverb to floating point data, using the float reverb engine
+//
+// Inputs:
+//  pIn:        pointer to stereo/mono float input data
+//  pOut:       pointer to stereo float output data
+//  frameCount: Frames to process
+//  pContext:   effect engine context
+//
+//  Outputs:
+//  pOut:       pointer to updated stereo float output data
+//
+//----------------------------------------------------------------------------
+
+int process_float( LVM_FLOAT     *pIn,
+                   LVM_FLOAT     *pOut,
+                   int           frameCount,
+                   ReverbContext *pContext){
+
+    LVM_INT16               samplesPerFrame = 1;
+    LVREV_ReturnStatus_en   LvmStatus = LVREV_SUCCESS;              /* Function call status */
+    LVM_FLOAT *InFramesFloat = (LVM_FLOAT *)pContext->InFrames32;
+    LVM_FLOAT *OutFramesFloat = (LVM_FLOAT *)pContext->OutFrames32;
+
+    // Check that the input is either mono or stereo
+    if (pContext->config.inputCfg.channels == AUDIO_CHANNEL_OUT_STEREO) {
+        samplesPerFrame = 2;
+    } else if (pContext->config.inputCfg.channels != AUDIO_CHANNEL_OUT_MONO) {
+        ALOGV("\tLVREV_ERROR : process_float invalid PCM format");
+        return -EINVAL;
+    }
+
+    // Check for NULL pointers
+    if((pContext->InFrames32 == NULL)||(pContext->OutFrames32 == NULL)){
+        ALOGV("\tLVREV_ERROR : process_float failed to allocate memory for temporary buffers ");
+        return -EINVAL;
+    }
+
+    if (pContext->preset && pContext->nextPreset != pContext->curPreset) {
+        Reverb_LoadPreset(pContext);
+    }
+
+    if (pContext->auxiliary) {
+        memcpy(InFramesFloat, pIn, frameCount * sizeof(LVM_FLOAT) * samplesPerFrame);
+    } else {
+        // insert reverb input is always stereo
+        const LVM_FLOAT sendLevel = (LVM_FLOAT)REVERB_SEND_LEVEL / REVERB_UNIT_VOLUME;
+        for (int i = 0; i < frameCount * 2; i++) {
+            InFramesFloat[i] = pIn[i] * sendLevel;
+        }
+    }
+
+    if (pContext->preset && pContext->curPreset == REVERB_PRESET_NONE) {
+        memset(OutFramesFloat, 0, frameCount * sizeof(LVM_FLOAT) * 2); //always stereo here
+    } else {
+        if(pContext->bEnabled == LVM_FALSE && pContext->SamplesToExitCount > 0) {
+            memset(InFramesFloat, 0, frameCount * sizeof(LVM_FLOAT) * samplesPerFrame);
+            ALOGV("\tZeroing %d samples per frame at the end of call", samplesPerFrame);
+        }
+
+        /* Process the samples, producing a stereo output */
+        LvmStatus = LVREV_Process_Float(pContext->hInstance,    /* Instance handle */
+                                        InFramesFloat,          /* Input buffer */
+                                        OutFramesFloat,         /* Output buffer */
+                                        frameCount);            /* Number of samples to read */
+    }
+
+    LVM_ERROR_CHECK(LvmStatus, "LVREV_Process_Float", "process_float")
+    if(LvmStatus != LVREV_SUCCESS) return -EINVAL;
+
+    if (!pContext->auxiliary) {
+        for (int i=0; i < frameCount*2; i++) { //always stereo here
+            OutFramesFloat[i] += pIn[i];
+        }
+
+        // apply volume with ramp if needed
+        if ((pContext->leftVolume != pContext->prevLeftVolume ||
+                pContext->rightVolume != pContext->prevRightVolume) &&
+                pContext->volumeMode == REVERB_VOLUME_RAMP) {
+            LVM_FLOAT vl = (LVM_FLOAT)pContext->prevLeftVolume / REVERB_UNIT_VOLUME;
+            LVM_FLOAT incl = ((LVM_FLOAT)pContext->leftVolume / REVERB_UNIT_VOLUME - vl) / frameCount;
+            LVM_FLOAT vr = (LVM_FLOAT)pContext->prevRightVolume / REVERB_UNIT_VOLUME;
+            LVM_FLOAT incr = ((LVM_FLOAT)pContext->rightVolume / REVERB_UNIT_VOLUME - vr) / frameCount;
+
+            for (int i = 0; i < frameCount; i++) {
+                OutFramesFloat[2*i] *= vl;
+                OutFramesFloat[2*i+1] *= vr;
+
+                vl += incl;
+                vr += incr;
+            }
+
+            pContext->prevLeftVolume = pContext->leftVolume;
+            pContext->prevRightVolume = pContext->rightVolume;
+        } else if (pContext->volumeMode != REVERB_VOLUME_OFF) {
+            if (pContext->leftVolume != REVERB_UNIT_VOLUME ||
+                pContext->rightVolume != REVERB_UNIT_VOLUME) {
+                const LVM_FLOAT vl = (LVM_FLOAT)pContext->leftVolume / REVERB_UNIT_VOLUME;
+                const LVM_FLOAT vr = (LVM_FLOAT)pContext->rightVolume / REVERB_UNIT_VOLUME;
+                for (int i = 0; i < frameCount; i++) {
+                    OutFramesFloat[2*i] *= vl;
+                    OutFramesFloat[2*i+1] *= vr;
+                }
+            }
+            pContext->prevLeftVolume = pContext->leftVolume;
+            pContext->prevRightVolume = pContext->rightVolume;
+            pContext->volumeMode = REVERB_VOLUME_RAMP;
+        }
+    }
+
+    // Accumulate if required
+    if (pContext->config.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE){
+        for (int i=0; i<frameCount*2; i++){ //always stereo here
+            pOut[i] += OutFramesFloat[i];
+        }
+    }else{
+        memcpy(pOut, OutFramesFloat, frameCount*sizeof(LVM_FLOAT)*2);
+    }
+
+    return 0;
+}    /* end process_float */
+
 //----------------------------------------------------------------------------
 // Reverb_free()
 //----------------------------------------------------------------------------
@@ -616,7 +742,8 @@ int Reverb_setConfig(ReverbContext *pContext, effect_config_t *pConfig){
     CHECK_ARG(pConfig->outputCfg.channels == AUDIO_CHANNEL_OUT_STEREO);
     CHECK_ARG(pConfig->outputCfg.accessMode == EFFECT_BUFFER_ACCESS_WRITE
               || pConfig->outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE);
-    CHECK_ARG(pConfig->inputCfg.format == AUDIO_FORMAT_PCM_16_BIT);
+    CHECK_ARG(pConfig->inputCfg.format == AUDIO_FORMAT_PCM_16_BIT
+              || pConfig->inputCfg.format == AUDIO_FORMAT_PCM_FLOAT);
 
     //ALOGV("\tReverb_setConfig calling memcpy");
     pContext->config = *pConfig;
@@ -836,6 +963,16 @@ int Reverb_init(ReverbContext *pContext){
     params.Density        = 100;
     params.Damping        = 21;
     params.RoomSize       = 100;
+    // Running the presets at half rate is cheaper but leaves 1.5-1.8dB less
+    // wet energy, so devices have to opt in.
+    params.HalfRateTail   = LVM_MODE_OFF;
+    if (pContext->preset) {
+        char value[PROPERTY_VALUE_MAX];
+        property_get("ro.audio.reverb.half_rate_tail", value, "0");
+        if (!strcmp(value, "1") || !strcmp(value, "true")) {
+            params.HalfRateTail = LVM_MODE_ON;
+        }
+    }
 
     pContext->SamplesToExitCount = (params.T60 * pContext->config.inputCfg.samplingRate)/1000;
 
@@ -1874,10 +2011,17 @@ int Reverb_process(effect_handle_t   self,
     }
     //ALOGV("\tReverb_process() Calling process with %d frames", outBuffer->frameCount);
     /* Process all the available frames, block processing is handled internalLY by the LVM bundle */
-    status = process(    (LVM_INT16 *)inBuffer->raw,
-                         (LVM_INT16 *)outBuffer->raw,
-                                      outBuffer->frameCount,
-                                      pContext);
+    if (pContext->config.inputCfg.format == AUDIO_FORMAT_PCM_FLOAT) {
+        status = process_float(inBuffer->f32,
+                               outBuffer->f32,
+                               outBuffer->frameCount,
+                               pContext);
+    } else {
+        status = process(    (LVM_INT16 *)inBuffer->raw,
+                             (LVM_INT16 *)outBuffer->raw,
+                                          outBuffer->frameCount,
+                                          pContext);
+    }
 
     if (pContext->bEnabled == LVM_FALSE) {
         if (pContext->SamplesToExitCount > 0) {
@@ -22,9 +22,12 @@ LOCAL_SHARED_LIBRARIES := \
     libwebrtc_audio_preprocessing \
     libspeexresampler \
     libutils \
+    libcutils \
     liblog
 
 LOCAL_SHARED_LIBRARIES += libdl
 LOCAL_CFLAGS += -fvisibility=hidden
 
 include $(BUILD_SHARED_LIBRARY)
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
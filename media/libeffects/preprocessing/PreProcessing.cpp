@@ -20,6 +20,7 @@
 //#define LOG_NDEBUG 0
 #include <utils/Log.h>
 #include <utils/Timers.h>
+#include <cutils/properties.h>
 #include <hardware/audio_effect.h>
 #include <audio_effects/effect_aec.h>
 #include <audio_effects/effect_agc.h>
@@ -35,8 +36,10 @@
 // local definitions
 //------------------------------------------------------------------------------
 
-// maximum number of sessions
+// default maximum number of sessions, can be changed with property ro.audio.preproc.max_sessions
 #define PREPROC_NUM_SESSIONS 8
+// upper limit for ro.audio.preproc.max_sessions
+#define PREPROC_MAX_SESSIONS 256
 
 // types of pre processing modules
 enum preproc_id
@@ -766,6 +769,22 @@ int Session_Init(preproc_session_t *session)
 }
 
 
+// Makes room for at least frames frames of channelCount samples in a session buffer.
+// Returns false, and leaves the buffer unchanged, if it could not be allocated.
+bool Session_ReserveBuffer(int16_t **buf, size_t *bufSize, size_t frames, uint32_t channelCount)
+{
+    if (*bufSize >= frames) {
+        return true;
+    }
+    int16_t *newBuf = (int16_t *)realloc(*buf, frames * channelCount * sizeof(int16_t));
+    if (newBuf == NULL) {
+        return false;
+    }
+    *buf = newBuf;
+    *bufSize = frames;
+    return true;
+}
+
 extern "C" int Session_CreateEffect(preproc_session_t *session,
                                     int32_t procId,
                                     effect_handle_t  *interface)
@@ -862,11 +881,11 @@ int Session_ReleaseEffect(preproc_session_t *session,
             speex_resampler_destroy(session->revResampler);
             session->revResampler = NULL;
         }
-        delete session->inBuf;
+        free(session->inBuf);
         session->inBuf = NULL;
-        delete session->outBuf;
+        free(session->outBuf);
         session->outBuf = NULL;
-        delete session->revBuf;
+        free(session->revBuf);
         session->revBuf = NULL;
 
         session->io = 0;
@@ -945,9 +964,19 @@ int Session_SetConfig(preproc_session_t *session, effect_config_t *config)
     // force process buffer reallocation
     session->inBufSize = 0;
     session->outBufSize = 0;
+    session->revBufSize = 0;
     session->framesIn = 0;
     session->framesOut = 0;
+    session->framesRev = 0;
 
+    // allocate the process buffers for the new configuration now rather than on the first
+    // process calls. The output buffer only needs more than two 10 ms chunks if the output is
+    // read in smaller chunks than it is produced.
+    if (!Session_ReserveBuffer(&session->outBuf, &session->outBufSize,
+            2 * session->frameCount, session->outChannelCount)) {
+        ALOGW("Session_SetConfig Cannot allocate output buffer");
+        return -ENOMEM;
+    }
 
     if (session->inResampler != NULL) {
         speex_resampler_destroy(session->inResampler);
@@ -999,6 +1028,14 @@ int Session_SetConfig(preproc_session_t *session, effect_config_t *config)
             session->outResampler = NULL;
             return -EINVAL;
         }
+        // the resampler input buffers never hold more than one 10 ms chunk
+        if (!Session_ReserveBuffer(&session->inBuf, &session->inBufSize,
+                        session->frameCount, session->inChannelCount) ||
+                !Session_ReserveBuffer(&session->revBuf, &session->revBufSize,
+                        session->frameCount, session->inChannelCount)) {
+            ALOGW("Session_SetConfig Cannot allocate resampler buffers");
+            return -ENOMEM;
+        }
     }
 
     session->state = PREPROC_SESSION_STATE_CONFIG;
@@ -1043,8 +1080,7 @@ int Session_SetReverseConfig(preproc_session_t *session, effect_config_t *config
     session->revChannelCount = inCnl;
     session->revFrame->_audioChannel = inCnl;
     session->revFrame->_frequencyInHz = session->apmSamplingRate;
-    // force process buffer reallocation
-    session->revBufSize = 0;
+    // the reverse buffer is sized for the input channel count by Session_SetConfig()
     session->framesRev = 0;
 
     return 0;
@@ -1101,42 +1137,66 @@ void Session_SetProcEnabled(preproc_session_t *session, uint32_t procId, bool en
 //------------------------------------------------------------------------------
 
 static int sInitStatus = 1;
-static preproc_session_t sSessions[PREPROC_NUM_SESSIONS];
+// Sessions are allocated when first needed, up to sMaxSessions, and reused once released.
+static preproc_session_t **sSessions;
+static size_t sMaxSessions;         // size of sSessions
+static size_t sNumSessions;         // number of sessions allocated in sSessions
 
 preproc_session_t *PreProc_GetSession(int32_t procId, int32_t  sessionId, int32_t  ioId)
 {
     size_t i;
-    int free = -1;
-    for (i = 0; i < PREPROC_NUM_SESSIONS; i++) {
-        if (sSessions[i].io == ioId) {
-            if (sSessions[i].createdMsk & (1 << procId)) {
+    preproc_session_t *session = NULL;
+
+    for (i = 0; i < sNumSessions; i++) {
+        if (sSessions[i]->io == ioId) {
+            if (sSessions[i]->createdMsk & (1 << procId)) {
                 return NULL;
             }
-            return &sSessions[i];
+            return sSessions[i];
         }
     }
-    for (i = 0; i < PREPROC_NUM_SESSIONS; i++) {
-        if (sSessions[i].io == 0) {
-            sSessions[i].id = sessionId;
-            sSessions[i].io = ioId;
-            return &sSessions[i];
+    for (i = 0; i < sNumSessions; i++) {
+        if (sSessions[i]->io == 0) {
+            session = sSessions[i];
+            break;
         }
     }
-    return NULL;
+    if (session == NULL) {
+        if (sNumSessions == sMaxSessions) {
+            ALOGW("PreProc_GetSession all %zu sessions in use", sMaxSessions);
+            return NULL;
+        }
+        session = (preproc_session_t *)calloc(1, sizeof(preproc_session_t));
+        if (session == NULL || Session_Init(session) != 0) {
+            free(session);
+            return NULL;
+        }
+        sSessions[sNumSessions++] = session;
+    }
+    session->id = sessionId;
+    session->io = ioId;
+    return session;
 }
 
 
 int PreProc_Init() {
-    size_t i;
-    int status = 0;
+    char value[PROPERTY_VALUE_MAX];
 
     if (sInitStatus <= 0) {
         return sInitStatus;
     }
-    for (i = 0; i < PREPROC_NUM_SESSIONS && status == 0; i++) {
-        status = Session_Init(&sSessions[i]);
+    sMaxSessions = PREPROC_NUM_SESSIONS;
+    if (property_get("ro.audio.preproc.max_sessions", value, NULL) > 0) {
+        char *endptr;
+        unsigned long ul = strtoul(value, &endptr, 0);
+        if (*endptr == '\0' && ul > 0 && ul <= PREPROC_MAX_SESSIONS) {
+            sMaxSessions = ul;
+        } else {
+            ALOGW("PreProc_Init ignoring ro.audio.preproc.max_sessions %s", value);
+        }
     }
-    sInitStatus = status;
+    sSessions = (preproc_session_t **)calloc(sMaxSessions, sizeof(preproc_session_t *));
+    sInitStatus = sSessions != NULL ? 0 : -ENOMEM;
     return sInitStatus;
 }
 
@@ -1194,7 +1254,7 @@ int PreProcessingFx_Process(effect_handle_t     self,
             memcpy(outBuffer->s16,
                   session->outBuf,
                   fr * session->outChannelCount * sizeof(int16_t));
-            memcpy(session->outBuf,
+            memmove(session->outBuf,
                   session->outBuf + fr * session->outChannelCount,
                   (session->framesOut - fr) * session->outChannelCount * sizeof(int16_t));
             session->framesOut -= fr;
@@ -1211,10 +1271,9 @@ int PreProcessingFx_Process(effect_handle_t     self,
             if (inBuffer->frameCount < fr) {
                 fr = inBuffer->frameCount;
             }
-            if (session->inBufSize < session->framesIn + fr) {
-                session->inBufSize = session->framesIn + fr;
-                session->inBuf = (int16_t *)realloc(session->inBuf,
-                                 session->inBufSize * session->inChannelCount * sizeof(int16_t));
+            if (!Session_ReserveBuffer(&session->inBuf, &session->inBufSize,
+                    session->framesIn + fr, session->inChannelCount)) {
+                return -ENOMEM;
             }
             memcpy(session->inBuf + session->framesIn * session->inChannelCount,
                    inBuffer->s16,
@@ -1249,7 +1308,7 @@ int PreProcessingFx_Process(effect_handle_t     self,
                                                         session->procFrame->_payloadData,
                                                         &frOut);
             }
-            memcpy(session->inBuf,
+            memmove(session->inBuf,
                    session->inBuf + frIn * session->inChannelCount,
                    (session->framesIn - frIn) * session->inChannelCount * sizeof(int16_t));
             session->framesIn -= frIn;
@@ -1283,10 +1342,9 @@ int PreProcessingFx_Process(effect_handle_t     self,
 
         effect->session->apm->ProcessStream(session->procFrame);
 
-        if (session->outBufSize < session->framesOut + session->frameCount) {
-            session->outBufSize = session->framesOut + session->frameCount;
-            session->outBuf = (int16_t *)realloc(session->outBuf,
-                              session->outBufSize * session->outChannelCount * sizeof(int16_t));
+        if (!Session_ReserveBuffer(&session->outBuf, &session->outBufSize,
+                session->framesOut + session->frameCount, session->outChannelCount)) {
+            return -ENOMEM;
         }
 
         if (session->outResampler != NULL) {
@@ -1320,7 +1378,7 @@ int PreProcessingFx_Process(effect_handle_t     self,
         memcpy(outBuffer->s16 + framesWr * session->outChannelCount,
               session->outBuf,
               fr * session->outChannelCount * sizeof(int16_t));
-        memcpy(session->outBuf,
+        memmove(session->outBuf,
               session->outBuf + fr * session->outChannelCount,
               (session->framesOut - fr) * session->outChannelCount * sizeof(int16_t));
         session->framesOut -= fr;
@@ -1740,10 +1798,9 @@ int PreProcessingFx_ProcessReverse(effect_handle_t     self,
             if (inBuffer->frameCount < fr) {
                 fr = inBuffer->frameCount;
             }
-            if (session->revBufSize < session->framesRev + fr) {
-                session->revBufSize = session->framesRev + fr;
-                session->revBuf = (int16_t *)realloc(session->revBuf,
-                                  session->revBufSize * session->inChannelCount * sizeof(int16_t));
+            if (!Session_ReserveBuffer(&session->revBuf, &session->revBufSize,
+                    session->framesRev + fr, session->inChannelCount)) {
+                return -ENOMEM;
             }
             memcpy(session->revBuf + session->framesRev * session->inChannelCount,
                    inBuffer->s16,
@@ -1770,7 +1827,7 @@ int PreProcessingFx_ProcessReverse(effect_handle_t     self,
                                                         session->revFrame->_payloadData,
                                                         &frOut);
             }
-            memcpy(session->revBuf,
+            memmove(session->revBuf,
                    session->revBuf + frIn * session->inChannelCount,
                    (session->framesRev - frIn) * session->inChannelCount * sizeof(int16_t));
             session->framesRev -= frIn;
@@ -0,0 +1,29 @@
+LOCAL_PATH:= $(call my-dir)
+
+# Pre processing effects benchmark with many capture sessions
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+    preprocbench.cpp \
+    ../PreProcessing.cpp
+
+LOCAL_C_INCLUDES += \
+    external/webrtc/src \
+    external/webrtc/src/modules/interface \
+    external/webrtc/src/modules/audio_processing/interface \
+    $(call include-path-for, audio-effects)
+
+LOCAL_C_INCLUDES += $(call include-path-for, speex)
+
+LOCAL_SHARED_LIBRARIES := \
+    libwebrtc_audio_preprocessing \
+    libspeexresampler \
+    libutils \
+    libcutils \
+    liblog
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= preprocbench
+
+include $(BUILD_EXECUTABLE)
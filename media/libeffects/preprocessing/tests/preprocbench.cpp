@@ -0,0 +1,258 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Drives a number of synthetic capture sessions through the pre processing effects, the way
+ * a RecordThread does for each input, and reports the CPU time spent per session.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <audio_effects/effect_aec.h>
+#include <audio_effects/effect_agc.h>
+#include <audio_effects/effect_ns.h>
+#include <hardware/audio_effect.h>
+#include <system/audio.h>
+
+extern audio_effect_library_t AUDIO_EFFECT_LIBRARY_INFO_SYM;
+
+// implementation UUIDs of the effects in PreProcessing.cpp
+static const effect_uuid_t kAgcUuid =
+        { 0xaa8130e0, 0x66fc, 0x11e0, 0xbad0, { 0x00, 0x02, 0xa5, 0xd5, 0xc5, 0x1b } };
+static const effect_uuid_t kAecUuid =
+        { 0xbb392ec0, 0x8d4d, 0x11e0, 0xa896, { 0x00, 0x02, 0xa5, 0xd5, 0xc5, 0x1b } };
+static const effect_uuid_t kNsUuid =
+        { 0xc06c8400, 0x8e06, 0x11e0, 0x9cb6, { 0x00, 0x02, 0xa5, 0xd5, 0xc5, 0x1b } };
+
+static const struct {
+    char name;
+    const effect_uuid_t *uuid;
+} kEffects[] = {
+    { 'g', &kAgcUuid },
+    { 'e', &kAecUuid },
+    { 'n', &kNsUuid },
+};
+static const size_t kNumEffects = sizeof(kEffects) / sizeof(kEffects[0]);
+
+struct Session {
+    effect_handle_t handles[3];
+    size_t numHandles;
+    effect_handle_t reverse;        // handle with a reverse stream (AEC), or NULL
+    int64_t cpuNs;
+};
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-n <sessions>] [-r <rate>] [-c <channels>] [-b <ms>]"
+            " [-s <seconds>] [-e <effects>]\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -n number of capture sessions (default 8)\n");
+    fprintf(stderr, "       -r sample rate of the capture (default 48000)\n");
+    fprintf(stderr, "       -c channel count of the capture, 1 or 2 (default 1)\n");
+    fprintf(stderr, "       -b milliseconds per process call (default 20)\n");
+    fprintf(stderr, "       -s seconds of audio per session (default 10)\n");
+    fprintf(stderr, "       -e effects per session, any of g(agc) e(aec) n(ns) (default gen)\n");
+
+    exit(1);
+}
+
+static int64_t getThreadCpuNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return (int64_t)ts.tv_nsec + ts.tv_sec * 1000000000ll;
+}
+
+static int command(effect_handle_t handle, uint32_t cmd, uint32_t size, void *data) {
+    int reply = 0;
+    uint32_t replySize = sizeof(reply);
+    int status = (*handle)->command(handle, cmd, size, data, &replySize, &reply);
+
+    return status != 0 ? status : reply;
+}
+
+static int openSession(Session *session, int io, const char *effects, uint32_t rate,
+        audio_channel_mask_t mask) {
+    effect_config_t config;
+
+    memset(&config, 0, sizeof(config));
+    config.inputCfg.samplingRate = rate;
+    config.inputCfg.channels = mask;
+    config.inputCfg.format = AUDIO_FORMAT_PCM_16_BIT;
+    config.inputCfg.accessMode = EFFECT_BUFFER_ACCESS_READ;
+    config.inputCfg.mask = EFFECT_CONFIG_ALL;
+    config.outputCfg = config.inputCfg;
+    config.outputCfg.accessMode = EFFECT_BUFFER_ACCESS_WRITE;
+
+    memset(session, 0, sizeof(*session));
+    for (size_t i = 0; i < kNumEffects; i++) {
+        if (strchr(effects, kEffects[i].name) == NULL) {
+            continue;
+        }
+        effect_handle_t handle;
+        int status = AUDIO_EFFECT_LIBRARY_INFO_SYM.create_effect(kEffects[i].uuid,
+                io /* sessionId */, io, &handle);
+        if (status != 0) {
+            return status;
+        }
+        session->handles[session->numHandles++] = handle;
+        status = command(handle, EFFECT_CMD_INIT, 0, NULL);
+        if (status == 0) {
+            status = command(handle, EFFECT_CMD_SET_CONFIG, sizeof(config), &config);
+        }
+        if (status == 0 && (*handle)->process_reverse != NULL) {
+            status = command(handle, EFFECT_CMD_SET_CONFIG_REVERSE, sizeof(config), &config);
+            session->reverse = handle;
+        }
+        if (status == 0) {
+            status = command(handle, EFFECT_CMD_ENABLE, 0, NULL);
+        }
+        if (status != 0) {
+            return status;
+        }
+    }
+    return 0;
+}
+
+static void closeSession(Session *session) {
+    for (size_t i = 0; i < session->numHandles; i++) {
+        AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(session->handles[i]);
+    }
+    session->numHandles = 0;
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    int numSessions = 8;
+    uint32_t rate = 48000;
+    uint32_t channelCount = 1;
+    int bufferMs = 20;
+    int seconds = 10;
+    const char *effects = "gen";
+    int res;
+
+    while ((res = getopt(argc, argv, "hn:r:c:b:s:e:")) >= 0) {
+        switch (res) {
+            case 'n':
+                numSessions = atoi(optarg);
+                break;
+            case 'r':
+                rate = atoi(optarg);
+                break;
+            case 'c':
+                channelCount = atoi(optarg);
+                break;
+            case 'b':
+                bufferMs = atoi(optarg);
+                break;
+            case 's':
+                seconds = atoi(optarg);
+                break;
+            case 'e':
+                effects = optarg;
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+    if (numSessions <= 0 || rate < 8000 || (channelCount != 1 && channelCount != 2)
+            || bufferMs <= 0 || seconds <= 0) {
+        usage(me);
+    }
+
+    const audio_channel_mask_t mask = audio_channel_in_mask_from_count(channelCount);
+    const size_t frameCount = rate * bufferMs / 1000;
+    const size_t numBuffers = seconds * 1000 / bufferMs;
+    Session *sessions = new Session[numSessions];
+    int16_t *in = new int16_t[frameCount * channelCount];
+    int16_t *out = new int16_t[frameCount * channelCount];
+    int16_t *far = new int16_t[frameCount * channelCount];
+    int opened = 0;
+
+    for (; opened < numSessions; opened++) {
+        int status = openSession(&sessions[opened], opened + 1 /* io */, effects, rate, mask);
+        if (status != 0) {
+            fprintf(stderr, "session %d could not be opened: %d\n", opened, status);
+            closeSession(&sessions[opened]);
+            break;
+        }
+    }
+
+    // a tone in noise on the capture, and the same tone as the far end signal for the AEC
+    unsigned seed = 1;
+    for (size_t i = 0; i < frameCount * channelCount; i++) {
+        seed = seed * 1103515245 + 12345;
+        const double tone = 4000 * sin(2 * M_PI * 440 * (i / channelCount) / rate);
+        far[i] = (int16_t)tone;
+        in[i] = (int16_t)(tone / 4 + (int16_t)(seed >> 16) / 16);
+    }
+
+    for (size_t n = 0; n < numBuffers; n++) {
+        for (int s = 0; s < opened; s++) {
+            Session *session = &sessions[s];
+            audio_buffer_t inBuffer, outBuffer;
+            const int64_t start = getThreadCpuNs();
+
+            if (session->reverse != NULL) {
+                inBuffer.frameCount = frameCount;
+                inBuffer.s16 = far;
+                outBuffer.frameCount = frameCount;
+                outBuffer.s16 = NULL;
+                (*session->reverse)->process_reverse(session->reverse, &inBuffer, &outBuffer);
+            }
+            // as in an effect chain, each effect is called and the last one does the work
+            for (size_t i = 0; i < session->numHandles; i++) {
+                inBuffer.frameCount = frameCount;
+                inBuffer.s16 = in;
+                outBuffer.frameCount = frameCount;
+                outBuffer.s16 = out;
+                (*session->handles[i])->process(session->handles[i], &inBuffer, &outBuffer);
+            }
+            session->cpuNs += getThreadCpuNs() - start;
+        }
+    }
+
+    const double audioNs = (double)numBuffers * frameCount * 1e9 / rate;
+    int64_t totalNs = 0;
+    printf("%d of %d sessions, effects %s, %u Hz, %u channel(s), %d ms buffers\n",
+            opened, numSessions, effects, rate, channelCount, bufferMs);
+    printf("%8s %14s %10s\n", "session", "us/s of audio", "% of core");
+    for (int s = 0; s < opened; s++) {
+        printf("%8d %14.1f %10.2f\n", s, sessions[s].cpuNs / (audioNs / 1e6),
+                100.0 * sessions[s].cpuNs / audioNs);
+        totalNs += sessions[s].cpuNs;
+        closeSession(&sessions[s]);
+    }
+    if (opened > 0) {
+        printf("%8s %14.1f %10.2f\n", "mean", totalNs / opened / (audioNs / 1e6),
+                100.0 * totalNs / opened / audioNs);
+        printf("%8s %14.1f %10.2f\n", "total", totalNs / (audioNs / 1e6),
+                100.0 * totalNs / audioNs);
+    }
+
+    delete[] sessions;
+    delete[] in;
+    delete[] out;
+    delete[] far;
+    return opened == numSessions ? 0 : 1;
+}
@@ -21,3 +21,5 @@ LOCAL_C_INCLUDES := \
 
 
 include $(BUILD_SHARED_LIBRARY)
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
@@ -24,7 +24,8 @@
 #include <new>
 #include <time.h>
 #include <math.h>
-#include <audio_effects/effect_visualizer.h>
+#include <cutils/atomic.h>
+#include <media/EffectVisualizerApi.h>
 
 
 extern "C" {
@@ -61,6 +62,10 @@ enum visualizer_state_e {
 // maximum number of buffers for which we keep track of the measurements
 #define MEASUREMENT_WINDOW_MAX_SIZE_IN_BUFFERS 25 // note: buffer index is stored in uint8_t
 
+// float capture buffer size in samples: a power of two holding the largest spectrum window
+// and one hop of new samples
+#define FLOAT_CAPTURE_BUF_SIZE (2 * VISUALIZER_SPECTRUM_SIZE_MAX)
+
 
 struct BufferStats {
     bool mIsValid;
@@ -85,6 +90,26 @@ struct VisualizerContext {
     uint8_t mMeasurementWindowSizeInBuffers;
     uint8_t mMeasurementBufferIdx;
     BufferStats mPastMeasurements[MEASUREMENT_WINDOW_MAX_SIZE_IN_BUFFERS];
+    // for float capture and spectrum
+    uint32_t mFloatCaptureSize;
+    uint32_t mFloatCaptureIdx;
+    float mFloatCaptureBuf[FLOAT_CAPTURE_BUF_SIZE];
+    uint32_t mSpectrumSize;      // analysis window size, 0 when the spectrum is disabled
+    uint32_t mSpectrumOverlap;   // in percent of the window
+    uint32_t mSpectrumAveraging; // windows per published spectrum
+    uint32_t mSpectrumHop;       // new samples between two windows
+    uint32_t mSpectrumPending;   // samples captured since the last window
+    uint32_t mSpectrumWindows;   // windows accumulated in mSpectrumPower
+    int64_t mSpectrumCostNs;     // time spent on the windows accumulated
+    float mSpectrumScale;        // from the square root of the power to a sine amplitude
+    float *mSpectrumTables;      // one allocation for the five arrays below
+    float *mWindow;              // mSpectrumSize Hann window coefficients
+    float *mTwiddleCos;          // mSpectrumSize / 2 values of exp(-2 pi i k / mSpectrumSize)
+    float *mTwiddleSin;
+    float *mFftBuf;              // mSpectrumSize / 2 complex values, interleaved
+    float *mSpectrumPower;       // mSpectrumSize / 2 + 1 accumulated bin powers
+    uint16_t *mBitReverse;       // mSpectrumSize / 2 bit reversed indices
+    visualizer_spectrum_buffer_t mSpectrumBuffers[VISUALIZER_SPECTRUM_BUFFERS_MAX];
 };
 
 //
@@ -115,6 +140,155 @@ void Visualizer_reset(VisualizerContext *pContext)
     pContext->mBufferUpdateTime.tv_sec = 0;
     pContext->mLatency = 0;
     memset(pContext->mCaptureBuf, 0x80, CAPTURE_BUF_SIZE);
+    pContext->mFloatCaptureIdx = 0;
+    memset(pContext->mFloatCaptureBuf, 0, sizeof(pContext->mFloatCaptureBuf));
+    pContext->mSpectrumPending = 0;
+    pContext->mSpectrumWindows = 0;
+    pContext->mSpectrumCostNs = 0;
+    if (pContext->mSpectrumPower != NULL) {
+        memset(pContext->mSpectrumPower, 0, (pContext->mSpectrumSize / 2 + 1) * sizeof(float));
+    }
+}
+
+//----------------------------------------------------------------------------
+// Visualizer_setSpectrum()
+//----------------------------------------------------------------------------
+// Purpose: Configure the spectrum analysis and build the window and FFT tables.
+//
+// Inputs:
+//  pContext:   effect engine context
+//  size:       window size in samples, power of two, 0 to disable the analysis
+//  overlap:    overlap of consecutive windows in percent: 0, 50 or 75
+//  averaging:  number of windows averaged into one published spectrum
+//
+// Outputs:
+//  returned value: 0 or -EINVAL, -ENOMEM, the configuration is unchanged on error
+//
+//----------------------------------------------------------------------------
+
+int Visualizer_setSpectrum(VisualizerContext *pContext, uint32_t size, uint32_t overlap,
+        uint32_t averaging)
+{
+    if (size != 0 && (size < VISUALIZER_SPECTRUM_SIZE_MIN ||
+            size > VISUALIZER_SPECTRUM_SIZE_MAX || (size & (size - 1)) != 0)) {
+        return -EINVAL;
+    }
+    if (overlap != 0 && overlap != 50 && overlap != 75) {
+        return -EINVAL;
+    }
+    if (averaging == 0 || averaging > VISUALIZER_SPECTRUM_AVERAGING_MAX) {
+        return -EINVAL;
+    }
+
+    if (size != pContext->mSpectrumSize) {
+        float *tables = NULL;
+        uint16_t *bitReverse = NULL;
+        const uint32_t half = size / 2;
+        if (size != 0) {
+            // window, cos, sin, FFT buffer and power
+            tables = new (std::nothrow) float[size + half + half + size + half + 1];
+            bitReverse = new (std::nothrow) uint16_t[half];
+            if (tables == NULL || bitReverse == NULL) {
+                delete[] tables;
+                delete[] bitReverse;
+                return -ENOMEM;
+            }
+        }
+        delete[] pContext->mSpectrumTables;
+        delete[] pContext->mBitReverse;
+        pContext->mSpectrumTables = tables;
+        pContext->mBitReverse = bitReverse;
+        pContext->mSpectrumSize = size;
+        if (size == 0) {
+            pContext->mWindow = NULL;
+            pContext->mTwiddleCos = NULL;
+            pContext->mTwiddleSin = NULL;
+            pContext->mFftBuf = NULL;
+            pContext->mSpectrumPower = NULL;
+        } else {
+            pContext->mWindow = tables;
+            pContext->mTwiddleCos = pContext->mWindow + size;
+            pContext->mTwiddleSin = pContext->mTwiddleCos + half;
+            pContext->mFftBuf = pContext->mTwiddleSin + half;
+            pContext->mSpectrumPower = pContext->mFftBuf + size;
+
+            // periodic Hann window, its sum is size / 2
+            for (uint32_t n = 0; n < size; n++) {
+                pContext->mWindow[n] = 0.5f - 0.5f * cosf(2 * M_PI * n / size);
+            }
+            pContext->mSpectrumScale = 2.0f / (size / 2);
+            for (uint32_t k = 0; k < half; k++) {
+                pContext->mTwiddleCos[k] = cosf(2 * M_PI * k / size);
+                pContext->mTwiddleSin[k] = -sinf(2 * M_PI * k / size);
+            }
+            uint32_t bits = 0;
+            while ((1u << bits) < half) {
+                bits++;
+            }
+            for (uint32_t m = 0; m < half; m++) {
+                uint32_t r = 0;
+                for (uint32_t b = 0; b < bits; b++) {
+                    r |= ((m >> b) & 1) << (bits - 1 - b);
+                }
+                pContext->mBitReverse[m] = r;
+            }
+            memset(pContext->mSpectrumPower, 0, (half + 1) * sizeof(float));
+        }
+    }
+    pContext->mSpectrumOverlap = overlap;
+    pContext->mSpectrumAveraging = averaging;
+    pContext->mSpectrumHop = size - size * overlap / 100;
+    pContext->mSpectrumPending = 0;
+    pContext->mSpectrumWindows = 0;
+    pContext->mSpectrumCostNs = 0;
+    if (pContext->mSpectrumPower != NULL) {
+        memset(pContext->mSpectrumPower, 0, (size / 2 + 1) * sizeof(float));
+    }
+    ALOGV("Visualizer_setSpectrum size %" PRIu32 " overlap %" PRIu32 "%% averaging %" PRIu32,
+            size, overlap, averaging);
+    return 0;
+}
+
+//----------------------------------------------------------------------------
+// Visualizer_setSpectrumBuffer()
+//----------------------------------------------------------------------------
+// Purpose: Register or unregister a shared buffer receiving the spectra.
+//
+// Inputs:
+//  pContext:   effect engine context
+//  pBuffer:    buffer to register, or to unregister if its size is 0
+//
+// Outputs:
+//  returned value: 0 or -EINVAL, -ENOSPC when all buffer slots are in use
+//
+//----------------------------------------------------------------------------
+
+int Visualizer_setSpectrumBuffer(VisualizerContext *pContext,
+        const visualizer_spectrum_buffer_t *pBuffer)
+{
+    if (pBuffer->cblk == NULL) {
+        return -EINVAL;
+    }
+    for (uint32_t i = 0; i < VISUALIZER_SPECTRUM_BUFFERS_MAX; i++) {
+        if (pContext->mSpectrumBuffers[i].cblk == pBuffer->cblk) {
+            pContext->mSpectrumBuffers[i].cblk = NULL;
+            pContext->mSpectrumBuffers[i].size = 0;
+        }
+    }
+    if (pBuffer->size == 0) {
+        return 0;
+    }
+    if (pBuffer->size < sizeof(visualizer_spectrum_cblk_t)) {
+        return -EINVAL;
+    }
+    for (uint32_t i = 0; i < VISUALIZER_SPECTRUM_BUFFERS_MAX; i++) {
+        if (pContext->mSpectrumBuffers[i].cblk == NULL) {
+            memset(pBuffer->cblk, 0, sizeof(visualizer_spectrum_cblk_t));
+            pContext->mSpectrumBuffers[i] = *pBuffer;
+            return 0;
+        }
+    }
+    return -ENOSPC;
 }
 
 //----------------------------------------------------------------------------
@@ -141,7 +315,8 @@ int Visualizer_setConfig(VisualizerContext *pContext, effect_config_t *pConfig)
     if (pConfig->inputCfg.channels != AUDIO_CHANNEL_OUT_STEREO) return -EINVAL;
     if (pConfig->outputCfg.accessMode != EFFECT_BUFFER_ACCESS_WRITE &&
             pConfig->outputCfg.accessMode != EFFECT_BUFFER_ACCESS_ACCUMULATE) return -EINVAL;
-    if (pConfig->inputCfg.format != AUDIO_FORMAT_PCM_16_BIT) return -EINVAL;
+    if (pConfig->inputCfg.format != AUDIO_FORMAT_PCM_16_BIT &&
+            pConfig->inputCfg.format != AUDIO_FORMAT_PCM_FLOAT) return -EINVAL;
 
     pContext->mConfig = *pConfig;
 
@@ -205,6 +380,8 @@ int Visualizer_init(VisualizerContext *pContext)
     // visualization initialization
     pContext->mCaptureSize = VISUALIZER_CAPTURE_SIZE_MAX;
     pContext->mScalingMode = VISUALIZER_SCALING_MODE_NORMALIZED;
+    pContext->mFloatCaptureSize = 0;
+    Visualizer_setSpectrum(pContext, 0, 0, 1);
 
     // measurement initialization
     pContext->mChannelCount =
@@ -246,6 +423,11 @@ int VisualizerLib_Create(const effect_uuid_t *uuid,
 
     pContext->mItfe = &gVisualizerInterface;
     pContext->mState = VISUALIZER_STATE_UNINITIALIZED;
+    pContext->mSpectrumSize = 0;
+    pContext->mSpectrumTables = NULL;
+    pContext->mBitReverse = NULL;
+    pContext->mSpectrumPower = NULL;
+    memset(pContext->mSpectrumBuffers, 0, sizeof(pContext->mSpectrumBuffers));
 
     ret = Visualizer_init(pContext);
     if (ret < 0) {
@@ -272,6 +454,8 @@ int VisualizerLib_Release(effect_handle_t handle) {
         return -EINVAL;
     }
     pContext->mState = VISUALIZER_STATE_UNINITIALIZED;
+    delete[] pContext->mSpectrumTables;
+    delete[] pContext->mBitReverse;
     delete pContext;
 
     return 0;
@@ -304,6 +488,175 @@ static inline int16_t clamp16(int32_t sample)
     return sample;
 }
 
+static inline int16_t clamp16_from_float(float f)
+{
+    f *= 32768.0f;
+    if (f >= 32767.0f) {
+        return 32767;
+    }
+    if (f <= -32768.0f) {
+        return -32768;
+    }
+    return (int16_t)f;
+}
+
+// returns sample i of a buffer as 16 bit PCM, whichever the input format
+static inline int32_t Visualizer_sample16(const audio_buffer_t *buffer, size_t i, bool isFloat)
+{
+    return isFloat ? clamp16_from_float(buffer->f32[i]) : buffer->s16[i];
+}
+
+static int64_t Visualizer_threadCpuNs()
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Converts the accumulated bin powers to magnitudes and copies them to the shared buffers
+static void Visualizer_publishSpectrum(VisualizerContext *pContext)
+{
+    const int64_t startNs = Visualizer_threadCpuNs();
+    const uint32_t size = pContext->mSpectrumSize;
+    const uint32_t binCount = size / 2 + 1;
+    const float invWindows = 1.0f / pContext->mSpectrumWindows;
+    const float scale = pContext->mSpectrumScale;
+    float *bins = pContext->mSpectrumPower;
+
+    for (uint32_t k = 0; k < binCount; k++) {
+        bins[k] = sqrtf(bins[k] * invWindows) * scale;
+    }
+    // DC and half the sampling rate have no mirror bin
+    bins[0] *= 0.5f;
+    bins[binCount - 1] *= 0.5f;
+
+    const int64_t costNs = pContext->mSpectrumCostNs + Visualizer_threadCpuNs() - startNs;
+    for (uint32_t i = 0; i < VISUALIZER_SPECTRUM_BUFFERS_MAX; i++) {
+        visualizer_spectrum_cblk_t *cblk = pContext->mSpectrumBuffers[i].cblk;
+        if (cblk == NULL ||
+                pContext->mSpectrumBuffers[i].size < VISUALIZER_SPECTRUM_BUFFER_SIZE(size)) {
+            continue;
+        }
+        android_atomic_inc(&cblk->sequence);
+        android_memory_barrier();
+        cblk->binCount = binCount;
+        cblk->samplingRate = pContext->mConfig.inputCfg.samplingRate;
+        cblk->windowCount = pContext->mSpectrumWindows;
+        cblk->costNs = costNs;
+        memcpy(cblk->bins, bins, binCount * sizeof(float));
+        android_atomic_inc(&cblk->sequence);
+    }
+
+    memset(bins, 0, binCount * sizeof(float));
+    pContext->mSpectrumWindows = 0;
+    pContext->mSpectrumCostNs = 0;
+}
+
+// Accumulates the bin powers of the window ending with the last float sample captured.
+// The real FFT of the window is computed as a complex FFT of half its size.
+static void Visualizer_analyzeWindow(VisualizerContext *pContext)
+{
+    const int64_t startNs = Visualizer_threadCpuNs();
+    const uint32_t size = pContext->mSpectrumSize;
+    const uint32_t half = size / 2;
+    const float *window = pContext->mWindow;
+    const float *cosTable = pContext->mTwiddleCos;
+    const float *sinTable = pContext->mTwiddleSin;
+    const float *capture = pContext->mFloatCaptureBuf;
+    const uint32_t start = pContext->mFloatCaptureIdx - size;
+    float *z = pContext->mFftBuf;
+
+    // even samples go to the real parts and odd ones to the imaginary parts, in bit reversed
+    // order for the butterflies below
+    for (uint32_t m = 0; m < half; m++) {
+        float *dst = z + 2 * pContext->mBitReverse[m];
+        dst[0] = capture[(start + 2 * m) & (FLOAT_CAPTURE_BUF_SIZE - 1)] * window[2 * m];
+        dst[1] = capture[(start + 2 * m + 1) & (FLOAT_CAPTURE_BUF_SIZE - 1)] * window[2 * m + 1];
+    }
+
+    // radix 2 stages, the twiddle factor of span len is exp(-2 pi i j / len)
+    for (uint32_t len = 2; len <= half; len <<= 1) {
+        const uint32_t step = size / len;
+        for (uint32_t i = 0; i < half; i += len) {
+            for (uint32_t j = 0; j < len / 2; j++) {
+                const float wr = cosTable[j * step];
+                const float wi = sinTable[j * step];
+                float *a = z + 2 * (i + j);
+                float *b = a + len;
+                const float tr = b[0] * wr - b[1] * wi;
+                const float ti = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - tr;
+                b[1] = a[1] - ti;
+                a[0] += tr;
+                a[1] += ti;
+            }
+        }
+    }
+
+    // split the half size transform into the spectrum of the real window
+    float *power = pContext->mSpectrumPower;
+    power[0] += (z[0] + z[1]) * (z[0] + z[1]);
+    power[half] += (z[0] - z[1]) * (z[0] - z[1]);
+    for (uint32_t k = 1; k < half; k++) {
+        const float *zk = z + 2 * k;
+        const float *zc = z + 2 * (half - k);
+        const float er = 0.5f * (zk[0] + zc[0]);
+        const float ei = 0.5f * (zk[1] - zc[1]);
+        const float orr = 0.5f * (zk[1] + zc[1]);
+        const float oi = -0.5f * (zk[0] - zc[0]);
+        const float xr = er + cosTable[k] * orr - sinTable[k] * oi;
+        const float xi = ei + cosTable[k] * oi + sinTable[k] * orr;
+        power[k] += xr * xr + xi * xi;
+    }
+
+    pContext->mSpectrumCostNs += Visualizer_threadCpuNs() - startNs;
+    if (++pContext->mSpectrumWindows >= pContext->mSpectrumAveraging) {
+        Visualizer_publishSpectrum(pContext);
+    }
+}
+
+// Appends the mono mix of a buffer to the float capture, analyzing a window each time
+// mSpectrumHop new samples have been captured
+static void Visualizer_captureFloat(VisualizerContext *pContext, const audio_buffer_t *inBuffer,
+        bool isFloat)
+{
+    float *buf = pContext->mFloatCaptureBuf;
+    uint32_t captIdx = pContext->mFloatCaptureIdx;
+    size_t inIdx = 0;
+
+    while (inIdx < inBuffer->frameCount) {
+        size_t end = inBuffer->frameCount;
+        if (pContext->mSpectrumSize != 0 &&
+                end - inIdx > pContext->mSpectrumHop - pContext->mSpectrumPending) {
+            end = inIdx + pContext->mSpectrumHop - pContext->mSpectrumPending;
+        }
+        const size_t count = end - inIdx;
+        if (isFloat) {
+            for (; inIdx < end; inIdx++) {
+                buf[captIdx] = 0.5f * (inBuffer->f32[2 * inIdx] + inBuffer->f32[2 * inIdx + 1]);
+                captIdx = (captIdx + 1) & (FLOAT_CAPTURE_BUF_SIZE - 1);
+            }
+        } else {
+            for (; inIdx < end; inIdx++) {
+                buf[captIdx] = (inBuffer->s16[2 * inIdx] + inBuffer->s16[2 * inIdx + 1]) *
+                        (0.5f / 32768.0f);
+                captIdx = (captIdx + 1) & (FLOAT_CAPTURE_BUF_SIZE - 1);
+            }
+        }
+        pContext->mFloatCaptureIdx = captIdx;
+
+        if (pContext->mSpectrumSize != 0) {
+            pContext->mSpectrumPending += count;
+            if (pContext->mSpectrumPending >= pContext->mSpectrumHop) {
+                Visualizer_analyzeWindow(pContext);
+                pContext->mSpectrumPending = 0;
+            }
+        }
+    }
+}
+
 int Visualizer_process(
         effect_handle_t self,audio_buffer_t *inBuffer, audio_buffer_t *outBuffer)
 {
@@ -320,6 +673,8 @@ int Visualizer_process(
         return -EINVAL;
     }
 
+    const bool isFloat = pContext->mConfig.inputCfg.format == AUDIO_FORMAT_PCM_FLOAT;
+
     // perform measurements if needed
     if (pContext->mMeasurementMode & MEASUREMENT_MODE_PEAK_RMS) {
         // find the peak and RMS squared for the new buffer
@@ -327,12 +682,13 @@ int Visualizer_process(
         int16_t maxSample = 0;
         float rmsSqAcc = 0;
         for (inIdx = 0 ; inIdx < inBuffer->frameCount * pContext->mChannelCount ; inIdx++) {
-            if (inBuffer->s16[inIdx] > maxSample) {
-                maxSample = inBuffer->s16[inIdx];
-            } else if (-inBuffer->s16[inIdx] > maxSample) {
-                maxSample = -inBuffer->s16[inIdx];
+            const int32_t smp = Visualizer_sample16(inBuffer, inIdx, isFloat);
+            if (smp > maxSample) {
+                maxSample = smp;
+            } else if (-smp > maxSample) {
+                maxSample = -smp;
             }
-            rmsSqAcc += (inBuffer->s16[inIdx] * inBuffer->s16[inIdx]);
+            rmsSqAcc += (smp * smp);
         }
         // store the measurement
         pContext->mPastMeasurements[pContext->mMeasurementBufferIdx].mPeakU16 = (uint16_t)maxSample;
@@ -344,7 +700,7 @@ int Visualizer_process(
         }
     }
 
-    // all code below assumes stereo 16 bit PCM output and input
+    // all code below assumes stereo 16 bit or float PCM output and input
     int32_t shift;
 
     if (pContext->mScalingMode == VISUALIZER_SCALING_MODE_NORMALIZED) {
@@ -353,7 +709,7 @@ int Visualizer_process(
         shift = 32;
         int len = inBuffer->frameCount * 2;
         for (int i = 0; i < len; i++) {
-            int32_t smp = inBuffer->s16[i];
+            int32_t smp = Visualizer_sample16(inBuffer, i, isFloat);
             if (smp < 0) smp = -smp - 1; // take care to keep the max negative in range
             int32_t clz = __builtin_clz(smp);
             if (shift > clz) shift = clz;
@@ -382,7 +738,8 @@ int Visualizer_process(
             // wrap around
             captIdx = 0;
         }
-        int32_t smp = inBuffer->s16[2 * inIdx] + inBuffer->s16[2 * inIdx + 1];
+        int32_t smp = Visualizer_sample16(inBuffer, 2 * inIdx, isFloat) +
+                Visualizer_sample16(inBuffer, 2 * inIdx + 1, isFloat);
         smp = smp >> shift;
         buf[captIdx] = ((uint8_t)smp)^0x80;
     }
@@ -390,6 +747,9 @@ int Visualizer_process(
     // XXX the following two should really be atomic, though it probably doesn't
     // matter much for visualization purposes
     pContext->mCaptureIdx = captIdx;
+    if (pContext->mFloatCaptureSize != 0 || pContext->mSpectrumSize != 0) {
+        Visualizer_captureFloat(pContext, inBuffer, isFloat);
+    }
     // update last buffer update time stamp
     if (clock_gettime(CLOCK_MONOTONIC, &pContext->mBufferUpdateTime) < 0) {
         pContext->mBufferUpdateTime.tv_sec = 0;
@@ -397,11 +757,18 @@ int Visualizer_process(
 
     if (inBuffer->raw != outBuffer->raw) {
         if (pContext->mConfig.outputCfg.accessMode == EFFECT_BUFFER_ACCESS_ACCUMULATE) {
-            for (size_t i = 0; i < outBuffer->frameCount*2; i++) {
-                outBuffer->s16[i] = clamp16(outBuffer->s16[i] + inBuffer->s16[i]);
+            if (isFloat) {
+                for (size_t i = 0; i < outBuffer->frameCount*2; i++) {
+                    outBuffer->f32[i] += inBuffer->f32[i];
+                }
+            } else {
+                for (size_t i = 0; i < outBuffer->frameCount*2; i++) {
+                    outBuffer->s16[i] = clamp16(outBuffer->s16[i] + inBuffer->s16[i]);
+                }
             }
         } else {
-            memcpy(outBuffer->raw, inBuffer->raw, outBuffer->frameCount * 2 * sizeof(int16_t));
+            memcpy(outBuffer->raw, inBuffer->raw, outBuffer->frameCount * 2 *
+                    (isFloat ? sizeof(float) : sizeof(int16_t)));
         }
     }
     if (pContext->mState != VISUALIZER_STATE_ACTIVE) {
@@ -503,6 +870,26 @@ int Visualizer_command(effect_handle_t self, uint32_t cmdCode, uint32_t cmdSize,
             p->vsize = sizeof(uint32_t);
             *replySize += sizeof(uint32_t);
             break;
+        case VISUALIZER_PARAM_FLOAT_CAPTURE_SIZE:
+            *((uint32_t *)p->data + 1) = pContext->mFloatCaptureSize;
+            p->vsize = sizeof(uint32_t);
+            *replySize += sizeof(uint32_t);
+            break;
+        case VISUALIZER_PARAM_SPECTRUM_SIZE:
+            *((uint32_t *)p->data + 1) = pContext->mSpectrumSize;
+            p->vsize = sizeof(uint32_t);
+            *replySize += sizeof(uint32_t);
+            break;
+        case VISUALIZER_PARAM_SPECTRUM_OVERLAP:
+            *((uint32_t *)p->data + 1) = pContext->mSpectrumOverlap;
+            p->vsize = sizeof(uint32_t);
+            *replySize += sizeof(uint32_t);
+            break;
+        case VISUALIZER_PARAM_SPECTRUM_AVERAGING:
+            *((uint32_t *)p->data + 1) = pContext->mSpectrumAveraging;
+            p->vsize = sizeof(uint32_t);
+            *replySize += sizeof(uint32_t);
+            break;
         default:
             p->status = -EINVAL;
         }
@@ -536,6 +923,28 @@ int Visualizer_command(effect_handle_t self, uint32_t cmdCode, uint32_t cmdSize,
             pContext->mMeasurementMode = *((uint32_t *)p->data + 1);
             ALOGV("set mMeasurementMode = %" PRIu32, pContext->mMeasurementMode);
             break;
+        case VISUALIZER_PARAM_FLOAT_CAPTURE_SIZE: {
+            const uint32_t size = *((uint32_t *)p->data + 1);
+            if (size != 0 && (size < VISUALIZER_FLOAT_CAPTURE_SIZE_MIN ||
+                    size > VISUALIZER_FLOAT_CAPTURE_SIZE_MAX || (size & (size - 1)) != 0)) {
+                *(int32_t *)pReplyData = -EINVAL;
+                break;
+            }
+            pContext->mFloatCaptureSize = size;
+            ALOGV("set mFloatCaptureSize = %" PRIu32, pContext->mFloatCaptureSize);
+            } break;
+        case VISUALIZER_PARAM_SPECTRUM_SIZE:
+            *(int32_t *)pReplyData = Visualizer_setSpectrum(pContext, *((uint32_t *)p->data + 1),
+                    pContext->mSpectrumOverlap, pContext->mSpectrumAveraging);
+            break;
+        case VISUALIZER_PARAM_SPECTRUM_OVERLAP:
+            *(int32_t *)pReplyData = Visualizer_setSpectrum(pContext, pContext->mSpectrumSize,
+                    *((uint32_t *)p->data + 1), pContext->mSpectrumAveraging);
+            break;
+        case VISUALIZER_PARAM_SPECTRUM_AVERAGING:
+            *(int32_t *)pReplyData = Visualizer_setSpectrum(pContext, pContext->mSpectrumSize,
+                    pContext->mSpectrumOverlap, *((uint32_t *)p->data + 1));
+            break;
         default:
             *(int32_t *)pReplyData = -EINVAL;
         }
@@ -598,6 +1007,51 @@ int Visualizer_command(effect_handle_t self, uint32_t cmdCode, uint32_t cmdSize,
 
         } break;
 
+    case VISUALIZER_CMD_CAPTURE_FLOAT: {
+        uint32_t captureSize = pContext->mFloatCaptureSize;
+        if (captureSize == 0 || pReplyData == NULL ||
+                *replySize != captureSize * sizeof(float)) {
+            ALOGV("VISUALIZER_CMD_CAPTURE_FLOAT() error *replySize %" PRIu32
+                    " captureSize %" PRIu32, *replySize, captureSize);
+            return -EINVAL;
+        }
+        const uint32_t deltaMs = Visualizer_getDeltaTimeMsFromUpdatedTime(pContext);
+        // return silence when disabled or when the audio framework stopped playing audio
+        if (pContext->mState != VISUALIZER_STATE_ACTIVE ||
+                pContext->mBufferUpdateTime.tv_sec == 0 || deltaMs > MAX_STALL_TIME_MS) {
+            memset(pReplyData, 0, captureSize * sizeof(float));
+            break;
+        }
+        int32_t latencyMs = pContext->mLatency;
+        latencyMs -= deltaMs;
+        if (latencyMs < 0) {
+            latencyMs = 0;
+        }
+        const uint32_t deltaSmpl = pContext->mConfig.inputCfg.samplingRate * latencyMs / 1000;
+        uint32_t capturePoint = (pContext->mFloatCaptureIdx - captureSize -
+                (deltaSmpl < VISUALIZER_FLOAT_CAPTURE_SIZE_MAX ?
+                        deltaSmpl : VISUALIZER_FLOAT_CAPTURE_SIZE_MAX)) &
+                (FLOAT_CAPTURE_BUF_SIZE - 1);
+        float *dst = (float *)pReplyData;
+        if (capturePoint + captureSize > FLOAT_CAPTURE_BUF_SIZE) {
+            const uint32_t size = FLOAT_CAPTURE_BUF_SIZE - capturePoint;
+            memcpy(dst, pContext->mFloatCaptureBuf + capturePoint, size * sizeof(float));
+            dst += size;
+            captureSize -= size;
+            capturePoint = 0;
+        }
+        memcpy(dst, pContext->mFloatCaptureBuf + capturePoint, captureSize * sizeof(float));
+        } break;
+
+    case VISUALIZER_CMD_SET_SPECTRUM_BUFFER:
+        if (pCmdData == NULL || cmdSize != sizeof(visualizer_spectrum_buffer_t) ||
+                pReplyData == NULL || *replySize != sizeof(int)) {
+            return -EINVAL;
+        }
+        *(int *)pReplyData = Visualizer_setSpectrumBuffer(pContext,
+                (visualizer_spectrum_buffer_t *)pCmdData);
+        break;
+
     case VISUALIZER_CMD_MEASURE: {
         uint16_t peakU16 = 0;
         float sumRmsSquared = 0.0f;
@@ -0,0 +1,21 @@
+LOCAL_PATH:= $(call my-dir)
+
+# Visualizer spectrum benchmark and accuracy check
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	visualizerbench.cpp \
+	../EffectVisualizer.cpp
+
+LOCAL_SHARED_LIBRARIES := \
+	libcutils \
+	liblog
+
+LOCAL_C_INCLUDES := \
+	$(call include-path-for, audio-effects)
+
+LOCAL_MODULE_TAGS := optional
+
+LOCAL_MODULE:= visualizerbench
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,259 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Plays a tone through the visualizer effect with the spectrum analysis enabled, checks the
+ * level and position of the tone in the published spectra and reports what the analysis costs,
+ * per published spectrum and per second of audio, next to the cost of the effect without it.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <hardware/audio_effect.h>
+#include <media/EffectVisualizerApi.h>
+#include <system/audio.h>
+
+extern audio_effect_library_t AUDIO_EFFECT_LIBRARY_INFO_SYM;
+
+static const effect_uuid_t kVisualizerUuid =
+        { 0xd069d9e0, 0x8329, 0x11df, 0x9168, { 0x00, 0x02, 0xa5, 0xd5, 0xc5, 0x1b } };
+
+static void usage(const char *me) {
+    fprintf(stderr, "usage: %s [-w <size>] [-o <overlap>] [-a <averaging>] [-r <rate>]"
+            " [-b <ms>] [-s <seconds>] [-f]\n", me);
+    fprintf(stderr, "       -h help\n");
+    fprintf(stderr, "       -w spectrum window size, a power of 2 (default 4096)\n");
+    fprintf(stderr, "       -o window overlap in percent, 0 50 or 75 (default 50)\n");
+    fprintf(stderr, "       -a windows averaged per spectrum (default 4)\n");
+    fprintf(stderr, "       -r sample rate (default 48000)\n");
+    fprintf(stderr, "       -b milliseconds per process call (default 20)\n");
+    fprintf(stderr, "       -s seconds of audio (default 20)\n");
+    fprintf(stderr, "       -f float input instead of 16 bit\n");
+
+    exit(1);
+}
+
+static int64_t getThreadCpuNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+
+    return (int64_t)ts.tv_nsec + ts.tv_sec * 1000000000ll;
+}
+
+static int command(effect_handle_t handle, uint32_t cmd, uint32_t size, void *data) {
+    int reply = 0;
+    uint32_t replySize = sizeof(reply);
+    int status = (*handle)->command(handle, cmd, size, data, &replySize, &reply);
+
+    return status != 0 ? status : reply;
+}
+
+static int setParam(effect_handle_t handle, uint32_t param, uint32_t value) {
+    uint32_t buf32[sizeof(effect_param_t) / sizeof(uint32_t) + 2];
+    effect_param_t *p = (effect_param_t *)buf32;
+
+    p->psize = sizeof(uint32_t);
+    p->vsize = sizeof(uint32_t);
+    *(uint32_t *)p->data = param;
+    *((uint32_t *)p->data + 1) = value;
+    return command(handle, EFFECT_CMD_SET_PARAM, sizeof(buf32), p);
+}
+
+static effect_handle_t openVisualizer(uint32_t rate, bool isFloat) {
+    effect_handle_t handle;
+    effect_config_t config;
+
+    if (AUDIO_EFFECT_LIBRARY_INFO_SYM.create_effect(&kVisualizerUuid, 0, 0, &handle) != 0) {
+        return NULL;
+    }
+    memset(&config, 0, sizeof(config));
+    config.inputCfg.samplingRate = rate;
+    config.inputCfg.channels = AUDIO_CHANNEL_OUT_STEREO;
+    config.inputCfg.format = isFloat ? AUDIO_FORMAT_PCM_FLOAT : AUDIO_FORMAT_PCM_16_BIT;
+    config.inputCfg.accessMode = EFFECT_BUFFER_ACCESS_READ;
+    config.inputCfg.mask = EFFECT_CONFIG_ALL;
+    config.outputCfg = config.inputCfg;
+    config.outputCfg.accessMode = EFFECT_BUFFER_ACCESS_WRITE;
+    if (command(handle, EFFECT_CMD_SET_CONFIG, sizeof(config), &config) != 0 ||
+            command(handle, EFFECT_CMD_ENABLE, 0, NULL) != 0) {
+        AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+// CPU time spent in process() for the whole signal
+static int64_t run(effect_handle_t handle, void *in, void *out, size_t frameCount,
+        size_t numBuffers, size_t frameSize) {
+    int64_t cpuNs = 0;
+    for (size_t n = 0; n < numBuffers; n++) {
+        audio_buffer_t inBuffer, outBuffer;
+        inBuffer.frameCount = frameCount;
+        inBuffer.raw = (uint8_t *)in + n * frameCount * frameSize;
+        outBuffer.frameCount = frameCount;
+        outBuffer.raw = out;
+        const int64_t start = getThreadCpuNs();
+        (*handle)->process(handle, &inBuffer, &outBuffer);
+        cpuNs += getThreadCpuNs() - start;
+    }
+    return cpuNs;
+}
+
+int main(int argc, char **argv) {
+    const char *me = argv[0];
+    uint32_t windowSize = 4096;
+    uint32_t overlap = 50;
+    uint32_t averaging = 4;
+    uint32_t rate = 48000;
+    int bufferMs = 20;
+    int seconds = 20;
+    bool isFloat = false;
+    int res;
+
+    while ((res = getopt(argc, argv, "hw:o:a:r:b:s:f")) >= 0) {
+        switch (res) {
+            case 'w':
+                windowSize = atoi(optarg);
+                break;
+            case 'o':
+                overlap = atoi(optarg);
+                break;
+            case 'a':
+                averaging = atoi(optarg);
+                break;
+            case 'r':
+                rate = atoi(optarg);
+                break;
+            case 'b':
+                bufferMs = atoi(optarg);
+                break;
+            case 's':
+                seconds = atoi(optarg);
+                break;
+            case 'f':
+                isFloat = true;
+                break;
+            case '?':
+            case 'h':
+            default:
+                usage(me);
+        }
+    }
+    if (rate < 8000 || bufferMs <= 0 || seconds <= 0) {
+        usage(me);
+    }
+
+    const size_t frameCount = rate * bufferMs / 1000;
+    const size_t numBuffers = seconds * 1000 / bufferMs;
+    const size_t frameSize = 2 * (isFloat ? sizeof(float) : sizeof(int16_t));
+    uint8_t *in = new uint8_t[numBuffers * frameCount * frameSize];
+    uint8_t *out = new uint8_t[frameCount * frameSize];
+
+    // a -6 dBFS tone at the center of a bin, in noise at about -60 dBFS
+    const uint32_t toneBin = windowSize / 16;
+    const double toneHz = (double)toneBin * rate / windowSize;
+    unsigned seed = 1;
+    for (size_t i = 0; i < numBuffers * frameCount; i++) {
+        seed = seed * 1103515245 + 12345;
+        const double smp = 0.5 * sin(2 * M_PI * toneHz * i / rate) +
+                ((int16_t)(seed >> 16) / 32768.0) / 1000;
+        for (int c = 0; c < 2; c++) {
+            if (isFloat) {
+                ((float *)in)[2 * i + c] = smp;
+            } else {
+                ((int16_t *)in)[2 * i + c] = (int16_t)(smp * 32767);
+            }
+        }
+    }
+
+    effect_handle_t handle = openVisualizer(rate, isFloat);
+    if (handle == NULL) {
+        fprintf(stderr, "could not open the visualizer\n");
+        return 1;
+    }
+    const int64_t plainNs = run(handle, in, out, frameCount, numBuffers, frameSize);
+
+    const uint32_t bufferSize = VISUALIZER_SPECTRUM_BUFFER_SIZE(windowSize);
+    visualizer_spectrum_cblk_t *cblk = (visualizer_spectrum_cblk_t *)malloc(bufferSize);
+    visualizer_spectrum_buffer_t buffer = { cblk, bufferSize };
+    if (setParam(handle, VISUALIZER_PARAM_SPECTRUM_SIZE, windowSize) != 0 ||
+            setParam(handle, VISUALIZER_PARAM_SPECTRUM_OVERLAP, overlap) != 0 ||
+            setParam(handle, VISUALIZER_PARAM_SPECTRUM_AVERAGING, averaging) != 0 ||
+            command(handle, VISUALIZER_CMD_SET_SPECTRUM_BUFFER, sizeof(buffer), &buffer) != 0) {
+        fprintf(stderr, "invalid spectrum configuration\n");
+        usage(me);
+    }
+
+    // feed one buffer at a time and collect each published spectrum
+    int64_t spectrumNs = 0;
+    int64_t publishedCostNs = 0;
+    int32_t sequence = 0;
+    uint32_t published = 0;
+    double toneError = 0;
+    uint32_t wrongPeaks = 0;
+    for (size_t n = 0; n < numBuffers; n++) {
+        spectrumNs += run(handle, in + n * frameCount * frameSize, out, frameCount, 1, frameSize);
+        if (cblk->sequence == sequence) {
+            continue;
+        }
+        sequence = cblk->sequence;
+        publishedCostNs += cblk->costNs;
+        // the first spectra include the silence before the tone started
+        if (++published <= (100 * averaging + 99) / (100 - overlap)) {
+            continue;
+        }
+        uint32_t peak = 0;
+        for (uint32_t k = 1; k < cblk->binCount; k++) {
+            if (cblk->bins[k] > cblk->bins[peak]) {
+                peak = k;
+            }
+        }
+        if (peak != toneBin) {
+            wrongPeaks++;
+        }
+        const double error = fabs(20 * log10(cblk->bins[toneBin] / 0.5));
+        if (error > toneError) {
+            toneError = error;
+        }
+    }
+
+    const double audioNs = (double)numBuffers * frameCount * 1e9 / rate;
+    printf("window %u overlap %u%% averaging %u, %u Hz %s, %d ms buffers\n",
+            windowSize, overlap, averaging, rate, isFloat ? "float" : "16 bit", bufferMs);
+    printf("%-24s %14s %10s\n", "", "us/s of audio", "% of core");
+    printf("%-24s %14.1f %10.3f\n", "capture only", plainNs / (audioNs / 1e6),
+            100.0 * plainNs / audioNs);
+    printf("%-24s %14.1f %10.3f\n", "capture and spectrum", spectrumNs / (audioNs / 1e6),
+            100.0 * spectrumNs / audioNs);
+    if (published > 0) {
+        printf("%u spectra published, %.1f us each as reported by the effect\n",
+                published, publishedCostNs / 1e3 / published);
+        printf("tone in bin %u: level error %.3f dB, %u spectra with another peak\n",
+                toneBin, toneError, wrongPeaks);
+    }
+
+    AUDIO_EFFECT_LIBRARY_INFO_SYM.release_effect(handle);
+    free(cblk);
+    delete[] in;
+    delete[] out;
+    return published > 0 && wrongPeaks == 0 && toneError < 0.1 ? 0 : 1;
+}
@@ -49,6 +49,7 @@ LOCAL_SRC_FILES:= \
     IAudioPolicyServiceClient.cpp \
     MediaScanner.cpp \
     MediaScannerClient.cpp \
+    MediaScanJournal.cpp \
     CharacterEncodingDetector.cpp \
     IMediaDeathNotifier.cpp \
     MediaProfiles.cpp \
@@ -59,6 +60,7 @@ LOCAL_SRC_FILES:= \
     MemoryLeakTrackUtil.cpp \
     SoundPool.cpp \
     SoundPoolThread.cpp \
+    SoundPoolMixer.cpp \
     StringArray.cpp
 
 LOCAL_SRC_FILES += ../libnbaio/roundup.c
@@ -98,3 +100,5 @@ LOCAL_MODULE := libinstantssq
 LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_STATIC_LIBRARY)
+
+include $(call all-makefiles-under,$(LOCAL_PATH))
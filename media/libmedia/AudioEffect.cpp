@@ -260,6 +260,14 @@ status_t AudioEffect::command(uint32_t cmdCode,
     return status;
 }
 
+sp<IMemory> AudioEffect::getDataMemory(uint32_t size)
+{
+    if (mStatus != NO_ERROR) {
+        return 0;
+    }
+    return mIEffect->getDataMemory(size);
+}
+
 
 status_t AudioEffect::setParameter(effect_param_t *param)
 {
@@ -21,6 +21,8 @@
 #include <CharacterEncodingDetector.h>
 #include "CharacterEncodingDetectorTables.h"
 
+#include <string.h>
+
 #include "utils/Vector.h"
 #include "StringArray.h"
 
@@ -30,7 +32,8 @@
 
 namespace android {
 
-CharacterEncodingDetector::CharacterEncodingDetector() {
+CharacterEncodingDetector::CharacterEncodingDetector()
+    : mNumDetections(0) {
 
     UErrorCode status = U_ZERO_ERROR;
     mUtf8Conv = ucnv_open("UTF-8", &status);
@@ -63,15 +66,179 @@ status_t CharacterEncodingDetector::getTag(int index, const char **name, const c
     return OK;
 }
 
+// Byte classes for the single pass pre-classification of tag values below.
+enum {
+    kAscii,     // printable ASCII
+    kCtl,       // ASCII control character or DEL
+    kTrail,     // UTF-8 continuation byte
+    kLead2,     // lead byte of a 2 byte UTF-8 sequence
+    kLead3,     // lead byte of a 3 byte UTF-8 sequence
+    kLead4,     // lead byte of a 4 byte UTF-8 sequence
+    kBad,       // never valid in UTF-8
+};
+
+static const uint8_t kByteClass[256] = {
+    kCtl, kCtl, kCtl, kCtl, kCtl, kCtl, kCtl, kCtl,  // 0x00
+    kCtl, kCtl, kCtl, kCtl, kCtl, kCtl, kCtl, kCtl,  // 0x08
+    kCtl, kCtl, kCtl, kCtl, kCtl, kCtl, kCtl, kCtl,  // 0x10
+    kCtl, kCtl, kCtl, kCtl, kCtl, kCtl, kCtl, kCtl,  // 0x18
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii,  // 0x20
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii,  // 0x28
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii,  // 0x30
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii,  // 0x38
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii,  // 0x40
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii,  // 0x48
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii,  // 0x50
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii,  // 0x58
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii,  // 0x60
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii,  // 0x68
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii,  // 0x70
+    kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kAscii, kCtl,  // 0x78
+    kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail,  // 0x80
+    kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail,  // 0x88
+    kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail,  // 0x90
+    kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail,  // 0x98
+    kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail,  // 0xa0
+    kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail,  // 0xa8
+    kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail,  // 0xb0
+    kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail, kTrail,  // 0xb8
+    kBad, kBad, kLead2, kLead2, kLead2, kLead2, kLead2, kLead2,  // 0xc0
+    kLead2, kLead2, kLead2, kLead2, kLead2, kLead2, kLead2, kLead2,  // 0xc8
+    kLead2, kLead2, kLead2, kLead2, kLead2, kLead2, kLead2, kLead2,  // 0xd0
+    kLead2, kLead2, kLead2, kLead2, kLead2, kLead2, kLead2, kLead2,  // 0xd8
+    kLead3, kLead3, kLead3, kLead3, kLead3, kLead3, kLead3, kLead3,  // 0xe0
+    kLead3, kLead3, kLead3, kLead3, kLead3, kLead3, kLead3, kLead3,  // 0xe8
+    kLead4, kLead4, kLead4, kLead4, kLead4, kBad, kBad, kBad,  // 0xf0
+    kBad, kBad, kBad, kBad, kBad, kBad, kBad, kBad,  // 0xf8
+};
+
+// True if none of the 8 bytes in 'w' has the top bit set, is below 0x20 or is
+// 0x7f. The subtraction only borrows across bytes when some byte is below
+// 0x20, in which case the answer is false regardless.
+static inline bool isPrintableAsciiWord(uint64_t w) {
+    const uint64_t kOnes = 0x0101010101010101ull;
+    const uint64_t kHighBits = 0x8080808080808080ull;
+    uint64_t notDel = w ^ (0x7f * kOnes);
+    uint64_t hasDel = (notDel - kOnes) & ~notDel;
+    return ((w | (w - 0x20 * kOnes) | hasDel) & kHighBits) == 0;
+}
+
 static bool isPrintableAscii(const char *value, size_t len) {
-    for (size_t i = 0; i < len; i++) {
-        if ((value[i] & 0x80) || value[i] < 0x20 || value[i] == 0x7f) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, value + i, sizeof(w));
+        if (!isPrintableAsciiWord(w)) {
+            return false;
+        }
+    }
+    for (; i < len; i++) {
+        if (kByteClass[(uint8_t)value[i]] != kAscii) {
             return false;
         }
     }
     return true;
 }
 
+// How much a character counts against an encoding that decodes to it, see
+// getPreferred(). 0 means the character is unremarkable.
+static int demeritFor(UChar32 c) {
+    if (c < 0x20 || (c >= 0x7f && c <= 0x009f)) {
+        ALOGV("control character %x", c);
+        return 100;
+    } else if ((c == 0xa0)                      // no-break space
+            || (c >= 0xa2 && c <= 0xbe)         // symbols, superscripts
+            || (c == 0xd7) || (c == 0xf7)       // multiplication and division signs
+            || (c >= 0x2000 && c <= 0x209f)) {  // punctuation, superscripts
+        ALOGV("unlikely character %x", c);
+        return 10;
+    } else if (c >= 0xe000 && c <= 0xf8ff) {
+        ALOGV("private use character %x", c);
+        return 30;
+    } else if (c >= 0x2190 && c <= 0x2bff) {
+        // this range comprises various symbol ranges that are unlikely to appear in
+        // music file metadata.
+        ALOGV("symbol %x", c);
+        return 10;
+    } else if (c == 0xfffd) {
+        ALOGV("replacement character");
+        return 50;
+    } else if (c >= 0xfff0 && c <= 0xfffc) {
+        ALOGV("unicode special %x", c);
+        return 50;
+    }
+    return 0;
+}
+
+/*
+ * Returns true if 'value' is well formed UTF-8 with enough multibyte characters
+ * that ICU's UTF-8 recognizer reports full confidence, and none of the decoded
+ * characters would be demerited by getPreferred(). For such input ICU followed
+ * by getPreferred() always settles on UTF-8, so detection can be skipped.
+ */
+static bool isUnambiguousUtf8(const char *value, size_t len) {
+    // ICU's UTF-8 recognizer reports 100 for more than 3 valid sequences.
+    const size_t kMinMultiByteChars = 4;
+
+    const uint8_t *s = (const uint8_t *)value;
+    size_t numMultiByte = 0;
+    size_t i = 0;
+    while (i < len) {
+        if (i + 8 <= len) {
+            uint64_t w;
+            memcpy(&w, s + i, sizeof(w));
+            if (isPrintableAsciiWord(w)) {
+                i += 8;
+                continue;
+            }
+        }
+
+        UChar32 c;
+        size_t n;
+        switch (kByteClass[s[i]]) {
+            case kAscii:
+                i++;
+                continue;
+            case kLead2:
+                c = s[i] & 0x1f;
+                n = 1;
+                break;
+            case kLead3:
+                c = s[i] & 0x0f;
+                n = 2;
+                break;
+            case kLead4:
+                c = s[i] & 0x07;
+                n = 3;
+                break;
+            default:
+                // control characters are demerited, the rest is malformed
+                return false;
+        }
+
+        if (i + n >= len) {
+            return false;
+        }
+        for (size_t j = 1; j <= n; j++) {
+            if (kByteClass[s[i + j]] != kTrail) {
+                return false;
+            }
+            c = (c << 6) | (s[i + j] & 0x3f);
+        }
+        // reject overlong forms, surrogates and anything beyond U+10FFFF
+        if ((n == 2 && (c < 0x800 || (c >= 0xd800 && c <= 0xdfff)))
+                || (n == 3 && (c < 0x10000 || c > 0x10ffff))) {
+            return false;
+        }
+        if (demeritFor(c) != 0) {
+            return false;
+        }
+        numMultiByte++;
+        i += n + 1;
+    }
+    return numMultiByte >= kMinMultiByteChars;
+}
+
 void CharacterEncodingDetector::detectAndConvert() {
 
     int size = mNames.size();
@@ -113,7 +280,11 @@ void CharacterEncodingDetector::detectAndConvert() {
             // since 'buf' is empty, ICU would return a UTF-8 matcher with low confidence, so
             // no need to even call it
             ALOGV("all tags are printable, assuming ascii (%zu)", strlen(buf));
+        } else if (isUnambiguousUtf8(buf, strlen(buf))) {
+            // ICU would pick UTF-8 with full confidence and no competitor can beat it
+            ALOGV("combined tags are unambiguous utf-8 (%zu)", strlen(buf));
         } else {
+            mNumDetections++;
             ucsdet_setText(csd, buf, strlen(buf), &status);
             int32_t matches;
             const UCharsetMatch** ucma = ucsdet_detectAll(csd, &matches, &status);
@@ -188,7 +359,11 @@ void CharacterEncodingDetector::detectAndConvert() {
                 if (isPrintableAscii(s, inputLength)) {
                     enc = "UTF-8";
                     ALOGV("@@@@ %s is ascii", mNames.getEntry(i));
+                } else if (isUnambiguousUtf8(s, inputLength)) {
+                    enc = "UTF-8";
+                    ALOGV("@@@@ %s is utf-8", mNames.getEntry(i));
                 } else {
+                    mNumDetections++;
                     ucsdet_setText(csd, s, inputLength, &status);
                     ucm = ucsdet_detect(csd, &status);
                     if (!ucm) {
@@ -361,29 +536,9 @@ const UCharsetMatch *CharacterEncodingDetector::getPreferred(
             if (!U_SUCCESS(status)) {
                 break;
             }
-            if (c < 0x20 || (c >= 0x7f && c <= 0x009f)) {
-                ALOGV("control character %x", c);
-                demerit += 100;
-            } else if ((c == 0xa0)                      // no-break space
-                    || (c >= 0xa2 && c <= 0xbe)         // symbols, superscripts
-                    || (c == 0xd7) || (c == 0xf7)       // multiplication and division signs
-                    || (c >= 0x2000 && c <= 0x209f)) {  // punctuation, superscripts
-                ALOGV("unlikely character %x", c);
-                demerit += 10;
-            } else if (c >= 0xe000 && c <= 0xf8ff) {
-                ALOGV("private use character %x", c);
-                demerit += 30;
-            } else if (c >= 0x2190 && c <= 0x2bff) {
-                // this range comprises various symbol ranges that are unlikely to appear in
-                // music file metadata.
-                ALOGV("symbol %x", c);
-                demerit += 10;
-            } else if (c == 0xfffd) {
-                ALOGV("replacement character");
-                demerit += 50;
-            } else if (c >= 0xfff0 && c <= 0xfffc) {
-                ALOGV("unicode special %x", c);
-                demerit += 50;
+            int charDemerit = demeritFor(c);
+            if (charDemerit != 0) {
+                demerit += charDemerit;
             } else if (freqdata != NULL) {
                 totalchars++;
                 if (isFrequent(freqdata, c)) {
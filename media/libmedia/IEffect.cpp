@@ -30,7 +30,8 @@ enum {
     DISABLE,
     COMMAND,
     DISCONNECT,
-    GET_CBLK
+    GET_CBLK,
+    GET_DATA_MEMORY
 };
 
 class BpEffect: public BpInterface<IEffect>
@@ -123,6 +124,22 @@ public:
         }
         return cblk;
     }
+
+    virtual sp<IMemory> getDataMemory(uint32_t size)
+    {
+        Parcel data, reply;
+        sp<IMemory> memory;
+        data.writeInterfaceToken(IEffect::getInterfaceDescriptor());
+        data.writeInt32(size);
+        status_t status = remote()->transact(GET_DATA_MEMORY, data, &reply);
+        if (status == NO_ERROR) {
+            memory = interface_cast<IMemory>(reply.readStrongBinder());
+            if (memory != 0 && (memory->pointer() == NULL || memory->size() < size)) {
+                memory.clear();
+            }
+        }
+        return memory;
+    }
  };
 
 IMPLEMENT_META_INTERFACE(Effect, "android.media.IEffect");
@@ -194,6 +211,14 @@ status_t BnEffect::onTransact(
             return NO_ERROR;
         } break;
 
+        case GET_DATA_MEMORY: {
+            CHECK_INTERFACE(IEffect, data, reply);
+            uint32_t size = data.readInt32();
+            sp<IMemory> memory = getDataMemory(size);
+            reply->writeStrongBinder(memory != 0 ? memory->asBinder() : NULL);
+            return NO_ERROR;
+        } break;
+
         default:
             return BBinder::onTransact(code, data, reply, flags);
     }
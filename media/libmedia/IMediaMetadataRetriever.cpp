@@ -68,6 +68,8 @@ enum {
     GET_FRAME_AT_TIME,
     EXTRACT_ALBUM_ART,
     EXTRACT_METADATA,
+    GET_THUMBNAIL_AT_TIME,
+    EXTRACT_METADATA_BATCH,
 };
 
 class BpMediaMetadataRetriever: public BpInterface<IMediaMetadataRetriever>
@@ -143,6 +145,27 @@ public:
         return interface_cast<IMemory>(reply.readStrongBinder());
     }
 
+    sp<IMemory> getThumbnailAtTime(int64_t timeUs, int option, int maxWidth, int maxHeight)
+    {
+        ALOGV("getThumbnailAtTime: time(%" PRId64 " us), option(%d), max %dx%d",
+                timeUs, option, maxWidth, maxHeight);
+        Parcel data, reply;
+        data.writeInterfaceToken(IMediaMetadataRetriever::getInterfaceDescriptor());
+        data.writeInt64(timeUs);
+        data.writeInt32(option);
+        data.writeInt32(maxWidth);
+        data.writeInt32(maxHeight);
+#ifndef DISABLE_GROUP_SCHEDULE_HACK
+        sendSchedPolicy(data);
+#endif
+        remote()->transact(GET_THUMBNAIL_AT_TIME, data, &reply);
+        status_t ret = reply.readInt32();
+        if (ret != NO_ERROR) {
+            return NULL;
+        }
+        return interface_cast<IMemory>(reply.readStrongBinder());
+    }
+
     sp<IMemory> extractAlbumArt()
     {
         Parcel data, reply;
@@ -185,6 +208,56 @@ public:
         }
     }
 
+    status_t extractMetadataBatch(
+            const Vector<MetadataBatchRequest> &requests,
+            const Vector<int> &keyCodes,
+            int thumbnailMaxWidth, int thumbnailMaxHeight,
+            Vector<MetadataBatchResult> *results)
+    {
+        Parcel data, reply;
+        data.writeInterfaceToken(IMediaMetadataRetriever::getInterfaceDescriptor());
+        data.writeInt32(requests.size());
+        for (size_t i = 0; i < requests.size(); ++i) {
+            data.writeFileDescriptor(requests[i].mFd);
+            data.writeInt64(requests[i].mOffset);
+            data.writeInt64(requests[i].mLength);
+        }
+        data.writeInt32(keyCodes.size());
+        for (size_t i = 0; i < keyCodes.size(); ++i) {
+            data.writeInt32(keyCodes[i]);
+        }
+        data.writeInt32(thumbnailMaxWidth);
+        data.writeInt32(thumbnailMaxHeight);
+#ifndef DISABLE_GROUP_SCHEDULE_HACK
+        sendSchedPolicy(data);
+#endif
+        status_t ret = remote()->transact(EXTRACT_METADATA_BATCH, data, &reply);
+        if (ret != NO_ERROR) {
+            return ret;
+        }
+        ret = reply.readInt32();
+        if (ret != NO_ERROR) {
+            return ret;
+        }
+
+        results->clear();
+        size_t numResults = reply.readInt32();
+        for (size_t i = 0; i < numResults; ++i) {
+            MetadataBatchResult result;
+            result.mStatus = reply.readInt32();
+            size_t numValues = reply.readInt32();
+            for (size_t j = 0; j < numValues; ++j) {
+                int keyCode = reply.readInt32();
+                result.mMetadata.add(keyCode, reply.readString8());
+            }
+            if (reply.readInt32()) {
+                result.mThumbnail = interface_cast<IMemory>(reply.readStrongBinder());
+            }
+            results->push(result);
+        }
+        return NO_ERROR;
+    }
+
 private:
     KeyedVector<int, String8> mMetadata;
 };
@@ -252,6 +325,29 @@ status_t BnMediaMetadataRetriever::onTransact(
             }
 #ifndef DISABLE_GROUP_SCHEDULE_HACK
             restoreSchedPolicy();
+#endif
+            return NO_ERROR;
+        } break;
+        case GET_THUMBNAIL_AT_TIME: {
+            CHECK_INTERFACE(IMediaMetadataRetriever, data, reply);
+            int64_t timeUs = data.readInt64();
+            int option = data.readInt32();
+            int maxWidth = data.readInt32();
+            int maxHeight = data.readInt32();
+            ALOGV("getThumbnailAtTime: time(%" PRId64 " us), option(%d), max %dx%d",
+                    timeUs, option, maxWidth, maxHeight);
+#ifndef DISABLE_GROUP_SCHEDULE_HACK
+            setSchedPolicy(data);
+#endif
+            sp<IMemory> bitmap = getThumbnailAtTime(timeUs, option, maxWidth, maxHeight);
+            if (bitmap != 0) {  // Don't send NULL across the binder interface
+                reply->writeInt32(NO_ERROR);
+                reply->writeStrongBinder(bitmap->asBinder());
+            } else {
+                reply->writeInt32(UNKNOWN_ERROR);
+            }
+#ifndef DISABLE_GROUP_SCHEDULE_HACK
+            restoreSchedPolicy();
 #endif
             return NO_ERROR;
         } break;
@@ -287,6 +383,59 @@ status_t BnMediaMetadataRetriever::onTransact(
             }
 #ifndef DISABLE_GROUP_SCHEDULE_HACK
             restoreSchedPolicy();
+#endif
+            return NO_ERROR;
+        } break;
+        case EXTRACT_METADATA_BATCH: {
+            CHECK_INTERFACE(IMediaMetadataRetriever, data, reply);
+            size_t numRequests = data.readInt32();
+            if (numRequests > kMaxBatchSize) {
+                reply->writeInt32(BAD_VALUE);
+                return NO_ERROR;
+            }
+            // The descriptors stay owned by the parcel, which outlives the
+            // call; retrievers dup() whatever they need to keep.
+            Vector<MetadataBatchRequest> requests;
+            for (size_t i = 0; i < numRequests; ++i) {
+                MetadataBatchRequest request;
+                request.mFd = data.readFileDescriptor();
+                request.mOffset = data.readInt64();
+                request.mLength = data.readInt64();
+                requests.push(request);
+            }
+            Vector<int> keyCodes;
+            size_t numKeyCodes = data.readInt32();
+            for (size_t i = 0; i < numKeyCodes && data.dataAvail() > 0; ++i) {
+                keyCodes.push(data.readInt32());
+            }
+            int thumbnailMaxWidth = data.readInt32();
+            int thumbnailMaxHeight = data.readInt32();
+#ifndef DISABLE_GROUP_SCHEDULE_HACK
+            setSchedPolicy(data);
+#endif
+            Vector<MetadataBatchResult> results;
+            status_t ret = extractMetadataBatch(
+                    requests, keyCodes, thumbnailMaxWidth, thumbnailMaxHeight, &results);
+            reply->writeInt32(ret);
+            if (ret == NO_ERROR) {
+                reply->writeInt32(results.size());
+                for (size_t i = 0; i < results.size(); ++i) {
+                    const MetadataBatchResult &result = results[i];
+                    reply->writeInt32(result.mStatus);
+                    reply->writeInt32(result.mMetadata.size());
+                    for (size_t j = 0; j < result.mMetadata.size(); ++j) {
+                        reply->writeInt32(result.mMetadata.keyAt(j));
+                        reply->writeString8(result.mMetadata.valueAt(j));
+                    }
+                    // Don't send NULL across the binder interface
+                    reply->writeInt32(result.mThumbnail != 0);
+                    if (result.mThumbnail != 0) {
+                        reply->writeStrongBinder(result.mThumbnail->asBinder());
+                    }
+                }
+            }
+#ifndef DISABLE_GROUP_SCHEDULE_HACK
+            restoreSchedPolicy();
 #endif
             return NO_ERROR;
         } break;
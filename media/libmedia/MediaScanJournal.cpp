@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "MediaScanJournal"
+#include <utils/Log.h>
+
+#include "MediaScanJournal.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+namespace android {
+
+static const char kJournalHeader[] = "mediascanjournal 1\n";
+
+MediaScanJournal::MediaScanJournal() {
+}
+
+// static
+int MediaScanJournal::compareEntries(const Entry *a, const Entry *b) {
+    return strcmp(a->mPath.string(), b->mPath.string());
+}
+
+status_t MediaScanJournal::load(const char *path) {
+    mPrevious.clear();
+    mCurrent.clear();
+
+    FILE *file = fopen(path, "r");
+    if (file == NULL) {
+        ALOGV("no journal at %s: %s", path, strerror(errno));
+        return NAME_NOT_FOUND;
+    }
+
+    char *line = NULL;
+    size_t lineCapacity = 0;
+    ssize_t lineLength = getline(&line, &lineCapacity, file);
+
+    status_t err = OK;
+    if (lineLength < 0 || strcmp(line, kJournalHeader)) {
+        ALOGW("ignoring journal %s with unknown format", path);
+        err = BAD_VALUE;
+    }
+
+    bool sorted = true;
+    while (err == OK && (lineLength = getline(&line, &lineCapacity, file)) > 0) {
+        if (line[lineLength - 1] == '\n') {
+            line[--lineLength] = '\0';
+        }
+
+        Entry entry;
+        int pathOffset = 0;
+        if (sscanf(line, "%lld %lld %n",
+                   &entry.mLastModified, &entry.mFileSize, &pathOffset) < 2
+                || pathOffset == 0 || line[pathOffset] == '\0') {
+            ALOGW("ignoring journal %s, malformed entry", path);
+            mPrevious.clear();
+            err = BAD_VALUE;
+            break;
+        }
+        entry.mPath.setTo(line + pathOffset);
+
+        if (!mPrevious.isEmpty()
+                && compareEntries(&mPrevious.top(), &entry) >= 0) {
+            sorted = false;
+        }
+        mPrevious.push(entry);
+    }
+
+    free(line);
+    fclose(file);
+
+    if (!sorted) {
+        mPrevious.sort(compareEntries);
+    }
+
+    ALOGV("loaded %zu journal entries from %s", mPrevious.size(), path);
+    return err;
+}
+
+status_t MediaScanJournal::save(const char *path, const char *root) {
+    // Entries of other roots were not looked at by this scan, keep them.
+    size_t rootLength = strlen(root);
+    for (size_t i = 0; i < mPrevious.size(); ++i) {
+        const Entry &entry = mPrevious.itemAt(i);
+        if (strncmp(entry.mPath.string(), root, rootLength)) {
+            mCurrent.push(entry);
+        }
+    }
+    mCurrent.sort(compareEntries);
+
+    // Write a new file and rename it over the old one so that an interrupted
+    // save never leaves a truncated journal behind.
+    String8 tmpPath(path);
+    tmpPath.append(".tmp");
+
+    FILE *file = fopen(tmpPath.string(), "w");
+    if (file == NULL) {
+        ALOGW("unable to write journal %s: %s", tmpPath.string(), strerror(errno));
+        return -errno;
+    }
+
+    fputs(kJournalHeader, file);
+    for (size_t i = 0; i < mCurrent.size(); ++i) {
+        const Entry &entry = mCurrent.itemAt(i);
+        fprintf(file, "%lld %lld %s\n",
+                entry.mLastModified, entry.mFileSize, entry.mPath.string());
+    }
+
+    bool failed = ferror(file) != 0;
+    if (fclose(file) != 0) {
+        failed = true;
+    }
+
+    if (failed || rename(tmpPath.string(), path) != 0) {
+        ALOGW("unable to write journal %s", path);
+        unlink(tmpPath.string());
+        return UNKNOWN_ERROR;
+    }
+
+    ALOGV("saved %zu journal entries to %s", mCurrent.size(), path);
+    return OK;
+}
+
+bool MediaScanJournal::isUnchanged(
+        const char *path, long long lastModified, long long fileSize) const {
+    ssize_t lo = 0;
+    ssize_t hi = (ssize_t)mPrevious.size() - 1;
+    while (lo <= hi) {
+        ssize_t mid = lo + (hi - lo) / 2;
+        const Entry &entry = mPrevious.itemAt(mid);
+        int cmp = strcmp(path, entry.mPath.string());
+        if (cmp == 0) {
+            return entry.mLastModified == lastModified
+                    && entry.mFileSize == fileSize;
+        } else if (cmp < 0) {
+            hi = mid - 1;
+        } else {
+            lo = mid + 1;
+        }
+    }
+
+    return false;
+}
+
+void MediaScanJournal::record(
+        const char *path, long long lastModified, long long fileSize) {
+    // The line based format cannot represent these, they'll just be rescanned.
+    if (strchr(path, '\n') != NULL) {
+        return;
+    }
+
+    Entry entry;
+    entry.mPath.setTo(path);
+    entry.mLastModified = lastModified;
+    entry.mFileSize = fileSize;
+    mCurrent.push(entry);
+}
+
+}  // namespace android
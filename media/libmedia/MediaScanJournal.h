@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MEDIA_SCAN_JOURNAL_H_
+#define MEDIA_SCAN_JOURNAL_H_
+
+#include <utils/Errors.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+/*
+ * Remembers (path, size, mtime) of every file a previous scan reported
+ * successfully, so that an incremental scan can skip files that did not
+ * change. Entries are kept sorted by path on disk. One journal may cover
+ * several scanned roots: saving replaces only the entries under the root
+ * that was scanned, files under it that were not recorded again drop out.
+ */
+class MediaScanJournal {
+public:
+    MediaScanJournal();
+
+    // A missing or unreadable journal simply yields an empty one.
+    status_t load(const char *path);
+
+    // Replaces the entries under root, which must end with a '/', with the
+    // entries recorded since load() and writes the journal to path.
+    status_t save(const char *path, const char *root);
+
+    bool isUnchanged(const char *path, long long lastModified, long long fileSize) const;
+
+    void record(const char *path, long long lastModified, long long fileSize);
+
+    size_t numPrevious() const { return mPrevious.size(); }
+
+private:
+    struct Entry {
+        String8 mPath;
+        long long mLastModified;
+        long long mFileSize;
+    };
+
+    // sorted by path
+    Vector<Entry> mPrevious;
+
+    // in scan order, sorted by save()
+    Vector<Entry> mCurrent;
+
+    static int compareEntries(const Entry *a, const Entry *b);
+
+    MediaScanJournal(const MediaScanJournal &);
+    MediaScanJournal &operator=(const MediaScanJournal &);
+};
+
+}  // namespace android
+
+#endif  // MEDIA_SCAN_JOURNAL_H_
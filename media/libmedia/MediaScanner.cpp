@@ -24,15 +24,285 @@
 #include <sys/stat.h>
 #include <dirent.h>
 
+#include "MediaScanJournal.h"
+
 namespace android {
 
+// Collects what processFile() reports for one file on a worker thread.
+class RecordingScannerClient : public MediaScannerClient {
+public:
+    RecordingScannerClient(MediaScanFileResult *result) : mResult(result) {}
+
+    virtual status_t scanFile(const char* /* path */, long long /* lastModified */,
+            long long /* fileSize */, bool /* isDirectory */, bool /* noMedia */) {
+        return INVALID_OPERATION;
+    }
+
+    virtual status_t handleStringTag(const char* name, const char* value) {
+        mResult->mTagNames.push(String8(name));
+        mResult->mTagValues.push(String8(value));
+        return OK;
+    }
+
+    virtual status_t setMimeType(const char* mimeType) {
+        mResult->mMimeType.setTo(mimeType);
+        return OK;
+    }
+
+private:
+    MediaScanFileResult *mResult;
+};
+
+// State of one processDirectory() call in parallel mode. Everything except
+// the job and result queues is only touched by the scanning thread.
+struct MediaScanner::ScanSession {
+    ScanSession(MediaScanner *scanner, MediaScannerClient &client,
+            int numWorkers, const char *journalPath, const char *root);
+    ~ScanSession();
+
+    MediaScanResult scanFile(const char *path, const struct stat &statbuf, bool noMedia);
+
+    // Waits for all queued files, delivers their results and, if the scan
+    // succeeded, saves the journal.
+    MediaScanResult finish(MediaScanResult result);
+
+private:
+    enum {
+        kBatchSize = 32,
+        kMaxQueuedJobsPerWorker = 8,
+    };
+
+    struct Job {
+        String8 mPath;
+        long long mLastModified;
+        long long mFileSize;
+        bool mNoMedia;
+    };
+
+    class Worker : public Thread {
+    public:
+        Worker(ScanSession *session) : Thread(false), mSession(session) {}
+
+    private:
+        virtual bool threadLoop() { return mSession->processNextJob(); }
+
+        ScanSession *mSession;
+    };
+
+    MediaScanner *mScanner;
+    MediaScannerClient &mClient;
+    String8 mJournalPath;
+    String8 mRoot;
+    MediaScanJournal mJournal;
+    Vector<sp<Worker> > mWorkers;
+
+    Mutex mLock;
+    Condition mJobAvailable;
+    Condition mResultAvailable;
+    List<Job> mJobs;
+    size_t mNumJobsInFlight;
+    Vector<MediaScanFileResult> mResults;
+    bool mDone;
+
+    size_t mNumUnchanged;
+    size_t mNumProcessed;
+
+    bool processNextJob();
+    MediaScanResult deliverResults(bool waitForAll);
+
+    ScanSession(const ScanSession &);
+    ScanSession &operator=(const ScanSession &);
+};
+
+MediaScanner::ScanSession::ScanSession(
+        MediaScanner *scanner, MediaScannerClient &client,
+        int numWorkers, const char *journalPath, const char *root)
+    : mScanner(scanner),
+      mClient(client),
+      mRoot(root),
+      mNumJobsInFlight(0),
+      mDone(false),
+      mNumUnchanged(0),
+      mNumProcessed(0) {
+    if (journalPath != NULL) {
+        mJournalPath.setTo(journalPath);
+        mJournal.load(journalPath);
+    }
+
+    if (!client.handlesScannedFiles()) {
+        return;
+    }
+
+    for (int i = 0; i < numWorkers; ++i) {
+        sp<Worker> worker = new Worker(this);
+        if (worker->run("MediaScanWorker", ANDROID_PRIORITY_BACKGROUND) != OK) {
+            break;
+        }
+        mWorkers.push(worker);
+    }
+}
+
+MediaScanner::ScanSession::~ScanSession() {
+    {
+        Mutex::Autolock autoLock(mLock);
+        mDone = true;
+        mJobAvailable.broadcast();
+    }
+
+    for (size_t i = 0; i < mWorkers.size(); ++i) {
+        mWorkers[i]->requestExitAndWait();
+    }
+}
+
+bool MediaScanner::ScanSession::processNextJob() {
+    Job job;
+    {
+        Mutex::Autolock autoLock(mLock);
+        while (mJobs.empty() && !mDone) {
+            mJobAvailable.wait(mLock);
+        }
+        if (mJobs.empty()) {
+            return false;
+        }
+        job = *mJobs.begin();
+        mJobs.erase(mJobs.begin());
+        ++mNumJobsInFlight;
+        mResultAvailable.signal();
+    }
+
+    MediaScanFileResult result;
+    result.mPath = job.mPath;
+    result.mLastModified = job.mLastModified;
+    result.mFileSize = job.mFileSize;
+    result.mNoMedia = job.mNoMedia;
+
+    RecordingScannerClient recorder(&result);
+    result.mResult = mScanner->processFile(job.mPath.string(), NULL, recorder);
+
+    Mutex::Autolock autoLock(mLock);
+    mResults.push(result);
+    --mNumJobsInFlight;
+    mResultAvailable.signal();
+
+    return true;
+}
+
+MediaScanResult MediaScanner::ScanSession::deliverResults(bool waitForAll) {
+    for (;;) {
+        Vector<MediaScanFileResult> batch;
+        {
+            Mutex::Autolock autoLock(mLock);
+            while (waitForAll && mResults.isEmpty()
+                    && (!mJobs.empty() || mNumJobsInFlight > 0)) {
+                mResultAvailable.wait(mLock);
+            }
+            if (mResults.isEmpty()) {
+                return MEDIA_SCAN_RESULT_OK;
+            }
+            batch = mResults;
+            mResults.clear();
+        }
+
+        if (mClient.handleScannedFiles(batch) != OK) {
+            return MEDIA_SCAN_RESULT_ERROR;
+        }
+
+        // Files that failed to process are left out of the journal so that
+        // the next scan tries them again.
+        for (size_t i = 0; i < batch.size(); ++i) {
+            const MediaScanFileResult &result = batch.itemAt(i);
+            if (result.mResult != MEDIA_SCAN_RESULT_ERROR) {
+                mJournal.record(result.mPath.string(),
+                        result.mLastModified, result.mFileSize);
+            }
+        }
+        mNumProcessed += batch.size();
+
+        if (!waitForAll) {
+            return MEDIA_SCAN_RESULT_OK;
+        }
+    }
+}
+
+MediaScanResult MediaScanner::ScanSession::scanFile(
+        const char *path, const struct stat &statbuf, bool noMedia) {
+    if (mJournal.isUnchanged(path, statbuf.st_mtime, statbuf.st_size)) {
+        mJournal.record(path, statbuf.st_mtime, statbuf.st_size);
+        ++mNumUnchanged;
+        return MEDIA_SCAN_RESULT_OK;
+    }
+
+    if (mWorkers.isEmpty()) {
+        status_t status = mClient.scanFile(path, statbuf.st_mtime, statbuf.st_size,
+                false /*isDirectory*/, noMedia);
+        if (status) {
+            return MEDIA_SCAN_RESULT_ERROR;
+        }
+        mJournal.record(path, statbuf.st_mtime, statbuf.st_size);
+        ++mNumProcessed;
+        return MEDIA_SCAN_RESULT_OK;
+    }
+
+    Job job;
+    job.mPath.setTo(path);
+    job.mLastModified = statbuf.st_mtime;
+    job.mFileSize = statbuf.st_size;
+    job.mNoMedia = noMedia;
+
+    size_t numResults;
+    for (;;) {
+        bool deliver = false;
+        {
+            Mutex::Autolock autoLock(mLock);
+            if (mJobs.size() < kMaxQueuedJobsPerWorker * mWorkers.size()) {
+                mJobs.push_back(job);
+                mJobAvailable.signal();
+                numResults = mResults.size();
+                break;
+            }
+
+            // The queue is full, hand finished files to the client while
+            // the workers catch up.
+            if (mResults.isEmpty()) {
+                mResultAvailable.wait(mLock);
+            }
+            deliver = !mResults.isEmpty();
+        }
+
+        if (deliver && deliverResults(false) == MEDIA_SCAN_RESULT_ERROR) {
+            return MEDIA_SCAN_RESULT_ERROR;
+        }
+    }
+
+    if (numResults >= kBatchSize) {
+        return deliverResults(false);
+    }
+    return MEDIA_SCAN_RESULT_OK;
+}
+
+MediaScanResult MediaScanner::ScanSession::finish(MediaScanResult result) {
+    if (result != MEDIA_SCAN_RESULT_ERROR) {
+        result = deliverResults(true);
+    }
+
+    ALOGV("scan finished: %zu files unchanged, %zu processed",
+          mNumUnchanged, mNumProcessed);
+
+    if (result != MEDIA_SCAN_RESULT_ERROR && !mJournalPath.isEmpty()) {
+        mJournal.save(mJournalPath.string(), mRoot.string());
+    }
+    return result;
+}
+
 MediaScanner::MediaScanner()
-    : mLocale(NULL), mSkipList(NULL), mSkipIndex(NULL) {
+    : mLocale(NULL), mSkipList(NULL), mSkipIndex(NULL),
+      mNumWorkers(0), mJournalPath(NULL), mSession(NULL) {
     loadSkipList();
 }
 
 MediaScanner::~MediaScanner() {
     setLocale(NULL);
+    setParallelScan(0, NULL);
     free(mSkipList);
     free(mSkipIndex);
 }
@@ -47,6 +317,19 @@ void MediaScanner::setLocale(const char *locale) {
     }
 }
 
+void MediaScanner::setParallelScan(int numWorkers, const char *journalPath) {
+    free(mJournalPath);
+    mJournalPath = NULL;
+    mNumWorkers = 0;
+
+    if (numWorkers > 0) {
+        mNumWorkers = numWorkers;
+        if (journalPath) {
+            mJournalPath = strdup(journalPath);
+        }
+    }
+}
+
 const char *MediaScanner::locale() const {
     return mLocale;
 }
@@ -99,8 +382,18 @@ MediaScanResult MediaScanner::processDirectory(
 
     client.setLocale(locale());
 
+    if (mNumWorkers > 0) {
+        mSession = new ScanSession(this, client, mNumWorkers, mJournalPath, pathBuffer);
+    }
+
     MediaScanResult result = doProcessDirectory(pathBuffer, pathRemaining, client, false);
 
+    if (mSession != NULL) {
+        result = mSession->finish(result);
+        delete mSession;
+        mSession = NULL;
+    }
+
     free(pathBuffer);
 
     return result;
@@ -227,6 +520,9 @@ MediaScanResult MediaScanner::doProcessDirectoryEntry(
         }
     } else if (type == DT_REG) {
         stat(path, &statbuf);
+        if (mSession != NULL) {
+            return mSession->scanFile(path, statbuf, noMedia);
+        }
         status_t status = client.scanFile(path, statbuf.st_mtime, statbuf.st_size,
                 false /*isDirectory*/, noMedia);
         if (status) {
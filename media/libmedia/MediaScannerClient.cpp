@@ -48,4 +48,9 @@ status_t MediaScannerClient::addStringTag(const char* name, const char* value)
 void MediaScannerClient::endFile() {
 }
 
+status_t MediaScannerClient::handleScannedFiles(
+        const Vector<MediaScanFileResult> & /* files */) {
+    return INVALID_OPERATION;
+}
+
 }  // namespace android
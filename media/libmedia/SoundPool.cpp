@@ -18,8 +18,10 @@
 #define LOG_TAG "SoundPool"
 
 #include <inttypes.h>
+#include <unistd.h>
 
 #include <utils/Log.h>
+#include <cutils/properties.h>
 
 #define USE_SHARED_MEM_BUFFER
 
@@ -28,6 +30,7 @@
 #include <media/mediaplayer.h>
 #include <media/SoundPool.h>
 #include "SoundPoolThread.h"
+#include "SoundPoolMixer.h"
 #include <media/AudioPolicyHelper.h>
 
 namespace android
@@ -38,26 +41,49 @@ uint32_t kMaxSampleRate = 48000;
 uint32_t kDefaultSampleRate = 44100;
 uint32_t kDefaultFrameCount = 1200;
 size_t kDefaultHeapSize = 1024 * 1024; // 1MB
+int kMaxDecodeThreads = 4;
+int kMaxChannels = 32;
+int kMaxMixerVoices = 128;
 
 
-SoundPool::SoundPool(int maxChannels, const audio_attributes_t* pAttributes)
+SoundPool::SoundPool(int maxChannels, const audio_attributes_t* pAttributes, int decodeThreads,
+        bool mixVoices)
 {
     ALOGV("SoundPool constructor: maxChannels=%d, attr.usage=%d, attr.flags=0x%x, attr.tags=%s",
             maxChannels, pAttributes->usage, pAttributes->flags, pAttributes->tags);
 
+    char value[PROPERTY_VALUE_MAX];
+    if (property_get("media.soundpool.mixer", value, "0") > 0 && atoi(value) != 0) {
+        mixVoices = true;
+    }
+
     // check limits
     mMaxChannels = maxChannels;
     if (mMaxChannels < 1) {
         mMaxChannels = 1;
     }
-    else if (mMaxChannels > 32) {
-        mMaxChannels = 32;
+    else if (mMaxChannels > (mixVoices ? kMaxMixerVoices : kMaxChannels)) {
+        mMaxChannels = mixVoices ? kMaxMixerVoices : kMaxChannels;
     }
-    ALOGW_IF(maxChannels != mMaxChannels, "App requested %d channels", maxChannels);
 
     mQuit = false;
+    mMixerIdle = false;
     mDecodeThread = 0;
+    mMixer = 0;
     memcpy(&mAttributes, pAttributes, sizeof(audio_attributes_t));
+
+    if (mixVoices) {
+        mMixer = new SoundPoolMixer(this, mMaxChannels);
+        if (mMixer->initCheck() != NO_ERROR) {
+            ALOGW("Unable to mix voices, one AudioTrack per channel");
+            delete mMixer;
+            mMixer = 0;
+            if (mMaxChannels > kMaxChannels) {
+                mMaxChannels = kMaxChannels;
+            }
+        }
+    }
+    ALOGW_IF(maxChannels != mMaxChannels, "App requested %d channels", maxChannels);
     mAllocated = 0;
     mNextSampleID = 0;
     mNextChannelID = 0;
@@ -65,14 +91,30 @@ SoundPool::SoundPool(int maxChannels, const audio_attributes_t* pAttributes)
     mCallback = 0;
     mUserData = 0;
 
+    // property "media.soundpool.cache_kb" bounds the decoded data of each sound pool
+    mCacheSize = 0;
+    mMaxCacheSize = 0;
+    mCacheClock = 0;
+    if (property_get("media.soundpool.cache_kb", value, NULL) > 0) {
+        mMaxCacheSize = (size_t)atoi(value) * 1024;
+    }
+
     mChannelPool = new SoundChannel[mMaxChannels];
     for (int i = 0; i < mMaxChannels; ++i) {
         mChannelPool[i].init(this);
         mChannels.push_back(&mChannelPool[i]);
     }
 
-    // start decode thread
-    startThreads();
+    // start decode threads
+    if (decodeThreads <= 0) {
+        decodeThreads = sysconf(_SC_NPROCESSORS_ONLN);
+    }
+    if (decodeThreads < 1) {
+        decodeThreads = 1;
+    } else if (decodeThreads > kMaxDecodeThreads) {
+        decodeThreads = kMaxDecodeThreads;
+    }
+    startThreads(decodeThreads);
 }
 
 SoundPool::~SoundPool()
@@ -92,6 +134,9 @@ SoundPool::~SoundPool()
 
     if (mDecodeThread)
         delete mDecodeThread;
+
+    // after the channels, which stop their voices
+    delete mMixer;
 }
 
 void SoundPool::addToRestartList(SoundChannel* channel)
@@ -112,6 +157,15 @@ void SoundPool::addToStopList(SoundChannel* channel)
     }
 }
 
+void SoundPool::mixerIdle()
+{
+    Mutex::Autolock lock(&mRestartLock);
+    if (!mQuit) {
+        mMixerIdle = true;
+        mCondition.signal();
+    }
+}
+
 int SoundPool::beginThread(void* arg)
 {
     SoundPool* p = (SoundPool*)arg;
@@ -155,10 +209,25 @@ int SoundPool::run()
             mRestartLock.lock();
             if (mQuit) break;
         }
+
+        // the mixer track is stopped here, as it cannot be from its callback
+        while (mMixerIdle) {
+            mMixerIdle = false;
+            mRestartLock.unlock();
+            {
+                Mutex::Autolock lock(&mLock);
+                if (mMixer != NULL) {
+                    mMixer->updateTrack();
+                }
+            }
+            mRestartLock.lock();
+            if (mQuit) break;
+        }
     }
 
     mStop.clear();
     mRestart.clear();
+    mMixerIdle = false;
     mCondition.signal();
     mRestartLock.unlock();
     ALOGV("goodbye");
@@ -175,14 +244,21 @@ void SoundPool::quit()
     mRestartLock.unlock();
 }
 
-bool SoundPool::startThreads()
+bool SoundPool::startThreads(int decodeThreads)
 {
     createThreadEtc(beginThread, this, "SoundPool");
     if (mDecodeThread == NULL)
-        mDecodeThread = new SoundPoolThread(this);
+        mDecodeThread = new SoundPoolThread(this, decodeThreads);
     return mDecodeThread != NULL;
 }
 
+// called from SoundPoolThread
+sp<Sample> SoundPool::findSample(int sampleID)
+{
+    Mutex::Autolock lock(&mLock);
+    return findSample_l(sampleID);
+}
+
 SoundChannel* SoundPool::findChannel(int channelID)
 {
     for (int i = 0; i < mMaxChannels; ++i) {
@@ -206,9 +282,14 @@ SoundChannel* SoundPool::findNextChannel(int channelID)
 int SoundPool::load(const char* path, int priority __unused)
 {
     ALOGV("load: path=%s, priority=%d", path, priority);
-    Mutex::Autolock lock(&mLock);
-    sp<Sample> sample = new Sample(++mNextSampleID, path);
-    mSamples.add(sample->sampleID(), sample);
+    sp<Sample> sample;
+    {
+        Mutex::Autolock lock(&mLock);
+        sample = new Sample(++mNextSampleID, path);
+        mSamples.add(sample->sampleID(), sample);
+    }
+    // the decode threads take the lock when a sample is loaded, so do not hold it
+    // while waiting for room in their queue
     doLoad(sample);
     return sample->sampleID();
 }
@@ -217,9 +298,15 @@ int SoundPool::load(int fd, int64_t offset, int64_t length, int priority __unuse
 {
     ALOGV("load: fd=%d, offset=%" PRId64 ", length=%" PRId64 ", priority=%d",
             fd, offset, length, priority);
-    Mutex::Autolock lock(&mLock);
-    sp<Sample> sample = new Sample(++mNextSampleID, fd, offset, length);
-    mSamples.add(sample->sampleID(), sample);
+    sp<Sample> sample;
+    {
+        Mutex::Autolock lock(&mLock);
+        sample = new Sample(++mNextSampleID, fd, offset, length);
+        if (mMaxCacheSize > 0) {
+            sample->keepSource();
+        }
+        mSamples.add(sample->sampleID(), sample);
+    }
     doLoad(sample);
     return sample->sampleID();
 }
@@ -235,9 +322,108 @@ bool SoundPool::unload(int sampleID)
 {
     ALOGV("unload: sampleID=%d", sampleID);
     Mutex::Autolock lock(&mLock);
+    sp<Sample> sample = findSample_l(sampleID);
+    if (sample != 0) {
+        mCacheSize -= sample->cachedSize();
+        sample->setCachedSize(0);
+    }
     return mSamples.removeItem(sampleID);
 }
 
+// called from SoundPoolThread, or from play() for an evicted sample
+void SoundPool::sampleLoaded(int sampleID)
+{
+    Mutex::Autolock lock(&mLock);
+    sp<Sample> sample = findSample_l(sampleID);
+    // the sample may have been unloaded while decoding
+    if (sample == 0 || sample->state() != Sample::READY || sample->cachedSize() != 0) {
+        return;
+    }
+    sample->setCachedSize(sample->size());
+    sample->setLastUsed(++mCacheClock);
+    mCacheSize += sample->size();
+    ALOGV("sampleLoaded: sampleID=%d, size=%zu, cache size=%zu", sampleID, sample->size(),
+            mCacheSize);
+    trimCache_l(sample);
+}
+
+void SoundPool::reloadSample(int sampleID)
+{
+    sp<Sample> sample;
+    {
+        Mutex::Autolock lock(&mLock);
+        sample = findSample_l(sampleID);
+        if ((sample == 0) || (sample->state() != Sample::EVICTED)) {
+            return;
+        }
+        sample->startLoad();
+        mReloading.add(sampleID);
+    }
+
+    // decode without the lock, like the decode threads
+    ALOGV("reloadSample: sampleID=%d", sampleID);
+    if (sample->doLoad() == NO_ERROR) {
+        sampleLoaded(sampleID);
+    }
+
+    Mutex::Autolock lock(&mLock);
+    mReloading.remove(sampleID);
+    mReloadCondition.broadcast();
+}
+
+void SoundPool::setMaxCacheSize(size_t maxCacheSize)
+{
+    ALOGV("setMaxCacheSize(%zu)", maxCacheSize);
+    Mutex::Autolock lock(&mLock);
+    mMaxCacheSize = maxCacheSize;
+    trimCache_l(0);
+}
+
+size_t SoundPool::cacheSize()
+{
+    Mutex::Autolock lock(&mLock);
+    return mCacheSize;
+}
+
+// call with lock held
+bool SoundPool::isPlaying_l(const sp<Sample>& sample)
+{
+    for (int i = 0; i < mMaxChannels; ++i) {
+        if (mChannelPool[i].sample() == sample || mChannelPool[i].nextSample() == sample) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// call with lock held
+void SoundPool::trimCache_l(const sp<Sample>& keep)
+{
+    while (mMaxCacheSize > 0 && mCacheSize > mMaxCacheSize) {
+        // evict the least recently used sample which is not playing
+        sp<Sample> lru;
+        for (size_t i = 0; i < mSamples.size(); ++i) {
+            const sp<Sample>& sample = mSamples.valueAt(i);
+            if (sample == keep || sample->cachedSize() == 0 || !sample->canEvict() ||
+                    isPlaying_l(sample)) {
+                continue;
+            }
+            if (lru == 0 || (int32_t)(sample->lastUsed() - lru->lastUsed()) < 0) {
+                lru = sample;
+            }
+        }
+        if (lru == 0) {
+            ALOGV("trimCache_l: cache size %zu above %zu, nothing to evict", mCacheSize,
+                    mMaxCacheSize);
+            break;
+        }
+        ALOGV("trimCache_l: evict sampleID=%d, size=%zu", lru->sampleID(), lru->cachedSize());
+        mCacheSize -= lru->cachedSize();
+        lru->setCachedSize(0);
+        lru->evict();
+    }
+}
+
 int SoundPool::play(int sampleID, float leftVolume, float rightVolume,
         int priority, int loop, float rate)
 {
@@ -247,17 +433,25 @@ int SoundPool::play(int sampleID, float leftVolume, float rightVolume,
     SoundChannel* channel;
     int channelID;
 
+    // decode again a sample evicted from the cache
+    reloadSample(sampleID);
+
     Mutex::Autolock lock(&mLock);
 
+    // a play() of the same evicted sample may be decoding it again: play it once it is done
+    while (mReloading.indexOf(sampleID) >= 0) {
+        mReloadCondition.wait(mLock);
+    }
     if (mQuit) {
         return 0;
     }
     // is sample ready?
-    sample = findSample(sampleID);
+    sample = findSample_l(sampleID);
     if ((sample == 0) || (sample->state() != Sample::READY)) {
         ALOGW("  sample %d not READY", sampleID);
         return 0;
     }
+    sample->setLastUsed(++mCacheClock);
 
     dump();
 
@@ -479,6 +673,9 @@ void Sample::init()
     mOffset = 0;
     mLength = 0;
     mUrl = 0;
+    mKeepSource = false;
+    mCachedSize = 0;
+    mLastUsed = 0;
 }
 
 Sample::~Sample()
@@ -492,12 +689,23 @@ Sample::~Sample()
 }
 
 status_t Sample::doLoad()
+{
+    sp<MemoryHeapBase> decodeHeap;
+    return doLoad(decodeHeap);
+}
+
+// decodeHeap is allocated if needed and can be reused for the next sample: the decoded data
+// is copied to a heap of its size, in the native sample rate, channel count and format
+status_t Sample::doLoad(sp<MemoryHeapBase>& decodeHeap)
 {
     uint32_t sampleRate;
     int numChannels;
     audio_format_t format;
     status_t status;
-    mHeap = new MemoryHeapBase(kDefaultHeapSize);
+    if (decodeHeap == 0) {
+        decodeHeap = new MemoryHeapBase(kDefaultHeapSize);
+    }
+    mHeap.clear();
 
     ALOGV("Start decode");
     if (mUrl) {
@@ -507,21 +715,23 @@ status_t Sample::doLoad()
                 &sampleRate,
                 &numChannels,
                 &format,
-                mHeap,
+                decodeHeap,
                 &mSize);
     } else {
         status = MediaPlayer::decode(mFd, mOffset, mLength, &sampleRate, &numChannels, &format,
-                                     mHeap, &mSize);
-        ALOGV("close(%d)", mFd);
-        ::close(mFd);
-        mFd = -1;
+                                     decodeHeap, &mSize);
+        if (!mKeepSource) {
+            ALOGV("close(%d)", mFd);
+            ::close(mFd);
+            mFd = -1;
+        }
     }
     if (status != NO_ERROR) {
         ALOGE("Unable to load sample: %s", mUrl);
         goto error;
     }
     ALOGV("pointer = %p, size = %zu, sampleRate = %u, numChannels = %d",
-          mHeap->getBase(), mSize, sampleRate, numChannels);
+          decodeHeap->getBase(), mSize, sampleRate, numChannels);
 
     if (sampleRate > kMaxSampleRate) {
        ALOGE("Sample rate (%u) out of range", sampleRate);
@@ -535,6 +745,19 @@ status_t Sample::doLoad()
         goto error;
     }
 
+    if (mSize == 0 || mSize > decodeHeap->getSize()) {
+        ALOGE("Sample size (%zu) out of range", mSize);
+        status = BAD_VALUE;
+        goto error;
+    }
+
+    mHeap = new MemoryHeapBase(mSize);
+    if (mHeap->getHeapID() < 0) {
+        ALOGE("Unable to allocate %zu bytes for sample %d", mSize, mSampleID);
+        status = NO_MEMORY;
+        goto error;
+    }
+    memcpy(mHeap->getBase(), decodeHeap->getBase(), mSize);
     mData = new MemoryBase(mHeap, 0, mSize);
     mSampleRate = sampleRate;
     mNumChannels = numChannels;
@@ -547,10 +770,22 @@ error:
     return status;
 }
 
+// call with sound pool lock held, returns the bytes released
+size_t Sample::evict()
+{
+    ALOGV("evict sampleID=%d, size=%zu", mSampleID, mSize);
+    // an AudioTrack still holding mData keeps the memory until it is destroyed
+    mData.clear();
+    mHeap.clear();
+    mState = EVICTED;
+    return mSize;
+}
+
 
 void SoundChannel::init(SoundPool* soundPool)
 {
     mSoundPool = soundPool;
+    mMixer = soundPool->mixer();
 }
 
 // call with sound pool lock held
@@ -577,6 +812,23 @@ void SoundChannel::play(const sp<Sample>& sample, int nextChannelID, float leftV
             return;
         }
 
+        if (mMixer != NULL) {
+            // mixed with the other voices of the sound pool, no AudioTrack of its own
+            mPos = 0;
+            mSample = sample;
+            mChannelID = nextChannelID;
+            mPriority = priority;
+            mLoop = loop;
+            mLeftVolume = leftVolume;
+            mRightVolume = rightVolume;
+            mNumChannels = sample->numChannels();
+            mRate = rate;
+            clearNextEvent();
+            mState = PLAYING;
+            mMixer->startVoice(this, sample, leftVolume, rightVolume, loop, rate);
+            return;
+        }
+
         // initialize track
         size_t afFrameCount;
         uint32_t afSampleRate;
@@ -776,7 +1028,11 @@ bool SoundChannel::doStop_l()
     if (mState != IDLE) {
         setVolume_l(0, 0);
         ALOGV("stop");
-        mAudioTrack->stop();
+        if (mMixer != NULL) {
+            mMixer->stopVoice(this);
+        } else {
+            mAudioTrack->stop();
+        }
         mSample.clear();
         mState = IDLE;
         mPriority = IDLE_PRIORITY;
@@ -814,7 +1070,11 @@ void SoundChannel::pause()
     if (mState == PLAYING) {
         ALOGV("pause track");
         mState = PAUSED;
-        mAudioTrack->pause();
+        if (mMixer != NULL) {
+            mMixer->pauseVoice(this, true);
+        } else {
+            mAudioTrack->pause();
+        }
     }
 }
 
@@ -825,7 +1085,11 @@ void SoundChannel::autoPause()
         ALOGV("pause track");
         mState = PAUSED;
         mAutoPaused = true;
-        mAudioTrack->pause();
+        if (mMixer != NULL) {
+            mMixer->pauseVoice(this, true);
+        } else {
+            mAudioTrack->pause();
+        }
     }
 }
 
@@ -836,7 +1100,11 @@ void SoundChannel::resume()
         ALOGV("resume track");
         mState = PLAYING;
         mAutoPaused = false;
-        mAudioTrack->start();
+        if (mMixer != NULL) {
+            mMixer->pauseVoice(this, false);
+        } else {
+            mAudioTrack->start();
+        }
     }
 }
 
@@ -847,14 +1115,21 @@ void SoundChannel::autoResume()
         ALOGV("resume track");
         mState = PLAYING;
         mAutoPaused = false;
-        mAudioTrack->start();
+        if (mMixer != NULL) {
+            mMixer->pauseVoice(this, false);
+        } else {
+            mAudioTrack->start();
+        }
     }
 }
 
 void SoundChannel::setRate(float rate)
 {
     Mutex::Autolock lock(&mLock);
-    if (mAudioTrack != NULL && mSample != 0) {
+    if (mMixer != NULL && mSample != 0) {
+        mMixer->setRate(this, rate);
+        mRate = rate;
+    } else if (mAudioTrack != NULL && mSample != 0) {
         uint32_t sampleRate = uint32_t(float(mSample->sampleRate()) * rate + 0.5);
         mAudioTrack->setSampleRate(sampleRate);
         mRate = rate;
@@ -866,7 +1141,9 @@ void SoundChannel::setVolume_l(float leftVolume, float rightVolume)
 {
     mLeftVolume = leftVolume;
     mRightVolume = rightVolume;
-    if (mAudioTrack != NULL)
+    if (mMixer != NULL)
+        mMixer->setVolume(this, leftVolume, rightVolume);
+    else if (mAudioTrack != NULL)
         mAudioTrack->setVolume(leftVolume, rightVolume);
 }
 
@@ -879,7 +1156,10 @@ void SoundChannel::setVolume(float leftVolume, float rightVolume)
 void SoundChannel::setLoop(int loop)
 {
     Mutex::Autolock lock(&mLock);
-    if (mAudioTrack != NULL && mSample != 0) {
+    if (mMixer != NULL && mSample != 0) {
+        mMixer->setLoop(this, loop);
+        mLoop = loop;
+    } else if (mAudioTrack != NULL && mSample != 0) {
         uint32_t loopEnd = mSample->size()/mNumChannels/
             ((mSample->format() == AUDIO_FORMAT_PCM_16_BIT) ? sizeof(int16_t) : sizeof(uint8_t));
         mAudioTrack->setLoop(0, loopEnd, loop);
@@ -0,0 +1,431 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "SoundPoolMixer"
+#include "utils/Log.h"
+
+#include <audio_utils/primitives.h>
+#include <media/AudioPolicyHelper.h>
+#include <media/AudioSystem.h>
+
+#include "SoundPoolMixer.h"
+
+namespace android {
+
+static const uint32_t kMixerDefaultSampleRate = 44100;
+static const int32_t kUnityVolume = 1 << 12;
+// voices ramp up when started and down when stopped, as a cut in a waveform clicks
+static const int32_t kUnityRamp = 1 << 15;
+static const int32_t kRampFrames = 128;
+static const int32_t kRampStep = kUnityRamp / kRampFrames;
+
+static inline int32_t toQ15(int16_t sample) {
+    return sample;
+}
+
+static inline int32_t toQ15(uint8_t sample) {
+    return ((int32_t)sample - 0x80) << 8;
+}
+
+// Adds frameCount frames of a voice to out, stereo, resampled with linear interpolation.
+// Returns the number of frames added, less than frameCount if the voice ended or faded out.
+template <typename T, int CHANNELS>
+static size_t mixVoice(int32_t* out, size_t frameCount, const T* data, size_t frames,
+        uint64_t* position, uint64_t step, const int32_t* volume, int* loop, int32_t* ramp,
+        int32_t* rampStep)
+{
+    uint64_t pos = *position;
+    size_t i = 0;
+    while (i < frameCount) {
+        size_t index = pos >> 32;
+        if (index >= frames) {
+            if (*loop == 0 || frames == 0) {
+                break;
+            }
+            if (*loop > 0) {
+                (*loop)--;
+            }
+            pos -= (uint64_t)frames << 32;
+            continue;
+        }
+        size_t next = index + 1;
+        if (next >= frames) {
+            next = *loop != 0 ? 0 : index;
+        }
+        const int32_t frac = (uint32_t)pos >> 17;     // Q0.15
+        int32_t left = toQ15(data[index * CHANNELS]);
+        left += ((toQ15(data[next * CHANNELS]) - left) * frac) >> 15;
+        int32_t right = left;
+        if (CHANNELS == 2) {
+            right = toQ15(data[index * CHANNELS + 1]);
+            right += ((toQ15(data[next * CHANNELS + 1]) - right) * frac) >> 15;
+        }
+        left = (left * volume[0]) >> 12;
+        right = (right * volume[1]) >> 12;
+        if (*ramp != kUnityRamp) {
+            left = (left * *ramp) >> 15;
+            right = (right * *ramp) >> 15;
+        }
+        out[2 * i] += left;
+        out[2 * i + 1] += right;
+        pos += step;
+        i++;
+        if (*rampStep != 0) {
+            *ramp += *rampStep;
+            if (*ramp >= kUnityRamp) {
+                *ramp = kUnityRamp;
+                *rampStep = 0;
+            } else if (*ramp <= 0) {
+                *ramp = 0;
+                break;
+            }
+        }
+    }
+    *position = pos;
+    return i;
+}
+
+SoundPoolMixer::SoundPoolMixer(SoundPool* soundPool, int maxVoices) :
+    mSoundPool(soundPool), mStatus(NO_INIT), mSampleRate(0), mMaxVoices(maxVoices),
+    mNumVoices(0), mTrackStarted(false), mMixBuffer(NULL), mMixFrameCount(0)
+{
+    mVoices = new Voice[mMaxVoices];
+    for (int i = 0; i < mMaxVoices; ++i) {
+        mVoices[i].mChannel = NULL;
+        mVoices[i].mRamp = 0;
+    }
+    mDoneChannels = new SoundChannel*[mMaxVoices];
+
+    audio_stream_type_t streamType = audio_attributes_to_stream_type(soundPool->attributes());
+    if (AudioSystem::getOutputSamplingRate(&mSampleRate, streamType) != NO_ERROR) {
+        mSampleRate = kMixerDefaultSampleRate;
+    }
+    // at the output sample rate so that the track can be a fast track
+    mAudioTrack = new AudioTrack(streamType, mSampleRate, AUDIO_FORMAT_PCM_16_BIT,
+            AUDIO_CHANNEL_OUT_STEREO, 0, AUDIO_OUTPUT_FLAG_FAST, callback, this);
+    mStatus = mAudioTrack->initCheck();
+    if (mStatus != NO_ERROR) {
+        ALOGE("Error creating AudioTrack");
+        mAudioTrack.clear();
+        return;
+    }
+    // the callback never asks for more than the track buffer, but process by chunks anyway
+    mMixFrameCount = mAudioTrack->frameCount();
+    mMixBuffer = new int32_t[mMixFrameCount * 2];
+    ALOGV("mixer: %d voices, %u Hz, %zu frames", mMaxVoices, mSampleRate, mMixFrameCount);
+}
+
+SoundPoolMixer::~SoundPoolMixer()
+{
+    // do not hold mLock: the AudioTrack destructor waits for the callback thread to exit
+    if (mAudioTrack != 0) {
+        mAudioTrack->stop();
+        mAudioTrack.clear();
+    }
+    delete[] mMixBuffer;
+    delete[] mDoneChannels;
+    delete[] mVoices;
+}
+
+// call with lock held
+SoundPoolMixer::Voice* SoundPoolMixer::findVoice_l(SoundChannel* channel)
+{
+    for (int i = 0; i < mMaxVoices; ++i) {
+        if (mVoices[i].mChannel == channel) {
+            return &mVoices[i];
+        }
+    }
+    return NULL;
+}
+
+// call with lock held
+uint64_t SoundPoolMixer::step_l(const sp<Sample>& sample, float rate)
+{
+    return (uint64_t)((double)sample->sampleRate() * rate / mSampleRate * 4294967296.0 + 0.5);
+}
+
+// call with lock held
+SoundPoolMixer::Voice* SoundPoolMixer::findFreeVoice_l()
+{
+    Voice* fading = NULL;
+    for (int i = 0; i < mMaxVoices; ++i) {
+        if (mVoices[i].mChannel == NULL) {
+            if (mVoices[i].mRamp == 0) {
+                return &mVoices[i];
+            }
+            fading = &mVoices[i];
+        }
+    }
+    // all the other voices play: cut one which is fading out
+    if (fading != NULL) {
+        fading->mRamp = 0;
+    }
+    return fading;
+}
+
+// call with lock held; the voice fades out unless it is silent
+void SoundPoolMixer::releaseVoice_l(Voice* voice)
+{
+    voice->mChannel = NULL;
+    mNumVoices--;
+    if (voice->mPaused || voice->mDone) {
+        voice->mRamp = 0;
+    } else {
+        voice->mRampStep = -kRampStep;
+    }
+}
+
+// call with lock held
+bool SoundPoolMixer::isActive_l()
+{
+    for (int i = 0; i < mMaxVoices; ++i) {
+        if (mVoices[i].mChannel != NULL ? !mVoices[i].mPaused : mVoices[i].mRamp > 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// control methods are serialized by the sound pool lock, so the track is started and
+// stopped without mLock
+void SoundPoolMixer::updateTrack()
+{
+    bool active, hasVoices;
+    // released after the lock, they may be the last references
+    Vector< sp<Sample> > samples;
+    Vector< sp<IMemory> > data;
+    {
+        Mutex::Autolock lock(&mLock);
+        for (int i = 0; i < mMaxVoices; ++i) {
+            Voice* voice = &mVoices[i];
+            if (voice->mChannel == NULL && voice->mRamp == 0 && voice->mSample != 0) {
+                samples.add(voice->mSample);
+                data.add(voice->mData);
+                voice->mSample.clear();
+                voice->mData.clear();
+            }
+        }
+        active = isActive_l();
+        hasVoices = mNumVoices > 0;
+    }
+    if (active == mTrackStarted) {
+        return;
+    }
+    mTrackStarted = active;
+    if (active) {
+        ALOGV("start track");
+        mAudioTrack->start();
+    } else if (hasVoices) {
+        // the paused voices resume with the mix left in the track
+        ALOGV("pause track");
+        mAudioTrack->pause();
+    } else {
+        // do not play the stale mix when the next voice starts
+        ALOGV("stop track");
+        mAudioTrack->stop();
+        mAudioTrack->flush();
+    }
+}
+
+static int32_t toVolume(float volume)
+{
+    if (volume <= 0.0f) {
+        return 0;
+    }
+    if (volume >= 1.0f) {
+        return kUnityVolume;
+    }
+    return (int32_t)(volume * kUnityVolume + 0.5f);
+}
+
+void SoundPoolMixer::startVoice(SoundChannel* channel, const sp<Sample>& sample,
+        float leftVolume, float rightVolume, int loop, float rate)
+{
+    // the sample and data of a reused voice are released after the lock
+    sp<Sample> oldSample;
+    sp<IMemory> oldData;
+    {
+        Mutex::Autolock lock(&mLock);
+        // the previous sound of the channel fades out on a voice of its own
+        Voice* voice = findVoice_l(channel);
+        if (voice != NULL) {
+            releaseVoice_l(voice);
+        }
+        // never NULL as the voices are allocated for all the channels
+        voice = findFreeVoice_l();
+        oldSample = voice->mSample;
+        oldData = voice->mData;
+        mNumVoices++;
+        size_t sampleSize = sample->numChannels() *
+                ((sample->format() == AUDIO_FORMAT_PCM_16_BIT) ? sizeof(int16_t) : sizeof(uint8_t));
+        voice->mChannel = channel;
+        voice->mSample = sample;
+        voice->mData = sample->getIMemory();
+        voice->mFrameCount = sample->size() / sampleSize;
+        voice->mPosition = 0;
+        voice->mStep = step_l(sample, rate);
+        voice->mVolume[0] = toVolume(leftVolume);
+        voice->mVolume[1] = toVolume(rightVolume);
+        voice->mRamp = 0;
+        voice->mRampStep = kRampStep;
+        voice->mLoop = loop;
+        voice->mPaused = false;
+        voice->mDone = false;
+    }
+    updateTrack();
+}
+
+void SoundPoolMixer::stopVoice(SoundChannel* channel)
+{
+    {
+        Mutex::Autolock lock(&mLock);
+        Voice* voice = findVoice_l(channel);
+        if (voice != NULL) {
+            releaseVoice_l(voice);
+        }
+    }
+    updateTrack();
+}
+
+void SoundPoolMixer::pauseVoice(SoundChannel* channel, bool paused)
+{
+    {
+        Mutex::Autolock lock(&mLock);
+        Voice* voice = findVoice_l(channel);
+        if (voice != NULL) {
+            voice->mPaused = paused;
+        }
+    }
+    updateTrack();
+}
+
+void SoundPoolMixer::setVolume(SoundChannel* channel, float leftVolume, float rightVolume)
+{
+    Mutex::Autolock lock(&mLock);
+    Voice* voice = findVoice_l(channel);
+    if (voice != NULL) {
+        voice->mVolume[0] = toVolume(leftVolume);
+        voice->mVolume[1] = toVolume(rightVolume);
+    }
+}
+
+void SoundPoolMixer::setRate(SoundChannel* channel, float rate)
+{
+    Mutex::Autolock lock(&mLock);
+    Voice* voice = findVoice_l(channel);
+    if (voice != NULL) {
+        voice->mStep = step_l(voice->mSample, rate);
+    }
+}
+
+void SoundPoolMixer::setLoop(SoundChannel* channel, int loop)
+{
+    Mutex::Autolock lock(&mLock);
+    Voice* voice = findVoice_l(channel);
+    if (voice != NULL) {
+        voice->mLoop = loop;
+    }
+}
+
+void SoundPoolMixer::callback(int event, void* user, void *info)
+{
+    SoundPoolMixer* mixer = static_cast<SoundPoolMixer*>(user);
+
+    if (event == AudioTrack::EVENT_MORE_DATA) {
+        AudioTrack::Buffer* b = static_cast<AudioTrack::Buffer *>(info);
+        size_t frameCount = b->frameCount;
+        int16_t* out = b->i16;
+        while (frameCount > 0) {
+            size_t frames = frameCount;
+            if (frames > mixer->mMixFrameCount) {
+                frames = mixer->mMixFrameCount;
+            }
+            if (mixer->process(out, frames)) {
+                // like the stop list, the sound pool thread stops the track
+                mixer->mSoundPool->mixerIdle();
+            }
+            out += frames * 2;
+            frameCount -= frames;
+        }
+        b->size = b->frameCount * sizeof(int16_t) * 2;
+    } else {
+        ALOGV("callback event %d", event);
+    }
+}
+
+// returns true if the last voice playing has faded out
+bool SoundPoolMixer::process(int16_t* out, size_t frameCount)
+{
+    int numDone = 0;
+    bool idle = false;
+    {
+        Mutex::Autolock lock(&mLock);
+        memset(mMixBuffer, 0, frameCount * 2 * sizeof(int32_t));
+        bool faded = false;
+        for (int i = 0; i < mMaxVoices; ++i) {
+            Voice* voice = &mVoices[i];
+            if (voice->mChannel == NULL ? voice->mRamp == 0 : voice->mPaused || voice->mDone) {
+                continue;
+            }
+            const sp<Sample>& sample = voice->mSample;
+            size_t mixed;
+            if (sample->format() == AUDIO_FORMAT_PCM_16_BIT) {
+                const int16_t* data = (const int16_t*)voice->mData->pointer();
+                mixed = sample->numChannels() == 2 ?
+                        mixVoice<int16_t, 2>(mMixBuffer, frameCount, data, voice->mFrameCount,
+                                &voice->mPosition, voice->mStep, voice->mVolume, &voice->mLoop,
+                                &voice->mRamp, &voice->mRampStep) :
+                        mixVoice<int16_t, 1>(mMixBuffer, frameCount, data, voice->mFrameCount,
+                                &voice->mPosition, voice->mStep, voice->mVolume, &voice->mLoop,
+                                &voice->mRamp, &voice->mRampStep);
+            } else {
+                const uint8_t* data = (const uint8_t*)voice->mData->pointer();
+                mixed = sample->numChannels() == 2 ?
+                        mixVoice<uint8_t, 2>(mMixBuffer, frameCount, data, voice->mFrameCount,
+                                &voice->mPosition, voice->mStep, voice->mVolume, &voice->mLoop,
+                                &voice->mRamp, &voice->mRampStep) :
+                        mixVoice<uint8_t, 1>(mMixBuffer, frameCount, data, voice->mFrameCount,
+                                &voice->mPosition, voice->mStep, voice->mVolume, &voice->mLoop,
+                                &voice->mRamp, &voice->mRampStep);
+            }
+            if (voice->mChannel == NULL) {
+                // fading out: the voice is free once silent, its sample is released by
+                // updateTrack()
+                if (mixed < frameCount || voice->mRamp == 0) {
+                    voice->mRamp = 0;
+                    faded = true;
+                }
+            } else if (mixed < frameCount) {
+                voice->mDone = true;
+                mDoneChannels[numDone++] = voice->mChannel;
+            }
+        }
+        for (size_t i = 0; i < frameCount * 2; ++i) {
+            out[i] = clamp16(mMixBuffer[i]);
+        }
+        idle = faded && !isActive_l();
+    }
+
+    // like EVENT_BUFFER_END of a channel AudioTrack, the sound pool thread stops the channel
+    for (int i = 0; i < numDone; ++i) {
+        ALOGV("voice of channel %p done", mDoneChannels[i]);
+        mSoundPool->addToStopList(mDoneChannels[i]);
+    }
+    return idle;
+}
+
+} // end namespace android
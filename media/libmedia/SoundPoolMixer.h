@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOUNDPOOLMIXER_H_
+#define SOUNDPOOLMIXER_H_
+
+#include <utils/threads.h>
+#include <media/AudioTrack.h>
+
+#include <media/SoundPool.h>
+
+namespace android {
+
+/*
+ * This class mixes the voices of all the SoundChannels of a SoundPool
+ * into a single AudioTrack, instead of one AudioTrack per channel.
+ * Control methods are called with the sound pool lock held.
+ */
+class SoundPoolMixer {
+public:
+    SoundPoolMixer(SoundPool* soundPool, int maxVoices);
+    ~SoundPoolMixer();
+    status_t initCheck() { return mStatus; }
+
+    void startVoice(SoundChannel* channel, const sp<Sample>& sample, float leftVolume,
+            float rightVolume, int loop, float rate);
+    void stopVoice(SoundChannel* channel);
+    void pauseVoice(SoundChannel* channel, bool paused);
+    void setVolume(SoundChannel* channel, float leftVolume, float rightVolume);
+    void setRate(SoundChannel* channel, float rate);
+    void setLoop(SoundChannel* channel, int loop);
+
+    // starts the track when a voice plays, and pauses it when all the voices are paused
+    // or stops and flushes it when none is left. Also called from the sound pool thread
+    // once the last voice has faded out.
+    void updateTrack();
+
+private:
+    struct Voice {
+        SoundChannel*   mChannel;       // NULL if the voice is free or fading out
+        sp<Sample>      mSample;        // kept until updateTrack() once the voice is free
+        sp<IMemory>     mData;          // decoded data of mSample, which may be evicted
+        size_t          mFrameCount;
+        uint64_t        mPosition;      // Q32.32 frames
+        uint64_t        mStep;          // Q32.32 frames per output frame
+        int32_t         mVolume[2];     // Q4.12
+        int32_t         mRamp;          // Q0.15 gain ramped at start and stop
+        int32_t         mRampStep;      // added to mRamp for each frame, < 0 when fading out
+        int             mLoop;
+        bool            mPaused;
+        bool            mDone;          // reached the end, waiting for stopVoice()
+    };
+
+    static void callback(int event, void* user, void *info);
+    bool process(int16_t* out, size_t frameCount);
+    Voice* findVoice_l(SoundChannel* channel);
+    Voice* findFreeVoice_l();
+    void releaseVoice_l(Voice* voice);
+    uint64_t step_l(const sp<Sample>& sample, float rate);
+    bool isActive_l();
+
+    SoundPool*          mSoundPool;
+    sp<AudioTrack>      mAudioTrack;
+    status_t            mStatus;
+    uint32_t            mSampleRate;
+    Mutex               mLock;
+    Voice*              mVoices;
+    int                 mMaxVoices;
+    int                 mNumVoices;     // voices started and not stopped
+    bool                mTrackStarted;  // serialized by the sound pool lock, as the controls
+    int32_t*            mMixBuffer;
+    size_t              mMixFrameCount;
+    SoundChannel**      mDoneChannels;
+};
+
+} // end namespace android
+
+#endif /*SOUNDPOOLMIXER_H_*/
@@ -31,7 +31,7 @@ void SoundPoolThread::write(SoundPoolMsg msg) {
     // if thread is quitting, don't add to queue
     if (mRunning) {
         mMsgQueue.push(msg);
-        mCondition.signal();
+        mCondition.broadcast();
     }
 }
 
@@ -42,7 +42,8 @@ const SoundPoolMsg SoundPoolThread::read() {
     }
     SoundPoolMsg msg = mMsgQueue[0];
     mMsgQueue.removeAt(0);
-    mCondition.signal();
+    // writers, readers and quit() wait on the same condition
+    mCondition.broadcast();
     return msg;
 }
 
@@ -51,20 +52,29 @@ void SoundPoolThread::quit() {
     if (mRunning) {
         mRunning = false;
         mMsgQueue.clear();
-        mMsgQueue.push(SoundPoolMsg(SoundPoolMsg::KILL, 0));
-        mCondition.signal();
-        mCondition.wait(mLock);
+        for (int i = 0; i < mNumThreads; i++) {
+            mMsgQueue.push(SoundPoolMsg(SoundPoolMsg::KILL, 0));
+        }
+        mCondition.broadcast();
+        while (mNumThreads > 0) {
+            mCondition.wait(mLock);
+        }
     }
     ALOGV("return from quit");
 }
 
-SoundPoolThread::SoundPoolThread(SoundPool* soundPool) :
-    mSoundPool(soundPool)
+SoundPoolThread::SoundPoolThread(SoundPool* soundPool, int numThreads) :
+    mSoundPool(soundPool), mRunning(false), mNumThreads(0)
 {
+    Mutex::Autolock lock(&mLock);
     mMsgQueue.setCapacity(maxMessages);
-    if (createThreadEtc(beginThread, this, "SoundPoolThread")) {
-        mRunning = true;
+    for (int i = 0; i < numThreads; i++) {
+        if (createThreadEtc(beginThread, this, "SoundPoolThread")) {
+            mNumThreads++;
+        }
     }
+    mRunning = mNumThreads > 0;
+    ALOGV("%d decode threads", mNumThreads);
 }
 
 SoundPoolThread::~SoundPoolThread()
@@ -80,15 +90,21 @@ int SoundPoolThread::beginThread(void* arg) {
 
 int SoundPoolThread::run() {
     ALOGV("run");
+    // reused by the samples decoded on this thread, each keeps a copy of its size
+    sp<MemoryHeapBase> decodeHeap;
     for (;;) {
         SoundPoolMsg msg = read();
         ALOGV("Got message m=%d, mData=%d", msg.mMessageType, msg.mData);
         switch (msg.mMessageType) {
-        case SoundPoolMsg::KILL:
+        case SoundPoolMsg::KILL: {
             ALOGV("goodbye");
+            Mutex::Autolock lock(&mLock);
+            mNumThreads--;
+            mCondition.broadcast();
             return NO_ERROR;
+        }
         case SoundPoolMsg::LOAD_SAMPLE:
-            doLoadSample(msg.mData);
+            doLoadSample(msg.mData, decodeHeap);
             break;
         default:
             ALOGW("run: Unrecognized message %d\n",
@@ -102,11 +118,14 @@ void SoundPoolThread::loadSample(int sampleID) {
     write(SoundPoolMsg(SoundPoolMsg::LOAD_SAMPLE, sampleID));
 }
 
-void SoundPoolThread::doLoadSample(int sampleID) {
+void SoundPoolThread::doLoadSample(int sampleID, sp<MemoryHeapBase>& decodeHeap) {
     sp <Sample> sample = mSoundPool->findSample(sampleID);
     status_t status = -1;
     if (sample != 0) {
-        status = sample->doLoad();
+        status = sample->doLoad(decodeHeap);
+        if (status == NO_ERROR) {
+            mSoundPool->sampleLoaded(sampleID);
+        }
     }
     mSoundPool->notify(SoundPoolEvent(SoundPoolEvent::SAMPLE_LOADED, sampleID, status));
 }
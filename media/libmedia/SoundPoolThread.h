@@ -37,10 +37,11 @@ public:
 
 /*
  * This class handles background requests from the SoundPool
+ * on a pool of threads, so that several samples are decoded at once
  */
 class SoundPoolThread {
 public:
-    SoundPoolThread(SoundPool* SoundPool);
+    SoundPoolThread(SoundPool* SoundPool, int numThreads);
     ~SoundPoolThread();
     void loadSample(int sampleID);
     void quit();
@@ -51,7 +52,7 @@ private:
 
     static int beginThread(void* arg);
     int run();
-    void doLoadSample(int sampleID);
+    void doLoadSample(int sampleID, sp<MemoryHeapBase>& decodeHeap);
     const SoundPoolMsg read();
 
     Mutex                   mLock;
@@ -59,6 +60,7 @@ private:
     Vector<SoundPoolMsg>    mMsgQueue;
     SoundPool*              mSoundPool;
     bool                    mRunning;
+    int                     mNumThreads;    // threads which have not exited yet
 };
 
 } // end namespace android
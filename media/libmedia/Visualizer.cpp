@@ -24,6 +24,7 @@
 #include <sys/types.h>
 #include <limits.h>
 
+#include <cutils/atomic.h>
 #include <cutils/bitops.h>
 
 #include <media/Visualizer.h>
@@ -45,7 +46,11 @@ Visualizer::Visualizer (int32_t priority,
         mScalingMode(VISUALIZER_SCALING_MODE_NORMALIZED),
         mMeasurementMode(MEASUREMENT_MODE_NONE),
         mCaptureCallBack(NULL),
-        mCaptureCbkUser(NULL)
+        mCaptureCbkUser(NULL),
+        mFloatCaptureSize(0),
+        mSpectrumSize(0),
+        mSpectrumOverlap(0),
+        mSpectrumAveraging(1)
 {
     initCaptureSize();
 }
@@ -328,6 +333,151 @@ status_t Visualizer::doFft(uint8_t *fft, uint8_t *waveform)
     return NO_ERROR;
 }
 
+status_t Visualizer::setFloatCaptureSize(uint32_t size)
+{
+    if (size != 0 && (size > VISUALIZER_FLOAT_CAPTURE_SIZE_MAX ||
+            size < VISUALIZER_FLOAT_CAPTURE_SIZE_MIN ||
+            popcount(size) != 1)) {
+        return BAD_VALUE;
+    }
+
+    Mutex::Autolock _l(mCaptureLock);
+    status_t status = setParameter32(VISUALIZER_PARAM_FLOAT_CAPTURE_SIZE, size);
+    ALOGV("setFloatCaptureSize size %d status %d", size, status);
+    if (status == NO_ERROR) {
+        mFloatCaptureSize = size;
+    }
+    return status;
+}
+
+status_t Visualizer::getFloatWaveForm(float *waveform)
+{
+    if (waveform == NULL) {
+        return BAD_VALUE;
+    }
+    if (mFloatCaptureSize == 0) {
+        return NO_INIT;
+    }
+
+    status_t status = NO_ERROR;
+    if (mEnabled) {
+        uint32_t replySize = mFloatCaptureSize * sizeof(float);
+        status = command(VISUALIZER_CMD_CAPTURE_FLOAT, 0, NULL, &replySize, waveform);
+        ALOGV("getFloatWaveForm() command returned %d", status);
+        if ((status == NO_ERROR) && (replySize == 0)) {
+            status = NOT_ENOUGH_DATA;
+        }
+    } else {
+        ALOGV("getFloatWaveForm() disabled");
+        memset(waveform, 0, mFloatCaptureSize * sizeof(float));
+    }
+    return status;
+}
+
+status_t Visualizer::setSpectrumMode(uint32_t size, uint32_t overlap, uint32_t averaging)
+{
+    if (size != 0 && (size > VISUALIZER_SPECTRUM_SIZE_MAX ||
+            size < VISUALIZER_SPECTRUM_SIZE_MIN ||
+            popcount(size) != 1)) {
+        return BAD_VALUE;
+    }
+    if ((overlap != 0 && overlap != 50 && overlap != 75) ||
+            averaging == 0 || averaging > VISUALIZER_SPECTRUM_AVERAGING_MAX) {
+        return BAD_VALUE;
+    }
+
+    Mutex::Autolock _l(mCaptureLock);
+    return setSpectrumMode_l(size, overlap, averaging);
+}
+
+status_t Visualizer::setSpectrumMode_l(uint32_t size, uint32_t overlap, uint32_t averaging)
+{
+    status_t status = setParameter32(VISUALIZER_PARAM_SPECTRUM_OVERLAP, overlap);
+    if (status == NO_ERROR) {
+        status = setParameter32(VISUALIZER_PARAM_SPECTRUM_AVERAGING, averaging);
+    }
+    if (status == NO_ERROR) {
+        status = setParameter32(VISUALIZER_PARAM_SPECTRUM_SIZE, size);
+    }
+    ALOGV("setSpectrumMode size %d overlap %d averaging %d status %d",
+            size, overlap, averaging, status);
+    if (status != NO_ERROR) {
+        return status;
+    }
+    mSpectrumOverlap = overlap;
+    mSpectrumAveraging = averaging;
+    mSpectrumSize = size;
+
+    // the memory is replaced as it is sized for one window size
+    mSpectrumMemory.clear();
+    if (size != 0) {
+        mSpectrumMemory = getDataMemory(VISUALIZER_SPECTRUM_BUFFER_SIZE(size));
+        if (mSpectrumMemory == 0) {
+            ALOGE("setSpectrumMode() could not get the spectrum memory");
+            setParameter32(VISUALIZER_PARAM_SPECTRUM_SIZE, 0);
+            mSpectrumSize = 0;
+            return NO_MEMORY;
+        }
+    }
+    return NO_ERROR;
+}
+
+status_t Visualizer::getSpectrum(float *bins, int32_t *sequence, uint32_t *costNs)
+{
+    if (bins == NULL || sequence == NULL) {
+        return BAD_VALUE;
+    }
+
+    Mutex::Autolock _l(mCaptureLock);
+    if (mSpectrumMemory == 0) {
+        return NO_INIT;
+    }
+    visualizer_spectrum_cblk_t *cblk =
+            static_cast<visualizer_spectrum_cblk_t *>(mSpectrumMemory->pointer());
+    const uint32_t binCount = mSpectrumSize / 2 + 1;
+
+    // the effect only holds the sequence odd for the time of a copy, it never blocks
+    for (int tries = 0; tries < SPECTRUM_READ_TRIES_MAX; tries++) {
+        const int32_t seq = android_atomic_acquire_load(&cblk->sequence);
+        if (seq == *sequence) {
+            return WOULD_BLOCK;
+        }
+        if (seq & 1) {
+            continue;
+        }
+        if (cblk->binCount != binCount) {
+            return NOT_ENOUGH_DATA;
+        }
+        memcpy(bins, cblk->bins, binCount * sizeof(float));
+        const uint32_t cost = cblk->costNs;
+        android_memory_barrier();
+        if (android_atomic_acquire_load(&cblk->sequence) == seq) {
+            *sequence = seq;
+            if (costNs != NULL) {
+                *costNs = cost;
+            }
+            return NO_ERROR;
+        }
+    }
+    return WOULD_BLOCK;
+}
+
+status_t Visualizer::setParameter32(int32_t param, uint32_t value)
+{
+    uint32_t buf32[sizeof(effect_param_t) / sizeof(uint32_t) + 2];
+    effect_param_t *p = (effect_param_t *)buf32;
+
+    p->psize = sizeof(uint32_t);
+    p->vsize = sizeof(uint32_t);
+    *(int32_t *)p->data = param;
+    *((int32_t *)p->data + 1) = value;
+    status_t status = setParameter(p);
+    if (status == NO_ERROR) {
+        status = p->status;
+    }
+    return status;
+}
+
 void Visualizer::periodicCapture()
 {
     Mutex::Autolock _l(mCaptureLock);
@@ -398,6 +548,13 @@ void Visualizer::controlStatusChanged(bool controlGranted) {
         setScalingMode(mScalingMode);
         ALOGV("    capture size reset to %d", mCaptureSize);
         setCaptureSize(mCaptureSize);
+        if (mFloatCaptureSize != 0) {
+            setFloatCaptureSize(mFloatCaptureSize);
+        }
+        if (mSpectrumSize != 0) {
+            Mutex::Autolock _l(mCaptureLock);
+            setSpectrumMode_l(mSpectrumSize, mSpectrumOverlap, mSpectrumAveraging);
+        }
     }
     AudioEffect::controlStatusChanged(controlGranted);
 }
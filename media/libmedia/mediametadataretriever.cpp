@@ -140,6 +140,19 @@ sp<IMemory> MediaMetadataRetriever::getFrameAtTime(int64_t timeUs, int option)
     return mRetriever->getFrameAtTime(timeUs, option);
 }
 
+sp<IMemory> MediaMetadataRetriever::getThumbnailAtTime(
+        int64_t timeUs, int option, int maxWidth, int maxHeight)
+{
+    ALOGV("getThumbnailAtTime: time(%" PRId64 " us) option(%d) max %dx%d",
+            timeUs, option, maxWidth, maxHeight);
+    Mutex::Autolock _l(mLock);
+    if (mRetriever == 0) {
+        ALOGE("retriever is not initialized");
+        return NULL;
+    }
+    return mRetriever->getThumbnailAtTime(timeUs, option, maxWidth, maxHeight);
+}
+
 const char* MediaMetadataRetriever::extractMetadata(int keyCode)
 {
     ALOGV("extractMetadata(%d)", keyCode);
@@ -162,6 +175,40 @@ sp<IMemory> MediaMetadataRetriever::extractAlbumArt()
     return mRetriever->extractAlbumArt();
 }
 
+status_t MediaMetadataRetriever::extractMetadataBatch(
+        const Vector<MetadataBatchRequest> &requests,
+        const Vector<int> &keyCodes,
+        int thumbnailMaxWidth, int thumbnailMaxHeight,
+        Vector<MetadataBatchResult> *results)
+{
+    ALOGV("extractMetadataBatch: %zu files, %zu keys, max %dx%d",
+            requests.size(), keyCodes.size(), thumbnailMaxWidth, thumbnailMaxHeight);
+    Mutex::Autolock _l(mLock);
+    if (mRetriever == 0) {
+        ALOGE("retriever is not initialized");
+        return INVALID_OPERATION;
+    }
+    results->clear();
+    for (size_t start = 0; start < requests.size();
+            start += IMediaMetadataRetriever::kMaxBatchSize) {
+        size_t count = requests.size() - start;
+        if (count > IMediaMetadataRetriever::kMaxBatchSize) {
+            count = IMediaMetadataRetriever::kMaxBatchSize;
+        }
+        Vector<MetadataBatchRequest> chunk;
+        chunk.appendArray(requests.array() + start, count);
+
+        Vector<MetadataBatchResult> chunkResults;
+        status_t err = mRetriever->extractMetadataBatch(
+                chunk, keyCodes, thumbnailMaxWidth, thumbnailMaxHeight, &chunkResults);
+        if (err != NO_ERROR) {
+            return err;
+        }
+        results->appendVector(chunkResults);
+    }
+    return NO_ERROR;
+}
+
 void MediaMetadataRetriever::DeathNotifier::binderDied(const wp<IBinder>& who __unused) {
     Mutex::Autolock lock(MediaMetadataRetriever::sServiceLock);
     MediaMetadataRetriever::sService.clear();
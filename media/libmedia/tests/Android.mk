@@ -0,0 +1,23 @@
+# Build the unit tests.
+LOCAL_PATH:= $(call my-dir)
+include $(CLEAR_VARS)
+LOCAL_ADDITIONAL_DEPENDENCIES := $(LOCAL_PATH)/Android.mk
+
+LOCAL_MODULE := MediaScanner_test
+
+LOCAL_MODULE_TAGS := tests
+
+LOCAL_SRC_FILES := \
+	MediaScanner_test.cpp \
+
+LOCAL_SHARED_LIBRARIES := \
+	libmedia \
+	libutils \
+	liblog
+
+LOCAL_C_INCLUDES := \
+	frameworks/av/include \
+
+LOCAL_32_BIT_ONLY := true
+
+include $(BUILD_NATIVE_TEST)
@@ -0,0 +1,154 @@
+/*
+ * Copyright 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "MediaScanner_test"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+#include <media/mediascanner.h>
+#include <utils/String8.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+// Reports every file as scanned without looking at its contents.
+class NullMediaScanner : public MediaScanner {
+public:
+    virtual MediaScanResult processFile(
+            const char * /* path */, const char * /* mimeType */,
+            MediaScannerClient & /* client */) {
+        return MEDIA_SCAN_RESULT_OK;
+    }
+
+    virtual MediaAlbumArt *extractAlbumArt(int /* fd */) {
+        return NULL;
+    }
+};
+
+class CountingClient : public MediaScannerClient {
+public:
+    CountingClient() : mNumFiles(0) {}
+
+    virtual status_t scanFile(const char* /* path */, long long /* lastModified */,
+            long long /* fileSize */, bool isDirectory, bool /* noMedia */) {
+        if (!isDirectory) {
+            ++mNumFiles;
+        }
+        return OK;
+    }
+
+    virtual status_t handleStringTag(const char* /* name */, const char* /* value */) {
+        return OK;
+    }
+
+    virtual status_t setMimeType(const char* /* mimeType */) {
+        return OK;
+    }
+
+    size_t mNumFiles;
+};
+
+class MediaScannerTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        char dir[] = "/data/local/tmp/MediaScanner_test-XXXXXX";
+        ASSERT_TRUE(mkdtemp(dir) != NULL);
+        mDir.setTo(dir);
+        mJournalPath = mDir;
+        mJournalPath.append("/journal");
+        mScanner.setParallelScan(1 /* numWorkers */, mJournalPath.string());
+    }
+
+    virtual void TearDown() {
+        for (size_t i = mCreated.size(); i > 0; --i) {
+            const String8 &path = mCreated[i - 1];
+            if (unlink(path.string()) != 0) {
+                rmdir(path.string());
+            }
+        }
+        unlink(mJournalPath.string());
+        rmdir(mDir.string());
+    }
+
+    String8 makeDir(const char *name) {
+        String8 path(mDir);
+        path.appendFormat("/%s", name);
+        EXPECT_EQ(0, mkdir(path.string(), 0755));
+        mCreated.push(path);
+        return path;
+    }
+
+    void makeFile(const String8 &dir, const char *name) {
+        String8 path(dir);
+        path.appendFormat("/%s", name);
+        int fd = open(path.string(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ASSERT_GE(fd, 0);
+        EXPECT_EQ(4, write(fd, "data", 4));
+        close(fd);
+        mCreated.push(path);
+    }
+
+    // Returns how many files the scan of |root| reported to the client.
+    size_t scan(const String8 &root) {
+        CountingClient client;
+        EXPECT_EQ(MEDIA_SCAN_RESULT_OK, mScanner.processDirectory(root.string(), client));
+        return client.mNumFiles;
+    }
+
+    NullMediaScanner mScanner;
+    String8 mDir;
+    String8 mJournalPath;
+    Vector<String8> mCreated;
+};
+
+TEST_F(MediaScannerTest, JournalKeepsEntriesOfOtherRoots) {
+    String8 music = makeDir("music");
+    String8 pictures = makeDir("pictures");
+    makeFile(music, "a.mp3");
+    makeFile(music, "b.mp3");
+    makeFile(pictures, "c.jpg");
+
+    EXPECT_EQ(2u, scan(music));
+    EXPECT_EQ(1u, scan(pictures));
+
+    // Saving the journal after the scan of one root must not drop the other.
+    EXPECT_EQ(0u, scan(music));
+    EXPECT_EQ(0u, scan(pictures));
+
+    makeFile(music, "d.mp3");
+    EXPECT_EQ(1u, scan(music));
+    EXPECT_EQ(0u, scan(pictures));
+    EXPECT_EQ(0u, scan(music));
+}
+
+TEST_F(MediaScannerTest, JournalKeepsRootsSharingAPrefix) {
+    String8 music = makeDir("music");
+    String8 music2 = makeDir("music2");
+    makeFile(music, "a.mp3");
+    makeFile(music2, "b.mp3");
+
+    EXPECT_EQ(1u, scan(music2));
+    EXPECT_EQ(1u, scan(music));
+    EXPECT_EQ(0u, scan(music2));
+}
+
+}  // namespace android
@@ -34,6 +34,7 @@
 #include <media/IMediaHTTPService.h>
 #include <media/MediaMetadataRetrieverInterface.h>
 #include <media/MediaPlayerInterface.h>
+#include <media/stagefright/MediaSource.h>
 #include <private/media/VideoFrame.h>
 #include "MidiMetadataRetriever.h"
 #include "MetadataRetrieverClient.h"
@@ -135,10 +136,11 @@ status_t MetadataRetrieverClient::setDataSource(
     return ret;
 }
 
-status_t MetadataRetrieverClient::setDataSource(int fd, int64_t offset, int64_t length)
+// Picks and sets up a retriever for the given range of fd. The caller keeps
+// ownership of fd; retrievers dup() it when they need to hold on to it.
+static status_t createRetrieverForFd(
+        int fd, int64_t offset, int64_t length, sp<MediaMetadataRetrieverBase> *retriever)
 {
-    ALOGV("setDataSource fd=%d, offset=%lld, length=%lld", fd, offset, length);
-    Mutex::Autolock lock(mLock);
     struct stat sb;
     int ret = fstat(fd, &sb);
     if (ret != 0) {
@@ -153,7 +155,6 @@ status_t MetadataRetrieverClient::setDataSource(int fd, int64_t offset, int64_t
 
     if (offset >= sb.st_size) {
         ALOGE("offset (%lld) bigger than file size (%llu)", offset, sb.st_size);
-        ::close(fd);
         return BAD_VALUE;
     }
     if (offset + length > sb.st_size) {
@@ -169,11 +170,18 @@ status_t MetadataRetrieverClient::setDataSource(int fd, int64_t offset, int64_t
     ALOGV("player type = %d", playerType);
     sp<MediaMetadataRetrieverBase> p = createRetriever(playerType);
     if (p == NULL) {
-        ::close(fd);
         return NO_INIT;
     }
     status_t status = p->setDataSource(fd, offset, length);
-    if (status == NO_ERROR) mRetriever = p;
+    if (status == NO_ERROR) *retriever = p;
+    return status;
+}
+
+status_t MetadataRetrieverClient::setDataSource(int fd, int64_t offset, int64_t length)
+{
+    ALOGV("setDataSource fd=%d, offset=%lld, length=%lld", fd, offset, length);
+    Mutex::Autolock lock(mLock);
+    status_t status = createRetrieverForFd(fd, offset, length, &mRetriever);
     ::close(fd);
     return status;
 }
@@ -192,20 +200,34 @@ sp<IMemory> MetadataRetrieverClient::getFrameAtTime(int64_t timeUs, int option)
         ALOGE("failed to capture a video frame");
         return NULL;
     }
-    size_t size = sizeof(VideoFrame) + frame->mSize;
-    sp<MemoryHeapBase> heap = new MemoryHeapBase(size, 0, "MetadataRetrieverClient");
-    if (heap == NULL) {
-        ALOGE("failed to create MemoryDealer");
-        delete frame;
+    return copyFrame_l(frame);
+}
+
+sp<IMemory> MetadataRetrieverClient::getThumbnailAtTime(
+        int64_t timeUs, int option, int maxWidth, int maxHeight)
+{
+    ALOGV("getThumbnailAtTime: time(%lld us) option(%d) max %dx%d",
+            timeUs, option, maxWidth, maxHeight);
+    Mutex::Autolock lock(mLock);
+    mThumbnail.clear();
+    if (mRetriever == NULL) {
+        ALOGE("retriever is not initialized");
         return NULL;
     }
-    mThumbnail = new MemoryBase(heap, 0, size);
-    if (mThumbnail == NULL) {
-        ALOGE("not enough memory for VideoFrame size=%u", size);
-        delete frame;
+    if (maxWidth <= 0 || maxHeight <= 0) {
+        ALOGE("invalid thumbnail size %dx%d", maxWidth, maxHeight);
         return NULL;
     }
-    VideoFrame *frameCopy = static_cast<VideoFrame *>(mThumbnail->pointer());
+    VideoFrame *frame = mRetriever->getThumbnailAtTime(timeUs, option, maxWidth, maxHeight);
+    if (frame == NULL) {
+        ALOGE("failed to capture a thumbnail");
+        return NULL;
+    }
+    return copyFrame_l(frame);
+}
+
+static void copyVideoFrame(VideoFrame *frameCopy, const VideoFrame *frame)
+{
     frameCopy->mWidth = frame->mWidth;
     frameCopy->mHeight = frame->mHeight;
     frameCopy->mDisplayWidth = frame->mDisplayWidth;
@@ -215,6 +237,25 @@ sp<IMemory> MetadataRetrieverClient::getFrameAtTime(int64_t timeUs, int option)
     ALOGV("rotation: %d", frameCopy->mRotationAngle);
     frameCopy->mData = (uint8_t *)frameCopy + sizeof(VideoFrame);
     memcpy(frameCopy->mData, frame->mData, frame->mSize);
+}
+
+// Moves the frame into shared memory for the client, consumes the frame.
+sp<IMemory> MetadataRetrieverClient::copyFrame_l(VideoFrame *frame)
+{
+    size_t size = sizeof(VideoFrame) + frame->mSize;
+    sp<MemoryHeapBase> heap = new MemoryHeapBase(size, 0, "MetadataRetrieverClient");
+    if (heap == NULL) {
+        ALOGE("failed to create MemoryDealer");
+        delete frame;
+        return NULL;
+    }
+    mThumbnail = new MemoryBase(heap, 0, size);
+    if (mThumbnail == NULL) {
+        ALOGE("not enough memory for VideoFrame size=%u", size);
+        delete frame;
+        return NULL;
+    }
+    copyVideoFrame(static_cast<VideoFrame *>(mThumbnail->pointer()), frame);
     delete frame;  // Fix memory leakage
     return mThumbnail;
 }
@@ -263,4 +304,185 @@ const char* MetadataRetrieverClient::extractMetadata(int keyCode)
     return mRetriever->extractMetadata(keyCode);
 }
 
+// Extra threads extractMetadataBatch() may have running at any one time,
+// across all clients. The calling binder thread always works on its own
+// batch too, so a batch makes progress even when none are available.
+static const size_t kMaxBatchWorkers = 3;
+static Mutex sBatchWorkerLock;
+static size_t sNumBatchWorkers = 0;
+
+// The state of one extractMetadataBatch() call, shared by the threads
+// working on it. Each request is handed to exactly one thread, which then
+// owns the matching entries of mResults and mFrames.
+struct MetadataBatchJob {
+    MetadataBatchJob(
+            const Vector<MetadataBatchRequest> &requests,
+            const Vector<int> &keyCodes,
+            int thumbnailMaxWidth, int thumbnailMaxHeight,
+            MetadataBatchResult *results, VideoFrame **frames)
+        : mRequests(requests),
+          mKeyCodes(keyCodes),
+          mThumbnailMaxWidth(thumbnailMaxWidth),
+          mThumbnailMaxHeight(thumbnailMaxHeight),
+          mResults(results),
+          mFrames(frames),
+          mNext(0) {
+    }
+
+    // Returns false once there are no requests left.
+    bool processNext();
+
+private:
+    const Vector<MetadataBatchRequest> &mRequests;
+    const Vector<int> &mKeyCodes;
+    int mThumbnailMaxWidth;
+    int mThumbnailMaxHeight;
+    MetadataBatchResult *mResults;
+    VideoFrame **mFrames;
+
+    Mutex mLock;
+    size_t mNext;
+};
+
+bool MetadataBatchJob::processNext()
+{
+    size_t index;
+    {
+        Mutex::Autolock lock(mLock);
+        if (mNext >= mRequests.size()) {
+            return false;
+        }
+        index = mNext++;
+    }
+
+    const MetadataBatchRequest &request = mRequests[index];
+    MetadataBatchResult *result = &mResults[index];
+
+    sp<MediaMetadataRetrieverBase> retriever;
+    result->mStatus = createRetrieverForFd(
+            request.mFd, request.mOffset, request.mLength, &retriever);
+    if (result->mStatus != NO_ERROR) {
+        ALOGW("batch request %zu: failed to set data source (%d)", index, result->mStatus);
+        return true;
+    }
+
+    for (size_t i = 0; i < mKeyCodes.size(); ++i) {
+        const char *value = retriever->extractMetadata(mKeyCodes[i]);
+        if (value != NULL) {
+            result->mMetadata.add(mKeyCodes[i], String8(value));
+        }
+    }
+
+    if (mThumbnailMaxWidth > 0 && mThumbnailMaxHeight > 0) {
+        mFrames[index] = retriever->getThumbnailAtTime(
+                -1, MediaSource::ReadOptions::SEEK_CLOSEST_SYNC,
+                mThumbnailMaxWidth, mThumbnailMaxHeight);
+    }
+    return true;
+}
+
+class MetadataBatchWorker : public Thread {
+public:
+    MetadataBatchWorker(MetadataBatchJob *job) : Thread(false), mJob(job) {}
+
+private:
+    virtual bool threadLoop() { return mJob->processNext(); }
+
+    MetadataBatchJob *mJob;
+};
+
+status_t MetadataRetrieverClient::extractMetadataBatch(
+        const Vector<MetadataBatchRequest> &requests,
+        const Vector<int> &keyCodes,
+        int thumbnailMaxWidth, int thumbnailMaxHeight,
+        Vector<MetadataBatchResult> *results)
+{
+    ALOGV("extractMetadataBatch: %zu files, %zu keys, max %dx%d",
+            requests.size(), keyCodes.size(), thumbnailMaxWidth, thumbnailMaxHeight);
+    if (requests.size() > kMaxBatchSize) {
+        return BAD_VALUE;
+    }
+
+    results->clear();
+    if (requests.isEmpty()) {
+        return NO_ERROR;
+    }
+
+    // Size the vector up front and hand out a raw pointer, so that the
+    // workers fill in their own entries without touching the Vector itself.
+    results->insertAt(0, requests.size());
+    Vector<VideoFrame *> frames;
+    frames.insertAt((VideoFrame *)NULL, 0, requests.size());
+
+    MetadataBatchJob job(requests, keyCodes, thumbnailMaxWidth, thumbnailMaxHeight,
+            results->editArray(), frames.editArray());
+
+    size_t numWorkers;
+    {
+        Mutex::Autolock lock(sBatchWorkerLock);
+        numWorkers = kMaxBatchWorkers - sNumBatchWorkers;
+        if (numWorkers > requests.size() - 1) {
+            numWorkers = requests.size() - 1;
+        }
+        sNumBatchWorkers += numWorkers;
+    }
+
+    Vector<sp<MetadataBatchWorker> > workers;
+    for (size_t i = 0; i < numWorkers; ++i) {
+        sp<MetadataBatchWorker> worker = new MetadataBatchWorker(&job);
+        if (worker->run("MetadataBatchWorker", ANDROID_PRIORITY_NORMAL) != OK) {
+            break;
+        }
+        workers.push(worker);
+    }
+
+    while (job.processNext()) {
+    }
+
+    for (size_t i = 0; i < workers.size(); ++i) {
+        workers[i]->requestExitAndWait();
+    }
+
+    {
+        Mutex::Autolock lock(sBatchWorkerLock);
+        sNumBatchWorkers -= numWorkers;
+    }
+
+    // Pack all thumbnails into one heap, so that the reply carries a single
+    // shared memory region however many files were asked for.
+    size_t heapSize = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        if (frames[i] != NULL) {
+            heapSize += (sizeof(VideoFrame) + frames[i]->mSize + 7) & ~7;
+        }
+    }
+
+    sp<MemoryHeapBase> heap;
+    if (heapSize > 0) {
+        heap = new MemoryHeapBase(heapSize, 0, "MetadataRetrieverClient");
+        if (heap->getHeapID() < 0) {
+            ALOGE("failed to allocate %zu bytes for batch thumbnails", heapSize);
+            heap.clear();
+        }
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        VideoFrame *frame = frames[i];
+        if (frame == NULL) {
+            continue;
+        }
+        if (heap != NULL) {
+            size_t size = sizeof(VideoFrame) + frame->mSize;
+            sp<IMemory> thumbnail = new MemoryBase(heap, offset, size);
+            copyVideoFrame(static_cast<VideoFrame *>(thumbnail->pointer()), frame);
+            results->editItemAt(i).mThumbnail = thumbnail;
+            offset += (size + 7) & ~7;
+        }
+        delete frame;
+    }
+
+    return NO_ERROR;
+}
+
 }; // namespace android
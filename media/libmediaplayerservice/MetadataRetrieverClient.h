@@ -50,8 +50,15 @@ public:
 
     virtual status_t                setDataSource(int fd, int64_t offset, int64_t length);
     virtual sp<IMemory>             getFrameAtTime(int64_t timeUs, int option);
+    virtual sp<IMemory>             getThumbnailAtTime(
+            int64_t timeUs, int option, int maxWidth, int maxHeight);
     virtual sp<IMemory>             extractAlbumArt();
     virtual const char*             extractMetadata(int keyCode);
+    virtual status_t                extractMetadataBatch(
+            const Vector<MetadataBatchRequest> &requests,
+            const Vector<int> &keyCodes,
+            int thumbnailMaxWidth, int thumbnailMaxHeight,
+            Vector<MetadataBatchResult> *results);
 
     virtual status_t                dump(int fd, const Vector<String16>& args) const;
 
@@ -61,6 +68,8 @@ private:
     explicit MetadataRetrieverClient(pid_t pid);
     virtual ~MetadataRetrieverClient();
 
+    sp<IMemory> copyFrame_l(VideoFrame *frame);
+
     mutable Mutex                          mLock;
     sp<MediaMetadataRetrieverBase>         mRetriever;
     pid_t                                  mPid;
@@ -322,13 +322,36 @@ nsecs_t VideoFrameScheduler::PLL::addSample(nsecs_t time) {
 
 static const nsecs_t kDefaultVsyncPeriod = kNanosIn1s / 60;  // 60Hz
 static const nsecs_t kVsyncRefreshPeriod = kNanosIn1s;       // 1 sec
+static const nsecs_t kCadenceToleranceDiv = 100;            // 1% of a vsync per cycle
+static const nsecs_t kCadenceKeepToleranceDiv = 4;          // 25% of a vsync per cycle
+static const nsecs_t kJudderBaseWeight = 16;
+static const nsecs_t kCadenceDriftWeight = 16;
+static const nsecs_t kCadenceMaxDriftVsyncs = 2;            // re-anchor beyond this
 
 VideoFrameScheduler::VideoFrameScheduler()
     : mVsyncTime(0),
       mVsyncPeriod(0),
       mVsyncRefreshAt(0),
       mLastVsyncTime(-1),
-      mTimeCorrection(0) {
+      mTimeCorrection(0),
+      mFixedVsync(false),
+      mCadencePeriod(-1),
+      mJudderBase(0),
+      mJudderBaseValid(false),
+      mNumCadenceSamples(0),
+      mFollowingCadence(false),
+      mCadenceAnchored(false),
+      mCadenceIndex(0),
+      mCadenceVsyncBase(0),
+      mCadenceRenderBase(0),
+      mCadenceDrift(0) {
+    memset(&mStats, 0, sizeof(mStats));
+}
+
+void VideoFrameScheduler::setVsync(nsecs_t vsyncTime, nsecs_t vsyncPeriod) {
+    mFixedVsync = true;
+    mVsyncTime = vsyncTime;
+    mVsyncPeriod = vsyncPeriod;
 }
 
 void VideoFrameScheduler::updateVsync() {
@@ -360,12 +383,23 @@ void VideoFrameScheduler::updateVsync() {
 }
 
 void VideoFrameScheduler::init(float videoFps) {
-    updateVsync();
+    if (!mFixedVsync) {
+        updateVsync();
+    }
 
     mLastVsyncTime = -1;
     mTimeCorrection = 0;
 
     mPll.reset(videoFps);
+
+    mCadencePeriod = -1;
+    mJudderBaseValid = false;
+    mNumCadenceSamples = 0;
+    mFollowingCadence = false;
+    mCadenceAnchored = false;
+
+    Mutex::Autolock autoLock(mStatsLock);
+    memset(&mStats, 0, sizeof(mStats));
 }
 
 void VideoFrameScheduler::restart() {
@@ -373,6 +407,180 @@ void VideoFrameScheduler::restart() {
     mTimeCorrection = 0;
 
     mPll.restart();
+
+    mJudderBaseValid = false;
+    mNumCadenceSamples = 0;
+    mFollowingCadence = false;
+    mCadenceAnchored = false;
+}
+
+void VideoFrameScheduler::getStats(Stats *stats) {
+    Mutex::Autolock autoLock(mStatsLock);
+    *stats = mStats;
+}
+
+// Finds the shortest run of frames that spans a whole number of vsyncs, e.g.
+// 2 frames in 5 vsyncs for 24fps on 60Hz (3:2 pulldown), or 5 frames in 12
+// vsyncs for 25fps on 60Hz. A detected cadence is kept while the period
+// estimate, which moves with render time jitter, stays loosely on it; the
+// remaining drift is corrected by applyCadence().
+void VideoFrameScheduler::updateCadence(nsecs_t videoPeriod) {
+    if (videoPeriod == mCadencePeriod) {
+        return;
+    }
+    mCadencePeriod = videoPeriod;
+
+    {
+        Mutex::Autolock autoLock(mStatsLock);
+        nsecs_t cycle = videoPeriod * (nsecs_t)mStats.mCadenceFrames;
+        nsecs_t error = cycle - (nsecs_t)mStats.mCadenceVsyncs * mVsyncPeriod;
+        if (mStats.mCadenceFrames > 0 && abs(error) <= mVsyncPeriod / kCadenceKeepToleranceDiv) {
+            return;
+        }
+    }
+
+    size_t frames = 0;
+    size_t vsyncs = 0;
+    for (size_t n = 1; n <= kMaxCadenceFrames; ++n) {
+        nsecs_t cycle = videoPeriod * n;
+        nsecs_t m = divRound(cycle, mVsyncPeriod);
+        if (m > 0 && abs(cycle - m * mVsyncPeriod) <= mVsyncPeriod / kCadenceToleranceDiv) {
+            frames = n;
+            vsyncs = m;
+            break;
+        }
+    }
+
+    Mutex::Autolock autoLock(mStatsLock);
+    if (frames != mStats.mCadenceFrames || vsyncs != mStats.mCadenceVsyncs) {
+        ALOGV("cadence: %zu vsyncs per %zu frames (period:%lld)",
+                vsyncs, frames, (long long)videoPeriod);
+        mStats.mCadenceFrames = frames;
+        mStats.mCadenceVsyncs = vsyncs;
+        mNumCadenceSamples = 0;
+        mFollowingCadence = false;
+        mCadenceAnchored = false;
+    }
+}
+
+// Picks the vsync of a frame from the detected cadence rather than from the
+// PLL correction, so that frames are repeated or dropped in a fixed pattern:
+// frame i after the anchor frame goes to the vsync closest to i * vsyncs /
+// frames vsyncs after the anchor's, e.g. 3, 2, 3, 2 vsyncs for 24fps on 60Hz
+// or one frame in three dropped for 90fps on 60Hz. The anchor is the PLL's
+// vsync for the first frame after the cadence is detected or the render times
+// jumped, e.g. after a seek. When the render times drift from the cadence on
+// average by more than half a vsync (e.g. 23.976fps on 60Hz), the anchor
+// moves by a vsync, which shows one frame for a vsync more or less.
+nsecs_t VideoFrameScheduler::applyCadence(nsecs_t renderTime, nsecs_t vsyncTime) {
+    nsecs_t frames;
+    nsecs_t vsyncs;
+    {
+        Mutex::Autolock autoLock(mStatsLock);
+        frames = mStats.mCadenceFrames;
+        vsyncs = mStats.mCadenceVsyncs;
+    }
+    if (frames == 0) {
+        mCadenceAnchored = false;
+        return vsyncTime;
+    }
+    nsecs_t index = 0;
+    nsecs_t drift = 0;
+    if (mCadenceAnchored) {
+        if (++mCadenceIndex == (size_t)frames) {
+            mCadenceIndex = 0;
+            mCadenceVsyncBase += vsyncs * mVsyncPeriod;
+            mCadenceRenderBase += vsyncs * mVsyncPeriod;
+        }
+        index = mCadenceIndex;
+        drift = renderTime - mCadenceRenderBase
+                - divRound(index * vsyncs * mVsyncPeriod, frames);
+
+        // render times jumped without the PLL restarting
+        if (abs(drift) > kCadenceMaxDriftVsyncs * mVsyncPeriod) {
+            ALOGV("render time jumped %lld from cadence", (long long)drift);
+            mCadenceAnchored = false;
+        }
+    }
+    if (!mCadenceAnchored) {
+        mCadenceAnchored = true;
+        mCadenceIndex = 0;
+        mCadenceVsyncBase = vsyncTime;
+        mCadenceRenderBase = renderTime;
+        mCadenceDrift = 0;
+        return vsyncTime;
+    }
+
+    mCadenceDrift += (drift - mCadenceDrift) / kCadenceDriftWeight;
+
+    // move on a frame whose vsyncs then stay within the cadence, e.g. a 2 of
+    // 3:2 pulldown becomes a 3, unless the drift reaches a whole vsync
+    nsecs_t previous = index > 0
+            ? divRound((index - 1) * vsyncs, frames)
+            : divRound((frames - 1) * vsyncs, frames) - vsyncs;
+    nsecs_t current = divRound(index * vsyncs, frames) - previous;
+    bool later = mCadenceDrift > 0;
+    bool onCadence = later ? current < divUp(vsyncs, frames) : current > vsyncs / frames;
+    if (abs(mCadenceDrift) > (onCadence ? mVsyncPeriod / 2 : mVsyncPeriod)) {
+        nsecs_t shift = later ? mVsyncPeriod : -mVsyncPeriod;
+        ALOGV("render time drifted %lld from cadence", (long long)mCadenceDrift);
+        mCadenceVsyncBase += shift;
+        mCadenceRenderBase += shift;
+        mCadenceDrift -= shift;
+    }
+    return mCadenceVsyncBase + divRound(index * vsyncs, frames) * mVsyncPeriod;
+}
+
+// Judder is how far a frame's vsync is from its intended render time, relative
+// to the running average of that offset. A steady cadence keeps it below a
+// vsync; drops and repeats show up as jumps of a whole vsync.
+void VideoFrameScheduler::updateStats(
+        nsecs_t renderTime, nsecs_t vsyncTime, size_t vsyncsForLastFrame) {
+    nsecs_t offset = vsyncTime - renderTime;
+    if (!mJudderBaseValid) {
+        mJudderBase = offset;
+        mJudderBaseValid = true;
+    }
+    nsecs_t judder = abs(offset - mJudderBase);
+    mJudderBase += (offset - mJudderBase) / kJudderBaseWeight;
+
+    Mutex::Autolock autoLock(mStatsLock);
+    ++mStats.mNumFrames;
+    mStats.mTotalJudder += judder;
+    if (judder > mStats.mMaxJudder) {
+        mStats.mMaxJudder = judder;
+    }
+
+    ssize_t vsyncs = (ssize_t)vsyncsForLastFrame;
+    if (vsyncs <= 0) {
+        ++mStats.mNumDropped;
+    }
+
+    size_t frames = mStats.mCadenceFrames;
+    nsecs_t maxVsyncs = frames > 0
+            ? divUp((nsecs_t)mStats.mCadenceVsyncs, (nsecs_t)frames)
+            : divUp(mCadencePeriod, mVsyncPeriod);
+    if (vsyncs > maxVsyncs) {
+        ++mStats.mNumRepeated;
+    }
+    if (frames == 0) {
+        return;
+    }
+
+    // on cadence, every run of |frames| frames spans the same number of vsyncs
+    mCadenceHistory[mNumCadenceSamples % kMaxCadenceFrames] = vsyncs < 0 ? 0 : vsyncs;
+    ++mNumCadenceSamples;
+    if (mNumCadenceSamples >= frames) {
+        size_t sum = 0;
+        for (size_t i = 0; i < frames; ++i) {
+            sum += mCadenceHistory[(mNumCadenceSamples - 1 - i) % kMaxCadenceFrames];
+        }
+        bool following = (sum == mStats.mCadenceVsyncs);
+        if (mFollowingCadence && !following) {
+            ++mStats.mNumCadenceBreaks;
+        }
+        mFollowingCadence = following;
+    }
 }
 
 nsecs_t VideoFrameScheduler::getVsyncPeriod() {
@@ -386,7 +594,7 @@ nsecs_t VideoFrameScheduler::schedule(nsecs_t renderTime) {
     nsecs_t origRenderTime = renderTime;
 
     nsecs_t now = systemTime(SYSTEM_TIME_MONOTONIC);
-    if (now >= mVsyncRefreshAt) {
+    if (!mFixedVsync && now >= mVsyncRefreshAt) {
         updateVsync();
     }
 
@@ -407,7 +615,13 @@ nsecs_t VideoFrameScheduler::schedule(nsecs_t renderTime) {
     renderTime -= mVsyncPeriod / 2;
 
     const nsecs_t videoPeriod = mPll.addSample(origRenderTime);
+    if (mPll.restarted()) {
+        // the render times jumped, the old anchor no longer applies
+        mCadenceAnchored = false;
+    }
     if (videoPeriod > 0) {
+        updateCadence(videoPeriod);
+
         // Smooth out rendering
         size_t N = 12;
         nsecs_t fiveSixthDev =
@@ -457,7 +671,15 @@ nsecs_t VideoFrameScheduler::schedule(nsecs_t renderTime) {
                 nextVsyncTime += mVsyncPeriod;
                 ++vsyncsForLastFrame;
             }
+
+            // the cadence, when there is one, overrides the decision above
+            nextVsyncTime = applyCadence(origRenderTime, nextVsyncTime);
+            if (mCadenceAnchored) {
+                renderTime = nextVsyncTime - mVsyncPeriod / 2;
+                vsyncsForLastFrame = divRound(nextVsyncTime - mLastVsyncTime, mVsyncPeriod);
+            }
             ATRACE_INT("FRAME_VSYNCS", vsyncsForLastFrame);
+            updateStats(origRenderTime, nextVsyncTime, vsyncsForLastFrame);
         }
         mLastVsyncTime = nextVsyncTime;
     }
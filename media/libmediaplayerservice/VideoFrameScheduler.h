@@ -18,6 +18,7 @@
 #define VIDEO_FRAME_SCHEDULER_H_
 
 #include <utils/RefBase.h>
+#include <utils/threads.h>
 #include <utils/Timers.h>
 
 #include <media/stagefright/foundation/ABase.h>
@@ -41,7 +42,28 @@ struct VideoFrameScheduler : public RefBase {
 
     void release();
 
+    // Uses the given vsync timing instead of querying the display, e.g. to
+    // replay recorded or synthetic timestamp and vsync traces offline.
+    void setVsync(nsecs_t vsyncTime, nsecs_t vsyncPeriod);
+
+    struct Stats {
+        size_t  mNumFrames;         // frames scheduled with a known video period
+        size_t  mNumDropped;        // frames sharing a vsync with the next frame
+        size_t  mNumRepeated;       // frames held for more vsyncs than the cadence needs
+        size_t  mNumCadenceBreaks;  // times the vsyncs per frame stopped following the cadence
+        nsecs_t mTotalJudder;       // sum of per-frame judder, see updateStats()
+        nsecs_t mMaxJudder;
+        // detected cadence: mCadenceVsyncs vsyncs for every mCadenceFrames
+        // frames (e.g. 5 for 2 for 3:2 pulldown), or 0 if there is none.
+        size_t  mCadenceFrames;
+        size_t  mCadenceVsyncs;
+    };
+
+    // statistics since the last init()
+    void getStats(Stats *stats);
+
     static const size_t kHistorySize = 8;
+    static const size_t kMaxCadenceFrames = 5;
 
 protected:
     virtual ~VideoFrameScheduler();
@@ -56,6 +78,8 @@ private:
         void restart();
         // returns period
         nsecs_t addSample(nsecs_t time);
+        // whether the phase restarted with the last sample
+        bool restarted() const { return mNumSamples == 1; }
 
     private:
         nsecs_t mPeriod;
@@ -78,6 +102,9 @@ private:
     };
 
     void updateVsync();
+    void updateCadence(nsecs_t videoPeriod);
+    nsecs_t applyCadence(nsecs_t renderTime, nsecs_t vsyncTime);
+    void updateStats(nsecs_t renderTime, nsecs_t vsyncTime, size_t vsyncsForLastFrame);
 
     nsecs_t mVsyncTime;        // vsync timing from display
     nsecs_t mVsyncPeriod;
@@ -88,6 +115,25 @@ private:
 
     PLL mPll;                  // PLL for video frame rate based on render time
 
+    bool mFixedVsync;          // vsync timing was given by setVsync()
+
+    nsecs_t mCadencePeriod;    // video period the cadence was detected for
+    nsecs_t mJudderBase;       // running average of vsync time - render time
+    bool    mJudderBaseValid;
+    size_t  mCadenceHistory[kMaxCadenceFrames]; // vsyncs of the last frames
+    size_t  mNumCadenceSamples;
+    bool    mFollowingCadence;
+
+    // frames are placed on the detected cadence from an anchor frame, see applyCadence()
+    bool    mCadenceAnchored;
+    size_t  mCadenceIndex;     // frames since the anchor, modulo the cadence frames
+    nsecs_t mCadenceVsyncBase; // vsync of the anchor frame, advanced by whole cadences
+    nsecs_t mCadenceRenderBase; // render time of the anchor frame, advanced likewise
+    nsecs_t mCadenceDrift;     // running average of render time - cadence time
+
+    Mutex mStatsLock;          // protects mStats, which is read from other threads
+    Stats mStats;
+
     sp<ISurfaceComposer> mComposer;
 
     DISALLOW_EVIL_CONSTRUCTORS(VideoFrameScheduler);
@@ -8,6 +8,7 @@ LOCAL_SRC_FILES:=                       \
         NuPlayerDecoder.cpp             \
         NuPlayerDecoderPassThrough.cpp  \
         NuPlayerDriver.cpp              \
+        NuPlayerLooperPool.cpp          \
         NuPlayerRenderer.cpp            \
         NuPlayerStreamListener.cpp      \
         RTSPSource.cpp                  \
@@ -21,6 +21,7 @@
 
 #include "AnotherPacketSource.h"
 
+#include <cutils/properties.h>
 #include <media/IMediaHTTPService.h>
 #include <media/stagefright/foundation/ABuffer.h>
 #include <media/stagefright/foundation/ADebug.h>
@@ -35,6 +36,7 @@
 #include <media/stagefright/Utils.h>
 #include "../../libstagefright/include/DRMExtractor.h"
 #include "../../libstagefright/include/NuCachedSource2.h"
+#include "../../libstagefright/include/ThrottledSource.h"
 #include "../../libstagefright/include/WVMExtractor.h"
 #include "../../libstagefright/include/HTTPBase.h"
 
@@ -246,6 +248,8 @@ void NuPlayer::GenericSource::checkDrmStatus(const sp<DataSource>& dataSource) {
 }
 
 int64_t NuPlayer::GenericSource::getLastReadPosition() {
+    // written on the read loopers
+    Mutex::Autolock _l(mReadBufferLock);
     if (mAudioTrack.mSource != NULL) {
         return mAudioTimeUs;
     } else if (mVideoTrack.mSource != NULL) {
@@ -264,6 +268,9 @@ status_t NuPlayer::GenericSource::setBuffers(
 }
 
 NuPlayer::GenericSource::~GenericSource() {
+    stopReadLooper(&mAudioTrack);
+    stopReadLooper(&mVideoTrack);
+
     if (mLooper != NULL) {
         mLooper->unregisterHandler(id());
         mLooper->stop();
@@ -283,6 +290,34 @@ void NuPlayer::GenericSource::prepareAsync() {
     msg->post();
 }
 
+void NuPlayer::GenericSource::startReadLooper(Track *track, const char *name) {
+    if (track->mSource == NULL || track->mReadLooper != NULL) {
+        return;
+    }
+
+    sp<ALooper> looper = new ALooper;
+    looper->setName(name);
+    looper->start();
+
+    sp<AHandlerReflector<GenericSource> > handler =
+        new AHandlerReflector<GenericSource>(this);
+    looper->registerHandler(handler);
+
+    // postReadBuffer() may already be running on another thread.
+    Mutex::Autolock _l(mReadBufferLock);
+    track->mReadLooper = looper;
+    track->mReadHandler = handler;
+}
+
+void NuPlayer::GenericSource::stopReadLooper(Track *track) {
+    if (track->mReadLooper != NULL) {
+        track->mReadLooper->unregisterHandler(track->mReadHandler->id());
+        track->mReadLooper->stop();
+        track->mReadLooper.clear();
+        track->mReadHandler.clear();
+    }
+}
+
 void NuPlayer::GenericSource::onPrepareAsync() {
     // delayed data source creation
     if (mDataSource == NULL) {
@@ -310,6 +345,14 @@ void NuPlayer::GenericSource::onPrepareAsync() {
             mIsWidevine = false;
 
             mDataSource = new FileSource(mFd, mOffset, mLength);
+
+            // for measuring seek and startup latency against slow storage
+            char value[PROPERTY_VALUE_MAX];
+            if (property_get("debug.nuplayer.throttle-bps", value, NULL)
+                    && atoi(value) > 0) {
+                ALOGI("throttling local playback to %d bytes/sec", atoi(value));
+                mDataSource = new ThrottledSource(mDataSource, atoi(value));
+            }
         }
 
         if (mDataSource == NULL) {
@@ -456,6 +499,11 @@ status_t NuPlayer::GenericSource::prefillCacheIfNecessary() {
 void NuPlayer::GenericSource::start() {
     ALOGI("start");
 
+    // Read loopers are only started once playback starts, so that players
+    // which are prepared ahead of time do not hold on to idle threads.
+    startReadLooper(&mAudioTrack, "generic-audio");
+    startReadLooper(&mVideoTrack, "generic-video");
+
     mStopRead = false;
     if (mAudioTrack.mSource != NULL) {
         CHECK_EQ(mAudioTrack.mSource->start(), (status_t)OK);
@@ -637,12 +685,15 @@ void NuPlayer::GenericSource::onMessageReceived(const sp<AMessage> &msg) {
           }
 
 
-          if (track->mSource != NULL) {
-              track->mSource->stop();
+          {
+              Mutex::Autolock autoLock(track->mReadLock);
+              if (track->mSource != NULL) {
+                  track->mSource->stop();
+              }
+              track->mSource = source;
+              track->mSource->start();
+              track->mIndex = trackIndex;
           }
-          track->mSource = source;
-          track->mSource->start();
-          track->mIndex = trackIndex;
 
           status_t avail;
           if (!track->mPackets->hasBufferAvailable(&avail)) {
@@ -705,7 +756,11 @@ void NuPlayer::GenericSource::onMessageReceived(const sp<AMessage> &msg) {
       {
           // mStopRead is only used for Widevine to prevent the video source
           // from being read while the associated video decoder is shutting down.
-          mStopRead = true;
+          {
+              // wait for a read in progress on the video read looper
+              Mutex::Autolock autoLock(mVideoTrack.mReadLock);
+              mStopRead = true;
+          }
           if (mVideoTrack.mSource != NULL) {
               mVideoTrack.mPackets->clear();
           }
@@ -847,7 +902,13 @@ status_t NuPlayer::GenericSource::dequeueAccessUnit(
 
     status_t result = track->mPackets->dequeueAccessUnit(accessUnit);
 
-    if (!track->mPackets->hasBufferAvailable(&finalResult)) {
+    // top up the read-ahead once half of it has been consumed
+    int64_t readAheadUs = audio ? kAudioReadAheadUs : kVideoReadAheadUs;
+    size_t numQueued = track->mPackets->getAvailableBufferCount(&finalResult);
+    if (numQueued == 0
+            || (!mIsWidevine && finalResult == OK
+                && numQueued < kMaxQueuedBuffers / 2
+                && track->mPackets->getEstimatedDurationUs() < readAheadUs / 2)) {
         postReadBuffer(audio? MEDIA_TRACK_TYPE_AUDIO : MEDIA_TRACK_TYPE_VIDEO);
     }
 
@@ -1128,8 +1189,11 @@ status_t NuPlayer::GenericSource::doSeek(int64_t seekTimeUs) {
         return INVALID_OPERATION;
     }
     if (mVideoTrack.mSource != NULL) {
+        int64_t startUs = ALooper::GetNowUs();
         int64_t actualTimeUs;
         readBuffer(MEDIA_TRACK_TYPE_VIDEO, seekTimeUs, &actualTimeUs);
+        ALOGV("seek to %lld us: first video frame at %lld us after %lld us",
+                seekTimeUs, actualTimeUs, ALooper::GetNowUs() - startUs);
 
         seekTimeUs = actualTimeUs;
     }
@@ -1216,7 +1280,9 @@ void NuPlayer::GenericSource::postReadBuffer(media_track_type trackType) {
 
     if ((mPendingReadBufferTypes & (1 << trackType)) == 0) {
         mPendingReadBufferTypes |= (1 << trackType);
-        sp<AMessage> msg = new AMessage(kWhatReadBuffer, id());
+        const Track *track = trackType == MEDIA_TRACK_TYPE_AUDIO ? &mAudioTrack : &mVideoTrack;
+        sp<AMessage> msg = new AMessage(kWhatReadBuffer,
+                track->mReadHandler != NULL ? track->mReadHandler->id() : id());
         msg->setInt32("trackType", trackType);
         msg->post();
     }
@@ -1244,11 +1310,15 @@ void NuPlayer::GenericSource::readBuffer(
     }
     Track *track;
     size_t maxBuffers = 1;
+    int64_t readAheadUs = -1;  // no limit other than maxBuffers
     switch (trackType) {
         case MEDIA_TRACK_TYPE_VIDEO:
             track = &mVideoTrack;
             if (mIsWidevine) {
                 maxBuffers = 2;
+            } else {
+                maxBuffers = kMaxBuffersPerRead;
+                readAheadUs = kVideoReadAheadUs;
             }
             break;
         case MEDIA_TRACK_TYPE_AUDIO:
@@ -1256,7 +1326,8 @@ void NuPlayer::GenericSource::readBuffer(
             if (mIsWidevine) {
                 maxBuffers = 8;
             } else {
-                maxBuffers = 64;
+                maxBuffers = kMaxBuffersPerRead;
+                readAheadUs = kAudioReadAheadUs;
             }
             break;
         case MEDIA_TRACK_TYPE_SUBTITLE:
@@ -1269,10 +1340,6 @@ void NuPlayer::GenericSource::readBuffer(
             TRESPASS();
     }
 
-    if (track->mSource == NULL) {
-        return;
-    }
-
     if (actualTimeUs) {
         *actualTimeUs = seekTimeUs;
     }
@@ -1290,7 +1357,33 @@ void NuPlayer::GenericSource::readBuffer(
         options.setNonBlocking();
     }
 
+    // Seeks and track changes only wait for the first access unit at the new
+    // position; the read looper fills in the rest.
+    bool postReadAhead = false;
+    if (readAheadUs >= 0 && (seeking || formatChange)) {
+        maxBuffers = 1;
+        postReadAhead = true;
+    }
+
+    // The lock is held for one access unit at a time, so that a seek never
+    // waits for more than a single read on the read looper.
     for (size_t numBuffers = 0; numBuffers < maxBuffers; ) {
+        Mutex::Autolock autoLock(track->mReadLock);
+
+        // Do not read data if Widevine source is stopped
+        if (mStopRead || track->mSource == NULL) {
+            postReadAhead = false;
+            break;
+        }
+
+        if (readAheadUs >= 0 && !seeking && !formatChange) {
+            status_t finalResult;
+            if (track->mPackets->getAvailableBufferCount(&finalResult) >= kMaxQueuedBuffers
+                    || track->mPackets->getEstimatedDurationUs() >= readAheadUs) {
+                break;
+            }
+        }
+
         MediaBuffer *mbuf;
         status_t err = track->mSource->read(&mbuf, &options);
 
@@ -1300,8 +1393,10 @@ void NuPlayer::GenericSource::readBuffer(
             int64_t timeUs;
             CHECK(mbuf->meta_data()->findInt64(kKeyTime, &timeUs));
             if (trackType == MEDIA_TRACK_TYPE_AUDIO) {
+                Mutex::Autolock _l(mReadBufferLock);
                 mAudioTimeUs = timeUs;
             } else if (trackType == MEDIA_TRACK_TYPE_VIDEO) {
+                Mutex::Autolock _l(mReadBufferLock);
                 mVideoTimeUs = timeUs;
             }
 
@@ -1335,9 +1430,14 @@ void NuPlayer::GenericSource::readBuffer(
 #endif
         } else {
             track->mPackets->signalEOS(err);
+            postReadAhead = false;
             break;
         }
     }
+
+    if (postReadAhead) {
+        postReadBuffer(trackType);
+    }
 }
 
 }  // namespace android
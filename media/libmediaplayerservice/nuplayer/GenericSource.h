@@ -24,6 +24,7 @@
 #include "ATSParser.h"
 
 #include <media/mediaplayer.h>
+#include <media/stagefright/foundation/AHandlerReflector.h>
 
 namespace android {
 
@@ -80,6 +81,8 @@ protected:
     virtual sp<MetaData> getFormatMeta(bool audio);
 
 private:
+    friend struct AHandlerReflector<GenericSource>;
+
     enum {
         kWhatPrepareAsync,
         kWhatFetchSubtitleData,
@@ -98,10 +101,29 @@ private:
 
     Vector<sp<MediaSource> > mSources;
 
+    // Audio and video are read ahead on their own loopers until a duration
+    // worth of access units is queued, so that slow I/O on one track blocks
+    // neither the other track nor the control messages handled on mLooper.
+    // The buffer count bounds the read-ahead of streams whose queued duration
+    // cannot be estimated, e.g. without timestamps.
+    enum {
+        kAudioReadAheadUs = 2000000,
+        kVideoReadAheadUs = 1000000,
+        kMaxBuffersPerRead = 64,
+        kMaxQueuedBuffers = 256,
+    };
+
     struct Track {
         size_t mIndex;
         sp<MediaSource> mSource;
         sp<AnotherPacketSource> mPackets;
+
+        // audio and video only
+        sp<ALooper> mReadLooper;
+        sp<AHandlerReflector<GenericSource> > mReadHandler;
+        // serializes reads from mSource, and changes to it, between the
+        // read looper and seeks or track changes on mLooper.
+        Mutex mReadLock;
     };
 
     Track mAudioTrack;
@@ -146,6 +168,9 @@ private:
 
     void resetDataSource();
 
+    void startReadLooper(Track *track, const char *name);
+    void stopReadLooper(Track *track);
+
     status_t initFromDataSource();
     void checkDrmStatus(const sp<DataSource>& dataSource);
     int64_t getLastReadPosition();
@@ -37,6 +37,7 @@
 #include <media/stagefright/foundation/ABuffer.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/foundation/AString.h>
 #include <media/stagefright/MediaBuffer.h>
 #include <media/stagefright/MediaDefs.h>
 #include <media/stagefright/MediaErrors.h>
@@ -64,18 +65,44 @@ private:
 };
 
 struct NuPlayer::SeekAction : public Action {
-    SeekAction(int64_t seekTimeUs, bool needNotify)
+    SeekAction(int64_t seekTimeUs, bool needNotify, int32_t generation)
         : mSeekTimeUs(seekTimeUs),
-          mNeedNotify(needNotify) {
+          mNeedNotify(needNotify),
+          mGeneration(generation) {
     }
 
     virtual void execute(NuPlayer *player) {
+        if (player->mPendingSeekAction == this) {
+            player->mPendingSeekAction.clear();
+        }
+
+        if (mGeneration != player->mSeekGeneration) {
+            // A later seek was requested after this one was queued. If it is
+            // still to come, it decides the position; if it was performed
+            // already, go there again rather than back to an older position.
+            if (player->mPerformedSeekGeneration != player->mSeekGeneration) {
+                ALOGV("dropping stale seek to %lld us", mSeekTimeUs);
+                player->notifySeekCompleteIfNeeded(mNeedNotify);
+                return;
+            }
+            mSeekTimeUs = player->mSeekTargetUs;
+        }
+
+        player->mPerformedSeekGeneration = player->mSeekGeneration;
         player->performSeek(mSeekTimeUs, mNeedNotify);
     }
 
+    // Replaces the target of a seek that has not been performed yet.
+    void retarget(int64_t seekTimeUs, bool needNotify, int32_t generation) {
+        mSeekTimeUs = seekTimeUs;
+        mNeedNotify = mNeedNotify || needNotify;
+        mGeneration = generation;
+    }
+
 private:
     int64_t mSeekTimeUs;
     bool mNeedNotify;
+    int32_t mGeneration;
 
     DISALLOW_EVIL_CONSTRUCTORS(SeekAction);
 };
@@ -170,7 +197,20 @@ NuPlayer::NuPlayer()
       mNumFramesTotal(0ll),
       mNumFramesDropped(0ll),
       mVideoScalingMode(NATIVE_WINDOW_SCALING_MODE_SCALE_TO_WINDOW),
-      mStarted(false) {
+      mStarted(false),
+      mPaused(false),
+      mScrubbing(false),
+      mIdleReleaseGeneration(0),
+      mIdleDecodersReleased(false),
+      mIdleResumePositionUs(-1ll),
+      mSeekGeneration(0),
+      mPerformedSeekGeneration(0),
+      mSeekTargetUs(-1ll),
+      mSeekRequestedUs(-1ll),
+      mNumSeeks(0ll),
+      mNumSeeksCoalesced(0ll),
+      mNumSeeksSkippedForward(0ll),
+      mNumSeekLatencies(0ll) {
     clearFlushComplete();
 }
 
@@ -331,6 +371,12 @@ void NuPlayer::seekToAsync(int64_t seekTimeUs, bool needNotify) {
     msg->post();
 }
 
+void NuPlayer::setScrubbing(bool scrubbing) {
+    sp<AMessage> msg = new AMessage(kWhatSetScrubbing, id());
+    msg->setInt32("scrubbing", scrubbing);
+    msg->post();
+}
+
 
 void NuPlayer::writeTrackInfo(
         Parcel* reply, const sp<AMessage> format) const {
@@ -500,6 +546,16 @@ void NuPlayer::onMessageReceived(const sp<AMessage> &msg) {
             break;
         }
 
+        case kWhatSetScrubbing:
+        {
+            int32_t scrubbing;
+            CHECK(msg->findInt32("scrubbing", &scrubbing));
+            ALOGV("kWhatSetScrubbing %d", scrubbing);
+
+            mScrubbing = scrubbing;
+            break;
+        }
+
         case kWhatPollDuration:
         {
             int32_t generation;
@@ -546,7 +602,8 @@ void NuPlayer::onMessageReceived(const sp<AMessage> &msg) {
                     int64_t currentPositionUs = 0;
                     if (getCurrentPosition(&currentPositionUs) == OK) {
                         mDeferredActions.push_back(
-                                new SeekAction(currentPositionUs, false /* needNotify */));
+                                new SeekAction(currentPositionUs, false /* needNotify */,
+                                        mSeekGeneration));
                     }
                 }
 
@@ -584,6 +641,7 @@ void NuPlayer::onMessageReceived(const sp<AMessage> &msg) {
             mNumFramesTotal = 0;
             mNumFramesDropped = 0;
             mStarted = true;
+            mPaused = false;
 
             /* instantiate decoders now for secure playback */
             if (mSourceFlags & Source::FLAG_SECURE) {
@@ -624,6 +682,8 @@ void NuPlayer::onMessageReceived(const sp<AMessage> &msg) {
             notify->setInt32("generation", mRendererGeneration);
             mRenderer = new Renderer(mAudioSink, notify, flags);
 
+            // Not pooled, the renderer blocks on the audio HAL when it
+            // opens or closes the audio sink.
             mRendererLooper = new ALooper;
             mRendererLooper->setName("NuPlayerRenderer");
             mRendererLooper->start(false, false, ANDROID_PRIORITY_AUDIO);
@@ -933,6 +993,9 @@ void NuPlayer::onMessageReceived(const sp<AMessage> &msg) {
         {
             ALOGV("kWhatReset");
 
+            ++mIdleReleaseGeneration;
+            mIdleDecodersReleased = false;
+
             mDeferredActions.push_back(
                     new ShutdownDecoderAction(
                         true /* audio */, true /* video */));
@@ -954,11 +1017,40 @@ void NuPlayer::onMessageReceived(const sp<AMessage> &msg) {
             ALOGV("kWhatSeek seekTimeUs=%lld us, needNotify=%d",
                     seekTimeUs, needNotify);
 
+            mSeekRequestedUs = ALooper::GetNowUs();
+            {
+                Mutex::Autolock autoLock(mSeekStatsLock);
+                ++mNumSeeks;
+            }
+
+            ++mSeekGeneration;
+            mSeekTargetUs = seekTimeUs;
+
+            if (mPendingSeekAction != NULL) {
+                // The decoders are still flushing for an earlier seek that
+                // has not been performed yet; only the latest target matters.
+                ALOGV("coalescing seek to %lld us", seekTimeUs);
+                mPendingSeekAction->retarget(seekTimeUs, needNotify, mSeekGeneration);
+
+                Mutex::Autolock autoLock(mSeekStatsLock);
+                ++mNumSeeksCoalesced;
+                break;
+            }
+
+            if (mIdleDecodersReleased) {
+                // Decoders are re-created at the new position on resume.
+                mIdleResumePositionUs = seekTimeUs;
+            }
+
+            if (skipForwardIfPossible(seekTimeUs, needNotify)) {
+                break;
+            }
+
             mDeferredActions.push_back(
                     new SimpleAction(&NuPlayer::performDecoderFlush));
 
-            mDeferredActions.push_back(
-                    new SeekAction(seekTimeUs, needNotify));
+            mPendingSeekAction = new SeekAction(seekTimeUs, needNotify, mSeekGeneration);
+            mDeferredActions.push_back(mPendingSeekAction);
 
             processDeferredActions();
             break;
@@ -976,6 +1068,23 @@ void NuPlayer::onMessageReceived(const sp<AMessage> &msg) {
             } else {
                 ALOGW("pause called when renderer is gone or not set");
             }
+
+            mPaused = true;
+            sp<AMessage> releaseMsg = new AMessage(kWhatReleaseIdleDecoders, id());
+            releaseMsg->setInt32("generation", ++mIdleReleaseGeneration);
+            releaseMsg->post(kIdleDecoderReleaseUs);
+            break;
+        }
+
+        case kWhatReleaseIdleDecoders:
+        {
+            int32_t generation;
+            CHECK(msg->findInt32("generation", &generation));
+            if (generation != mIdleReleaseGeneration) {
+                break;
+            }
+
+            onReleaseIdleDecoders();
             break;
         }
 
@@ -986,6 +1095,17 @@ void NuPlayer::onMessageReceived(const sp<AMessage> &msg) {
             } else {
                 ALOGW("resume called when source is gone or not set");
             }
+            mPaused = false;
+            ++mIdleReleaseGeneration;
+            if (mIdleDecodersReleased) {
+                mIdleDecodersReleased = false;
+                mDeferredActions.push_back(
+                        new SeekAction(mIdleResumePositionUs, false /* needNotify */,
+                                mSeekGeneration));
+                mDeferredActions.push_back(
+                        new SimpleAction(&NuPlayer::performScanSources));
+                processDeferredActions();
+            }
             // |mAudioDecoder| may have been released due to the pause timeout, so re-create it if
             // needed.
             if (audioDecoderStillNeeded() && mAudioDecoder == NULL) {
@@ -1479,6 +1599,8 @@ void NuPlayer::renderBuffer(bool audio, const sp<AMessage> &msg) {
         skipUntilMediaTimeUs = -1;
     }
 
+    recordSeekLatencyIfNeeded(audio);
+
     if (!audio && mCCDecoder->isSelected()) {
         mCCDecoder->display(mediaTimeUs);
     }
@@ -1703,6 +1825,49 @@ void NuPlayer::getStats(int64_t *numFramesTotal, int64_t *numFramesDropped) {
     *numFramesDropped = mNumFramesDropped;
 }
 
+static int compareLatencies(const int64_t *lhs, const int64_t *rhs) {
+    if (*lhs < *rhs) {
+        return -1;
+    } else if (*lhs > *rhs) {
+        return 1;
+    }
+    return 0;
+}
+
+void NuPlayer::dump(AString *out) {
+    {
+        Mutex::Autolock autoLock(mSeekStatsLock);
+        out->append(StringPrintf(
+                "  seeks(%lld), coalesced(%lld), skippedForward(%lld)\n",
+                (long long)mNumSeeks, (long long)mNumSeeksCoalesced,
+                (long long)mNumSeeksSkippedForward));
+
+        int64_t numLatencies = mNumSeekLatencies;
+        if (numLatencies > (int64_t)kNumSeekLatencies) {
+            numLatencies = kNumSeekLatencies;
+        }
+        if (numLatencies > 0) {
+            Vector<int64_t> latencies;
+            latencies.appendArray(mSeekLatenciesUs, numLatencies);
+            latencies.sort(compareLatencies);
+            size_t n = latencies.size();
+            out->append(StringPrintf(
+                    "  seek-to-display latency over last %zu: "
+                    "p50(%.1f ms), p90(%.1f ms), p99(%.1f ms), max(%.1f ms)\n",
+                    n,
+                    latencies[(n - 1) * 50 / 100] / 1E3,
+                    latencies[(n - 1) * 90 / 100] / 1E3,
+                    latencies[(n - 1) * 99 / 100] / 1E3,
+                    latencies[n - 1] / 1E3));
+        }
+    }
+
+    sp<Renderer> renderer = mRenderer;
+    if (renderer != NULL) {
+        renderer->dump(out);
+    }
+}
+
 sp<MetaData> NuPlayer::getFileMeta() {
     return mSource->getFileFormatMeta();
 }
@@ -1740,6 +1905,38 @@ void NuPlayer::processDeferredActions() {
     }
 }
 
+void NuPlayer::onReleaseIdleDecoders() {
+    if (!mPaused || mIdleDecodersReleased
+            || (mAudioDecoder == NULL && mVideoDecoder == NULL)) {
+        return;
+    }
+
+    // Secure decoders hold protected buffers the surface may still show,
+    // and offloaded audio already has its own pause timeout.
+    if ((mSourceFlags & Source::FLAG_SECURE) || mOffloadAudio) {
+        return;
+    }
+
+    if (mFlushingAudio != NONE || mFlushingVideo != NONE
+            || !mDeferredActions.empty()) {
+        return;
+    }
+
+    int64_t positionUs;
+    if (getCurrentPosition(&positionUs) != OK) {
+        return;
+    }
+
+    ALOGV("releasing decoders of player paused at %lld us", (long long)positionUs);
+
+    mIdleDecodersReleased = true;
+    mIdleResumePositionUs = positionUs;
+
+    mDeferredActions.push_back(
+            new ShutdownDecoderAction(true /* audio */, true /* video */));
+    processDeferredActions();
+}
+
 void NuPlayer::performSeek(int64_t seekTimeUs, bool needNotify) {
     ALOGV("performSeek seekTimeUs=%lld us (%.2f secs), needNotify(%d)",
           seekTimeUs,
@@ -1757,6 +1954,61 @@ void NuPlayer::performSeek(int64_t seekTimeUs, bool needNotify) {
     mSource->seekTo(seekTimeUs);
     ++mTimedTextGeneration;
 
+    if (mScrubbing) {
+        // The source seeks to the preceding sync frame; drop everything
+        // decoded before the requested time so that it is the first frame
+        // shown.
+        mSkipRenderingAudioUntilMediaTimeUs = seekTimeUs;
+        mSkipRenderingVideoUntilMediaTimeUs = seekTimeUs;
+    }
+
+    notifySeekCompleteIfNeeded(needNotify);
+
+    // everything's flushed, continue playback.
+}
+
+// While scrubbing, a short seek forward does not need to flush the decoders
+// and restart from the preceding sync frame: the frames up to the new
+// position are decoded in order anyway, and are dropped in renderBuffer()
+// before they reach the renderer. Only the renderer's queues are flushed.
+bool NuPlayer::skipForwardIfPossible(int64_t seekTimeUs, bool needNotify) {
+    if (!mScrubbing || mVideoDecoder == NULL || mOffloadAudio
+            || mAudioEOS || mVideoEOS
+            || mFlushingAudio != NONE || mFlushingVideo != NONE
+            || !mDeferredActions.empty()) {
+        return false;
+    }
+
+    int64_t positionUs;
+    if (getCurrentPosition(&positionUs) != OK
+            || seekTimeUs < positionUs
+            || seekTimeUs - positionUs > kMaxSkipForwardUs) {
+        return false;
+    }
+
+    ALOGV("skipping forward from %lld us to %lld us", positionUs, seekTimeUs);
+
+    mPerformedSeekGeneration = mSeekGeneration;
+
+    mSkipRenderingVideoUntilMediaTimeUs = seekTimeUs;
+    mRenderer->flush(false /* audio */);
+    if (mAudioDecoder != NULL) {
+        mSkipRenderingAudioUntilMediaTimeUs = seekTimeUs;
+        mRenderer->flush(true /* audio */);
+    }
+    mRenderer->signalTimeDiscontinuity();
+    ++mTimedTextGeneration;
+
+    {
+        Mutex::Autolock autoLock(mSeekStatsLock);
+        ++mNumSeeksSkippedForward;
+    }
+
+    notifySeekCompleteIfNeeded(needNotify);
+    return true;
+}
+
+void NuPlayer::notifySeekCompleteIfNeeded(bool needNotify) {
     if (mDriver != NULL) {
         sp<NuPlayerDriver> driver = mDriver.promote();
         if (driver != NULL) {
@@ -1765,8 +2017,20 @@ void NuPlayer::performSeek(int64_t seekTimeUs, bool needNotify) {
             }
         }
     }
+}
 
-    // everything's flushed, continue playback.
+void NuPlayer::recordSeekLatencyIfNeeded(bool audio) {
+    // measured on video, unless there is none
+    if (mSeekRequestedUs < 0 || (audio && mVideoDecoder != NULL)) {
+        return;
+    }
+
+    int64_t latencyUs = ALooper::GetNowUs() - mSeekRequestedUs;
+    mSeekRequestedUs = -1;
+    ALOGV("seek-to-display latency %lld us", latencyUs);
+
+    Mutex::Autolock autoLock(mSeekStatsLock);
+    mSeekLatenciesUs[mNumSeekLatencies++ % kNumSeekLatencies] = latencyUs;
 }
 
 void NuPlayer::performDecoderFlush() {
@@ -26,6 +26,7 @@ namespace android {
 
 struct ABuffer;
 struct AMessage;
+struct AString;
 struct MetaData;
 struct NuPlayerDriver;
 
@@ -63,6 +64,11 @@ struct NuPlayer : public AHandler {
     // and needNotify is true.
     void seekToAsync(int64_t seekTimeUs, bool needNotify = false);
 
+    // While scrubbing, seeks land on the frame closest to the seek time
+    // instead of the preceding sync frame, and short forward seeks skip
+    // ahead in the current stream instead of flushing the decoders.
+    void setScrubbing(bool scrubbing);
+
     status_t setVideoScalingMode(int32_t mode);
     status_t getTrackInfo(Parcel* reply) const;
     status_t getSelectedTrack(int32_t type, Parcel* reply) const;
@@ -70,6 +76,9 @@ struct NuPlayer : public AHandler {
     status_t getCurrentPosition(int64_t *mediaUs);
     void getStats(int64_t *mNumFramesTotal, int64_t *mNumFramesDropped);
 
+    // Appends seek and renderer statistics for dumpsys to |out|.
+    void dump(AString *out);
+
     sp<MetaData> getFileMeta();
 
     static const size_t kAggregateBufferSizeBytes;
@@ -80,12 +89,13 @@ protected:
     virtual void onMessageReceived(const sp<AMessage> &msg);
 
 public:
+    struct Decoder;
+    struct DecoderPassThrough;
+    struct LooperPool;
     struct NuPlayerStreamListener;
     struct Source;
 
 private:
-    struct Decoder;
-    struct DecoderPassThrough;
     struct CCDecoder;
     struct GenericSource;
     struct HTTPLiveSource;
@@ -120,8 +130,21 @@ private:
         kWhatGetTrackInfo               = 'gTrI',
         kWhatGetSelectedTrack           = 'gSel',
         kWhatSelectTrack                = 'selT',
+        kWhatSetScrubbing               = 'scrb',
+        kWhatReleaseIdleDecoders        = 'rlsI',
     };
 
+    // Players that stay paused this long shut their decoders down, and
+    // re-create them on resume.
+    static const int64_t kIdleDecoderReleaseUs = 30000000ll;
+
+    // Forward seeks up to this far ahead of the current position are done
+    // by decoding and dropping the frames in between while scrubbing.
+    static const int64_t kMaxSkipForwardUs = 1000000ll;
+
+    // Number of most recent seeks whose latency is kept for dump().
+    static const size_t kNumSeekLatencies = 128;
+
     wp<NuPlayerDriver> mDriver;
     bool mUIDValid;
     uid_t mUID;
@@ -184,6 +207,35 @@ private:
     int32_t mVideoScalingMode;
 
     bool mStarted;
+    bool mPaused;
+
+    bool mScrubbing;
+
+    int32_t mIdleReleaseGeneration;
+    bool mIdleDecodersReleased;
+    int64_t mIdleResumePositionUs;
+
+    // The SeekAction queued behind a decoder flush that is still in
+    // progress. Further seeks retarget it instead of queueing another flush.
+    sp<SeekAction> mPendingSeekAction;
+
+    // Bumped by every seek request. SeekActions carry the generation they
+    // were queued in, so that one queued before a later request, e.g. the
+    // seek refreshing a new surface, does not undo it.
+    int32_t mSeekGeneration;
+    int32_t mPerformedSeekGeneration;
+    int64_t mSeekTargetUs;  // of the latest seek request
+
+    // Time the last seek was requested, until its first frame is queued
+    // for display.
+    int64_t mSeekRequestedUs;
+
+    Mutex mSeekStatsLock;  // protects the following, which are read by dump().
+    int64_t mNumSeeks;
+    int64_t mNumSeeksCoalesced;
+    int64_t mNumSeeksSkippedForward;
+    int64_t mNumSeekLatencies;
+    int64_t mSeekLatenciesUs[kNumSeekLatencies];  // ring of the most recent
 
     inline const sp<Decoder> &getDecoder(bool audio) {
         return audio ? mAudioDecoder : mVideoDecoder;
@@ -226,7 +278,12 @@ private:
 
     void processDeferredActions();
 
+    void onReleaseIdleDecoders();
+
     void performSeek(int64_t seekTimeUs, bool needNotify);
+    bool skipForwardIfPossible(int64_t seekTimeUs, bool needNotify);
+    void notifySeekCompleteIfNeeded(bool needNotify);
+    void recordSeekLatencyIfNeeded(bool audio);
     void performDecoderFlush();
     void performDecoderShutdown(bool audio, bool video);
     void performReset();
@@ -20,6 +20,7 @@
 #include <inttypes.h>
 
 #include "NuPlayerDecoder.h"
+#include "NuPlayerLooperPool.h"
 
 #include <media/ICrypto.h>
 #include <media/stagefright/foundation/ABitReader.h>
@@ -41,20 +42,21 @@ NuPlayer::Decoder::Decoder(
       mBufferGeneration(0),
       mPaused(true),
       mComponentName("decoder") {
-    // Every decoder has its own looper because MediaCodec operations
-    // are blocking, but NuPlayer needs asynchronous operations.
-    mDecoderLooper = new ALooper;
-    mDecoderLooper->setName("NPDecoder");
-    mDecoderLooper->start(false, false, ANDROID_PRIORITY_AUDIO);
-
-    mCodecLooper = new ALooper;
-    mCodecLooper->setName("NPDecoder-CL");
-    mCodecLooper->start(false, false, ANDROID_PRIORITY_AUDIO);
+    // Decoders run off the NuPlayer looper because MediaCodec operations
+    // are blocking, but NuPlayer needs asynchronous operations. MediaCodec
+    // itself runs in a separate pool, as decoders wait for its responses.
+    mDecoderLooper = LooperPool::acquire(
+            "NPDecoder", LooperPool::kMaxDecoderLoopers,
+            false /* canCallJava */, ANDROID_PRIORITY_AUDIO);
 }
 
 NuPlayer::Decoder::~Decoder() {
     mDecoderLooper->unregisterHandler(id());
-    mDecoderLooper->stop();
+    LooperPool::release(mDecoderLooper);
+
+    if (mCodecLooper != NULL) {
+        LooperPool::release(mCodecLooper);
+    }
 
     releaseAndResetMediaBuffers();
 }
@@ -105,6 +107,12 @@ void NuPlayer::Decoder::onConfigure(const sp<AMessage> &format) {
     mComponentName.append(" decoder");
     ALOGV("[%s] onConfigure (surface=%p)", mComponentName.c_str(), surface.get());
 
+    if (mCodecLooper == NULL) {
+        mCodecLooper = LooperPool::acquire(
+                "NPDecoder-CL", LooperPool::kMaxCodecLoopers,
+                false /* canCallJava */, ANDROID_PRIORITY_AUDIO);
+    }
+
     mCodec = MediaCodec::CreateByType(mCodecLooper, mime.c_str(), false /* encoder */);
     int32_t secure = 0;
     if (format->findInt32("secure", &secure) && secure != 0) {
@@ -45,9 +45,6 @@ NuPlayer::DecoderPassThrough::DecoderPassThrough(
       mPendingBuffersToDrain(0),
       mCachedBytes(0),
       mComponentName("pass through decoder") {
-    mDecoderLooper = new ALooper;
-    mDecoderLooper->setName("NuPlayerDecoderPassThrough");
-    mDecoderLooper->start(false, false, ANDROID_PRIORITY_AUDIO);
 }
 
 NuPlayer::DecoderPassThrough::~DecoderPassThrough() {
@@ -59,10 +56,6 @@ void NuPlayer::DecoderPassThrough::configure(const sp<AMessage> &format) {
     msg->post();
 }
 
-void NuPlayer::DecoderPassThrough::init() {
-    mDecoderLooper->registerHandler(this);
-}
-
 void NuPlayer::DecoderPassThrough::signalFlush() {
     (new AMessage(kWhatFlush, id()))->post();
 }
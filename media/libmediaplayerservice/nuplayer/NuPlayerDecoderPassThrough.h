@@ -28,7 +28,6 @@ struct NuPlayer::DecoderPassThrough : public Decoder {
     DecoderPassThrough(const sp<AMessage> &notify);
 
     virtual void configure(const sp<AMessage> &format);
-    virtual void init();
 
     virtual void signalFlush();
     virtual void signalResume();
@@ -53,7 +52,6 @@ private:
     };
 
     sp<AMessage> mNotify;
-    sp<ALooper> mDecoderLooper;
 
     /** Returns true if a buffer was requested.
      * Returns false if at EOS or cache already full.
@@ -22,10 +22,12 @@
 #include "NuPlayerDriver.h"
 
 #include "NuPlayer.h"
+#include "NuPlayerLooperPool.h"
 #include "NuPlayerSource.h"
 
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AString.h>
 #include <media/stagefright/foundation/AUtils.h>
 #include <media/stagefright/MetaData.h>
 #include <media/stagefright/Utils.h>
@@ -49,6 +51,8 @@ NuPlayerDriver::NuPlayerDriver()
     ALOGV("NuPlayerDriver(%p)", this);
     mLooper->setName("NuPlayerDriver Looper");
 
+    // Not pooled, sources and the renderer wait for responses on this
+    // looper, which would stall every player sharing it.
     mLooper->start(
             false, /* runOnCallingThread */
             true,  /* canCallJava */
@@ -512,9 +516,22 @@ void NuPlayerDriver::setAudioSink(const sp<AudioSink> &audioSink) {
     mAudioSink = audioSink;
 }
 
-status_t NuPlayerDriver::setParameter(
-        int /* key */, const Parcel & /* request */) {
-    return INVALID_OPERATION;
+status_t NuPlayerDriver::setParameter(int key, const Parcel &request) {
+    switch (key) {
+        case KEY_PARAMETER_SCRUBBING:
+        {
+            int32_t scrubbing;
+            status_t err = request.readInt32(&scrubbing);
+            if (err != OK) {
+                return err;
+            }
+            mPlayer->setScrubbing(scrubbing != 0);
+            return OK;
+        }
+
+        default:
+            return INVALID_OPERATION;
+    }
 }
 
 status_t NuPlayerDriver::getParameter(int /* key */, Parcel * /* reply */) {
@@ -612,6 +629,11 @@ status_t NuPlayerDriver::dump(
                  numFramesTotal == 0
                     ? 0.0 : (double)numFramesDropped / numFramesTotal);
 
+    AString stats;
+    mPlayer->dump(&stats);
+    NuPlayer::LooperPool::dump(&stats);
+    fprintf(out, "%s", stats.c_str());
+
     fclose(out);
     out = NULL;
 
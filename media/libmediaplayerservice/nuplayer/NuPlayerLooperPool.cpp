@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "NuPlayerLooperPool"
+#include <utils/Log.h>
+
+#include "NuPlayerLooperPool.h"
+
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AString.h>
+#include <utils/KeyedVector.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+struct PooledLooper {
+    AString mPoolName;
+    sp<ALooper> mLooper;
+    size_t mNumUsers;
+};
+
+static Mutex gLooperPoolLock;
+static Vector<PooledLooper> gPooledLoopers;
+
+// static
+sp<ALooper> NuPlayer::LooperPool::acquire(
+        const char *name, size_t maxLoopers, bool canCallJava, int32_t priority) {
+    Mutex::Autolock autoLock(gLooperPoolLock);
+
+    size_t numLoopers = 0;
+    ssize_t leastUsed = -1;
+    for (size_t i = 0; i < gPooledLoopers.size(); ++i) {
+        const PooledLooper &entry = gPooledLoopers[i];
+        if (entry.mPoolName != name) {
+            continue;
+        }
+        ++numLoopers;
+        if (leastUsed < 0 || entry.mNumUsers < gPooledLoopers[leastUsed].mNumUsers) {
+            leastUsed = i;
+        }
+    }
+
+    if (numLoopers >= maxLoopers && leastUsed >= 0) {
+        PooledLooper &entry = gPooledLoopers.editItemAt(leastUsed);
+        ++entry.mNumUsers;
+        ALOGV("sharing %s looper %zd with %zu users", name, leastUsed, entry.mNumUsers);
+        return entry.mLooper;
+    }
+
+    PooledLooper entry;
+    entry.mPoolName = name;
+    entry.mLooper = new ALooper;
+    entry.mLooper->setName(name);
+    entry.mLooper->start(false /* runOnCallingThread */, canCallJava, priority);
+    entry.mNumUsers = 1;
+    gPooledLoopers.push(entry);
+
+    ALOGV("started %s looper, %zu in pool", name, numLoopers + 1);
+    return entry.mLooper;
+}
+
+// static
+void NuPlayer::LooperPool::release(const sp<ALooper> &looper) {
+    sp<ALooper> stopLooper;
+    {
+        Mutex::Autolock autoLock(gLooperPoolLock);
+
+        size_t i = 0;
+        while (i < gPooledLoopers.size() && gPooledLoopers[i].mLooper != looper) {
+            ++i;
+        }
+        CHECK_LT(i, gPooledLoopers.size());
+
+        PooledLooper &entry = gPooledLoopers.editItemAt(i);
+        if (--entry.mNumUsers == 0) {
+            stopLooper = entry.mLooper;
+            gPooledLoopers.removeAt(i);
+        }
+    }
+
+    // Stop outside of the lock; this joins the looper's thread, which may
+    // itself be about to acquire or release a pooled looper.
+    if (stopLooper != NULL) {
+        stopLooper->stop();
+    }
+}
+
+// static
+void NuPlayer::LooperPool::dump(AString *out) {
+    Mutex::Autolock autoLock(gLooperPoolLock);
+
+    KeyedVector<AString, size_t> numLoopers;
+    KeyedVector<AString, size_t> numUsers;
+    for (size_t i = 0; i < gPooledLoopers.size(); ++i) {
+        const PooledLooper &entry = gPooledLoopers[i];
+        ssize_t index = numLoopers.indexOfKey(entry.mPoolName);
+        if (index < 0) {
+            numLoopers.add(entry.mPoolName, 1);
+            numUsers.add(entry.mPoolName, entry.mNumUsers);
+        } else {
+            numLoopers.editValueAt(index) += 1;
+            numUsers.editValueAt(index) += entry.mNumUsers;
+        }
+    }
+
+    for (size_t i = 0; i < numLoopers.size(); ++i) {
+        const AString &name = numLoopers.keyAt(i);
+        out->append(StringPrintf(
+                "  looper pool %s: loopers(%zu), users(%zu)\n",
+                name.c_str(), numLoopers.valueAt(i), numUsers.valueAt(i)));
+    }
+}
+
+}  // namespace android
@@ -0,0 +1,61 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef NUPLAYER_LOOPER_POOL_H_
+
+#define NUPLAYER_LOOPER_POOL_H_
+
+#include "NuPlayer.h"
+
+namespace android {
+
+struct ALooper;
+struct AString;
+
+// Named pools of loopers shared by all NuPlayer instances in the process.
+// A pool starts a new looper for each user until it holds maxLoopers of
+// them, after which users share the least used one. Handlers on a shared
+// looper are serialized, so none of them may block waiting for a handler
+// that lives in the same pool, nor on I/O or the audio HAL. That is why
+// only the decoder and codec loopers are pooled; the player, renderer and
+// source loopers stay per player.
+struct NuPlayer::LooperPool {
+    enum {
+        // Each player has an audio and a video decoder.
+        kMaxDecoderLoopers  = 8,
+        kMaxCodecLoopers    = 8,
+    };
+
+    // Returns a running looper of the pool |name|. Every looper of a pool
+    // runs with the canCallJava and priority it was first created with.
+    static sp<ALooper> acquire(
+            const char *name, size_t maxLoopers, bool canCallJava, int32_t priority);
+
+    // Hands back a looper obtained from acquire(). The looper is stopped
+    // once its last user has released it. Handlers must already have been
+    // unregistered.
+    static void release(const sp<ALooper> &looper);
+
+    // Appends the number of loopers and users of each pool to |out|.
+    static void dump(AString *out);
+
+private:
+    DISALLOW_EVIL_CONSTRUCTORS(LooperPool);
+};
+
+}  // namespace android
+
+#endif  // NUPLAYER_LOOPER_POOL_H_
@@ -25,6 +25,7 @@
 #include <media/stagefright/foundation/ABuffer.h>
 #include <media/stagefright/foundation/ADebug.h>
 #include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/foundation/AString.h>
 #include <media/stagefright/foundation/AUtils.h>
 #include <media/stagefright/MediaErrors.h>
 #include <media/stagefright/MetaData.h>
@@ -33,6 +34,7 @@
 #include <VideoFrameScheduler.h>
 
 #include <inttypes.h>
+#include <time.h>
 
 namespace android {
 
@@ -43,6 +45,19 @@ static const int64_t kOffloadPauseMaxUs = 60000000ll;
 // static
 const int64_t NuPlayer::Renderer::kMinPositionUpdateDelayUs = 100000ll;
 
+// If a new audio buffer's media time is further than this from where the last
+// anchor says it should be, the anchor is updated right away.
+// static
+const int64_t NuPlayer::Renderer::kMaxAudioAnchorDriftUs = 20000ll;
+
+static int64_t getThreadCpuTimeUs() {
+    struct timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) {
+        return 0;
+    }
+    return ts.tv_sec * 1000000ll + ts.tv_nsec / 1000;
+}
+
 static bool sFrameAccurateAVsync = false;
 
 static void readProperties() {
@@ -80,6 +95,14 @@ NuPlayer::Renderer::Renderer(
       mVideoRenderingStarted(false),
       mVideoRenderingStartGeneration(0),
       mAudioRenderingStartGeneration(0),
+      mLastPositionUpdateUs(-1),
+      mLastAnchorAudioMediaUs(-1),
+      mLastAnchorNumFramesWritten(0),
+      mAudioRenderedUs(0),
+      mNumAudioWakeups(0),
+      mNumAudioSinkWrites(0),
+      mNumAudioPositionQueries(0),
+      mAudioCpuTimeUs(0),
       mAudioOffloadPauseTimeoutGeneration(0),
       mAudioOffloadTornDown(false),
       mCurrentOffloadInfo(AUDIO_INFO_INITIALIZER),
@@ -323,27 +346,14 @@ void NuPlayer::Renderer::onMessageReceived(const sp<AMessage> &msg) {
 
             mDrainAudioQueuePending = false;
 
+            int64_t startCpuUs = getThreadCpuTimeUs();
             if (onDrainAudioQueue()) {
-                uint32_t numFramesPlayed;
-                CHECK_EQ(mAudioSink->getPosition(&numFramesPlayed),
-                         (status_t)OK);
-
-                uint32_t numFramesPendingPlayout =
-                    mNumFramesWritten - numFramesPlayed;
-
-                // This is how long the audio sink will have data to
-                // play back.
-                int64_t delayUs =
-                    mAudioSink->msecsPerFrame()
-                        * numFramesPendingPlayout * 1000ll;
-
-                // Let's give it more data after about half that time
-                // has elapsed.
                 // kWhatDrainAudioQueue is used for non-offloading mode,
                 // and mLock is used only for offloading mode. Therefore,
                 // no need to acquire mLock here.
-                postDrainAudioQueue_l(delayUs / 2);
+                postDrainAudioQueue_l(getAudioDrainDelayUs());
             }
+            addAudioWakeup(getThreadCpuTimeUs() - startCpuUs);
             break;
         }
 
@@ -378,7 +388,14 @@ void NuPlayer::Renderer::onMessageReceived(const sp<AMessage> &msg) {
 
         case kWhatQueueBuffer:
         {
+            int32_t audio;
+            CHECK(msg->findInt32("audio", &audio));
+
+            int64_t startCpuUs = audio ? getThreadCpuTimeUs() : 0;
             onQueueBuffer(msg);
+            if (audio) {
+                addAudioWakeup(getThreadCpuTimeUs() - startCpuUs);
+            }
             break;
         }
 
@@ -466,6 +483,64 @@ void NuPlayer::Renderer::postDrainAudioQueue_l(int64_t delayUs) {
     msg->post(delayUs);
 }
 
+// Returns how long the next drain can wait: about half the time the audio
+// sink has data to play back for. Newly queued audio accumulates meanwhile
+// and goes to the sink in one batch rather than one write per buffer.
+int64_t NuPlayer::Renderer::getAudioDrainDelayUs() {
+    uint32_t numFramesPlayed;
+    if (offloadingAudio() || mAudioSink->getPosition(&numFramesPlayed) != OK) {
+        return 0;
+    }
+
+    uint32_t numFramesPendingPlayout = mNumFramesWritten - numFramesPlayed;
+
+    // This is how long the audio sink will have data to play back.
+    int64_t delayUs = mAudioSink->msecsPerFrame() * numFramesPendingPlayout * 1000ll;
+
+    // Let's give it more data after about half that time has elapsed.
+    return delayUs / 2;
+}
+
+void NuPlayer::Renderer::addAudioWakeup(int64_t cpuTimeUs) {
+    Mutex::Autolock autoLock(mStatsLock);
+    ++mNumAudioWakeups;
+    mAudioCpuTimeUs += cpuTimeUs;
+}
+
+void NuPlayer::Renderer::dump(AString *out) {
+    Mutex::Autolock autoLock(mStatsLock);
+    double minutes = mAudioRenderedUs / 6E7;
+    out->append(StringPrintf(
+            "  audio rendered(%.1f s), wakeups(%" PRId64 "), sinkWrites(%" PRId64 "), "
+            "positionQueries(%" PRId64 "), cpu(%.1f ms)\n",
+            mAudioRenderedUs / 1E6, mNumAudioWakeups, mNumAudioSinkWrites,
+            mNumAudioPositionQueries, mAudioCpuTimeUs / 1E3));
+    if (minutes > 0) {
+        out->append(StringPrintf(
+                "  per minute of audio: wakeups(%.0f), sinkWrites(%.0f), "
+                "positionQueries(%.0f), cpu(%.1f ms)\n",
+                mNumAudioWakeups / minutes, mNumAudioSinkWrites / minutes,
+                mNumAudioPositionQueries / minutes, mAudioCpuTimeUs / 1E3 / minutes));
+    }
+
+    if (mVideoScheduler != NULL) {
+        VideoFrameScheduler::Stats stats;
+        mVideoScheduler->getStats(&stats);
+        out->append(StringPrintf(
+                "  video frames(%zu), dropped(%zu), repeated(%zu), cadenceBreaks(%zu), "
+                "judder avg(%.2f ms) max(%.2f ms)",
+                stats.mNumFrames, stats.mNumDropped, stats.mNumRepeated,
+                stats.mNumCadenceBreaks,
+                stats.mNumFrames > 0 ? stats.mTotalJudder / 1E6 / stats.mNumFrames : 0.,
+                stats.mMaxJudder / 1E6));
+        if (stats.mCadenceFrames > 0) {
+            out->append(StringPrintf(", cadence(%zu vsyncs per %zu frames)",
+                    stats.mCadenceVsyncs, stats.mCadenceFrames));
+        }
+        out->append("\n");
+    }
+}
+
 void NuPlayer::Renderer::prepareForMediaRenderingStart() {
     mAudioRenderingStartGeneration = mAudioQueueGeneration;
     mVideoRenderingStartGeneration = mVideoQueueGeneration;
@@ -640,6 +715,12 @@ bool NuPlayer::Renderer::onDrainAudioQueue() {
         size_t copiedFrames = written / mAudioSink->frameSize();
         mNumFramesWritten += copiedFrames;
 
+        {
+            Mutex::Autolock autoLock(mStatsLock);
+            ++mNumAudioSinkWrites;
+            mAudioRenderedUs += copiedFrames * 1000ll * mAudioSink->msecsPerFrame();
+        }
+
         notifyIfMediaRenderingStarted();
 
         if (written != (ssize_t)copy) {
@@ -690,7 +771,29 @@ void NuPlayer::Renderer::onNewAudioMediaTime(int64_t mediaTimeUs) {
     }
     setAudioFirstAnchorTimeIfNeeded(mediaTimeUs);
     int64_t nowUs = ALooper::GetNowUs();
+
+    // getCurrentPosition() extrapolates from the anchor, so there is no need to
+    // query the sink's timestamp for every small buffer. Re-anchor periodically
+    // to follow the sink's clock, or right away if the media time jumped.
+    if (!offloadingAudio() && mAnchorTimeMediaUs >= 0 && mLastAnchorAudioMediaUs >= 0
+            && nowUs - mLastPositionUpdateUs < kMinPositionUpdateDelayUs) {
+        int64_t expectedMediaTimeUs = mLastAnchorAudioMediaUs
+            + (int64_t)((mNumFramesWritten - mLastAnchorNumFramesWritten)
+                    * 1000ll * mAudioSink->msecsPerFrame());
+        int64_t driftUs = mediaTimeUs - expectedMediaTimeUs;
+        if (driftUs >= -kMaxAudioAnchorDriftUs && driftUs <= kMaxAudioAnchorDriftUs) {
+            return;
+        }
+        ALOGV("audio media time off by %" PRId64 " us, re-anchoring", driftUs);
+    }
+
     setAnchorTime(mediaTimeUs, nowUs + getPendingAudioPlayoutDurationUs(nowUs));
+    mLastPositionUpdateUs = nowUs;
+    mLastAnchorAudioMediaUs = mediaTimeUs;
+    mLastAnchorNumFramesWritten = mNumFramesWritten;
+
+    Mutex::Autolock autoLock(mStatsLock);
+    ++mNumAudioPositionQueries;
 }
 
 void NuPlayer::Renderer::postDrainVideoQueue() {
@@ -871,8 +974,10 @@ void NuPlayer::Renderer::onQueueBuffer(const sp<AMessage> &msg) {
 
     if (mHasVideo) {
         if (mVideoScheduler == NULL) {
-            mVideoScheduler = new VideoFrameScheduler();
-            mVideoScheduler->init();
+            sp<VideoFrameScheduler> scheduler = new VideoFrameScheduler();
+            scheduler->init();
+            Mutex::Autolock autoLock(mStatsLock);
+            mVideoScheduler = scheduler;
         }
     }
 
@@ -896,7 +1001,7 @@ void NuPlayer::Renderer::onQueueBuffer(const sp<AMessage> &msg) {
     if (audio) {
         Mutex::Autolock autoLock(mLock);
         mAudioQueue.push_back(entry);
-        postDrainAudioQueue_l();
+        postDrainAudioQueue_l(mDrainAudioQueuePending ? 0 : getAudioDrainDelayUs());
     } else {
         mVideoQueue.push_back(entry);
         postDrainVideoQueue();
@@ -1029,6 +1134,7 @@ void NuPlayer::Renderer::onFlush(const sp<AMessage> &msg) {
         }
 
         mDrainAudioQueuePending = false;
+        mLastAnchorAudioMediaUs = -1;
 
         if (offloadingAudio()) {
             mAudioSink->pause();
@@ -1172,6 +1278,7 @@ void NuPlayer::Renderer::onResume() {
 
 void NuPlayer::Renderer::onSetVideoFrameRate(float fps) {
     if (mVideoScheduler == NULL) {
+        Mutex::Autolock autoLock(mStatsLock);
         mVideoScheduler = new VideoFrameScheduler();
     }
     mVideoScheduler->init(fps);
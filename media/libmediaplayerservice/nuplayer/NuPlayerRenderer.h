@@ -23,6 +23,7 @@
 namespace android {
 
 struct ABuffer;
+struct AString;
 struct VideoFrameScheduler;
 
 struct NuPlayer::Renderer : public AHandler {
@@ -77,6 +78,9 @@ struct NuPlayer::Renderer : public AHandler {
             uint32_t flags);
     void closeAudioSink();
 
+    // Appends audio rendering statistics for dumpsys to |out|.
+    void dump(AString *out);
+
     enum {
         kWhatEOS                 = 'eos ',
         kWhatFlushComplete       = 'fluC',
@@ -124,6 +128,7 @@ private:
     };
 
     static const int64_t kMinPositionUpdateDelayUs;
+    static const int64_t kMaxAudioAnchorDriftUs;
 
     sp<MediaPlayerBase::AudioSink> mAudioSink;
     sp<AMessage> mNotify;
@@ -132,7 +137,7 @@ private:
     List<QueueEntry> mAudioQueue;
     List<QueueEntry> mVideoQueue;
     uint32_t mNumFramesWritten;
-    sp<VideoFrameScheduler> mVideoScheduler;
+    sp<VideoFrameScheduler> mVideoScheduler;  // set under mStatsLock for dump()
 
     bool mDrainAudioQueuePending;
     bool mDrainVideoQueuePending;
@@ -165,7 +170,18 @@ private:
     int32_t mVideoRenderingStartGeneration;
     int32_t mAudioRenderingStartGeneration;
 
+    // Time of the last anchor update from the audio sink, and the media time and
+    // frame count it was taken at, used to extrapolate in between updates.
     int64_t mLastPositionUpdateUs;
+    int64_t mLastAnchorAudioMediaUs;
+    uint32_t mLastAnchorNumFramesWritten;
+
+    Mutex mStatsLock;  // protects the following, which are only written on Renderer thread.
+    int64_t mAudioRenderedUs;
+    int64_t mNumAudioWakeups;
+    int64_t mNumAudioSinkWrites;
+    int64_t mNumAudioPositionQueries;
+    int64_t mAudioCpuTimeUs;
 
     int32_t mAudioOffloadPauseTimeoutGeneration;
     bool mAudioOffloadTornDown;
@@ -180,6 +196,8 @@ private:
     int64_t getPendingAudioPlayoutDurationUs(int64_t nowUs);
     int64_t getPlayedOutAudioDurationUs(int64_t nowUs);
     void postDrainAudioQueue_l(int64_t delayUs = 0);
+    int64_t getAudioDrainDelayUs();
+    void addAudioWakeup(int64_t cpuTimeUs);
 
     void onNewAudioMediaTime(int64_t mediaTimeUs);
     int64_t getRealTimeUs(int64_t mediaTimeUs, int64_t nowUs);
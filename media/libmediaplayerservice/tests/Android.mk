@@ -0,0 +1,56 @@
+# Build the unit tests.
+LOCAL_PATH:= $(call my-dir)
+include $(CLEAR_VARS)
+LOCAL_ADDITIONAL_DEPENDENCIES := $(LOCAL_PATH)/Android.mk
+
+LOCAL_MODULE := VideoFrameScheduler_test
+
+LOCAL_MODULE_TAGS := tests
+
+LOCAL_SRC_FILES := \
+	VideoFrameScheduler_test.cpp \
+
+LOCAL_SHARED_LIBRARIES := \
+	libmediaplayerservice \
+	libstagefright_foundation \
+	libutils \
+	liblog
+
+LOCAL_C_INCLUDES := \
+	frameworks/av/media/libmediaplayerservice \
+
+LOCAL_32_BIT_ONLY := true
+
+include $(BUILD_NATIVE_TEST)
+
+
+include $(CLEAR_VARS)
+LOCAL_ADDITIONAL_DEPENDENCIES := $(LOCAL_PATH)/Android.mk
+
+LOCAL_MODULE := NuPlayerDecoderPassThrough_test
+
+LOCAL_MODULE_TAGS := tests
+
+LOCAL_SRC_FILES := \
+	NuPlayerDecoderPassThrough_test.cpp \
+
+LOCAL_STATIC_LIBRARIES := \
+	libstagefright_nuplayer \
+
+LOCAL_SHARED_LIBRARIES := \
+	libbinder \
+	libgui \
+	libmedia \
+	libstagefright \
+	libstagefright_foundation \
+	libutils \
+	liblog
+
+LOCAL_C_INCLUDES := \
+	frameworks/av/media/libmediaplayerservice \
+	frameworks/av/media/libstagefright/include \
+	frameworks/native/include/media/openmax \
+
+LOCAL_32_BIT_ONLY := true
+
+include $(BUILD_NATIVE_TEST)
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "NuPlayerDecoderPassThrough_test"
+
+#include <gtest/gtest.h>
+#include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/AHandler.h>
+#include <media/stagefright/foundation/ALooper.h>
+#include <media/stagefright/foundation/AMessage.h>
+#include <media/stagefright/MediaDefs.h>
+#include <utils/threads.h>
+#include <utils/Vector.h>
+
+#include "nuplayer/NuPlayerDecoderPassThrough.h"
+
+namespace android {
+
+static const nsecs_t kTimeoutNs = 2000000000ll;
+
+// Collects the notifications a decoder sends to NuPlayer.
+struct NotifyCollector : public AHandler {
+    NotifyCollector() {}
+
+    // Returns whether a notification |what| arrived within the timeout.
+    bool waitFor(int32_t what) {
+        Mutex::Autolock autoLock(mLock);
+        for (;;) {
+            for (size_t i = 0; i < mWhats.size(); ++i) {
+                if (mWhats[i] == what) {
+                    return true;
+                }
+            }
+            if (mCondition.waitRelative(mLock, kTimeoutNs) != OK) {
+                return false;
+            }
+        }
+    }
+
+protected:
+    virtual void onMessageReceived(const sp<AMessage> &msg) {
+        int32_t what;
+        CHECK(msg->findInt32("what", &what));
+
+        Mutex::Autolock autoLock(mLock);
+        mWhats.push(what);
+        mCondition.broadcast();
+    }
+
+private:
+    Mutex mLock;
+    Condition mCondition;
+    Vector<int32_t> mWhats;
+
+    DISALLOW_EVIL_CONSTRUCTORS(NotifyCollector);
+};
+
+class NuPlayerDecoderPassThroughTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        mLooper = new ALooper;
+        mLooper->setName("NuPlayerDecoderPassThrough_test");
+        mLooper->start();
+
+        mCollector = new NotifyCollector;
+        mLooper->registerHandler(mCollector);
+    }
+
+    virtual void TearDown() {
+        mLooper->unregisterHandler(mCollector->id());
+        mLooper->stop();
+    }
+
+    sp<ALooper> mLooper;
+    sp<NotifyCollector> mCollector;
+};
+
+TEST_F(NuPlayerDecoderPassThroughTest, RunsOnPooledLooper) {
+    sp<NuPlayer::DecoderPassThrough> decoder =
+            new NuPlayer::DecoderPassThrough(new AMessage(0, mCollector->id()));
+    decoder->init();
+    EXPECT_NE(0, decoder->id());
+
+    sp<AMessage> format = new AMessage;
+    format->setString("mime", MEDIA_MIMETYPE_AUDIO_MPEG);
+    decoder->configure(format);
+
+    EXPECT_TRUE(mCollector->waitFor(NuPlayer::Decoder::kWhatOutputFormatChanged));
+    EXPECT_TRUE(mCollector->waitFor(NuPlayer::Decoder::kWhatFillThisBuffer));
+
+    decoder->initiateShutdown();
+    EXPECT_TRUE(mCollector->waitFor(NuPlayer::Decoder::kWhatShutdownCompleted));
+}
+
+}  // namespace android
@@ -0,0 +1,216 @@
+/*
+ * Copyright 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "VideoFrameScheduler_test"
+
+#include <gtest/gtest.h>
+#include <utils/Vector.h>
+
+#include "VideoFrameScheduler.h"
+
+namespace android {
+
+static const nsecs_t kVsyncPeriod60Hz = 1000000000ll / 60;
+
+class VideoFrameSchedulerTest : public ::testing::Test {
+protected:
+    virtual void SetUp() {
+        mScheduler = new VideoFrameScheduler();
+        mScheduler->setVsync(0 /* vsyncTime */, kVsyncPeriod60Hz);
+    }
+
+    // Feeds |numFrames| render times spaced |videoPeriod| apart, starting
+    // well after the vsync base, and returns the resulting statistics.
+    void feed(nsecs_t videoPeriod, size_t numFrames, VideoFrameScheduler::Stats *stats) {
+        nsecs_t renderTime = 1000000000ll;
+        for (size_t i = 0; i < numFrames; ++i) {
+            mScheduler->schedule(renderTime);
+            renderTime += videoPeriod;
+        }
+        mScheduler->getStats(stats);
+    }
+
+    // Feeds |numFrames| render times spaced |videoPeriod| apart with up to
+    // |jitter| of pseudo-random error, and returns how many vsyncs each frame
+    // was shown for.
+    void feedJittered(nsecs_t videoPeriod, nsecs_t jitter, size_t numFrames,
+            Vector<nsecs_t> *vsyncsPerFrame) {
+        nsecs_t renderTime = 1000000000ll;
+        nsecs_t lastScheduled = -1;
+        uint32_t seed = 1;
+        vsyncsPerFrame->clear();
+        for (size_t i = 0; i < numFrames; ++i) {
+            seed = seed * 1103515245 + 12345;
+            nsecs_t error = jitter > 0 ? (nsecs_t)(seed >> 8) % (2 * jitter + 1) - jitter : 0;
+            nsecs_t scheduled = mScheduler->schedule(renderTime + error);
+            if (lastScheduled >= 0) {
+                vsyncsPerFrame->push_back(
+                        (scheduled - lastScheduled + kVsyncPeriod60Hz / 2) / kVsyncPeriod60Hz);
+            }
+            lastScheduled = scheduled;
+            renderTime += videoPeriod;
+        }
+    }
+
+    sp<VideoFrameScheduler> mScheduler;
+};
+
+// frames left for the PLL to converge and the cadence to be detected
+static const size_t kSettleFrames = 24;
+
+TEST_F(VideoFrameSchedulerTest, Detects32Pulldown) {
+    mScheduler->init(24.f);
+    VideoFrameScheduler::Stats stats;
+    feed(1000000000ll / 24, 240, &stats);
+
+    EXPECT_EQ(2u, stats.mCadenceFrames);
+    EXPECT_EQ(5u, stats.mCadenceVsyncs);
+    EXPECT_GT(stats.mNumFrames, 0u);
+    EXPECT_EQ(0u, stats.mNumDropped);
+    EXPECT_EQ(0u, stats.mNumRepeated);
+    EXPECT_EQ(0u, stats.mNumCadenceBreaks);
+    // 3:2 pulldown alternates between 3 and 2 vsyncs, so frames are at most
+    // a vsync off their ideal time.
+    EXPECT_LE(stats.mMaxJudder, kVsyncPeriod60Hz);
+}
+
+TEST_F(VideoFrameSchedulerTest, DetectsSimpleCadences) {
+    VideoFrameScheduler::Stats stats;
+
+    mScheduler->init(30.f);
+    feed(1000000000ll / 30, 120, &stats);
+    EXPECT_EQ(1u, stats.mCadenceFrames);
+    EXPECT_EQ(2u, stats.mCadenceVsyncs);
+    EXPECT_EQ(0u, stats.mNumDropped);
+    EXPECT_EQ(0u, stats.mNumRepeated);
+
+    mScheduler->init(25.f);
+    feed(1000000000ll / 25, 250, &stats);
+    EXPECT_EQ(5u, stats.mCadenceFrames);
+    EXPECT_EQ(12u, stats.mCadenceVsyncs);
+    EXPECT_EQ(0u, stats.mNumDropped);
+}
+
+TEST_F(VideoFrameSchedulerTest, CountsDroppedFrames) {
+    // 90fps on 60Hz cannot show every frame
+    mScheduler->init(90.f);
+    VideoFrameScheduler::Stats stats;
+    feed(1000000000ll / 90, 270, &stats);
+
+    EXPECT_EQ(3u, stats.mCadenceFrames);
+    EXPECT_EQ(2u, stats.mCadenceVsyncs);
+    EXPECT_GT(stats.mNumDropped, 0u);
+}
+
+TEST_F(VideoFrameSchedulerTest, Follows32PulldownDespiteJitter) {
+    // render times off by up to a quarter vsync must not break the 3:2 pattern
+    mScheduler->init(24.f);
+    Vector<nsecs_t> vsyncs;
+    feedJittered(1000000000ll / 24, kVsyncPeriod60Hz / 4, 480, &vsyncs);
+
+    for (size_t i = kSettleFrames; i + 1 < vsyncs.size(); ++i) {
+        EXPECT_TRUE(vsyncs[i] == 2 || vsyncs[i] == 3) << "frame " << i;
+        EXPECT_EQ(5, vsyncs[i] + vsyncs[i + 1]) << "frame " << i;
+    }
+    VideoFrameScheduler::Stats stats;
+    mScheduler->getStats(&stats);
+    EXPECT_EQ(0u, stats.mNumDropped);
+    EXPECT_EQ(0u, stats.mNumCadenceBreaks);
+}
+
+TEST_F(VideoFrameSchedulerTest, DropsOnCadence) {
+    // 90fps on 60Hz: exactly one frame in three is dropped, in a fixed position
+    mScheduler->init(90.f);
+    Vector<nsecs_t> vsyncs;
+    feedJittered(1000000000ll / 90, kVsyncPeriod60Hz / 16, 270, &vsyncs);
+
+    for (size_t i = kSettleFrames; i + 3 < vsyncs.size(); ++i) {
+        EXPECT_TRUE(vsyncs[i] == 0 || vsyncs[i] == 1) << "frame " << i;
+        EXPECT_EQ(2, vsyncs[i] + vsyncs[i + 1] + vsyncs[i + 2]) << "frame " << i;
+        EXPECT_EQ(vsyncs[i], vsyncs[i + 3]) << "frame " << i;
+    }
+}
+
+TEST_F(VideoFrameSchedulerTest, ReanchorsCadenceOnDrift) {
+    // 23.976fps drifts from the 3:2 cadence by a vsync every 200 cycles, ~6
+    // vsyncs over 2400 frames
+    mScheduler->init(23.976f);
+    Vector<nsecs_t> vsyncs;
+    feedJittered(1000000000ll * 1001 / 24000, 0, 2400, &vsyncs);
+
+    nsecs_t total = 0;
+    for (size_t i = kSettleFrames; i < vsyncs.size(); ++i) {
+        // a 2 of the pattern becomes a 3 rather than a 3 becoming a 4
+        EXPECT_TRUE(vsyncs[i] == 2 || vsyncs[i] == 3) << "frame " << i;
+        total += vsyncs[i];
+    }
+    nsecs_t repeats = total - (nsecs_t)(vsyncs.size() - kSettleFrames) * 5 / 2;
+    EXPECT_GE(repeats, 5);
+    EXPECT_LE(repeats, 7);
+    VideoFrameScheduler::Stats stats;
+    mScheduler->getStats(&stats);
+    EXPECT_EQ(0u, stats.mNumDropped);
+    EXPECT_LE(stats.mMaxJudder, kVsyncPeriod60Hz * 3 / 2);
+}
+
+TEST_F(VideoFrameSchedulerTest, ReanchorsCadenceOnJumps) {
+    mScheduler->init(24.f);
+    const nsecs_t videoPeriod = 1000000000ll / 24;
+
+    // forward past the PLL's frame skip limit, backward, and forward by less
+    // than the limit, which does not restart the PLL
+    const nsecs_t starts[] = {
+        1000000000ll, 11000000000ll, 3000000000ll, 8300000000ll,
+    };
+    for (size_t k = 0; k < sizeof(starts) / sizeof(starts[0]); ++k) {
+        nsecs_t lastScheduled = -1;
+        nsecs_t lastVsyncs = -1;
+        for (size_t i = 0; i < 120; ++i) {
+            nsecs_t renderTime = starts[k] + videoPeriod * i;
+            nsecs_t scheduled = mScheduler->schedule(renderTime);
+            if (i < kSettleFrames) {
+                lastScheduled = scheduled;
+                continue;
+            }
+            EXPECT_LE(abs(scheduled - renderTime), 2 * kVsyncPeriod60Hz)
+                    << "jump " << k << " frame " << i;
+            nsecs_t vsyncs =
+                    (scheduled - lastScheduled + kVsyncPeriod60Hz / 2) / kVsyncPeriod60Hz;
+            EXPECT_TRUE(vsyncs == 2 || vsyncs == 3) << "jump " << k << " frame " << i;
+            if (lastVsyncs >= 0) {
+                EXPECT_EQ(5, vsyncs + lastVsyncs) << "jump " << k << " frame " << i;
+            }
+            lastScheduled = scheduled;
+            lastVsyncs = vsyncs;
+        }
+    }
+}
+
+TEST_F(VideoFrameSchedulerTest, InitResetsStats) {
+    mScheduler->init(24.f);
+    VideoFrameScheduler::Stats stats;
+    feed(1000000000ll / 24, 48, &stats);
+    EXPECT_GT(stats.mNumFrames, 0u);
+
+    mScheduler->init(24.f);
+    mScheduler->getStats(&stats);
+    EXPECT_EQ(0u, stats.mNumFrames);
+    EXPECT_EQ(0u, stats.mCadenceFrames);
+    EXPECT_EQ(0, stats.mTotalJudder);
+}
+
+} // namespace android
@@ -48,6 +48,7 @@ LOCAL_SRC_FILES:=                         \
         SampleIterator.cpp                \
         SampleTable.cpp                   \
         SkipCutBuffer.cpp                 \
+        SniffProbeSource.cpp              \
         StagefrightMediaScanner.cpp       \
         StagefrightMetadataRetriever.cpp  \
         SurfaceMediaSource.cpp            \
@@ -28,6 +28,7 @@
 #include "include/MPEG4Extractor.h"
 #include "include/NuCachedSource2.h"
 #include "include/OggExtractor.h"
+#include "include/SniffProbeSource.h"
 #include "include/WAVExtractor.h"
 #include "include/WVMExtractor.h"
 
@@ -36,6 +37,7 @@
 #include <media/IMediaHTTPConnection.h>
 #include <media/IMediaHTTPService.h>
 #include <media/stagefright/foundation/ADebug.h>
+#include <media/stagefright/foundation/ALooper.h>
 #include <media/stagefright/foundation/AMessage.h>
 #include <media/stagefright/DataSource.h>
 #include <media/stagefright/DataURISource.h>
@@ -109,15 +111,65 @@ status_t DataSource::getSize(off64_t *size) {
 ////////////////////////////////////////////////////////////////////////////////
 
 Mutex DataSource::gSnifferMutex;
-List<DataSource::SnifferFunc> DataSource::gSniffers;
+List<DataSource::Sniffer> DataSource::gSniffers;
 bool DataSource::gSniffersRegistered = false;
 
+// Enough to cover every fixed-offset signature below.
+static const size_t kSniffHeadSize = 16;
+
+static bool MatchesMPEG4Magic(const uint8_t *head, size_t size) {
+    return size >= 8 && !memcmp(&head[4], "ftyp", 4);
+}
+
+static bool MatchesMatroskaMagic(const uint8_t *head, size_t size) {
+    return size >= 4 && !memcmp(head, "\x1a\x45\xdf\xa3", 4);
+}
+
+static bool MatchesOggMagic(const uint8_t *head, size_t size) {
+    return size >= 4 && !memcmp(head, "OggS", 4);
+}
+
+static bool MatchesWAVMagic(const uint8_t *head, size_t size) {
+    return size >= 12 && !memcmp(head, "RIFF", 4) && !memcmp(&head[8], "WAVE", 4);
+}
+
+static bool MatchesFLACMagic(const uint8_t *head, size_t size) {
+    return size >= 4 && !memcmp(head, "fLaC", 4);
+}
+
+static bool MatchesAMRMagic(const uint8_t *head, size_t size) {
+    return size >= 6 && !memcmp(head, "#!AMR", 5);
+}
+
+static bool MatchesMPEG2TSMagic(const uint8_t *head, size_t size) {
+    return size >= 1 && head[0] == 0x47;
+}
+
+static bool MatchesMP3Magic(const uint8_t *head, size_t size) {
+    return size >= 3 && (!memcmp(head, "ID3", 3)
+            || (head[0] == 0xff && (head[1] & 0xe0) == 0xe0));
+}
+
+static bool MatchesAACMagic(const uint8_t *head, size_t size) {
+    return size >= 3 && (!memcmp(head, "ID3", 3)
+            || (head[0] == 0xff && (head[1] & 0xf6) == 0xf0));
+}
+
+static bool MatchesMPEG2PSMagic(const uint8_t *head, size_t size) {
+    return size >= 5 && !memcmp(head, "\x00\x00\x01\xba", 4);
+}
+
 bool DataSource::sniff(
-        String8 *mimeType, float *confidence, sp<AMessage> *meta) {
+        String8 *mimeType, float *confidence, sp<AMessage> *meta,
+        Vector<SniffStat> *stats) {
     *mimeType = "";
     *confidence = 0.0f;
     meta->clear();
 
+    if (stats != NULL) {
+        stats->clear();
+    }
+
     {
         Mutex::Autolock autoLock(gSnifferMutex);
         if (!gSniffersRegistered) {
@@ -125,17 +177,77 @@ bool DataSource::sniff(
         }
     }
 
-    for (List<SnifferFunc>::iterator it = gSniffers.begin();
-         it != gSniffers.end(); ++it) {
-        String8 newMimeType;
-        float newConfidence;
-        sp<AMessage> newMeta;
-        if ((*it)(this, &newMimeType, &newConfidence, &newMeta)) {
-            if (newConfidence > *confidence) {
-                *mimeType = newMimeType;
-                *confidence = newConfidence;
-                *meta = newMeta;
+    // All sniffers share one probe buffer over the head of the content.
+    sp<SniffProbeSource> probe = new SniffProbeSource(this);
+
+    uint8_t head[kSniffHeadSize];
+    ssize_t headSize = probe->readAt(0, head, sizeof(head));
+
+    // Sniffers whose signature matches go first, so that the likely winner
+    // is found early and everything it outranks can be skipped. Otherwise
+    // registration order is preserved, which keeps ties resolved as before.
+    Vector<const Sniffer *> ordered;
+    Vector<bool> magicMatched;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (List<Sniffer>::iterator it = gSniffers.begin();
+             it != gSniffers.end(); ++it) {
+            bool matched = headSize > 0 && (*it).mMatchesMagic != NULL
+                    && (*it).mMatchesMagic(head, headSize);
+            if (matched == (pass == 0)) {
+                ordered.push(&*it);
+                magicMatched.push(matched);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < ordered.size(); ++i) {
+        const Sniffer *sniffer = ordered[i];
+
+        // A sniffer can be skipped if it cannot beat what we already have,
+        // or if its mandatory signature is absent. If the head could not be
+        // read at all, nothing is skipped on account of its signature.
+        bool skip = sniffer->mMaxConfidence <= *confidence
+                || (headSize > 0 && sniffer->mMagicRequired
+                        && !magicMatched[i]);
+
+        SniffStat stat;
+        stat.mName = sniffer->mName;
+        stat.mTimeUs = 0;
+        stat.mBytesRequested = 0;
+        stat.mBytesFetched = 0;
+        stat.mConfidence = 0.0f;
+        stat.mSkipped = skip;
+
+        if (!skip) {
+            size_t requested = probe->bytesRequested();
+            size_t fetched = probe->bytesFetched();
+            int64_t startUs = ALooper::GetNowUs();
+
+            String8 newMimeType;
+            float newConfidence;
+            sp<AMessage> newMeta;
+            if ((*sniffer->mFunc)(probe, &newMimeType, &newConfidence, &newMeta)) {
+                stat.mConfidence = newConfidence;
+
+                if (newConfidence > *confidence) {
+                    *mimeType = newMimeType;
+                    *confidence = newConfidence;
+                    *meta = newMeta;
+                }
             }
+
+            stat.mTimeUs = ALooper::GetNowUs() - startUs;
+            stat.mBytesRequested = probe->bytesRequested() - requested;
+            stat.mBytesFetched = probe->bytesFetched() - fetched;
+        }
+
+        ALOGV("sniffer %s: %s, confidence %.2f, %lld us, "
+              "%zu bytes requested, %zu bytes fetched",
+              stat.mName, skip ? "skipped" : "ran", stat.mConfidence,
+              (long long)stat.mTimeUs, stat.mBytesRequested, stat.mBytesFetched);
+
+        if (stats != NULL) {
+            stats->push(stat);
         }
     }
 
@@ -143,15 +255,24 @@ bool DataSource::sniff(
 }
 
 // static
-void DataSource::RegisterSniffer_l(SnifferFunc func) {
-    for (List<SnifferFunc>::iterator it = gSniffers.begin();
+void DataSource::RegisterSniffer_l(
+        SnifferFunc func, const char *name, float maxConfidence,
+        MagicFunc matchesMagic, bool magicRequired) {
+    for (List<Sniffer>::iterator it = gSniffers.begin();
          it != gSniffers.end(); ++it) {
-        if (*it == func) {
+        if ((*it).mFunc == func) {
             return;
         }
     }
 
-    gSniffers.push_back(func);
+    Sniffer sniffer;
+    sniffer.mFunc = func;
+    sniffer.mName = name;
+    sniffer.mMaxConfidence = maxConfidence;
+    sniffer.mMatchesMagic = matchesMagic;
+    sniffer.mMagicRequired = magicRequired;
+
+    gSniffers.push_back(sniffer);
 }
 
 // static
@@ -161,22 +282,23 @@ void DataSource::RegisterDefaultSniffers() {
         return;
     }
 
-    RegisterSniffer_l(SniffMPEG4);
-    RegisterSniffer_l(SniffMatroska);
-    RegisterSniffer_l(SniffOgg);
-    RegisterSniffer_l(SniffWAV);
-    RegisterSniffer_l(SniffFLAC);
-    RegisterSniffer_l(SniffAMR);
-    RegisterSniffer_l(SniffMPEG2TS);
-    RegisterSniffer_l(SniffMP3);
-    RegisterSniffer_l(SniffAAC);
-    RegisterSniffer_l(SniffMPEG2PS);
-    RegisterSniffer_l(SniffWVM);
+    // The confidences below must match the highest value each sniffer reports.
+    RegisterSniffer_l(SniffMPEG4, "mpeg4", 0.4f, MatchesMPEG4Magic);
+    RegisterSniffer_l(SniffMatroska, "matroska", 0.6f, MatchesMatroskaMagic);
+    RegisterSniffer_l(SniffOgg, "ogg", 0.2f, MatchesOggMagic, true);
+    RegisterSniffer_l(SniffWAV, "wav", 0.3f, MatchesWAVMagic, true);
+    RegisterSniffer_l(SniffFLAC, "flac", 0.5f, MatchesFLACMagic, true);
+    RegisterSniffer_l(SniffAMR, "amr", 0.5f, MatchesAMRMagic, true);
+    RegisterSniffer_l(SniffMPEG2TS, "mpeg2ts", 0.1f, MatchesMPEG2TSMagic, true);
+    RegisterSniffer_l(SniffMP3, "mp3", 0.2f, MatchesMP3Magic);
+    RegisterSniffer_l(SniffAAC, "aac", 0.2f, MatchesAACMagic);
+    RegisterSniffer_l(SniffMPEG2PS, "mpeg2ps", 0.25f, MatchesMPEG2PSMagic, true);
+    RegisterSniffer_l(SniffWVM, "wvm", 10.0f);
 
     char value[PROPERTY_VALUE_MAX];
     if (property_get("drm.service.enabled", value, NULL)
             && (!strcmp(value, "1") || !strcasecmp(value, "true"))) {
-        RegisterSniffer_l(SniffDRM);
+        RegisterSniffer_l(SniffDRM, "drm", 10.0f);
     }
     gSniffersRegistered = true;
 }
@@ -0,0 +1,127 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+//#define LOG_NDEBUG 0
+#define LOG_TAG "SniffProbeSource"
+#include <utils/Log.h>
+
+#include "include/SniffProbeSource.h"
+
+#include <media/stagefright/foundation/ADebug.h>
+
+namespace android {
+
+SniffProbeSource::SniffProbeSource(const sp<DataSource> &source)
+    : mSource(source),
+      mData(NULL),
+      mCapacity(0),
+      mCachedSize(0),
+      mReachedEOS(false),
+      mBytesRequested(0),
+      mBytesFetched(0) {
+}
+
+SniffProbeSource::~SniffProbeSource() {
+    free(mData);
+    mData = NULL;
+}
+
+ssize_t SniffProbeSource::readAt(off64_t offset, void *data, size_t size) {
+    Mutex::Autolock autoLock(mLock);
+
+    if (offset < 0) {
+        return ERROR_MALFORMED;
+    }
+
+    mBytesRequested += size;
+
+    if (offset + size > kMaxProbeSize) {
+        return fetch_l(offset, data, size);
+    }
+
+    size_t cachedSize = mCachedSize;
+    status_t err = fillTo_l(offset + size);
+
+    if ((size_t)offset >= mCachedSize) {
+        // Either at end of stream or the source failed; let it tell us which.
+        return mReachedEOS ? 0 : fetch_l(offset, data, size);
+    }
+
+    // A short copy would look like the end of the stream to the caller.
+    if (err != OK && mCachedSize == cachedSize && offset + size > mCachedSize) {
+        return err;
+    }
+
+    size_t copy = mCachedSize - offset;
+    if (copy > size) {
+        copy = size;
+    }
+    memcpy(data, mData + offset, copy);
+
+    return copy;
+}
+
+ssize_t SniffProbeSource::fetch_l(off64_t offset, void *data, size_t size) {
+    ssize_t n = mSource->readAt(offset, data, size);
+    if (n > 0) {
+        mBytesFetched += n;
+    }
+    return n;
+}
+
+status_t SniffProbeSource::fillTo_l(size_t end) {
+    if (end <= mCachedSize || mReachedEOS) {
+        return OK;
+    }
+
+    // Grow geometrically so that a sniffer walking forward through the
+    // file costs O(log n) reads rather than one read per request.
+    size_t newCapacity = mCapacity < kMinProbeSize ? kMinProbeSize : mCapacity;
+    while (newCapacity < end) {
+        newCapacity *= 2;
+    }
+    if (newCapacity > kMaxProbeSize) {
+        newCapacity = kMaxProbeSize;
+    }
+
+    if (newCapacity > mCapacity) {
+        uint8_t *newData = (uint8_t *)realloc(mData, newCapacity);
+        if (newData == NULL) {
+            return NO_MEMORY;
+        }
+        mData = newData;
+        mCapacity = newCapacity;
+    }
+
+    while (mCachedSize < mCapacity) {
+        ssize_t n = fetch_l(
+                mCachedSize, mData + mCachedSize, mCapacity - mCachedSize);
+
+        if (n == 0) {
+            mReachedEOS = true;
+            break;
+        } else if (n < 0) {
+            ALOGV("read of %zu bytes at %zu failed (%zd)",
+                  mCapacity - mCachedSize, mCachedSize, n);
+            return n;
+        }
+
+        mCachedSize += n;
+    }
+    return OK;
+}
+
+}  // namespace android
@@ -48,6 +48,8 @@ StagefrightMetadataRetriever::StagefrightMetadataRetriever()
 StagefrightMetadataRetriever::~StagefrightMetadataRetriever() {
     ALOGV("~StagefrightMetadataRetriever()");
 
+    releaseThumbnailTrack();
+
     delete mAlbumArt;
     mAlbumArt = NULL;
 
@@ -60,6 +62,8 @@ status_t StagefrightMetadataRetriever::setDataSource(
         const KeyedVector<String8, String8> *headers) {
     ALOGV("setDataSource(%s)", uri);
 
+    releaseThumbnailTrack();
+
     mParsedMetaData = false;
     mMetaData.clear();
     delete mAlbumArt;
@@ -92,6 +96,8 @@ status_t StagefrightMetadataRetriever::setDataSource(
 
     ALOGV("setDataSource(%d, %" PRId64 ", %" PRId64 ")", fd, offset, length);
 
+    releaseThumbnailTrack();
+
     mParsedMetaData = false;
     mMetaData.clear();
     delete mAlbumArt;
@@ -142,14 +148,13 @@ static bool isYUV420PlanarSupported(
     return false;
 }
 
-static VideoFrame *extractVideoFrameWithCodecFlags(
+// Instantiates and starts a decoder for the video track that hands out
+// frames in memory the color converter can read.
+static sp<MediaSource> createVideoDecoder(
         OMXClient *client,
         const sp<MetaData> &trackMeta,
         const sp<MediaSource> &source,
-        uint32_t flags,
-        int64_t frameTimeUs,
-        int seekMode) {
-
+        uint32_t flags) {
     sp<MetaData> format = source->getFormat();
 
     // XXX:
@@ -176,6 +181,18 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
         return NULL;
     }
 
+    return decoder;
+}
+
+// Seeks the decoder and reads the first frame it produces from there.
+static status_t readVideoFrame(
+        const sp<MediaSource> &decoder,
+        const sp<MetaData> &trackMeta,
+        int64_t frameTimeUs,
+        int seekMode,
+        MediaBuffer **out) {
+    *out = NULL;
+
     // Read one output buffer, ignore format change notifications
     // and spurious empty buffers.
 
@@ -184,7 +201,7 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
         seekMode > MediaSource::ReadOptions::SEEK_CLOSEST) {
 
         ALOGE("Unknown seek mode: %d", seekMode);
-        return NULL;
+        return BAD_VALUE;
     }
 
     MediaSource::ReadOptions::SeekMode mode =
@@ -202,6 +219,7 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
         options.setSeekTo(frameTimeUs, mode);
     }
 
+    status_t err;
     MediaBuffer *buffer = NULL;
     do {
         if (buffer != NULL) {
@@ -217,9 +235,8 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
         CHECK(buffer == NULL);
 
         ALOGV("decoding frame failed.");
-        decoder->stop();
 
-        return NULL;
+        return err;
     }
 
     ALOGV("successfully decoded video frame.");
@@ -233,9 +250,7 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
         buffer->release();
         buffer = NULL;
 
-        decoder->stop();
-
-        return NULL;
+        return ERROR_UNSUPPORTED;
     }
 
     int64_t timeUs;
@@ -250,6 +265,20 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
         }
     }
 
+    *out = buffer;
+
+    return OK;
+}
+
+// Converts a decoded frame to RGB565. If maxWidth and maxHeight are
+// positive and the frame does not fit, it is scaled down, preserving its
+// aspect ratio, as part of the conversion.
+static VideoFrame *convertVideoFrame(
+        const sp<MediaSource> &decoder,
+        const sp<MetaData> &trackMeta,
+        MediaBuffer *buffer,
+        int32_t maxWidth,
+        int32_t maxHeight) {
     sp<MetaData> meta = decoder->getFormat();
 
     int32_t width, height;
@@ -270,21 +299,34 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
         rotationAngle = 0;  // By default, no rotation
     }
 
-    VideoFrame *frame = new VideoFrame;
-    frame->mWidth = crop_right - crop_left + 1;
-    frame->mHeight = crop_bottom - crop_top + 1;
-    frame->mDisplayWidth = frame->mWidth;
-    frame->mDisplayHeight = frame->mHeight;
-    frame->mSize = frame->mWidth * frame->mHeight * 2;
-    frame->mData = new uint8_t[frame->mSize];
-    frame->mRotationAngle = rotationAngle;
+    int32_t cropWidth = crop_right - crop_left + 1;
+    int32_t cropHeight = crop_bottom - crop_top + 1;
+
+    int32_t frameWidth = cropWidth;
+    int32_t frameHeight = cropHeight;
+    if (maxWidth > 0 && maxHeight > 0
+            && (cropWidth > maxWidth || cropHeight > maxHeight)) {
+        if ((int64_t)cropWidth * maxHeight > (int64_t)cropHeight * maxWidth) {
+            frameWidth = maxWidth;
+            frameHeight = (int64_t)cropHeight * maxWidth / cropWidth;
+        } else {
+            frameHeight = maxHeight;
+            frameWidth = (int64_t)cropWidth * maxHeight / cropHeight;
+        }
+        if (frameWidth < 1) {
+            frameWidth = 1;
+        }
+        if (frameHeight < 1) {
+            frameHeight = 1;
+        }
+    }
 
     int32_t displayWidth, displayHeight;
-    if (meta->findInt32(kKeyDisplayWidth, &displayWidth)) {
-        frame->mDisplayWidth = displayWidth;
+    if (!meta->findInt32(kKeyDisplayWidth, &displayWidth)) {
+        displayWidth = cropWidth;
     }
-    if (meta->findInt32(kKeyDisplayHeight, &displayHeight)) {
-        frame->mDisplayHeight = displayHeight;
+    if (!meta->findInt32(kKeyDisplayHeight, &displayHeight)) {
+        displayHeight = cropHeight;
     }
 
     int32_t srcFormat;
@@ -293,7 +335,41 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
     ColorConverter converter(
             (OMX_COLOR_FORMATTYPE)srcFormat, OMX_COLOR_Format16bitRGB565);
 
-    if (converter.isValid()) {
+    if (!converter.isValid()) {
+        ALOGE("Unable to instantiate color conversion from format 0x%08x to "
+              "RGB565",
+              srcFormat);
+
+        return NULL;
+    }
+
+    VideoFrame *frame = NULL;
+    status_t err = ERROR_UNSUPPORTED;
+    for (int attempt = 0; attempt < 2 && err != OK; ++attempt) {
+        if (attempt > 0) {
+            if (frameWidth == cropWidth && frameHeight == cropHeight) {
+                break;
+            }
+
+            // Scaling is not supported for this color format, hand out the
+            // frame at full size instead.
+            ALOGV("unable to scale frame, converting at %dx%d",
+                  cropWidth, cropHeight);
+
+            delete frame;
+            frameWidth = cropWidth;
+            frameHeight = cropHeight;
+        }
+
+        frame = new VideoFrame;
+        frame->mWidth = frameWidth;
+        frame->mHeight = frameHeight;
+        frame->mDisplayWidth = (int64_t)displayWidth * frameWidth / cropWidth;
+        frame->mDisplayHeight = (int64_t)displayHeight * frameHeight / cropHeight;
+        frame->mSize = frame->mWidth * frame->mHeight * 2;
+        frame->mData = new uint8_t[frame->mSize];
+        frame->mRotationAngle = rotationAngle;
+
         err = converter.convert(
                 (const uint8_t *)buffer->data() + buffer->range_offset(),
                 width, height,
@@ -302,19 +378,8 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
                 frame->mWidth,
                 frame->mHeight,
                 0, 0, frame->mWidth - 1, frame->mHeight - 1);
-    } else {
-        ALOGE("Unable to instantiate color conversion from format 0x%08x to "
-              "RGB565",
-              srcFormat);
-
-        err = ERROR_UNSUPPORTED;
     }
 
-    buffer->release();
-    buffer = NULL;
-
-    decoder->stop();
-
     if (err != OK) {
         ALOGE("Colorconverter failed to convert frame.");
 
@@ -325,27 +390,53 @@ static VideoFrame *extractVideoFrameWithCodecFlags(
     return frame;
 }
 
-VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
-        int64_t timeUs, int option) {
+static VideoFrame *extractVideoFrameWithCodecFlags(
+        OMXClient *client,
+        const sp<MetaData> &trackMeta,
+        const sp<MediaSource> &source,
+        uint32_t flags,
+        int64_t frameTimeUs,
+        int seekMode) {
+    sp<MediaSource> decoder = createVideoDecoder(client, trackMeta, source, flags);
+    if (decoder == NULL) {
+        return NULL;
+    }
 
-    ALOGV("getFrameAtTime: %" PRId64 " us option: %d", timeUs, option);
+    MediaBuffer *buffer;
+    if (readVideoFrame(decoder, trackMeta, frameTimeUs, seekMode, &buffer) != OK) {
+        decoder->stop();
+
+        return NULL;
+    }
 
+    VideoFrame *frame = convertVideoFrame(decoder, trackMeta, buffer, 0, 0);
+
+    buffer->release();
+    buffer = NULL;
+
+    decoder->stop();
+
+    return frame;
+}
+
+status_t StagefrightMetadataRetriever::getVideoTrack(
+        sp<MetaData> *trackMeta, sp<MediaSource> *source) {
     if (mExtractor.get() == NULL) {
         ALOGV("no extractor.");
-        return NULL;
+        return NO_INIT;
     }
 
     sp<MetaData> fileMeta = mExtractor->getMetaData();
 
     if (fileMeta == NULL) {
         ALOGV("extractor doesn't publish metadata, failed to initialize?");
-        return NULL;
+        return NO_INIT;
     }
 
     int32_t drm = 0;
     if (fileMeta->findInt32(kKeyIsDRM, &drm) && drm != 0) {
         ALOGE("frame grab not allowed.");
-        return NULL;
+        return PERMISSION_DENIED;
     }
 
     size_t n = mExtractor->countTracks();
@@ -363,17 +454,17 @@ VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
 
     if (i == n) {
         ALOGV("no video track found.");
-        return NULL;
+        return ERROR_UNSUPPORTED;
     }
 
-    sp<MetaData> trackMeta = mExtractor->getTrackMetaData(
+    *trackMeta = mExtractor->getTrackMetaData(
             i, MediaExtractor::kIncludeExtensiveMetaData);
 
-    sp<MediaSource> source = mExtractor->getTrack(i);
+    *source = mExtractor->getTrack(i);
 
-    if (source.get() == NULL) {
+    if (source->get() == NULL) {
         ALOGV("unable to instantiate video track.");
-        return NULL;
+        return UNKNOWN_ERROR;
     }
 
     const void *data;
@@ -384,6 +475,20 @@ VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
         mAlbumArt = MediaAlbumArt::fromData(dataSize, data);
     }
 
+    return OK;
+}
+
+VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
+        int64_t timeUs, int option) {
+
+    ALOGV("getFrameAtTime: %" PRId64 " us option: %d", timeUs, option);
+
+    sp<MetaData> trackMeta;
+    sp<MediaSource> source;
+    if (getVideoTrack(&trackMeta, &source) != OK) {
+        return NULL;
+    }
+
     VideoFrame *frame =
         extractVideoFrameWithCodecFlags(
                 &mClient, trackMeta, source, OMXCodec::kPreferSoftwareCodecs,
@@ -400,6 +505,72 @@ VideoFrame *StagefrightMetadataRetriever::getFrameAtTime(
     return frame;
 }
 
+VideoFrame *StagefrightMetadataRetriever::getThumbnailAtTime(
+        int64_t timeUs, int option, int maxWidth, int maxHeight) {
+
+    ALOGV("getThumbnailAtTime: %" PRId64 " us option: %d max %dx%d",
+          timeUs, option, maxWidth, maxHeight);
+
+    // Only sync frames are decoded, there is no point in decoding up to
+    // the exact time for a thumbnail.
+    if (option == MediaSource::ReadOptions::SEEK_CLOSEST) {
+        option = MediaSource::ReadOptions::SEEK_CLOSEST_SYNC;
+    }
+
+    VideoFrame *frame = NULL;
+
+    // The decoder stays around between calls. If it fails, it is replaced
+    // by one that need not be a software decoder.
+    for (int attempt = 0; attempt < 2 && frame == NULL; ++attempt) {
+        if (mThumbnailDecoder == NULL) {
+            if (mThumbnailTrack == NULL
+                    && getVideoTrack(&mThumbnailTrackMeta, &mThumbnailTrack) != OK) {
+                return NULL;
+            }
+
+            mThumbnailDecoder = createVideoDecoder(
+                    &mClient, mThumbnailTrackMeta, mThumbnailTrack,
+                    attempt == 0 ? OMXCodec::kPreferSoftwareCodecs : 0);
+
+            if (mThumbnailDecoder == NULL) {
+                continue;
+            }
+        }
+
+        MediaBuffer *buffer;
+        if (readVideoFrame(mThumbnailDecoder, mThumbnailTrackMeta,
+                    timeUs, option, &buffer) != OK) {
+            stopThumbnailDecoder();
+            continue;
+        }
+
+        // We have our frame, keep the decoder from working ahead until the
+        // next request seeks it again.
+        mThumbnailDecoder->pause();
+
+        frame = convertVideoFrame(
+                mThumbnailDecoder, mThumbnailTrackMeta, buffer, maxWidth, maxHeight);
+
+        buffer->release();
+        buffer = NULL;
+    }
+
+    return frame;
+}
+
+void StagefrightMetadataRetriever::stopThumbnailDecoder() {
+    if (mThumbnailDecoder != NULL) {
+        mThumbnailDecoder->stop();
+        mThumbnailDecoder.clear();
+    }
+}
+
+void StagefrightMetadataRetriever::releaseThumbnailTrack() {
+    stopThumbnailDecoder();
+    mThumbnailTrack.clear();
+    mThumbnailTrackMeta.clear();
+}
+
 MediaAlbumArt *StagefrightMetadataRetriever::extractAlbumArt() {
     ALOGV("extractAlbumArt (extractor: %s)", mExtractor.get() != NULL ? "YES" : "NO");
 
@@ -101,6 +101,24 @@ status_t ColorConverter::convert(
 
     status_t err;
 
+    if (src.cropWidth() != dst.cropWidth()
+            || src.cropHeight() != dst.cropHeight()) {
+        if (dst.cropWidth() > src.cropWidth()
+                || dst.cropHeight() > src.cropHeight()) {
+            return ERROR_UNSUPPORTED;
+        }
+
+        switch (mSrcFormat) {
+            case OMX_COLOR_FormatYUV420Planar:
+            case OMX_QCOM_COLOR_FormatYVU420SemiPlanar:
+            case OMX_COLOR_FormatYUV420SemiPlanar:
+                return convertYUV420Scaled(src, dst);
+
+            default:
+                return ERROR_UNSUPPORTED;
+        }
+    }
+
     switch (mSrcFormat) {
         case OMX_COLOR_FormatYUV420Planar:
             err = convertYUV420Planar(src, dst);
@@ -506,6 +524,104 @@ status_t ColorConverter::convertTIYUV420PackedSemiPlanar(
     return OK;
 }
 
+// Converts and downsamples in a single pass, so that only the pixels that
+// end up in the destination are ever converted. Each destination pixel
+// takes the chroma of the source pixel at its center and, when shrinking by
+// at least 2x, the average luma of the 2x2 block there to limit aliasing.
+// The output channel order matches the unscaled converters of each format.
+status_t ColorConverter::convertYUV420Scaled(
+        const BitmapParams &src, const BitmapParams &dst) {
+    uint8_t *kAdjustedClip = initClip();
+
+    const size_t srcCropWidth = src.cropWidth();
+    const size_t srcCropHeight = src.cropHeight();
+    const size_t dstCropWidth = dst.cropWidth();
+    const size_t dstCropHeight = dst.cropHeight();
+
+    const bool averageLuma =
+        srcCropWidth >= 2 * dstCropWidth && srcCropHeight >= 2 * dstCropHeight;
+
+    const uint8_t *yPlane = (const uint8_t *)src.mBits;
+    const uint8_t *chromaPlane = yPlane + src.mWidth * src.mHeight;
+
+    bool planar = (mSrcFormat == OMX_COLOR_FormatYUV420Planar);
+    bool swapRB = !planar;
+    size_t uOffset = (mSrcFormat == OMX_COLOR_FormatYUV420SemiPlanar) ? 1 : 0;
+    size_t vOffset = 1 - uOffset;
+
+    const uint8_t *uPlane = chromaPlane;
+    const uint8_t *vPlane = chromaPlane + (src.mWidth / 2) * (src.mHeight / 2);
+
+    // Source column for each destination column, at the center of its span.
+    size_t *srcX = new size_t[dstCropWidth];
+    for (size_t x = 0; x < dstCropWidth; ++x) {
+        srcX[x] = src.mCropLeft + ((2 * x + 1) * srcCropWidth) / (2 * dstCropWidth);
+        if (averageLuma && srcX[x] + 1 > src.mCropRight) {
+            srcX[x] = src.mCropRight - 1;
+        }
+    }
+
+    uint16_t *dst_ptr = (uint16_t *)dst.mBits
+        + dst.mCropTop * dst.mWidth + dst.mCropLeft;
+
+    for (size_t y = 0; y < dstCropHeight; ++y) {
+        size_t sy = src.mCropTop + ((2 * y + 1) * srcCropHeight) / (2 * dstCropHeight);
+        if (averageLuma && sy + 1 > src.mCropBottom) {
+            sy = src.mCropBottom - 1;
+        }
+
+        const uint8_t *src_y = yPlane + sy * src.mWidth;
+        const uint8_t *src_y2 = src_y + src.mWidth;
+
+        for (size_t x = 0; x < dstCropWidth; ++x) {
+            size_t sx = srcX[x];
+
+            signed luma;
+            if (averageLuma) {
+                luma = ((signed)src_y[sx] + src_y[sx + 1]
+                        + src_y2[sx] + src_y2[sx + 1] + 2) / 4;
+            } else {
+                luma = src_y[sx];
+            }
+
+            signed u, v;
+            if (planar) {
+                size_t chromaIndex = (sy / 2) * (src.mWidth / 2) + sx / 2;
+                u = uPlane[chromaIndex];
+                v = vPlane[chromaIndex];
+            } else {
+                const uint8_t *src_uv = chromaPlane + (sy / 2) * src.mWidth + (sx & ~1);
+                u = src_uv[uOffset];
+                v = src_uv[vOffset];
+            }
+            u -= 128;
+            v -= 128;
+
+            signed tmp = (luma - 16) * 298;
+            signed b = (tmp + u * 517) / 256;
+            signed g = (tmp - v * 208 - u * 100) / 256;
+            signed r = (tmp + v * 409) / 256;
+
+            if (swapRB) {
+                signed t = r;
+                r = b;
+                b = t;
+            }
+
+            dst_ptr[x] =
+                ((kAdjustedClip[r] >> 3) << 11)
+                | ((kAdjustedClip[g] >> 2) << 5)
+                | (kAdjustedClip[b] >> 3);
+        }
+
+        dst_ptr += dst.mWidth;
+    }
+
+    delete[] srcX;
+
+    return OK;
+}
+
 uint8_t *ColorConverter::initClip() {
     static const signed kClipMin = -278;
     static const signed kClipMax = 535;
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SNIFF_PROBE_SOURCE_H_
+
+#define SNIFF_PROBE_SOURCE_H_
+
+#include <media/stagefright/DataSource.h>
+#include <utils/threads.h>
+
+namespace android {
+
+// Wraps a DataSource for the duration of DataSource::sniff(). All sniffers
+// read through one buffer that caches the head of the source and grows on
+// demand, so the many small overlapping reads they issue near the start of
+// the file turn into a handful of larger reads on the underlying source.
+// Reads that fall (partially) beyond kMaxProbeSize go straight through.
+struct SniffProbeSource : public DataSource {
+    SniffProbeSource(const sp<DataSource> &source);
+
+    virtual ssize_t readAt(off64_t offset, void *data, size_t size);
+
+    // Bytes requested by callers of readAt() so far.
+    size_t bytesRequested() const { return mBytesRequested; }
+
+    // Bytes actually read from the wrapped source so far.
+    size_t bytesFetched() const { return mBytesFetched; }
+
+    // following methods all call through to the wrapped DataSource's methods
+
+    virtual status_t initCheck() const {
+        return mSource->initCheck();
+    }
+
+    virtual status_t getSize(off64_t *size) {
+        return mSource->getSize(size);
+    }
+
+    virtual uint32_t flags() {
+        return mSource->flags();
+    }
+
+    virtual status_t reconnectAtOffset(off64_t offset) {
+        return mSource->reconnectAtOffset(offset);
+    }
+
+    virtual sp<DecryptHandle> DrmInitialization(const char *mime = NULL) {
+        return mSource->DrmInitialization(mime);
+    }
+
+    virtual void getDrmInfo(sp<DecryptHandle> &handle, DrmManagerClient **client) {
+        mSource->getDrmInfo(handle, client);
+    };
+
+    virtual String8 getUri() {
+        return mSource->getUri();
+    }
+
+    virtual String8 getMIMEType() const {
+        return mSource->getMIMEType();
+    }
+
+protected:
+    virtual ~SniffProbeSource();
+
+private:
+    enum {
+        kMinProbeSize = 4096,
+        kMaxProbeSize = 256 * 1024,
+    };
+
+    Mutex mLock;
+
+    sp<DataSource> mSource;
+
+    uint8_t *mData;
+    size_t mCapacity;
+    size_t mCachedSize;
+    bool mReachedEOS;
+
+    size_t mBytesRequested;
+    size_t mBytesFetched;
+
+    ssize_t fetch_l(off64_t offset, void *data, size_t size);
+    // Returns the error of the underlying source if a read failed.
+    status_t fillTo_l(size_t end);
+
+    SniffProbeSource(const SniffProbeSource &);
+    SniffProbeSource &operator=(const SniffProbeSource &);
+};
+
+}  // namespace android
+
+#endif  // SNIFF_PROBE_SOURCE_H_
@@ -27,6 +27,8 @@ namespace android {
 
 struct DataSource;
 class MediaExtractor;
+struct MediaSource;
+class MetaData;
 
 struct StagefrightMetadataRetriever : public MediaMetadataRetrieverInterface {
     StagefrightMetadataRetriever();
@@ -40,6 +42,8 @@ struct StagefrightMetadataRetriever : public MediaMetadataRetrieverInterface {
     virtual status_t setDataSource(int fd, int64_t offset, int64_t length);
 
     virtual VideoFrame *getFrameAtTime(int64_t timeUs, int option);
+    virtual VideoFrame *getThumbnailAtTime(
+            int64_t timeUs, int option, int maxWidth, int maxHeight);
     virtual MediaAlbumArt *extractAlbumArt();
     virtual const char *extractMetadata(int keyCode);
 
@@ -52,8 +56,18 @@ private:
     KeyedVector<int, String8> mMetaData;
     MediaAlbumArt *mAlbumArt;
 
+    // Kept across getThumbnailAtTime() calls on the same data source. The
+    // track is looked up once, decoders that fail are replaced on top of it.
+    sp<MediaSource> mThumbnailDecoder;
+    sp<MediaSource> mThumbnailTrack;
+    sp<MetaData> mThumbnailTrackMeta;
+
     void parseMetaData();
 
+    status_t getVideoTrack(sp<MetaData> *trackMeta, sp<MediaSource> *source);
+    void stopThumbnailDecoder();
+    void releaseThumbnailTrack();
+
     StagefrightMetadataRetriever(const StagefrightMetadataRetriever &);
 
     StagefrightMetadataRetriever &operator=(
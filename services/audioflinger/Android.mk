@@ -28,8 +28,10 @@ LOCAL_SRC_FILES:=               \
     Threads.cpp                 \
     Tracks.cpp                  \
     Effects.cpp                 \
+    EffectWorker.cpp            \
     AudioMixer.cpp.arm          \
-    PatchPanel.cpp
+    PatchPanel.cpp              \
+    SharedRecordConversion.cpp
 
 LOCAL_SRC_FILES += StateQueue.cpp
 
@@ -51,8 +51,10 @@
 #include <media/AudioBufferProvider.h>
 #include <media/ExtendedAudioBufferProvider.h>
 
+#include "EffectWorker.h"
 #include "FastCapture.h"
 #include "FastMixer.h"
+#include "SharedRecordConversion.h"
 #include <media/nbaio/NBAIO.h>
 #include "AudioWatchdog.h"
 #include "AudioMixer.h"
@@ -444,6 +446,7 @@ private:
     class OffloadThread;
     class DuplicatingThread;
     class AsyncCallbackThread;
+    class EffectWorkerThread;
     class Track;
     class RecordTrack;
     class EffectModule;
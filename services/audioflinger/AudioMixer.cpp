@@ -248,7 +248,7 @@ AudioMixer::DownmixerBufferProvider::DownmixerBufferProvider(
          return;
      }
 
-     // Set downmix type
+     // Set downmix type: the fold type applies the downmix matrix computed for the input mask
      // parameter size rounded for padding on 32bit boundary
      const int psizePadded = ((sizeof(downmix_params_t) - 1)/sizeof(int) + 1) * sizeof(int);
      const int downmixParamSize =
@@ -505,9 +505,6 @@ int AudioMixer::getTrackName(audio_channel_mask_t channelMask,
             ALOGE("AudioMixer::getTrackName invalid channelMask (%#x)", channelMask);
             return -1;
         }
-        // initTrackDownmix() may change the input format requirement.
-        // If you desire floating point input to the mixer, it may change
-        // to integer because the downmixer requires integer to process.
         ALOGVV("mMixerFormat:%#x  mMixerInFormat:%#x\n", t->mMixerFormat, t->mMixerInFormat);
         prepareTrackForReformat(t, n);
         mTrackNames |= 1 << n;
@@ -526,8 +523,8 @@ void AudioMixer::invalidateState(uint32_t mask)
  }
 
 // Called when channel masks have changed for a track name
-// TODO: Fix Downmixbufferprofider not to (possibly) change mixer input format,
-// which will simplify this logic.
+// The downmixer and the remixer are configured with the track's mMixerInFormat, 16 bit or
+// float, so the mixer input format only changes when it is reset to the preferred format.
 bool AudioMixer::setChannelMasks(int name,
         audio_channel_mask_t trackChannelMask, audio_channel_mask_t mixerChannelMask) {
     track_t &track = mState.tracks[name];
@@ -561,7 +558,7 @@ bool AudioMixer::setChannelMasks(int name,
 
     const bool mixerInFormatChanged = prevMixerInFormat != track.mMixerInFormat;
     if (mixerInFormatChanged) {
-        prepareTrackForReformat(&track, name); // because of downmixer, track format may change!
+        prepareTrackForReformat(&track, name); // the track is converted to mMixerInFormat
     }
 
     if (track.resampler && (mixerInFormatChanged || mixerChannelCountChanged)) {
@@ -611,13 +608,12 @@ status_t AudioMixer::prepareTrackForDownmix(track_t* pTrack, int trackName)
     // discard the previous downmixer if there was one
     unprepareTrackForDownmix(pTrack, trackName);
     if (DownmixerBufferProvider::isMultichannelCapable()) {
+        // the downmix effect processes PCM 16 bit and float, so the mixer input format is kept
         DownmixerBufferProvider* pDbp = new DownmixerBufferProvider(pTrack->channelMask,
-                pTrack->mMixerChannelMask,
-                AUDIO_FORMAT_PCM_16_BIT /* TODO: use pTrack->mMixerInFormat, now only PCM 16 */,
+                pTrack->mMixerChannelMask, pTrack->mMixerInFormat,
                 pTrack->sampleRate, pTrack->sessionId, kCopyBufferFrameCount);
 
         if (pDbp->isValid()) { // if constructor completed properly
-            pTrack->mMixerInFormat = AUDIO_FORMAT_PCM_16_BIT; // PCM 16 bit required for downmix
             pTrack->downmixerBufferProvider = pDbp;
             reconfigureBufferProviders(pTrack);
             return NO_ERROR;
@@ -33,6 +33,9 @@
 #define FAST_MIXER_STATISTICS
 // FIXME rename to FAST_THREAD_STATISTICS
 
+// uncomment to time each effect engine process call, for the statistics in dumpsys
+#define EFFECT_PROCESS_STATISTICS
+
 // uncomment for debugging timing problems related to StateQueue::push()
 //#define STATE_QUEUE_DUMP
 
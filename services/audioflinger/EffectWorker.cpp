@@ -0,0 +1,205 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "EffectWorker"
+//#define LOG_NDEBUG 0
+
+#include "Configuration.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <utils/Log.h>
+#include "EffectWorker.h"
+
+namespace android {
+
+EffectWorker::EffectWorker(size_t frameCount, uint32_t channelCount)
+    :   Thread(false /*canCallJava*/),
+        mFrameCount(frameCount),
+        mChannelCount(channelCount),
+        mBuffer(NULL),
+        mPending(false),
+        mNumBuffers(0),
+        mNumStalls(0),
+        mProcessNs(0),
+        mMaxProcessNs(0),
+        mStallNs(0)
+{
+    const size_t size = mFrameCount * mChannelCount * sizeof(int16_t);
+    (void)posix_memalign((void **)&mBuffer, 32, size);
+    memset(mBuffer, 0, size);
+}
+
+EffectWorker::~EffectWorker()
+{
+    free(mBuffer);
+    for (size_t i = 0; i < mAuxBuffers.size(); i++) {
+        delete[] mAuxBuffers[i].buffer;
+    }
+}
+
+void EffectWorker::onFirstRef()
+{
+    run("Effect Worker", ANDROID_PRIORITY_URGENT_AUDIO);
+}
+
+bool EffectWorker::threadLoop()
+{
+    while (!exitPending()) {
+        {
+            Mutex::Autolock _l(mLock);
+            while (!mPending && !exitPending()) {
+                mWorkCV.wait(mLock);
+            }
+            if (exitPending()) {
+                break;
+            }
+        }
+
+        // mBuffer is not accessed by exchange() or flush() while mPending is true
+        nsecs_t start = systemTime();
+        process();
+        nsecs_t delta = systemTime() - start;
+
+        {
+            Mutex::Autolock _l(mLock);
+            mPending = false;
+            mNumBuffers++;
+            mProcessNs += delta;
+            if (delta > mMaxProcessNs) {
+                mMaxProcessNs = delta;
+            }
+            mDoneCV.signal();
+        }
+    }
+
+    Mutex::Autolock _l(mLock);
+    mPending = false;
+    mDoneCV.broadcast();
+    return false;
+}
+
+void EffectWorker::exit()
+{
+    ALOGV("EffectWorker::exit");
+    Mutex::Autolock _l(mLock);
+    requestExit();
+    mWorkCV.broadcast();
+}
+
+void EffectWorker::exchange(int16_t *buffer)
+{
+    Mutex::Autolock _l(mLock);
+    if (mPending) {
+        // the worker did not keep up: the caller is now late by the remaining processing
+        nsecs_t start = systemTime();
+        waitIdle_l();
+        mNumStalls++;
+        mStallNs += systemTime() - start;
+    }
+    if (exitPending()) {
+        return;
+    }
+    std::swap_ranges(buffer, buffer + mFrameCount * mChannelCount, mBuffer);
+    // The effect input buffers are only written here, while the worker is idle. A send is
+    // dropped if its effect is gone, and its buffer is freed once the mixer stops using it.
+    for (size_t i = 0; i < mAuxBuffers.size(); ) {
+        AuxBuffer& aux = mAuxBuffers.editItemAt(i);
+        if (aux.effectBuffer != NULL) {
+            memcpy(aux.effectBuffer, aux.buffer, mFrameCount * sizeof(int32_t));
+        }
+        if (aux.used) {
+            memset(aux.buffer, 0, mFrameCount * sizeof(int32_t));
+            aux.used = false;
+            i++;
+        } else {
+            delete[] aux.buffer;
+            mAuxBuffers.removeAt(i);
+        }
+    }
+    onExchange_l();
+    mPending = true;
+    mWorkCV.signal();
+}
+
+void EffectWorker::flush()
+{
+    Mutex::Autolock _l(mLock);
+    waitIdle_l();
+    memset(mBuffer, 0, mFrameCount * mChannelCount * sizeof(int16_t));
+    for (size_t i = 0; i < mAuxBuffers.size(); i++) {
+        memset(mAuxBuffers[i].buffer, 0, mFrameCount * sizeof(int32_t));
+    }
+}
+
+void EffectWorker::waitIdle_l()
+{
+    while (mPending && !exitPending()) {
+        mDoneCV.wait(mLock);
+    }
+}
+
+int32_t *EffectWorker::auxBuffer(int effectId, int32_t *effectBuffer)
+{
+    Mutex::Autolock _l(mLock);
+    for (size_t i = 0; i < mAuxBuffers.size(); i++) {
+        if (mAuxBuffers[i].effectId == effectId) {
+            AuxBuffer& aux = mAuxBuffers.editItemAt(i);
+            aux.effectBuffer = effectBuffer;
+            aux.used = true;
+            return aux.buffer;
+        }
+    }
+    AuxBuffer aux;
+    aux.effectId = effectId;
+    aux.buffer = new int32_t[mFrameCount];
+    memset(aux.buffer, 0, mFrameCount * sizeof(int32_t));
+    aux.effectBuffer = effectBuffer;
+    aux.used = true;
+    mAuxBuffers.add(aux);
+    return aux.buffer;
+}
+
+void EffectWorker::detachAuxEffect(int effectId)
+{
+    Mutex::Autolock _l(mLock);
+    for (size_t i = 0; i < mAuxBuffers.size(); i++) {
+        if (mAuxBuffers[i].effectId == effectId) {
+            mAuxBuffers.editItemAt(i).effectBuffer = NULL;
+            break;
+        }
+    }
+}
+
+uint32_t EffectWorker::numStalls()
+{
+    Mutex::Autolock _l(mLock);
+    return mNumStalls;
+}
+
+void EffectWorker::dump(int fd)
+{
+    Mutex::Autolock _l(mLock);
+    dprintf(fd, "  Effect worker buffers: %u\n", mNumBuffers);
+    if (mNumBuffers != 0) {
+        dprintf(fd, "  Effect worker process time (msecs): mean %.3f max %.3f\n",
+                (mProcessNs / mNumBuffers) * 1e-6, mMaxProcessNs * 1e-6);
+    }
+    dprintf(fd, "  Effect worker stalls: %u (%.3f msecs)\n", mNumStalls, mStallNs * 1e-6);
+}
+
+}   // namespace android
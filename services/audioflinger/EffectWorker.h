@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+// The effect worker processes the mix of a playback thread one buffer behind the mixer, so
+// that the effects of a buffer run while the mixer prepares the next one. The mixer and the
+// worker meet once per buffer in exchange(). The effects themselves are run by subclasses,
+// see AudioFlinger::EffectWorkerThread.
+
+#ifndef EFFECT_WORKER_H
+#define EFFECT_WORKER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <utils/Thread.h>
+#include <utils/Timers.h>
+#include <utils/Vector.h>
+
+namespace android {
+
+class EffectWorker : public Thread {
+public:
+
+    EffectWorker(size_t frameCount, uint32_t channelCount);
+
+    virtual             ~EffectWorker();
+
+    // Thread virtuals
+    virtual bool        threadLoop();
+
+    // RefBase
+    virtual void        onFirstRef();
+
+            void        exit();
+
+    // Waits until the previous buffer has been processed, exchanges it with the content of
+    // buffer and starts processing the new content.
+    // buffer holds mFrameCount frames of 16 bit PCM. The sends to auxiliary effects mixed
+    // since the previous exchange are handed over to the effects at the same time.
+            void        exchange(int16_t *buffer);
+
+    // Waits until the current buffer has been processed and replaces it and the auxiliary
+    // sends with silence.
+            void        flush();
+
+    // Input and output buffer of the effects processed by this worker
+            int16_t    *buffer() const { return mBuffer; }
+
+    // Returns the buffer the mixer accumulates the send to auxiliary effect effectId into, in
+    // place of effectBuffer, the effect input buffer which the worker reads while the mixer
+    // runs. exchange() copies it to effectBuffer along with the mix.
+            int32_t    *auxBuffer(int effectId, int32_t *effectBuffer);
+
+    // Stops copying the send to auxiliary effect effectId, whose input buffer is about to
+    // be freed.
+            void        detachAuxEffect(int effectId);
+
+    // Number of exchanges which waited for processing
+            uint32_t    numStalls();
+
+            void        dump(int fd);
+
+protected:
+    // Processes buffer() in place, called on the worker thread without mLock held
+    virtual void        process() = 0;
+
+    // Called by exchange() with mLock held when a new buffer is handed over, to pick up
+    // the work for it
+    virtual void        onExchange_l() { }
+
+    // Waits until the current buffer has been processed
+            void        waitIdle_l();
+
+    Mutex                      mLock;
+
+private:
+    const size_t               mFrameCount;
+    const uint32_t             mChannelCount;
+    int16_t                   *mBuffer;
+
+    struct AuxBuffer {
+        int         effectId;
+        int32_t    *buffer;     // mFrameCount mono frames, as the effect input buffer
+        int32_t    *effectBuffer; // effect input buffer, NULL once the effect is detached
+        bool        used;       // returned by auxBuffer() since the last exchange()
+    };
+    Vector<AuxBuffer>          mAuxBuffers;
+    bool                       mPending;    // true until mBuffer has been processed
+    Condition                  mWorkCV;     // signaled when mPending is set
+    Condition                  mDoneCV;     // signaled when mPending is cleared
+
+    // statistics, protected by mLock
+    uint32_t                   mNumBuffers;     // buffers processed
+    uint32_t                   mNumStalls;      // exchanges which waited for processing
+    nsecs_t                    mProcessNs;      // total processing time
+    nsecs_t                    mMaxProcessNs;   // maximum processing time for one buffer
+    nsecs_t                    mStallNs;        // total time spent waiting in exchange()
+};
+
+}   // namespace android
+
+#endif  // EFFECT_WORKER_H
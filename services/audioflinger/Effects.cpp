@@ -21,7 +21,9 @@
 
 #include "Configuration.h"
 #include <utils/Log.h>
+#include <utils/Timers.h>
 #include <audio_effects/effect_visualizer.h>
+#include <media/EffectVisualizerApi.h>
 #include <audio_utils/primitives.h>
 #include <private/media/AudioEffectShared.h>
 #include <media/EffectsFactoryApi.h>
@@ -72,6 +74,10 @@ AudioFlinger::EffectModule::EffectModule(ThreadBase *thread,
       mAudioFlinger(thread->mAudioFlinger)
 {
     ALOGV("Constructor %p", this);
+#ifdef EFFECT_PROCESS_STATISTICS
+    mProcessCount = 0;
+    mProcessMaxNs = 0;
+#endif
     int lStatus;
 
     // create effect engine from effect factory
@@ -277,9 +283,19 @@ void AudioFlinger::EffectModule::process()
         }
 
         // do the actual processing in the effect engine
+#ifdef EFFECT_PROCESS_STATISTICS
+        nsecs_t startNs = systemTime(SYSTEM_TIME_THREAD);
+#endif
         int ret = (*mEffectInterface)->process(mEffectInterface,
                                                &mConfig.inputCfg.buffer,
                                                &mConfig.outputCfg.buffer);
+#ifdef EFFECT_PROCESS_STATISTICS
+        uint32_t processNs = (uint32_t)(systemTime(SYSTEM_TIME_THREAD) - startNs);
+        mProcessNs[mProcessCount++ & (kProcessStatsSamples - 1)] = processNs;
+        if (processNs > mProcessMaxNs) {
+            mProcessMaxNs = processNs;
+        }
+#endif
 
         // force transition to IDLE state when engine is ready
         if (mState == STOPPED && ret == -ENODATA) {
@@ -400,7 +416,7 @@ status_t AudioFlinger::EffectModule::configure()
         uint32_t latency = 0;
         PlaybackThread *pbt = thread->mAudioFlinger->checkPlaybackThread_l(thread->mId);
         if (pbt != NULL) {
-            latency = pbt->latency_l();
+            latency = pbt->mixLatency_l();
         }
 
         *((int32_t *)p->data + 1)= latency;
@@ -414,6 +430,11 @@ status_t AudioFlinger::EffectModule::configure()
 
     mMaxDisableWaitCnt = (MAX_DISABLE_TIME_MS * mConfig.outputCfg.samplingRate) /
             (1000 * mConfig.outputCfg.buffer.frameCount);
+#ifdef EFFECT_PROCESS_STATISTICS
+    // the buffer size may have changed
+    mProcessCount = 0;
+    mProcessMaxNs = 0;
+#endif
 
 exit:
     mStatus = status;
@@ -568,6 +589,36 @@ status_t AudioFlinger::EffectModule::command(uint32_t cmdCode,
     return status;
 }
 
+status_t AudioFlinger::EffectModule::setDataBuffer(void *buffer, uint32_t size)
+{
+    Mutex::Autolock _l(mLock);
+
+    // only the visualizer publishes results, its spectra
+    if (memcmp(&mDescriptor.type, SL_IID_VISUALIZATION, sizeof(effect_uuid_t)) != 0) {
+        return INVALID_OPERATION;
+    }
+    if (mState == DESTROYED || mEffectInterface == NULL) {
+        return NO_INIT;
+    }
+    if (mStatus != NO_ERROR) {
+        return mStatus;
+    }
+    // unlike command(), not reported to the other handles: the address is only meaningful
+    // in this process
+    visualizer_spectrum_buffer_t spectrumBuffer;
+    spectrumBuffer.cblk = static_cast<visualizer_spectrum_cblk_t *>(buffer);
+    spectrumBuffer.size = size;
+    int reply;
+    uint32_t replySize = sizeof(reply);
+    status_t status = (*mEffectInterface)->command(mEffectInterface,
+                                                   VISUALIZER_CMD_SET_SPECTRUM_BUFFER,
+                                                   sizeof(spectrumBuffer),
+                                                   &spectrumBuffer,
+                                                   &replySize,
+                                                   &reply);
+    return status != NO_ERROR ? status : reply;
+}
+
 status_t AudioFlinger::EffectModule::setEnabled(bool enabled)
 {
     Mutex::Autolock _l(mLock);
@@ -933,6 +984,22 @@ String8 effectFlagsToString(uint32_t flags) {
 }
 
 
+#ifdef EFFECT_PROCESS_STATISTICS
+// helper function called by qsort()
+static int compare_uint32_t(const void *pa, const void *pb)
+{
+    uint32_t a = *(const uint32_t *)pa;
+    uint32_t b = *(const uint32_t *)pb;
+    if (a < b) {
+        return -1;
+    } else if (a > b) {
+        return 1;
+    } else {
+        return 0;
+    }
+}
+#endif
+
 void AudioFlinger::EffectModule::dump(int fd, const Vector<String16>& args __unused)
 {
     const size_t SIZE = 256;
@@ -1001,6 +1068,26 @@ void AudioFlinger::EffectModule::dump(int fd, const Vector<String16>& args __unu
             formatToString((audio_format_t)mConfig.outputCfg.format));
     result.append(buffer);
 
+#ifdef EFFECT_PROCESS_STATISTICS
+    uint32_t n = mProcessCount < kProcessStatsSamples ? mProcessCount : kProcessStatsSamples;
+    if (n != 0) {
+        uint32_t *samples = new uint32_t[n];
+        memcpy(samples, mProcessNs, n * sizeof(uint32_t));
+        qsort(samples, n, sizeof(uint32_t), compare_uint32_t);
+        double meanNs = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            meanNs += samples[i];
+        }
+        meanNs /= n;
+        snprintf(buffer, SIZE, "\t\t- Process CPU time in us per buffer, last %u buffers:\n"
+                "\t\t\tmean=%.1f p99=%.1f max=%.1f, peak=%.1f over %u buffers\n",
+                n, meanNs * 1e-3, samples[(n * 99) / 100] * 1e-3, samples[n - 1] * 1e-3,
+                mProcessMaxNs * 1e-3, mProcessCount);
+        result.append(buffer);
+        delete[] samples;
+    }
+#endif
+
     snprintf(buffer, SIZE, "\t\t%zu Clients:\n", mHandles.size());
     result.append(buffer);
     result.append("\t\t\t  Pid Priority Ctrl Locked client server\n");
@@ -1169,6 +1256,7 @@ void AudioFlinger::EffectHandle::disconnect(bool unpinIfLast)
     if (mEffect == 0) {
         return;
     }
+    releaseDataMemory();
     // restore suspended effects if the disconnected handle was enabled and the last one.
     if ((mEffect->disconnect(this, unpinIfLast) == 0) && mEnabled) {
         sp<ThreadBase> thread = mEffect->thread().promote();
@@ -1191,6 +1279,41 @@ void AudioFlinger::EffectHandle::disconnect(bool unpinIfLast)
     }
 }
 
+sp<IMemory> AudioFlinger::EffectHandle::getDataMemory(uint32_t size)
+{
+    if (!mHasControl || mEffect == 0 || mClient == 0) {
+        return 0;
+    }
+    if (size < sizeof(visualizer_spectrum_cblk_t) ||
+            size > VISUALIZER_SPECTRUM_BUFFER_SIZE(VISUALIZER_SPECTRUM_SIZE_MAX)) {
+        return 0;
+    }
+    releaseDataMemory();
+
+    sp<IMemory> memory = mClient->heap()->allocate(size);
+    if (memory == 0 || memory->pointer() == NULL) {
+        ALOGE("not enough memory for effect data size=%u", size);
+        return 0;
+    }
+    status_t status = mEffect->setDataBuffer(memory->pointer(), size);
+    if (status != NO_ERROR) {
+        ALOGV("getDataMemory() not supported by effect: %d", status);
+        return 0;
+    }
+    mDataMemory = memory;
+    return mDataMemory;
+}
+
+void AudioFlinger::EffectHandle::releaseDataMemory()
+{
+    if (mDataMemory == 0) {
+        return;
+    }
+    // the effect must stop writing before the memory returns to the client heap
+    mEffect->setDataBuffer(mDataMemory->pointer(), 0);
+    mDataMemory.clear();
+}
+
 status_t AudioFlinger::EffectHandle::command(uint32_t cmdCode,
                                              uint32_t cmdSize,
                                              void *pCmdData,
@@ -1210,6 +1333,11 @@ status_t AudioFlinger::EffectHandle::command(uint32_t cmdCode,
     if (mClient == 0) {
         return INVALID_OPERATION;
     }
+    // shared buffers are only registered by getDataMemory()
+    if (cmdCode == VISUALIZER_CMD_SET_SPECTRUM_BUFFER &&
+            memcmp(&mEffect->desc().type, SL_IID_VISUALIZATION, sizeof(effect_uuid_t)) == 0) {
+        return INVALID_OPERATION;
+    }
 
     // handle commands that are not forwarded transparently to effect engine
     if (cmdCode == EFFECT_CMD_SET_PARAM_COMMIT) {
@@ -66,6 +66,9 @@ public:
                      void *pCmdData,
                      uint32_t *replySize,
                      void *pReplyData);
+    // registers (size > 0) or unregisters (size 0) a buffer in shared memory the effect
+    // engine publishes its results into, see IEffect::getDataMemory()
+    status_t setDataBuffer(void *buffer, uint32_t size);
 
     void reset_l();
     status_t configure();
@@ -152,6 +155,14 @@ mutable Mutex               mLock;      // mutex for process, commands and handl
     uint32_t mMaxDisableWaitCnt;    // maximum grace period before forcing an effect off after
                                     // sending disable command.
     uint32_t mDisableWaitCnt;       // current process() calls count during disable period.
+#ifdef EFFECT_PROCESS_STATISTICS
+    // thread CPU time of the last kProcessStatsSamples effect engine process calls, in ns,
+    // for dump(). Reset by configure().
+    static const uint32_t kProcessStatsSamples = 1024;  // must be a power of 2
+    uint32_t mProcessNs[kProcessStatsSamples];
+    uint32_t mProcessCount;         // process calls timed since configure()
+    uint32_t mProcessMaxNs;         // longest process call since configure()
+#endif
     bool     mSuspended;            // effect is suspended: temporarily disabled by framework
     bool     mOffloaded;            // effect is currently offloaded to the audio DSP
     wp<AudioFlinger>    mAudioFlinger;
@@ -184,8 +195,10 @@ public:
     virtual void disconnect();
 private:
             void disconnect(bool unpinIfLast);
+            void releaseDataMemory();
 public:
     virtual sp<IMemory> getCblk() const { return mCblkMemory; }
+    virtual sp<IMemory> getDataMemory(uint32_t size);
     virtual status_t onTransact(uint32_t code, const Parcel& data,
             Parcel* reply, uint32_t flags);
 
@@ -225,6 +238,7 @@ protected:
     effect_param_cblk_t* mCblk;         // control block for deferred parameter setting via
                                         // shared memory
     uint8_t*            mBuffer;        // pointer to parameter area in shared memory
+    sp<IMemory>         mDataMemory;    // shared memory the effect publishes results into
     int mPriority;                      // client application priority to control the effect
     bool mHasControl;                   // true if this handle is controlling the effect
     bool mEnabled;                      // cached enable state: needed when the effect is
@@ -94,6 +94,14 @@ private:
 
             // used by resampler to find source frames
             ResamplerBufferProvider *mResamplerBufferProvider;
+
+            // shared conversion the track reads from in the current cycle, NULL if the track
+            // converts the input itself. Only accessed by RecordThread::threadLoop().
+            SharedRecordConversion              *mSharedConversion;
+            // id of the shared conversion mSharedFront refers to, 0 if none
+            int32_t                             mSharedConversionId;
+            // rolling counter that is never cleared
+            int32_t                             mSharedFront;   // next converted frame
 };
 
 // playback track, used by PatchPanel
@@ -0,0 +1,232 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define LOG_TAG "SharedRecordConversion"
+//#define LOG_NDEBUG 0
+
+#include "Configuration.h"
+#include <math.h>
+#include <string.h>
+#include <audio_utils/primitives.h>
+#include <media/nbaio/roundup.h>
+#include <utils/Log.h>
+#include "AudioResampler.h"
+#include "SharedRecordConversion.h"
+
+#define FCC_2 2     // FCC_2 = Fixed Channel Count 2
+
+namespace android {
+
+SharedRecordConversion::SharedRecordConversion(int32_t id, const int16_t *inBuffer,
+        size_t inFrames, size_t inFramesP2, uint32_t inSampleRate, uint32_t inChannelCount,
+        int32_t inRear, uint32_t sampleRate, uint32_t channelCount)
+    :   mId(id), mSampleRate(sampleRate), mChannelCount(channelCount), mNumTracks(0),
+        mInBuffer(inBuffer), mInFrames(inFrames), mInFramesP2(inFramesP2),
+        mInSampleRate(inSampleRate), mInChannelCount(inChannelCount), mInRear(inRear),
+        mResampler(NULL), mRsmpOutBuffer(NULL), mRsmpOutFrameCount(0),
+        mRsmpInUnrel(0), mRsmpInFront(inRear), mRear(0)
+{
+    // same conversions as RecordTrack
+    if (inSampleRate != sampleRate && inChannelCount <= FCC_2 && channelCount <= FCC_2) {
+        mResampler = AudioResampler::create(AUDIO_FORMAT_PCM_16_BIT, inChannelCount,
+                sampleRate);
+        mResampler->setSampleRate(inSampleRate);
+        mResampler->setVolume(AudioResampler::UNITY_GAIN_FLOAT,
+                AudioResampler::UNITY_GAIN_FLOAT);
+    }
+    // at most the whole thread input is converted in a cycle; the ring keeps as many frames
+    // as a track reading the thread input directly could fall behind before an overrun
+    mMaxFrameCount = mResampler == NULL ? inFrames :
+            (size_t) ceil(inFrames * (double) sampleRate / inSampleRate) + 1;
+    mFramesP2 = roundup(mMaxFrameCount);
+    mBuffer = new int16_t[(mFramesP2 + mMaxFrameCount) * mChannelCount];
+}
+
+SharedRecordConversion::~SharedRecordConversion()
+{
+    delete mResampler;
+    delete[] mRsmpOutBuffer;
+    delete[] mBuffer;
+}
+
+void SharedRecordConversion::convert(int32_t inRear)
+{
+    mInRear = inRear;
+    ssize_t filled = inRear - mRsmpInFront;
+    if (filled < 0 || (size_t) filled > mInFrames) {
+        // should not happen as all the input is converted in each cycle, but re-sync
+        ALOGW("shared conversion %d lost %zd input frames", mId, filled);
+        filled = filled < 0 ? 0 : mInFrames;
+        mRsmpInFront = inRear - filled;
+        mRsmpInUnrel = 0;
+        if (mResampler != NULL) {
+            mResampler->reset();
+        }
+    }
+    size_t framesIn = filled;
+    size_t framesOut;
+    int16_t *dst = mBuffer + (mRear & (mFramesP2 - 1)) * mChannelCount;
+
+    if (mResampler == NULL) {
+        framesOut = framesIn;
+        int32_t front = mRsmpInFront;
+        while (framesIn > 0) {
+            front &= mInFramesP2 - 1;
+            size_t part1 = mInFramesP2 - front;
+            if (part1 > framesIn) {
+                part1 = framesIn;
+            }
+            const int16_t *src = mInBuffer + front * mInChannelCount;
+            if (mInChannelCount == mChannelCount) {
+                memcpy(dst, src, part1 * mChannelCount * sizeof(int16_t));
+            } else if (mInChannelCount == 1) {
+                upmix_to_stereo_i16_from_mono_i16(dst, src, part1);
+            } else {
+                downmix_to_mono_i16_from_stereo_i16(dst, src, part1);
+            }
+            dst += part1 * mChannelCount;
+            front += part1;
+            framesIn -= part1;
+        }
+        mRsmpInFront += framesOut;
+
+    } else {
+        // convert all the input except the unreleased frames, with the same budgeting as
+        // RecordThread::threadLoop() for a track
+        const double in(mInSampleRate);
+        const double out(mSampleRate);
+        framesIn = framesIn > mRsmpInUnrel ? framesIn - mRsmpInUnrel : 0;
+        framesOut = framesIn > 0 ? floor((framesIn - 1) * out / in) : 0;
+        if (framesOut > mMaxFrameCount) {
+            framesOut = mMaxFrameCount;
+        }
+        if (framesOut == 0) {
+            return;
+        }
+        if (mRsmpOutFrameCount < framesOut) {
+            delete[] mRsmpOutBuffer;
+            // resampler always outputs stereo
+            mRsmpOutBuffer = new int32_t[framesOut * FCC_2];
+            mRsmpOutFrameCount = framesOut;
+        }
+        memset(mRsmpOutBuffer, 0, framesOut * FCC_2 * sizeof(int32_t));
+        mResampler->resample(mRsmpOutBuffer, framesOut, this);
+        if (mChannelCount == 1) {
+            // temporarily type pun mRsmpOutBuffer from Q4.27 to int16_t
+            ditherAndClamp(mRsmpOutBuffer, mRsmpOutBuffer, framesOut);
+            downmix_to_mono_i16_from_stereo_i16(dst, (const int16_t *)mRsmpOutBuffer,
+                    framesOut);
+        } else {
+            ditherAndClamp((int32_t *)dst, mRsmpOutBuffer, framesOut);
+        }
+    }
+
+    // frames written past the end of the ring go to its beginning
+    size_t part1 = mFramesP2 - (mRear & (mFramesP2 - 1));
+    if (framesOut > part1) {
+        memcpy(mBuffer, mBuffer + mFramesP2 * mChannelCount,
+                (framesOut - part1) * mChannelCount * sizeof(int16_t));
+    }
+    mRear += framesOut;
+}
+
+size_t SharedRecordConversion::read(int32_t *front, void *dst, size_t frameCount,
+        bool *overrun)
+{
+    *overrun = false;
+    ssize_t filled = mRear - *front;
+    if (filled < 0) {
+        // should not happen, but treat like a massive overrun and re-sync
+        *front = mRear;
+        filled = 0;
+        *overrun = true;
+    } else if ((size_t) filled > mFramesP2) {
+        // client is not keeping up with server, but give it latest data
+        *front = mRear - mFramesP2;
+        filled = mFramesP2;
+        *overrun = true;
+    }
+    if (frameCount > (size_t) filled) {
+        frameCount = filled;
+    }
+
+    const size_t frameSize = mChannelCount * sizeof(int16_t);
+    int8_t *dst8 = (int8_t *)dst;
+    int32_t position = *front;
+    size_t frames = frameCount;
+    while (frames > 0) {
+        position &= mFramesP2 - 1;
+        size_t part1 = mFramesP2 - position;
+        if (part1 > frames) {
+            part1 = frames;
+        }
+        memcpy(dst8, mBuffer + position * mChannelCount, part1 * frameSize);
+        dst8 += part1 * frameSize;
+        position += part1;
+        frames -= part1;
+    }
+    *front += frameCount;
+    return frameCount;
+}
+
+// AudioBufferProvider interface
+status_t SharedRecordConversion::getNextBuffer(AudioBufferProvider::Buffer* buffer,
+        int64_t pts __unused)
+{
+    int32_t front = mRsmpInFront;
+    ssize_t filled = mInRear - front;
+    LOG_ALWAYS_FATAL_IF(!(0 <= filled && (size_t) filled <= mInFrames));
+    // 'filled' may be non-contiguous, so return only the first contiguous chunk
+    front &= mInFramesP2 - 1;
+    size_t part1 = mInFramesP2 - front;
+    if (part1 > (size_t) filled) {
+        part1 = filled;
+    }
+    size_t ask = buffer->frameCount;
+    ALOG_ASSERT(ask > 0);
+    if (part1 > ask) {
+        part1 = ask;
+    }
+    if (part1 == 0) {
+        // convert() does not call the resampler for more frames than available
+        LOG_ALWAYS_FATAL("SharedRecordConversion::getNextBuffer() starved");
+        buffer->raw = NULL;
+        buffer->frameCount = 0;
+        mRsmpInUnrel = 0;
+        return NOT_ENOUGH_DATA;
+    }
+
+    buffer->raw = (void *)(mInBuffer + front * mInChannelCount);
+    buffer->frameCount = part1;
+    mRsmpInUnrel = part1;
+    return NO_ERROR;
+}
+
+// AudioBufferProvider interface
+void SharedRecordConversion::releaseBuffer(AudioBufferProvider::Buffer* buffer)
+{
+    size_t stepCount = buffer->frameCount;
+    if (stepCount == 0) {
+        return;
+    }
+    ALOG_ASSERT(stepCount <= mRsmpInUnrel);
+    mRsmpInUnrel -= stepCount;
+    mRsmpInFront += stepCount;
+    buffer->raw = NULL;
+    buffer->frameCount = 0;
+}
+
+}   // namespace android
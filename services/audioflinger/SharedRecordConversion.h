@@ -0,0 +1,82 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SHARED_RECORD_CONVERSION_H
+#define SHARED_RECORD_CONVERSION_H
+
+#include <stdint.h>
+#include <sys/types.h>
+#include <media/AudioBufferProvider.h>
+
+namespace android {
+
+class AudioResampler;
+
+// Conversion of the input of a record thread to the sample rate and channel count of the
+// tracks with that format, done once per cycle into a ring buffer which each of these tracks
+// copies from at its own position. Used by RecordThread instead of the conversion per track
+// when property af.record_fanout is set, so that additional clients only cost a copy.
+//
+// The input is the 16 bit PCM ring buffer of the thread, mRsmpInBuffer, which must stay
+// allocated with the same size and format for the lifetime of the conversion.
+class SharedRecordConversion : public AudioBufferProvider
+                        // derives from AudioBufferProvider interface for use by resampler
+{
+public:
+    SharedRecordConversion(int32_t id, const int16_t *inBuffer, size_t inFrames,
+            size_t inFramesP2, uint32_t inSampleRate, uint32_t inChannelCount, int32_t inRear,
+            uint32_t sampleRate, uint32_t channelCount);
+    virtual ~SharedRecordConversion();
+
+    // converts the input frames up to inRear, the position of the last frame read + 1
+            void        convert(int32_t inRear);
+    // copies up to frameCount converted frames from position *front to dst, advances *front
+    // and returns the number of frames copied. overrun is set when *front had to be moved as
+    // the frames were overwritten.
+            size_t      read(int32_t *front, void *dst, size_t frameCount, bool *overrun);
+    // position of the next frame to be converted
+            int32_t     rear() const { return mRear; }
+
+    // AudioBufferProvider interface
+    virtual status_t    getNextBuffer(AudioBufferProvider::Buffer* buffer, int64_t pts);
+    virtual void        releaseBuffer(AudioBufferProvider::Buffer* buffer);
+
+    const int32_t       mId;            // unique for the thread, never 0
+    const uint32_t      mSampleRate;
+    const uint32_t      mChannelCount;
+    size_t              mNumTracks;     // tracks reading this cycle
+
+private:
+    const int16_t * const mInBuffer;    // thread input ring, see RecordThread::mRsmpInBuffer
+    const size_t        mInFrames;      // frames the thread keeps in its input ring
+    const size_t        mInFramesP2;    // input ring size in frames, power of 2
+    const uint32_t      mInSampleRate;
+    const uint32_t      mInChannelCount;
+    int32_t             mInRear;        // last input frame read + 1, rolling counter
+    AudioResampler      *mResampler;    // NULL if the track and thread rates are the same
+    int32_t             *mRsmpOutBuffer;
+    size_t              mRsmpOutFrameCount;
+    size_t              mRsmpInUnrel;
+    int32_t             mRsmpInFront;   // next thread input frame, rolling counter
+    size_t              mMaxFrameCount; // most frames converted in a cycle
+    int16_t             *mBuffer;       // converted frames, over-allocated by mMaxFrameCount
+    size_t              mFramesP2;      // ring size in frames, power of 2
+    int32_t             mRear;          // last converted frame + 1, rolling counter
+};
+
+}   // namespace android
+
+#endif  // SHARED_RECORD_CONVERSION_H
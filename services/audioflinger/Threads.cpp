@@ -24,6 +24,7 @@
 #include <math.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <algorithm>
 #include <cutils/properties.h>
 #include <media/AudioParameter.h>
 #include <media/AudioResamplerPublic.h>
@@ -188,6 +189,38 @@ static void sFastTrackMultiplierInit()
     }
 }
 
+static pthread_once_t sEffectWorkerOnce = PTHREAD_ONCE_INIT;
+static bool sEffectWorkerEnabled = false;
+
+// Property "af.effect_worker" set to 1 moves the global effect chains of mixer threads to a
+// dedicated worker thread, at the cost of one normal sink buffer of additional latency.
+static void sEffectWorkerInit()
+{
+    char value[PROPERTY_VALUE_MAX];
+    if (property_get("af.effect_worker", value, "0") > 0) {
+        sEffectWorkerEnabled = atoi(value) != 0;
+    }
+}
+
+static pthread_once_t sRecordFanoutOnce = PTHREAD_ONCE_INIT;
+static bool sRecordFanoutEnabled = false;
+
+// Property "af.record_fanout" set to 1 makes record threads convert the input once for all
+// the normal tracks with the same sample rate and channel count, see SharedRecordConversion.
+static void sRecordFanoutInit()
+{
+    char value[PROPERTY_VALUE_MAX];
+    if (property_get("af.record_fanout", value, "0") > 0) {
+        sRecordFanoutEnabled = atoi(value) != 0;
+    }
+}
+
+static bool recordFanoutEnabled()
+{
+    pthread_once(&sRecordFanoutOnce, sRecordFanoutInit);
+    return sRecordFanoutEnabled;
+}
+
 // ----------------------------------------------------------------------------
 
 #ifdef ADD_BATTERY_DATA
@@ -1180,6 +1213,7 @@ AudioFlinger::PlaybackThread::PlaybackThread(const sp<AudioFlinger>& audioFlinge
         mEffectBufferSize(0),
         mEffectBufferFormat(AUDIO_FORMAT_INVALID),
         mEffectBufferValid(false),
+        mEffectWorkerFrames(0),
         mSuspended(0), mBytesWritten(0),
         mActiveTracksGeneration(0),
         // mStreamTypes[] initialized in constructor body
@@ -1328,6 +1362,10 @@ void AudioFlinger::PlaybackThread::dumpInternals(int fd, const Vector<String16>&
     dprintf(fd, "  Mixer buffer: %p\n", mMixerBuffer);
     dprintf(fd, "  Effect buffer: %p\n", mEffectBuffer);
     dprintf(fd, "  Fast track availMask=%#x\n", mFastTrackAvailMask);
+    if (mEffectWorker != 0) {
+        dprintf(fd, "  Effect worker delay: %zu frames\n", mEffectWorkerFrames);
+        mEffectWorker->dump(fd);
+    }
 
     dumpBase(fd, args);
 }
@@ -1567,6 +1605,11 @@ uint32_t AudioFlinger::PlaybackThread::latency_l() const
     }
 }
 
+uint32_t AudioFlinger::PlaybackThread::mixLatency_l() const
+{
+    return latency_l() + (mEffectWorkerFrames * 1000) / mSampleRate;
+}
+
 void AudioFlinger::PlaybackThread::setMasterVolume(float value)
 {
     Mutex::Autolock _l(mLock);
@@ -1920,6 +1963,19 @@ void AudioFlinger::PlaybackThread::readOutputParameters_l()
         (void)posix_memalign(&mEffectBuffer, 32, mEffectBufferSize);
     }
 
+    // the worker buffer must match the new normal sink buffer: the global effect chains are
+    // attached to the new worker by moveEffectChain_l() below
+    if (mEffectWorker != 0) {
+        mEffectWorker->exit();
+        mEffectWorker->join();
+        mEffectWorker.clear();
+    }
+    mEffectWorkerFrames = 0;
+    pthread_once(&sEffectWorkerOnce, sEffectWorkerInit);
+    if (mType == MIXER && sEffectWorkerEnabled) {
+        mEffectWorker = new AudioFlinger::EffectWorkerThread(mNormalFrameCount, mChannelCount);
+    }
+
     // force reconfiguration of effect chains and engines to take new buffer size and audio
     // parameters into account
     // Note that mLock is not held when readOutputParameters_l() is called from the constructor
@@ -2126,7 +2182,10 @@ ssize_t AudioFlinger::PlaybackThread::threadLoop_write()
         if (status == NO_ERROR) {
             size_t totalFramesWritten = mNormalSink->framesWritten();
             if (totalFramesWritten >= mLatchD.mTimestamp.mPosition) {
-                mLatchD.mUnpresentedFrames = totalFramesWritten - mLatchD.mTimestamp.mPosition;
+                // frames held by the effect worker have been released by the tracks
+                // but not written to the sink yet
+                mLatchD.mUnpresentedFrames = totalFramesWritten - mLatchD.mTimestamp.mPosition
+                        + mEffectWorkerFrames;
                 // mLatchD.mFramesReleased is set immediately before D is clocked into Q
                 mLatchDValid = true;
             }
@@ -2179,7 +2238,10 @@ void AudioFlinger::PlaybackThread::threadLoop_drain()
 
 void AudioFlinger::PlaybackThread::threadLoop_exit()
 {
-    // Default implementation has nothing to do
+    if (mEffectWorker != 0) {
+        mEffectWorker->exit();
+        mEffectWorker->join();
+    }
 }
 
 /*
@@ -2266,9 +2328,15 @@ status_t AudioFlinger::PlaybackThread::addEffectChain_l(const sp<EffectChain>& c
         }
     }
     chain->setThread(this);
-    chain->setInBuffer(buffer, ownsBuffer);
-    chain->setOutBuffer(reinterpret_cast<int16_t*>(mEffectBufferEnabled
-            ? mEffectBuffer : mSinkBuffer));
+    if (session <= AUDIO_SESSION_OUTPUT_MIX && mEffectWorker != 0) {
+        // global chains run in place on the worker buffer, see threadLoop()
+        chain->setInBuffer(mEffectWorker->buffer(), false);
+        chain->setOutBuffer(mEffectWorker->buffer());
+    } else {
+        chain->setInBuffer(buffer, ownsBuffer);
+        chain->setOutBuffer(reinterpret_cast<int16_t*>(mEffectBufferEnabled
+                ? mEffectBuffer : mSinkBuffer));
+    }
     // Effect chain for session AUDIO_SESSION_OUTPUT_STAGE is inserted at end of effect
     // chains list in order to be processed last as it contains output stage effects
     // Effect chain for session AUDIO_SESSION_OUTPUT_MIX is inserted before
@@ -2292,6 +2360,32 @@ status_t AudioFlinger::PlaybackThread::addEffectChain_l(const sp<EffectChain>& c
     return NO_ERROR;
 }
 
+void AudioFlinger::PlaybackThread::lockEffectChainsForWorker_l(
+        Vector< sp<AudioFlinger::EffectChain> >& effectChains,
+        Vector< sp<AudioFlinger::EffectChain> >& workerChains)
+{
+    effectChains.clear();
+    workerChains.clear();
+    for (size_t i = 0; i < mEffectChains.size(); i++) {
+        if (mEffectChains[i]->sessionId() <= AUDIO_SESSION_OUTPUT_MIX) {
+            workerChains.add(mEffectChains[i]);
+        } else {
+            mEffectChains[i]->lock();
+            effectChains.add(mEffectChains[i]);
+        }
+    }
+
+    // The pipeline delay only applies while there are global chains. When it starts, the
+    // worker contributes one buffer of silence; when it stops, its last buffer is dropped.
+    size_t workerFrames = workerChains.isEmpty() ? 0 : mNormalFrameCount;
+    if (workerFrames != mEffectWorkerFrames) {
+        ALOGV("lockEffectChainsForWorker_l() effect worker delay %zu -> %zu frames",
+                mEffectWorkerFrames, workerFrames);
+        mEffectWorker->flush();
+        mEffectWorkerFrames = workerFrames;
+    }
+}
+
 size_t AudioFlinger::PlaybackThread::removeEffectChain_l(const sp<EffectChain>& chain)
 {
     int session = chain->sessionId();
@@ -2301,6 +2395,11 @@ size_t AudioFlinger::PlaybackThread::removeEffectChain_l(const sp<EffectChain>&
     for (size_t i = 0; i < mEffectChains.size(); i++) {
         if (chain == mEffectChains[i]) {
             mEffectChains.removeAt(i);
+            // the worker may still hold the chain from the last exchange() and the chains
+            // collected by threadLoop() for the next one
+            if (session <= AUDIO_SESSION_OUTPUT_MIX && mEffectWorker != 0) {
+                mEffectWorker->removeChain(chain);
+            }
             // detach all active tracks from the chain
             for (size_t i = 0 ; i < mActiveTracks.size() ; ++i) {
                 sp<Track> track = mActiveTracks[i].promote();
@@ -2360,6 +2459,10 @@ status_t AudioFlinger::PlaybackThread::attachAuxEffect_l(
 
 void AudioFlinger::PlaybackThread::detachAuxEffect_l(int effectId)
 {
+    // the effect input buffer is freed once the effect is removed from its chain
+    if (mEffectWorker != 0) {
+        mEffectWorker->detachAuxEffect(effectId);
+    }
     for (size_t i = 0; i < mTracks.size(); ++i) {
         sp<Track> track = mTracks[i];
         if (track->auxEffectId() == effectId) {
@@ -2407,6 +2510,8 @@ bool AudioFlinger::PlaybackThread::threadLoop()
         cpuStats.sample(myName);
 
         Vector< sp<EffectChain> > effectChains;
+        // global chains processed by mEffectWorker
+        Vector< sp<EffectChain> > workerChains;
 
         { // scope for mLock
 
@@ -2466,6 +2571,11 @@ bool AudioFlinger::PlaybackThread::threadLoop()
                     threadLoop_standby();
 
                     mStandby = true;
+
+                    // do not play the buffer held by the effect worker after standby
+                    if (mEffectWorker != 0) {
+                        mEffectWorker->flush();
+                    }
                 }
 
                 if (!mActiveTracks.size() && mConfigEvents.isEmpty()) {
@@ -2515,7 +2625,11 @@ bool AudioFlinger::PlaybackThread::threadLoop()
             // prevent any changes in effect chain list and in each effect chain
             // during mixing and effect process as the audio buffers could be deleted
             // or modified if an effect is created or deleted
-            lockEffectChains_l(effectChains);
+            if (mEffectWorker != 0) {
+                lockEffectChainsForWorker_l(effectChains, workerChains);
+            } else {
+                lockEffectChains_l(effectChains);
+            }
         } // mLock scope ends
 
         if (mBytesRemaining == 0) {
@@ -2563,6 +2677,12 @@ bool AudioFlinger::PlaybackThread::threadLoop()
                 for (size_t i = 0; i < effectChains.size(); i ++) {
                     effectChains[i]->process_l();
                 }
+                // hand this buffer over to the global chains and get back the previous one,
+                // which they have processed in the meantime
+                if (!workerChains.isEmpty()) {
+                    mEffectWorker->exchange(reinterpret_cast<int16_t*>(
+                            mEffectBufferValid ? mEffectBuffer : mSinkBuffer), workerChains);
+                }
             }
         }
         // Process effect chains for offloaded thread even if no audio
@@ -2637,6 +2757,7 @@ bool AudioFlinger::PlaybackThread::threadLoop()
         // Effect chains will be actually deleted here if they were removed from
         // mEffectChains list during mixing or effects processing
         effectChains.clear();
+        workerChains.clear();
 
         // FIXME Note that the above .clear() is no longer necessary since effectChains
         // is now local to this block, but will keep it for now (at least until merge done).
@@ -2685,7 +2806,16 @@ void AudioFlinger::PlaybackThread::removeTracks_l(const Vector< sp<Track> >& tra
 status_t AudioFlinger::PlaybackThread::getTimestamp_l(AudioTimestamp& timestamp)
 {
     if (mNormalSink != 0) {
-        return mNormalSink->getTimestamp(timestamp);
+        status_t status = mNormalSink->getTimestamp(timestamp);
+        if (status == NO_ERROR && mEffectWorkerFrames != 0) {
+            // report the position of the mixed data, which reaches the sink
+            // mEffectWorkerFrames later
+            if (timestamp.mPosition < mEffectWorkerFrames) {
+                return INVALID_OPERATION;
+            }
+            timestamp.mPosition -= mEffectWorkerFrames;
+        }
+        return status;
     }
     if ((mType == OFFLOAD || mType == DIRECT) && mOutput->stream->get_presentation_position) {
         uint64_t position64;
@@ -3555,10 +3685,15 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
                         AudioMixer::TRACK,
                         AudioMixer::MAIN_BUFFER, (void *)track->mainBuffer());
             }
+            // the effect worker reads the auxiliary effect input buffer during the mix
+            int32_t *auxBuffer = track->auxBuffer();
+            if (auxBuffer != NULL && mEffectWorker != 0) {
+                auxBuffer = mEffectWorker->auxBuffer(track->auxEffectId(), auxBuffer);
+            }
             mAudioMixer->setParameter(
                 name,
                 AudioMixer::TRACK,
-                AudioMixer::AUX_BUFFER, (void *)track->auxBuffer());
+                AudioMixer::AUX_BUFFER, (void *)auxBuffer);
 
             // reset retry count
             track->mRetryCount = kMaxTrackRetries;
@@ -3588,7 +3723,7 @@ AudioFlinger::PlaybackThread::mixer_state AudioFlinger::MixerThread::prepareTrac
                 // Remove it from the list of active tracks.
                 // TODO: use actual buffer filling status instead of latency when available from
                 // audio HAL
-                size_t audioHALFrames = (latency_l() * mSampleRate) / 1000;
+                size_t audioHALFrames = (mixLatency_l() * mSampleRate) / 1000;
                 size_t framesWritten = mBytesWritten / mFrameSize;
                 if (mStandby || track->presentationComplete(framesWritten, audioHALFrames)) {
                     if (track->isStopped()) {
@@ -3671,6 +3806,11 @@ track_is_ready: ;
     if (getEffectChain_l(AUDIO_SESSION_OUTPUT_MIX) != 0) {
         mEffectBufferValid = true;
     }
+    // the effect worker exchanges its buffer with the effect buffer, so that buffer must
+    // also be used when there are only output stage effects
+    if (mEffectWorker != 0 && getEffectChain_l(AUDIO_SESSION_OUTPUT_STAGE) != 0) {
+        mEffectBufferValid = true;
+    }
 
     if (mEffectBufferValid) {
         // as long as there are effects we should clear the effects buffer, to avoid
@@ -4341,6 +4481,92 @@ void AudioFlinger::AsyncCallbackThread::resetDraining()
 }
 
 
+// ----------------------------------------------------------------------------
+//      EffectWorkerThread
+// ----------------------------------------------------------------------------
+
+AudioFlinger::EffectWorkerThread::EffectWorkerThread(size_t frameCount, uint32_t channelCount)
+    :   EffectWorker(frameCount, channelCount)
+{
+}
+
+AudioFlinger::EffectWorkerThread::~EffectWorkerThread()
+{
+}
+
+void AudioFlinger::EffectWorkerThread::process()
+{
+    Vector< sp<EffectChain> > chains;
+    {
+        Mutex::Autolock _l(mLock);
+        chains = mChains;
+    }
+    for (size_t i = 0; i < chains.size(); i++) {
+        chains[i]->lock();
+        chains[i]->process_l();
+        chains[i]->unlock();
+    }
+}
+
+void AudioFlinger::EffectWorkerThread::exchange(int16_t *buffer,
+        const Vector< sp<EffectChain> >& chains)
+{
+    Vector< sp<EffectChain> > releasedChains;
+    {
+        Mutex::Autolock _l(mLock);
+        mNextChains = chains;
+    }
+    EffectWorker::exchange(buffer);
+    Mutex::Autolock _l(mLock);
+    releasedChains = mReleasedChains;
+    mReleasedChains.clear();
+}
+
+void AudioFlinger::EffectWorkerThread::onExchange_l()
+{
+    mReleasedChains = mChains;
+    mChains.clear();
+    for (size_t i = 0; i < mNextChains.size(); i++) {
+        bool removed = false;
+        for (size_t j = 0; j < mRemovedChains.size(); j++) {
+            if (mNextChains[i] == mRemovedChains[j]) {
+                removed = true;
+                break;
+            }
+        }
+        if (!removed) {
+            mChains.add(mNextChains[i]);
+        }
+    }
+    mReleasedChains.appendVector(mRemovedChains);
+    mRemovedChains.clear();
+    mNextChains.clear();
+}
+
+void AudioFlinger::EffectWorkerThread::flush()
+{
+    EffectWorker::flush();
+    Vector< sp<EffectChain> > previousChains;
+    Mutex::Autolock _l(mLock);
+    previousChains = mChains;
+    mChains.clear();
+}
+
+void AudioFlinger::EffectWorkerThread::removeChain(const sp<EffectChain>& chain)
+{
+    Vector< sp<EffectChain> > previousChains;
+    Mutex::Autolock _l(mLock);
+    waitIdle_l();
+    for (size_t i = 0; i < mChains.size(); i++) {
+        if (mChains[i] == chain) {
+            previousChains = mChains;
+            mChains.removeAt(i);
+            break;
+        }
+    }
+    mRemovedChains.add(chain);
+}
+
 // ----------------------------------------------------------------------------
 AudioFlinger::OffloadThread::OffloadThread(const sp<AudioFlinger>& audioFlinger,
         AudioStreamOut* output, audio_io_handle_t id, uint32_t device)
@@ -4844,6 +5070,8 @@ AudioFlinger::RecordThread::RecordThread(const sp<AudioFlinger>& audioFlinger,
     // mPipeMemory
     // mFastCaptureNBLogWriter
     , mFastTrackAvail(false)
+    , mSharedConversionEnabled(recordFanoutEnabled())
+    , mSharedConversionId(0)
 {
     snprintf(mName, kNameLength, "AudioIn_%X", id);
     mNBLogWriter = audioFlinger->newWriter_l(kLogSize, mName);
@@ -4982,6 +5210,7 @@ AudioFlinger::RecordThread::~RecordThread()
     }
     mAudioFlinger->unregisterWriter(mFastCaptureNBLogWriter);
     mAudioFlinger->unregisterWriter(mNBLogWriter);
+    clearSharedConversions();
     delete[] mRsmpInBuffer;
 }
 
@@ -5200,6 +5429,10 @@ reacquire_wakelock:
         // now run the fast track destructor with thread mutex unlocked
         fastTrackToRemove.clear();
 
+        if (mSharedConversionEnabled) {
+            updateSharedConversions(activeTracks);
+        }
+
         // Read from HAL to keep up with fastest client if multiple active tracks, not slowest one.
         // Only the client(s) that are too slow will overrun. But if even the fastest client is too
         // slow, then this RecordThread will overrun by not calling HAL read often enough.
@@ -5253,6 +5486,11 @@ reacquire_wakelock:
         }
         rear = mRsmpInRear += framesRead;
 
+        // convert once for all the tracks of each shared conversion
+        for (size_t i = 0; i < mSharedConversions.size(); i++) {
+            mSharedConversions[i]->convert(rear);
+        }
+
         size = activeTracks.size();
         // loop over each active track
         for (size_t i = 0; i < size; i++) {
@@ -5281,7 +5519,10 @@ reacquire_wakelock:
                 ssize_t filled = rear - front;
                 size_t framesIn;
 
-                if (filled < 0) {
+                if (activeTrack->mSharedConversion != NULL) {
+                    // the shared conversion handles the input position
+                    framesIn = framesOut;
+                } else if (filled < 0) {
                     // should not happen, but treat like a massive overrun and re-sync
                     framesIn = 0;
                     activeTrack->mRsmpInFront = rear;
@@ -5299,7 +5540,17 @@ reacquire_wakelock:
                     break;
                 }
 
-                if (activeTrack->mResampler == NULL) {
+                if (activeTrack->mSharedConversion != NULL) {
+                    // copy the frames converted for all the tracks with this format
+                    bool sharedOverrun;
+                    framesOut = activeTrack->mSharedConversion->read(
+                            &activeTrack->mSharedFront, activeTrack->mSink.raw, framesOut,
+                            &sharedOverrun);
+                    if (sharedOverrun) {
+                        overrun = OVERRUN_TRUE;
+                    }
+
+                } else if (activeTrack->mResampler == NULL) {
                     // no resampling
                     if (framesIn > framesOut) {
                         framesIn = framesOut;
@@ -5711,6 +5962,8 @@ status_t AudioFlinger::RecordThread::start(RecordThread::RecordTrack* recordTrac
 
         recordTrack->mRsmpInFront = mRsmpInRear;
         recordTrack->mRsmpInUnrel = 0;
+        // same for a shared conversion: the track starts reading from its latest frames
+        recordTrack->mSharedConversionId = 0;
         // FIXME why reset?
         if (recordTrack->mResampler != NULL) {
             recordTrack->mResampler->reset();
@@ -5948,6 +6201,61 @@ void AudioFlinger::RecordThread::ResamplerBufferProvider::releaseBuffer(
     buffer->frameCount = 0;
 }
 
+void AudioFlinger::RecordThread::updateSharedConversions(
+        const Vector< sp<RecordTrack> >& activeTracks)
+{
+    for (size_t i = 0; i < mSharedConversions.size(); i++) {
+        mSharedConversions[i]->mNumTracks = 0;
+    }
+    for (size_t i = 0; i < activeTracks.size(); i++) {
+        RecordTrack *recordTrack = activeTracks[i].get();
+        if (recordTrack->isFastTrack()) {
+            continue;
+        }
+        uint32_t channelCount = recordTrack->mChannelCount;
+        SharedRecordConversion *conversion = NULL;
+        for (size_t j = 0; j < mSharedConversions.size(); j++) {
+            if (mSharedConversions[j]->mSampleRate == recordTrack->mSampleRate &&
+                    mSharedConversions[j]->mChannelCount == channelCount) {
+                conversion = mSharedConversions[j];
+                break;
+            }
+        }
+        if (conversion == NULL) {
+            conversion = new SharedRecordConversion(++mSharedConversionId, mRsmpInBuffer,
+                    mRsmpInFrames, mRsmpInFramesP2, mSampleRate, mChannelCount, mRsmpInRear,
+                    recordTrack->mSampleRate, channelCount);
+            mSharedConversions.add(conversion);
+            ALOGV("new shared conversion %d: %u Hz %u channels", conversion->mId,
+                    conversion->mSampleRate, conversion->mChannelCount);
+        }
+        if (recordTrack->mSharedConversionId != conversion->mId) {
+            // like a track starting on the thread input, read from the next frames converted
+            recordTrack->mSharedConversionId = conversion->mId;
+            recordTrack->mSharedFront = conversion->rear();
+        }
+        recordTrack->mSharedConversion = conversion;
+        conversion->mNumTracks++;
+    }
+    for (size_t i = 0; i < mSharedConversions.size(); ) {
+        if (mSharedConversions[i]->mNumTracks == 0) {
+            ALOGV("delete shared conversion %d", mSharedConversions[i]->mId);
+            delete mSharedConversions[i];
+            mSharedConversions.removeAt(i);
+        } else {
+            i++;
+        }
+    }
+}
+
+void AudioFlinger::RecordThread::clearSharedConversions()
+{
+    for (size_t i = 0; i < mSharedConversions.size(); i++) {
+        delete mSharedConversions[i];
+    }
+    mSharedConversions.clear();
+}
+
 bool AudioFlinger::RecordThread::checkForNewParameter_l(const String8& keyValuePair,
                                                         status_t& status)
 {
@@ -6131,6 +6439,9 @@ void AudioFlinger::RecordThread::readInputParameters_l()
     // Over-allocate beyond mRsmpInFramesP2 to permit a HAL read past end of buffer
     mRsmpInBuffer = new int16_t[(mRsmpInFramesP2 + mFrameCount - 1) * mChannelCount];
 
+    // shared conversions depend on the input parameters, they are re-created as needed
+    clearSharedConversions();
+
     // AudioRecord mSampleRate and mChannelCount are constant due to AudioRecord API constraints.
     // But if thread's mSampleRate or mChannelCount changes, how will that affect active tracks?
 }
@@ -516,6 +516,9 @@ public:
                 uint32_t    latency() const;
                 // same, but lock must already be held
                 uint32_t    latency_l() const;
+                // latency_l() plus the effect worker delay, which normal tracks go through and
+                // fast tracks bypass
+                uint32_t    mixLatency_l() const;
 
                 void        setMasterVolume(float value);
                 void        setMasterMute(bool muted);
@@ -659,6 +662,19 @@ protected:
     // for any processing (including output processing).
     bool                            mEffectBufferValid;
 
+    // Effect worker (MIXER only, enabled by property "af.effect_worker")
+    //
+    // When present, the global effect chains (AUDIO_SESSION_OUTPUT_MIX and
+    // AUDIO_SESSION_OUTPUT_STAGE) are processed by mEffectWorker instead of threadLoop(),
+    // one normal sink buffer behind the mixer. Their input and output buffer is owned by the
+    // worker and its content is exchanged with the mixed data once per cycle.
+    sp<EffectWorkerThread>          mEffectWorker;
+
+    // Frames delayed by mEffectWorker: mNormalFrameCount while global chains are offloaded,
+    // 0 otherwise. Added to mixLatency_l() and to the unpresented frames of timestamps.
+    // Written by threadLoop() with mLock held.
+    size_t                          mEffectWorkerFrames;
+
     // suspend count, > 0 means suspended.  While suspended, the thread continues to pull from
     // tracks and mix, but doesn't write to HAL.  A2DP and SCO HAL implementations can't handle
     // concurrent use of both of them, so Audio Policy Service suspends one of the threads to
@@ -723,6 +739,11 @@ private:
 
     void        readOutputParameters_l();
 
+    // Same as lockEffectChains_l() but moves the chains run by mEffectWorker to workerChains
+    // without locking them: the worker locks each chain while processing it.
+    void        lockEffectChainsForWorker_l(Vector< sp<EffectChain> >& effectChains,
+                                            Vector< sp<EffectChain> >& workerChains);
+
     virtual void dumpInternals(int fd, const Vector<String16>& args);
     void        dumpTracks(int fd, const Vector<String16>& args);
 
@@ -986,6 +1007,40 @@ private:
     Mutex                      mLock;
 };
 
+// Runs the global effect chains of a mixer thread on an EffectWorker, see
+// PlaybackThread::mEffectWorker.
+class EffectWorkerThread : public EffectWorker {
+public:
+
+    EffectWorkerThread(size_t frameCount, uint32_t channelCount);
+
+    virtual             ~EffectWorkerThread();
+
+    // Same as EffectWorker::exchange(), the new content is processed with the given chains
+            void        exchange(int16_t *buffer, const Vector< sp<EffectChain> >& chains);
+
+    // Same as EffectWorker::flush(), also releases the chains
+            void        flush();
+
+    // Waits until the current buffer has been processed and stops running chain, which the
+    // caller is removing from its thread. chain is also dropped from the chains passed to
+    // the next exchange(), which may have been collected before the removal.
+            void        removeChain(const sp<EffectChain>& chain);
+
+protected:
+    virtual void        process();
+    virtual void        onExchange_l();
+
+private:
+    // all protected by mLock
+    Vector< sp<EffectChain> >  mChains;     // chains for the buffer being processed
+    Vector< sp<EffectChain> >  mNextChains; // chains passed to exchange()
+    Vector< sp<EffectChain> >  mRemovedChains; // removed since the last exchange()
+    // chains replaced by exchange(), released outside of mLock as the last reference may
+    // be dropped there
+    Vector< sp<EffectChain> >  mReleasedChains;
+};
+
 class DuplicatingThread : public MixerThread {
 public:
     DuplicatingThread(const sp<AudioFlinger>& audioFlinger, MixerThread* mainThread,
@@ -1142,6 +1197,11 @@ private:
             // Call the HAL standby method unconditionally, and don't change mStandby flag
             void    inputStandBy();
 
+            // Attach the normal active tracks to the shared conversion of their format,
+            // creating the missing ones and deleting the unused ones
+            void    updateSharedConversions(const Vector< sp<RecordTrack> >& activeTracks);
+            void    clearSharedConversions();
+
             AudioStreamIn                       *mInput;
             SortedVector < sp<RecordTrack> >    mTracks;
             // mActiveTracks has dual roles:  it indicates the current active track(s), and
@@ -1199,4 +1259,9 @@ private:
             sp<NBLog::Writer>                   mFastCaptureNBLogWriter;
 
             bool                                mFastTrackAvail;    // true if fast track available
+
+            // accessible only within the threadLoop(), no locks required
+            const bool                          mSharedConversionEnabled;
+            Vector<SharedRecordConversion *>    mSharedConversions;
+            int32_t                             mSharedConversionId;    // last id allocated
 };
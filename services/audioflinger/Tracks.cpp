@@ -1995,7 +1995,8 @@ AudioFlinger::RecordThread::RecordTrack::RecordTrack(
                   type),
         mOverflow(false), mResampler(NULL), mRsmpOutBuffer(NULL), mRsmpOutFrameCount(0),
         // See real initialization of mRsmpInFront at RecordThread::start()
-        mRsmpInUnrel(0), mRsmpInFront(0), mFramesToDrop(0), mResamplerBufferProvider(NULL)
+        mRsmpInUnrel(0), mRsmpInFront(0), mFramesToDrop(0), mResamplerBufferProvider(NULL),
+        mSharedConversion(NULL), mSharedConversionId(0), mSharedFront(0)
 {
     if (mCblk == NULL) {
         return;
@@ -71,3 +71,57 @@ LOCAL_MODULE:= test-mixer
 LOCAL_MODULE_TAGS := optional
 
 include $(BUILD_EXECUTABLE)
+
+#
+# effect chain benchmark
+#
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	test-effect-chain.cpp \
+	../EffectWorker.cpp
+
+LOCAL_C_INCLUDES := \
+	$(call include-path-for, audio-effects) \
+	$(call include-path-for, audio-utils) \
+	frameworks/av/services/audioflinger
+
+LOCAL_SHARED_LIBRARIES := \
+	libeffects \
+	libaudioutils \
+	libcutils \
+	libutils \
+	liblog
+
+LOCAL_MODULE:= test-effect-chain
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+
+#
+# record fan-out benchmark
+#
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	test-record-fanout.cpp \
+	../SharedRecordConversion.cpp
+
+LOCAL_C_INCLUDES := \
+	$(call include-path-for, audio-utils) \
+	frameworks/av/services/audioflinger
+
+LOCAL_SHARED_LIBRARIES := \
+	libaudioresampler \
+	libaudioutils \
+	libnbaio \
+	libcutils \
+	libutils \
+	liblog
+
+LOCAL_MODULE:= test-record-fanout
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
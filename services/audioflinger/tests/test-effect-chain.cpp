@@ -0,0 +1,625 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <audio_effects/effect_bassboost.h>
+#include <audio_effects/effect_environmentalreverb.h>
+#include <audio_effects/effect_equalizer.h>
+#include <audio_effects/effect_presetreverb.h>
+#include <audio_effects/effect_virtualizer.h>
+#include <media/EffectsFactoryApi.h>
+#include <audio_utils/primitives.h>
+#include "EffectWorker.h"
+
+/* Benchmarks a chain of insert effects loaded through the effects factory, the way
+ * EffectChain::process_l() runs them on a playback thread: every effect of a session chain
+ * processes the session buffer in place except the last one, which accumulates into the mix
+ * buffer. In the output mix session all the effects process the mix buffer in place.
+ *
+ * With -p, an output mix chain is also run in real time behind a synthetic mixer load, first
+ * inline as threadLoop() does and then on a worker thread pipelined by one buffer as with
+ * property af.effect_worker. Each cycle must complete within one buffer period or it is
+ * counted as an underrun. The pipelined output must be the inline output delayed by one
+ * buffer, otherwise the test fails. With -a, the mix is also sent to an auxiliary environmental
+ * reverb at the head of the chain: on the worker, the mixer accumulates the send into a buffer
+ * of its own which is copied to the reverb input when the buffers are exchanged. The worker
+ * is the EffectWorker that AudioFlinger::EffectWorkerThread is built on.
+ *
+ * The effects are taken from the effects factory configuration (audio_effects.conf), so the
+ * libraries listed there must be present.
+ */
+
+struct ChainEffect {
+    char letter;
+    const char *name;
+    const effect_uuid_t *type;
+};
+
+static const ChainEffect kEffects[] = {
+    { 'e', "equalizer", SL_IID_EQUALIZER },
+    { 'b', "bass boost", SL_IID_BASSBOOST },
+    { 'v', "virtualizer", SL_IID_VIRTUALIZER },
+    { 'r', "preset reverb", SL_IID_PRESETREVERB },
+    { 'R', "env reverb", SL_IID_ENVIRONMENTALREVERB },
+};
+static const size_t kNumEffects = sizeof(kEffects) / sizeof(kEffects[0]);
+
+struct Stage {
+    const ChainEffect *effect;
+    effect_handle_t handle;
+    effect_descriptor_t desc;
+    uint32_t *processNs;
+};
+
+struct Chain {
+    Stage *stages;
+    size_t numStages;
+    size_t opened;
+    size_t frameCount;
+    int16_t *in;
+    int16_t *out;
+    Stage *aux;         // auxiliary effect processed first, see EffectChain::addEffect_l()
+    int32_t *auxIn;     // input buffer of the auxiliary effect
+};
+
+static const ChainEffect kAuxEffect = {
+    'R', "aux env reverb", SL_IID_ENVIRONMENTALREVERB
+};
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s [-e effects] [-r sample-rate] [-f frames] [-s seconds] [-g]\n"
+            "       [-p] [-l load] [-a]\n", name);
+    fprintf(stderr, "    -e    effects in chain order (default ebvr):\n");
+    for (size_t i = 0; i < kNumEffects; i++) {
+        fprintf(stderr, "              %c %s\n", kEffects[i].letter, kEffects[i].name);
+    }
+    fprintf(stderr, "    -r    sample rate (default 48000)\n");
+    fprintf(stderr, "    -f    frames per buffer (default 960)\n");
+    fprintf(stderr, "    -s    seconds of audio (default 10)\n");
+    fprintf(stderr, "    -g    output mix chain: all effects process in place\n");
+    fprintf(stderr, "    -p    real time output mix chain, inline and on a worker thread\n");
+    fprintf(stderr, "    -l    synthetic mixer load with -p, in %% of a buffer period "
+            "(default 50)\n");
+    fprintf(stderr, "    -a    with -p, the mix is also sent to an auxiliary environmental "
+            "reverb\n");
+}
+
+static int64_t threadCpuNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int64_t monotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static int command(effect_handle_t handle, uint32_t cmd, uint32_t size, void *data) {
+    int reply = 0;
+    uint32_t replySize = sizeof(reply);
+    int status = (*handle)->command(handle, cmd, size, data, &replySize, &reply);
+    return status != 0 ? status : reply;
+}
+
+// sets a parameter with a 32 bit id and a 16 bit value, the format of all the settings below
+static int setParam16(effect_handle_t handle, uint32_t param, int16_t value) {
+    uint32_t buf32[(sizeof(effect_param_t) + sizeof(uint32_t) + sizeof(int16_t) + 3) / 4];
+    effect_param_t *p = (effect_param_t *)buf32;
+    p->psize = sizeof(uint32_t);
+    p->vsize = sizeof(int16_t);
+    *(uint32_t *)p->data = param;
+    *(int16_t *)(p->data + sizeof(uint32_t)) = value;
+    return command(handle, EFFECT_CMD_SET_PARAM,
+            sizeof(effect_param_t) + sizeof(uint32_t) + sizeof(int16_t), p);
+}
+
+// finds an insert or auxiliary implementation of an effect type in the factory
+static bool findEffect(const effect_uuid_t *type, uint32_t flagType, effect_descriptor_t *desc) {
+    uint32_t numEffects;
+    if (EffectQueryNumberEffects(&numEffects) != 0) {
+        return false;
+    }
+    for (uint32_t i = 0; i < numEffects; i++) {
+        if (EffectQueryEffect(i, desc) == 0 &&
+                memcmp(&desc->type, type, sizeof(effect_uuid_t)) == 0 &&
+                (desc->flags & EFFECT_FLAG_TYPE_MASK) == flagType) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// an auxiliary effect reads a mono input of its own and accumulates into out
+static int openStage(Stage *stage, int sessionId, uint32_t sampleRate, size_t frameCount,
+        int16_t *in, int16_t *out, bool auxiliary = false) {
+    if (!findEffect(stage->effect->type,
+            auxiliary ? EFFECT_FLAG_TYPE_AUXILIARY : EFFECT_FLAG_TYPE_INSERT, &stage->desc)) {
+        return -ENOENT;
+    }
+    int status = EffectCreate(&stage->desc.uuid, sessionId, 1 /*ioId*/, &stage->handle);
+    if (status != 0) {
+        stage->handle = NULL;
+        return status;
+    }
+
+    effect_config_t config;
+    memset(&config, 0, sizeof(config));
+    config.inputCfg.buffer.frameCount = frameCount;
+    config.inputCfg.buffer.s16 = in;
+    config.inputCfg.samplingRate = sampleRate;
+    config.inputCfg.channels = AUDIO_CHANNEL_OUT_STEREO;
+    config.inputCfg.format = AUDIO_FORMAT_PCM_16_BIT;
+    config.inputCfg.accessMode = EFFECT_BUFFER_ACCESS_READ;
+    config.inputCfg.mask = EFFECT_CONFIG_ALL;
+    config.outputCfg = config.inputCfg;
+    config.outputCfg.buffer.s16 = out;
+    if (auxiliary) {
+        config.inputCfg.channels = AUDIO_CHANNEL_OUT_MONO;
+    }
+    // as in EffectModule::configure(): accumulate <=> input buffer != output buffer
+    config.outputCfg.accessMode = in != out ?
+            EFFECT_BUFFER_ACCESS_ACCUMULATE : EFFECT_BUFFER_ACCESS_WRITE;
+
+    status = command(stage->handle, EFFECT_CMD_INIT, 0, NULL);
+    if (status == 0) {
+        status = command(stage->handle, EFFECT_CMD_SET_CONFIG, sizeof(config), &config);
+    }
+    if (status != 0) {
+        return status;
+    }
+    // settings that keep each effect busy: unset, some engines bypass their processing
+    if (memcmp(stage->effect->type, SL_IID_BASSBOOST, sizeof(effect_uuid_t)) == 0) {
+        setParam16(stage->handle, BASSBOOST_PARAM_STRENGTH, 1000);
+    } else if (memcmp(stage->effect->type, SL_IID_VIRTUALIZER, sizeof(effect_uuid_t)) == 0) {
+        setParam16(stage->handle, VIRTUALIZER_PARAM_STRENGTH, 1000);
+    } else if (memcmp(stage->effect->type, SL_IID_EQUALIZER, sizeof(effect_uuid_t)) == 0) {
+        setParam16(stage->handle, EQ_PARAM_CUR_PRESET, 1);
+    } else if (memcmp(stage->effect->type, SL_IID_PRESETREVERB, sizeof(effect_uuid_t)) == 0) {
+        setParam16(stage->handle, REVERB_PARAM_PRESET, REVERB_PRESET_LARGEHALL);
+    } else if (memcmp(stage->effect->type, SL_IID_ENVIRONMENTALREVERB,
+            sizeof(effect_uuid_t)) == 0) {
+        setParam16(stage->handle, REVERB_PARAM_ROOM_LEVEL, 0);
+        setParam16(stage->handle, REVERB_PARAM_REVERB_LEVEL, 0);
+    }
+    return command(stage->handle, EFFECT_CMD_ENABLE, 0, NULL);
+}
+
+static int compareUint32(const void *pa, const void *pb) {
+    uint32_t a = *(const uint32_t *)pa;
+    uint32_t b = *(const uint32_t *)pb;
+    return a < b ? -1 : a > b ? 1 : 0;
+}
+
+// prints the mean, 99th percentile and maximum of n samples, and the mean load
+static void printStats(const char *name, uint32_t *ns, size_t n, double bufferNs) {
+    double mean = 0;
+    for (size_t i = 0; i < n; i++) {
+        mean += ns[i];
+    }
+    mean /= n;
+    qsort(ns, n, sizeof(uint32_t), compareUint32);
+    printf("%-16s %10.1f %10.1f %10.1f %10.2f\n", name, mean * 1e-3, ns[(n * 99) / 100] * 1e-3,
+            ns[n - 1] * 1e-3, 100.0 * mean / bufferNs);
+}
+
+// opens the effects of a chain processing in into out, see EffectChain::process_l();
+// with numBuffers != 0, the process time of each stage is recorded for that many buffers
+static int openChain(Chain *chain, const char *effects, int sessionId, uint32_t sampleRate,
+        size_t frameCount, int16_t *in, int16_t *out, size_t numBuffers) {
+    chain->numStages = strlen(effects);
+    chain->stages = new Stage[chain->numStages];
+    chain->opened = 0;
+    chain->frameCount = frameCount;
+    chain->in = in;
+    chain->out = out;
+    chain->aux = NULL;
+    chain->auxIn = NULL;
+
+    for (; chain->opened < chain->numStages; ) {
+        Stage *stage = &chain->stages[chain->opened++];
+        stage->effect = NULL;
+        stage->handle = NULL;
+        stage->processNs = numBuffers != 0 ? new uint32_t[numBuffers] : NULL;
+        for (size_t i = 0; i < kNumEffects; i++) {
+            if (kEffects[i].letter == effects[chain->opened - 1]) {
+                stage->effect = &kEffects[i];
+            }
+        }
+        if (stage->effect == NULL) {
+            fprintf(stderr, "unknown effect '%c'\n", effects[chain->opened - 1]);
+            return -EINVAL;
+        }
+        const bool last = chain->opened == chain->numStages;
+        int status = openStage(stage, sessionId, sampleRate, frameCount, in, last ? out : in);
+        if (status != 0) {
+            fprintf(stderr, "cannot open %s: %d\n", stage->effect->name, status);
+            return status;
+        }
+    }
+    return 0;
+}
+
+// opens an auxiliary effect accumulating into the input of an output mix chain
+static int openAux(Chain *chain, uint32_t sampleRate, int32_t *auxIn) {
+    chain->aux = new Stage;
+    chain->aux->effect = &kAuxEffect;
+    chain->aux->handle = NULL;
+    chain->aux->processNs = NULL;
+    chain->auxIn = auxIn;
+    int status = openStage(chain->aux, AUDIO_SESSION_OUTPUT_MIX, sampleRate, chain->frameCount,
+            (int16_t *)auxIn, chain->in, true /*auxiliary*/);
+    if (status != 0) {
+        fprintf(stderr, "cannot open %s: %d\n", kAuxEffect.name, status);
+    }
+    return status;
+}
+
+static void closeChain(Chain *chain) {
+    if (chain->aux != NULL) {
+        if (chain->aux->handle != NULL) {
+            EffectRelease(chain->aux->handle);
+        }
+        delete chain->aux;
+    }
+    for (size_t s = 0; s < chain->opened; s++) {
+        if (chain->stages[s].handle != NULL) {
+            EffectRelease(chain->stages[s].handle);
+        }
+        delete[] chain->stages[s].processNs;
+    }
+    delete[] chain->stages;
+}
+
+// processes buffer n through all the stages of the chain
+static void processChain(Chain *chain, size_t n) {
+    if (chain->aux != NULL) {
+        // as EffectModule::process(): the send is converted to 16 bit in place, then cleared
+        audio_buffer_t inBuffer, outBuffer;
+        ditherAndClamp(chain->auxIn, chain->auxIn, chain->frameCount / 2);
+        inBuffer.frameCount = chain->frameCount;
+        inBuffer.s32 = chain->auxIn;
+        outBuffer.frameCount = chain->frameCount;
+        outBuffer.s16 = chain->in;
+        (*chain->aux->handle)->process(chain->aux->handle, &inBuffer, &outBuffer);
+        memset(chain->auxIn, 0, chain->frameCount * sizeof(int32_t));
+    }
+    for (size_t s = 0; s < chain->numStages; s++) {
+        Stage *stage = &chain->stages[s];
+        audio_buffer_t inBuffer, outBuffer;
+        inBuffer.frameCount = chain->frameCount;
+        inBuffer.s16 = chain->in;
+        outBuffer.frameCount = chain->frameCount;
+        outBuffer.s16 = s == chain->numStages - 1 ? chain->out : chain->in;
+        const int64_t start = stage->processNs != NULL ? threadCpuNs() : 0;
+        (*stage->handle)->process(stage->handle, &inBuffer, &outBuffer);
+        if (stage->processNs != NULL) {
+            stage->processNs[n] = (uint32_t)(threadCpuNs() - start);
+        }
+    }
+}
+
+// a new mix of a tone and noise for each buffer, as the mixer would write it
+struct MixSource {
+    double phase;
+    unsigned seed;
+};
+
+static void mix(MixSource *source, int16_t *buffer, size_t frameCount, uint32_t sampleRate) {
+    for (size_t i = 0; i < frameCount; i++) {
+        source->seed = source->seed * 1103515245 + 12345;
+        const int16_t noise = (int16_t)(source->seed >> 16) / 8;
+        const int16_t tone = (int16_t)(8000 * sin(source->phase));
+        source->phase += 2 * M_PI * 220 / sampleRate;
+        buffer[2 * i] = tone + noise;
+        buffer[2 * i + 1] = tone - noise;
+    }
+}
+
+// the send of the mix to an auxiliary effect, accumulated as the mixer does in 4.27 format
+static void sendAux(const int16_t *buffer, int32_t *aux, size_t frameCount) {
+    for (size_t i = 0; i < frameCount; i++) {
+        aux[i] += ((int32_t)buffer[2 * i] + buffer[2 * i + 1]) << 11;
+    }
+}
+
+// the synthetic mixer load: spins for ns of thread CPU time
+static void spin(int64_t ns) {
+    const int64_t end = threadCpuNs() + ns;
+    while (threadCpuNs() < end) {
+    }
+}
+
+static uint32_t hashBuffer(const int16_t *buffer, size_t samples) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < samples; i++) {
+        hash = (hash ^ (uint16_t)buffer[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Runs the chain on an EffectWorker, the base of AudioFlinger::EffectWorkerThread: the chain
+// processes the worker buffer in place while the mixer prepares the next one, and exchange()
+// swaps the two.
+class ChainWorker : public android::EffectWorker {
+public:
+    ChainWorker(Chain *chain, size_t frameCount)
+        : EffectWorker(frameCount, 2 /*channelCount*/), mChain(chain), mCpuNs(0) { }
+
+    // CPU time of the worker thread, once it has exited
+    int64_t cpuNs() const { return mCpuNs; }
+
+protected:
+    virtual void process() {
+        processChain(mChain, 0);
+        mCpuNs = threadCpuNs();
+    }
+
+private:
+    Chain *mChain;
+    int64_t mCpuNs;
+};
+
+// the auxiliary effect id the mixer sends to, as given to EffectWorker::auxBuffer()
+static const int kAuxEffectId = 1;
+
+struct RealtimeResult {
+    uint32_t *cycleNs;      // mixer cycle time for each buffer
+    uint32_t *hashes;       // hash of the output of each buffer
+    uint32_t underruns;     // cycles which did not complete within a buffer period
+    uint32_t stalls;        // exchanges which waited for the worker
+    int64_t mixerCpuNs;
+    int64_t workerCpuNs;
+};
+
+// Runs numBuffers cycles of mixing, with a synthetic load of loadNs, and output mix effects,
+// one buffer period apart like a thread writing to a HAL with a single buffer of headroom.
+// With aux, the mix is also sent to an auxiliary effect.
+static int runRealtime(const char *effects, bool aux, bool pipelined, uint32_t sampleRate,
+        size_t frameCount, size_t numBuffers, int64_t loadNs, RealtimeResult *result) {
+    const size_t samples = frameCount * 2;
+    int16_t *mixBuffer = new int16_t[samples];
+    int32_t *auxIn = new int32_t[frameCount];
+    memset(auxIn, 0, frameCount * sizeof(int32_t));
+    Chain chain;
+    android::sp<ChainWorker> worker;
+    if (pipelined) {
+        worker = new ChainWorker(&chain, frameCount);
+    }
+    int16_t *chainBuffer = pipelined ? worker->buffer() : mixBuffer;
+    int status = openChain(&chain, effects, AUDIO_SESSION_OUTPUT_MIX, sampleRate, frameCount,
+            chainBuffer, chainBuffer, 0);
+    if (status == 0 && aux) {
+        status = openAux(&chain, sampleRate, auxIn);
+    }
+
+    if (status == 0) {
+        const int64_t periodNs = (int64_t)(1e9 * frameCount / sampleRate);
+        MixSource source = { 0, 1 };
+        result->underruns = 0;
+        const int64_t cpuStart = threadCpuNs();
+        int64_t next = monotonicNs();
+        for (size_t n = 0; n < numBuffers; n++) {
+            const int64_t start = monotonicNs();
+            // the sends are accumulated first, while the worker may still process the
+            // previous buffer
+            mix(&source, mixBuffer, frameCount, sampleRate);
+            if (aux) {
+                // the mixer accumulates into the effect input unless the worker may be
+                // reading it, see MixerThread::prepareTracks_l()
+                int32_t *auxSend = pipelined ? worker->auxBuffer(kAuxEffectId, auxIn) : auxIn;
+                sendAux(mixBuffer, auxSend, frameCount);
+            }
+            spin(loadNs);
+            if (pipelined) {
+                worker->exchange(mixBuffer);
+            } else {
+                processChain(&chain, 0);
+            }
+            result->hashes[n] = hashBuffer(mixBuffer, samples);
+            const int64_t end = monotonicNs();
+            result->cycleNs[n] = (uint32_t)(end - start);
+
+            // the HAL has consumed the previous buffer when the next period starts
+            next += periodNs;
+            if (end > next) {
+                result->underruns++;
+                next = end;
+            } else {
+                struct timespec ts;
+                ts.tv_sec = next / 1000000000;
+                ts.tv_nsec = next % 1000000000;
+                clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+            }
+        }
+        result->mixerCpuNs = threadCpuNs() - cpuStart;
+    }
+
+    result->stalls = 0;
+    result->workerCpuNs = 0;
+    if (worker != 0) {
+        worker->exit();
+        worker->join();
+        result->stalls = worker->numStalls();
+        result->workerCpuNs = worker->cpuNs();
+    }
+
+    closeChain(&chain);
+    delete[] mixBuffer;
+    delete[] auxIn;
+    return status;
+}
+
+static int benchmarkRealtime(const char *effects, bool aux, uint32_t sampleRate,
+        size_t frameCount, size_t numBuffers, int loadPercent) {
+    const double bufferNs = 1e9 * frameCount / sampleRate;
+    const int64_t loadNs = (int64_t)(bufferNs * loadPercent / 100);
+    RealtimeResult results[2];
+    static const char * const kModes[2] = { "inline", "worker" };
+    int status = 0;
+
+    for (int mode = 0; mode < 2 && status == 0; mode++) {
+        results[mode].cycleNs = new uint32_t[numBuffers];
+        results[mode].hashes = new uint32_t[numBuffers];
+        status = runRealtime(effects, aux, mode == 1, sampleRate, frameCount, numBuffers,
+                loadNs, &results[mode]);
+        if (status != 0) {
+            delete[] results[mode].cycleNs;
+            delete[] results[mode].hashes;
+            return status;
+        }
+    }
+
+    printf("%zu buffers of %zu frames at %u Hz in real time, output mix chain%s, "
+            "mixer load %d%%\n", numBuffers, frameCount, sampleRate,
+            aux ? " with auxiliary send" : "", loadPercent);
+    printf("%-16s %10s %10s %10s %10s\n", "us per cycle", "mean", "p99", "max", "% of period");
+    for (int mode = 0; mode < 2; mode++) {
+        printStats(kModes[mode], results[mode].cycleNs, numBuffers, bufferNs);
+    }
+    printf("%-16s %10s %10s %10s %10s\n", "", "underruns", "stalls", "mixer cpu", "worker cpu");
+    const double totalNs = bufferNs * numBuffers;
+    for (int mode = 0; mode < 2; mode++) {
+        printf("%-16s %10u %10u %9.2f%% %9.2f%%\n", kModes[mode], results[mode].underruns,
+                results[mode].stalls, 100.0 * results[mode].mixerCpuNs / totalNs,
+                100.0 * results[mode].workerCpuNs / totalNs);
+    }
+
+    // the worker writes silence first, then the inline output one buffer late
+    int16_t *silence = new int16_t[frameCount * 2];
+    memset(silence, 0, frameCount * 2 * sizeof(int16_t));
+    bool delayed = results[1].hashes[0] == hashBuffer(silence, frameCount * 2);
+    for (size_t n = 1; n < numBuffers; n++) {
+        delayed = delayed && results[1].hashes[n] == results[0].hashes[n - 1];
+    }
+    printf("worker output is inline output delayed by one buffer: %s\n",
+            delayed ? "PASS" : "FAIL");
+    delete[] silence;
+
+    for (int mode = 0; mode < 2; mode++) {
+        delete[] results[mode].cycleNs;
+        delete[] results[mode].hashes;
+    }
+    return delayed ? 0 : -EIO;
+}
+
+int main(int argc, char **argv) {
+    const char *effects = "ebvr";
+    uint32_t sampleRate = 48000;
+    size_t frameCount = 960;
+    int seconds = 10;
+    bool outputMix = false;
+    bool realtime = false;
+    int loadPercent = 50;
+    bool aux = false;
+    int ch;
+
+    while ((ch = getopt(argc, argv, "e:r:f:s:gpl:ah")) != -1) {
+        switch (ch) {
+        case 'e':
+            effects = optarg;
+            break;
+        case 'r':
+            sampleRate = atoi(optarg);
+            break;
+        case 'f':
+            frameCount = atoi(optarg);
+            break;
+        case 's':
+            seconds = atoi(optarg);
+            break;
+        case 'g':
+            outputMix = true;
+            break;
+        case 'p':
+            realtime = true;
+            break;
+        case 'l':
+            loadPercent = atoi(optarg);
+            break;
+        case 'a':
+            aux = true;
+            break;
+        case 'h':
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    const size_t numStages = strlen(effects);
+    if (numStages == 0 || sampleRate < 8000 || frameCount == 0 || seconds <= 0 ||
+            loadPercent < 0 || loadPercent > 100) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const size_t numBuffers = (size_t)seconds * sampleRate / frameCount;
+    if (numBuffers == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // the session buffer the tracks are mixed into, and the mix buffer of the thread
+    int16_t *sessionBuffer = new int16_t[frameCount * 2];
+    int16_t *mixBuffer = new int16_t[frameCount * 2];
+    int16_t *chainIn = outputMix ? mixBuffer : sessionBuffer;
+    Chain chain;
+    int status = openChain(&chain, effects, outputMix ? AUDIO_SESSION_OUTPUT_MIX : 1 /*sessionId*/,
+            sampleRate, frameCount, chainIn, mixBuffer, numBuffers);
+
+    if (status == 0) {
+        uint32_t *chainNs = new uint32_t[numBuffers];
+        MixSource source = { 0, 1 };
+        for (size_t n = 0; n < numBuffers; n++) {
+            mix(&source, chainIn, frameCount, sampleRate);
+            if (!outputMix) {
+                memset(mixBuffer, 0, frameCount * 2 * sizeof(int16_t));
+            }
+            int64_t chainStart = threadCpuNs();
+            processChain(&chain, n);
+            chainNs[n] = (uint32_t)(threadCpuNs() - chainStart);
+        }
+
+        const double bufferNs = 1e9 * frameCount / sampleRate;
+        printf("%zu buffers of %zu frames at %u Hz, %s chain\n", numBuffers, frameCount,
+                sampleRate, outputMix ? "output mix" : "session");
+        printf("%-16s %10s %10s %10s %10s\n", "us per buffer", "mean", "p99", "max", "% of core");
+        for (size_t s = 0; s < numStages; s++) {
+            printStats(chain.stages[s].effect->name, chain.stages[s].processNs, numBuffers,
+                    bufferNs);
+        }
+        printStats("chain", chainNs, numBuffers, bufferNs);
+        delete[] chainNs;
+    } else if (status == -EINVAL) {
+        usage(argv[0]);
+    }
+    closeChain(&chain);
+    delete[] sessionBuffer;
+    delete[] mixBuffer;
+
+    if (status == 0 && realtime) {
+        printf("\n");
+        status = benchmarkRealtime(effects, aux, sampleRate, frameCount, numBuffers,
+                loadPercent);
+    }
+    return status == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
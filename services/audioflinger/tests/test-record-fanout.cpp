@@ -0,0 +1,383 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <audio_utils/primitives.h>
+#include <media/AudioBufferProvider.h>
+#include "AudioResampler.h"
+#include "SharedRecordConversion.h"
+
+using namespace android;
+
+/* Benchmarks the conversion work of RecordThread::threadLoop() for several normal tracks
+ * recording the same input with the same sample rate and channel count:
+ *  - per track: each track resamples and channel converts the input itself,
+ *  - shared: the input is converted once by a SharedRecordConversion into a ring buffer which
+ *    each track copies from at its own position, as with property af.record_fanout.
+ * The output of each track must be the same in both modes, otherwise the test fails.
+ */
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s [-r input-rate] [-c input-channels] [-R track-rate]\n"
+            "       [-C track-channels] [-f frames] [-n tracks] [-s seconds]\n", name);
+    fprintf(stderr, "    -r    input sample rate (default 48000)\n");
+    fprintf(stderr, "    -c    input channel count, 1 or 2 (default 2)\n");
+    fprintf(stderr, "    -R    track sample rate (default 16000)\n");
+    fprintf(stderr, "    -C    track channel count, 1 or 2 (default 1)\n");
+    fprintf(stderr, "    -f    input frames per HAL read (default 960)\n");
+    fprintf(stderr, "    -n    maximum number of tracks (default 4)\n");
+    fprintf(stderr, "    -s    seconds of audio (default 10)\n");
+}
+
+static int64_t threadCpuNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static size_t roundup(size_t v) {
+    size_t p2 = 1;
+    while (p2 < v) {
+        p2 <<= 1;
+    }
+    return p2;
+}
+
+// The thread input: a ring of HAL reads, as mRsmpInBuffer
+struct Input {
+    int16_t *buffer;
+    size_t frames;
+    size_t framesP2;
+    uint32_t channelCount;
+    int32_t rear;
+};
+
+// The conversion of a track which converts the input itself from its own input position,
+// with the same budgeting and conversions as RecordThread::threadLoop()
+class Converter : public AudioBufferProvider {
+public:
+    Converter(const Input *input, uint32_t inputRate, uint32_t sampleRate,
+            uint32_t channelCount)
+        :   mInput(input), mResampler(NULL), mRsmpOutBuffer(NULL), mRsmpOutFrameCount(0),
+            mRsmpInUnrel(0), mRsmpInFront(input->rear), mInputRate(inputRate),
+            mSampleRate(sampleRate), mChannelCount(channelCount) {
+        if (inputRate != sampleRate) {
+            mResampler = AudioResampler::create(AUDIO_FORMAT_PCM_16_BIT,
+                    input->channelCount, sampleRate);
+            mResampler->setSampleRate(inputRate);
+            mResampler->setVolume(AudioResampler::UNITY_GAIN_FLOAT,
+                    AudioResampler::UNITY_GAIN_FLOAT);
+        }
+    }
+
+    virtual ~Converter() {
+        delete mResampler;
+        delete[] mRsmpOutBuffer;
+    }
+
+    // converts all the available input to dst, returns the number of frames written
+    size_t convert(int16_t *dst) {
+        size_t framesIn = mInput->rear - mRsmpInFront;
+        size_t framesOut;
+        if (mResampler == NULL) {
+            framesOut = framesIn;
+            int32_t front = mRsmpInFront;
+            while (framesIn > 0) {
+                front &= mInput->framesP2 - 1;
+                size_t part1 = mInput->framesP2 - front;
+                if (part1 > framesIn) {
+                    part1 = framesIn;
+                }
+                const int16_t *src = mInput->buffer + front * mInput->channelCount;
+                if (mInput->channelCount == mChannelCount) {
+                    memcpy(dst, src, part1 * mChannelCount * sizeof(int16_t));
+                } else if (mInput->channelCount == 1) {
+                    upmix_to_stereo_i16_from_mono_i16(dst, src, part1);
+                } else {
+                    downmix_to_mono_i16_from_stereo_i16(dst, src, part1);
+                }
+                dst += part1 * mChannelCount;
+                front += part1;
+                framesIn -= part1;
+            }
+            mRsmpInFront += framesOut;
+            return framesOut;
+        }
+
+        const double in(mInputRate);
+        const double out(mSampleRate);
+        framesIn = framesIn > mRsmpInUnrel ? framesIn - mRsmpInUnrel : 0;
+        framesOut = framesIn > 0 ? floor((framesIn - 1) * out / in) : 0;
+        if (framesOut == 0) {
+            return 0;
+        }
+        if (mRsmpOutFrameCount < framesOut) {
+            delete[] mRsmpOutBuffer;
+            mRsmpOutBuffer = new int32_t[framesOut * 2];
+            mRsmpOutFrameCount = framesOut;
+        }
+        memset(mRsmpOutBuffer, 0, framesOut * 2 * sizeof(int32_t));
+        mResampler->resample(mRsmpOutBuffer, framesOut, this);
+        if (mChannelCount == 1) {
+            ditherAndClamp(mRsmpOutBuffer, mRsmpOutBuffer, framesOut);
+            downmix_to_mono_i16_from_stereo_i16(dst, (const int16_t *)mRsmpOutBuffer,
+                    framesOut);
+        } else {
+            ditherAndClamp((int32_t *)dst, mRsmpOutBuffer, framesOut);
+        }
+        return framesOut;
+    }
+
+    // AudioBufferProvider interface
+    virtual status_t getNextBuffer(AudioBufferProvider::Buffer* buffer, int64_t pts __unused) {
+        size_t filled = mInput->rear - mRsmpInFront;
+        int32_t front = mRsmpInFront & (mInput->framesP2 - 1);
+        size_t part1 = mInput->framesP2 - front;
+        if (part1 > filled) {
+            part1 = filled;
+        }
+        if (part1 > buffer->frameCount) {
+            part1 = buffer->frameCount;
+        }
+        if (part1 == 0) {
+            fprintf(stderr, "resampler starved\n");
+            exit(EXIT_FAILURE);
+        }
+        buffer->raw = mInput->buffer + front * mInput->channelCount;
+        buffer->frameCount = part1;
+        mRsmpInUnrel = part1;
+        return NO_ERROR;
+    }
+
+    virtual void releaseBuffer(AudioBufferProvider::Buffer* buffer) {
+        mRsmpInUnrel -= buffer->frameCount;
+        mRsmpInFront += buffer->frameCount;
+        buffer->raw = NULL;
+        buffer->frameCount = 0;
+    }
+
+private:
+    const Input *mInput;
+    AudioResampler *mResampler;
+    int32_t *mRsmpOutBuffer;
+    size_t mRsmpOutFrameCount;
+    size_t mRsmpInUnrel;
+    int32_t mRsmpInFront;
+    const uint32_t mInputRate;
+    const uint32_t mSampleRate;
+    const uint32_t mChannelCount;
+};
+
+// fills one HAL read of a tone and noise at the input rear
+static void capture(Input *input, size_t frameCount, uint32_t sampleRate, double *phase,
+        unsigned *seed) {
+    for (size_t i = 0; i < frameCount; i++) {
+        *seed = *seed * 1103515245 + 12345;
+        const int16_t noise = (int16_t)(*seed >> 16) / 8;
+        const int16_t tone = (int16_t)(8000 * sin(*phase));
+        *phase += 2 * M_PI * 440 / sampleRate;
+        int16_t *frame = input->buffer +
+                ((input->rear + i) & (input->framesP2 - 1)) * input->channelCount;
+        frame[0] = tone + noise;
+        if (input->channelCount == 2) {
+            frame[1] = tone - noise;
+        }
+    }
+    input->rear += frameCount;
+}
+
+// Records numReads HAL reads for numTracks tracks, returns the mean thread CPU time per read.
+// The output of each track is written to out[track], which has room for maxFrames frames.
+static double run(bool shared, size_t numTracks, uint32_t inputRate, uint32_t inputChannels,
+        uint32_t sampleRate, uint32_t channelCount, size_t frameCount, size_t numReads,
+        int16_t **out, size_t maxFrames) {
+    Input input;
+    input.frames = frameCount * 7;
+    input.framesP2 = roundup(input.frames);
+    input.buffer = new int16_t[input.framesP2 * inputChannels];
+    input.channelCount = inputChannels;
+    input.rear = 0;
+
+    const size_t maxOut = (size_t) ceil(input.framesP2 * (double) sampleRate / inputRate) + 1;
+    int16_t *ring = new int16_t[maxOut * channelCount];
+    Converter **converters = new Converter *[numTracks];
+    for (size_t t = 0; t < numTracks; t++) {
+        converters[t] = shared ? NULL :
+                new Converter(&input, inputRate, sampleRate, channelCount);
+    }
+    // as RecordThread::updateSharedConversions(): the tracks start at the next frame converted
+    SharedRecordConversion *conversion = NULL;
+    int32_t *fronts = new int32_t[numTracks];
+    if (shared) {
+        conversion = new SharedRecordConversion(1 /*id*/, input.buffer, input.frames,
+                input.framesP2, inputRate, inputChannels, input.rear, sampleRate, channelCount);
+        for (size_t t = 0; t < numTracks; t++) {
+            fronts[t] = conversion->rear();
+        }
+    }
+
+    size_t written = 0;
+    double phase = 0;
+    unsigned seed = 1;
+    int64_t cpuNs = 0;
+    for (size_t n = 0; n < numReads; n++) {
+        capture(&input, frameCount, inputRate, &phase, &seed);
+        const int64_t start = threadCpuNs();
+        size_t frames = 0;
+        if (shared) {
+            // convert once, then each track copies to its client buffer
+            conversion->convert(input.rear);
+            for (size_t t = 0; t < numTracks; t++) {
+                bool overrun;
+                frames = conversion->read(&fronts[t], out[t] + written * channelCount,
+                        maxFrames - written, &overrun);
+                if (overrun) {
+                    fprintf(stderr, "shared conversion overrun\n");
+                    exit(EXIT_FAILURE);
+                }
+            }
+        } else {
+            for (size_t t = 0; t < numTracks; t++) {
+                frames = converters[t]->convert(ring);
+                if (written + frames > maxFrames) {
+                    frames = maxFrames - written;
+                }
+                memcpy(out[t] + written * channelCount, ring,
+                        frames * channelCount * sizeof(int16_t));
+            }
+        }
+        cpuNs += threadCpuNs() - start;
+        written += frames;
+    }
+
+    for (size_t t = 0; t < numTracks; t++) {
+        delete converters[t];
+    }
+    delete[] converters;
+    delete conversion;
+    delete[] fronts;
+    delete[] ring;
+    delete[] input.buffer;
+    return (double) cpuNs / numReads;
+}
+
+int main(int argc, char **argv) {
+    uint32_t inputRate = 48000;
+    uint32_t inputChannels = 2;
+    uint32_t sampleRate = 16000;
+    uint32_t channelCount = 1;
+    size_t frameCount = 960;
+    size_t maxTracks = 4;
+    int seconds = 10;
+    int ch;
+
+    while ((ch = getopt(argc, argv, "r:c:R:C:f:n:s:h")) != -1) {
+        switch (ch) {
+        case 'r':
+            inputRate = atoi(optarg);
+            break;
+        case 'c':
+            inputChannels = atoi(optarg);
+            break;
+        case 'R':
+            sampleRate = atoi(optarg);
+            break;
+        case 'C':
+            channelCount = atoi(optarg);
+            break;
+        case 'f':
+            frameCount = atoi(optarg);
+            break;
+        case 'n':
+            maxTracks = atoi(optarg);
+            break;
+        case 's':
+            seconds = atoi(optarg);
+            break;
+        case 'h':
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (inputRate < 8000 || sampleRate < 8000 || inputChannels < 1 || inputChannels > 2 ||
+            channelCount < 1 || channelCount > 2 || frameCount == 0 || maxTracks == 0 ||
+            seconds <= 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const size_t numReads = (size_t)seconds * inputRate / frameCount;
+    if (numReads == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const size_t maxFrames = (size_t)seconds * sampleRate;
+    int16_t **perTrackOut = new int16_t *[maxTracks];
+    int16_t **sharedOut = new int16_t *[maxTracks];
+    for (size_t t = 0; t < maxTracks; t++) {
+        perTrackOut[t] = new int16_t[maxFrames * channelCount];
+        sharedOut[t] = new int16_t[maxFrames * channelCount];
+        memset(perTrackOut[t], 0, maxFrames * channelCount * sizeof(int16_t));
+        memset(sharedOut[t], 0, maxFrames * channelCount * sizeof(int16_t));
+    }
+
+    const double readNs = 1e9 * frameCount / inputRate;
+    printf("%zu reads of %zu frames at %u Hz %u ch, tracks at %u Hz %u ch\n", numReads,
+            frameCount, inputRate, inputChannels, sampleRate, channelCount);
+    printf("%-8s %14s %14s %14s %14s\n", "tracks", "per track us", "shared us",
+            "per track %", "shared %");
+    double perTrack1 = 0, shared1 = 0, perTrackN = 0, sharedN = 0;
+    bool match = true;
+    for (size_t numTracks = 1; numTracks <= maxTracks; numTracks++) {
+        const double perTrackNs = run(false, numTracks, inputRate, inputChannels, sampleRate,
+                channelCount, frameCount, numReads, perTrackOut, maxFrames);
+        const double sharedNs = run(true, numTracks, inputRate, inputChannels, sampleRate,
+                channelCount, frameCount, numReads, sharedOut, maxFrames);
+        printf("%-8zu %14.1f %14.1f %13.2f%% %13.2f%%\n", numTracks, perTrackNs * 1e-3,
+                sharedNs * 1e-3, 100 * perTrackNs / readNs, 100 * sharedNs / readNs);
+        if (numTracks == 1) {
+            perTrack1 = perTrackNs;
+            shared1 = sharedNs;
+        }
+        perTrackN = perTrackNs;
+        sharedN = sharedNs;
+        for (size_t t = 0; t < numTracks; t++) {
+            match = match && memcmp(perTrackOut[t], sharedOut[t],
+                    maxFrames * channelCount * sizeof(int16_t)) == 0;
+        }
+    }
+    if (maxTracks > 1) {
+        printf("us per additional track: per track %.1f, shared %.1f\n",
+                (perTrackN - perTrack1) * 1e-3 / (maxTracks - 1),
+                (sharedN - shared1) * 1e-3 / (maxTracks - 1));
+    }
+    printf("shared output is identical to per track output: %s\n", match ? "PASS" : "FAIL");
+
+    for (size_t t = 0; t < maxTracks; t++) {
+        delete[] perTrackOut[t];
+        delete[] sharedOut[t];
+    }
+    delete[] perTrackOut;
+    delete[] sharedOut;
+    return match ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -84,3 +84,7 @@ include $(BUILD_SHARED_LIBRARY)
 
 endif
 endif
+
+ifneq ($(USE_LEGACY_AUDIO_POLICY), 1)
+include $(call all-makefiles-under,$(LOCAL_PATH))
+endif
@@ -35,8 +35,11 @@
 #define APM_AUDIO_DEVICE_MATCH_ADDRESS_ALL (AUDIO_DEVICE_IN_REMOTE_SUBMIX | \
                                             AUDIO_DEVICE_OUT_REMOTE_SUBMIX)
 
+#include <fcntl.h>
 #include <inttypes.h>
 #include <math.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <cutils/properties.h>
 #include <utils/Log.h>
@@ -259,9 +262,11 @@ status_t AudioPolicyManager::setDeviceConnectionState(audio_devices_t device,
             } else {
                 return NO_MEMORY;
             }
+            invalidateRoutingCache();
 
             if (checkOutputsForDevice(devDesc, state, outputs, address) != NO_ERROR) {
                 mAvailableOutputDevices.remove(devDesc);
+                invalidateRoutingCache();
                 return INVALID_OPERATION;
             }
             // outputs should never be empty here
@@ -286,6 +291,7 @@ status_t AudioPolicyManager::setDeviceConnectionState(audio_devices_t device,
 
             // remove device from available output devices
             mAvailableOutputDevices.remove(devDesc);
+            invalidateRoutingCache();
 
             checkOutputsForDevice(devDesc, state, outputs, address);
             } break;
@@ -372,6 +378,7 @@ status_t AudioPolicyManager::setDeviceConnectionState(audio_devices_t device,
             } else {
                 return NO_MEMORY;
             }
+            invalidateRoutingCache();
         } break;
 
         // handle input device disconnection
@@ -390,6 +397,7 @@ status_t AudioPolicyManager::setDeviceConnectionState(audio_devices_t device,
 
             checkInputsForDevice(device, state, inputs, address);
             mAvailableInputDevices.remove(devDesc);
+            invalidateRoutingCache();
 
         } break;
 
@@ -583,6 +591,7 @@ void AudioPolicyManager::setPhoneState(audio_mode_t state)
     // store previous phone state for management of sonification strategy below
     int oldState = mPhoneState;
     mPhoneState = state;
+    invalidateStrategyCache();
     bool force = false;
 
     // are we entering or starting a call
@@ -751,6 +760,7 @@ void AudioPolicyManager::setForceUse(audio_policy_force_use_t usage,
         ALOGW("setForceUse() invalid usage %d", usage);
         break;
     }
+    invalidateStrategyCache();
 
     // check for device and output changes triggered by new force usage
     checkA2dpSuspend();
@@ -797,22 +807,52 @@ sp<AudioPolicyManager::IOProfile> AudioPolicyManager::getProfileForDirectOutput(
                                                                audio_channel_mask_t channelMask,
                                                                audio_output_flags_t flags)
 {
-    for (size_t i = 0; i < mHwModules.size(); i++) {
+    if (mRoutingCacheEnabled) {
+        for (size_t i = 0; i < mDirectProfileCache.size(); i++) {
+            const DirectProfileCacheEntry& entry = mDirectProfileCache[i];
+            if (entry.mDevice == device && entry.mSamplingRate == samplingRate &&
+                    entry.mFormat == format && entry.mChannelMask == channelMask &&
+                    entry.mFlags == flags) {
+                mDirectProfileCacheHits++;
+                return entry.mProfile;
+            }
+        }
+        mDirectProfileCacheMisses++;
+    }
+
+    sp<IOProfile> profile;
+    for (size_t i = 0; i < mHwModules.size() && profile == 0; i++) {
         if (mHwModules[i]->mHandle == 0) {
             continue;
         }
         for (size_t j = 0; j < mHwModules[i]->mOutputProfiles.size(); j++) {
-            sp<IOProfile> profile = mHwModules[i]->mOutputProfiles[j];
-            bool found = profile->isCompatibleProfile(device, samplingRate,
+            const sp<IOProfile>& candidate = mHwModules[i]->mOutputProfiles[j];
+            bool found = candidate->isCompatibleProfile(device, samplingRate,
                     NULL /*updatedSamplingRate*/, format, channelMask,
                     flags & AUDIO_OUTPUT_FLAG_COMPRESS_OFFLOAD ?
                         AUDIO_OUTPUT_FLAG_COMPRESS_OFFLOAD : AUDIO_OUTPUT_FLAG_DIRECT);
-            if (found && (mAvailableOutputDevices.types() & profile->mSupportedDevices.types())) {
-                return profile;
+            if (found && (mAvailableOutputDevices.types() & candidate->mSupportedDevices.types())) {
+                profile = candidate;
+                break;
             }
         }
     }
-    return 0;
+
+    if (mRoutingCacheEnabled) {
+        // the profiles and the available devices only change on device connection
+        if (mDirectProfileCache.size() >= MAX_ROUTING_CACHE_ENTRIES) {
+            mDirectProfileCache.removeAt(0);
+        }
+        DirectProfileCacheEntry entry;
+        entry.mDevice = device;
+        entry.mSamplingRate = samplingRate;
+        entry.mFormat = format;
+        entry.mChannelMask = channelMask;
+        entry.mFlags = flags;
+        entry.mProfile = profile;
+        mDirectProfileCache.add(entry);
+    }
+    return profile;
 }
 
 audio_io_handle_t AudioPolicyManager::getOutput(audio_stream_type_t stream,
@@ -1036,11 +1076,10 @@ non_direct_output:
     if (audio_is_linear_pcm(format)) {
         // get which output is suitable for the specified stream. The actual
         // routing change will happen when startOutput() will be called
-        SortedVector<audio_io_handle_t> outputs = getOutputsForDevice(device, mOutputs);
 
         // at this stage we should ignore the DIRECT flag as no direct output could be found earlier
         flags = (audio_output_flags_t)(flags & ~AUDIO_OUTPUT_FLAG_DIRECT);
-        output = selectOutput(outputs, flags, format);
+        output = getMixedOutputForDevice(device, flags, format);
     }
     ALOGW_IF((output == 0), "getOutput() could not find output for stream %d, samplingRate %d,"
             "format %d, channels %x, flags %x", stream, samplingRate, format, channelMask, flags);
@@ -1248,7 +1287,7 @@ void AudioPolicyManager::releaseOutput(audio_io_handle_t output)
         sp<AudioOutputDescriptor> outputDesc = mOutputs.valueAt(index);
         if (outputDesc->isActive()) {
             mpClientInterface->closeOutput(output);
-            mOutputs.removeItem(output);
+            removeOutput(output);
             mTestOutputs[testIndex] = 0;
         }
         return;
@@ -1862,6 +1901,12 @@ status_t AudioPolicyManager::dump(int fd)
     snprintf(buffer, SIZE, " Force use for hdmi system audio %d\n",
             mForceUse[AUDIO_POLICY_FORCE_FOR_HDMI_SYSTEM_AUDIO]);
     result.append(buffer);
+    snprintf(buffer, SIZE, " Routing cache %s: strategy hits %u misses %u,"
+             " output hits %u misses %u, direct profile hits %u misses %u\n",
+             mRoutingCacheEnabled ? "enabled" : "disabled",
+             mStrategyCacheHits, mStrategyCacheMisses, mOutputCacheHits, mOutputCacheMisses,
+             mDirectProfileCacheHits, mDirectProfileCacheMisses);
+    result.append(buffer);
 
     snprintf(buffer, SIZE, " Available output devices:\n");
     result.append(buffer);
@@ -2653,7 +2698,11 @@ AudioPolicyManager::AudioPolicyManager(AudioPolicyClientInterface *clientInterfa
     mTotalEffectsCpuLoad(0), mTotalEffectsMemory(0),
     mA2dpSuspended(false),
     mSpeakerDrcEnabled(false), mNextUniqueId(1),
-    mAudioPortGeneration(1)
+    mAudioPortGeneration(1),
+    mRoutingCacheEnabled(true), mStrategyCacheValid(0),
+    mStrategyCacheHits(0), mStrategyCacheMisses(0),
+    mOutputCacheHits(0), mOutputCacheMisses(0),
+    mDirectProfileCacheHits(0), mDirectProfileCacheMisses(0)
 {
     mUidCached = getuid();
     mpClientInterface = clientInterface;
@@ -2662,9 +2711,20 @@ AudioPolicyManager::AudioPolicyManager(AudioPolicyClientInterface *clientInterfa
         mForceUse[i] = AUDIO_POLICY_FORCE_NONE;
     }
 
+    char propValue[PROPERTY_VALUE_MAX];
+    if (property_get("audio.policy.routing_cache", propValue, "1")) {
+        mRoutingCacheEnabled = atoi(propValue) != 0;
+    }
+
+    // the configuration file is parsed once, and then loaded from its binary cache
+    const char *configCachePath = NULL;
+    if (property_get("audio.policy.config_cache", propValue, "1") && atoi(propValue) != 0) {
+        configCachePath = AUDIO_POLICY_CONFIG_CACHE_FILE;
+    }
+
     mDefaultOutputDevice = new DeviceDescriptor(String8(""), AUDIO_DEVICE_OUT_SPEAKER);
-    if (loadAudioPolicyConfig(AUDIO_POLICY_VENDOR_CONFIG_FILE) != NO_ERROR) {
-        if (loadAudioPolicyConfig(AUDIO_POLICY_CONFIG_FILE) != NO_ERROR) {
+    if (loadAudioPolicyConfig(AUDIO_POLICY_VENDOR_CONFIG_FILE, configCachePath) != NO_ERROR) {
+        if (loadAudioPolicyConfig(AUDIO_POLICY_CONFIG_FILE, configCachePath) != NO_ERROR) {
             ALOGE("could not load audio policy configuration file, setting defaults");
             defaultAudioPolicyConfig();
         }
@@ -2836,6 +2896,8 @@ AudioPolicyManager::AudioPolicyManager(AudioPolicyClientInterface *clientInterfa
         }
         i++;
     }
+    // routing evaluated while opening the outputs may include unreachable devices
+    invalidateRoutingCache();
     // make sure default device is reachable
     if (mAvailableOutputDevices.indexOf(mDefaultOutputDevice) < 0) {
         ALOGE("Default device %08x is unreachable", mDefaultOutputDevice->mDeviceType);
@@ -2994,7 +3056,7 @@ bool AudioPolicyManager::threadLoop()
 
                 audio_module_handle_t moduleHandle = outputDesc->mModule->mHandle;
 
-                mOutputs.removeItem(mPrimaryOutput);
+                removeOutput(mPrimaryOutput);
 
                 sp<AudioOutputDescriptor> outputDesc = new AudioOutputDescriptor(NULL);
                 outputDesc->mDevice = AUDIO_DEVICE_OUT_SPEAKER;
@@ -3057,9 +3119,20 @@ void AudioPolicyManager::addOutput(audio_io_handle_t output, sp<AudioOutputDescr
     outputDesc->mIoHandle = output;
     outputDesc->mId = nextUniqueId();
     mOutputs.add(output, outputDesc);
+    invalidateOutputCache(output, outputDesc);
     nextAudioPortGeneration();
 }
 
+void AudioPolicyManager::removeOutput(audio_io_handle_t output)
+{
+    ssize_t index = mOutputs.indexOfKey(output);
+    if (index < 0) {
+        return;
+    }
+    invalidateOutputCache(output, mOutputs.valueAt(index));
+    mOutputs.removeItemsAt(index);
+}
+
 void AudioPolicyManager::addInput(audio_io_handle_t input, sp<AudioInputDescriptor> inputDesc)
 {
     inputDesc->mIoHandle = input;
@@ -3289,7 +3362,7 @@ status_t AudioPolicyManager::checkOutputsForDevice(const sp<DeviceDescriptor> de
                             ALOGW("checkOutputsForDevice() could not open dup output for %d and %d",
                                     mPrimaryOutput, output);
                             mpClientInterface->closeOutput(output);
-                            mOutputs.removeItem(output);
+                            removeOutput(output);
                             nextAudioPortGeneration();
                             output = AUDIO_IO_HANDLE_NONE;
                         }
@@ -3590,7 +3663,7 @@ void AudioPolicyManager::closeOutput(audio_io_handle_t output)
             ALOGV("closeOutput() closing also duplicated output %d", duplicatedOutput);
 
             mpClientInterface->closeOutput(duplicatedOutput);
-            mOutputs.removeItem(duplicatedOutput);
+            removeOutput(duplicatedOutput);
         }
     }
 
@@ -3609,7 +3682,7 @@ void AudioPolicyManager::closeOutput(audio_io_handle_t output)
     mpClientInterface->setParameters(output, param.toString());
 
     mpClientInterface->closeOutput(output);
-    mOutputs.removeItem(output);
+    removeOutput(output);
     mPreviousOutputs = mOutputs;
 }
 
@@ -3744,7 +3817,10 @@ void AudioPolicyManager::checkA2dpSuspend()
 {
     audio_io_handle_t a2dpOutput = getA2dpOutput();
     if (a2dpOutput == 0) {
-        mA2dpSuspended = false;
+        if (mA2dpSuspended) {
+            mA2dpSuspended = false;
+            invalidateStrategyCache();
+        }
         return;
     }
 
@@ -3771,6 +3847,7 @@ void AudioPolicyManager::checkA2dpSuspend()
 
             mpClientInterface->restoreOutput(a2dpOutput);
             mA2dpSuspended = false;
+            invalidateStrategyCache();
         }
     } else {
         if ((isScoConnected &&
@@ -3781,6 +3858,7 @@ void AudioPolicyManager::checkA2dpSuspend()
 
             mpClientInterface->suspendOutput(a2dpOutput);
             mA2dpSuspended = true;
+            invalidateStrategyCache();
         }
     }
 }
@@ -3977,6 +4055,13 @@ audio_devices_t AudioPolicyManager::getDeviceForStrategy(routing_strategy strate
               strategy, mDeviceForStrategy[strategy]);
         return mDeviceForStrategy[strategy];
     }
+    // STRATEGY_SONIFICATION_RESPECTFUL depends on recent music activity: never memoized
+    bool memoize = mRoutingCacheEnabled && strategy < NUM_STRATEGIES &&
+            strategy != STRATEGY_SONIFICATION_RESPECTFUL;
+    if (memoize && (mStrategyCacheValid & (1 << strategy))) {
+        mStrategyCacheHits++;
+        return mStrategyCache[strategy];
+    }
     audio_devices_t availableOutputDeviceTypes = mAvailableOutputDevices.types();
     switch (strategy) {
 
@@ -4220,6 +4305,11 @@ audio_devices_t AudioPolicyManager::getDeviceForStrategy(routing_strategy strate
     }
 
     ALOGVV("getDeviceForStrategy() strategy %d, device %x", strategy, device);
+    if (memoize) {
+        mStrategyCache[strategy] = device;
+        mStrategyCacheValid |= 1 << strategy;
+        mStrategyCacheMisses++;
+    }
     return device;
 }
 
@@ -4231,6 +4321,64 @@ void AudioPolicyManager::updateDevicesAndOutputs()
     mPreviousOutputs = mOutputs;
 }
 
+void AudioPolicyManager::invalidateRoutingCache()
+{
+    invalidateStrategyCache();
+    mDirectProfileCache.clear();
+}
+
+void AudioPolicyManager::invalidateOutputCache(audio_io_handle_t output,
+                                               const sp<AudioOutputDescriptor>& outputDesc)
+{
+    // an output is a candidate for all the devices it supports, see getOutputsForDevice():
+    // other selections are not affected
+    audio_devices_t devices = outputDesc->supportedDevices();
+    for (size_t i = 0; i < mOutputCache.size(); ) {
+        const OutputCacheEntry& entry = mOutputCache[i];
+        if (((entry.mDevice & devices) == entry.mDevice) || (entry.mOutput == output)) {
+            mOutputCache.removeAt(i);
+        } else {
+            i++;
+        }
+    }
+    // getDeviceForStrategy() depends on the A2DP output and on the primary output
+    if ((output == mPrimaryOutput) || (devices & AUDIO_DEVICE_OUT_ALL_A2DP)) {
+        invalidateStrategyCache();
+    }
+}
+
+audio_io_handle_t AudioPolicyManager::getMixedOutputForDevice(audio_devices_t device,
+                                                              audio_output_flags_t flags,
+                                                              audio_format_t format)
+{
+    if (mRoutingCacheEnabled) {
+        for (size_t i = 0; i < mOutputCache.size(); i++) {
+            const OutputCacheEntry& entry = mOutputCache[i];
+            if (entry.mDevice == device && entry.mFlags == flags && entry.mFormat == format) {
+                mOutputCacheHits++;
+                return entry.mOutput;
+            }
+        }
+        mOutputCacheMisses++;
+    }
+
+    SortedVector<audio_io_handle_t> outputs = getOutputsForDevice(device, mOutputs);
+    audio_io_handle_t output = selectOutput(outputs, flags, format);
+
+    if (mRoutingCacheEnabled) {
+        if (mOutputCache.size() >= MAX_ROUTING_CACHE_ENTRIES) {
+            mOutputCache.removeAt(0);
+        }
+        OutputCacheEntry entry;
+        entry.mDevice = device;
+        entry.mFlags = flags;
+        entry.mFormat = format;
+        entry.mOutput = output;
+        mOutputCache.add(entry);
+    }
+    return output;
+}
+
 uint32_t AudioPolicyManager::checkDeviceMuteStrategies(sp<AudioOutputDescriptor> outputDesc,
                                                        audio_devices_t prevDevice,
                                                        uint32_t delayMs)
@@ -4344,6 +4492,10 @@ uint32_t AudioPolicyManager::setOutputDevice(audio_io_handle_t output,
 
     if (device != AUDIO_DEVICE_NONE) {
         outputDesc->mDevice = device;
+        // getA2dpOutput() looks for an output routed to A2DP
+        if ((device ^ prevDevice) & AUDIO_DEVICE_OUT_ALL_A2DP) {
+            invalidateStrategyCache();
+        }
     }
     muteWaitMs = checkDeviceMuteStrategies(outputDesc, prevDevice, delayMs);
 
@@ -7159,11 +7311,16 @@ void AudioPolicyManager::loadGlobalConfig(cnode *root, const sp<HwModule>& modul
     }
 }
 
-status_t AudioPolicyManager::loadAudioPolicyConfig(const char *path)
+status_t AudioPolicyManager::loadAudioPolicyConfig(const char *path, const char *cachePath)
 {
     cnode *root;
     char *data;
 
+    if (cachePath != NULL && loadAudioPolicyConfigCache(cachePath, path) == NO_ERROR) {
+        ALOGI("loadAudioPolicyConfig() loaded %s from %s\n", path, cachePath);
+        return NO_ERROR;
+    }
+
     data = (char *)load_file(path, NULL);
     if (data == NULL) {
         return -ENODEV;
@@ -7180,9 +7337,457 @@ status_t AudioPolicyManager::loadAudioPolicyConfig(const char *path)
 
     ALOGI("loadAudioPolicyConfig() loaded %s\n", path);
 
+    if (cachePath != NULL) {
+        saveAudioPolicyConfigCache(cachePath, path);
+    }
+    return NO_ERROR;
+}
+
+// --- Audio policy configuration cache
+
+// The cache is an image of the modules, devices and global configuration loaded from a
+// configuration file. It is valid as long as the size, modification time and contents of the
+// file do not change, and is read with one mmap() instead of parsing the file at each start.
+// The legacy configuration format has no include directive, so the file is the only input.
+// It is only read on the device which wrote it: values are in native byte order.
+
+static const uint32_t kConfigCacheMagic = 0x43435041; // "APCC"
+static const uint32_t kConfigCacheVersion = 2;
+// device reference for a device which is not declared by a module, followed by its type
+static const uint32_t kConfigCacheDeviceType = 0xFFFFFFFF;
+
+struct ConfigCacheHeader {
+    uint32_t mMagic;
+    uint32_t mVersion;
+    uint32_t mConfigSize;       // size of the configuration file
+    uint32_t mConfigHash;       // checksum of the contents of the configuration file
+    int64_t  mConfigTime;       // modification time of the configuration file
+    uint32_t mDataSize;         // size of the data following the header
+    uint32_t mDataChecksum;     // checksum of the data following the header
+};
+
+// FNV-1a, detects truncated or corrupted cache files
+static uint32_t configCacheChecksum(const uint8_t *data, size_t size)
+{
+    uint32_t checksum = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        checksum = (checksum ^ data[i]) * 16777619u;
+    }
+    return checksum;
+}
+
+// a file may be rewritten within the resolution of its modification time, or restored with
+// its previous time, so the contents are checked as well
+static status_t configFileHash(const char *path, uint32_t *hash)
+{
+    unsigned size;
+    void *data = load_file(path, &size);
+    if (data == NULL) {
+        return -ENODEV;
+    }
+    *hash = configCacheChecksum((const uint8_t *)data, size);
+    free(data);
     return NO_ERROR;
 }
 
+// Writes the configuration to mData, or reads it from the data given to the constructor.
+// mError is set if the configuration cannot be written or if the data is not valid.
+class AudioPolicyManager::ConfigCache
+{
+public:
+    ConfigCache() : mPos(NULL), mEnd(NULL), mError(false) {}
+    ConfigCache(const uint8_t *data, size_t size) : mPos(data), mEnd(data + size), mError(false) {}
+
+    void write(const AudioPolicyManager *manager, const char *path);
+    status_t read(AudioPolicyManager *manager, const char *path);
+
+    Vector<uint8_t> mData;
+    const uint8_t   *mPos;
+    const uint8_t   *mEnd;
+    bool            mError;
+
+private:
+    void putU32(uint32_t value);
+    void putString(const String8& value);
+    void putPort(const sp<AudioPort>& port);
+    void putDevices(const Vector < sp<HwModule> >& modules, const DeviceVector& devices);
+    void putProfiles(const Vector < sp<HwModule> >& modules,
+                     const Vector < sp<IOProfile> >& profiles);
+
+    uint32_t getU32();
+    String8 getString();
+    uint32_t getCount();
+    void getPort(const sp<AudioPort>& port);
+    void getDevices(const Vector < sp<HwModule> >& modules, DeviceVector& devices);
+    void getProfiles(const Vector < sp<HwModule> >& modules, const sp<HwModule>& module,
+                     audio_port_role_t role, Vector < sp<IOProfile> >& profiles);
+};
+
+void AudioPolicyManager::ConfigCache::putU32(uint32_t value)
+{
+    mData.appendArray((const uint8_t *)&value, sizeof(value));
+}
+
+void AudioPolicyManager::ConfigCache::putString(const String8& value)
+{
+    putU32(value.length());
+    mData.appendArray((const uint8_t *)value.string(), value.length());
+}
+
+void AudioPolicyManager::ConfigCache::putPort(const sp<AudioPort>& port)
+{
+    putU32(port->mSamplingRates.size());
+    for (size_t i = 0; i < port->mSamplingRates.size(); i++) {
+        putU32(port->mSamplingRates[i]);
+    }
+    putU32(port->mFormats.size());
+    for (size_t i = 0; i < port->mFormats.size(); i++) {
+        putU32(port->mFormats[i]);
+    }
+    putU32(port->mChannelMasks.size());
+    for (size_t i = 0; i < port->mChannelMasks.size(); i++) {
+        putU32(port->mChannelMasks[i]);
+    }
+    putU32(port->mGains.size());
+    for (size_t i = 0; i < port->mGains.size(); i++) {
+        const sp<AudioGain>& gain = port->mGains[i];
+        putU32(gain->mIndex);
+        putU32(gain->mUseInChannelMask);
+        putU32(gain->mGain.mode);
+        putU32(gain->mGain.channel_mask);
+        putU32(gain->mGain.min_value);
+        putU32(gain->mGain.max_value);
+        putU32(gain->mGain.default_value);
+        putU32(gain->mGain.step_value);
+        putU32(gain->mGain.min_ramp_ms);
+        putU32(gain->mGain.max_ramp_ms);
+    }
+    putU32(port->mFlags);
+}
+
+// devices declared by a module are written as the module index and the device name, so that
+// they are shared again with the module when read; the others are written as their type
+void AudioPolicyManager::ConfigCache::putDevices(const Vector < sp<HwModule> >& modules,
+                                                 const DeviceVector& devices)
+{
+    putU32(devices.size());
+    for (size_t i = 0; i < devices.size(); i++) {
+        const sp<DeviceDescriptor>& device = devices[i];
+        if (device->mName.isEmpty()) {
+            putU32(kConfigCacheDeviceType);
+            putU32(device->mDeviceType);
+            continue;
+        }
+        size_t j;
+        for (j = 0; j < modules.size(); j++) {
+            if (modules[j]->mDeclaredDevices.getDeviceFromName(device->mName) == device) {
+                break;
+            }
+        }
+        if (j == modules.size()) {
+            // declared by a module which failed to load
+            ALOGW("ConfigCache::putDevices() device %s not found", device->mName.string());
+            mError = true;
+            return;
+        }
+        putU32(j);
+        putString(device->mName);
+    }
+}
+
+void AudioPolicyManager::ConfigCache::putProfiles(const Vector < sp<HwModule> >& modules,
+                                                  const Vector < sp<IOProfile> >& profiles)
+{
+    putU32(profiles.size());
+    for (size_t i = 0; i < profiles.size(); i++) {
+        putString(profiles[i]->mName);
+        putPort(profiles[i]);
+        putDevices(modules, profiles[i]->mSupportedDevices);
+    }
+}
+
+void AudioPolicyManager::ConfigCache::write(const AudioPolicyManager *manager, const char *path)
+{
+    const Vector < sp<HwModule> >& modules = manager->mHwModules;
+
+    putString(String8(path));
+    putU32(modules.size());
+    for (size_t i = 0; i < modules.size(); i++) {
+        const sp<HwModule>& module = modules[i];
+        putString(String8(module->mName));
+        putU32(module->mHalVersion);
+        putU32(module->mDeclaredDevices.size());
+        for (size_t j = 0; j < module->mDeclaredDevices.size(); j++) {
+            const sp<DeviceDescriptor>& device = module->mDeclaredDevices[j];
+            putString(device->mName);
+            putU32(device->mDeviceType);
+            putString(device->mAddress);
+            putPort(device);
+        }
+        putProfiles(modules, module->mOutputProfiles);
+        putProfiles(modules, module->mInputProfiles);
+    }
+    putU32(manager->mDefaultOutputDevice->mDeviceType);
+    putU32(manager->mSpeakerDrcEnabled);
+    putDevices(modules, manager->mAvailableOutputDevices);
+    putDevices(modules, manager->mAvailableInputDevices);
+}
+
+uint32_t AudioPolicyManager::ConfigCache::getU32()
+{
+    uint32_t value = 0;
+    if (mEnd - mPos < (ssize_t)sizeof(value)) {
+        mError = true;
+        return value;
+    }
+    memcpy(&value, mPos, sizeof(value));
+    mPos += sizeof(value);
+    return value;
+}
+
+String8 AudioPolicyManager::ConfigCache::getString()
+{
+    uint32_t length = getU32();
+    if (mError || (size_t)(mEnd - mPos) < length) {
+        mError = true;
+        return String8("");
+    }
+    String8 value((const char *)mPos, length);
+    mPos += length;
+    return value;
+}
+
+// number of items to read, each one takes at least 4 bytes
+uint32_t AudioPolicyManager::ConfigCache::getCount()
+{
+    uint32_t count = getU32();
+    if (count > (size_t)(mEnd - mPos) / sizeof(uint32_t)) {
+        mError = true;
+        return 0;
+    }
+    return count;
+}
+
+void AudioPolicyManager::ConfigCache::getPort(const sp<AudioPort>& port)
+{
+    uint32_t count = getCount();
+    for (uint32_t i = 0; i < count; i++) {
+        port->mSamplingRates.add(getU32());
+    }
+    count = getCount();
+    for (uint32_t i = 0; i < count; i++) {
+        port->mFormats.add((audio_format_t)getU32());
+    }
+    count = getCount();
+    for (uint32_t i = 0; i < count; i++) {
+        port->mChannelMasks.add((audio_channel_mask_t)getU32());
+    }
+    count = getCount();
+    for (uint32_t i = 0; i < count && !mError; i++) {
+        int index = getU32();
+        bool useInChannelMask = getU32() != 0;
+        sp<AudioGain> gain = new AudioGain(index, useInChannelMask);
+        gain->mGain.mode = (audio_gain_mode_t)getU32();
+        gain->mGain.channel_mask = (audio_channel_mask_t)getU32();
+        gain->mGain.min_value = getU32();
+        gain->mGain.max_value = getU32();
+        gain->mGain.default_value = getU32();
+        gain->mGain.step_value = getU32();
+        gain->mGain.min_ramp_ms = getU32();
+        gain->mGain.max_ramp_ms = getU32();
+        port->mGains.add(gain);
+    }
+    port->mFlags = getU32();
+}
+
+void AudioPolicyManager::ConfigCache::getDevices(const Vector < sp<HwModule> >& modules,
+                                                 DeviceVector& devices)
+{
+    uint32_t count = getCount();
+    for (uint32_t i = 0; i < count && !mError; i++) {
+        uint32_t moduleIndex = getU32();
+        if (moduleIndex == kConfigCacheDeviceType) {
+            audio_devices_t type = (audio_devices_t)getU32();
+            if (!mError) {
+                devices.add(new DeviceDescriptor(String8(""), type));
+            }
+            continue;
+        }
+        String8 name = getString();
+        if (mError || moduleIndex >= modules.size()) {
+            mError = true;
+            return;
+        }
+        sp<DeviceDescriptor> device = modules[moduleIndex]->mDeclaredDevices.getDeviceFromName(name);
+        if (device == 0) {
+            mError = true;
+            return;
+        }
+        devices.add(device);
+    }
+}
+
+void AudioPolicyManager::ConfigCache::getProfiles(const Vector < sp<HwModule> >& modules,
+                                                  const sp<HwModule>& module,
+                                                  audio_port_role_t role,
+                                                  Vector < sp<IOProfile> >& profiles)
+{
+    uint32_t count = getCount();
+    for (uint32_t i = 0; i < count && !mError; i++) {
+        sp<IOProfile> profile = new IOProfile(getString(), role, module);
+        getPort(profile);
+        getDevices(modules, profile->mSupportedDevices);
+        profiles.add(profile);
+    }
+}
+
+status_t AudioPolicyManager::ConfigCache::read(AudioPolicyManager *manager, const char *path)
+{
+    if (getString() != String8(path)) {
+        return BAD_VALUE;
+    }
+
+    Vector < sp<HwModule> > modules;
+    uint32_t count = getCount();
+    for (uint32_t i = 0; i < count && !mError; i++) {
+        sp<HwModule> module = new HwModule(getString().string());
+        module->mHalVersion = getU32();
+        modules.add(module);
+        uint32_t numDevices = getCount();
+        for (uint32_t j = 0; j < numDevices && !mError; j++) {
+            String8 name = getString();
+            audio_devices_t type = (audio_devices_t)getU32();
+            sp<DeviceDescriptor> device = new DeviceDescriptor(name, type);
+            device->mModule = module;
+            device->mAddress = getString();
+            getPort(device);
+            module->mDeclaredDevices.add(device);
+        }
+        getProfiles(modules, module, AUDIO_PORT_ROLE_SOURCE, module->mOutputProfiles);
+        getProfiles(modules, module, AUDIO_PORT_ROLE_SINK, module->mInputProfiles);
+    }
+    audio_devices_t defaultOutputDevice = (audio_devices_t)getU32();
+    bool speakerDrcEnabled = getU32() != 0;
+    DeviceVector outputDevices;
+    DeviceVector inputDevices;
+    getDevices(modules, outputDevices);
+    getDevices(modules, inputDevices);
+
+    if (mError || mPos != mEnd) {
+        // profiles and declared devices refer to their module
+        for (size_t i = 0; i < modules.size(); i++) {
+            modules[i]->mOutputProfiles.clear();
+            modules[i]->mInputProfiles.clear();
+            modules[i]->mDeclaredDevices.clear();
+        }
+        return BAD_VALUE;
+    }
+
+    // the policy manager is only modified once the whole cache is read
+    for (size_t i = 0; i < modules.size(); i++) {
+        manager->mHwModules.add(modules[i]);
+    }
+    for (size_t i = 0; i < outputDevices.size(); i++) {
+        manager->mAvailableOutputDevices.add(outputDevices[i]);
+    }
+    for (size_t i = 0; i < inputDevices.size(); i++) {
+        manager->mAvailableInputDevices.add(inputDevices[i]);
+    }
+    if (defaultOutputDevice != manager->mDefaultOutputDevice->mDeviceType) {
+        manager->mDefaultOutputDevice = new DeviceDescriptor(String8(""), defaultOutputDevice);
+    }
+    manager->mSpeakerDrcEnabled = speakerDrcEnabled;
+    return NO_ERROR;
+}
+
+status_t AudioPolicyManager::loadAudioPolicyConfigCache(const char *cachePath, const char *path)
+{
+    struct stat configStat;
+    if (stat(path, &configStat) != 0) {
+        return -ENODEV;
+    }
+    int fd = open(cachePath, O_RDONLY);
+    if (fd < 0) {
+        return NAME_NOT_FOUND;
+    }
+    struct stat cacheStat;
+    if (fstat(fd, &cacheStat) != 0 || cacheStat.st_size < (off_t)sizeof(ConfigCacheHeader)) {
+        close(fd);
+        return BAD_VALUE;
+    }
+    size_t size = cacheStat.st_size;
+    void *data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return NO_MEMORY;
+    }
+
+    status_t status = BAD_VALUE;
+    uint32_t configHash;
+    const ConfigCacheHeader *header = (const ConfigCacheHeader *)data;
+    const uint8_t *cacheData = (const uint8_t *)data + sizeof(ConfigCacheHeader);
+    if (header->mMagic != kConfigCacheMagic || header->mVersion != kConfigCacheVersion) {
+        ALOGW("loadAudioPolicyConfigCache() unknown format of %s", cachePath);
+    } else if (header->mConfigSize != (uint32_t)configStat.st_size ||
+            header->mConfigTime != (int64_t)configStat.st_mtime ||
+            configFileHash(path, &configHash) != NO_ERROR ||
+            header->mConfigHash != configHash) {
+        ALOGV("loadAudioPolicyConfigCache() %s changed", path);
+    } else if (header->mDataSize != size - sizeof(ConfigCacheHeader) ||
+            header->mDataChecksum != configCacheChecksum(cacheData, header->mDataSize)) {
+        ALOGW("loadAudioPolicyConfigCache() %s is corrupted", cachePath);
+    } else {
+        ConfigCache cache(cacheData, header->mDataSize);
+        status = cache.read(this, path);
+        ALOGW_IF(status != NO_ERROR, "loadAudioPolicyConfigCache() invalid %s", cachePath);
+    }
+    munmap(data, size);
+    return status;
+}
+
+void AudioPolicyManager::saveAudioPolicyConfigCache(const char *cachePath, const char *path)
+{
+    struct stat configStat;
+    uint32_t configHash;
+    if (stat(path, &configStat) != 0 || configFileHash(path, &configHash) != NO_ERROR) {
+        return;
+    }
+    ConfigCache cache;
+    cache.write(this, path);
+    if (cache.mError) {
+        ALOGW("saveAudioPolicyConfigCache() cannot cache %s", path);
+        return;
+    }
+
+    ConfigCacheHeader header;
+    header.mMagic = kConfigCacheMagic;
+    header.mVersion = kConfigCacheVersion;
+    header.mConfigSize = configStat.st_size;
+    header.mConfigHash = configHash;
+    header.mConfigTime = configStat.st_mtime;
+    header.mDataSize = cache.mData.size();
+    header.mDataChecksum = configCacheChecksum(cache.mData.array(), cache.mData.size());
+
+    // a partially written cache is never visible under cachePath
+    String8 tmpPath(cachePath);
+    tmpPath.append(".tmp");
+    int fd = open(tmpPath.string(), O_WRONLY | O_CREAT | O_TRUNC, 0640);
+    if (fd < 0) {
+        ALOGW("saveAudioPolicyConfigCache() cannot create %s: %s", tmpPath.string(),
+              strerror(errno));
+        return;
+    }
+    bool written = (write(fd, &header, sizeof(header)) == (ssize_t)sizeof(header)) &&
+            (write(fd, cache.mData.array(), cache.mData.size()) == (ssize_t)cache.mData.size());
+    close(fd);
+    if (!written || rename(tmpPath.string(), cachePath) != 0) {
+        ALOGW("saveAudioPolicyConfigCache() cannot write %s: %s", cachePath, strerror(errno));
+        unlink(tmpPath.string());
+        return;
+    }
+    ALOGV("saveAudioPolicyConfigCache() saved %s to %s", path, cachePath);
+}
+
 void AudioPolicyManager::defaultAudioPolicyConfig(void)
 {
     sp<HwModule> module;
@@ -544,6 +544,7 @@ protected:
         };
 
         void addOutput(audio_io_handle_t output, sp<AudioOutputDescriptor> outputDesc);
+        void removeOutput(audio_io_handle_t output);
         void addInput(audio_io_handle_t input, sp<AudioInputDescriptor> inputDesc);
 
         // return the strategy corresponding to a given stream type
@@ -680,6 +681,26 @@ protected:
          // Must be called after checkOutputForAllStrategies()
         void updateDevicesAndOutputs();
 
+        // routing cache: getDeviceForStrategy() results (fromCache false) are memoized per
+        // strategy, the output selected for a mixed output request per device, flags and format,
+        // and the direct output profiles per request parameters. The caches are invalidated
+        // where the state they depend on changes, see the methods below.
+
+        // must be called every time the policy state used by getDeviceForStrategy() changes:
+        // phone state, force use, A2DP suspend, A2DP or primary output...
+        void invalidateStrategyCache() { mStrategyCacheValid = 0; }
+        // same as invalidateStrategyCache() for a change of the available devices, also
+        // drops the direct output profiles selected for the previous devices
+        void invalidateRoutingCache();
+        // drops the cached output selections that the output given, being opened or closed,
+        // can change
+        void invalidateOutputCache(audio_io_handle_t output,
+                                   const sp<AudioOutputDescriptor>& outputDesc);
+        // selects an output among the mixed outputs reaching device, from the cache if possible
+        audio_io_handle_t getMixedOutputForDevice(audio_devices_t device,
+                                                  audio_output_flags_t flags,
+                                                  audio_format_t format);
+
         // selects the most appropriate device on input for current state
         audio_devices_t getNewInputDevice(audio_io_handle_t input);
 
@@ -760,7 +781,12 @@ protected:
         void loadHwModule(cnode *root);
         void loadHwModules(cnode *root);
         void loadGlobalConfig(cnode *root, const sp<HwModule>& module);
-        status_t loadAudioPolicyConfig(const char *path);
+        // cachePath is the binary cache of the configuration, or NULL to always parse path
+        status_t loadAudioPolicyConfig(const char *path, const char *cachePath);
+        class ConfigCache;
+        friend class ConfigCache;
+        status_t loadAudioPolicyConfigCache(const char *cachePath, const char *path);
+        void saveAudioPolicyConfigCache(const char *cachePath, const char *path);
         void defaultAudioPolicyConfig(void);
 
 
@@ -799,6 +825,36 @@ protected:
         volatile int32_t mNextUniqueId;
         volatile int32_t mAudioPortGeneration;
 
+        // an output selected by getMixedOutputForDevice()
+        struct OutputCacheEntry {
+            audio_devices_t mDevice;
+            audio_output_flags_t mFlags;
+            audio_format_t mFormat;
+            audio_io_handle_t mOutput;
+        };
+        // a profile, or none, returned by getProfileForDirectOutput()
+        struct DirectProfileCacheEntry {
+            audio_devices_t mDevice;
+            uint32_t mSamplingRate;
+            audio_format_t mFormat;
+            audio_channel_mask_t mChannelMask;
+            audio_output_flags_t mFlags;
+            sp<IOProfile> mProfile;
+        };
+        // maximum number of entries of each of mOutputCache and mDirectProfileCache
+        static const size_t MAX_ROUTING_CACHE_ENTRIES = 32;
+        bool mRoutingCacheEnabled;    // false to always evaluate the routing, for tests
+        audio_devices_t mStrategyCache[NUM_STRATEGIES]; // memoized getDeviceForStrategy() result
+        uint32_t mStrategyCacheValid; // bit i set if mStrategyCache[i] is valid
+        Vector<OutputCacheEntry> mOutputCache;
+        Vector<DirectProfileCacheEntry> mDirectProfileCache;
+        uint32_t mStrategyCacheHits;
+        uint32_t mStrategyCacheMisses;
+        uint32_t mOutputCacheHits;
+        uint32_t mOutputCacheMisses;
+        uint32_t mDirectProfileCacheHits;
+        uint32_t mDirectProfileCacheMisses;
+
         DefaultKeyedVector<audio_patch_handle_t, sp<AudioPatch> > mAudioPatches;
 
         DefaultKeyedVector<audio_session_t, audio_io_handle_t> mSoundTriggerSessions;
@@ -27,6 +27,8 @@
 
 #define AUDIO_POLICY_CONFIG_FILE "/system/etc/audio_policy.conf"
 #define AUDIO_POLICY_VENDOR_CONFIG_FILE "/vendor/etc/audio_policy.conf"
+// binary image of the last configuration file loaded, rebuilt when the file changes
+#define AUDIO_POLICY_CONFIG_CACHE_FILE "/data/misc/audio/audio_policy.conf.cache"
 
 // global configuration
 #define GLOBAL_CONFIG_TAG "global_configuration"
@@ -0,0 +1,51 @@
+# Build the tests for the audio policy manager
+
+LOCAL_PATH:= $(call my-dir)
+
+#
+# routing cache test and benchmark
+#
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	test-policy-routing.cpp
+
+LOCAL_C_INCLUDES := \
+	frameworks/av/services/audiopolicy
+
+LOCAL_SHARED_LIBRARIES := \
+	libaudiopolicymanagerdefault \
+	libmedia \
+	libcutils \
+	libutils \
+	liblog
+
+LOCAL_MODULE:= test-policy-routing
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
+
+#
+# configuration cache test and benchmark
+#
+include $(CLEAR_VARS)
+
+LOCAL_SRC_FILES:= \
+	test-policy-config.cpp
+
+LOCAL_C_INCLUDES := \
+	frameworks/av/services/audiopolicy
+
+LOCAL_SHARED_LIBRARIES := \
+	libaudiopolicymanagerdefault \
+	libmedia \
+	libcutils \
+	libutils \
+	liblog
+
+LOCAL_MODULE:= test-policy-config
+
+LOCAL_MODULE_TAGS := optional
+
+include $(BUILD_EXECUTABLE)
@@ -0,0 +1,340 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include <utils/SortedVector.h>
+#include <utils/String8.h>
+#include "AudioPolicyManager.h"
+#include "audio_policy_conf.h"
+#include "test_policy_client.h"
+
+using namespace android;
+
+/* Loads the audio policy configuration file repeatedly, by parsing the text file and from the
+ * binary cache written after the first parse, and reports the time taken by each load.
+ * Both loads must give the same modules, profiles and devices, a corrupted cache must be
+ * rejected and a cache must not be used once its configuration file changed, even if its size
+ * and modification time did not, otherwise the test fails.
+ */
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s [-n loads] [-c cache] [config]\n", name);
+    fprintf(stderr, "    -n    number of loads measured (default 200)\n");
+    fprintf(stderr, "    -c    cache file written by the test "
+            "(default /data/local/tmp/audio_policy.conf.cache)\n");
+    fprintf(stderr, "    config defaults to %s, or to %s if it does not exist\n",
+            AUDIO_POLICY_VENDOR_CONFIG_FILE, AUDIO_POLICY_CONFIG_FILE);
+}
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static bool copyFile(const char *src, const char *dst) {
+    FILE *in = fopen(src, "r");
+    FILE *out = fopen(dst, "w");
+    bool ok = in != NULL && out != NULL;
+    char buffer[4096];
+    size_t n;
+    while (ok && (n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        ok = fwrite(buffer, 1, n, out) == n;
+    }
+    if (in != NULL) {
+        fclose(in);
+    }
+    if (out != NULL) {
+        ok = (fclose(out) == 0) && ok;
+    }
+    return ok;
+}
+
+// Loads the configuration in place of the one loaded by the constructor, and describes it
+class TestPolicyManager : public AudioPolicyManager {
+public:
+    TestPolicyManager(AudioPolicyClientInterface *client) : AudioPolicyManager(client) {}
+
+    status_t loadText(const char *path) {
+        resetConfig();
+        return loadAudioPolicyConfig(path, NULL);
+    }
+
+    // parses the file and writes the cache if the cache is not valid
+    status_t load(const char *path, const char *cachePath) {
+        resetConfig();
+        return loadAudioPolicyConfig(path, cachePath);
+    }
+
+    status_t loadCache(const char *path, const char *cachePath) {
+        resetConfig();
+        return loadAudioPolicyConfigCache(cachePath, path);
+    }
+
+    // device vectors are sorted by address, so the devices are described in name order
+    String8 describeConfig() {
+        String8 result;
+        for (size_t i = 0; i < mHwModules.size(); i++) {
+            const sp<HwModule>& module = mHwModules[i];
+            result.appendFormat("module %s version %04x\n", module->mName, module->mHalVersion);
+            result.append(describeDevices(module->mDeclaredDevices));
+            for (size_t j = 0; j < module->mOutputProfiles.size(); j++) {
+                result.append(describeProfile("output", module->mOutputProfiles[j]));
+            }
+            for (size_t j = 0; j < module->mInputProfiles.size(); j++) {
+                result.append(describeProfile("input", module->mInputProfiles[j]));
+            }
+        }
+        result.appendFormat("default output device %08x speaker drc %d\n",
+                            mDefaultOutputDevice->mDeviceType, mSpeakerDrcEnabled);
+        result.append("attached outputs\n");
+        result.append(describeDevices(mAvailableOutputDevices));
+        result.append("attached inputs\n");
+        result.append(describeDevices(mAvailableInputDevices));
+        return result;
+    }
+
+private:
+    void resetConfig() {
+        for (size_t i = 0; i < mHwModules.size(); i++) {
+            // profiles and declared devices refer to their module
+            mHwModules[i]->mOutputProfiles.clear();
+            mHwModules[i]->mInputProfiles.clear();
+            mHwModules[i]->mDeclaredDevices.clear();
+        }
+        mHwModules.clear();
+        mAvailableOutputDevices.clear();
+        mAvailableInputDevices.clear();
+        mDefaultOutputDevice = new DeviceDescriptor(String8(""), AUDIO_DEVICE_OUT_SPEAKER);
+        mSpeakerDrcEnabled = false;
+    }
+
+    static String8 describePort(const sp<AudioPort>& port) {
+        String8 result;
+        result.appendFormat(" flags %08x rates", port->mFlags);
+        for (size_t i = 0; i < port->mSamplingRates.size(); i++) {
+            result.appendFormat(" %u", port->mSamplingRates[i]);
+        }
+        result.append(" formats");
+        for (size_t i = 0; i < port->mFormats.size(); i++) {
+            result.appendFormat(" %08x", port->mFormats[i]);
+        }
+        result.append(" masks");
+        for (size_t i = 0; i < port->mChannelMasks.size(); i++) {
+            result.appendFormat(" %08x", port->mChannelMasks[i]);
+        }
+        for (size_t i = 0; i < port->mGains.size(); i++) {
+            const sp<AudioGain>& gain = port->mGains[i];
+            result.appendFormat(" gain %d %d %08x %08x %d %d %d %d %u %u", gain->mIndex,
+                    gain->mUseInChannelMask, gain->mGain.mode, gain->mGain.channel_mask,
+                    gain->mGain.min_value, gain->mGain.max_value, gain->mGain.default_value,
+                    gain->mGain.step_value, gain->mGain.min_ramp_ms, gain->mGain.max_ramp_ms);
+        }
+        return result;
+    }
+
+    // a declared device must be the one of its module, not a copy
+    static String8 describeDevices(const DeviceVector& devices) {
+        SortedVector<String8> lines;
+        for (size_t i = 0; i < devices.size(); i++) {
+            const sp<DeviceDescriptor>& device = devices[i];
+            bool declared = device->mModule != 0 &&
+                    device->mModule->mDeclaredDevices.getDeviceFromName(device->mName) == device;
+            String8 line;
+            line.appendFormat("  device %s type %08x address %s module %s%s",
+                    device->mName.string(), device->mDeviceType, device->mAddress.string(),
+                    device->mModule != 0 ? device->mModule->mName : "-",
+                    declared ? " declared" : "");
+            line.append(describePort(device));
+            line.append("\n");
+            lines.add(line);
+        }
+        String8 result;
+        for (size_t i = 0; i < lines.size(); i++) {
+            result.append(lines[i]);
+        }
+        return result;
+    }
+
+    static String8 describeProfile(const char *role, const sp<IOProfile>& profile) {
+        String8 result;
+        result.appendFormat("%s %s module %s", role, profile->mName.string(),
+                            profile->mModule != 0 ? profile->mModule->mName : "-");
+        result.append(describePort(profile));
+        result.append("\n");
+        result.append(describeDevices(profile->mSupportedDevices));
+        return result;
+    }
+};
+
+int main(int argc, char **argv) {
+    int numLoads = 200;
+    const char *cachePath = "/data/local/tmp/audio_policy.conf.cache";
+    int ch;
+    while ((ch = getopt(argc, argv, "n:c:")) != -1) {
+        switch (ch) {
+        case 'n':
+            numLoads = atoi(optarg);
+            break;
+        case 'c':
+            cachePath = optarg;
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (numLoads <= 0 || optind < argc - 1) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *path = optind < argc ? argv[optind] :
+            access(AUDIO_POLICY_VENDOR_CONFIG_FILE, R_OK) == 0 ?
+                    AUDIO_POLICY_VENDOR_CONFIG_FILE : AUDIO_POLICY_CONFIG_FILE;
+
+    TestClient client;
+    TestPolicyManager manager(&client);
+    int failures = 0;
+
+    // text parsing, the reference configuration
+    int64_t textNs = 0;
+    for (int i = 0; i < numLoads; i++) {
+        int64_t startNs = nowNs();
+        status_t status = manager.loadText(path);
+        textNs += nowNs() - startNs;
+        if (status != NO_ERROR) {
+            fprintf(stderr, "cannot load %s: %d\n", path, status);
+            return EXIT_FAILURE;
+        }
+    }
+    String8 config = manager.describeConfig();
+
+    // the first start parses the file and writes the cache
+    unlink(cachePath);
+    int64_t startNs = nowNs();
+    manager.load(path, cachePath);
+    int64_t firstNs = nowNs() - startNs;
+    if (access(cachePath, R_OK) != 0) {
+        fprintf(stderr, "%s not written\n", cachePath);
+        return EXIT_FAILURE;
+    }
+
+    // the next starts map the cache
+    int64_t cacheNs = 0;
+    for (int i = 0; i < numLoads; i++) {
+        startNs = nowNs();
+        status_t status = manager.loadCache(path, cachePath);
+        cacheNs += nowNs() - startNs;
+        if (status != NO_ERROR) {
+            fprintf(stderr, "cannot load %s: %d\n", cachePath, status);
+            return EXIT_FAILURE;
+        }
+    }
+    if (manager.describeConfig() != config) {
+        fprintf(stderr, "configuration loaded from %s differs from %s:\n%s\n----\n%s\n",
+                cachePath, path, manager.describeConfig().string(), config.string());
+        failures++;
+    }
+
+    // a corrupted cache is rejected, and replaced by the next start
+    struct stat cacheStat;
+    int fd = open(cachePath, O_RDWR);
+    uint8_t byte = 0;
+    if (fd < 0 || fstat(fd, &cacheStat) != 0 ||
+            pread(fd, &byte, 1, cacheStat.st_size - 1) != 1) {
+        fprintf(stderr, "cannot read %s\n", cachePath);
+        return EXIT_FAILURE;
+    }
+    byte ^= 0x01;
+    if (pwrite(fd, &byte, 1, cacheStat.st_size - 1) != 1) {
+        fprintf(stderr, "cannot write %s\n", cachePath);
+        return EXIT_FAILURE;
+    }
+    close(fd);
+    if (manager.loadCache(path, cachePath) == NO_ERROR) {
+        fprintf(stderr, "corrupted %s accepted\n", cachePath);
+        failures++;
+    }
+    manager.load(path, cachePath);
+    if (manager.describeConfig() != config || manager.loadCache(path, cachePath) != NO_ERROR) {
+        fprintf(stderr, "corrupted %s not replaced\n", cachePath);
+        failures++;
+    }
+
+    // a cache is not used once its configuration file changed
+    String8 copyPath(cachePath);
+    copyPath.append(".conf");
+    FILE *copy = NULL;
+    if (!copyFile(path, copyPath.string()) ||
+            manager.load(copyPath.string(), cachePath) != NO_ERROR ||
+            manager.loadCache(copyPath.string(), cachePath) != NO_ERROR ||
+            (copy = fopen(copyPath.string(), "a")) == NULL) {
+        fprintf(stderr, "cannot load a copy of %s\n", path);
+        failures++;
+    } else {
+        fprintf(copy, "\n# changed by test-policy-config\n");
+        fclose(copy);
+        if (manager.loadCache(copyPath.string(), cachePath) == NO_ERROR) {
+            fprintf(stderr, "cache of modified %s accepted\n", copyPath.string());
+            failures++;
+        }
+    }
+
+    // nor once its contents changed with the same size and modification time
+    struct stat copyStat;
+    fd = -1;
+    if (manager.load(copyPath.string(), cachePath) != NO_ERROR ||
+            manager.loadCache(copyPath.string(), cachePath) != NO_ERROR ||
+            stat(copyPath.string(), &copyStat) != 0 ||
+            (fd = open(copyPath.string(), O_RDWR)) < 0 ||
+            pread(fd, &byte, 1, copyStat.st_size - 2) != 1) {
+        fprintf(stderr, "cannot load a copy of %s\n", path);
+        failures++;
+    } else {
+        // in the comment appended above
+        byte ^= 0x01;
+        struct timespec times[2] = { copyStat.st_atim, copyStat.st_mtim };
+        if (pwrite(fd, &byte, 1, copyStat.st_size - 2) != 1 ||
+                futimens(fd, times) != 0) {
+            fprintf(stderr, "cannot modify %s\n", copyPath.string());
+            failures++;
+        } else if (manager.loadCache(copyPath.string(), cachePath) == NO_ERROR) {
+            fprintf(stderr, "cache of %s modified in place accepted\n", copyPath.string());
+            failures++;
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    unlink(copyPath.string());
+    unlink(cachePath);
+
+    printf("%s, cache %lld bytes\n", path, (long long)cacheStat.st_size);
+    printf("%-20s %10s\n", "load", "us");
+    printf("%-20s %10.1f\n", "text", textNs / 1000.0 / numLoads);
+    printf("%-20s %10.1f\n", "first start", firstNs / 1000.0);
+    printf("%-20s %10.1f\n", "cache", cacheNs / 1000.0 / numLoads);
+    printf("startup speedup %.2f\n", (double)textNs / cacheNs);
+
+    printf("%s\n", failures == 0 ? "PASS" : "FAIL");
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
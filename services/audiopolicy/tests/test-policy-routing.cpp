@@ -0,0 +1,267 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <utils/String8.h>
+#include "AudioPolicyManager.h"
+#include "test_policy_client.h"
+
+using namespace android;
+
+/* Replays AudioTrack creations and device connection changes on two AudioPolicyManager
+ * instances loaded with the device audio policy configuration, one with the routing cache
+ * (audio.policy.routing_cache) and one without, and reports the latency of
+ * getOutputForAttr() and of the device changes. The audio HAL is replaced by a client which
+ * accepts all requests, so that only the policy decisions are measured.
+ * Both instances must take the same decisions, otherwise the test fails.
+ */
+
+static void usage(const char *name) {
+    fprintf(stderr, "Usage: %s [-n tracks] [-c tracks-per-change] [-s seed]\n", name);
+    fprintf(stderr, "    -n    number of track creations (default 20000)\n");
+    fprintf(stderr, "    -c    track creations between two device or policy changes "
+            "(default 20)\n");
+    fprintf(stderr, "    -s    seed of the replayed sequence (default 1)\n");
+}
+
+static int64_t nowNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Gives access to the routing cache switch and to the device selected for each strategy
+class TestPolicyManager : public AudioPolicyManager {
+public:
+    TestPolicyManager(AudioPolicyClientInterface *client, bool routingCache)
+        : AudioPolicyManager(client) {
+        mRoutingCacheEnabled = routingCache;
+    }
+
+    audio_devices_t deviceForStrategy(int strategy) {
+        return getDeviceForStrategy((routing_strategy)strategy, false /*fromCache*/);
+    }
+
+    void printCacheStats() {
+        printf("strategy hits %u misses %u, output hits %u misses %u, "
+               "direct profile hits %u misses %u\n",
+               mStrategyCacheHits, mStrategyCacheMisses, mOutputCacheHits, mOutputCacheMisses,
+               mDirectProfileCacheHits, mDirectProfileCacheMisses);
+    }
+
+    static const int kNumStrategies = NUM_STRATEGIES;
+};
+
+struct TrackRequest {
+    audio_usage_t usage;
+    audio_content_type_t contentType;
+    uint32_t samplingRate;
+    audio_format_t format;
+    audio_channel_mask_t channelMask;
+    audio_output_flags_t flags;
+};
+
+static const TrackRequest kTracks[] = {
+    { AUDIO_USAGE_MEDIA, AUDIO_CONTENT_TYPE_MUSIC, 44100, AUDIO_FORMAT_PCM_16_BIT,
+      AUDIO_CHANNEL_OUT_STEREO, AUDIO_OUTPUT_FLAG_NONE },
+    { AUDIO_USAGE_MEDIA, AUDIO_CONTENT_TYPE_MOVIE, 48000, AUDIO_FORMAT_PCM_16_BIT,
+      AUDIO_CHANNEL_OUT_5POINT1, AUDIO_OUTPUT_FLAG_NONE },
+    { AUDIO_USAGE_MEDIA, AUDIO_CONTENT_TYPE_MOVIE, 48000, AUDIO_FORMAT_AC3,
+      AUDIO_CHANNEL_OUT_5POINT1, AUDIO_OUTPUT_FLAG_DIRECT },
+    { AUDIO_USAGE_GAME, AUDIO_CONTENT_TYPE_SONIFICATION, 48000, AUDIO_FORMAT_PCM_16_BIT,
+      AUDIO_CHANNEL_OUT_STEREO, AUDIO_OUTPUT_FLAG_FAST },
+    { AUDIO_USAGE_NOTIFICATION, AUDIO_CONTENT_TYPE_SONIFICATION, 44100,
+      AUDIO_FORMAT_PCM_16_BIT, AUDIO_CHANNEL_OUT_STEREO, AUDIO_OUTPUT_FLAG_NONE },
+    { AUDIO_USAGE_NOTIFICATION_TELEPHONY_RINGTONE, AUDIO_CONTENT_TYPE_SONIFICATION, 44100,
+      AUDIO_FORMAT_PCM_16_BIT, AUDIO_CHANNEL_OUT_STEREO, AUDIO_OUTPUT_FLAG_NONE },
+    { AUDIO_USAGE_ALARM, AUDIO_CONTENT_TYPE_SONIFICATION, 44100, AUDIO_FORMAT_PCM_16_BIT,
+      AUDIO_CHANNEL_OUT_STEREO, AUDIO_OUTPUT_FLAG_NONE },
+    { AUDIO_USAGE_VOICE_COMMUNICATION, AUDIO_CONTENT_TYPE_SPEECH, 16000,
+      AUDIO_FORMAT_PCM_16_BIT, AUDIO_CHANNEL_OUT_MONO, AUDIO_OUTPUT_FLAG_NONE },
+    { AUDIO_USAGE_ASSISTANCE_SONIFICATION, AUDIO_CONTENT_TYPE_SONIFICATION, 48000,
+      AUDIO_FORMAT_PCM_16_BIT, AUDIO_CHANNEL_OUT_STEREO, AUDIO_OUTPUT_FLAG_FAST },
+    { AUDIO_USAGE_ASSISTANCE_NAVIGATION_GUIDANCE, AUDIO_CONTENT_TYPE_SPEECH, 22050,
+      AUDIO_FORMAT_PCM_16_BIT, AUDIO_CHANNEL_OUT_MONO, AUDIO_OUTPUT_FLAG_NONE },
+};
+
+// devices connected and disconnected during the replay
+struct DeviceChange {
+    audio_devices_t device;
+    const char *address;
+};
+
+static const DeviceChange kDevices[] = {
+    { AUDIO_DEVICE_OUT_WIRED_HEADSET, "" },
+    { AUDIO_DEVICE_OUT_BLUETOOTH_A2DP, "00:11:22:33:44:55" },
+    { AUDIO_DEVICE_OUT_BLUETOOTH_SCO_HEADSET, "00:11:22:33:44:66" },
+    { AUDIO_DEVICE_IN_BLUETOOTH_SCO_HEADSET, "00:11:22:33:44:66" },
+    { AUDIO_DEVICE_OUT_USB_DEVICE, "card=1;device=0" },
+    { AUDIO_DEVICE_OUT_AUX_DIGITAL, "" },
+    { AUDIO_DEVICE_IN_WIRED_HEADSET, "" },
+};
+
+static const size_t kNumTracks = sizeof(kTracks) / sizeof(kTracks[0]);
+static const size_t kNumDevices = sizeof(kDevices) / sizeof(kDevices[0]);
+
+struct Latency {
+    Latency() : count(0), totalNs(0), maxNs(0) {}
+    void add(int64_t ns) {
+        count++;
+        totalNs += ns;
+        if (ns > maxNs) {
+            maxNs = ns;
+        }
+    }
+    int count;
+    int64_t totalNs;
+    int64_t maxNs;
+};
+
+struct Instance {
+    Instance(bool routingCache) : manager(&client, routingCache) {}
+    TestClient client;
+    TestPolicyManager manager;
+    Latency tracks;
+    Latency changes;
+};
+
+int main(int argc, char **argv) {
+    int numTracks = 20000;
+    int tracksPerChange = 20;
+    unsigned seed = 1;
+    int ch;
+    while ((ch = getopt(argc, argv, "n:c:s:")) != -1) {
+        switch (ch) {
+        case 'n':
+            numTracks = atoi(optarg);
+            break;
+        case 'c':
+            tracksPerChange = atoi(optarg);
+            break;
+        case 's':
+            seed = atoi(optarg);
+            break;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (numTracks <= 0 || tracksPerChange <= 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // [0] evaluates the routing for each request, [1] uses the routing cache
+    Instance *instances[2] = { new Instance(false), new Instance(true) };
+    bool connected[kNumDevices];
+    memset(connected, 0, sizeof(connected));
+    int mismatches = 0;
+
+    srand(seed);
+    for (int i = 0; i < numTracks; i++) {
+        if (i % tracksPerChange == 0) {
+            // a device connection change, or sometimes a phone state or force use change
+            int event = rand() % (kNumDevices + 2);
+            status_t status[2] = { NO_ERROR, NO_ERROR };
+            for (int j = 0; j < 2; j++) {
+                TestPolicyManager& manager = instances[j]->manager;
+                int64_t startNs = nowNs();
+                if (event < (int)kNumDevices) {
+                    // fails for the devices the configuration does not declare
+                    status[j] = manager.setDeviceConnectionState(kDevices[event].device,
+                            connected[event] ? AUDIO_POLICY_DEVICE_STATE_UNAVAILABLE :
+                                               AUDIO_POLICY_DEVICE_STATE_AVAILABLE,
+                            kDevices[event].address);
+                } else if (event == (int)kNumDevices) {
+                    manager.setPhoneState(
+                            (i / tracksPerChange) % 4 == 0 ? AUDIO_MODE_IN_COMMUNICATION :
+                                                             AUDIO_MODE_NORMAL);
+                } else {
+                    manager.setForceUse(AUDIO_POLICY_FORCE_FOR_MEDIA,
+                            manager.getForceUse(AUDIO_POLICY_FORCE_FOR_MEDIA) ==
+                                    AUDIO_POLICY_FORCE_NONE ?
+                                    AUDIO_POLICY_FORCE_NO_BT_A2DP : AUDIO_POLICY_FORCE_NONE);
+                }
+                instances[j]->changes.add(nowNs() - startNs);
+            }
+            if (status[0] != status[1]) {
+                fprintf(stderr, "track %d: device %#x change status %d, %d with routing cache\n",
+                        i, kDevices[event].device, status[0], status[1]);
+                mismatches++;
+            }
+            if (event < (int)kNumDevices && status[0] == NO_ERROR) {
+                connected[event] = !connected[event];
+            }
+            for (int s = 0; s < TestPolicyManager::kNumStrategies; s++) {
+                audio_devices_t device0 = instances[0]->manager.deviceForStrategy(s);
+                audio_devices_t device1 = instances[1]->manager.deviceForStrategy(s);
+                if (device0 != device1) {
+                    fprintf(stderr, "track %d: strategy %d device %#x, %#x with routing cache\n",
+                            i, s, device0, device1);
+                    mismatches++;
+                }
+            }
+        }
+
+        const TrackRequest& track = kTracks[rand() % kNumTracks];
+        audio_attributes_t attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.usage = track.usage;
+        attr.content_type = track.contentType;
+        audio_io_handle_t outputs[2];
+        for (int j = 0; j < 2; j++) {
+            TestPolicyManager& manager = instances[j]->manager;
+            int64_t startNs = nowNs();
+            outputs[j] = manager.getOutputForAttr(&attr, track.samplingRate, track.format,
+                    track.channelMask, track.flags, NULL /*offloadInfo*/);
+            instances[j]->tracks.add(nowNs() - startNs);
+            if (outputs[j] != AUDIO_IO_HANDLE_NONE) {
+                // closes the direct outputs, like the AudioTrack destruction
+                manager.releaseOutput(outputs[j]);
+            }
+        }
+        if (outputs[0] != outputs[1]) {
+            fprintf(stderr, "track %d: usage %d output %d, %d with routing cache\n",
+                    i, track.usage, outputs[0], outputs[1]);
+            mismatches++;
+        }
+    }
+
+    printf("%-14s %10s %10s %10s %10s\n", "routing cache", "track us", "max us", "change us",
+           "max us");
+    for (int j = 0; j < 2; j++) {
+        const Instance *instance = instances[j];
+        printf("%-14s %10.2f %10.2f %10.2f %10.2f\n", j ? "on" : "off",
+               instance->tracks.totalNs / 1000.0 / instance->tracks.count,
+               instance->tracks.maxNs / 1000.0,
+               instance->changes.totalNs / 1000.0 / instance->changes.count,
+               instance->changes.maxNs / 1000.0);
+    }
+    printf("track creation speedup %.2f, device change speedup %.2f\n",
+           (double)instances[0]->tracks.totalNs / instances[1]->tracks.totalNs,
+           (double)instances[0]->changes.totalNs / instances[1]->changes.totalNs);
+    instances[1]->manager.printCacheStats();
+
+    delete instances[1];
+    delete instances[0];
+
+    printf("%s\n", mismatches == 0 ? "PASS" : "FAIL");
+    return mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
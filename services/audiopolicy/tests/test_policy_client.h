@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2014 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ANDROID_AUDIO_TEST_POLICY_CLIENT_H
+#define ANDROID_AUDIO_TEST_POLICY_CLIENT_H
+
+#include <utils/String8.h>
+#include "AudioPolicyInterface.h"
+
+namespace android {
+
+// A client which opens every output and input as requested, with unique handles
+class TestClient : public AudioPolicyClientInterface {
+public:
+    TestClient() : mNextHandle(1) {}
+    virtual ~TestClient() {}
+
+    virtual audio_module_handle_t loadHwModule(const char *name __unused) {
+        return mNextHandle++;
+    }
+
+    virtual status_t openOutput(audio_module_handle_t module __unused,
+                                audio_io_handle_t *output,
+                                audio_config_t *config,
+                                audio_devices_t *devices __unused,
+                                const String8& address __unused,
+                                uint32_t *latencyMs,
+                                audio_output_flags_t flags __unused) {
+        fillConfig(config, AUDIO_CHANNEL_OUT_STEREO);
+        *output = mNextHandle++;
+        *latencyMs = 20;
+        return NO_ERROR;
+    }
+    virtual audio_io_handle_t openDuplicateOutput(audio_io_handle_t output1 __unused,
+                                                  audio_io_handle_t output2 __unused) {
+        return mNextHandle++;
+    }
+    virtual status_t closeOutput(audio_io_handle_t output __unused) { return NO_ERROR; }
+    virtual status_t suspendOutput(audio_io_handle_t output __unused) { return NO_ERROR; }
+    virtual status_t restoreOutput(audio_io_handle_t output __unused) { return NO_ERROR; }
+
+    virtual status_t openInput(audio_module_handle_t module __unused,
+                               audio_io_handle_t *input,
+                               audio_config_t *config,
+                               audio_devices_t *device __unused,
+                               const String8& address __unused,
+                               audio_source_t source __unused,
+                               audio_input_flags_t flags __unused) {
+        fillConfig(config, AUDIO_CHANNEL_IN_MONO);
+        *input = mNextHandle++;
+        return NO_ERROR;
+    }
+    virtual status_t closeInput(audio_io_handle_t input __unused) { return NO_ERROR; }
+
+    virtual status_t setStreamVolume(audio_stream_type_t stream __unused, float volume __unused,
+                                     audio_io_handle_t output __unused,
+                                     int delayMs __unused) {
+        return NO_ERROR;
+    }
+    virtual status_t invalidateStream(audio_stream_type_t stream __unused) { return NO_ERROR; }
+    virtual void setParameters(audio_io_handle_t ioHandle __unused,
+                               const String8& keyValuePairs __unused, int delayMs __unused) {}
+    virtual String8 getParameters(audio_io_handle_t ioHandle __unused,
+                                  const String8& keys __unused) {
+        return String8("");
+    }
+    virtual status_t startTone(audio_policy_tone_t tone __unused,
+                               audio_stream_type_t stream __unused) {
+        return NO_ERROR;
+    }
+    virtual status_t stopTone() { return NO_ERROR; }
+    virtual status_t setVoiceVolume(float volume __unused, int delayMs __unused) {
+        return NO_ERROR;
+    }
+    virtual status_t moveEffects(int session __unused, audio_io_handle_t srcOutput __unused,
+                                 audio_io_handle_t dstOutput __unused) {
+        return NO_ERROR;
+    }
+    virtual status_t createAudioPatch(const struct audio_patch *patch __unused,
+                                      audio_patch_handle_t *handle,
+                                      int delayMs __unused) {
+        if (*handle == AUDIO_PATCH_HANDLE_NONE) {
+            *handle = mNextHandle++;
+        }
+        return NO_ERROR;
+    }
+    virtual status_t releaseAudioPatch(audio_patch_handle_t handle __unused,
+                                       int delayMs __unused) {
+        return NO_ERROR;
+    }
+    virtual status_t setAudioPortConfig(const struct audio_port_config *config __unused,
+                                        int delayMs __unused) {
+        return NO_ERROR;
+    }
+    virtual void onAudioPortListUpdate() {}
+    virtual void onAudioPatchListUpdate() {}
+    virtual audio_unique_id_t newAudioUniqueId() { return mNextHandle++; }
+
+private:
+    static void fillConfig(audio_config_t *config, audio_channel_mask_t defaultMask) {
+        if (config->sample_rate == 0) {
+            config->sample_rate = 48000;
+        }
+        if (config->format == AUDIO_FORMAT_DEFAULT) {
+            config->format = AUDIO_FORMAT_PCM_16_BIT;
+        }
+        if (config->channel_mask == 0) {
+            config->channel_mask = defaultMask;
+        }
+    }
+
+    int mNextHandle;
+};
+
+} // namespace android
+
+#endif // ANDROID_AUDIO_TEST_POLICY_CLIENT_H